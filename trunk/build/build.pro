@@ -38,14 +38,18 @@ SOURCES = gelement.cpp \
           2d/gellipsecurve2d.cpp \
           2d/gmesh2d.cpp \
           2d/gpath2d.cpp \
+          2d/gpathdata.cpp \
           2d/gtracer2d.cpp \
           2d/gpixelmap.cpp \
           2d/gfont2d.cpp \
           2d/gtesselator2d.cpp \
           2d/ganimtrsnode2d.cpp \
           geometry/gaffineparts.cpp \
+          geometry/gbatchquery.cpp \
+          geometry/gbulkxform.cpp \
           numerics/geigen.cpp \
           numerics/gintegration.cpp \
+          rendering/gcolorramp.cpp \
           rendering/gdrawstyle.cpp \
           rendering/gdrawboard.cpp \
           rendering/gopenglboard.cpp \
@@ -53,14 +57,19 @@ SOURCES = gelement.cpp \
           rendering/gopenglmasks.cpp \
           rendering/gopenglgroups.cpp \
           rendering/gopenglradialgrad.cpp \
+          rendering/gopenglreadback.cpp \
           rendering/gopenglconicalgrad.cpp \
           rendering/gopenglstroke.cpp \
           rendering/gopenglgeometries.cpp \
           rendering/gopenglcache.cpp \
           rendering/gopenglcompositing.cpp \
+          rendering/gpixelcompositor.cpp \
+          rendering/gspangenerator.cpp \
           support/gavltree.cpp \
           support/gutilities.cpp \
-          support/gsvgpathtokenizer.cpp
+          support/gsvgpathtokenizer.cpp \
+          support/gsvgpathparser.cpp \
+          support/gthreadpool.cpp
 
 
 #*********************************************************
@@ -118,6 +127,18 @@ contains(DEFINES, _FONTS_PLUGIN) {
     }
 }
 
+#*********************************************************
+#
+#                 BINARY FONTS PLUGIN
+#
+#*********************************************************
+contains(DEFINES, _BINFONT_PLUGIN) {
+    contains(BINFONT_PLUGIN_OPTIONS, INTERNAL) {
+        include($$(AMANITHDIR)/plugins/binfont/build.conf)
+        SOURCES += $$(AMANITHDIR)/plugins/binfont/gbinfontimpexp.cpp
+    }
+}
+
 
 #*********************************************************
 #
@@ -152,6 +173,9 @@ contains(BUILD_MODE, static) {
     DEFINES -= G_MAKE_DLL G_USE_DLL GLEW_BUILD
 }
 
+# thread pool support
+unix: LIBS += -lpthread
+
 # link options for Windows (no MinGW!)
 !contains(DEFINES, WIN32_MINGW) {
     win32: LIBS += wbemuuid.lib
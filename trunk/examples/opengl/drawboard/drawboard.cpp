@@ -67,6 +67,10 @@ QGLWidgetTest::QGLWidgetTest(const QGLFormat& Format, QWidget *parent) : QGLWidg
 	gRandScaleY = 1;
 	gRenderingQuality = G_HIGH_RENDERING_QUALITY;
 	gUseShaders = G_TRUE;
+	gUIRectsTime = 0;
+	gCaptureFps[0] = gCaptureFps[1] = 0;
+	gCaptureWidth = gCaptureHeight = 0;
+	gCaptureMatch = G_FALSE;
 	gDrawBackGround = G_TRUE;
 	// set an 800x600 window
 	this->setGeometry(50, 50, 800, 600);
@@ -255,6 +259,12 @@ void QGLWidgetTest::paintGL() {
 		case 10:
 			TestCache(gTestIndex);
 			break;
+		case 11:
+			TestUIRects(gTestIndex);
+			break;
+		case 12:
+			TestCapture(gTestIndex);
+			break;
 		default:
 			TestColor(gTestIndex);
 	}
@@ -282,7 +292,7 @@ void QGLWidgetTest::keyPressEvent(QKeyEvent *e) {
 
 		case Qt::Key_F1:
 			s = "F2: contextual example description\n";
-			s += "0..9, C: Toggle draw test\n";
+			s += "0..9, C, U, G: Toggle draw test\n";
 			s += "PageUp/PageDown: Switch draw sheet\n";
 			s += "B: Toggle background\n";
 			s += "R: Switch rendering quality (low/normal/high)\n";
@@ -434,6 +444,31 @@ void QGLWidgetTest::keyPressEvent(QKeyEvent *e) {
 					s += "Topmost row: cached geometry is drawn with a different paint style.\n\n";
 					QMessageBox::information(this, "Current board description", s);
 					break;
+				case 11:
+					s = "This board is a benchmark made of many small UI rectangles (use PageUp/PageDown keys to switch sheet).\n\n";
+					s += "Sheet 1: 100000 filled and outlined rectangles.\n";
+					s += "Sheet 2: 100000 filled and outlined round rectangles.\n";
+					s += "Sheet 3: 2000 panels clipped by rectangular masks (scissor test), with 10 rectangles each.\n";
+					s += "Sheet 4: the same panels of sheet 3, using stencil masks.\n\n";
+					s += "With multisample buffers rectangular masks use the scissor test only at low rendering quality (R key).\n\n";
+					s += "Last frame was drawn in " + QString::number(gUIRectsTime) + " ms.";
+					QMessageBox::information(this, "Current board description", s);
+					break;
+				case 12:
+					s = "This board is a benchmark of framebuffer capture (use PageUp/PageDown keys to switch sheet).\n\n";
+					s += "Every run draws 60 frames of an animation, each one is grabbed after being drawn.\n";
+					s += "Sheet 1: frames are grabbed with the synchronous ScreenShot().\n";
+					s += "Sheet 2: frames are grabbed with ScreenShotAsync(), so that reads can go on while next frames are drawn.\n\n";
+					s += "Frames have the size of the window: maximize it on a 1920x1080 display to measure 1080p capture.\n\n";
+					s += "Last runs at " + QString::number(gCaptureWidth) + "x" + QString::number(gCaptureHeight) + ": ";
+					s += "synchronous " + QString::number(gCaptureFps[0], 'f', 1) + " fps, ";
+					s += "asynchronous " + QString::number(gCaptureFps[1], 'f', 1) + " fps.\n";
+					if (gCaptureMatch)
+						s += "Last asynchronous frame is equal to the synchronous screenshot.";
+					else
+						s += "Last asynchronous frame is NOT equal to the synchronous screenshot (or sheet 2 has not been drawn yet).";
+					QMessageBox::information(this, "Current board description", s);
+					break;
 			}
 			break;
 		case Qt::Key_1:
@@ -493,6 +528,18 @@ void QGLWidgetTest::keyPressEvent(QKeyEvent *e) {
 			updateGL();
 			break;
 
+		case Qt::Key_U:
+			gTestSuite = 11;
+			gTestIndex = 0;
+			updateGL();
+			break;
+
+		case Qt::Key_G:
+			gTestSuite = 12;
+			gTestIndex = 0;
+			updateGL();
+			break;
+
 		case Qt::Key_B:
 			if (gDrawBackGround)
 				gDrawBackGround = G_FALSE;
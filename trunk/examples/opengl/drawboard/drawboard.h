@@ -60,6 +60,9 @@ private:
 	// 7 = stroking
 	// 8 = masks and group opacity
 	// 9 = shapes
+	// 10 = cache
+	// 11 = UI rectangles benchmark
+	// 12 = screenshot capture benchmark
 	GUInt32 gTestSuite;
 	GUInt32 gTestIndex;
 	GBool gDrawBackGround;
@@ -68,6 +71,14 @@ private:
 	GReal gRandScaleY;
 	GRenderingQuality gRenderingQuality;
 	GBool gUseShaders;
+	// time spent drawing the last UI rectangles frame, in milliseconds
+	GUInt32 gUIRectsTime;
+	// frames per second of the last synchronous and asynchronous capture runs
+	GReal gCaptureFps[2];
+	// size of the captured frames
+	GUInt32 gCaptureWidth, gCaptureHeight;
+	// G_TRUE if the last asynchronous frame is equal to a synchronous screenshot
+	GBool gCaptureMatch;
 
 protected:
 	void initializeGL();					// implementation for QGLWidget.initializeGL()
@@ -86,6 +97,8 @@ protected:
 	void TestMasks(const GUInt32 TestIndex);
 	void TestGeometries(const GUInt32 TestIndex);
 	void TestCache(const GUInt32 TestIndex);
+	void TestUIRects(const GUInt32 TestIndex);
+	void TestCapture(const GUInt32 TestIndex);
 
 public:
 	// constructor
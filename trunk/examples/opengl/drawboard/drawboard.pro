@@ -18,7 +18,9 @@ SOURCES = main.cpp \
           test_stroking.cpp \
           test_geometries.cpp \
           test_masks.cpp \
-          test_cache.cpp
+          test_cache.cpp \
+          test_uirects.cpp \
+          test_capture.cpp
 
 win32: RC_FILE = example.rc
 
@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "drawboard.h"
+#include <qdatetime.h>
+
+// every frame must draw exactly the same scene, so a private generator is used instead of GMath::RangeRandom
+static GUInt32 gUISeed;
+
+static GReal UIRandom() {
+
+	gUISeed = gUISeed * 1103515245 + 12345;
+	return (GReal)((gUISeed >> 8) & 0xFFFF) / (GReal)65536;
+}
+
+void QGLWidgetTest::TestUIRects(const GUInt32 TestIndex) {
+
+	GUInt32 idx = TestIndex % 4;
+	GUInt32 i, j;
+	GReal x, y, w, h;
+	QTime time;
+
+	gDrawBoard->SetTargetMode(G_COLOR_MODE);
+	gDrawBoard->SetStrokeStyle(G_SOLID_STROKE);
+	gDrawBoard->SetStrokeJoinStyle(G_MITER_JOIN);
+	gDrawBoard->SetStrokeWidth(1);
+	gDrawBoard->SetStrokeColor(GVector4((GReal)0.0, (GReal)0.0, (GReal)0.0, (GReal)1.000));
+	gDrawBoard->SetStrokePaintType(G_COLOR_PAINT_TYPE);
+	gDrawBoard->SetFillPaintType(G_COLOR_PAINT_TYPE);
+	gDrawBoard->SetStrokeEnabled(G_TRUE);
+	gDrawBoard->SetFillEnabled(G_TRUE);
+
+	glFinish();
+	time.start();
+	gUISeed = 7;
+
+	if (idx < 2) {
+		// 100k small buttons, filled and outlined
+		for (i = 0; i < 100000; ++i) {
+			x = UIRandom() * 780;
+			y = UIRandom() * 580;
+			w = 4 + UIRandom() * 36;
+			h = 4 + UIRandom() * 20;
+			gDrawBoard->SetFillColor(GVector4(UIRandom(), UIRandom(), UIRandom(), (GReal)1.000));
+			if (idx == 0)
+				gDrawBoard->DrawRectangle(GPoint2(x, y), GPoint2(x + w, y + h));
+			else
+				gDrawBoard->DrawRoundRectangle(GPoint2(x, y), GPoint2(x + w, y + h), 1 + UIRandom() * 5, 1 + UIRandom() * 5);
+		}
+	}
+	else {
+		// 2000 panels, each one clipping its 10 widgets; the last sheet uses stencil masks instead of scissor boxes
+		gDrawBoard->SetScissorClipMasksEnabled(idx == 2);
+		for (i = 0; i < 2000; ++i) {
+			x = UIRandom() * 700;
+			y = UIRandom() * 500;
+			gDrawBoard->SetTargetMode(G_CLIP_MODE);
+			gDrawBoard->SetStrokeEnabled(G_FALSE);
+			gDrawBoard->DrawRectangle(GPoint2(x, y), GPoint2(x + 100, y + 80));
+			gDrawBoard->SetTargetMode(G_COLOR_MODE);
+			gDrawBoard->SetClipEnabled(G_TRUE);
+			gDrawBoard->SetStrokeEnabled(G_TRUE);
+			for (j = 0; j < 10; ++j) {
+				w = x - 20 + UIRandom() * 140;
+				h = y - 20 + UIRandom() * 120;
+				gDrawBoard->SetFillColor(GVector4(UIRandom(), UIRandom(), UIRandom(), (GReal)1.000));
+				gDrawBoard->DrawRectangle(GPoint2(w, h), GPoint2(w + 30, h + 12));
+			}
+			gDrawBoard->PopClipMask();
+			gDrawBoard->SetClipEnabled(G_FALSE);
+		}
+		gDrawBoard->SetScissorClipMasksEnabled(G_TRUE);
+	}
+
+	// wait for the GPU too, the time is shown by the F2 description
+	glFinish();
+	gUIRectsTime = (GUInt32)time.elapsed();
+}
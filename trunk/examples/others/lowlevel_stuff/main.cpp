@@ -32,6 +32,23 @@
 #include <amanith/geometry/gintersect.h>
 #include <amanith/support/gutilities.h>
 #include <amanith/gpluglib.h>
+#include <amanith/support/gsvgpathparser.h>
+#include <amanith/2d/gtesselator2d.h>
+#include <amanith/geometry/gaffine2.h>
+#include <amanith/2d/gfont2d.h>
+#include <amanith/geometry/gbatchquery.h>
+#include <amanith/geometry/gbvh2.h>
+#include <amanith/geometry/gquadtree2.h>
+#include <amanith/geometry/ggrid2.h>
+#include <amanith/2d/gbsplinecurve2d.h>
+#include <amanith/support/gthreadpool.h>
+#include <ctime>
+#include <cstring>
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	#include <windows.h>
+#else
+	#include <sys/time.h>
+#endif
 
 using namespace Amanith;
 
@@ -419,6 +436,1069 @@ void TestProxies() {
 	printf("\n");
 }
 
+void TestSVGPathParser() {
+
+	GString d;
+	GChar8 buf[256];
+	GInt32 i, j;
+
+	// build some MBs of path data, like the ones found in maps and icon sets
+	srand(5);
+	while (d.length() < 8 * 1024 * 1024) {
+		sprintf(buf, "M%.2f,%.2f", (rand() % 100000) / 100.0, (rand() % 100000) / 100.0);
+		d += buf;
+		for (i = 0; i < 20; ++i) {
+			if (rand() & 1)
+				sprintf(buf, "l%.2f,%.2f", (rand() % 2000) / 100.0 - 10, (rand() % 2000) / 100.0 - 10);
+			else {
+				j = sprintf(buf, "c%.2f,%.2f ", (rand() % 2000) / 100.0 - 10, (rand() % 2000) / 100.0 - 10);
+				j += sprintf(buf + j, "%.2f,%.2f ", (rand() % 2000) / 100.0 - 10, (rand() % 2000) / 100.0 - 10);
+				sprintf(buf + j, "%.2f,%.2f", (rand() % 2000) / 100.0 - 10, (rand() % 2000) / 100.0 - 10);
+			}
+			d += buf;
+		}
+		d += "z";
+	}
+
+	const GChar8 *begin = d.data();
+	const GChar8 *end = begin + d.length();
+	GDynArray<GChar8> commands;
+	GDynArray<GReal> coordinates;
+	GDynArray<GPoint2> points;
+	GDynArray<GInt32> pointsPerContour;
+	GDynArray<GBool> closedContours;
+	GDouble mb = (GDouble)d.length() / (1024.0 * 1024.0);
+	GDouble t;
+	clock_t t0;
+
+	printf("\n\nSVG path parser on %.1f MB of path data:\n", mb);
+
+	t0 = clock();
+	GSVGPathParser::ParseCommands(begin, end, commands, coordinates);
+	t = (GDouble)(clock() - t0) / CLOCKS_PER_SEC;
+	if (t > 0)
+		printf("    ParseCommands: %.0f MB/s (%d commands)\n", mb / t, (GInt32)commands.size());
+
+	t0 = clock();
+	GSVGPathParser::Flatten(begin, end, (GReal)0.25, points, pointsPerContour, closedContours);
+	t = (GDouble)(clock() - t0) / CLOCKS_PER_SEC;
+	if (t > 0)
+		printf("    Flatten: %.0f MB/s (%d points)\n", mb / t, (GInt32)points.size());
+}
+
+static void AddRect(GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+					const GReal MinX, const GReal MinY, const GReal MaxX, const GReal MaxY) {
+
+	Points.push_back(GPoint2(MinX, MinY));
+	Points.push_back(GPoint2(MaxX, MinY));
+	Points.push_back(GPoint2(MaxX, MaxY));
+	Points.push_back(GPoint2(MinX, MaxY));
+	PointsPerContour.push_back(4);
+}
+
+static GDouble PolygonsArea(const GDynArray< GPoint<GDouble, 2> >& Points, const GUInt32 PointsPerPolygon) {
+
+	GUInt32 i, j, k = (GUInt32)Points.size();
+	GDouble a, area = 0;
+
+	for (i = 0; i + PointsPerPolygon <= k; i += PointsPerPolygon) {
+		a = 0;
+		for (j = 0; j < PointsPerPolygon; ++j) {
+			const GPoint<GDouble, 2>& p0 = Points[i + j];
+			const GPoint<GDouble, 2>& p1 = Points[i + (j + 1) % PointsPerPolygon];
+			a += p0[G_X] * p1[G_Y] - p1[G_X] * p0[G_Y];
+		}
+		area += GMath::Abs(a) * 0.5;
+	}
+	return area;
+}
+
+void TestTesselator() {
+
+	// rectangles sharing (whole or partial) edges, they stress the handling of overlapping edges
+	static const GReal rects[4][8] = {
+		{ 0, 0, 2, 2, 0, 0, 2, 2 },
+		{ 0, 0, 2, 2, 0, 0, 3, 2 },
+		{ 0, 0, 2, 2, 2, 0, 4, 2 },
+		{ 0, 0, 2, 2, 0, 0, 2, 3 }
+	};
+	// expected areas for odd-even and non-zero rules
+	static const GDouble areas[4][2] = {
+		{ 0, 4 },
+		{ 2, 6 },
+		{ 8, 8 },
+		{ 2, 6 }
+	};
+	static const GFillBehavior rules[2] = { G_ODD_EVEN_RULE, G_NON_ZERO_RULE };
+	static const GChar8 *rulesNames[2] = { "odd-even", "non-zero" };
+	GTesselator2D tesselator;
+	GDynArray<GPoint2> points;
+	GDynArray<GInt32> pointsPerContour;
+	GDynArray< GPoint<GDouble, 2> > triangles, trapezoids;
+	GDouble triArea, trapArea;
+	GInt32 i, j;
+
+	printf("\n\nTesselator on overlapping rectangles:\n");
+	for (i = 0; i < 4; ++i) {
+		points.clear();
+		pointsPerContour.clear();
+		AddRect(points, pointsPerContour, rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+		AddRect(points, pointsPerContour, rects[i][4], rects[i][5], rects[i][6], rects[i][7]);
+		for (j = 0; j < 2; ++j) {
+			triangles.clear();
+			trapezoids.clear();
+			tesselator.Tesselate(points, pointsPerContour, triangles, rules[j]);
+			tesselator.TesselateTrapezoids(points, pointsPerContour, trapezoids, rules[j]);
+			triArea = PolygonsArea(triangles, 3);
+			trapArea = PolygonsArea(trapezoids, 4);
+			printf("    Case %d, %s: triangles area %.2f, trapezoids area %.2f, expected %.2f -> %s\n", i, rulesNames[j],
+				   triArea, trapArea, areas[i][j],
+				   (GMath::Abs(triArea - areas[i][j]) < 1e-6 && GMath::Abs(trapArea - areas[i][j]) < 1e-6) ? "ok" : "WRONG");
+		}
+	}
+}
+
+// point in polygon test, counting the crossings of an horizontal ray
+static GBool PolygonContains(const GDynArray<GPoint2>& Polygon, const GPoint2& Point) {
+
+	GUInt32 i, j = (GUInt32)Polygon.size(), k;
+	GBool inside = G_FALSE;
+
+	for (i = 0, k = j - 1; i < j; k = i++) {
+		const GPoint2& a = Polygon[i];
+		const GPoint2& b = Polygon[k];
+		if ((a[G_Y] > Point[G_Y]) != (b[G_Y] > Point[G_Y]) &&
+			Point[G_X] < a[G_X] + (Point[G_Y] - a[G_Y]) * (b[G_X] - a[G_X]) / (b[G_Y] - a[G_Y]))
+			inside = !inside;
+	}
+	return inside;
+}
+
+void TestFontLabelling() {
+
+	const GChar8 *fontNames[2] = { "crazk.ttf", "cards.ttf" };
+	GDynArray< GDynArray<GPoint2> > polygons;
+	GFont2D *font;
+	GError err;
+	GString fName;
+	GDouble t;
+	clock_t t0;
+	GInt32 i, j, f;
+	GUInt32 k, w, q, n, containers, contoursCount, mismatches;
+	GBool hole;
+
+	printf("\n\nFont contours hole/fill labelling:\n");
+	for (f = 0; f < 2; ++f) {
+		font = (GFont2D *)kernel->CreateNew(G_FONT2D_CLASSID);
+		if (!font) {
+			printf("Error creating GFont2D: used kernel does not support it, or plugin not found.");
+			return;
+		}
+		fName = dataPath + fontNames[f];
+		err = font->Load(StrUtils::ToAscii(fName), "scale=0");
+		if (err != G_NO_ERROR) {
+			printf("Error loading %s. Error is: %s\n", fontNames[f], StrUtils::ToAscii(ErrorUtils::ErrToString(err)));
+			delete font;
+			continue;
+		}
+		j = font->CharsCount();
+		contoursCount = 0;
+		// contours are labeled the first time they are accessed
+		t0 = clock();
+		for (i = 0; i < j; ++i) {
+			const GFontChar2D *fontChar = font->CharByIndex(i);
+			if (fontChar && !fontChar->IsComposite() && fontChar->ContoursCount() > 0) {
+				fontChar->Contour(0);
+				contoursCount += fontChar->ContoursCount();
+			}
+		}
+		t = (GDouble)(clock() - t0) / CLOCKS_PER_SEC;
+
+		// check labels against a brute force test: a contour is an hole if it's contained inside an odd number of
+		// (flattened) contours; the middle of a segment halfway along it is tested, because on-curve points can be
+		// shared by touching contours. A container must also contain the bounding box of the contour, so crossing
+		// contours (for which containment is not defined) are treated as the labelling sweep does
+		mismatches = 0;
+		for (i = 0; i < j; ++i) {
+			const GFontChar2D *fontChar = font->CharByIndex(i);
+			if (!fontChar || fontChar->IsComposite())
+				continue;
+			w = fontChar->ContoursCount();
+			polygons.clear();
+			polygons.resize(w);
+			for (k = 0; k < w; ++k)
+				fontChar->Contour(k)->DrawContour(polygons[k], (GReal)1e-7);
+			for (k = 0; k < w; ++k) {
+				if (polygons[k].size() < 2)
+					continue;
+				n = (GUInt32)polygons[k].size() / 2;
+				GPoint2 p = (polygons[k][n - 1] + polygons[k][n]) * (GReal)0.5;
+				containers = 0;
+				const GAABox2& box = fontChar->Contour(k)->BoundBox();
+				for (q = 0; q < w; ++q) {
+					if (q == k)
+						continue;
+					const GAABox2& qBox = fontChar->Contour(q)->BoundBox();
+					if (qBox.Min()[G_X] > box.Min()[G_X] || qBox.Max()[G_X] < box.Max()[G_X] ||
+						qBox.Min()[G_Y] > box.Min()[G_Y] || qBox.Max()[G_Y] < box.Max()[G_Y])
+						continue;
+					if (PolygonContains(polygons[q], p))
+						containers++;
+				}
+				hole = ((containers & 1) != 0);
+				if (fontChar->EvenOddFill())
+					hole = !hole;
+				if (hole != fontChar->Contour(k)->IsHole())
+					mismatches++;
+			}
+		}
+		printf("    %s: %d glyphs, %d contours labeled in %.2f ms, %d labels differ from the brute force test\n",
+			   fontNames[f], j, contoursCount, t * 1000.0, mismatches);
+		delete font;
+	}
+}
+
+// fill a matrix with a pseudo random, diagonally dominant (so invertible) content
+template <GUInt32 SIZE>
+static void RandomMatrix(GMatrix<GReal, SIZE, SIZE>& Matrix) {
+
+	for (GUInt32 i = 0; i < SIZE; ++i)
+		for (GUInt32 j = 0; j < SIZE; ++j)
+			Matrix[i][j] = (GReal)(rand() % 2000) / 1000 - 1 + ((i == j) ? (GReal)SIZE : 0);
+}
+
+static void PrintMatrixTimes(const GChar8 *Name, const clock_t Generic, const clock_t Specialized, const GUInt32 Count) {
+
+	GDouble k = 1e9 / ((GDouble)CLOCKS_PER_SEC * Count);
+
+	printf("    %s: generic %.1f ns, specialized %.1f ns\n", Name, Generic * k, Specialized * k);
+}
+
+void TestMatrixOps() {
+
+	const GUInt32 count = 2000000;
+	GMatrix33 a3, b3, r3;
+	GMatrix44 a4, b4, r4, l4, u4;
+	GMatrix<GReal, 5, 5> a5, r5;
+	GVect<GInt32, 4> perm4;
+	GAffine2 af1, af2, raf;
+	GReal det, det2, sum = 0;
+	clock_t t0, tGeneric, tSpecialized;
+	GUInt32 i;
+
+	srand(7);
+	RandomMatrix(a3);
+	RandomMatrix(b3);
+	RandomMatrix(a4);
+	RandomMatrix(b4);
+	RandomMatrix(a5);
+	af1 = GAffine2(a3);
+	af2 = GAffine2(b3);
+	a3[2][0] = a3[2][1] = b3[2][0] = b3[2][1] = 0;
+	a3[2][2] = b3[2][2] = 1;
+
+	printf("\n\nFixed size matrix operations (%d iterations):\n", count);
+
+	// the generic DecompLU has no closed form counterpart for 5x5 matrices, check it against Gauss-Jordan
+	InvertFull_GJ(r5, a5, det2);
+	det = Determinant(a5);
+	printf("    5x5 determinant: LU %f, Gauss-Jordan %f -> %s\n", det, det2,
+		   (GMath::Abs(det - det2) <= GMath::Abs(det2) * (GReal)1e-4) ? "ok" : "WRONG");
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(i & 7);
+		Mult<GReal, 3, 3, 3>(r3, a3, b3);
+		sum += r3[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(i & 7);
+		Mult(r3, a3, b3);
+		sum += r3[1][2];
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("3x3 multiply", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a4[0][0] = (GReal)(i & 7);
+		Mult<GReal, 4, 4, 4>(r4, a4, b4);
+		sum += r4[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a4[0][0] = (GReal)(i & 7);
+		Mult(r4, a4, b4);
+		sum += r4[1][2];
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("4x4 multiply", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(4 + (i & 7));
+		InvertFull_GJ(r3, a3, det);
+		sum += r3[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(4 + (i & 7));
+		Invert(r3, a3, det);
+		sum += r3[1][2];
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("3x3 inverse", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(4 + (i & 7));
+		InvertFull_GJ(r3, a3, det);
+		sum += r3[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(4 + (i & 7));
+		InvertAffine(r3, a3, det);
+		sum += r3[1][2];
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("3x3 affine inverse", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a4[0][0] = (GReal)(4 + (i & 7));
+		InvertFull_GJ(r4, a4, det);
+		sum += r4[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a4[0][0] = (GReal)(4 + (i & 7));
+		Invert(r4, a4, det);
+		sum += r4[1][2];
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("4x4 inverse", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a4[0][0] = (GReal)(4 + (i & 7));
+		DecompLU(a4, l4, u4, perm4, det);
+		sum += det;
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a4[0][0] = (GReal)(4 + (i & 7));
+		sum += Determinant(a4);
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("4x4 determinant", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(i & 7);
+		Mult<GReal, 3, 3, 3>(r3, a3, b3);
+		sum += r3[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(i & 7);
+		MultAffine(r3, a3, b3);
+		sum += r3[1][2];
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("3x3 affine multiply", tGeneric, tSpecialized, count);
+
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		a3[0][0] = (GReal)(i & 7);
+		Mult<GReal, 3, 3, 3>(r3, a3, b3);
+		sum += r3[1][2];
+	}
+	tGeneric = clock() - t0;
+	t0 = clock();
+	for (i = 0; i < count; ++i) {
+		af1(0, 0) = (GReal)(i & 7);
+		raf = af1 * af2;
+		sum += raf(1, 2);
+	}
+	tSpecialized = clock() - t0;
+	PrintMatrixTimes("affine compose (GAffine2)", tGeneric, tSpecialized, count);
+	// print the accumulated value, so that the compiler can't throw away the loops
+	printf("    (checksum %g)\n", sum);
+}
+
+// random coordinates on a coarse grid, so that touching, tangent and parallel primitives are frequent
+static GReal GridReal() {
+
+	return (GReal)(rand() % 41 - 20) * (GReal)0.25;
+}
+
+// a batched result must be the scalar one, parameters are compared bit for bit
+static GBool SameResult(const GBool BatchHit, const GReal BatchParam, const GBool ScalarHit, const GReal ScalarParam) {
+
+	if (BatchHit != ScalarHit)
+		return G_FALSE;
+	return (!ScalarHit || std::memcmp(&BatchParam, &ScalarParam, sizeof(GReal)) == 0);
+}
+
+void TestBatchQuery() {
+
+	// not a multiple of the pack size, so that the scalar tail is exercised too
+	const GUInt32 count = 10007;
+	const GUInt32 queriesCount = 200;
+	GAABox2Array boxes;
+	GSphere2Array spheres;
+	GLineSegment2Array segments;
+	GDynArray<GPoint2> points(count);
+	GDynArray<GReal> params(count);
+	GBool *hits = new GBool[count];
+	GRay2 ray;
+	GAABox2 box;
+	GVector2 dir;
+	GReal scalarParams[2];
+	GUInt32 i, j, flags, batchCount, scalarCount, tests, differences;
+	GBoxSide side;
+	GBool hit;
+
+	srand(11);
+	for (i = 0; i < count; ++i) {
+		boxes.Add(GAABox2(GPoint2(GridReal(), GridReal()), GPoint2(GridReal(), GridReal())));
+		spheres.Add(GSphere2(GPoint2(GridReal(), GridReal()), GMath::Abs(GridReal())));
+		segments.Add(GLineSegment2(GPoint2(GridReal(), GridReal()), GVector2(GridReal(), GridReal())));
+		points[i].Set(GridReal(), GridReal());
+	}
+
+	printf("\n\nBatched queries against scalar templates (%s, %d primitives, %d queries):\n",
+		   (sizeof(GReal) == sizeof(GDouble)) ? "double" : "float", count, queriesCount);
+
+	// rays parallel to the axes and zero length rays are included, they take the scalar path
+	tests = differences = 0;
+	for (j = 0; j < queriesCount; ++j) {
+		dir.Set(GridReal(), GridReal());
+		if (j % 8 == 0)
+			dir[G_X] = 0;
+		else
+		if (j % 8 == 1)
+			dir[G_Y] = 0;
+		ray.SetOrigin(GPoint2(GridReal(), GridReal()));
+		ray.SetDirection(dir);
+
+		batchCount = GBatchQuery::Intersect(ray, boxes, hits, &params[0]);
+		scalarCount = 0;
+		for (i = 0; i < count; ++i) {
+			hit = Intersect(ray, boxes.Box(i), flags, scalarParams, side);
+			scalarCount += (hit) ? 1 : 0;
+			differences += (SameResult(hits[i], params[i], hit, scalarParams[0])) ? 0 : 1;
+		}
+		differences += (batchCount != scalarCount) ? 1 : 0;
+
+		batchCount = GBatchQuery::Intersect(ray, spheres, hits, &params[0]);
+		scalarCount = 0;
+		for (i = 0; i < count; ++i) {
+			hit = Intersect(ray, spheres.Sphere(i), flags, scalarParams);
+			scalarCount += (hit) ? 1 : 0;
+			differences += (SameResult(hits[i], params[i], hit, scalarParams[0])) ? 0 : 1;
+		}
+		differences += (batchCount != scalarCount) ? 1 : 0;
+
+		batchCount = GBatchQuery::Intersect(ray, segments, hits, &params[0]);
+		scalarCount = 0;
+		for (i = 0; i < count; ++i) {
+			hit = Intersect(ray, segments.Segment(i), flags, scalarParams);
+			scalarCount += (hit) ? 1 : 0;
+			differences += (SameResult(hits[i], params[i], hit, scalarParams[0])) ? 0 : 1;
+		}
+		differences += (batchCount != scalarCount) ? 1 : 0;
+		tests += 3 * count;
+	}
+	printf("    ray - boxes, spheres, segments: %d tests, %d differences\n", tests, differences);
+
+	tests = differences = 0;
+	for (j = 0; j < queriesCount; ++j) {
+		box.SetMinMax(GPoint2(GridReal(), GridReal()), GPoint2(GridReal(), GridReal()));
+
+		batchCount = GBatchQuery::PointsInBox(box, &points[0], count, hits, (GReal)((j & 1) ? 0.25 : 0));
+		scalarCount = 0;
+		for (i = 0; i < count; ++i) {
+			hit = (box.PointSign(points[i], (GReal)((j & 1) ? 0.25 : 0)) != G_OUTSIDE);
+			scalarCount += (hit) ? 1 : 0;
+			differences += (hits[i] != hit) ? 1 : 0;
+		}
+		differences += (batchCount != scalarCount) ? 1 : 0;
+
+		batchCount = GBatchQuery::Cull(box, boxes, hits);
+		scalarCount = 0;
+		for (i = 0; i < count; ++i) {
+			hit = Intersect(boxes.Box(i), box, flags);
+			scalarCount += (hit) ? 1 : 0;
+			differences += (hits[i] != hit) ? 1 : 0;
+		}
+		differences += (batchCount != scalarCount) ? 1 : 0;
+		tests += 2 * count;
+	}
+	printf("    points in box, boxes culling: %d tests, %d differences\n", tests, differences);
+	delete [] hits;
+}
+
+static GReal RandomReal(const GReal Min, const GReal Max) {
+
+	return Min + (Max - Min) * ((GReal)rand() / (GReal)RAND_MAX);
+}
+
+static GDouble ElapsedMs(const clock_t Start) {
+
+	return (GDouble)(clock() - Start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+template <typename CONTAINER>
+static void BenchSpatialContainer(const GChar8 *Name, const GDynArray<GAABox2>& Items) {
+
+	CONTAINER container;
+	GDynArray<GUInt32> handles;
+	GDynArray<GSpatialHit2> hits;
+	GPoint2 p;
+	GUInt32 i, h, boxHits = 0, rayHits = 0;
+	GDouble tBuild, tBox, tRay, tNearest, tUpdate;
+	clock_t t0;
+
+	t0 = clock();
+	container.Build(Items);
+	tBuild = ElapsedMs(t0);
+
+	// all containers run the same queries, so they must find the same number of hits
+	srand(11);
+	t0 = clock();
+	for (i = 0; i < 10000; ++i) {
+		p.Set(RandomReal(0, 1000), RandomReal(0, 1000));
+		container.Query(GAABox2(p, p + GVector2(5, 5)), handles);
+		boxHits += (GUInt32)handles.size();
+	}
+	tBox = ElapsedMs(t0);
+
+	t0 = clock();
+	for (i = 0; i < 1000; ++i) {
+		p.Set(RandomReal(0, 1000), RandomReal(0, 1000));
+		container.Query(GRay2(p, GVector2(RandomReal(-1, 1), RandomReal(-1, 1))), hits);
+		rayHits += (GUInt32)hits.size();
+	}
+	tRay = ElapsedMs(t0);
+
+	t0 = clock();
+	for (i = 0; i < 10000; ++i) {
+		p.Set(RandomReal(0, 1000), RandomReal(0, 1000));
+		container.Nearest(p, 8, hits);
+	}
+	tNearest = ElapsedMs(t0);
+
+	t0 = clock();
+	for (i = 0; i < 100000; ++i) {
+		h = (GUInt32)rand() % (GUInt32)Items.size();
+		if (container.Remove(h))
+			container.Insert(Items[h]);
+	}
+	tUpdate = ElapsedMs(t0);
+
+	printf("    %-9s %6.0f %8.0f %7.0f %9.0f %19.0f   (%d box hits, %d ray hits)\n", Name, tBuild, tBox, tRay,
+		   tNearest, tUpdate, boxHits, rayHits);
+}
+
+void TestSpatialContainers() {
+
+	const GUInt32 count = 1000000;
+	GDynArray<GAABox2> items(count);
+	GSpatialBox2 queryBox;
+	GPoint2 p;
+	GUInt32 i, j, hitsCount;
+	clock_t t0;
+
+	srand(5);
+	for (i = 0; i < count; ++i) {
+		p.Set(RandomReal(0, 1000), RandomReal(0, 1000));
+		items[i] = GAABox2(p, p + GVector2(RandomReal(0, 1), RandomReal(0, 1)));
+	}
+
+	printf("\n\nSpatial containers, %d boxes (times in ms):\n", count);
+	printf("               build  10k box  1k ray  10k 8-NN  100k remove+insert\n");
+	BenchSpatialContainer< GBVH2<GAABox2> >("bvh", items);
+	BenchSpatialContainer< GQuadTree2<GAABox2> >("quadtree", items);
+	BenchSpatialContainer< GGrid2<GAABox2> >("grid", items);
+
+	// reference: a linear scan of all boxes
+	srand(11);
+	hitsCount = 0;
+	t0 = clock();
+	for (j = 0; j < 100; ++j) {
+		p.Set(RandomReal(0, 1000), RandomReal(0, 1000));
+		queryBox = GSpatialBox2(GAABox2(p, p + GVector2(5, 5)));
+		for (i = 0; i < count; ++i) {
+			if (GSpatialTraits2<GAABox2>::Box(items[i]).Overlaps(queryBox))
+				hitsCount++;
+		}
+	}
+	printf("    linear scan: %.2f ms per box query (%d hits in 100 queries)\n", ElapsedMs(t0) / 100, hitsCount);
+}
+
+static const GChar8 *gFormatNames[6] = { "gray", "palette", "rgb", "argb", "1555", "565" };
+
+static GDouble GBPerSecond(const GDouble Bytes, const GDouble Ms) {
+
+	return (Ms > 0) ? Bytes / (Ms * 1e6) : 0;
+}
+
+static GUInt32 DifferentBytes(const GUChar8 *Bytes1, const GUChar8 *Bytes2, const GUInt32 Count) {
+
+	GUInt32 i, n = 0;
+
+	for (i = 0; i < Count; ++i)
+		n += (Bytes1[i] != Bytes2[i]) ? 1 : 0;
+	return n;
+}
+
+// Negative (0), ReverseChannels (1) and ReverseChannels with alpha (2), timed on the whole image, then checked
+// pixel by pixel on a single pixel image: a single pixel is always handled by the scalar tail of the kernels
+static void BenchPixelOp(const GChar8 *Name, const GPixelMap& Image, const GUInt32 Op, const GUInt32 Loops) {
+
+	GPixelMap result, single;
+	GUInt32 i, bpp = Image.BytesPerPixel(), count = Image.PixelsCount(), differences = 0;
+	clock_t t0;
+	GDouble t;
+
+	t0 = clock();
+	for (i = 0; i < Loops; ++i) {
+		if (Op == 0)
+			Image.Negative(result);
+		else
+			Image.ReverseChannels(result, (Op == 2));
+	}
+	t = ElapsedMs(t0);
+
+	single.Reset(1, 1, Image.PixelFormat());
+	for (i = 0; i < count; ++i) {
+		std::memcpy(single.Pixels(), Image.Pixels() + i * bpp, bpp);
+		if (Op == 0)
+			single.Negative();
+		else
+			single.ReverseChannels(Op == 2);
+		differences += DifferentBytes(single.Pixels(), result.Pixels() + i * bpp, bpp);
+	}
+	printf("    %-24s %-7s %6.2f GB/s, %d bytes differ from the scalar code\n", Name, gFormatNames[Image.PixelFormat()],
+		   GBPerSecond((GDouble)count * bpp * 2 * Loops, t), differences);
+}
+
+void TestRowConverters() {
+
+	// an odd number of pixels, so that the scalar tails are exercised too
+	const GUInt32 width = 2047, height = 2049, count = width * height;
+	const GUInt32 loops = 10;
+	const GUInt32 sizes[6] = { 1, 1, 4, 4, 2, 2 };
+	GUChar8 *src = new GUChar8[count * 4];
+	GUChar8 *dst = new GUChar8[count * 4];
+	GUChar8 ref[4];
+	GUInt32 palette[256];
+	GPixelRowConverter converter;
+	GPixelMap image, single, alpha, red, green, blue, a1, r1, g1, b1, merged;
+	GUInt32 i, j, s, d, differences = 0;
+	clock_t t0;
+	GDouble t;
+
+	srand(3);
+	for (i = 0; i < count * 4; ++i)
+		src[i] = (GUChar8)(rand() >> 3);
+	for (i = 0; i < 256; ++i)
+		palette[i] = ((GUInt32)rand() << 16) ^ (GUInt32)rand();
+
+	printf("\n\nPixel row converters, %d pixels (GB/s of source plus destination bytes, rows are source formats):\n",
+		   count);
+	printf("               gray palette     rgb    argb    1555     565\n");
+	for (s = 0; s < 6; ++s) {
+		printf("    %-7s", gFormatNames[s]);
+		for (d = 0; d < 6; ++d) {
+			converter = GPixelMap::RowConverter((GPixelFormat)s, (GPixelFormat)d);
+			// conversions to a paletted format require a quantization
+			if (!converter) {
+				printf("       -");
+				continue;
+			}
+			t0 = clock();
+			for (j = 0; j < loops; ++j)
+				converter(src, dst, count, palette);
+			t = ElapsedMs(t0);
+			printf(" %7.2f", GBPerSecond((GDouble)count * (sizes[s] + sizes[d]) * loops, t));
+			// a single pixel is always handled by the scalar traits, compare them with the vectorized run
+			for (i = 0; i < count; ++i) {
+				converter(src + i * sizes[s], ref, 1, palette);
+				differences += DifferentBytes(ref, dst + i * sizes[d], sizes[d]);
+			}
+		}
+		printf("\n");
+	}
+	printf("    %d bytes differ from the scalar converters\n", differences);
+
+	for (s = 0; s < 6; ++s) {
+		if (s == G_RGB_PALETTE)
+			continue;
+		image.Reset(width, height, (GPixelFormat)s);
+		std::memcpy(image.Pixels(), src, count * sizes[s]);
+		BenchPixelOp("Negative", image, 0, loops);
+		if (s == G_GRAYSCALE)
+			continue;
+		BenchPixelOp("ReverseChannels", image, 1, loops);
+		BenchPixelOp("ReverseChannels (alpha)", image, 2, loops);
+
+		t0 = clock();
+		for (j = 0; j < loops; ++j)
+			image.SplitChannels(&alpha, &red, &green, &blue);
+		t = ElapsedMs(t0);
+		single.Reset(1, 1, (GPixelFormat)s);
+		differences = 0;
+		for (i = 0; i < count; ++i) {
+			std::memcpy(single.Pixels(), image.Pixels() + i * sizes[s], sizes[s]);
+			single.SplitChannels(&a1, &r1, &g1, &b1);
+			differences += (a1.Pixels()[0] != alpha.Pixels()[i]) ? 1 : 0;
+			differences += (r1.Pixels()[0] != red.Pixels()[i]) ? 1 : 0;
+			differences += (g1.Pixels()[0] != green.Pixels()[i]) ? 1 : 0;
+			differences += (b1.Pixels()[0] != blue.Pixels()[i]) ? 1 : 0;
+		}
+		printf("    %-24s %-7s %6.2f GB/s, %d bytes differ from the scalar code\n", "SplitChannels", gFormatNames[s],
+			   GBPerSecond((GDouble)count * (sizes[s] + 4) * loops, t), differences);
+	}
+
+	// merge the channels of a 32bit image, with and without alpha
+	image.Reset(width, height, G_A8R8G8B8);
+	std::memcpy(image.Pixels(), src, count * 4);
+	image.SplitChannels(&alpha, &red, &green, &blue);
+	for (s = 0; s < 2; ++s) {
+		t0 = clock();
+		for (j = 0; j < loops; ++j)
+			merged.MergeChannels(red, green, blue, (s == 0) ? NULL : &alpha);
+		t = ElapsedMs(t0);
+		differences = 0;
+		for (i = 0; i < count; ++i) {
+			r1.Pixels()[0] = red.Pixels()[i];
+			g1.Pixels()[0] = green.Pixels()[i];
+			b1.Pixels()[0] = blue.Pixels()[i];
+			a1.Pixels()[0] = alpha.Pixels()[i];
+			single.MergeChannels(r1, g1, b1, (s == 0) ? NULL : &a1);
+			differences += DifferentBytes(single.Pixels(), merged.Pixels() + i * 4, 4);
+		}
+		printf("    %-24s %-7s %6.2f GB/s, %d bytes differ from the scalar code\n", "MergeChannels",
+			   gFormatNames[merged.PixelFormat()], GBPerSecond((GDouble)count * (3 + s + 4) * loops, t), differences);
+	}
+	delete [] src;
+	delete [] dst;
+}
+
+// pseudo random generator independent from the C library, so that fit points are the same on every platform
+static GUInt32 gFitSeed;
+
+static GReal FitRandom() {
+
+	gFitSeed = gFitSeed * 1103515245 + 12345;
+	return (GReal)((gFitSeed >> 8) & 0xFFFF) / (GReal)65536;
+}
+
+// FNV-1a hash of the bytes of some real values
+static GUInt32 HashReals(const GReal *Values, const GUInt32 Count, GUInt32 Hash) {
+
+	const GUChar8 *bytes = (const GUChar8 *)Values;
+
+	for (GUInt32 i = 0; i < Count * sizeof(GReal); ++i) {
+		Hash ^= bytes[i];
+		Hash *= 16777619;
+	}
+	return Hash;
+}
+
+// hash of the control points built by each global fit variant, for degrees 1..6
+static void GlobalFitHashes(GUInt32 Hashes[8]) {
+
+	const GUInt32 count = 1000;
+	GDynArray<GPoint2> points(count);
+	GDynArray<GVector2> derivatives(count);
+	GDynArray<GReal> values(count), derivatives1D(count);
+	GBSplineCurve2D curve;
+	GBSplineCurve1D curve1D;
+	GPoint2 p;
+	GUInt32 i, k;
+	GInt32 degree;
+	GError err;
+
+	gFitSeed = 17;
+	for (i = 0; i < count; ++i) {
+		points[i].Set((GReal)i + FitRandom(), FitRandom() * 50);
+		derivatives[i].Set(1 + FitRandom(), FitRandom() * 20 - 10);
+		values[i] = FitRandom() * 50;
+		derivatives1D[i] = FitRandom() * 20 - 10;
+	}
+	for (k = 0; k < 8; ++k)
+		Hashes[k] = 2166136261u;
+
+	for (degree = 1; degree <= 6; ++degree) {
+		for (k = 0; k < 8; ++k) {
+			switch (k) {
+				case 0:
+					err = curve.GlobalFit(degree, points);
+					break;
+				case 1:
+					err = curve.GlobalFit(degree, points, derivatives[0], derivatives[count - 1]);
+					break;
+				case 2:
+					err = curve.GlobalFit(degree, points, derivatives);
+					break;
+				case 3:
+					err = curve.GlobalNaturalFit(degree, points);
+					break;
+				case 4:
+					err = curve1D.GlobalFit(degree, values);
+					break;
+				case 5:
+					err = curve1D.GlobalFit(degree, values, derivatives1D[0], derivatives1D[count - 1], 0, 1);
+					break;
+				case 6:
+					err = curve1D.GlobalFit(degree, values, derivatives1D);
+					break;
+				default:
+					err = curve1D.GlobalNaturalFit(degree, values);
+			}
+			if (err != G_NO_ERROR)
+				Hashes[k] = (Hashes[k] ^ (GUInt32)err) * 16777619;
+			else
+			if (k < 4) {
+				for (i = 0; i < curve.PointsCount(); ++i) {
+					p = curve.Point(i);
+					Hashes[k] = HashReals(p.Data(), 2, Hashes[k]);
+				}
+			}
+			else
+				Hashes[k] = HashReals(&curve1D.Points()[0], curve1D.PointsCount(), Hashes[k]);
+		}
+	}
+}
+
+// a random walk, so that consecutive points are never coincident
+static void FitPoints(GDynArray<GPoint2>& Points, const GUInt32 Count) {
+
+	Points.resize(Count);
+	for (GUInt32 i = 0; i < Count; ++i)
+		Points[i].Set((GReal)i + FitRandom(), FitRandom() * 50);
+}
+
+static GReal MaxDistance(const GBSplineCurve2D& Curve1, const GBSplineCurve2D& Curve2) {
+
+	GReal d = 0;
+
+	for (GUInt32 i = 0; i < Curve1.PointsCount(); ++i)
+		d = GMath::Max(d, Distance(Curve1.Point(i), Curve2.Point(i)));
+	return d;
+}
+
+void TestBSplineFit() {
+
+	// hashes of the control points built by the dense global fit code, that was replaced by the banded one;
+	// they have been computed in double precision on x86-64
+	const GUInt32 denseHashes[8] = { 0x38ED8B44, 0x88FEE6F5, 0x1A7793FD, 0xF3D566E9,
+									 0xAF5535FB, 0x683B11C8, 0x34C17BD6, 0x7785C1CF };
+	const GUInt32 knownCount = 200, samplesCount = 20000;
+	GDynArray<GPoint2> points, samples;
+	GDynArray<GReal> params, noWeights;
+	GBSplineCurve2D curve, known, incremental;
+	GBSplineCurveFitter2D fitter;
+	GUInt32 hashes[8];
+	GUInt32 i, j, k, count, loops, differences;
+	GDouble tGlobal, tLeastSquares, tAdd, tSolve;
+	clock_t t0;
+
+	printf("\n\nB-spline fitting:\n");
+
+	GlobalFitHashes(hashes);
+	if (sizeof(GReal) == sizeof(GDouble)) {
+		differences = 0;
+		for (k = 0; k < 8; ++k)
+			differences += (hashes[k] != denseHashes[k]) ? 1 : 0;
+		printf("    global fits (1D and 2D, 4 variants, degrees 1..6): %d of 8 differ from the dense code\n",
+			   differences);
+	}
+	else
+		printf("    global fits: reference hashes are available in double precision only\n");
+
+	// cubic curves; least-squares fits use a control point every 10 fit points
+	printf("    points  GlobalFit  LeastSquaresFit  fitter AddSample  fitter Solve   (ms)\n");
+	for (count = 10000; count <= 1000000; count *= 10) {
+		gFitSeed = 5;
+		FitPoints(points, count);
+		params.resize(count);
+		for (i = 0; i < count; ++i)
+			params[i] = (GReal)i / (GReal)(count - 1);
+		// small sizes are repeated, to get a measurable time
+		loops = 1000000 / count;
+
+		t0 = clock();
+		for (j = 0; j < loops; ++j)
+			curve.GlobalFit(3, points);
+		tGlobal = ElapsedMs(t0) / loops;
+
+		t0 = clock();
+		for (j = 0; j < loops; ++j)
+			curve.LeastSquaresFit(3, count / 10, points, noWeights);
+		tLeastSquares = ElapsedMs(t0) / loops;
+
+		tAdd = tSolve = 0;
+		for (j = 0; j < loops; ++j) {
+			fitter.SetUniformKnots(3, count / 10);
+			t0 = clock();
+			for (i = 0; i < count; ++i)
+				fitter.AddSample(params[i], points[i]);
+			tAdd += ElapsedMs(t0);
+			t0 = clock();
+			fitter.Solve(curve);
+			tSolve += ElapsedMs(t0);
+		}
+		printf("    %7d %10.2f %16.2f %17.2f %13.2f\n", count, tGlobal, tLeastSquares, tAdd / loops, tSolve / loops);
+	}
+
+	// sample a known spline with non uniform knots, then fit the samples using the same knots
+	gFitSeed = 9;
+	FitPoints(points, knownCount);
+	known.SetPoints(points, 3, 0, 1, G_TRUE, G_FALSE);
+	params.resize(samplesCount);
+	for (i = 0; i < samplesCount; ++i)
+		params[i] = (GReal)i / (GReal)(samplesCount - 1);
+	known.Evaluate(params, samples);
+	fitter.SetKnots(3, known.Knots());
+	fitter.AddSamples(params, samples, noWeights);
+	fitter.Solve(curve);
+	printf("    known spline (%d control points) recovered from %d samples, max error %g\n", knownCount, samplesCount,
+		   MaxDistance(curve, known));
+
+	// the same samples are added one by one in a shuffled order, together with some outliers that are then
+	// removed; the result must be the batch one
+	fitter.Reset();
+	for (i = 0; i < samplesCount; ++i) {
+		j = (i * 7919) % samplesCount;
+		fitter.AddSample(params[j], samples[j]);
+		if (j % 10 == 0)
+			fitter.AddSample(params[j], samples[j] + GVector2(5, -5), 2);
+	}
+	for (j = 0; j < samplesCount; j += 10)
+		fitter.RemoveSample(params[j], samples[j] + GVector2(5, -5), 2);
+	fitter.Solve(incremental);
+	printf("    incremental (shuffled, with removals) and batch fits differ by %g\n", MaxDistance(incremental, curve));
+}
+
+// clock() sums the time of all threads, so multithreaded code must be timed with a wall clock
+static GDouble WallClockMs() {
+
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	return (GDouble)GetTickCount();
+#else
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (GDouble)tv.tv_sec * 1000.0 + (GDouble)tv.tv_usec / 1000.0;
+#endif
+}
+
+// a smooth photo-like image: overlapping color waves, a vignetting and some grain
+static void QuantizeTestImage(GPixelMap& Image, const GUInt32 Width, const GUInt32 Height) {
+
+	GUInt32 *pixels;
+	GUInt32 x, y;
+	GInt32 r, g, b, n;
+	GReal u, v, light;
+
+	Image.Reset(Width, Height, G_A8R8G8B8);
+	pixels = (GUInt32 *)Image.Pixels();
+	srand(11);
+	for (y = 0; y < Height; ++y) {
+		v = (GReal)y / (GReal)Height;
+		for (x = 0; x < Width; ++x) {
+			u = (GReal)x / (GReal)Width;
+			light = 1 - (GReal)0.6 * ((u - (GReal)0.5) * (u - (GReal)0.5) + (v - (GReal)0.4) * (v - (GReal)0.4));
+			n = (rand() % 13) - 6;
+			r = (GInt32)(light * (140 + 100 * GMath::Sin(7 * u + 2 * v))) + n;
+			g = (GInt32)(light * (120 + 90 * GMath::Sin(5 * v - 3 * u + 1))) + n;
+			b = (GInt32)(light * (110 + 80 * GMath::Cos(4 * u * v + 9 * v))) + n;
+			r = GMath::Max(0, GMath::Min(r, 255));
+			g = GMath::Max(0, GMath::Min(g, 255));
+			b = GMath::Max(0, GMath::Min(b, 255));
+			pixels[y * Width + x] = 0xFF000000 | (r << 16) | (g << 8) | b;
+		}
+	}
+}
+
+// peak signal to noise ratio (dB) of the RGB channels; if Blurred is true both images are first filtered with
+// a 3x3 box, that is a rough model of how the eye averages dithering patterns
+static GDouble QuantizePSNR(const GPixelMap& Original, const GPixelMap& Paletted, const GBool Blurred) {
+
+	const GUInt32 *src = (const GUInt32 *)Original.Pixels();
+	const GUChar8 *idx = Paletted.Pixels();
+	const GUInt32 *pal = Paletted.Palette();
+	GInt32 w = Original.Width(), h = Original.Height(), r = (Blurred) ? 1 : 0;
+	GInt32 x, y, i, j, k, c1, c2;
+	GDouble d, err = 0;
+
+	for (y = r; y < h - r; ++y)
+		for (x = r; x < w - r; ++x)
+			for (k = 0; k < 24; k += 8) {
+				c1 = c2 = 0;
+				for (j = -r; j <= r; ++j)
+					for (i = -r; i <= r; ++i) {
+						c1 += (src[(y + j) * w + x + i] >> k) & 0xFF;
+						c2 += (pal[idx[(y + j) * w + x + i]] >> k) & 0xFF;
+					}
+				d = (GDouble)(c1 - c2) / (GDouble)((2 * r + 1) * (2 * r + 1));
+				err += d * d;
+			}
+	err /= 3.0 * (w - 2 * r) * (h - 2 * r);
+	if (err <= 0)
+		return 99.0;
+	return 10.0 * GMath::Log10(255.0 * 255.0 / err);
+}
+
+void TestQuantize() {
+
+	const GUInt32 width = 2048, height = 2048;
+	const GUInt32 colors[2] = { 256, 16 };
+	const GDitherMode modes[3] = { G_NO_DITHER, G_ORDERED_DITHER, G_FLOYD_STEINBERG_DITHER };
+	const GChar8 *modeNames[3] = { "none", "Bayer", "Floyd-Steinberg" };
+	GThreadPool pool;
+	GPixelMap image, single, pooled;
+	GUInt32 c, m, i, badIndexes, differences;
+	GDouble t0, tSingle, tPooled;
+
+	QuantizeTestImage(image, width, height);
+	printf("\n\nColor quantization of a %dx%d image (%d threads in the pool):\n", width, height, pool.ThreadsCount());
+	printf("    colors  dither            1 thread  pool (ms)  PSNR  blurred PSNR (dB)  pool differences\n");
+	for (c = 0; c < 2; ++c) {
+		for (m = 0; m < 3; ++m) {
+			t0 = WallClockMs();
+			image.Quantize(single, colors[c], modes[m]);
+			tSingle = WallClockMs() - t0;
+			t0 = WallClockMs();
+			image.Quantize(pooled, colors[c], modes[m], 2, &pool);
+			tPooled = WallClockMs() - t0;
+			// every index must refer to one of the requested colors
+			badIndexes = 0;
+			for (i = 0; i < width * height; ++i)
+				badIndexes += (single.Pixels()[i] >= colors[c]) ? 1 : 0;
+			differences = DifferentBytes(single.Pixels(), pooled.Pixels(), width * height) +
+						  DifferentBytes((const GUChar8 *)single.Palette(), (const GUChar8 *)pooled.Palette(), 256 * 4);
+			printf("    %6d  %-16s %9.1f %10.1f %5.2f %18.2f %17d\n", colors[c], modeNames[m], tSingle, tPooled,
+				   QuantizePSNR(image, single, G_FALSE), QuantizePSNR(image, single, G_TRUE), differences);
+			if (badIndexes > 0)
+				printf("    %d pixels refer to a palette entry out of range!\n", badIndexes);
+		}
+	}
+}
+
 int main(void) {
 
 	kernel = new GKernel();
@@ -437,6 +1517,15 @@ int main(void) {
 	TestIntersect();
 	TestDistance();
 	TestProxies();
+	TestSVGPathParser();
+	TestTesselator();
+	TestMatrixOps();
+	TestFontLabelling();
+	TestBatchQuery();
+	TestSpatialContainers();
+	TestRowConverters();
+	TestBSplineFit();
+	TestQuantize();
 	delete kernel;
 	return 0;
 }
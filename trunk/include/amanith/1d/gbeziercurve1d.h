@@ -254,6 +254,20 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GReal Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the curve at several domain parameters, see GCurve1D::Evaluate().
+
+			\note curves up to degree 4 are converted once into power basis form, then evaluated with the
+			Horner scheme.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters, see GCurve1D::Derivative().
+
+			\note forward differences are converted once into power basis form (up to degree 4), then evaluated
+			with the Horner scheme.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const;
 		/*!
 			Cubic Bezier to Hermite conversion.
 
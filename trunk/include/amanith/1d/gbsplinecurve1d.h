@@ -187,8 +187,14 @@ namespace Amanith {
 		// return true if B-spline is clamped (first and last knots have a multiplicity greater or equal to
 		// the degree)
 		GBool IsClamped() const;
-		//! Resolve banded system for B-spline fitting.
-		static GError SolveBandedSystem(const GDynArray<GReal>& BasisMatrix, const GInt32 MatrixSize,
+		/*!
+			Resolve banded system for B-spline fitting.
+
+			The matrix is given in compact form: row i is stored at CompactMatrix[i * (LeftSemiBandWidth +
+			RightSemiBandWidth + 1)], and element (i, j) is at column j - i + LeftSemiBandWidth of such row. The compact
+			matrix is overwritten by its LU decomposition.
+		*/
+		static GError SolveBandedSystem(GDynArray<GReal>& CompactMatrix, const GInt32 MatrixSize,
 										const GInt32 LeftSemiBandWidth, const GInt32 RightSemiBandWidth,
 										GDynArray<GReal>& Rhs);
 
@@ -219,6 +225,15 @@ namespace Amanith {
 		GInt32 Multiplicity(const GReal u) const;
 		//! Find knot span.
 		GInt32 FindSpan(const GReal u) const;
+		/*!
+			Find knot span, starting the search from a known span.
+
+			\param u the domain parameter.
+			\param SpanHint a span index not greater than the searched one (for example the span of a smaller
+			parameter). If it's not valid, a full search is done.
+			\note when parameters are sorted, this method finds spans in constant (amortized) time.
+		*/
+		GInt32 FindSpan(const GReal u, const GInt32 SpanHint) const;
 		/*!
 			Find at the same time knot span and knot multiplicity.
 
@@ -436,6 +451,18 @@ N_{i,p}(u) = \frac{u - u_i}{u_{i+p} - u_i}N_{i,p-1}(u) + \frac{u_{i+p+1} - u}{u_
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GReal Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the curve at several domain parameters, see GCurve1D::Evaluate().
+
+			\note knot spans are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters, see GCurve1D::Derivative().
+
+			\note knot spans are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const;
 		/*!
 			Construct a B-spline that interpolates given points data.
 
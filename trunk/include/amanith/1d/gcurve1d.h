@@ -92,6 +92,8 @@ namespace Amanith {
 		GError BaseClone(const GElement& Source);
 		//! Static speed evaluation callback (for Length() evaluation).
 		static GReal SpeedEvaluationCallBack(const GReal u, void *Data);
+		//! Static batched speed evaluation callback (for Length() evaluation).
+		static void SpeedsEvaluationCallBack(const GReal *u, GReal *Speeds, const GUInt32 Count, void *Data);
 
 	public:
 		//! Default constructor, constructs and empty curve.
@@ -149,6 +151,26 @@ namespace Amanith {
 			\note <b>this method must be implemented by all derived classes</b>.
 		*/
 		virtual GReal Derivative(const GDerivativeOrder Order, const GReal u) const = 0;
+		/*!
+			Evaluate the curve at several domain parameters.
+
+			\param Params the domain parameters at witch we wanna evaluate curve values.
+			\param Out the output values, one for each parameter. The array is resized to Params size.
+			\note the default implementation calls Evaluate() for each parameter; derived classes walk their
+			spans (or keys) incrementally, so sorted parameters are evaluated faster.
+		*/
+		virtual void Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters.
+
+			\param Order the order of derivative
+			\param Params the domain parameters at witch we wanna evaluate curve derivatives.
+			\param Out the output derivatives, one for each parameter. The array is resized to Params size.
+			\note the default implementation calls Derivative() for each parameter; derived classes walk their
+			spans (or keys) incrementally, so sorted parameters are evaluated faster.
+		*/
+		virtual void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params,
+								GDynArray<GReal>& Out) const;
 		/*!
 			Giving CurvePos = Length(t), this function solves for t = Inverse(Length(s))
 
@@ -179,7 +201,7 @@ namespace Amanith {
 			\f]
 
 
-			This implementation uses a Romberg integration schema.
+			This implementation uses an adaptive Gauss-Kronrod integration schema.
 
 			\param u0 the lower bound of integral
 			\param u1 the upper bound of integral
@@ -30,6 +30,7 @@
 #define GANIMTRSNODE2D_H
 
 #include "amanith/gelement.h"
+#include "amanith/support/gthreadpool.h"
 
 /*!
 	\file ganimtrsnode2d.h
@@ -58,7 +59,10 @@ namespace Amanith {
 
 		A TRS node can have a father and children, as well none of them. If a father is linked, all internal
 		animated TRS track are stored relative to father's coordinate system. A local pivot point (intended as a
-		full TRS point) is also supported.
+		full TRS point) is also supported.\n
+		Besides the exact (and uncached) Matrix() function, a whole hierarchy can be evaluated in a single top-down
+		pass through EvaluateHierarchy(); every node keeps its local and world matrices, together with their
+		validity intervals, so that unchanged (or not animated) nodes are not re-evaluated at each frame.
 	*/
 	class G_EXPORT GAnimTRSNode2D : public GAnimElement {
 
@@ -75,6 +79,37 @@ namespace Amanith {
 		GDynArray<GAnimTRSNode2D *>gChildren;
 		//! Associated custom/user data
 		void *gCustomData;
+		/*!
+			Resolved TRS properties: position "x" and "y", rotation, scale "x" and "y" (in this order). They
+			are all NULL if the node does not contain a "transform" property.
+		*/
+		GProperty *gTRSProperties[5];
+		//! Time position of the last EvaluateHierarchy() that has updated this node.
+		GTimeValue gCacheTime;
+		//! Cached local matrix.
+		GMatrix33 gLocalMatrix;
+		//! Validity interval of cached local matrix.
+		GTimeInterval gLocalValidInterval;
+		//! Cached world matrix.
+		GMatrix33 gWorldMatrix;
+		//! Validity interval of cached world matrix.
+		GTimeInterval gWorldValidInterval;
+		//! G_TRUE if cached local matrix must be re-evaluated, regardless of its validity interval.
+		GBool gCacheDirty;
+
+		//! Resolve TRS properties pointers, looking for them by name.
+		void ResolveTRSProperties();
+		//! Evaluate local matrix through resolved properties; ValidInterval is intersected with matrix validity.
+		GError LocalMatrix(const GTimeValue TimePos, GMatrix33& Result, GTimeInterval& ValidInterval) const;
+		/*!
+			Update cached matrices of this node only. FatherMatrix and FatherValid are the (already evaluated) world
+			matrix of the father and its validity interval; a NULL FatherMatrix means identity (root node).
+		*/
+		void UpdateCache(const GTimeValue TimePos, const GMatrix33 *FatherMatrix, const GTimeInterval& FatherValid);
+		//! Update cached matrices of this node and of all its descendants, in a single depth-first traversal.
+		void UpdateCacheHierarchy(const GTimeValue TimePos, const GMatrix33 *FatherMatrix, const GTimeInterval& FatherValid);
+		//! Thread pool job, it updates a subtree collected by EvaluateHierarchy().
+		static void UpdateSubtreeJob(void *Data, const GUInt32 JobIndex);
 
 	protected:
 		//! Move all position keys by an additive offset vector.
@@ -217,6 +252,49 @@ namespace Amanith {
 			settings.
 		*/
 		GError SetPivotScale(const GVectBase<GReal, 2>& NewScaleFactors, const GBool AffectChildren = G_TRUE);
+		/*!
+			Evaluate local and world matrices of this node and of all its descendants, at the specified time.
+
+			The hierarchy is visited once, top-down: a local matrix is re-evaluated only if the node has been
+			modified or if TimePos falls outside its validity interval, while world matrices are always built
+			multiplying the father's (just updated) world matrix by the local one. Results can be read through
+			CachedMatrix() and CachedValidInterval().
+
+			\param TimePos the time position.
+			\param Pool an optional thread pool; if specified (and it has more than one thread), different
+			subtrees are evaluated in parallel.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note Properties of different nodes must not be shared, and the hierarchy must not be modified
+			during the evaluation.
+		*/
+		GError EvaluateHierarchy(const GTimeValue TimePos, GThreadPool *Pool = NULL);
+		/*!
+			Get the matrix (pivot excluded) calculated by the last EvaluateHierarchy() involving this node.
+			It is the same matrix returned by Matrix(CachedTime(), Space, ...).
+		*/
+		inline const GMatrix33& CachedMatrix(const GSpaceSystem Space) const {
+			if (Space == G_WORLD_SPACE)
+				return gWorldMatrix;
+			return gLocalMatrix;
+		}
+		//! Get the validity interval of the cached matrix.
+		inline const GTimeInterval& CachedValidInterval(const GSpaceSystem Space) const {
+			if (Space == G_WORLD_SPACE)
+				return gWorldValidInterval;
+			return gLocalValidInterval;
+		}
+		//! Get the time position of the last EvaluateHierarchy() involving this node.
+		inline GTimeValue CachedTime() const {
+			return gCacheTime;
+		}
+		/*!
+			Force the re-evaluation of local matrix at the next EvaluateHierarchy(). Node functions that
+			modify TRS tracks already do it, so this must be called only when TRS properties have been
+			modified directly (for example by setting keys through Property("transform")).
+		*/
+		inline void InvalidateMatrixCache() {
+			gCacheDirty = G_TRUE;
+		}
 		//! Get class descriptor
 		inline const GClassID& ClassID() const {
 			return G_ANIMTRSNODE2D_CLASSID;
@@ -118,6 +118,8 @@ namespace Amanith {
 			\note The interval is ensured to be completely inside the curve domain.
 		*/
 		GReal Variation(const GReal u0, const GReal u1,	const GPoint2& p0, const GPoint2& p1) const;
+		//! Get control points array for in place modification; the curve is considered modified.
+		GPoint2 *PointsBuffer();
 
 		//! Returns the number of intersection between control polygon and X axis.
 		GInt32 CrossingCountX() const;
@@ -432,6 +434,30 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the curve at several domain parameters, see GCurve2D::Evaluate().
+
+			\note curves up to degree 4 are converted once into power basis form, then evaluated with the
+			Horner scheme.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters, see GCurve2D::Derivative().
+
+			\note forward differences are converted once into power basis form (up to degree 4), then evaluated
+			with the Horner scheme.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const;
+		/*!
+			Returns the length of the curve between the 2 specified global domain values.
+
+			\param u0 the lower bound of integral
+			\param u1 the upper bound of integral
+			\param MaxError the maximum relative error (precision) at witch we wanna calculate length.
+			\return The length of curve, calculated in the domain interval [u0; u1].
+			\note linear and quadratic curves are measured in closed form, so MaxError is not used for them.
+		*/
+		GReal Length(const GReal u0, const GReal u1, const GReal MaxError = G_EPSILON) const;
 		/*!
 			Cubic Bezier to Hermite conversion.
 
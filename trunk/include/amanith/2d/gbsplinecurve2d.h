@@ -31,7 +31,7 @@
 
 /*!
 	\file gbsplinecurve2d.h
-	\brief Header file for 2D BSpline curve class.
+	\brief Header file for 2D BSpline curve and BSpline fitter classes.
 */
 
 #include "amanith/2d/gcurve2d.h"
@@ -39,6 +39,7 @@
 
 namespace Amanith {
 
+	class GBSplineCurveFitter2D;
 
 	// *********************************************************************
 	//                           GBSplineCurve2D
@@ -87,6 +88,8 @@ namespace Amanith {
 	*/
 	class G_EXPORT GBSplineCurve2D : public GCurve2D {
 
+		friend class GBSplineCurveFitter2D;
+
 	private:
 		//! Curve degree
 		GInt32 gDegree;
@@ -162,6 +165,8 @@ namespace Amanith {
 			\note The interval is ensured to be completely inside the curve domain.
 		*/
 		GReal Variation(const GReal u0, const GReal u1,	const GPoint2& p0, const GPoint2& p1) const;
+		//! Get control points array for in place modification; the curve is considered modified.
+		GPoint2 *PointsBuffer();
 		/*
 			Flats the curve specifying a max error/variation (squared chordal distance).
 
@@ -223,8 +228,14 @@ namespace Amanith {
 		// return true if B-spline is clamped (first and last knots have a multiplicity greater or equal to
 		// the degree)
 		GBool IsClamped() const;
-		//! Resolve banded system for B-spline fitting.
-		static GError SolveBandedSystem(const GDynArray<GReal>& BasisMatrix, const GInt32 MatrixSize,
+		/*!
+			Resolve banded system for B-spline fitting.
+
+			The matrix is given in compact form: row i is stored at CompactMatrix[i * (LeftSemiBandWidth +
+			RightSemiBandWidth + 1)], and element (i, j) is at column j - i + LeftSemiBandWidth of such row. The compact
+			matrix is overwritten by its LU decomposition.
+		*/
+		static GError SolveBandedSystem(GDynArray<GReal>& CompactMatrix, const GInt32 MatrixSize,
 										const GInt32 LeftSemiBandWidth, const GInt32 RightSemiBandWidth,
 										GDynArray<GPoint2>& Rhs);
 
@@ -255,6 +266,15 @@ namespace Amanith {
 		GInt32 Multiplicity(const GReal u) const;
 		//! Find knot span.
 		GInt32 FindSpan(const GReal u) const;
+		/*!
+			Find knot span, starting the search from a known span.
+
+			\param u the domain parameter.
+			\param SpanHint a span index not greater than the searched one (for example the span of a smaller
+			parameter). If it's not valid, a full search is done.
+			\note when parameters are sorted, this method finds spans in constant (amortized) time.
+		*/
+		GInt32 FindSpan(const GReal u, const GInt32 SpanHint) const;
 		/*!
 			Find at the same time knot span and knot multiplicity.
 
@@ -528,6 +548,18 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the curve at several domain parameters, see GCurve2D::Evaluate().
+
+			\note knot spans are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters, see GCurve2D::Derivative().
+
+			\note knot spans are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const;
 		/*!
 			Construct a B-spline that interpolates given points data.
 
@@ -594,6 +626,28 @@ namespace Amanith {
 		*/
 		GError GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>& FitPoints, const GDynArray<GVector2>& Derivatives,
 						 const GReal MinKnotValue = 0, const GReal MaxKnotValue = 1);
+		/*!
+			Construct a B-spline that approximates given points data in the (weighted) least-squares sense.
+
+			Fit points are chord-length parametrized, and knots are placed so that every knot span contains at least
+			one parameter; then the sum of weighted squared distances between fit points and the corresponding curve
+			points is minimized. End points are not interpolated: just give them a larger weight to pull the curve
+			closer to them.
+
+			\param Degree the degree of the approximating B-spline.
+			\param ControlPointsCount the number of control points of the approximating B-spline; it must be greater
+			than Degree and not greater than the number of fit points.
+			\param FitPoints the points array to approximate.
+			\param Weights a (non negative) weight for each fit point; if empty, all points have a unit weight.
+			\param MinKnotValue lower bound of the approximating B-spline's domain.
+			\param MaxKnotValue upper bound of the approximating B-spline's domain.
+			\return G_NO_ERROR if the operation succeeds, else an error code.
+			\note the banded normal equations are solved by Cholesky decomposition, so time and memory are linear in the
+			number of fit points. Use GBSplineCurveFitter2D to refine the solution when new points come.
+		*/
+		GError LeastSquaresFit(const GInt32 Degree, const GInt32 ControlPointsCount,
+							   const GDynArray<GPoint2>& FitPoints, const GDynArray<GReal>& Weights,
+							   const GReal MinKnotValue = 0, const GReal MaxKnotValue = 1);
 		//! Get class descriptor.
 		inline const GClassID& ClassID() const {
 			return G_BSPLINECURVE2D_CLASSID;
@@ -633,6 +687,145 @@ namespace Amanith {
 	//! Static proxy for GBSplineCurve2D class.
 	static const GBSplineCurve2DProxy G_BSPLINECURVE2D_PROXY;
 
+
+	// *********************************************************************
+	//                        GBSplineCurveFitter2D
+	// *********************************************************************
+
+	/*!
+		\class GBSplineCurveFitter2D
+		\brief Incremental least-squares B-spline approximation of 2D points.
+
+		The knots vector (and so the number of control points) is fixed in advance; then samples, each one made of a
+		domain parameter, a point and a weight, can be added (or removed) one at a time. Every sample updates the
+		banded normal equations in O(Degree^2) time, so a curve can be refit with Solve() at any moment without
+		looking at the samples again. Solve() takes O(n * Degree^2) time, where n is the number of control points.\n
+		Every control point must be influenced by some sample, else the system is singular; a smoothing term, that
+		penalizes the length of the control polygon, can be used to fix that and to regularize noisy data.
+	*/
+	class G_EXPORT GBSplineCurveFitter2D {
+
+	private:
+		//! Degree of fitting curves.
+		GInt32 gDegree;
+		//! Uniform / non-uniform flag, referred to the knots vector.
+		GBool gUniform;
+		//! Knots vector (clamped).
+		GDynArray<GReal> gKnots;
+		//! Normal equations matrix, symmetric and banded: row i stores elements (i, i)..(i, i + Degree).
+		GDynArray<GReal> gNormalMatrix;
+		//! Normal equations right hand side.
+		GDynArray<GPoint2> gNormalRhs;
+		//! Internal support array, for basis functions evaluation.
+		GDynArray<GReal> gBasisFuncEval;
+		//! Weight of the control polygon length penalty.
+		GReal gSmoothing;
+		//! Number of added (minus removed) samples.
+		GInt32 gSamplesCount;
+		//! Last found knot span, used to speed up span search when samples come sorted by parameter.
+		GInt32 gLastSpan;
+
+		// find knot span that contains the specified parameter
+		GInt32 FindSpan(const GReal u);
+		// evaluate non-vanishing basis functions for a given span index
+		const GReal* BasisFunctions(const GInt32 SpanIndex, const GReal u);
+		// accumulate a weighted sample into normal equations
+		GError Accumulate(const GReal Parameter, const GPoint2& Point, const GReal Weight);
+
+	public:
+		//! Constructor, it builds a fitter without knots.
+		GBSplineCurveFitter2D();
+		/*!
+			Set degree and knots of fitting curves; all samples are discarded.
+
+			\param Degree the degree of fitting curves, it must be greater than 0.
+			\param Knots a not decreasing, clamped knots vector (first and last knots must have multiplicity
+			Degree + 1); the number of control points is the number of knots minus Degree + 1.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_PARAMETER otherwise.
+		*/
+		GError SetKnots(const GInt32 Degree, const GDynArray<GReal>& Knots);
+		/*!
+			Set degree and a uniform, clamped, knots vector for fitting curves; all samples are discarded.
+
+			\param Degree the degree of fitting curves, it must be greater than 0.
+			\param ControlPointsCount number of control points, it must be greater than Degree.
+			\param MinKnotValue lower bound of fitting curves domain.
+			\param MaxKnotValue upper bound of fitting curves domain.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_PARAMETER otherwise.
+		*/
+		GError SetUniformKnots(const GInt32 Degree, const GInt32 ControlPointsCount,
+							   const GReal MinKnotValue = 0, const GReal MaxKnotValue = 1);
+		//! Discard all samples, knots are kept.
+		void Reset();
+		/*!
+			Add a sample.
+
+			\param Parameter the domain parameter associated to the point, it must be inside knots range.
+			\param Point the point to approximate.
+			\param Weight the (non negative) sample weight.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note adding samples sorted by parameter is faster, because knot spans are searched starting from the
+			last found one.
+		*/
+		GError AddSample(const GReal Parameter, const GPoint2& Point, const GReal Weight = 1);
+		/*!
+			Add an array of samples.
+
+			\param Parameters the domain parameters associated to the points.
+			\param Points the points to approximate, one for each parameter.
+			\param Weights the (non negative) weight of each sample; if empty, all samples have a unit weight.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise. In case of error, no sample is
+			added.
+		*/
+		GError AddSamples(const GDynArray<GReal>& Parameters, const GDynArray<GPoint2>& Points,
+						  const GDynArray<GReal>& Weights);
+		/*!
+			Remove a previously added sample (for example to implement a sliding window over a stream of points).
+
+			\param Parameter the domain parameter used to add the sample.
+			\param Point the point used to add the sample.
+			\param Weight the weight used to add the sample.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note removing a sample never added is not detected, and it leads to wrong results.
+		*/
+		GError RemoveSample(const GReal Parameter, const GPoint2& Point, const GReal Weight = 1);
+		/*!
+			Set the weight of the control polygon length penalty.
+
+			A zero value (the default) gives a pure least-squares fit. A value comparable to the weight of a single
+			sample is enough to make the system solvable when some control points are not influenced by any sample.
+		*/
+		void SetSmoothing(const GReal Smoothing);
+		//! Get the weight of the control polygon length penalty.
+		inline GReal Smoothing() const {
+			return gSmoothing;
+		}
+		//! Get the degree of fitting curves.
+		inline GInt32 Degree() const {
+			return gDegree;
+		}
+		//! Get the knots vector of fitting curves.
+		inline const GDynArray<GReal>& Knots() const {
+			return gKnots;
+		}
+		//! Get the number of control points of fitting curves.
+		inline GInt32 PointsCount() const {
+			return (GInt32)gNormalRhs.size();
+		}
+		//! Get the number of samples added so far (removed ones are not counted).
+		inline GInt32 SamplesCount() const {
+			return gSamplesCount;
+		}
+		/*!
+			Build the curve that best approximates the samples added so far.
+
+			\param Curve the output B-spline.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_OPERATION if knots have not been set or if the
+			system is singular (some control points are not influenced by samples, and no smoothing is used).
+		*/
+		GError Solve(GBSplineCurve2D& Curve) const;
+	};
+
 };	// end namespace Amanith
 
 #endif
@@ -122,6 +122,19 @@ namespace Amanith {
 		GError BaseClone(const GElement& Source);
 		//! Static speed evaluation callback (for Length() evaluation).
 		static GReal SpeedEvaluationCallBack(const GReal u, void *Data);
+		//! Static batched speed evaluation callback (for Length() evaluation).
+		static void SpeedsEvaluationCallBack(const GReal *u, GReal *Speeds, const GUInt32 Count, void *Data);
+		/*!
+			Get a writable pointer to curve points, if they are stored as a contiguous array of PointsCount() entries.
+
+			XForm() uses it to transform all points with a single GBulkXForm call, instead of going through
+			Point()/SetPoint() for each point. The default implementation returns NULL.
+			\note a derived class that returns its own array must consider the curve as modified, because the
+			caller is going to write into it.
+		*/
+		virtual GPoint2 *PointsBuffer() {
+			return NULL;
+		}
 
 	public:
 		//! Default constructor, constructs and empty curve.
@@ -209,6 +222,26 @@ namespace Amanith {
 			\note <b>this method must be implemented by all derived classes</b>.
 		*/
 		virtual GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const = 0;
+		/*!
+			Evaluate the curve at several domain parameters.
+
+			\param Params the domain parameters at witch we wanna evaluate curve values.
+			\param Out the output values, one for each parameter. The array is resized to Params size.
+			\note the default implementation calls Evaluate() for each parameter; derived classes walk their
+			spans (or keys) incrementally, so sorted parameters are evaluated faster.
+		*/
+		virtual void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters.
+
+			\param Order the order of derivative
+			\param Params the domain parameters at witch we wanna evaluate curve derivatives.
+			\param Out the output derivatives, one for each parameter. The array is resized to Params size.
+			\note the default implementation calls Derivative() for each parameter; derived classes walk their
+			spans (or keys) incrementally, so sorted parameters are evaluated faster.
+		*/
+		virtual void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params,
+								GDynArray<GVector2>& Out) const;
 		/*!
 			Giving CurvePos = Length(t), this function solves for t = Inverse(Length(s))
 
@@ -239,7 +272,7 @@ namespace Amanith {
 			\f]
 
 
-			This implementation uses a Romberg integration schema.
+			This implementation uses an adaptive Gauss-Kronrod integration schema.
 
 			\param u0 the lower bound of integral
 			\param u1 the upper bound of integral
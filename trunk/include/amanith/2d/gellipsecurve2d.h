@@ -263,6 +263,10 @@ namespace Amanith {
 		inline GBool LargeArc() const {
 			return GEllipseCurve2D::IsLargeArc(gStartAngle, gEndAngle, gCCW);
 		}
+		//! Return G_TRUE if the ellipse arc goes from StartAngle to EndAngle in counter-clockwise direction.
+		inline GBool CCW() const {
+			return gCCW;
+		}
 		/*!
 			Get variation (squared chordal distance) in the current domain range.
 		*/
@@ -283,6 +287,21 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const;
+		//! Evaluate the curve at several domain parameters, see GCurve2D::Evaluate().
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		//! Evaluate the curve derivative at several domain parameters, see GCurve2D::Derivative().
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const;
+		/*!
+			Returns the length of the curve between the 2 specified global domain values.
+
+			\param u0 the lower bound of integral
+			\param u1 the upper bound of integral
+			\param MaxError the maximum relative error (precision) at witch we wanna calculate length.
+			\return The length of curve, calculated in the domain interval [u0; u1].
+			\note circular arcs have a constant speed, so they are measured in closed form and MaxError is not
+			used for them.
+		*/
+		GReal Length(const GReal u0, const GReal u1, const GReal MaxError = G_EPSILON) const;
 		/*!
 			Translates ellipse, specifying a vector offset.
 
@@ -119,6 +119,16 @@ Legend:  O on curve  + off curve
 	public:
 		//! Set constructor, build a new contour specifying main points and their associated flags
 		GFontCharContour2D(const GDynArray<GPoint2>& NewPoints, const GDynArray<GInt32>& PointsFlags);
+		/*!
+			Set constructor, build a contour from already processed points and flags, for example taken from a
+			contour of an initialized character. Points are not cleaned, and the hole flag is taken as is.
+
+			\param NewPoints main points, in the right winding order for the specified hole flag.
+			\param PointsFlags flags associated to points.
+			\param IsHole G_TRUE if the contour is an hole, G_FALSE otherwise.
+		*/
+		GFontCharContour2D(const GDynArray<GPoint2>& NewPoints, const GDynArray<GInt32>& PointsFlags,
+						   const GBool IsHole);
 		//! Copy constructor.
 		GFontCharContour2D(const GFontCharContour2D& Source);
 		//! Destructor
@@ -296,7 +306,13 @@ Legend:  O on curve  + off curve
 		void DeleteContours();
 		//! Label a single contour as hole or solid (using the crossing line algorithm)
 		void LabelContour(const GFontCharContour2D& Contour) const;
-		//! Label every contours as hole or solid (using the crossing line algorithm)
+		/*!
+			Label every contours as hole or solid.
+
+			Contours are swept by the left side of their bounding boxes, so only contours whose box contains the box
+			of a contour are tested as its containers. Containment is tested with a horizontal ray against the
+			y-monotone arcs of the containers, without any flattening.
+		*/
 		void LabelHolesAndFilled() const;
 		//! Swap (toggle) internal hole/solid flag (assigned by the LabelHolesAndFilled() function) according to passed flag.
 		void SwapHolesAndFilledLabels(const GBool EvenOddFlag) const;
@@ -307,8 +323,11 @@ Legend:  O on curve  + off curve
 
 			\param Owner the font that has created this character.
 			\param Contours the array of closed contours that will build the new plain character.
+			\param Labeled if G_TRUE, contours are already labeled as holes or solids and oriented accordingly, so
+			the character won't be initialized again.
 		*/
-		GFontChar2D(const GFont2D* Owner, const GDynArray<GFontCharContour2D>& Contours);
+		GFontChar2D(const GFont2D* Owner, const GDynArray<GFontCharContour2D>& Contours,
+					const GBool Labeled = G_FALSE);
 		/*!
 			Set constructor, build a 'composite' character.
 
@@ -610,8 +629,14 @@ Legend:  O on curve  + off curve
 		GInt32 CharsCount() const {
 			return (GInt32)gChars.size();
 		}
-		//! Add new char to this font, specifying contours.
-		GFontChar2D* AddChar(const GDynArray<GFontCharContour2D>& Contours);
+		/*!
+			Add new char to this font, specifying contours.
+
+			\param Contours the closed contours that build the character.
+			\param Labeled if G_TRUE, contours are already labeled as holes or solids and oriented accordingly (for
+			example they come from a pre-processed font file), so hole labelling is skipped.
+		*/
+		GFontChar2D* AddChar(const GDynArray<GFontCharContour2D>& Contours, const GBool Labeled = G_FALSE);
 		//! Add a new char to this font, specifying sub-characters
 		GFontChar2D* AddChar(const GDynArray<GSubChar2D>& SubChars);
 		//! Remove a char from this font.
@@ -686,6 +711,10 @@ Legend:  O on curve  + off curve
 		}
 		//! Set kerning informations for this font.
 		void SetKerning(const GDynArray<GKerningEntry>& NewKerningTable);
+		//! Get the kerning table, sorted by left glyph index and then by right glyph index.
+		inline const GDynArray<GKerningEntry>& KerningTable() const {
+			return gKerningTable;
+		}
 		//! Get kerning vector, specifying the couple of(glyphs)index.
 		const GPoint2& KerningByIndex(const GUInt32 LeftIndex, const GUInt32 RightIndex) const;
 		//! Get kerning vector, specifying the couple of character codes and the charsmap to use for mapping.
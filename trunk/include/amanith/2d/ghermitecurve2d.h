@@ -258,6 +258,8 @@ namespace Amanith {
 		void SegmentToBezierConversion(const GUInt32 Index, GBezierCurve2D& Result) const;
 		// static speed evaluation callback (useful for length evaluation)
 		static GReal SegmentSpeedEvaluationCallBack(const GReal u, void *Data);
+		// static batched speed evaluation callback (useful for length evaluation)
+		static void SegmentSpeedsEvaluationCallBack(const GReal *u, GReal *Speeds, const GUInt32 Count, void *Data);
 		/*!
 			Get domain parameter corresponding to specified (key)point index.
 			Index is ensured to be valid.
@@ -308,6 +310,17 @@ namespace Amanith {
 			check this case before calling ParamToKeyIndex.
 		*/
 		GBool ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex) const;
+		/*!
+			Given a domain value, it returns the span index that includes it, starting the search from a known
+			key index.
+
+			\param Param the domain parameter
+			\param KeyIndex the lower key index of the interval where Param is included.
+			\param KeyIndexHint a key index not greater than the searched one (for example the one found for
+			a smaller parameter); if the searched index is far from it, a binary search is done.
+			\return G_TRUE if the domain value is inside the current domain, G_FALSE otherwise.
+		*/
+		GBool ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex, const GUInt32 KeyIndexHint) const;
 		//! Get Index-th key point; Index must be valid, else a point with infinitive components is returned.
 		GPoint2 Point(const GUInt32 Index) const;
 		//! Set Index-th (key)point; Index must be valid.
@@ -429,6 +442,18 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the curve at several domain parameters, see GCurve2D::Evaluate().
+
+			\note keys are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters, see GCurve2D::Derivative().
+
+			\note keys are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const;
 		/*!
 			Return the curve derivative calculated at specified domain parameter. This method differs from
 			the one of base GCurve2D class in the number of returned values. This is due to the possibility
@@ -295,6 +295,20 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the path at several domain parameters, see GCurve2D::Evaluate().
+
+			\note consecutive parameters that fall inside the same segment are passed to it with a single
+			batched call, so sorted parameters are evaluated faster.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		/*!
+			Evaluate the path derivative at several domain parameters, see GCurve2D::Derivative().
+
+			\note consecutive parameters that fall inside the same segment are passed to it with a single
+			batched call, so sorted parameters are evaluated faster.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const;
 		/*!
 			Return the path derivative calculated at specified domain parameter. This method differs from
 			the one of base GCurve2D class in the number of returned values. This is due to the possibility
@@ -0,0 +1,317 @@
+/****************************************************************************
+** $file: amanith/2d/gpathdata.h   0.3.0.0   edited Jan, 30 2006
+**
+** 2D compact path data definition.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GPATHDATA_H
+#define GPATHDATA_H
+
+#include "amanith/2d/gpath2d.h"
+#include "amanith/geometry/gaabox.h"
+
+/*!
+	\file gpathdata.h
+	\brief Header file for 2D compact path data class.
+*/
+namespace Amanith {
+
+	class GKernel;
+
+	//! Path data verbs.
+	enum GPathVerb {
+		//! Begin a new contour; it takes 1 point.
+		G_MOVE_TO_VERB,
+		//! Line; it takes 1 point (the end point).
+		G_LINE_TO_VERB,
+		//! Quadratic Bezier curve; it takes 2 points (control point and end point).
+		G_QUAD_TO_VERB,
+		//! Cubic Bezier curve; it takes 3 points (two control points and end point).
+		G_CUBIC_TO_VERB,
+		//! Elliptical arc; it takes 4 points (center, the ends of two conjugate semi-diameters, end point) and 2 angles.
+		G_ARC_TO_VERB,
+		//! Close the current contour; it takes no points.
+		G_CLOSE_VERB
+	};
+
+	// *********************************************************************
+	//                             GPathFlattener
+	// *********************************************************************
+
+	/*!
+		\class GPathFlattener
+		\brief Flattens path commands directly into contours, without building any curve object.
+
+		Bezier curves are flattened using Wang's formula and forward differencing, elliptical arcs with a constant
+		angular step. Contours made of a single point are discarded, closed contours don't repeat their first point.
+	*/
+	class G_EXPORT GPathFlattener {
+
+	private:
+		GDynArray<GPoint2>& gPoints;
+		GDynArray<GInt32>& gPointsPerContour;
+		GDynArray<GBool>& gClosedContours;
+		// maximum (not squared) chordal distance
+		GReal gFlatness;
+		// index of the first point of the current contour
+		GInt32 gContourStart;
+		GPoint2 gCursor;
+
+		// number of segments that keep a Bezier curve within flatness (Wang's formula)
+		GInt32 SegmentsCount(const GReal Coefficient, const GReal SecondDifference) const;
+		// close the current contour, discarding it if made of a single point
+		void EndContour(const GBool Closed);
+
+	public:
+		/*!
+			Constructor, new points and contours are appended to the specified arrays.
+
+			\param Points output points.
+			\param PointsPerContour for each output contour, the number of its points.
+			\param ClosedContours for each output contour, G_TRUE if it has been closed.
+			\param MaxDeviation maximum squared chordal distance, it must be positive.
+		*/
+		GPathFlattener(GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+					   GDynArray<GBool>& ClosedContours, const GReal MaxDeviation);
+		//! Begin a new contour.
+		void MoveTo(const GPoint2& P);
+		//! Line from the current point to P.
+		void LineTo(const GPoint2& P);
+		//! Quadratic Bezier curve from the current point to P, with control point P1.
+		void QuadTo(const GPoint2& P1, const GPoint2& P);
+		//! Cubic Bezier curve from the current point to P, with control points P1 and P2.
+		void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P);
+		/*!
+			Elliptical arc from the current point to P; arc points are Center + U * cos(t) + V * sin(t), where t goes
+			from StartAngle to StartAngle + SweepAngle.
+		*/
+		void ArcTo(const GPoint2& Center, const GVector2& U, const GVector2& V, const GReal StartAngle,
+				   const GReal SweepAngle, const GPoint2& P);
+		//! Close the current contour.
+		void ClosePath();
+		//! Flush the last contour; it must be called at the end.
+		void Finish();
+	};
+
+	// *********************************************************************
+	//                               GPathData
+	// *********************************************************************
+
+	/*!
+		\class GPathData
+		\brief A compact path, made of verbs and points stored into flat arrays.
+
+		GPathData is a lightweight alternative to GPath2D: segments are not curve objects, so appending is O(1),
+		copying a path is a plain copy of its arrays, and a transformation is a single pass over points.
+		A path data can contain more than one contour; every contour starts with a G_MOVE_TO_VERB, and it can end
+		with a G_CLOSE_VERB.\n
+		Elliptical arcs are stored as a center and the ends of two conjugate semi-diameters, so they are transformed
+		like all other points. Each arc takes also a start angle and a (signed) sweep angle, stored apart because they
+		don't change under affine transformations: arc points are Center + U * cos(t) + V * sin(t), where U and V are
+		the semi-diameters and t goes from the start angle to the start angle plus the sweep angle.\n
+		Where a curve parameter is needed (see IntersectRay()), it's the index of the verb plus the local [0; 1]
+		parameter of the segment.
+	*/
+	class G_EXPORT GPathData {
+
+	private:
+		//! Verbs, one GPathVerb for each entry.
+		GDynArray<GUChar8> gVerbs;
+		//! Points used by verbs, in the same order.
+		GDynArray<GPoint2> gPoints;
+		//! Start angle and sweep angle of each arc.
+		GDynArray<GReal> gArcAngles;
+		//! Index of the point where the current contour starts.
+		GInt32 gContourStart;
+		//! G_TRUE if a move is needed before next drawing verb (empty path or just closed contour).
+		GBool gNeedMove;
+
+		// begin a contour at the current point, if needed
+		void EnsureContour();
+
+	public:
+		//! Default constructor, creates an empty path.
+		GPathData();
+		//! Remove all verbs and points.
+		void Clear();
+		//! Reserve memory for the specified number of verbs and points.
+		void Reserve(const GUInt32 VerbsCount, const GUInt32 PointsCount);
+		//! Return G_TRUE if the path does not contain any verb.
+		inline GBool IsEmpty() const {
+			return (gVerbs.size() == 0);
+		}
+		//! Get verbs array.
+		inline const GDynArray<GUChar8>& Verbs() const {
+			return gVerbs;
+		}
+		//! Get points array.
+		inline const GDynArray<GPoint2>& Points() const {
+			return gPoints;
+		}
+		//! Get arcs angles array, for each arc its start angle and its sweep angle.
+		inline const GDynArray<GReal>& ArcAngles() const {
+			return gArcAngles;
+		}
+		//! Get the current point, that is the end point of the last verb (the origin for an empty path).
+		GPoint2 CurrentPoint() const;
+		//! Begin a new contour at the specified point.
+		void MoveTo(const GPoint2& P);
+		//! Line from the current point to P.
+		void LineTo(const GPoint2& P);
+		//! Quadratic Bezier curve from the current point to P, with control point P1.
+		void QuadTo(const GPoint2& P1, const GPoint2& P);
+		//! Cubic Bezier curve from the current point to P, with control points P1 and P2.
+		void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P);
+		/*!
+			Elliptical arc, specified by center, semi-axes lengths, offset rotation and angles (like GEllipseCurve2D).
+
+			\param Center center of the ellipse.
+			\param XSemiAxisLength length of x semi-axis.
+			\param YSemiAxisLength length of y semi-axis.
+			\param OffsetRotation x-axis rotation, in radians.
+			\param StartAngle angle where the arc starts.
+			\param SweepAngle angle spanned by the arc, positive values go counter-clockwise.
+			\note if the current point is not the arc start point, a line is added to join them.
+		*/
+		void ArcTo(const GPoint2& Center, const GReal XSemiAxisLength, const GReal YSemiAxisLength,
+				   const GReal OffsetRotation, const GReal StartAngle, const GReal SweepAngle);
+		/*!
+			Elliptical arc from the current point to P, specified like SVG does.
+
+			\param Rx x semi-axis length.
+			\param Ry y semi-axis length.
+			\param XRot x-axis rotation, in radians.
+			\param LargeArc SVG large arc flag.
+			\param Sweep SVG sweep flag (G_TRUE means positive angles direction).
+			\param P arc end point.
+			\note radii too small to join arc ends are scaled up; a zero radius gives a line, and nothing is added if
+			P is the current point.
+		*/
+		void ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+				   const GPoint2& P);
+		//! Close the current contour.
+		void ClosePath();
+		/*!
+			Append a path, converting each one of its segments.
+
+			Lines, polylines, Bezier curves up to degree 3 and ellipse arcs are converted exactly; other curves are
+			flattened into lines.
+
+			\param Path the path to append, as a new contour.
+			\param MaxDeviation maximum squared chordal distance used to flatten curves that can't be converted
+			exactly.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+		*/
+		GError AppendPath(const GPath2D& Path, const GReal MaxDeviation = (GReal)1e-4);
+		/*!
+			Build a GPath2D for each contour.
+
+			Consecutive lines are joined into a single polyline segment, each segment has a unit domain length (a
+			polyline one unit for each of its lines).
+
+			\param Kernel the kernel used to create paths.
+			\param Paths output paths, new paths are appended. The caller is responsible to delete them.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note two consecutive arcs, or an arc that closes a contour starting with another arc, are joined by a
+			degenerate line: GPath2D needs coincident segment ends, and ellipse ends can't be moved without
+			changing the ellipse. AppendPath skips such lines.
+		*/
+		GError ToPaths(GKernel& Kernel, GDynArray<GPath2D *>& Paths) const;
+		/*!
+			Flatten the path into contours.
+
+			\param MaxDeviation maximum squared chordal distance allowed between curves and their flattened version;
+			it must be positive.
+			\param Points output points, new points are appended.
+			\param PointsPerContour for each output contour, the number of its points.
+			\param ClosedContours for each output contour, G_TRUE if it has been closed. Closed contours don't repeat
+			their first point at the end.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_PARAMETER if MaxDeviation is not positive.
+			\note contours made of a single point are discarded.
+		*/
+		GError Flatten(const GReal MaxDeviation, GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+					   GDynArray<GBool>& ClosedContours) const;
+		/*!
+			Calculate the exact bounding box of the path (not the bounding box of control points).
+
+			\param Box the output bounding box.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_OPERATION if the path is empty.
+		*/
+		GError BoundingBox(GAABox2& Box) const;
+		/*!
+			Intersect the path with a normalized ray, closing segments included.
+
+			\param NormalizedRay a normalized ray used for intersection test.
+			\param Intersections every found intersection will be appended to this array. Each intersection is a 2D
+			vector; it has at position 0 the path parameter (verb index plus segment local parameter) and at position
+			1 the ray parameter.
+			\param Precision the precision used to find cubic curves solutions.
+			\param MaxIterations number of max iterations used to refine each cubic curve solution.
+			\return G_TRUE if at least one intersection has been found, G_FALSE otherwise.
+			\note lines, quadratic curves and arcs are intersected analytically.
+		*/
+		GBool IntersectRay(const GRay2& NormalizedRay, GDynArray<GVector2>& Intersections,
+						   const GReal Precision = G_EPSILON, const GUInt32 MaxIterations = 100) const;
+		//! Transform all points by the specified matrix.
+		void XForm(const GMatrix23& Matrix);
+		/*!
+			Transform all points by the specified matrix.
+
+			\note when projection is done, curves are approximated by transforming their control points (as Bezier
+			curves do), arcs by transforming their center and semi-diameters.
+		*/
+		void XForm(const GMatrix33& Matrix, const GBool DoProjection = G_TRUE);
+		/*!
+			Convert the arc center parametrization used by SVG (endpoints, radii and flags) into the one used by
+			this class.
+
+			\return G_FALSE if the arc is degenerate (coincident ends or a zero radius), in this case outputs are
+			not set.
+		*/
+		static GBool ArcCenterParameters(const GPoint2& P0, const GReal Rx, const GReal Ry, const GReal XRot,
+										 const GBool LargeArc, const GBool Sweep, const GPoint2& P1,
+										 GPoint2& Center, GVector2& U, GVector2& V,
+										 GReal& StartAngle, GReal& SweepAngle);
+		/*!
+			Convert conjugate semi-diameters into principal semi-axes.
+
+			\param U first semi-diameter.
+			\param V second semi-diameter.
+			\param StartAngle start angle of the arc, relative to U and V.
+			\param SweepAngle sweep angle of the arc, relative to U and V.
+			\param XSemiAxisLength output length of x semi-axis.
+			\param YSemiAxisLength output length of y semi-axis.
+			\param OffsetRotation output x-axis rotation, in radians.
+			\param NewStartAngle output start angle, relative to principal axes.
+			\param NewSweepAngle output sweep angle, relative to principal axes (positive values go counter-clockwise).
+		*/
+		static void ArcPrincipalAxes(const GVector2& U, const GVector2& V, const GReal StartAngle,
+									 const GReal SweepAngle, GReal& XSemiAxisLength, GReal& YSemiAxisLength,
+									 GReal& OffsetRotation, GReal& NewStartAngle, GReal& NewSweepAngle);
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -35,6 +35,7 @@
 */
 
 #include "amanith/gelement.h"
+#include "amanith/support/gthreadpool.h"
 
 namespace Amanith {
 
@@ -91,6 +92,27 @@ namespace Amanith {
 		G_RESIZE_NORMAL
 	};
 
+	//! Dithering methods available for color quantization
+	enum GDitherMode {
+		//! No dithering, every pixel is mapped to its nearest palette color
+		G_NO_DITHER,
+		//! Ordered dithering, using a 4x4 Bayer matrix
+		G_ORDERED_DITHER,
+		//! Floyd-Steinberg error diffusion dithering
+		G_FLOYD_STEINBERG_DITHER
+	};
+
+	/*!
+		Row converter function type, see GPixelMap::RowConverter.
+
+		\param Src pointer to the first source pixel.
+		\param Dst pointer to the first destination pixel.
+		\param Count number of pixels to convert.
+		\param SrcPalette source color palette; it's used only when source pixel format is G_RGB_PALETTE.
+	*/
+	typedef void (*GPixelRowConverter)(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+									   const GUInt32 *SrcPalette);
+
 	/*!
 		\class GPixelMap
 		\brief A 2D cross-platform bitmap class.
@@ -577,6 +599,43 @@ namespace Amanith {
 			\return G_NO_ERROR if operation succeeds, an error code otherwise.
 		*/
 		GError SetPixelFormat(const GPixelFormat NewPixelFormat, GPixelMap& ConvertedImage) const;
+		/*!
+			Build a paletted version of this image.
+
+			Colors are collected into a 32K cells histogram (5 bits per channel), then the palette is built using
+			the median cut algorithm, and optionally refined by some k-means iterations. Pixels are finally mapped
+			through a 32K entries inverse color map. This is the method used by SetPixelFormat, when G_RGB_PALETTE
+			format is requested.
+
+			\param PalettedImage the destination image, it will have a G_RGB_PALETTE pixel format.
+			\param MaxColors the maximum number of palette colors, it must be in the range [1; 256].
+			\param DitherMode the dithering method used to map pixels.
+			\param RefineIterations the number of k-means iterations used to refine median cut palette.
+			\param Pool the thread pool used to build the inverse color map and to map pixels. If NULL, a
+			temporary pool with as many threads as the available processors will be used.
+			\return G_NO_ERROR if operation succeeds, an error code otherwise.
+			\note Floyd-Steinberg dithering propagates errors from a row to the next one, so in this case pixels
+			are mapped by the calling thread only.
+		*/
+		GError Quantize(GPixelMap& PalettedImage, const GUInt32 MaxColors = 256,
+						const GDitherMode DitherMode = G_NO_DITHER, const GUInt32 RefineIterations = 2,
+						GThreadPool *Pool = NULL) const;
+		/*!
+			Get the row converter between two pixel formats.
+
+			Every format pair has its own specialized converter, that works on a contiguous run of pixels; so
+			conversions can be chained row by row (for example paletted to 32bit, then 32bit to 16bit) using a
+			single row buffer instead of intermediate images. Where available (SSE2), the most common pairs are
+			vectorized; gray values are always computed with the same fixed point luma used by RGBToGray.
+
+			\param SrcFormat the source pixel format.
+			\param DstFormat the destination pixel format.
+			\return the converter function, or NULL if the conversion requires a color quantization (that is
+			DstFormat is G_RGB_PALETTE and SrcFormat is not).
+			\note source and destination pointers passed to the converter can be the same, if source and
+			destination pixels have the same size.
+		*/
+		static GPixelRowConverter RowConverter(const GPixelFormat SrcFormat, const GPixelFormat DstFormat);
 		/*
 			Reset the image.
 
@@ -684,8 +743,8 @@ namespace Amanith {
 		inline static GUInt32 RGBToGray(const GUInt32 Red, const GUInt32 Green, const GUInt32 Blue) {
 			// Rec 601-1: 0.299, 0.587, 0.114
 			// Rec 709 / ITU:   0.2125, 0.7154, 0.0721
-			GReal fLum = (GReal)Red * (GReal)0.299 + (GReal)Green * (GReal)0.587 + (GReal)Blue * (GReal)0.114;
-			return (GUInt32)fLum;
+			// weights are expressed in 1.15 fixed point
+			return ((Red * 9798 + Green * 19235 + Blue * 3735) >> 15);
 		}
 		/*!
 			RGB to gray conversion.
@@ -702,8 +761,8 @@ namespace Amanith {
 			GUInt32 r = (RGB >> 16) & 0xFF;
 			GUInt32 g = (RGB >> 8) & 0xFF;
 			GUInt32 b = (RGB & 0xFF);
-			GReal fLum = (GReal)r * (GReal)0.299 + (GReal)g * (GReal)0.587 + (GReal)b * (GReal)0.114;
-			return (GUInt32)fLum;
+			// weights are expressed in 1.15 fixed point
+			return ((r * 9798 + g * 19235 + b * 3735) >> 15);
 		}
 		/*!
 			RGB to CMY conversion.
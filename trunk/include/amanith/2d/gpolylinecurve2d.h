@@ -192,6 +192,17 @@ namespace Amanith {
 			check this case before calling ParamToKeyIndex.
 		*/
 		GBool ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex) const;
+		/*!
+			Given a domain value, it returns the span index that includes it, starting the search from a known
+			key index.
+
+			\param Param the domain parameter
+			\param KeyIndex the lower key index of the interval where Param is included.
+			\param KeyIndexHint a key index not greater than the searched one (for example the one found for
+			a smaller parameter); if the searched index is far from it, a binary search is done.
+			\return G_TRUE if the domain value is inside the current domain, G_FALSE otherwise.
+		*/
+		GBool ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex, const GUInt32 KeyIndexHint) const;
 		//! Get Index-th key point; Index must be valid, else a point with infinitive components is returned.
 		GPoint2 Point(const GUInt32 Index) const;
 		//! Set Index-th (key)point; Index must be valid.
@@ -271,6 +282,23 @@ namespace Amanith {
 			Get variation (squared chordal distance) in the current domain range.
 		*/
 		GReal Variation() const;
+		/*!
+			Apply an affine transformation to all key points.
+
+			\param Matrix a 2x3 matrix, specifying the affine transformation.
+			\note the leftmost 2x2 matrix contains the rotation/scale portion, the last column vector contains the
+			translation.
+		*/
+		void XForm(const GMatrix23& Matrix);
+		/*!
+			Apply full transformation to all key points.
+
+			\param Matrix a 3x3 matrix, specifying the transformation.
+			\param DoProjection if G_TRUE the projective transformation (described by the last row vector of matrix) will
+			be done. In this case all transformed vertexes will be divided by the last W component. If G_FALSE only the
+			affine portion will be used for transformation, and no projective division will be executed.
+		*/
+		void XForm(const GMatrix33& Matrix, const GBool DoProjection = G_TRUE);
 		/*!
 			Flats the curve specifying a max error/variation (squared chordal distance).
 
@@ -310,6 +338,18 @@ namespace Amanith {
 			\note specified domain parameter is clamped by domain interval.
 		*/
 		GVector2 Derivative(const GDerivativeOrder Order, const GReal u) const;
+		/*!
+			Evaluate the curve at several domain parameters, see GCurve2D::Evaluate().
+
+			\note keys are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const;
+		/*!
+			Evaluate the curve derivative at several domain parameters, see GCurve2D::Derivative().
+
+			\note keys are searched incrementally, so sorted parameters are evaluated faster.
+		*/
+		void Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const;
 		/*!
 			Return the curve derivative calculated at specified domain parameter. This method differs from
 			the one of base GCurve2D class in the number of returned values. This is due to the possibility
@@ -50,10 +50,14 @@ namespace Amanith {
 		G_ODD_EVEN_RULE,
 		//! Even-odd rule
 		G_EVEN_ODD_RULE,
-		//! Non-zero rule (not yet supported)
+		//! Non-zero rule
 		G_NON_ZERO_RULE,
 		//! Any rule
-		G_ANY_RULE
+		G_ANY_RULE,
+		//! Positive winding number rule
+		G_POSITIVE_RULE,
+		//! Negative winding number rule
+		G_NEGATIVE_RULE
 	};
 
 	/*!
@@ -70,7 +74,9 @@ namespace Amanith {
 
 		The general step is to sweep a vertical line, as the classic Bentley-Ottmann algorithm do. The so called
 		Y-structure (also known as edges dictionary) is an AVL tree (maybe next version will use a skip list), and the
-		so called X-structure is a priority queue (implemented as a simple sorted list).\n
+		so called X-structure is a priority queue (implemented as a simple sorted list). Each edge into the dictionary
+		carries its crossing number and its winding number (counter-clockwise contours have positive winding), so all
+		fill rules are resolved by the sweep itself.\n
 		The overall complexity is (N + K)Log2(N), where N is the total number of segments, K is the number of
 		intersections that occur between segments (intersections can derive from non simple contours or they can be due
 		to contours intersections), and Log2 is the logarithm to base 2 function.
@@ -98,12 +104,16 @@ namespace Amanith {
 		struct GActiveRegion {
 			GMeshEdge2D<GDouble> *MeshUpperEdge;  // upper edge, directed right to left
 			GInt32 CrossingNumber;
+			GInt32 WindingNumber;
 			GBool Valid;
 		};
 
 		struct GMeshToAVL {
 			GInt32 EdgeType;
 			GInt32 CrossingNumber;
+			// winding number of the region below the edge, and the edge contribution to it (0 for diagonals)
+			GInt32 WindingNumber;
+			GInt32 Winding;
 			GBool IsIntoDictionary;
 			GAVLNode *AVLNode;
 			GActiveRegion *Region;
@@ -144,6 +154,8 @@ namespace Amanith {
 			GDynArray<GMeshToAVL *> ExtEdges;
 			GDynArray<GActiveRegion *> ActiveRegions;
 			GULong VertexID;
+			// G_TRUE if x and y coordinates have been swapped, to sweep along the y axis
+			GBool Transposed;
 
 			// constructor
 			GTessDescriptor() {
@@ -155,6 +167,7 @@ namespace Amanith {
 				LastRegionEdge = NULL;
 				DictionaryTree.DescPointer = this;
 				VertexID = 0;
+				Transposed = G_FALSE;
 			}
 		};
 
@@ -204,6 +217,8 @@ namespace Amanith {
 															  GMeshEdge2D<GDouble> *UnTouched,
 															  const GPoint<GDouble, 2>& IntersectionPoint,
 															  GTessDescriptor& Descriptor);
+		void SplitOverlappingEdges(GMeshEdge2D<GDouble> *SplitEdge, const GPoint<GDouble, 2>& OldDest,
+								   const GPoint<GDouble, 2>& IntersectionPoint, GTessDescriptor& Descriptor);
 		// merging rings functions
 		static GMeshVertex2D<GDouble> *MergeRings(GMeshVertex2D<GDouble> *Ring1Vertex,
 												  GMeshVertex2D<GDouble> *Ring2Vertex,
@@ -230,6 +245,11 @@ namespace Amanith {
 									  GTessDescriptor& Descriptor);
 		void TessellateMonotoneRegion(const GActiveRegion* Region, GDynArray<GULong>& PointsIds,
 									  GTessDescriptor& Descriptor);
+		// decompose a monotone region into trapezoids, with parallel sides orthogonal to the sweep direction
+		void TrapezoidateMonotoneRegion(const GActiveRegion* Region, GDynArray< GPoint<GDouble, 2> >& Trapezoids,
+										GTessDescriptor& Descriptor);
+		// return G_TRUE if the specified region must be filled according to the specified rule
+		static GBool IsRegionFilled(const GActiveRegion* Region, const GFillBehavior FillRule);
 
 		// searching into RingEdge's origin ring, return that edge that span the smaller angle in CCW
 		// direction to meet an edge specified by its Origin and its Destination
@@ -280,7 +300,6 @@ namespace Amanith {
 			\param Triangles the outputted array of triangles. Every triangle is built by 3 vertexes.
 			\param FillRule the filling rule.
 			\return G_NO_ERROR if operation succeeds, an error code otherwise.
-			\note Please keep OddFill parameter G_TRUE. This is the only supported mode for this version.
 		*/
 		GError Tesselate(const GDynArray<GPoint2>& Points, const GDynArray<GInt32>& PointsPerContour,
 						 GDynArray< GPoint<GDouble, 2> >& Triangles, const GFillBehavior FillRule = G_ODD_EVEN_RULE);
@@ -328,7 +347,6 @@ namespace Amanith {
 			triangle, and so on.
 			\param FillRule the filling rule.
 			\return G_NO_ERROR if operation succeeds, an error code otherwise.
-			\note Please keep OddFill parameter G_TRUE. This is the only supported mode for this version.
 		*/
 		GError Tesselate(const GDynArray<GPoint2>& Points, const GDynArray<GInt32>& PointsPerContour,
 						 GDynArray< GPoint<GDouble, 2> >& TriangPoints, GDynArray< GULong >& TriangIds,
@@ -339,6 +357,23 @@ namespace Amanith {
 						GDynArray< GPoint<GDouble, 2> >& TriangPoints, GDynArray< GULong >& TriangIds,
 						GAABox2& BoundingBox, const GFillBehavior FillRule = G_ODD_EVEN_RULE);
 
+		/*!
+			Decompose given contours and holes into trapezoids, with horizontal parallel sides.
+
+			The sweep runs along the y axis, so each monotone region is split at its vertices by horizontal lines.
+			Trapezoids don't overlap, and they can be consumed by a scanline rasterizer without any triangle setup.
+
+			\param Points the array containing the contours points.
+			\param PointsPerContour an array containing the number of point for every contour.
+			\param Trapezoids the outputted array of trapezoids. Every trapezoid is made of 4 points: the first two
+			lie on the lower horizontal side (left one first), the other two on the upper horizontal side (right one
+			first), so each trapezoid is counter-clockwise. Degenerate sides (triangles) have coincident points.
+			\param FillRule the filling rule.
+			\return G_NO_ERROR if operation succeeds, an error code otherwise.
+		*/
+		GError TesselateTrapezoids(const GDynArray<GPoint2>& Points, const GDynArray<GInt32>& PointsPerContour,
+								   GDynArray< GPoint<GDouble, 2> >& Trapezoids,
+								   const GFillBehavior FillRule = G_ODD_EVEN_RULE);
 	};
 
 };	// end namespace Amanith
@@ -31,6 +31,8 @@
 
 #include "amanith/2d/gpath2d.h"
 #include "amanith/2d/gpixelmap.h"
+#include "amanith/support/gthreadpool.h"
+#include "amanith/geometry/gaabox.h"
 
 /*!
 	\file gtracer2d.h
@@ -120,6 +122,8 @@ namespace Amanith {
 	*/
 	class G_EXPORT GTracer2D {
 
+		friend class GTracerSession;
+
 	private:
 
 		struct PixelPath {
@@ -127,6 +131,7 @@ namespace Amanith {
 			GInt32 Length;
 			GInt32 Area;
 			GInt32 Direction;
+			GPoint<GInt32, 2> Start;
 		};
 
 		struct PrivateCurve {
@@ -135,6 +140,17 @@ namespace Amanith {
 			GDynArray<GPoint2> Vertexes;
 		};
 
+		// data shared by vectorization jobs; every job writes only its own Curves/Errors slots
+		struct VectorizeJobsData {
+			GDynArray<PixelPath> *Paths;
+			const GDynArray<GInt32> *Signs;
+			GDynArray<PrivateCurve> *Curves;
+			GDynArray<GError> *Errors;
+			GReal AlphaMax;
+			GReal Scale;
+			GReal ImageHeight;
+		};
+
 		static GError BuildPath(const GPixelMap& Image, const GPoint<GInt32, 2>& StartPoint,
 								const GUChar8 WhiteColor, const GInt32 Direction, const GTurnPolicy TurnPolicy,
 								const GInt32 MaxRadius,	PixelPath& Path);
@@ -161,10 +177,20 @@ namespace Amanith {
 		static GError VectorizePath(PixelPath& Path, PrivateCurve& Curve,
 									const GInt32 Sign, const GReal AlphaMax, const GReal Scale,
 									const GReal ImageHeight);
+		static void VectorizeJob(void *Data, const GUInt32 JobIndex);
+		static GError ExtractPaths(const GPixelMap& Image, const GUChar8 WhiteColor, const GTurnPolicy TurnPolicy,
+								   const GInt32 MaxRadius, const GInt32 MinArea,
+								   GDynArray<PixelPath>& Paths, GDynArray<GInt32>& Signs);
+		static GError VectorizePaths(GDynArray<PixelPath>& Paths, const GDynArray<GInt32>& Signs,
+									 const GReal AlphaMax, const GReal Scale, const GReal ImageHeight,
+									 GThreadPool *Pool, GDynArray<PrivateCurve>& Curves,
+									 GDynArray<GError>& Errors);
 
 	protected:
 		static GBool FindBlackPixel(const GPixelMap& Image, const GUChar8 WhiteColor, const GInt32 StartY,
 									 GPoint<GInt32, 2>& PixelCoords);
+		static GBool FindBlackPixel(const GPixelMap& Image, const GUChar8 WhiteColor,
+									GPoint<GInt32, 2>& ScanCursor, GPoint<GInt32, 2>& PixelCoords);
 		static GBool BlackDominance(const GPixelMap& Image, const GPoint<GInt32, 2>& Center,
 									const GUChar8 WhiteColor, const GInt32 MaxRadius);
 
@@ -185,13 +211,107 @@ namespace Amanith {
 			of isolated pixels or isolated small pixel areas. This area is expressed in pixels.
 			\param Alpha corner detection threshold, smaller values lead to more corners and larger values lead
 			to more rounded shapes. The default values is a good compromise.
+			\param Pool the thread pool used to vectorize extracted contours. If NULL, a temporary pool with as
+			many threads as the available processors will be used.
 			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note Contours are extracted in a single raster scan, then they are vectorized concurrently. The
+			output order is the extraction order, so it does not depend on the number of used threads.
 		*/
 		static GError Trace(const GPixelMap& Image, GDynArray<GTracedContour>& Paths,
 							const GUChar8 WhiteColor = 255,
 							const GTurnPolicy TurnPolicy = G_CONNECT_NOT_DOMINANT,
 							const GInt32 MaxRadius = 6,
-							const GInt32 MinArea = 10, const GReal Alpha = 0.55);
+							const GInt32 MinArea = 10, const GReal Alpha = 0.55,
+							GThreadPool *Pool = NULL);
+	};
+
+
+	// *********************************************************************
+	//                           GTracerSession
+	// *********************************************************************
+
+	/*!
+		\class GTracerSession
+		\brief This class implements an incremental bitmap vectorizer.
+
+		A session keeps the contours traced on an image, together with their bounding boxes. When some pixels of
+		the image are modified, only contours intersecting the modified (dirty) rectangle are traced again, and
+		new contours are spliced into the existing ones. Contours order is the same of a full GTracer2D::Trace
+		call on the modified image.\n
+		The re-traced region is grown until it contains every contour that intersects it, plus a margin of
+		MaxRadius pixels used to resolve turn policies. For G_CONNECT_BLACK and G_CONNECT_WHITE turn policies the
+		result is exactly the same of a full trace; for dominance-based policies cross roads very close to other
+		untouched shapes could be resolved in a slightly different way.
+	*/
+	class G_EXPORT GTracerSession {
+
+	private:
+		//! Traced contours.
+		GDynArray<GTracedContour> gContours;
+		//! Contours bounding boxes, in pixel coordinates (both corners are included).
+		GDynArray< GGenericAABox<GInt32, 2> > gBoxes;
+		//! Contours start points, used to keep the raster scan order.
+		GDynArray< GPoint<GInt32, 2> > gStartPoints;
+		//! Traced image width.
+		GInt32 gWidth;
+		//! Traced image height.
+		GInt32 gHeight;
+		//! White color used by tracing.
+		GUChar8 gWhiteColor;
+		//! Turn policy used by tracing.
+		GTurnPolicy gTurnPolicy;
+		//! Dominance mask radius used by tracing.
+		GInt32 gMaxRadius;
+		//! Minimum area of traced contours.
+		GInt32 gMinArea;
+		//! Corner detection threshold used by tracing.
+		GReal gAlpha;
+		//! Thread pool used for vectorization (can be NULL).
+		GThreadPool *gPool;
+
+		/*
+			Trace contours lying inside the specified region. If some contour crosses the region border, Grown
+			flag is set and GrowBox will include all such contours (in this case no contour is returned).
+		*/
+		GError TraceRegion(const GPixelMap& Image, const GGenericAABox<GInt32, 2>& Region,
+						   GBool& Grown, GGenericAABox<GInt32, 2>& GrowBox,
+						   GDynArray<GTracedContour>& Contours, GDynArray< GGenericAABox<GInt32, 2> >& Boxes,
+						   GDynArray< GPoint<GInt32, 2> >& StartPoints);
+
+	public:
+		//! Constructor, it builds an empty session.
+		GTracerSession();
+		//! Destructor
+		~GTracerSession();
+		/*!
+			Trace the whole image, and start a new session. Parameters have the same meaning of GTracer2D::Trace
+			ones, and they are kept for successive Update() calls.
+
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+		*/
+		GError Trace(const GPixelMap& Image, const GUChar8 WhiteColor = 255,
+					 const GTurnPolicy TurnPolicy = G_CONNECT_NOT_DOMINANT, const GInt32 MaxRadius = 6,
+					 const GInt32 MinArea = 10, const GReal Alpha = 0.55, GThreadPool *Pool = NULL);
+		/*!
+			Update traced contours, after that a portion of the image has been modified.
+
+			\param Image the modified image. It must have the same dimensions and format of the image passed to
+			Trace(); if dimensions are changed, the whole image is traced again.
+			\param DirtyRect the modified rectangle, in pixel coordinates (both corners are included).
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+		*/
+		GError Update(const GPixelMap& Image, const GGenericAABox<GInt32, 2>& DirtyRect);
+		//! Get traced contours.
+		inline const GDynArray<GTracedContour>& Contours() const {
+			return gContours;
+		}
+		//! Get the bounding box (in pixel coordinates) of the Index-th contour.
+		inline const GGenericAABox<GInt32, 2>& ContourBox(const GUInt32 Index) const {
+			G_ASSERT(Index < (GUInt32)gBoxes.size());
+			return gBoxes[Index];
+		}
+		//! Remove all contours, and close the session.
+		void Clear();
 	};
 
 };	// end namespace Amanith
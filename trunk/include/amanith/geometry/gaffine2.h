@@ -0,0 +1,185 @@
+/****************************************************************************
+** $file: amanith/geometry/gaffine2.h   0.3.0.0   edited Jan, 30 2006
+**
+** Compact 2D affine transformation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GAFFINE2_H
+#define GAFFINE2_H
+
+#include "amanith/geometry/gvect.h"
+#include "amanith/geometry/gmatrix.h"
+
+/*!
+	\file gaffine2.h
+	\brief Header file for GAffine2 class.
+*/
+namespace Amanith {
+
+	/*!
+		\class GAffine2
+		\brief A 2D affine transformation stored as 6 values.
+
+		GAffine2 represents the matrix:
+
+\verbatim
+	| m00 m01 m02 |
+	| m10 m11 m12 |
+	|  0   0   1  |
+\endverbatim
+
+		without storing the constant last row. Composition, inversion and point transformation are written
+		in closed form, so GAffine2 is the cheapest way to carry around a 2D model-view or a node transformation.
+		Conversions from and to GMatrix23 and GMatrix33 are provided.
+	*/
+	class GAffine2 {
+
+	private:
+		//! Values, stored by row: m00 m01 m02 m10 m11 m12.
+		GReal gM[6];
+
+	public:
+		//! Default constructor, builds an identity transformation.
+		GAffine2() {
+			SetIdentity();
+		}
+		//! Set constructor, values are given by row.
+		GAffine2(const GReal M00, const GReal M01, const GReal M02,
+				 const GReal M10, const GReal M11, const GReal M12) {
+			Set(M00, M01, M02, M10, M11, M12);
+		}
+		//! Constructor from a 2x3 matrix.
+		GAffine2(const GMatrix23& Matrix) {
+			Set(Matrix[0][0], Matrix[0][1], Matrix[0][2], Matrix[1][0], Matrix[1][1], Matrix[1][2]);
+		}
+		//! Constructor from a 3x3 matrix; the last row is ignored.
+		GAffine2(const GMatrix33& Matrix) {
+			Set(Matrix[0][0], Matrix[0][1], Matrix[0][2], Matrix[1][0], Matrix[1][1], Matrix[1][2]);
+		}
+		//! Set all values, given by row.
+		inline void Set(const GReal M00, const GReal M01, const GReal M02,
+						const GReal M10, const GReal M11, const GReal M12) {
+			gM[0] = M00;
+			gM[1] = M01;
+			gM[2] = M02;
+			gM[3] = M10;
+			gM[4] = M11;
+			gM[5] = M12;
+		}
+		//! Set the identity transformation.
+		inline void SetIdentity() {
+			Set(1, 0, 0, 0, 1, 0);
+		}
+		//! Element access, Row must be 0 or 1, Column must be 0, 1 or 2.
+		inline GReal& operator()(const GUInt32 Row, const GUInt32 Column) {
+			G_ASSERT(Row < 2 && Column < 3);
+			return gM[Row * 3 + Column];
+		}
+		//! Element access (const version), Row must be 0 or 1, Column must be 0, 1 or 2.
+		inline const GReal& operator()(const GUInt32 Row, const GUInt32 Column) const {
+			G_ASSERT(Row < 2 && Column < 3);
+			return gM[Row * 3 + Column];
+		}
+		//! Get values array, stored by row.
+		inline const GReal *Data() const {
+			return gM;
+		}
+		//! Convert to a 2x3 matrix.
+		inline GMatrix23 ToMatrix23() const {
+			GMatrix23 m;
+			m[0][0] = gM[0]; m[0][1] = gM[1]; m[0][2] = gM[2];
+			m[1][0] = gM[3]; m[1][1] = gM[4]; m[1][2] = gM[5];
+			return m;
+		}
+		//! Convert to a 3x3 matrix, the last row is set to (0, 0, 1).
+		inline GMatrix33 ToMatrix33() const {
+			GMatrix33 m;
+			m[0][0] = gM[0]; m[0][1] = gM[1]; m[0][2] = gM[2];
+			m[1][0] = gM[3]; m[1][1] = gM[4]; m[1][2] = gM[5];
+			m[2][0] = 0; m[2][1] = 0; m[2][2] = 1;
+			return m;
+		}
+		//! Get the determinant of the linear part.
+		inline GReal Determinant() const {
+			return gM[0] * gM[4] - gM[1] * gM[3];
+		}
+		/*!
+			Calculate the inverse transformation.
+
+			\param Result the inverse transformation; it is left untouched if this transformation is singular.
+			\param Epsilon singularity threshold, compared with the absolute value of the determinant.
+			\return G_TRUE if the transformation has been inverted, G_FALSE if it is singular.
+			\note Result can be this same transformation.
+		*/
+		inline GBool Invert(GAffine2& Result, const GReal Epsilon = (GReal)1e-20) const {
+
+			GReal det = Determinant();
+			if (GMath::Abs(det) < Epsilon)
+				return G_FALSE;
+
+			GReal invDet = 1 / det;
+			GReal a = gM[4] * invDet, b = -gM[1] * invDet;
+			GReal c = -gM[3] * invDet, d = gM[0] * invDet;
+			GReal tx = gM[2], ty = gM[5];
+
+			Result.Set(a, b, -(a * tx + b * ty), c, d, -(c * tx + d * ty));
+			return G_TRUE;
+		}
+		/*!
+			Composition: the returned transformation applies Other first, then this transformation.
+		*/
+		inline GAffine2 operator *(const GAffine2& Other) const {
+
+			const GReal *o = Other.gM;
+			return GAffine2(gM[0] * o[0] + gM[1] * o[3], gM[0] * o[1] + gM[1] * o[4], gM[0] * o[2] + gM[1] * o[5] + gM[2],
+							gM[3] * o[0] + gM[4] * o[3], gM[3] * o[1] + gM[4] * o[4], gM[3] * o[2] + gM[4] * o[5] + gM[5]);
+		}
+		//! Post-multiply (compose) by the specified transformation, that will be applied first.
+		inline GAffine2& operator *=(const GAffine2& Other) {
+			*this = (*this) * Other;
+			return *this;
+		}
+		//! Transform a point.
+		inline GPoint2 operator *(const GPoint2& Point) const {
+			return GPoint2(gM[0] * Point[G_X] + gM[1] * Point[G_Y] + gM[2], gM[3] * Point[G_X] + gM[4] * Point[G_Y] + gM[5]);
+		}
+		//! Transform a vector; translation is not applied.
+		inline GVector2 XFormVector(const GVector2& Vector) const {
+			return GVector2(gM[0] * Vector[G_X] + gM[1] * Vector[G_Y], gM[3] * Vector[G_X] + gM[4] * Vector[G_Y]);
+		}
+		//! Equal operator.
+		inline GBool operator ==(const GAffine2& Other) const {
+			return (gM[0] == Other.gM[0] && gM[1] == Other.gM[1] && gM[2] == Other.gM[2] &&
+					gM[3] == Other.gM[3] && gM[4] == Other.gM[4] && gM[5] == Other.gM[5]);
+		}
+		//! Not-equal operator.
+		inline GBool operator !=(const GAffine2& Other) const {
+			return !(*this == Other);
+		}
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -0,0 +1,323 @@
+/****************************************************************************
+** $file: amanith/geometry/gbatchquery.h   0.3.0.0   edited Jan, 30 2006
+**
+** Batched intersection queries over arrays of primitives.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GBATCHQUERY_H
+#define GBATCHQUERY_H
+
+#include "amanith/geometry/gintersect.h"
+
+/*!
+	\file gbatchquery.h
+	\brief Header file for batched intersection queries.
+*/
+namespace Amanith {
+
+	/*!
+		\class GAABox2Array
+		\brief An array of 2D axes aligned boxes, stored as a structure of arrays.
+
+		Each box component is kept in its own contiguous array, so that batched queries can load the same
+		component of several boxes at once.
+	*/
+	class GAABox2Array {
+
+	private:
+		GDynArray<GReal> gMinX;
+		GDynArray<GReal> gMinY;
+		GDynArray<GReal> gMaxX;
+		GDynArray<GReal> gMaxY;
+
+	public:
+		//! Get the number of boxes.
+		inline GUInt32 Count() const {
+			return (GUInt32)gMinX.size();
+		}
+		//! Remove all boxes.
+		inline void Clear() {
+			gMinX.clear();
+			gMinY.clear();
+			gMaxX.clear();
+			gMaxY.clear();
+		}
+		//! Reserve space for the specified number of boxes.
+		inline void Reserve(const GUInt32 Count) {
+			gMinX.reserve(Count);
+			gMinY.reserve(Count);
+			gMaxX.reserve(Count);
+			gMaxY.reserve(Count);
+		}
+		//! Append a box at the end of the array.
+		inline void Add(const GAABox2& Box) {
+			gMinX.push_back(Box.Min()[G_X]);
+			gMinY.push_back(Box.Min()[G_Y]);
+			gMaxX.push_back(Box.Max()[G_X]);
+			gMaxY.push_back(Box.Max()[G_Y]);
+		}
+		//! Replace the Index-th box.
+		inline void Set(const GUInt32 Index, const GAABox2& Box) {
+			G_ASSERT(Index < Count());
+			gMinX[Index] = Box.Min()[G_X];
+			gMinY[Index] = Box.Min()[G_Y];
+			gMaxX[Index] = Box.Max()[G_X];
+			gMaxY[Index] = Box.Max()[G_Y];
+		}
+		//! Get the Index-th box.
+		inline GAABox2 Box(const GUInt32 Index) const {
+			G_ASSERT(Index < Count());
+			return GAABox2(GPoint2(gMinX[Index], gMinY[Index]), GPoint2(gMaxX[Index], gMaxY[Index]));
+		}
+		//! Minimum x components.
+		inline const GReal *MinX() const {
+			return (gMinX.empty()) ? NULL : &gMinX[0];
+		}
+		//! Minimum y components.
+		inline const GReal *MinY() const {
+			return (gMinY.empty()) ? NULL : &gMinY[0];
+		}
+		//! Maximum x components.
+		inline const GReal *MaxX() const {
+			return (gMaxX.empty()) ? NULL : &gMaxX[0];
+		}
+		//! Maximum y components.
+		inline const GReal *MaxY() const {
+			return (gMaxY.empty()) ? NULL : &gMaxY[0];
+		}
+	};
+
+	/*!
+		\class GSphere2Array
+		\brief An array of 2D spheres (circles), stored as a structure of arrays.
+	*/
+	class GSphere2Array {
+
+	private:
+		GDynArray<GReal> gCenterX;
+		GDynArray<GReal> gCenterY;
+		GDynArray<GReal> gRadius;
+
+	public:
+		//! Get the number of spheres.
+		inline GUInt32 Count() const {
+			return (GUInt32)gCenterX.size();
+		}
+		//! Remove all spheres.
+		inline void Clear() {
+			gCenterX.clear();
+			gCenterY.clear();
+			gRadius.clear();
+		}
+		//! Reserve space for the specified number of spheres.
+		inline void Reserve(const GUInt32 Count) {
+			gCenterX.reserve(Count);
+			gCenterY.reserve(Count);
+			gRadius.reserve(Count);
+		}
+		//! Append a sphere at the end of the array.
+		inline void Add(const GSphere2& Sphere) {
+			gCenterX.push_back(Sphere.Center()[G_X]);
+			gCenterY.push_back(Sphere.Center()[G_Y]);
+			gRadius.push_back(Sphere.Radius());
+		}
+		//! Replace the Index-th sphere.
+		inline void Set(const GUInt32 Index, const GSphere2& Sphere) {
+			G_ASSERT(Index < Count());
+			gCenterX[Index] = Sphere.Center()[G_X];
+			gCenterY[Index] = Sphere.Center()[G_Y];
+			gRadius[Index] = Sphere.Radius();
+		}
+		//! Get the Index-th sphere.
+		inline GSphere2 Sphere(const GUInt32 Index) const {
+			G_ASSERT(Index < Count());
+			return GSphere2(GPoint2(gCenterX[Index], gCenterY[Index]), gRadius[Index]);
+		}
+		//! Center x components.
+		inline const GReal *CenterX() const {
+			return (gCenterX.empty()) ? NULL : &gCenterX[0];
+		}
+		//! Center y components.
+		inline const GReal *CenterY() const {
+			return (gCenterY.empty()) ? NULL : &gCenterY[0];
+		}
+		//! Radii.
+		inline const GReal *Radius() const {
+			return (gRadius.empty()) ? NULL : &gRadius[0];
+		}
+	};
+
+	/*!
+		\class GLineSegment2Array
+		\brief An array of 2D line segments, stored as a structure of arrays.
+
+		Each segment is stored as its origin and direction (end point minus start point), exactly as GLineSeg does.
+	*/
+	class GLineSegment2Array {
+
+	private:
+		GDynArray<GReal> gOriginX;
+		GDynArray<GReal> gOriginY;
+		GDynArray<GReal> gDirectionX;
+		GDynArray<GReal> gDirectionY;
+
+	public:
+		//! Get the number of segments.
+		inline GUInt32 Count() const {
+			return (GUInt32)gOriginX.size();
+		}
+		//! Remove all segments.
+		inline void Clear() {
+			gOriginX.clear();
+			gOriginY.clear();
+			gDirectionX.clear();
+			gDirectionY.clear();
+		}
+		//! Reserve space for the specified number of segments.
+		inline void Reserve(const GUInt32 Count) {
+			gOriginX.reserve(Count);
+			gOriginY.reserve(Count);
+			gDirectionX.reserve(Count);
+			gDirectionY.reserve(Count);
+		}
+		//! Append a segment at the end of the array.
+		inline void Add(const GLineSegment2& Segment) {
+			gOriginX.push_back(Segment.Origin()[G_X]);
+			gOriginY.push_back(Segment.Origin()[G_Y]);
+			gDirectionX.push_back(Segment.Direction()[G_X]);
+			gDirectionY.push_back(Segment.Direction()[G_Y]);
+		}
+		//! Replace the Index-th segment.
+		inline void Set(const GUInt32 Index, const GLineSegment2& Segment) {
+			G_ASSERT(Index < Count());
+			gOriginX[Index] = Segment.Origin()[G_X];
+			gOriginY[Index] = Segment.Origin()[G_Y];
+			gDirectionX[Index] = Segment.Direction()[G_X];
+			gDirectionY[Index] = Segment.Direction()[G_Y];
+		}
+		//! Get the Index-th segment.
+		inline GLineSegment2 Segment(const GUInt32 Index) const {
+			G_ASSERT(Index < Count());
+			return GLineSegment2(GPoint2(gOriginX[Index], gOriginY[Index]), GVector2(gDirectionX[Index], gDirectionY[Index]));
+		}
+		//! Origin x components.
+		inline const GReal *OriginX() const {
+			return (gOriginX.empty()) ? NULL : &gOriginX[0];
+		}
+		//! Origin y components.
+		inline const GReal *OriginY() const {
+			return (gOriginY.empty()) ? NULL : &gOriginY[0];
+		}
+		//! Direction x components.
+		inline const GReal *DirectionX() const {
+			return (gDirectionX.empty()) ? NULL : &gDirectionX[0];
+		}
+		//! Direction y components.
+		inline const GReal *DirectionY() const {
+			return (gDirectionY.empty()) ? NULL : &gDirectionY[0];
+		}
+	};
+
+	/*!
+		\class GBatchQuery
+		\brief Intersection queries of a single entity against arrays of primitives.
+
+		Picking and culling code often tests one ray (or one box) against thousands of primitives. These routines
+		run the same tests of the Intersect() templates defined in gintersect.h over a whole array with a single
+		call; on x86 processors with SSE2 several primitives are tested at once.
+
+		Results are the same, bit for bit, of the scalar templates: degenerate configurations (parallel slabs,
+		tangent circles, parallel segments and so on) are detected per primitive and handed to the scalar
+		template itself.
+
+		Every query writes one GBool for each primitive into the Hits array, and returns the number of
+		primitives that have been hit.
+	*/
+	class G_EXPORT GBatchQuery {
+
+	public:
+		/*!
+			Intersect a ray against an array of axes aligned boxes.
+
+			\param Ray the ray.
+			\param Boxes the boxes to test.
+			\param Hits for each box, G_TRUE if Intersect(Ray, Box, ...) returns G_TRUE.
+			\param Parameters if not NULL, for each box that has been hit it receives the first local parameter
+			returned by the scalar test, that is the ray parameter of the nearest valid intersection.
+			Values relative to missed boxes are undefined.
+			\return the number of hit boxes.
+		*/
+		static GUInt32 Intersect(const GRay2& Ray, const GAABox2Array& Boxes, GBool *Hits, GReal *Parameters);
+		/*!
+			Intersect a ray against an array of spheres (circles).
+
+			\param Ray the ray.
+			\param Spheres the spheres to test.
+			\param Hits for each sphere, G_TRUE if Intersect(Ray, Sphere, ...) returns G_TRUE.
+			\param Parameters if not NULL, for each sphere that has been hit it receives the first local
+			parameter returned by the scalar test. Values relative to missed spheres are undefined.
+			\return the number of hit spheres.
+		*/
+		static GUInt32 Intersect(const GRay2& Ray, const GSphere2Array& Spheres, GBool *Hits, GReal *Parameters);
+		/*!
+			Intersect a ray against an array of line segments.
+
+			\param Ray the ray.
+			\param Segments the segments to test.
+			\param Hits for each segment, G_TRUE if Intersect(Ray, Segment, ...) returns G_TRUE.
+			\param Parameters if not NULL, for each segment that has been hit it receives the first local
+			parameter returned by the scalar test (the ray parameter). Values relative to missed segments are
+			undefined.
+			\return the number of hit segments.
+		*/
+		static GUInt32 Intersect(const GRay2& Ray, const GLineSegment2Array& Segments, GBool *Hits,
+								 GReal *Parameters);
+		/*!
+			Test an array of points against an axes aligned box.
+
+			\param Box the box.
+			\param Points the points to test.
+			\param Count number of points.
+			\param Hits for each point, G_TRUE if the point is not outside the box, that is if
+			Box.PointSign(Point, Epsilon) != G_OUTSIDE.
+			\param Epsilon the tolerance used during comparisons, as in GGenericAABox::PointSign().
+			\return the number of points inside the box or on its surface.
+		*/
+		static GUInt32 PointsInBox(const GAABox2& Box, const GPoint2 *Points, const GUInt32 Count, GBool *Hits,
+								   const GReal Epsilon = 0);
+		/*!
+			Cull an array of axes aligned boxes against a view box.
+
+			\param View the view box (typically the visible area of a drawing surface).
+			\param Boxes the boxes to test.
+			\param Visible for each box, G_TRUE if Intersect(Box, View, Flags) returns G_TRUE.
+			\return the number of visible boxes.
+		*/
+		static GUInt32 Cull(const GAABox2& View, const GAABox2Array& Boxes, GBool *Visible);
+	};
+
+};	// end namespace Amanith
+
+#endif
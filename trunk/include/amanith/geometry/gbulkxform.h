@@ -0,0 +1,90 @@
+/****************************************************************************
+** $file: amanith/geometry/gbulkxform.h   0.3.0.0   edited Jan, 30 2006
+**
+** Bulk transformation of points arrays.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GBULKXFORM_H
+#define GBULKXFORM_H
+
+#include "amanith/geometry/gvect.h"
+#include "amanith/geometry/gmatrix.h"
+
+/*!
+	\file gbulkxform.h
+	\brief Header file for bulk transformation of points arrays.
+*/
+namespace Amanith {
+
+	/*!
+		\class GBulkXForm
+		\brief Transformation of contiguous arrays of 2D points.
+
+		These routines transform a whole array of points with a single call, instead of going through the generic
+		matrix * point templates one point at a time. Matrix entries are loaded once, and on x86 processors with
+		SSE2 the inner loops work on packed values. Both single and double precision points are supported,
+		independently of the GReal type used by the matrix.
+
+		Source and destination arrays can be the same array (in-place transformation); partially overlapping arrays
+		are not supported.
+	*/
+	class G_EXPORT GBulkXForm {
+
+	public:
+		/*!
+			Transform an array of points by an affine matrix.
+
+			\param Matrix the affine transformation.
+			\param Src source points.
+			\param Dst destination points, it must be able to contain Count points.
+			\param Count number of points to transform.
+		*/
+		static void XForm(const GMatrix23& Matrix, const GPoint<GFloat, 2> *Src, GPoint<GFloat, 2> *Dst,
+						  const GUInt32 Count);
+		//! Double precision version of the affine transformation, see the single precision version.
+		static void XForm(const GMatrix23& Matrix, const GPoint<GDouble, 2> *Src, GPoint<GDouble, 2> *Dst,
+						  const GUInt32 Count);
+		/*!
+			Transform an array of points by a 3x3 matrix.
+
+			\param Matrix the transformation.
+			\param DoProjection if G_TRUE, each transformed point is divided by its w component; if G_FALSE, the
+			last row of the matrix is ignored.
+			\param Src source points.
+			\param Dst destination points, it must be able to contain Count points.
+			\param Count number of points to transform.
+			\note when the w component of a point is (almost) zero, the point is not divided, as GCurve2D::XForm()
+			has always done.
+		*/
+		static void XForm(const GMatrix33& Matrix, const GBool DoProjection, const GPoint<GFloat, 2> *Src,
+						  GPoint<GFloat, 2> *Dst, const GUInt32 Count);
+		//! Double precision version of the 3x3 transformation, see the single precision version.
+		static void XForm(const GMatrix33& Matrix, const GBool DoProjection, const GPoint<GDouble, 2> *Src,
+						  GPoint<GDouble, 2> *Dst, const GUInt32 Count);
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -0,0 +1,597 @@
+/****************************************************************************
+** $file: amanith/geometry/gbvh2.h   0.3.0.0   edited Jan, 30 2006
+**
+** 2D bounding volume hierarchy.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GBVH2_H
+#define GBVH2_H
+
+#include "amanith/geometry/gspatial2.h"
+
+/*!
+	\file gbvh2.h
+	\brief Header file for GBVH2 class.
+*/
+namespace Amanith {
+
+	/*!
+		\class GBVH2
+		\brief A 2D bounding volume hierarchy.
+
+		GBVH2 is a binary tree of bounding boxes, with one item for each leaf. Build() constructs the tree top-down
+		using the surface area heuristic (SAH, where the 2D "surface" is the box perimeter) evaluated over a fixed
+		number of bins. Insert() and Remove() modify the tree incrementally, choosing the insertion point that
+		least enlarges the tree perimeter. Moving items can be updated one at a time with Update(), or all
+		together by changing them with SetItem() and calling Refit() once. After many incremental changes, the
+		tree quality can be restored with Rebuild().
+
+		\param ITEM type of the stored primitives (for example GAABox2, GSphere2, GLineSegment2 or GPoint2).
+		\param TRAITS the spatial traits of ITEM, see GSpatialTraits2.
+	*/
+	template<typename ITEM, typename TRAITS = GSpatialTraits2<ITEM> >
+	class GBVH2 {
+
+	private:
+		// a tree node; leaves have Left = -1 and Item set to the item handle
+		struct GBVHNode {
+			GSpatialBox2 Box;
+			GInt32 Parent;
+			GInt32 Left;
+			GInt32 Right;
+			GInt32 Item;
+		};
+		// an item (or a centroid) during SAH construction
+		struct GBuildEntry {
+			GSpatialBox2 Box;
+			GReal CenterX;
+			GReal CenterY;
+			GUInt32 Handle;
+		};
+		// a bin used to evaluate SAH split positions
+		struct GBuildBin {
+			GSpatialBox2 Box;
+			GUInt32 Count;
+		};
+		// number of bins used during construction
+		enum {
+			G_BVH_BINS = 16
+		};
+
+		GSpatialItems2<ITEM, TRAITS> gItems;
+		GDynArray<GBVHNode> gNodes;
+		GDynArray<GInt32> gFreeNodes;
+		GInt32 gRoot;
+
+		GInt32 AllocNode() {
+
+			GInt32 index;
+			if (!gFreeNodes.empty()) {
+				index = gFreeNodes.back();
+				gFreeNodes.pop_back();
+			}
+			else {
+				index = (GInt32)gNodes.size();
+				gNodes.push_back(GBVHNode());
+			}
+			GBVHNode& n = gNodes[index];
+			n.Parent = n.Left = n.Right = n.Item = -1;
+			return index;
+		}
+
+		inline void FreeNode(const GInt32 Index) {
+			gFreeNodes.push_back(Index);
+		}
+
+		inline GBool IsLeaf(const GInt32 Index) const {
+			return (gNodes[Index].Left < 0);
+		}
+
+		// recalculate boxes from the specified node up to the root
+		void RefitUp(GInt32 Index) {
+
+			while (Index >= 0) {
+				GBVHNode& n = gNodes[Index];
+				n.Box = Union(gNodes[n.Left].Box, gNodes[n.Right].Box);
+				Index = n.Parent;
+			}
+		}
+
+		// build a subtree over Entries[Begin, End), it returns the subtree root
+		GInt32 BuildRange(GDynArray<GBuildEntry>& Entries, const GUInt32 Begin, const GUInt32 End, const GInt32 Parent) {
+
+			GInt32 index = AllocNode();
+			GUInt32 i, count = End - Begin;
+
+			gNodes[index].Parent = Parent;
+			if (count == 1) {
+				gNodes[index].Box = Entries[Begin].Box;
+				gNodes[index].Item = (GInt32)Entries[Begin].Handle;
+				gItems.Slot(Entries[Begin].Handle) = index;
+				return index;
+			}
+
+			// centroids bounds, the split axis is the one of largest centroids extent
+			GSpatialBox2 centroids;
+			for (i = Begin; i < End; ++i)
+				centroids.Extend(Entries[i].CenterX, Entries[i].CenterY);
+			GUInt32 axis = ((centroids.MaxX - centroids.MinX) >= (centroids.MaxY - centroids.MinY)) ? G_X : G_Y;
+			GReal lo = (axis == G_X) ? centroids.MinX : centroids.MinY;
+			GReal extent = ((axis == G_X) ? centroids.MaxX : centroids.MaxY) - lo;
+			GUInt32 mid = Begin + count / 2;
+
+			if (extent > 0 && count > 2) {
+				GBuildBin bins[G_BVH_BINS];
+				GSpatialBox2 rightBoxes[G_BVH_BINS];
+				GUInt32 rightCounts[G_BVH_BINS];
+				GReal k = (GReal)G_BVH_BINS / extent;
+				GInt32 b;
+
+				for (b = 0; b < G_BVH_BINS; ++b)
+					bins[b].Count = 0;
+				for (i = Begin; i < End; ++i) {
+					b = BinIndex(Entries[i], axis, lo, k);
+					bins[b].Box.Extend(Entries[i].Box);
+					bins[b].Count++;
+				}
+				// sweep from right, then from left evaluating the cost of each split plane
+				GSpatialBox2 acc;
+				GUInt32 accCount = 0;
+				for (b = G_BVH_BINS - 1; b > 0; --b) {
+					acc.Extend(bins[b].Box);
+					accCount += bins[b].Count;
+					rightBoxes[b] = acc;
+					rightCounts[b] = accCount;
+				}
+				GReal bestCost = G_MAX_REAL;
+				GInt32 bestSplit = -1;
+				acc = GSpatialBox2();
+				accCount = 0;
+				for (b = 1; b < G_BVH_BINS; ++b) {
+					acc.Extend(bins[b - 1].Box);
+					accCount += bins[b - 1].Count;
+					if (accCount == 0 || rightCounts[b] == 0)
+						continue;
+					GReal cost = accCount * acc.HalfPerimeter() + rightCounts[b] * rightBoxes[b].HalfPerimeter();
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestSplit = b;
+					}
+				}
+				if (bestSplit > 0) {
+					// partition entries around the best split plane
+					GUInt32 l = Begin, r = End;
+					while (l < r) {
+						if (BinIndex(Entries[l], axis, lo, k) < bestSplit)
+							l++;
+						else {
+							r--;
+							std::swap(Entries[l], Entries[r]);
+						}
+					}
+					if (l > Begin && l < End)
+						mid = l;
+				}
+			}
+			else
+			if (extent > 0) {
+				// two entries, just order them along the axis
+				if (Center(Entries[Begin], axis) > Center(Entries[Begin + 1], axis))
+					std::swap(Entries[Begin], Entries[Begin + 1]);
+			}
+
+			GInt32 left = BuildRange(Entries, Begin, mid, index);
+			GInt32 right = BuildRange(Entries, mid, End, index);
+			gNodes[index].Left = left;
+			gNodes[index].Right = right;
+			gNodes[index].Box = Union(gNodes[left].Box, gNodes[right].Box);
+			return index;
+		}
+
+		static inline GReal Center(const GBuildEntry& Entry, const GUInt32 Axis) {
+			return (Axis == G_X) ? Entry.CenterX : Entry.CenterY;
+		}
+
+		static inline GInt32 BinIndex(const GBuildEntry& Entry, const GUInt32 Axis, const GReal Lo, const GReal K) {
+			GInt32 b = (GInt32)((Center(Entry, Axis) - Lo) * K);
+			return (b < 0) ? 0 : ((b >= G_BVH_BINS) ? G_BVH_BINS - 1 : b);
+		}
+
+		// link a leaf into the tree, choosing the sibling that least enlarges the tree
+		void InsertLeaf(const GInt32 Leaf) {
+
+			if (gRoot < 0) {
+				gRoot = Leaf;
+				gNodes[Leaf].Parent = -1;
+				return;
+			}
+
+			const GSpatialBox2 leafBox = gNodes[Leaf].Box;
+			GInt32 index = gRoot;
+
+			while (!IsLeaf(index)) {
+				const GBVHNode& n = gNodes[index];
+				GReal perimeter = n.Box.HalfPerimeter();
+				GReal combined = Union(n.Box, leafBox).HalfPerimeter();
+				// cost of making a new parent here, and cost pushed down to children
+				GReal cost = 2 * combined;
+				GReal inheritance = 2 * (combined - perimeter);
+				GReal costLeft = ChildCost(n.Left, leafBox) + inheritance;
+				GReal costRight = ChildCost(n.Right, leafBox) + inheritance;
+
+				if (cost < costLeft && cost < costRight)
+					break;
+				index = (costLeft < costRight) ? n.Left : n.Right;
+			}
+
+			GInt32 sibling = index;
+			GInt32 oldParent = gNodes[sibling].Parent;
+			GInt32 newParent = AllocNode();
+			gNodes[newParent].Parent = oldParent;
+			gNodes[newParent].Left = sibling;
+			gNodes[newParent].Right = Leaf;
+			gNodes[sibling].Parent = newParent;
+			gNodes[Leaf].Parent = newParent;
+
+			if (oldParent < 0)
+				gRoot = newParent;
+			else {
+				if (gNodes[oldParent].Left == sibling)
+					gNodes[oldParent].Left = newParent;
+				else
+					gNodes[oldParent].Right = newParent;
+			}
+			RefitUp(newParent);
+		}
+
+		inline GReal ChildCost(const GInt32 Child, const GSpatialBox2& LeafBox) const {
+			GReal p = Union(gNodes[Child].Box, LeafBox).HalfPerimeter();
+			return (IsLeaf(Child)) ? p : (p - gNodes[Child].Box.HalfPerimeter());
+		}
+
+		// unlink a leaf from the tree (the leaf node itself is not freed)
+		void RemoveLeaf(const GInt32 Leaf) {
+
+			if (Leaf == gRoot) {
+				gRoot = -1;
+				return;
+			}
+
+			GInt32 parent = gNodes[Leaf].Parent;
+			GInt32 grandParent = gNodes[parent].Parent;
+			GInt32 sibling = (gNodes[parent].Left == Leaf) ? gNodes[parent].Right : gNodes[parent].Left;
+
+			if (grandParent < 0) {
+				gRoot = sibling;
+				gNodes[sibling].Parent = -1;
+			}
+			else {
+				if (gNodes[grandParent].Left == parent)
+					gNodes[grandParent].Left = sibling;
+				else
+					gNodes[grandParent].Right = sibling;
+				gNodes[sibling].Parent = grandParent;
+				RefitUp(grandParent);
+			}
+			FreeNode(parent);
+		}
+
+	public:
+		//! Default constructor, builds an empty hierarchy.
+		GBVH2() : gRoot(-1) {
+		}
+
+		//! Number of items.
+		inline GUInt32 Count() const {
+			return gItems.Count();
+		}
+		//! Return G_TRUE if the handle refers to an item.
+		inline GBool IsValid(const GUInt32 Handle) const {
+			return gItems.IsValid(Handle);
+		}
+		//! Get an item.
+		inline const ITEM& Item(const GUInt32 Handle) const {
+			G_ASSERT(gItems.IsValid(Handle));
+			return gItems.Item(Handle);
+		}
+		//! Bounding box of all items (an inverted box if the hierarchy is empty).
+		inline GSpatialBox2 Bounds() const {
+			return (gRoot < 0) ? GSpatialBox2() : gNodes[gRoot].Box;
+		}
+
+		//! Remove all items.
+		void Clear() {
+			gItems.Clear();
+			gNodes.clear();
+			gFreeNodes.clear();
+			gRoot = -1;
+		}
+
+		/*!
+			Build the hierarchy from an array of items, using the SAH.
+
+			Previous items are removed. The handle of each item is its index inside the Items array.
+		*/
+		void Build(const GDynArray<ITEM>& Items) {
+
+			GUInt32 i, j = (GUInt32)Items.size();
+
+			Clear();
+			gItems.Reserve(j);
+			for (i = 0; i < j; ++i)
+				gItems.Add(Items[i]);
+			Rebuild();
+		}
+
+		//! Rebuild the whole hierarchy over current items, using the SAH. Handles are preserved.
+		void Rebuild() {
+
+			GDynArray<GBuildEntry> entries;
+			GUInt32 i, j = gItems.HandlesCount();
+
+			gNodes.clear();
+			gFreeNodes.clear();
+			gRoot = -1;
+			if (gItems.Count() == 0)
+				return;
+
+			entries.reserve(gItems.Count());
+			for (i = 0; i < j; ++i) {
+				if (!gItems.IsValid(i))
+					continue;
+				GBuildEntry e;
+				e.Box = gItems.Box(i);
+				e.CenterX = (e.Box.MinX + e.Box.MaxX) / 2;
+				e.CenterY = (e.Box.MinY + e.Box.MaxY) / 2;
+				e.Handle = i;
+				entries.push_back(e);
+			}
+			gNodes.reserve(2 * entries.size());
+			gRoot = BuildRange(entries, 0, (GUInt32)entries.size(), -1);
+		}
+
+		/*!
+			Insert an item.
+
+			\return the handle of the inserted item.
+		*/
+		GUInt32 Insert(const ITEM& Item) {
+
+			GUInt32 handle = gItems.Add(Item);
+			GInt32 leaf = AllocNode();
+
+			gNodes[leaf].Box = gItems.Box(handle);
+			gNodes[leaf].Item = (GInt32)handle;
+			gItems.Slot(handle) = leaf;
+			InsertLeaf(leaf);
+			return handle;
+		}
+
+		/*!
+			Remove an item.
+
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+		*/
+		GBool Remove(const GUInt32 Handle) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+
+			GInt32 leaf = gItems.Slot(Handle);
+			RemoveLeaf(leaf);
+			FreeNode(leaf);
+			gItems.Remove(Handle);
+			return G_TRUE;
+		}
+
+		/*!
+			Replace an item and update the hierarchy.
+
+			If the new bounding box is still inside the old one, only the leaf is updated; else the leaf is
+			moved in the best place of the tree.
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+		*/
+		GBool Update(const GUInt32 Handle, const ITEM& Item) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+
+			GInt32 leaf = gItems.Slot(Handle);
+			gItems.Set(Handle, Item);
+			if (gNodes[leaf].Box.Contains(gItems.Box(Handle)) && gNodes[leaf].Parent >= 0) {
+				gNodes[leaf].Box = gItems.Box(Handle);
+				RefitUp(gNodes[leaf].Parent);
+				return G_TRUE;
+			}
+			RemoveLeaf(leaf);
+			gNodes[leaf].Box = gItems.Box(Handle);
+			InsertLeaf(leaf);
+			return G_TRUE;
+		}
+
+		/*!
+			Replace an item without updating the hierarchy.
+
+			It must be followed by a call to Refit() (or Rebuild()) before the next query.
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+		*/
+		GBool SetItem(const GUInt32 Handle, const ITEM& Item) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+			gItems.Set(Handle, Item);
+			return G_TRUE;
+		}
+
+		/*!
+			Recalculate all node boxes from current items, keeping the tree topology.
+
+			This is the cheapest way to update the hierarchy when many items move a little (for example when
+			animated); if items move a lot, Rebuild() gives better query performance.
+		*/
+		void Refit() {
+
+			if (gRoot < 0)
+				return;
+
+			// post-order visit without recursion
+			GDynArray<GInt32> stack;
+			GInt32 index, last = -1;
+
+			index = gRoot;
+			while (index >= 0 || !stack.empty()) {
+				if (index >= 0) {
+					if (IsLeaf(index)) {
+						gNodes[index].Box = gItems.Box((GUInt32)gNodes[index].Item);
+						last = index;
+						index = -1;
+					}
+					else {
+						stack.push_back(index);
+						index = gNodes[index].Left;
+					}
+				}
+				else {
+					GInt32 top = stack.back();
+					if (gNodes[top].Right != last) {
+						index = gNodes[top].Right;
+					}
+					else {
+						gNodes[top].Box = Union(gNodes[gNodes[top].Left].Box, gNodes[gNodes[top].Right].Box);
+						last = top;
+						stack.pop_back();
+					}
+				}
+			}
+		}
+
+		/*!
+			Find all items whose bounding box overlaps the specified box.
+
+			\param Box the query box.
+			\param Result handles of found items (previous content is discarded).
+		*/
+		void Query(const GAABox2& Box, GDynArray<GUInt32>& Result) const {
+
+			GSpatialBox2 box(Box);
+			GDynArray<GInt32> stack;
+
+			Result.clear();
+			if (gRoot < 0)
+				return;
+			stack.push_back(gRoot);
+			while (!stack.empty()) {
+				GInt32 index = stack.back();
+				stack.pop_back();
+				const GBVHNode& n = gNodes[index];
+				if (!n.Box.Overlaps(box))
+					continue;
+				if (n.Left < 0)
+					Result.push_back((GUInt32)n.Item);
+				else {
+					stack.push_back(n.Right);
+					stack.push_back(n.Left);
+				}
+			}
+		}
+
+		/*!
+			Find all items intersected by a ray.
+
+			Each item whose bounding box is reached by the ray is tested with TRAITS::Intersect().
+			\param Ray the query ray.
+			\param Result intersected items and their ray parameters, sorted by ascending parameter (previous
+			content is discarded).
+		*/
+		void Query(const GRay2& Ray, GDynArray<GSpatialHit2>& Result) const {
+
+			GSpatialRay2 ray(Ray);
+			GDynArray<GInt32> stack;
+			GReal t;
+
+			Result.clear();
+			if (gRoot < 0)
+				return;
+			stack.push_back(gRoot);
+			while (!stack.empty()) {
+				GInt32 index = stack.back();
+				stack.pop_back();
+				const GBVHNode& n = gNodes[index];
+				if (!ray.Hit(n.Box, G_MAX_REAL, t))
+					continue;
+				if (n.Left < 0) {
+					if (TRAITS::Intersect(gItems.Item((GUInt32)n.Item), Ray, t))
+						Result.push_back(GSpatialHit2((GUInt32)n.Item, t));
+				}
+				else {
+					stack.push_back(n.Right);
+					stack.push_back(n.Left);
+				}
+			}
+			std::sort(Result.begin(), Result.end());
+		}
+
+		/*!
+			Find the K items nearest to a point, according to TRAITS::DistanceSquared().
+
+			\param Point the query point.
+			\param K the number of wanted items.
+			\param Result the nearest items and their distances, sorted by ascending distance (previous content is
+			discarded). It contains less than K entries if the hierarchy contains less than K items.
+		*/
+		void Nearest(const GPoint2& Point, const GUInt32 K, GDynArray<GSpatialHit2>& Result) const {
+
+			GSpatialNearest2 nearest(K);
+			GDynArray<GSpatialQueueEntry2> queue;
+			GReal x = Point[G_X], y = Point[G_Y];
+
+			Result.clear();
+			if (gRoot < 0 || K == 0)
+				return;
+			queue.push_back(GSpatialQueueEntry2(gRoot, gNodes[gRoot].Box.DistanceSquared(x, y)));
+			while (!queue.empty()) {
+				std::pop_heap(queue.begin(), queue.end());
+				GSpatialQueueEntry2 e = queue.back();
+				queue.pop_back();
+				// all remaining nodes are farther than the worst kept candidate
+				if (e.DistanceSquared > nearest.WorstDistanceSquared())
+					break;
+				const GBVHNode& n = gNodes[e.Node];
+				if (n.Left < 0)
+					nearest.Offer((GUInt32)n.Item, TRAITS::DistanceSquared(gItems.Item((GUInt32)n.Item), Point));
+				else {
+					queue.push_back(GSpatialQueueEntry2(n.Left, gNodes[n.Left].Box.DistanceSquared(x, y)));
+					std::push_heap(queue.begin(), queue.end());
+					queue.push_back(GSpatialQueueEntry2(n.Right, gNodes[n.Right].Box.DistanceSquared(x, y)));
+					std::push_heap(queue.begin(), queue.end());
+				}
+			}
+			nearest.Extract(Result);
+		}
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -0,0 +1,496 @@
+/****************************************************************************
+** $file: amanith/geometry/ggrid2.h   0.3.0.0   edited Jan, 30 2006
+**
+** 2D uniform grid.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GGRID2_H
+#define GGRID2_H
+
+#include "amanith/geometry/gspatial2.h"
+
+/*!
+	\file ggrid2.h
+	\brief Header file for GGrid2 class.
+*/
+namespace Amanith {
+
+	/*!
+		\class GGrid2
+		\brief A 2D uniform grid.
+
+		The grid divides its bounds into CellsX * CellsY cells of the same size; each item is registered into
+		every cell overlapped by its bounding box. Items whose bounding box is not inside the grid bounds are kept
+		into an overflow list, that is scanned by every query. Ray queries walk the cells crossed by the ray, in
+		order (3D-DDA algorithm of Amanatides and Woo, reduced to 2D); nearest neighbor queries visit rings of
+		cells of growing radius.
+
+		A uniform grid is the best choice for items of similar size, uniformly distributed, that move a lot:
+		insertion and removal costs do not depend on the number of items.
+
+		\param ITEM type of the stored primitives (for example GAABox2, GSphere2, GLineSegment2 or GPoint2).
+		\param TRAITS the spatial traits of ITEM, see GSpatialTraits2.
+	*/
+	template<typename ITEM, typename TRAITS = GSpatialTraits2<ITEM> >
+	class GGrid2 {
+
+	private:
+		GSpatialItems2<ITEM, TRAITS> gItems;
+		GDynArray< GDynArray<GUInt32> > gCells;
+		GDynArray<GUInt32> gOverflow;
+		GSpatialBox2 gBounds;
+		GInt32 gCellsX;
+		GInt32 gCellsY;
+		GReal gCellWidth;
+		GReal gCellHeight;
+		// query marks, used to report items registered in more than one cell only once
+		mutable GDynArray<GUInt32> gMarks;
+		mutable GUInt32 gMark;
+
+		void SetupCells(const GSpatialBox2& Bounds, const GUInt32 CellsX, const GUInt32 CellsY) {
+
+			gBounds = Bounds;
+			gCellsX = (GInt32)GMath::Max(CellsX, (GUInt32)1);
+			gCellsY = (GInt32)GMath::Max(CellsY, (GUInt32)1);
+			gCellWidth = (gBounds.MaxX - gBounds.MinX) / gCellsX;
+			gCellHeight = (gBounds.MaxY - gBounds.MinY) / gCellsY;
+			if (gCellWidth <= 0)
+				gCellWidth = 1;
+			if (gCellHeight <= 0)
+				gCellHeight = 1;
+			gCells.clear();
+			gCells.resize(gCellsX * gCellsY);
+			gOverflow.clear();
+		}
+
+		inline GInt32 CellX(const GReal X) const {
+			GReal f = (X - gBounds.MinX) / gCellWidth;
+			return (f <= 0) ? 0 : ((f >= gCellsX) ? gCellsX - 1 : (GInt32)f);
+		}
+
+		inline GInt32 CellY(const GReal Y) const {
+			GReal f = (Y - gBounds.MinY) / gCellHeight;
+			return (f <= 0) ? 0 : ((f >= gCellsY) ? gCellsY - 1 : (GInt32)f);
+		}
+
+		inline GDynArray<GUInt32>& Cell(const GInt32 X, const GInt32 Y) {
+			return gCells[Y * gCellsX + X];
+		}
+
+		inline const GDynArray<GUInt32>& Cell(const GInt32 X, const GInt32 Y) const {
+			return gCells[Y * gCellsX + X];
+		}
+
+		void InsertHandle(const GUInt32 Handle) {
+
+			const GSpatialBox2& box = gItems.Box(Handle);
+			GInt32 x, y, x0, y0, x1, y1;
+
+			if (!gBounds.Contains(box)) {
+				gItems.Slot(Handle) = -1;
+				gOverflow.push_back(Handle);
+				return;
+			}
+			gItems.Slot(Handle) = 0;
+			x0 = CellX(box.MinX);
+			x1 = CellX(box.MaxX);
+			y0 = CellY(box.MinY);
+			y1 = CellY(box.MaxY);
+			for (y = y0; y <= y1; ++y)
+				for (x = x0; x <= x1; ++x)
+					Cell(x, y).push_back(Handle);
+		}
+
+		static void EraseHandle(GDynArray<GUInt32>& List, const GUInt32 Handle) {
+
+			GUInt32 i, j = (GUInt32)List.size();
+
+			for (i = 0; i < j; ++i) {
+				if (List[i] == Handle) {
+					List[i] = List[j - 1];
+					List.pop_back();
+					return;
+				}
+			}
+		}
+
+		void RemoveHandle(const GUInt32 Handle) {
+
+			const GSpatialBox2& box = gItems.Box(Handle);
+			GInt32 x, y, x0, y0, x1, y1;
+
+			if (gItems.Slot(Handle) < 0) {
+				EraseHandle(gOverflow, Handle);
+				return;
+			}
+			x0 = CellX(box.MinX);
+			x1 = CellX(box.MaxX);
+			y0 = CellY(box.MinY);
+			y1 = CellY(box.MaxY);
+			for (y = y0; y <= y1; ++y)
+				for (x = x0; x <= x1; ++x)
+					EraseHandle(Cell(x, y), Handle);
+		}
+
+		// start a new query, it returns the mark value for visited items
+		GUInt32 NewMark() const {
+
+			if (gMarks.size() < gItems.HandlesCount())
+				gMarks.resize(gItems.HandlesCount(), 0);
+			gMark++;
+			if (gMark == 0) {
+				std::fill(gMarks.begin(), gMarks.end(), (GUInt32)0);
+				gMark = 1;
+			}
+			return gMark;
+		}
+
+		// return G_TRUE the first time an item is visited by the current query
+		inline GBool Visit(const GUInt32 Handle, const GUInt32 Mark) const {
+			if (gMarks[Handle] == Mark)
+				return G_FALSE;
+			gMarks[Handle] = Mark;
+			return G_TRUE;
+		}
+
+		// offer the items of a cell to a nearest neighbor query
+		void NearestCell(const GInt32 X, const GInt32 Y, const GPoint2& Point, const GUInt32 Mark,
+						 GSpatialNearest2& Nearest) const {
+
+			const GDynArray<GUInt32>& cell = Cell(X, Y);
+			GUInt32 i, h, j = (GUInt32)cell.size();
+
+			for (i = 0; i < j; ++i) {
+				h = cell[i];
+				if (Visit(h, Mark) && gItems.Box(h).DistanceSquared(Point[G_X], Point[G_Y]) <= Nearest.WorstDistanceSquared())
+					Nearest.Offer(h, TRAITS::DistanceSquared(gItems.Item(h), Point));
+			}
+		}
+
+	public:
+		/*!
+			Constructor.
+
+			\param Bounds the region covered by the grid.
+			\param CellsX number of cells along x axis.
+			\param CellsY number of cells along y axis.
+		*/
+		GGrid2(const GAABox2& Bounds = GAABox2(GPoint2(0, 0), GPoint2(1, 1)), const GUInt32 CellsX = 1,
+			   const GUInt32 CellsY = 1) : gMark(0) {
+			SetupCells(GSpatialBox2(Bounds), CellsX, CellsY);
+		}
+
+		//! Number of items.
+		inline GUInt32 Count() const {
+			return gItems.Count();
+		}
+		//! Return G_TRUE if the handle refers to an item.
+		inline GBool IsValid(const GUInt32 Handle) const {
+			return gItems.IsValid(Handle);
+		}
+		//! Get an item.
+		inline const ITEM& Item(const GUInt32 Handle) const {
+			G_ASSERT(gItems.IsValid(Handle));
+			return gItems.Item(Handle);
+		}
+		//! Get the region covered by the grid.
+		inline GAABox2 Bounds() const {
+			return gBounds.AABox();
+		}
+		//! Number of cells along x axis.
+		inline GUInt32 CellsX() const {
+			return (GUInt32)gCellsX;
+		}
+		//! Number of cells along y axis.
+		inline GUInt32 CellsY() const {
+			return (GUInt32)gCellsY;
+		}
+
+		//! Remove all items.
+		void Clear() {
+			gItems.Clear();
+			gMarks.clear();
+			gMark = 0;
+			SetupCells(gBounds, (GUInt32)gCellsX, (GUInt32)gCellsY);
+		}
+
+		/*!
+			Change the grid layout; items are redistributed and handles are preserved.
+
+			\param Bounds the region covered by the grid.
+			\param CellsX number of cells along x axis.
+			\param CellsY number of cells along y axis.
+		*/
+		void SetGrid(const GAABox2& Bounds, const GUInt32 CellsX, const GUInt32 CellsY) {
+
+			GUInt32 i, j = gItems.HandlesCount();
+
+			SetupCells(GSpatialBox2(Bounds), CellsX, CellsY);
+			for (i = 0; i < j; ++i) {
+				if (gItems.IsValid(i))
+					InsertHandle(i);
+			}
+		}
+
+		/*!
+			Build the grid from an array of items.
+
+			Previous items are removed. Bounds are set to the bounding box of all items, and the number of cells
+			is chosen to be about the number of items (up to 2048 * 2048 cells), with cells as square as possible.
+			The handle of each item is its index inside the Items array.
+		*/
+		void Build(const GDynArray<ITEM>& Items) {
+
+			GUInt32 i, j = (GUInt32)Items.size();
+
+			gItems.Clear();
+			gMarks.clear();
+			gMark = 0;
+			gItems.Reserve(j);
+			for (i = 0; i < j; ++i)
+				gItems.Add(Items[i]);
+
+			GSpatialBox2 bounds = (j > 0) ? gItems.Bounds() : GSpatialBox2(0, 0, 1, 1);
+			GReal w = GMath::Max(bounds.MaxX - bounds.MinX, (GReal)G_EPSILON);
+			GReal h = GMath::Max(bounds.MaxY - bounds.MinY, (GReal)G_EPSILON);
+			GReal cx = GMath::Sqrt((GReal)GMath::Max(j, (GUInt32)1) * w / h);
+			GUInt32 cellsX = (GUInt32)GMath::Clamp(cx, (GReal)1, (GReal)2048);
+			GUInt32 cellsY = (GUInt32)GMath::Clamp((GReal)GMath::Max(j, (GUInt32)1) / cellsX, (GReal)1, (GReal)2048);
+
+			SetupCells(bounds, cellsX, cellsY);
+			for (i = 0; i < j; ++i)
+				InsertHandle(i);
+		}
+
+		/*!
+			Insert an item.
+
+			\return the handle of the inserted item.
+		*/
+		GUInt32 Insert(const ITEM& Item) {
+
+			GUInt32 handle = gItems.Add(Item);
+			InsertHandle(handle);
+			return handle;
+		}
+
+		/*!
+			Remove an item.
+
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+		*/
+		GBool Remove(const GUInt32 Handle) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+			RemoveHandle(Handle);
+			gItems.Remove(Handle);
+			return G_TRUE;
+		}
+
+		/*!
+			Replace an item, moving it to the cells overlapped by its new bounding box.
+
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+		*/
+		GBool Update(const GUInt32 Handle, const ITEM& Item) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+			RemoveHandle(Handle);
+			gItems.Set(Handle, Item);
+			InsertHandle(Handle);
+			return G_TRUE;
+		}
+
+		/*!
+			Find all items whose bounding box overlaps the specified box.
+
+			\param Box the query box.
+			\param Result handles of found items (previous content is discarded).
+		*/
+		void Query(const GAABox2& Box, GDynArray<GUInt32>& Result) const {
+
+			GSpatialBox2 box(Box);
+			GUInt32 i, j, h, mark = NewMark();
+			GInt32 x, y, x0, y0, x1, y1;
+
+			Result.clear();
+			for (i = 0; i < (GUInt32)gOverflow.size(); ++i) {
+				if (gItems.Box(gOverflow[i]).Overlaps(box))
+					Result.push_back(gOverflow[i]);
+			}
+			if (!gBounds.Overlaps(box))
+				return;
+			x0 = CellX(box.MinX);
+			x1 = CellX(box.MaxX);
+			y0 = CellY(box.MinY);
+			y1 = CellY(box.MaxY);
+			for (y = y0; y <= y1; ++y) {
+				for (x = x0; x <= x1; ++x) {
+					const GDynArray<GUInt32>& cell = Cell(x, y);
+					j = (GUInt32)cell.size();
+					for (i = 0; i < j; ++i) {
+						h = cell[i];
+						if (Visit(h, mark) && gItems.Box(h).Overlaps(box))
+							Result.push_back(h);
+					}
+				}
+			}
+		}
+
+		/*!
+			Find all items intersected by a ray.
+
+			Each item registered in a cell crossed by the ray is tested with TRAITS::Intersect().
+			\param Ray the query ray.
+			\param Result intersected items and their ray parameters, sorted by ascending parameter (previous
+			content is discarded).
+		*/
+		void Query(const GRay2& Ray, GDynArray<GSpatialHit2>& Result) const {
+
+			GSpatialRay2 ray(Ray);
+			GUInt32 i, j, h, mark = NewMark();
+			GReal t, tEnter;
+
+			Result.clear();
+			for (i = 0; i < (GUInt32)gOverflow.size(); ++i) {
+				h = gOverflow[i];
+				if (ray.Hit(gItems.Box(h), G_MAX_REAL, t) && TRAITS::Intersect(gItems.Item(h), Ray, t))
+					Result.push_back(GSpatialHit2(h, t));
+			}
+
+			if (ray.Hit(gBounds, G_MAX_REAL, tEnter)) {
+				// entry cell
+				GInt32 x = CellX(ray.OriginX + tEnter * ray.DirectionX);
+				GInt32 y = CellY(ray.OriginY + tEnter * ray.DirectionY);
+				GInt32 stepX = (ray.DirectionX > 0) ? 1 : ((ray.DirectionX < 0) ? -1 : 0);
+				GInt32 stepY = (ray.DirectionY > 0) ? 1 : ((ray.DirectionY < 0) ? -1 : 0);
+				// ray parameters of the next vertical and horizontal cell boundaries, and their increments
+				GReal tMaxX = G_MAX_REAL, tMaxY = G_MAX_REAL, tDeltaX = G_MAX_REAL, tDeltaY = G_MAX_REAL;
+
+				if (stepX != 0) {
+					tMaxX = (gBounds.MinX + (x + (stepX > 0 ? 1 : 0)) * gCellWidth - ray.OriginX) * ray.InvDirectionX;
+					tDeltaX = gCellWidth * GMath::Abs(ray.InvDirectionX);
+				}
+				if (stepY != 0) {
+					tMaxY = (gBounds.MinY + (y + (stepY > 0 ? 1 : 0)) * gCellHeight - ray.OriginY) * ray.InvDirectionY;
+					tDeltaY = gCellHeight * GMath::Abs(ray.InvDirectionY);
+				}
+
+				for (;;) {
+					const GDynArray<GUInt32>& cell = Cell(x, y);
+					j = (GUInt32)cell.size();
+					for (i = 0; i < j; ++i) {
+						h = cell[i];
+						if (Visit(h, mark) && TRAITS::Intersect(gItems.Item(h), Ray, t))
+							Result.push_back(GSpatialHit2(h, t));
+					}
+					// a zero length ray touches a single cell
+					if (stepX == 0 && stepY == 0)
+						break;
+					if (tMaxX < tMaxY) {
+						x += stepX;
+						if (x < 0 || x >= gCellsX)
+							break;
+						tMaxX += tDeltaX;
+					}
+					else {
+						y += stepY;
+						if (y < 0 || y >= gCellsY)
+							break;
+						tMaxY += tDeltaY;
+					}
+				}
+			}
+			std::sort(Result.begin(), Result.end());
+		}
+
+		/*!
+			Find the K items nearest to a point, according to TRAITS::DistanceSquared().
+
+			\param Point the query point.
+			\param K the number of wanted items.
+			\param Result the nearest items and their distances, sorted by ascending distance (previous content is
+			discarded). It contains less than K entries if the grid contains less than K items.
+		*/
+		void Nearest(const GPoint2& Point, const GUInt32 K, GDynArray<GSpatialHit2>& Result) const {
+
+			GSpatialNearest2 nearest(K);
+			GReal px = Point[G_X], py = Point[G_Y];
+			GUInt32 i, h, mark = NewMark();
+			GInt32 x, y, r, cx, cy, x0, y0, x1, y1;
+
+			Result.clear();
+			if (K == 0)
+				return;
+			for (i = 0; i < (GUInt32)gOverflow.size(); ++i) {
+				h = gOverflow[i];
+				nearest.Offer(h, TRAITS::DistanceSquared(gItems.Item(h), Point));
+			}
+
+			cx = CellX(px);
+			cy = CellY(py);
+			for (r = 0; ; ++r) {
+				x0 = cx - r;
+				x1 = cx + r;
+				y0 = cy - r;
+				y1 = cy + r;
+				// visit the cells of the ring at distance r
+				for (y = GMath::Max(y0, (GInt32)0); y <= GMath::Min(y1, gCellsY - 1); ++y) {
+					if (y == y0 || y == y1) {
+						for (x = GMath::Max(x0, (GInt32)0); x <= GMath::Min(x1, gCellsX - 1); ++x)
+							NearestCell(x, y, Point, mark, nearest);
+					}
+					else {
+						if (x0 >= 0)
+							NearestCell(x0, y, Point, mark, nearest);
+						if (x1 < gCellsX)
+							NearestCell(x1, y, Point, mark, nearest);
+					}
+				}
+				// every cell has been visited
+				if (x0 <= 0 && y0 <= 0 && x1 >= gCellsX - 1 && y1 >= gCellsY - 1)
+					break;
+				// every unvisited cell lies beyond (at least) one side of the visited block
+				GReal bound = G_MAX_REAL;
+				if (x0 > 0)
+					bound = GMath::Min(bound, GMath::Max((GReal)0, px - (gBounds.MinX + x0 * gCellWidth)));
+				if (x1 < gCellsX - 1)
+					bound = GMath::Min(bound, GMath::Max((GReal)0, (gBounds.MinX + (x1 + 1) * gCellWidth) - px));
+				if (y0 > 0)
+					bound = GMath::Min(bound, GMath::Max((GReal)0, py - (gBounds.MinY + y0 * gCellHeight)));
+				if (y1 < gCellsY - 1)
+					bound = GMath::Min(bound, GMath::Max((GReal)0, (gBounds.MinY + (y1 + 1) * gCellHeight) - py));
+				if (bound * bound >= nearest.WorstDistanceSquared())
+					break;
+			}
+			nearest.Extract(Result);
+		}
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -473,6 +473,156 @@ namespace Amanith {
 		return Result = ret_mat;
 	}
 
+	/*!
+		2x2 matrix multiply, fully unrolled; it is selected instead of the generic Mult() for 2x2 operands.
+		\post Result = lhs * rhs  (where rhs is applied first)
+	*/
+	template <typename DATA_TYPE>
+	inline GMatrix<DATA_TYPE, 2, 2>& Mult(GMatrix<DATA_TYPE, 2, 2>& Result,
+										  const GMatrix<DATA_TYPE, 2, 2>& lhs,
+										  const GMatrix<DATA_TYPE, 2, 2>& rhs) {
+		// read everything before writing, Result can be lhs or rhs
+		DATA_TYPE r00 = lhs(0, 0) * rhs(0, 0) + lhs(0, 1) * rhs(1, 0);
+		DATA_TYPE r01 = lhs(0, 0) * rhs(0, 1) + lhs(0, 1) * rhs(1, 1);
+		DATA_TYPE r10 = lhs(1, 0) * rhs(0, 0) + lhs(1, 1) * rhs(1, 0);
+		DATA_TYPE r11 = lhs(1, 0) * rhs(0, 1) + lhs(1, 1) * rhs(1, 1);
+
+		Result(0, 0) = r00;
+		Result(0, 1) = r01;
+		Result(1, 0) = r10;
+		Result(1, 1) = r11;
+		return Result;
+	}
+
+	/*!
+		3x3 matrix multiply, fully unrolled; it is selected instead of the generic Mult() for 3x3 operands.
+		\post Result = lhs * rhs  (where rhs is applied first)
+	*/
+	template <typename DATA_TYPE>
+	inline GMatrix<DATA_TYPE, 3, 3>& Mult(GMatrix<DATA_TYPE, 3, 3>& Result,
+										  const GMatrix<DATA_TYPE, 3, 3>& lhs,
+										  const GMatrix<DATA_TYPE, 3, 3>& rhs) {
+		// read everything before writing, Result can be lhs or rhs
+		DATA_TYPE r00 = lhs(0, 0) * rhs(0, 0) + lhs(0, 1) * rhs(1, 0) + lhs(0, 2) * rhs(2, 0);
+		DATA_TYPE r01 = lhs(0, 0) * rhs(0, 1) + lhs(0, 1) * rhs(1, 1) + lhs(0, 2) * rhs(2, 1);
+		DATA_TYPE r02 = lhs(0, 0) * rhs(0, 2) + lhs(0, 1) * rhs(1, 2) + lhs(0, 2) * rhs(2, 2);
+		DATA_TYPE r10 = lhs(1, 0) * rhs(0, 0) + lhs(1, 1) * rhs(1, 0) + lhs(1, 2) * rhs(2, 0);
+		DATA_TYPE r11 = lhs(1, 0) * rhs(0, 1) + lhs(1, 1) * rhs(1, 1) + lhs(1, 2) * rhs(2, 1);
+		DATA_TYPE r12 = lhs(1, 0) * rhs(0, 2) + lhs(1, 1) * rhs(1, 2) + lhs(1, 2) * rhs(2, 2);
+		DATA_TYPE r20 = lhs(2, 0) * rhs(0, 0) + lhs(2, 1) * rhs(1, 0) + lhs(2, 2) * rhs(2, 0);
+		DATA_TYPE r21 = lhs(2, 0) * rhs(0, 1) + lhs(2, 1) * rhs(1, 1) + lhs(2, 2) * rhs(2, 1);
+		DATA_TYPE r22 = lhs(2, 0) * rhs(0, 2) + lhs(2, 1) * rhs(1, 2) + lhs(2, 2) * rhs(2, 2);
+
+		Result(0, 0) = r00;
+		Result(0, 1) = r01;
+		Result(0, 2) = r02;
+		Result(1, 0) = r10;
+		Result(1, 1) = r11;
+		Result(1, 2) = r12;
+		Result(2, 0) = r20;
+		Result(2, 1) = r21;
+		Result(2, 2) = r22;
+		return Result;
+	}
+
+	/*!
+		4x4 matrix multiply, fully unrolled; it is selected instead of the generic Mult() for 4x4 operands.
+		\post Result = lhs * rhs  (where rhs is applied first)
+	*/
+	template <typename DATA_TYPE>
+	inline GMatrix<DATA_TYPE, 4, 4>& Mult(GMatrix<DATA_TYPE, 4, 4>& Result,
+										  const GMatrix<DATA_TYPE, 4, 4>& lhs,
+										  const GMatrix<DATA_TYPE, 4, 4>& rhs) {
+		// read everything before writing, Result can be lhs or rhs
+		DATA_TYPE r00 = lhs(0, 0) * rhs(0, 0) + lhs(0, 1) * rhs(1, 0) + lhs(0, 2) * rhs(2, 0) + lhs(0, 3) * rhs(3, 0);
+		DATA_TYPE r01 = lhs(0, 0) * rhs(0, 1) + lhs(0, 1) * rhs(1, 1) + lhs(0, 2) * rhs(2, 1) + lhs(0, 3) * rhs(3, 1);
+		DATA_TYPE r02 = lhs(0, 0) * rhs(0, 2) + lhs(0, 1) * rhs(1, 2) + lhs(0, 2) * rhs(2, 2) + lhs(0, 3) * rhs(3, 2);
+		DATA_TYPE r03 = lhs(0, 0) * rhs(0, 3) + lhs(0, 1) * rhs(1, 3) + lhs(0, 2) * rhs(2, 3) + lhs(0, 3) * rhs(3, 3);
+		DATA_TYPE r10 = lhs(1, 0) * rhs(0, 0) + lhs(1, 1) * rhs(1, 0) + lhs(1, 2) * rhs(2, 0) + lhs(1, 3) * rhs(3, 0);
+		DATA_TYPE r11 = lhs(1, 0) * rhs(0, 1) + lhs(1, 1) * rhs(1, 1) + lhs(1, 2) * rhs(2, 1) + lhs(1, 3) * rhs(3, 1);
+		DATA_TYPE r12 = lhs(1, 0) * rhs(0, 2) + lhs(1, 1) * rhs(1, 2) + lhs(1, 2) * rhs(2, 2) + lhs(1, 3) * rhs(3, 2);
+		DATA_TYPE r13 = lhs(1, 0) * rhs(0, 3) + lhs(1, 1) * rhs(1, 3) + lhs(1, 2) * rhs(2, 3) + lhs(1, 3) * rhs(3, 3);
+		DATA_TYPE r20 = lhs(2, 0) * rhs(0, 0) + lhs(2, 1) * rhs(1, 0) + lhs(2, 2) * rhs(2, 0) + lhs(2, 3) * rhs(3, 0);
+		DATA_TYPE r21 = lhs(2, 0) * rhs(0, 1) + lhs(2, 1) * rhs(1, 1) + lhs(2, 2) * rhs(2, 1) + lhs(2, 3) * rhs(3, 1);
+		DATA_TYPE r22 = lhs(2, 0) * rhs(0, 2) + lhs(2, 1) * rhs(1, 2) + lhs(2, 2) * rhs(2, 2) + lhs(2, 3) * rhs(3, 2);
+		DATA_TYPE r23 = lhs(2, 0) * rhs(0, 3) + lhs(2, 1) * rhs(1, 3) + lhs(2, 2) * rhs(2, 3) + lhs(2, 3) * rhs(3, 3);
+		DATA_TYPE r30 = lhs(3, 0) * rhs(0, 0) + lhs(3, 1) * rhs(1, 0) + lhs(3, 2) * rhs(2, 0) + lhs(3, 3) * rhs(3, 0);
+		DATA_TYPE r31 = lhs(3, 0) * rhs(0, 1) + lhs(3, 1) * rhs(1, 1) + lhs(3, 2) * rhs(2, 1) + lhs(3, 3) * rhs(3, 1);
+		DATA_TYPE r32 = lhs(3, 0) * rhs(0, 2) + lhs(3, 1) * rhs(1, 2) + lhs(3, 2) * rhs(2, 2) + lhs(3, 3) * rhs(3, 2);
+		DATA_TYPE r33 = lhs(3, 0) * rhs(0, 3) + lhs(3, 1) * rhs(1, 3) + lhs(3, 2) * rhs(2, 3) + lhs(3, 3) * rhs(3, 3);
+
+		Result(0, 0) = r00;
+		Result(0, 1) = r01;
+		Result(0, 2) = r02;
+		Result(0, 3) = r03;
+		Result(1, 0) = r10;
+		Result(1, 1) = r11;
+		Result(1, 2) = r12;
+		Result(1, 3) = r13;
+		Result(2, 0) = r20;
+		Result(2, 1) = r21;
+		Result(2, 2) = r22;
+		Result(2, 3) = r23;
+		Result(3, 0) = r30;
+		Result(3, 1) = r31;
+		Result(3, 2) = r32;
+		Result(3, 3) = r33;
+		return Result;
+	}
+
+	/*!
+		Affine 3x3 matrix multiply.
+		\pre the last row of both matrices must be (0, 0, 1); it is not read.
+		\post Result = lhs * rhs  (where rhs is applied first), with last row set to (0, 0, 1).
+	*/
+	template <typename DATA_TYPE>
+	inline GMatrix<DATA_TYPE, 3, 3>& MultAffine(GMatrix<DATA_TYPE, 3, 3>& Result,
+												const GMatrix<DATA_TYPE, 3, 3>& lhs,
+												const GMatrix<DATA_TYPE, 3, 3>& rhs) {
+		// read everything before writing, Result can be lhs or rhs
+		DATA_TYPE r00 = lhs(0, 0) * rhs(0, 0) + lhs(0, 1) * rhs(1, 0);
+		DATA_TYPE r01 = lhs(0, 0) * rhs(0, 1) + lhs(0, 1) * rhs(1, 1);
+		DATA_TYPE r02 = lhs(0, 0) * rhs(0, 2) + lhs(0, 1) * rhs(1, 2) + lhs(0, 2);
+		DATA_TYPE r10 = lhs(1, 0) * rhs(0, 0) + lhs(1, 1) * rhs(1, 0);
+		DATA_TYPE r11 = lhs(1, 0) * rhs(0, 1) + lhs(1, 1) * rhs(1, 1);
+		DATA_TYPE r12 = lhs(1, 0) * rhs(0, 2) + lhs(1, 1) * rhs(1, 2) + lhs(1, 2);
+
+		Result(0, 0) = r00;
+		Result(0, 1) = r01;
+		Result(0, 2) = r02;
+		Result(1, 0) = r10;
+		Result(1, 1) = r11;
+		Result(1, 2) = r12;
+		Result(2, 0) = 0;
+		Result(2, 1) = 0;
+		Result(2, 2) = 1;
+		return Result;
+	}
+
+	/*!
+		Affine 2x3 matrix composition; both matrices are treated as 3x3 matrices with (0, 0, 1) last row.
+		\post Result = lhs * rhs  (where rhs is applied first)
+	*/
+	template <typename DATA_TYPE>
+	inline GMatrix<DATA_TYPE, 2, 3>& MultAffine(GMatrix<DATA_TYPE, 2, 3>& Result,
+												const GMatrix<DATA_TYPE, 2, 3>& lhs,
+												const GMatrix<DATA_TYPE, 2, 3>& rhs) {
+		DATA_TYPE r00 = lhs(0, 0) * rhs(0, 0) + lhs(0, 1) * rhs(1, 0);
+		DATA_TYPE r01 = lhs(0, 0) * rhs(0, 1) + lhs(0, 1) * rhs(1, 1);
+		DATA_TYPE r02 = lhs(0, 0) * rhs(0, 2) + lhs(0, 1) * rhs(1, 2) + lhs(0, 2);
+		DATA_TYPE r10 = lhs(1, 0) * rhs(0, 0) + lhs(1, 1) * rhs(1, 0);
+		DATA_TYPE r11 = lhs(1, 0) * rhs(0, 1) + lhs(1, 1) * rhs(1, 1);
+		DATA_TYPE r12 = lhs(1, 0) * rhs(0, 2) + lhs(1, 1) * rhs(1, 2) + lhs(1, 2);
+
+		Result(0, 0) = r00;
+		Result(0, 1) = r01;
+		Result(0, 2) = r02;
+		Result(1, 0) = r10;
+		Result(1, 1) = r11;
+		Result(1, 2) = r12;
+		return Result;
+	}
+
 	/*!
 		Matrix * Matrix.
 		\pre With regard to size (ROWS/COLS): if lhs is m x p, and rhs is p x n, then result is m x n (undefined otherwise)
@@ -879,47 +1029,46 @@ namespace Amanith {
 		for (i = 0; i < m; ++i)
 			Permutation[i] = i;
 
-		DATA_TYPE *LUrowi = 0;
 		GVect<DATA_TYPE, ROWS> LUcolj;
+		DATA_TYPE s, t;
+		GInt32 k, kmax, p;
 		// outer loop
-		for (j = 0; j < n; j++) {
+		for (j = 0; j < n; ++j) {
 			// make a copy of the j-th column to localize references
 			for (i = 0; i < m; ++i)
-				LUcolj[i] = LU_[i][j];
+				LUcolj[i] = LU_(i, j);
 			// apply previous transformations
-			DATA_TYPE s;
 			for (i = 0; i < m; ++i) {
-				LUrowi = LU_[i];
 				// most of the time is spent in the following dot product
-				GInt32 kmax = GMath::Min(i, j);
+				kmax = GMath::Min(i, j);
 				s = 0;
-				for (GInt32 k = 0; k < kmax; k++)
-					s += LUrowi[k] * LUcolj[k];
+				for (k = 0; k < kmax; ++k)
+					s += LU_(i, k) * LUcolj[k];
+				LUcolj[i] -= s;
+				LU_(i, j) = LUcolj[i];
+			}
+			// find pivot and exchange if necessary
+			p = j;
+			for (i = j + 1; i < m; ++i) {
+				if (GMath::Abs(LUcolj[i]) > GMath::Abs(LUcolj[p]))
+					p = i;
+			}
+			if (p != j) {
+				for (k = 0; k < n; ++k) {
+					t = LU_(p, k);
+					LU_(p, k) = LU_(j, k);
+					LU_(j, k) = t;
+				}
+				k = Permutation[p];
+				Permutation[p] = Permutation[j];
+				Permutation[j] = k;
+				pivsign = -pivsign;
+			}
+			// compute multipliers
+			if ((j < m) && (LU_(j, j) != 0)) {
+				for (i = j + 1; i < m; ++i)
+					LU_(i, j) /= LU_(j, j);
 			}
-			LUrowi[j] = LUcolj[i] -= s;
-         }
-           // find pivot and exchange if necessary
-         GInt32 p = j;
-         for (i = j + 1; i < m; ++i) {
-			 if (GMath::Abs(LUcolj[i]) > GMath::Abs(LUcolj[p]))
-               p = i;
-         }
-         if (p != j) {
-		    GInt32 k = 0;
-            for (k = 0; k < n; ++k) {
-               DATA_TYPE t = LU_[p][k]; 
-			   LU_[p][k] = LU_[j][k]; 
-			   LU_[j][k] = t;
-            }
-            k = Permutation[p]; 
-			Permutation[p] = Permutation[j]; 
-			Permutation[j] = k;
-            pivsign = -pivsign;
-		}
-		// compute multipliers
-		if ((j < m) && (LU_[j][j] != 0)) {
-			for (i = j + 1; i < m; ++i)
-				LU_[i][j] /= LU_[j][j];
 		}
 		// build L matrix
 		for (i = 0; i < m; ++i) {
@@ -962,6 +1111,227 @@ namespace Amanith {
 		return G_TRUE;
 	}
 
+	/*!
+		Square matrix determinant, computed through LU decomposition.
+
+		Closed form versions are selected instead of this one for 2x2, 3x3 and 4x4 matrices.
+	*/
+	template <typename DATA_TYPE, GUInt32 SIZE>
+	inline DATA_TYPE Determinant(const GMatrix<DATA_TYPE, SIZE, SIZE>& Src) {
+
+		GMatrix<DATA_TYPE, SIZE, SIZE> l, u;
+		GVect<GInt32, SIZE> permutation;
+		DATA_TYPE det;
+
+		DecompLU(Src, l, u, permutation, det);
+		return det;
+	}
+
+	//! 2x2 matrix determinant, closed form.
+	template <typename DATA_TYPE>
+	inline DATA_TYPE Determinant(const GMatrix<DATA_TYPE, 2, 2>& Src) {
+
+		return Src(0, 0) * Src(1, 1) - Src(0, 1) * Src(1, 0);
+	}
+
+	//! 3x3 matrix determinant, closed form (cofactors expansion along the first row).
+	template <typename DATA_TYPE>
+	inline DATA_TYPE Determinant(const GMatrix<DATA_TYPE, 3, 3>& Src) {
+
+		return Src(0, 0) * (Src(1, 1) * Src(2, 2) - Src(1, 2) * Src(2, 1)) -
+			   Src(0, 1) * (Src(1, 0) * Src(2, 2) - Src(1, 2) * Src(2, 0)) +
+			   Src(0, 2) * (Src(1, 0) * Src(2, 1) - Src(1, 1) * Src(2, 0));
+	}
+
+	//! 4x4 matrix determinant, closed form (Laplace expansion on 2x2 minors).
+	template <typename DATA_TYPE>
+	inline DATA_TYPE Determinant(const GMatrix<DATA_TYPE, 4, 4>& Src) {
+
+		DATA_TYPE s0 = Src(0, 0) * Src(1, 1) - Src(1, 0) * Src(0, 1);
+		DATA_TYPE s1 = Src(0, 0) * Src(1, 2) - Src(1, 0) * Src(0, 2);
+		DATA_TYPE s2 = Src(0, 0) * Src(1, 3) - Src(1, 0) * Src(0, 3);
+		DATA_TYPE s3 = Src(0, 1) * Src(1, 2) - Src(1, 1) * Src(0, 2);
+		DATA_TYPE s4 = Src(0, 1) * Src(1, 3) - Src(1, 1) * Src(0, 3);
+		DATA_TYPE s5 = Src(0, 2) * Src(1, 3) - Src(1, 2) * Src(0, 3);
+		DATA_TYPE c5 = Src(2, 2) * Src(3, 3) - Src(3, 2) * Src(2, 3);
+		DATA_TYPE c4 = Src(2, 1) * Src(3, 3) - Src(3, 1) * Src(2, 3);
+		DATA_TYPE c3 = Src(2, 1) * Src(3, 2) - Src(3, 1) * Src(2, 2);
+		DATA_TYPE c2 = Src(2, 0) * Src(3, 3) - Src(3, 0) * Src(2, 3);
+		DATA_TYPE c1 = Src(2, 0) * Src(3, 2) - Src(3, 0) * Src(2, 2);
+		DATA_TYPE c0 = Src(2, 0) * Src(3, 1) - Src(3, 0) * Src(2, 1);
+
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	}
+
+	/*!
+		Square matrix inversion.
+
+		For generic sizes it uses InvertFull_GJ(); closed form versions (adjugate divided by determinant) are
+		selected at compile time for 2x2, 3x3 and 4x4 matrices.
+		\param Result the inverse matrix, it can be the same object as Src. It is not modified if the matrix is singular.
+		\param Src the matrix to invert.
+		\param Determinant the determinant of Src; it is set to 0 if the matrix is singular.
+		\param Epsilon singularity threshold. Gauss-Jordan elimination compares it with the absolute value of each
+		pivot, closed forms with the absolute value of the determinant.
+		\return G_TRUE if the matrix has been inverted, G_FALSE if it is singular.
+	*/
+	template <typename DATA_TYPE, GUInt32 SIZE>
+	inline GBool Invert(GMatrix<DATA_TYPE, SIZE, SIZE>& Result, const GMatrix<DATA_TYPE, SIZE, SIZE>& Src,
+						DATA_TYPE& Determinant, const DATA_TYPE Epsilon = 1e-20) {
+
+		GMatrix<DATA_TYPE, SIZE, SIZE> tmp;
+
+		if (!InvertFull_GJ(tmp, Src, Determinant, Epsilon))
+			return G_FALSE;
+		Result = tmp;
+		return G_TRUE;
+	}
+
+	//! 2x2 matrix inversion, closed form; see the generic Invert().
+	template <typename DATA_TYPE>
+	inline GBool Invert(GMatrix<DATA_TYPE, 2, 2>& Result, const GMatrix<DATA_TYPE, 2, 2>& Src,
+						DATA_TYPE& Determinant, const DATA_TYPE Epsilon = 1e-20) {
+
+		DATA_TYPE a = Src(0, 0), b = Src(0, 1), c = Src(1, 0), d = Src(1, 1);
+		DATA_TYPE det = a * d - b * c, invDet;
+
+		if (GMath::Abs(det) < Epsilon) {
+			Determinant = 0;
+			return G_FALSE;
+		}
+		invDet = 1 / det;
+		Result(0, 0) = d * invDet;
+		Result(0, 1) = -b * invDet;
+		Result(1, 0) = -c * invDet;
+		Result(1, 1) = a * invDet;
+		Determinant = det;
+		return G_TRUE;
+	}
+
+	//! 3x3 matrix inversion (projective matrices too), closed form; see the generic Invert().
+	template <typename DATA_TYPE>
+	inline GBool Invert(GMatrix<DATA_TYPE, 3, 3>& Result, const GMatrix<DATA_TYPE, 3, 3>& Src,
+						DATA_TYPE& Determinant, const DATA_TYPE Epsilon = 1e-20) {
+
+		// cofactors of the first row
+		DATA_TYPE c00 = Src(1, 1) * Src(2, 2) - Src(1, 2) * Src(2, 1);
+		DATA_TYPE c01 = Src(1, 2) * Src(2, 0) - Src(1, 0) * Src(2, 2);
+		DATA_TYPE c02 = Src(1, 0) * Src(2, 1) - Src(1, 1) * Src(2, 0);
+		DATA_TYPE det = Src(0, 0) * c00 + Src(0, 1) * c01 + Src(0, 2) * c02;
+		DATA_TYPE invDet;
+
+		if (GMath::Abs(det) < Epsilon) {
+			Determinant = 0;
+			return G_FALSE;
+		}
+		invDet = 1 / det;
+
+		GMatrix<DATA_TYPE, 3, 3> tmp; // prevent aliasing
+
+		tmp(0, 0) = c00 * invDet;
+		tmp(1, 0) = c01 * invDet;
+		tmp(2, 0) = c02 * invDet;
+		tmp(0, 1) = (Src(0, 2) * Src(2, 1) - Src(0, 1) * Src(2, 2)) * invDet;
+		tmp(1, 1) = (Src(0, 0) * Src(2, 2) - Src(0, 2) * Src(2, 0)) * invDet;
+		tmp(2, 1) = (Src(0, 1) * Src(2, 0) - Src(0, 0) * Src(2, 1)) * invDet;
+		tmp(0, 2) = (Src(0, 1) * Src(1, 2) - Src(0, 2) * Src(1, 1)) * invDet;
+		tmp(1, 2) = (Src(0, 2) * Src(1, 0) - Src(0, 0) * Src(1, 2)) * invDet;
+		tmp(2, 2) = (Src(0, 0) * Src(1, 1) - Src(0, 1) * Src(1, 0)) * invDet;
+		Result = tmp;
+		Determinant = det;
+		return G_TRUE;
+	}
+
+	//! 4x4 matrix inversion, closed form; see the generic Invert().
+	template <typename DATA_TYPE>
+	inline GBool Invert(GMatrix<DATA_TYPE, 4, 4>& Result, const GMatrix<DATA_TYPE, 4, 4>& Src,
+						DATA_TYPE& Determinant, const DATA_TYPE Epsilon = 1e-20) {
+
+		// 2x2 minors of the first two rows (s) and of the last two rows (c)
+		DATA_TYPE s0 = Src(0, 0) * Src(1, 1) - Src(1, 0) * Src(0, 1);
+		DATA_TYPE s1 = Src(0, 0) * Src(1, 2) - Src(1, 0) * Src(0, 2);
+		DATA_TYPE s2 = Src(0, 0) * Src(1, 3) - Src(1, 0) * Src(0, 3);
+		DATA_TYPE s3 = Src(0, 1) * Src(1, 2) - Src(1, 1) * Src(0, 2);
+		DATA_TYPE s4 = Src(0, 1) * Src(1, 3) - Src(1, 1) * Src(0, 3);
+		DATA_TYPE s5 = Src(0, 2) * Src(1, 3) - Src(1, 2) * Src(0, 3);
+		DATA_TYPE c5 = Src(2, 2) * Src(3, 3) - Src(3, 2) * Src(2, 3);
+		DATA_TYPE c4 = Src(2, 1) * Src(3, 3) - Src(3, 1) * Src(2, 3);
+		DATA_TYPE c3 = Src(2, 1) * Src(3, 2) - Src(3, 1) * Src(2, 2);
+		DATA_TYPE c2 = Src(2, 0) * Src(3, 3) - Src(3, 0) * Src(2, 3);
+		DATA_TYPE c1 = Src(2, 0) * Src(3, 2) - Src(3, 0) * Src(2, 2);
+		DATA_TYPE c0 = Src(2, 0) * Src(3, 1) - Src(3, 0) * Src(2, 1);
+		DATA_TYPE det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		DATA_TYPE invDet;
+
+		if (GMath::Abs(det) < Epsilon) {
+			Determinant = 0;
+			return G_FALSE;
+		}
+		invDet = 1 / det;
+
+		GMatrix<DATA_TYPE, 4, 4> tmp; // prevent aliasing
+
+		tmp(0, 0) = ( Src(1, 1) * c5 - Src(1, 2) * c4 + Src(1, 3) * c3) * invDet;
+		tmp(0, 1) = (-Src(0, 1) * c5 + Src(0, 2) * c4 - Src(0, 3) * c3) * invDet;
+		tmp(0, 2) = ( Src(3, 1) * s5 - Src(3, 2) * s4 + Src(3, 3) * s3) * invDet;
+		tmp(0, 3) = (-Src(2, 1) * s5 + Src(2, 2) * s4 - Src(2, 3) * s3) * invDet;
+		tmp(1, 0) = (-Src(1, 0) * c5 + Src(1, 2) * c2 - Src(1, 3) * c1) * invDet;
+		tmp(1, 1) = ( Src(0, 0) * c5 - Src(0, 2) * c2 + Src(0, 3) * c1) * invDet;
+		tmp(1, 2) = (-Src(3, 0) * s5 + Src(3, 2) * s2 - Src(3, 3) * s1) * invDet;
+		tmp(1, 3) = ( Src(2, 0) * s5 - Src(2, 2) * s2 + Src(2, 3) * s1) * invDet;
+		tmp(2, 0) = ( Src(1, 0) * c4 - Src(1, 1) * c2 + Src(1, 3) * c0) * invDet;
+		tmp(2, 1) = (-Src(0, 0) * c4 + Src(0, 1) * c2 - Src(0, 3) * c0) * invDet;
+		tmp(2, 2) = ( Src(3, 0) * s4 - Src(3, 1) * s2 + Src(3, 3) * s0) * invDet;
+		tmp(2, 3) = (-Src(2, 0) * s4 + Src(2, 1) * s2 - Src(2, 3) * s0) * invDet;
+		tmp(3, 0) = (-Src(1, 0) * c3 + Src(1, 1) * c1 - Src(1, 2) * c0) * invDet;
+		tmp(3, 1) = ( Src(0, 0) * c3 - Src(0, 1) * c1 + Src(0, 2) * c0) * invDet;
+		tmp(3, 2) = (-Src(3, 0) * s3 + Src(3, 1) * s1 - Src(3, 2) * s0) * invDet;
+		tmp(3, 3) = ( Src(2, 0) * s3 - Src(2, 1) * s1 + Src(2, 2) * s0) * invDet;
+		Result = tmp;
+		Determinant = det;
+		return G_TRUE;
+	}
+
+	/*!
+		Affine 3x3 matrix inversion: the inverse of [A t; 0 1] is [inv(A) -inv(A)t; 0 1].
+
+		\param Result the inverse matrix, it can be the same object as Src. It is not modified if the matrix is singular.
+		\param Src the matrix to invert; its last row must be (0, 0, 1), and it is not read.
+		\param Determinant the determinant of Src (the one of its 2x2 linear part); it is set to 0 if the matrix
+		is singular.
+		\param Epsilon singularity threshold, compared with the absolute value of the determinant.
+		\return G_TRUE if the matrix has been inverted, G_FALSE if it is singular.
+	*/
+	template <typename DATA_TYPE>
+	inline GBool InvertAffine(GMatrix<DATA_TYPE, 3, 3>& Result, const GMatrix<DATA_TYPE, 3, 3>& Src,
+							  DATA_TYPE& Determinant, const DATA_TYPE Epsilon = 1e-20) {
+
+		DATA_TYPE a = Src(0, 0), b = Src(0, 1), c = Src(1, 0), d = Src(1, 1);
+		DATA_TYPE tx = Src(0, 2), ty = Src(1, 2);
+		DATA_TYPE det = a * d - b * c, invDet;
+
+		if (GMath::Abs(det) < Epsilon) {
+			Determinant = 0;
+			return G_FALSE;
+		}
+		invDet = 1 / det;
+		a *= invDet;
+		b *= invDet;
+		c *= invDet;
+		d *= invDet;
+		Result(0, 0) = d;
+		Result(0, 1) = -b;
+		Result(0, 2) = b * ty - d * tx;
+		Result(1, 0) = -c;
+		Result(1, 1) = a;
+		Result(1, 2) = c * tx - a * ty;
+		Result(2, 0) = 0;
+		Result(2, 1) = 0;
+		Result(2, 2) = 1;
+		Determinant = det;
+		return G_TRUE;
+	}
+
 	/*!
 		Classical QR Decomposition: for an m-by-n matrix A with m >= n, the QR decomposition is an m-by-n
 		orthogonal matrix Q and an n-by-n upper triangular matrix R so that
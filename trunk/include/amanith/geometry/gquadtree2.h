@@ -0,0 +1,443 @@
+/****************************************************************************
+** $file: amanith/geometry/gquadtree2.h   0.3.0.0   edited Jan, 30 2006
+**
+** 2D region quadtree.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GQUADTREE2_H
+#define GQUADTREE2_H
+
+#include "amanith/geometry/gspatial2.h"
+
+/*!
+	\file gquadtree2.h
+	\brief Header file for GQuadTree2 class.
+*/
+namespace Amanith {
+
+	/*!
+		\class GQuadTree2
+		\brief A 2D loose region quadtree.
+
+		The quadtree recursively subdivides its bounds into four quadrants. Each item is stored into the quadrant
+		that contains the center of its bounding box, going down as long as the item fits inside the "loose"
+		bounds of the quadrant: the quadrant box enlarged by half its size on each side. In a plain quadtree,
+		small items crossing a subdivision line remain in the upper nodes, and every query has to test them;
+		loose bounds let them sink to a node of their size. A leaf node is split when it contains more than
+		MaxItemsPerNode items, up to MaxDepth levels.
+		Items that are not contained in the quadtree bounds are kept into the root node, so they are still
+		found by queries (but they are not accelerated).
+
+		Build() calculates the bounds from the items; when the tree is filled with Insert() only, bounds can be
+		specified at construction time or with SetBounds().
+
+		\param ITEM type of the stored primitives (for example GAABox2, GSphere2, GLineSegment2 or GPoint2).
+		\param TRAITS the spatial traits of ITEM, see GSpatialTraits2.
+	*/
+	template<typename ITEM, typename TRAITS = GSpatialTraits2<ITEM> >
+	class GQuadTree2 {
+
+	private:
+		// a tree node; items of each node are kept into a doubly linked list
+		struct GQuadNode {
+			GSpatialBox2 Box;
+			// Box enlarged by half its size on each side (the root one is not enlarged)
+			GSpatialBox2 LooseBox;
+			// index of the first of the 4 consecutive children, -1 for leaves
+			GInt32 Children;
+			GInt32 FirstItem;
+			GUInt32 ItemsCount;
+			GUInt32 Depth;
+		};
+
+		GSpatialItems2<ITEM, TRAITS> gItems;
+		// per handle links of nodes lists
+		GDynArray<GInt32> gNext;
+		GDynArray<GInt32> gPrev;
+		GDynArray<GQuadNode> gNodes;
+		GSpatialBox2 gBounds;
+		GUInt32 gMaxItemsPerNode;
+		GUInt32 gMaxDepth;
+
+		void Reset() {
+
+			gNodes.clear();
+			GQuadNode root;
+			root.Box = gBounds;
+			root.LooseBox = gBounds;
+			root.Children = -1;
+			root.FirstItem = -1;
+			root.ItemsCount = 0;
+			root.Depth = 0;
+			gNodes.push_back(root);
+		}
+
+		void LinkItem(const GInt32 Node, const GUInt32 Handle) {
+
+			GQuadNode& n = gNodes[Node];
+			gNext[Handle] = n.FirstItem;
+			gPrev[Handle] = -1;
+			if (n.FirstItem >= 0)
+				gPrev[n.FirstItem] = (GInt32)Handle;
+			n.FirstItem = (GInt32)Handle;
+			n.ItemsCount++;
+			gItems.Slot(Handle) = Node;
+		}
+
+		void UnlinkItem(const GUInt32 Handle) {
+
+			GQuadNode& n = gNodes[gItems.Slot(Handle)];
+			if (gPrev[Handle] >= 0)
+				gNext[gPrev[Handle]] = gNext[Handle];
+			else
+				n.FirstItem = gNext[Handle];
+			if (gNext[Handle] >= 0)
+				gPrev[gNext[Handle]] = gPrev[Handle];
+			n.ItemsCount--;
+			gItems.Slot(Handle) = -1;
+		}
+
+		// index of the child quadrant that can hold the box, -1 if none
+		GInt32 ChildFor(const GInt32 Node, const GSpatialBox2& Box) const {
+
+			const GQuadNode& n = gNodes[Node];
+			GReal midX = (n.Box.MinX + n.Box.MaxX) / 2;
+			GReal midY = (n.Box.MinY + n.Box.MaxY) / 2;
+			GInt32 q = 0;
+
+			// the quadrant is chosen by the box center
+			if ((Box.MinX + Box.MaxX) / 2 >= midX)
+				q = 1;
+			if ((Box.MinY + Box.MaxY) / 2 >= midY)
+				q += 2;
+			q += n.Children;
+			return (gNodes[q].LooseBox.Contains(Box)) ? q : -1;
+		}
+
+		static GQuadNode Loosen(GQuadNode Node) {
+
+			GReal dx = (Node.Box.MaxX - Node.Box.MinX) / 2;
+			GReal dy = (Node.Box.MaxY - Node.Box.MinY) / 2;
+			Node.LooseBox = GSpatialBox2(Node.Box.MinX - dx, Node.Box.MinY - dy, Node.Box.MaxX + dx, Node.Box.MaxY + dy);
+			return Node;
+		}
+
+		void Split(const GInt32 Node) {
+
+			GInt32 first = (GInt32)gNodes.size();
+			GSpatialBox2 box = gNodes[Node].Box;
+			GUInt32 depth = gNodes[Node].Depth + 1;
+			GReal midX = (box.MinX + box.MaxX) / 2;
+			GReal midY = (box.MinY + box.MaxY) / 2;
+			GQuadNode child;
+
+			child.Children = -1;
+			child.FirstItem = -1;
+			child.ItemsCount = 0;
+			child.Depth = depth;
+			// quadrants order: bottom-left, bottom-right, top-left, top-right
+			child.Box = GSpatialBox2(box.MinX, box.MinY, midX, midY);
+			gNodes.push_back(Loosen(child));
+			child.Box = GSpatialBox2(midX, box.MinY, box.MaxX, midY);
+			gNodes.push_back(Loosen(child));
+			child.Box = GSpatialBox2(box.MinX, midY, midX, box.MaxY);
+			gNodes.push_back(Loosen(child));
+			child.Box = GSpatialBox2(midX, midY, box.MaxX, box.MaxY);
+			gNodes.push_back(Loosen(child));
+			gNodes[Node].Children = first;
+
+			// push down items that fit into a quadrant
+			GInt32 h = gNodes[Node].FirstItem, next, c;
+			while (h >= 0) {
+				next = gNext[h];
+				c = ChildFor(Node, gItems.Box((GUInt32)h));
+				if (c >= 0) {
+					UnlinkItem((GUInt32)h);
+					LinkItem(c, (GUInt32)h);
+				}
+				h = next;
+			}
+		}
+
+		void InsertHandle(const GUInt32 Handle) {
+
+			const GSpatialBox2& box = gItems.Box(Handle);
+			GInt32 node = 0, c;
+
+			if (gNext.size() < gItems.HandlesCount()) {
+				gNext.resize(gItems.HandlesCount(), -1);
+				gPrev.resize(gItems.HandlesCount(), -1);
+			}
+			if (gBounds.Contains(box)) {
+				while (gNodes[node].Children >= 0) {
+					c = ChildFor(node, box);
+					if (c < 0)
+						break;
+					node = c;
+				}
+			}
+			LinkItem(node, Handle);
+			if (gNodes[node].Children < 0 && gNodes[node].ItemsCount > gMaxItemsPerNode && gNodes[node].Depth < gMaxDepth)
+				Split(node);
+		}
+
+	public:
+		/*!
+			Constructor.
+
+			\param Bounds the region subdivided by the quadtree.
+			\param MaxItemsPerNode a leaf is split when it contains more items than this value.
+			\param MaxDepth maximum depth of the tree.
+		*/
+		GQuadTree2(const GAABox2& Bounds = GAABox2(GPoint2(0, 0), GPoint2(1, 1)), const GUInt32 MaxItemsPerNode = 8,
+				   const GUInt32 MaxDepth = 16)
+		: gBounds(Bounds), gMaxItemsPerNode(MaxItemsPerNode), gMaxDepth(MaxDepth) {
+			Reset();
+		}
+
+		//! Number of items.
+		inline GUInt32 Count() const {
+			return gItems.Count();
+		}
+		//! Return G_TRUE if the handle refers to an item.
+		inline GBool IsValid(const GUInt32 Handle) const {
+			return gItems.IsValid(Handle);
+		}
+		//! Get an item.
+		inline const ITEM& Item(const GUInt32 Handle) const {
+			G_ASSERT(gItems.IsValid(Handle));
+			return gItems.Item(Handle);
+		}
+		//! Get the region subdivided by the quadtree.
+		inline GAABox2 Bounds() const {
+			return gBounds.AABox();
+		}
+		//! Number of nodes.
+		inline GUInt32 NodesCount() const {
+			return (GUInt32)gNodes.size();
+		}
+
+		//! Remove all items.
+		void Clear() {
+			gItems.Clear();
+			gNext.clear();
+			gPrev.clear();
+			Reset();
+		}
+
+		/*!
+			Change the region subdivided by the quadtree; items are redistributed and handles are preserved.
+		*/
+		void SetBounds(const GAABox2& Bounds) {
+
+			GUInt32 i, j = gItems.HandlesCount();
+
+			gBounds = GSpatialBox2(Bounds);
+			Reset();
+			for (i = 0; i < j; ++i) {
+				if (gItems.IsValid(i))
+					InsertHandle(i);
+			}
+		}
+
+		/*!
+			Build the quadtree from an array of items.
+
+			Previous items are removed, and bounds are set to the bounding box of all items. The handle of each item
+			is its index inside the Items array.
+		*/
+		void Build(const GDynArray<ITEM>& Items) {
+
+			GUInt32 i, j = (GUInt32)Items.size();
+
+			gItems.Clear();
+			gItems.Reserve(j);
+			for (i = 0; i < j; ++i)
+				gItems.Add(Items[i]);
+			gNext.assign(j, -1);
+			gPrev.assign(j, -1);
+			gBounds = gItems.Bounds();
+			if (j == 0)
+				gBounds = GSpatialBox2(0, 0, 1, 1);
+			Reset();
+			for (i = 0; i < j; ++i)
+				InsertHandle(i);
+		}
+
+		/*!
+			Insert an item.
+
+			\return the handle of the inserted item.
+		*/
+		GUInt32 Insert(const ITEM& Item) {
+
+			GUInt32 handle = gItems.Add(Item);
+			InsertHandle(handle);
+			return handle;
+		}
+
+		/*!
+			Remove an item.
+
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+			\note empty nodes are not merged; they are reused by later insertions.
+		*/
+		GBool Remove(const GUInt32 Handle) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+			UnlinkItem(Handle);
+			gItems.Remove(Handle);
+			return G_TRUE;
+		}
+
+		/*!
+			Replace an item, moving it to the node that contains its new bounding box.
+
+			\return G_FALSE if the handle is not valid, G_TRUE otherwise.
+		*/
+		GBool Update(const GUInt32 Handle, const ITEM& Item) {
+
+			if (!gItems.IsValid(Handle))
+				return G_FALSE;
+			UnlinkItem(Handle);
+			gItems.Set(Handle, Item);
+			InsertHandle(Handle);
+			return G_TRUE;
+		}
+
+		/*!
+			Find all items whose bounding box overlaps the specified box.
+
+			\param Box the query box.
+			\param Result handles of found items (previous content is discarded).
+		*/
+		void Query(const GAABox2& Box, GDynArray<GUInt32>& Result) const {
+
+			GSpatialBox2 box(Box);
+			GDynArray<GInt32> stack;
+			GInt32 node, h, i;
+
+			Result.clear();
+			stack.push_back(0);
+			while (!stack.empty()) {
+				node = stack.back();
+				stack.pop_back();
+				const GQuadNode& n = gNodes[node];
+				for (h = n.FirstItem; h >= 0; h = gNext[h]) {
+					if (gItems.Box((GUInt32)h).Overlaps(box))
+						Result.push_back((GUInt32)h);
+				}
+				if (n.Children >= 0) {
+					for (i = 0; i < 4; ++i) {
+						if (gNodes[n.Children + i].LooseBox.Overlaps(box))
+							stack.push_back(n.Children + i);
+					}
+				}
+			}
+		}
+
+		/*!
+			Find all items intersected by a ray.
+
+			Each item whose bounding box is reached by the ray is tested with TRAITS::Intersect().
+			\param Ray the query ray.
+			\param Result intersected items and their ray parameters, sorted by ascending parameter (previous
+			content is discarded).
+		*/
+		void Query(const GRay2& Ray, GDynArray<GSpatialHit2>& Result) const {
+
+			GSpatialRay2 ray(Ray);
+			GDynArray<GInt32> stack;
+			GInt32 node, h, i;
+			GReal t;
+
+			Result.clear();
+			stack.push_back(0);
+			while (!stack.empty()) {
+				node = stack.back();
+				stack.pop_back();
+				const GQuadNode& n = gNodes[node];
+				for (h = n.FirstItem; h >= 0; h = gNext[h]) {
+					if (ray.Hit(gItems.Box((GUInt32)h), G_MAX_REAL, t) &&
+						TRAITS::Intersect(gItems.Item((GUInt32)h), Ray, t))
+						Result.push_back(GSpatialHit2((GUInt32)h, t));
+				}
+				if (n.Children >= 0) {
+					for (i = 0; i < 4; ++i) {
+						if (ray.Hit(gNodes[n.Children + i].LooseBox, G_MAX_REAL, t))
+							stack.push_back(n.Children + i);
+					}
+				}
+			}
+			std::sort(Result.begin(), Result.end());
+		}
+
+		/*!
+			Find the K items nearest to a point, according to TRAITS::DistanceSquared().
+
+			\param Point the query point.
+			\param K the number of wanted items.
+			\param Result the nearest items and their distances, sorted by ascending distance (previous content is
+			discarded). It contains less than K entries if the quadtree contains less than K items.
+		*/
+		void Nearest(const GPoint2& Point, const GUInt32 K, GDynArray<GSpatialHit2>& Result) const {
+
+			GSpatialNearest2 nearest(K);
+			GDynArray<GSpatialQueueEntry2> queue;
+			GReal x = Point[G_X], y = Point[G_Y];
+			GInt32 h, i, c;
+
+			Result.clear();
+			if (K == 0)
+				return;
+			// root items can lie outside bounds, so the root is always visited
+			queue.push_back(GSpatialQueueEntry2(0, 0));
+			while (!queue.empty()) {
+				std::pop_heap(queue.begin(), queue.end());
+				GSpatialQueueEntry2 e = queue.back();
+				queue.pop_back();
+				if (e.DistanceSquared > nearest.WorstDistanceSquared())
+					break;
+				const GQuadNode& n = gNodes[e.Node];
+				for (h = n.FirstItem; h >= 0; h = gNext[h]) {
+					if (gItems.Box((GUInt32)h).DistanceSquared(x, y) <= nearest.WorstDistanceSquared())
+						nearest.Offer((GUInt32)h, TRAITS::DistanceSquared(gItems.Item((GUInt32)h), Point));
+				}
+				if (n.Children >= 0) {
+					for (i = 0; i < 4; ++i) {
+						c = n.Children + i;
+						queue.push_back(GSpatialQueueEntry2(c, gNodes[c].LooseBox.DistanceSquared(x, y)));
+						std::push_heap(queue.begin(), queue.end());
+					}
+				}
+			}
+			nearest.Extract(Result);
+		}
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -0,0 +1,503 @@
+/****************************************************************************
+** $file: amanith/geometry/gspatial2.h   0.3.0.0   edited Jan, 30 2006
+**
+** Common support for 2D spatial containers.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GSPATIAL2_H
+#define GSPATIAL2_H
+
+#include "amanith/geometry/gintersect.h"
+#include <algorithm>
+
+/*!
+	\file gspatial2.h
+	\brief Common support for 2D spatial containers (GQuadTree2, GBVH2, GGrid2).
+*/
+namespace Amanith {
+
+	/*!
+		\struct GSpatialBox2
+		\brief A plain 2D axes aligned box, used internally by spatial containers.
+
+		Unlike GAABox2, it does not reorder its corners at every assignment, so it is cheap to copy and to grow
+		during container construction and traversal.
+	*/
+	struct GSpatialBox2 {
+		//! Minimum x.
+		GReal MinX;
+		//! Minimum y.
+		GReal MinY;
+		//! Maximum x.
+		GReal MaxX;
+		//! Maximum y.
+		GReal MaxY;
+
+		//! Default constructor, builds an empty (inverted) box.
+		GSpatialBox2() : MinX(G_MAX_REAL), MinY(G_MAX_REAL), MaxX(G_MIN_REAL), MaxY(G_MIN_REAL) {
+		}
+		//! Set constructor; corners must be already ordered.
+		GSpatialBox2(const GReal MinX_, const GReal MinY_, const GReal MaxX_, const GReal MaxY_)
+		: MinX(MinX_), MinY(MinY_), MaxX(MaxX_), MaxY(MaxY_) {
+		}
+		//! Constructor from a GAABox2.
+		GSpatialBox2(const GAABox2& Box)
+		: MinX(Box.Min()[G_X]), MinY(Box.Min()[G_Y]), MaxX(Box.Max()[G_X]), MaxY(Box.Max()[G_Y]) {
+		}
+		//! Convert to a GAABox2.
+		inline GAABox2 AABox() const {
+			return GAABox2(GPoint2(MinX, MinY), GPoint2(MaxX, MaxY));
+		}
+		//! Grow the box so that it includes the specified box.
+		inline void Extend(const GSpatialBox2& Box) {
+			if (Box.MinX < MinX) MinX = Box.MinX;
+			if (Box.MinY < MinY) MinY = Box.MinY;
+			if (Box.MaxX > MaxX) MaxX = Box.MaxX;
+			if (Box.MaxY > MaxY) MaxY = Box.MaxY;
+		}
+		//! Grow the box so that it includes the specified point.
+		inline void Extend(const GReal X, const GReal Y) {
+			if (X < MinX) MinX = X;
+			if (Y < MinY) MinY = Y;
+			if (X > MaxX) MaxX = X;
+			if (Y > MaxY) MaxY = Y;
+		}
+		//! Half perimeter, the 2D counterpart of the surface area used by the SAH cost.
+		inline GReal HalfPerimeter() const {
+			return (MaxX - MinX) + (MaxY - MinY);
+		}
+		//! Return G_TRUE if the two boxes overlap (touching boxes overlap).
+		inline GBool Overlaps(const GSpatialBox2& Box) const {
+			return (Box.MinX <= MaxX && Box.MaxX >= MinX && Box.MinY <= MaxY && Box.MaxY >= MinY);
+		}
+		//! Return G_TRUE if the specified box is completely inside this box.
+		inline GBool Contains(const GSpatialBox2& Box) const {
+			return (Box.MinX >= MinX && Box.MaxX <= MaxX && Box.MinY >= MinY && Box.MaxY <= MaxY);
+		}
+		//! Squared distance between the box and a point (0 for points inside the box).
+		inline GReal DistanceSquared(const GReal X, const GReal Y) const {
+			GReal dx = (X < MinX) ? (MinX - X) : ((X > MaxX) ? (X - MaxX) : 0);
+			GReal dy = (Y < MinY) ? (MinY - Y) : ((Y > MaxY) ? (Y - MaxY) : 0);
+			return (dx * dx + dy * dy);
+		}
+	};
+
+	//! Return the box that includes both specified boxes.
+	inline GSpatialBox2 Union(const GSpatialBox2& Box1, const GSpatialBox2& Box2) {
+		GSpatialBox2 b(Box1);
+		b.Extend(Box2);
+		return b;
+	}
+
+	/*!
+		\struct GSpatialRay2
+		\brief A ray prepared for repeated slab tests against GSpatialBox2.
+	*/
+	struct GSpatialRay2 {
+		//! Origin x.
+		GReal OriginX;
+		//! Origin y.
+		GReal OriginY;
+		//! Direction x.
+		GReal DirectionX;
+		//! Direction y.
+		GReal DirectionY;
+		//! Inverse of direction x (meaningful if DirectionX is not zero).
+		GReal InvDirectionX;
+		//! Inverse of direction y (meaningful if DirectionY is not zero).
+		GReal InvDirectionY;
+
+		//! Constructor from a ray.
+		GSpatialRay2(const GRay2& Ray) {
+			OriginX = Ray.Origin()[G_X];
+			OriginY = Ray.Origin()[G_Y];
+			DirectionX = Ray.Direction()[G_X];
+			DirectionY = Ray.Direction()[G_Y];
+			InvDirectionX = (DirectionX != 0) ? (1 / DirectionX) : 0;
+			InvDirectionY = (DirectionY != 0) ? (1 / DirectionY) : 0;
+		}
+		/*!
+			Slab test against a box.
+
+			\param Box the box to test.
+			\param MaxParameter intersections beyond this ray parameter are ignored.
+			\param EntryParameter the ray parameter (>= 0) where the ray enters the box.
+			\return G_TRUE if the ray (for parameters between 0 and MaxParameter) touches the box.
+		*/
+		inline GBool Hit(const GSpatialBox2& Box, const GReal MaxParameter, GReal& EntryParameter) const {
+
+			GReal t0 = 0, t1 = MaxParameter, a, b;
+
+			if (DirectionX != 0) {
+				a = (Box.MinX - OriginX) * InvDirectionX;
+				b = (Box.MaxX - OriginX) * InvDirectionX;
+				if (a > b) {
+					GReal swap = a; a = b; b = swap;
+				}
+				if (a > t0) t0 = a;
+				if (b < t1) t1 = b;
+			}
+			else
+			if (OriginX < Box.MinX || OriginX > Box.MaxX)
+				return G_FALSE;
+
+			if (DirectionY != 0) {
+				a = (Box.MinY - OriginY) * InvDirectionY;
+				b = (Box.MaxY - OriginY) * InvDirectionY;
+				if (a > b) {
+					GReal swap = a; a = b; b = swap;
+				}
+				if (a > t0) t0 = a;
+				if (b < t1) t1 = b;
+			}
+			else
+			if (OriginY < Box.MinY || OriginY > Box.MaxY)
+				return G_FALSE;
+
+			if (t0 > t1)
+				return G_FALSE;
+			EntryParameter = t0;
+			return G_TRUE;
+		}
+	};
+
+	/*!
+		\struct GSpatialHit2
+		\brief A result of ray and nearest neighbor queries.
+	*/
+	struct GSpatialHit2 {
+		//! Handle of the item.
+		GUInt32 Handle;
+		/*!
+			For ray queries it is the ray parameter of the intersection, for nearest neighbor queries it is the
+			distance between the query point and the item.
+		*/
+		GReal Distance;
+
+		//! Default constructor.
+		GSpatialHit2() : Handle(0), Distance(0) {
+		}
+		//! Set constructor.
+		GSpatialHit2(const GUInt32 Handle_, const GReal Distance_) : Handle(Handle_), Distance(Distance_) {
+		}
+		//! Ordering by distance.
+		inline GBool operator <(const GSpatialHit2& Hit) const {
+			return (Distance < Hit.Distance);
+		}
+	};
+
+	/*!
+		\struct GSpatialTraits2
+		\brief Describes how a spatial container deals with a primitive type.
+
+		A specialization must provide:
+
+		- static GSpatialBox2 Box(const ITEM& Item): the bounding box of the item.
+		- static GReal DistanceSquared(const ITEM& Item, const GPoint2& Point): squared distance between the item
+		and a point, used by nearest neighbor queries.
+		- static GBool Intersect(const ITEM& Item, const GRay2& Ray, GReal& Parameter): exact ray test, used by
+		ray queries; Parameter is the ray parameter of the first intersection.
+
+		Specializations are provided for GPoint2, GAABox2, GSphere2 and GLineSegment2; other types can be used
+		by writing a specialization, or by passing a custom traits class to the container.
+	*/
+	template<typename ITEM>
+	struct GSpatialTraits2;
+
+	//! Spatial traits for points.
+	template<>
+	struct GSpatialTraits2<GPoint2> {
+		static inline GSpatialBox2 Box(const GPoint2& Item) {
+			return GSpatialBox2(Item[G_X], Item[G_Y], Item[G_X], Item[G_Y]);
+		}
+		static inline GReal DistanceSquared(const GPoint2& Item, const GPoint2& Point) {
+			return Amanith::DistanceSquared(Item, Point);
+		}
+		static inline GBool Intersect(const GPoint2& Item, const GRay2& Ray, GReal& Parameter) {
+			GReal len = Ray.Direction().LengthSquared();
+			if (len <= G_EPSILON || Distance(Ray, Item) > G_EPSILON)
+				return G_FALSE;
+			Parameter = Dot(Item - Ray.Origin(), Ray.Direction()) / len;
+			return (Parameter >= 0);
+		}
+	};
+
+	//! Spatial traits for axes aligned boxes.
+	template<>
+	struct GSpatialTraits2<GAABox2> {
+		static inline GSpatialBox2 Box(const GAABox2& Item) {
+			return GSpatialBox2(Item);
+		}
+		static inline GReal DistanceSquared(const GAABox2& Item, const GPoint2& Point) {
+			return GSpatialBox2(Item).DistanceSquared(Point[G_X], Point[G_Y]);
+		}
+		static inline GBool Intersect(const GAABox2& Item, const GRay2& Ray, GReal& Parameter) {
+			GUInt32 flags;
+			GReal params[2];
+			GBoxSide side;
+			if (!Amanith::Intersect(Ray, Item, flags, params, side))
+				return G_FALSE;
+			Parameter = params[0];
+			return G_TRUE;
+		}
+	};
+
+	//! Spatial traits for spheres (circles).
+	template<>
+	struct GSpatialTraits2<GSphere2> {
+		static inline GSpatialBox2 Box(const GSphere2& Item) {
+			return GSpatialBox2(Item.Center()[G_X] - Item.Radius(), Item.Center()[G_Y] - Item.Radius(),
+								Item.Center()[G_X] + Item.Radius(), Item.Center()[G_Y] + Item.Radius());
+		}
+		static inline GReal DistanceSquared(const GSphere2& Item, const GPoint2& Point) {
+			GReal d = Distance(Item.Center(), Point) - Item.Radius();
+			return (d > 0) ? (d * d) : 0;
+		}
+		static inline GBool Intersect(const GSphere2& Item, const GRay2& Ray, GReal& Parameter) {
+			GUInt32 flags;
+			GReal params[2];
+			if (!Amanith::Intersect(Ray, Item, flags, params))
+				return G_FALSE;
+			Parameter = params[0];
+			return G_TRUE;
+		}
+	};
+
+	//! Spatial traits for line segments.
+	template<>
+	struct GSpatialTraits2<GLineSegment2> {
+		static inline GSpatialBox2 Box(const GLineSegment2& Item) {
+			GSpatialBox2 b(Item.Origin()[G_X], Item.Origin()[G_Y], Item.Origin()[G_X], Item.Origin()[G_Y]);
+			b.Extend(Item.Origin()[G_X] + Item.Direction()[G_X], Item.Origin()[G_Y] + Item.Direction()[G_Y]);
+			return b;
+		}
+		static inline GReal DistanceSquared(const GLineSegment2& Item, const GPoint2& Point) {
+			GReal len = Item.Direction().LengthSquared();
+			GReal t = (len > 0) ? (Dot(Point - Item.Origin(), Item.Direction()) / len) : 0;
+			t = GMath::Clamp(t, (GReal)0, (GReal)1);
+			return Amanith::DistanceSquared(Point, GPoint2(Item.Origin() + t * Item.Direction()));
+		}
+		static inline GBool Intersect(const GLineSegment2& Item, const GRay2& Ray, GReal& Parameter) {
+			GUInt32 flags;
+			GReal params[2];
+			if (!Amanith::Intersect(Ray, Item, flags, params))
+				return G_FALSE;
+			Parameter = params[0];
+			return G_TRUE;
+		}
+	};
+
+	/*!
+		\class GSpatialItems2
+		\brief Items storage shared by spatial containers.
+
+		Items are identified by handles: a handle is assigned at insertion and stays valid until the item is
+		removed; handles of removed items are recycled by later insertions. The bounding box of each item is
+		cached, together with an integer "slot" that each container uses to locate the item inside its own
+		structure.
+	*/
+	template<typename ITEM, typename TRAITS>
+	class GSpatialItems2 {
+
+	private:
+		GDynArray<ITEM> gItems;
+		GDynArray<GSpatialBox2> gBoxes;
+		GDynArray<GInt32> gSlots;
+		GDynArray<GUChar8> gValid;
+		GDynArray<GUInt32> gFreeHandles;
+		GUInt32 gCount;
+
+	public:
+		//! Default constructor.
+		GSpatialItems2() : gCount(0) {
+		}
+		//! Number of (valid) items.
+		inline GUInt32 Count() const {
+			return gCount;
+		}
+		//! Upper bound of handles; handles range from 0 to HandlesCount() - 1, some of them can be invalid.
+		inline GUInt32 HandlesCount() const {
+			return (GUInt32)gItems.size();
+		}
+		//! Return G_TRUE if the handle refers to an item.
+		inline GBool IsValid(const GUInt32 Handle) const {
+			return (Handle < gValid.size() && gValid[Handle] != 0);
+		}
+		//! Remove all items.
+		void Clear() {
+			gItems.clear();
+			gBoxes.clear();
+			gSlots.clear();
+			gValid.clear();
+			gFreeHandles.clear();
+			gCount = 0;
+		}
+		//! Reserve space for the specified number of items.
+		void Reserve(const GUInt32 Count) {
+			gItems.reserve(Count);
+			gBoxes.reserve(Count);
+			gSlots.reserve(Count);
+			gValid.reserve(Count);
+		}
+		//! Add an item and return its handle.
+		GUInt32 Add(const ITEM& Item) {
+
+			GUInt32 handle;
+
+			if (!gFreeHandles.empty()) {
+				handle = gFreeHandles.back();
+				gFreeHandles.pop_back();
+				gItems[handle] = Item;
+				gBoxes[handle] = TRAITS::Box(Item);
+				gSlots[handle] = -1;
+				gValid[handle] = 1;
+			}
+			else {
+				handle = (GUInt32)gItems.size();
+				gItems.push_back(Item);
+				gBoxes.push_back(TRAITS::Box(Item));
+				gSlots.push_back(-1);
+				gValid.push_back(1);
+			}
+			gCount++;
+			return handle;
+		}
+		//! Remove an item; the handle must be valid.
+		void Remove(const GUInt32 Handle) {
+			G_ASSERT(IsValid(Handle));
+			gValid[Handle] = 0;
+			gFreeHandles.push_back(Handle);
+			gCount--;
+		}
+		//! Replace an item, updating its cached bounding box; the handle must be valid.
+		void Set(const GUInt32 Handle, const ITEM& Item) {
+			G_ASSERT(IsValid(Handle));
+			gItems[Handle] = Item;
+			gBoxes[Handle] = TRAITS::Box(Item);
+		}
+		//! Get an item.
+		inline const ITEM& Item(const GUInt32 Handle) const {
+			G_ASSERT(Handle < gItems.size());
+			return gItems[Handle];
+		}
+		//! Get the cached bounding box of an item.
+		inline const GSpatialBox2& Box(const GUInt32 Handle) const {
+			G_ASSERT(Handle < gBoxes.size());
+			return gBoxes[Handle];
+		}
+		//! Get the container slot of an item.
+		inline GInt32& Slot(const GUInt32 Handle) {
+			G_ASSERT(Handle < gSlots.size());
+			return gSlots[Handle];
+		}
+		//! Get the container slot of an item (const version).
+		inline GInt32 Slot(const GUInt32 Handle) const {
+			G_ASSERT(Handle < gSlots.size());
+			return gSlots[Handle];
+		}
+		//! Bounding box of all items.
+		GSpatialBox2 Bounds() const {
+
+			GSpatialBox2 b;
+			GUInt32 i, j = (GUInt32)gItems.size();
+
+			for (i = 0; i < j; ++i) {
+				if (gValid[i])
+					b.Extend(gBoxes[i]);
+			}
+			return b;
+		}
+	};
+
+	/*!
+		\class GSpatialNearest2
+		\brief Keeps the K nearest candidates found so far during a nearest neighbor query.
+	*/
+	class GSpatialNearest2 {
+
+	private:
+		// max-heap on squared distances
+		GDynArray<GSpatialHit2> gHeap;
+		GUInt32 gK;
+
+	public:
+		//! Constructor, K is the number of wanted neighbors.
+		GSpatialNearest2(const GUInt32 K) : gK(K) {
+			gHeap.reserve(K);
+		}
+		//! Squared distance of the worst kept candidate, or G_MAX_REAL if less than K candidates have been found.
+		inline GReal WorstDistanceSquared() const {
+			return (gHeap.size() < gK) ? G_MAX_REAL : gHeap.front().Distance;
+		}
+		//! Offer a candidate.
+		inline void Offer(const GUInt32 Handle, const GReal DistanceSquared) {
+
+			if (gK == 0)
+				return;
+			if (gHeap.size() < gK) {
+				gHeap.push_back(GSpatialHit2(Handle, DistanceSquared));
+				std::push_heap(gHeap.begin(), gHeap.end());
+			}
+			else
+			if (DistanceSquared < gHeap.front().Distance) {
+				std::pop_heap(gHeap.begin(), gHeap.end());
+				gHeap.back() = GSpatialHit2(Handle, DistanceSquared);
+				std::push_heap(gHeap.begin(), gHeap.end());
+			}
+		}
+		//! Move the candidates into Result, sorted by ascending distance (distances are not squared).
+		void Extract(GDynArray<GSpatialHit2>& Result) {
+
+			std::sort_heap(gHeap.begin(), gHeap.end());
+			Result = gHeap;
+			for (GUInt32 i = 0; i < (GUInt32)Result.size(); ++i)
+				Result[i].Distance = GMath::Sqrt(Result[i].Distance);
+			gHeap.clear();
+		}
+	};
+
+	/*!
+		\struct GSpatialQueueEntry2
+		\brief A node waiting to be visited during best first traversals (nearest node first).
+	*/
+	struct GSpatialQueueEntry2 {
+		//! Node index.
+		GInt32 Node;
+		//! Squared distance between the node and the query point.
+		GReal DistanceSquared;
+
+		//! Set constructor.
+		GSpatialQueueEntry2(const GInt32 Node_, const GReal DistanceSquared_)
+		: Node(Node_), DistanceSquared(DistanceSquared_) {
+		}
+		//! Reversed ordering, so that std heaps keep the nearest node on top.
+		inline GBool operator <(const GSpatialQueueEntry2& Entry) const {
+			return (DistanceSquared > Entry.DistanceSquared);
+		}
+	};
+
+};	// end namespace Amanith
+
+#endif
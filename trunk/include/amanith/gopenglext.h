@@ -86,6 +86,12 @@ namespace Amanith {
 		GBool IsOcclusionQuerySupported() const;
 		//! Check if FBO (frame buffer object) extension is supported by the underlying OpenGL device.
 		GBool IsFBOSupported() const;
+		//! Check if PBO (pixel buffer object) extension is supported by the underlying OpenGL device.
+		GBool IsPBOSupported() const;
+		//! Check if VBO (vertex buffer object) extension is supported by the underlying OpenGL device.
+		GBool IsVBOSupported() const;
+		//! Check if NV fences are supported by the underlying OpenGL device.
+		GBool IsFenceSupported() const;
 		//! Return the number of texture units of the underlying OpenGL device
 		static GInt32 TextureUnitsCount();
 		//! Return maximum acceptable filter kernel width (0 if no convolution support).
@@ -110,6 +116,8 @@ namespace Amanith {
 		static GUInt32 StencilBits();
 		//! Get number of multisamples used by render context
 		static GUInt32 MultiSamples();
+		//! Get number of bits of subpixel precision used by the rasterizer to position vertices.
+		static GUInt32 SubPixelBits();
 		//! Get the number of maximum color attachments permitted for FBO.
 		static GUInt32 FBOMaxColorAttachments();
 		//! Get the list of supported OpenGL functions over OpenGL 1.1 version
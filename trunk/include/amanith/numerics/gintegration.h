@@ -53,6 +53,27 @@ namespace Amanith {
 		//! Romberg integration for continuous scalar functions.
 		static GBool Romberg(GReal& Result,	const GReal u0, const GReal u1, GFunction Function,
 							 void *UserData, const GReal MaxError = G_EPSILON);
+		//! Type definition of a batched scalar function callback; it must write a value for each one of the Count parameters.
+		typedef void (*GBatchFunction)(const GReal *, GReal *, const GUInt32, void*);
+		/*!
+			Adaptive Gauss-Kronrod (7-15 points) integration for continuous scalar functions.
+
+			The sub-interval with the largest estimated error is bisected, until the sum of all errors falls below
+			the requested precision. The integrand is always evaluated 15 or 30 points at once.
+
+			\param Result the output calculated integral.
+			\param u0 lower bound of integration domain
+			\param u1 upper bound of integration domain
+			\param Function the batched callback function used to evaluate integrand.
+			\param UserData pointer passed to the callback function.
+			\param MaxError the maximum relative precision we wanna reach for the integral calculus.
+			\param MaxIntervals the maximum number of sub-intervals the domain can be split into.
+			\return G_TRUE if the specified precision has been reached, G_FALSE otherwise
+			\note a relative precision below 100 * G_EPSILON can't be told apart from roundoff, so it is clamped
+			to that value.
+		*/
+		static GBool GaussKronrod(GReal& Result, const GReal u0, const GReal u1, GBatchFunction Function,
+								  void *UserData, const GReal MaxError = G_EPSILON, const GUInt32 MaxIntervals = 128);
 	};
 };
 
@@ -0,0 +1,211 @@
+/****************************************************************************
+** $file: amanith/rendering/gcolorramp.h   0.3.0.0   edited Jan, 30 2006
+**
+** Color ramp (gradient lookup table) definition.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GCOLORRAMP_H
+#define GCOLORRAMP_H
+
+#include "amanith/rendering/gdrawstyle.h"
+
+/*!
+	\file gcolorramp.h
+	\brief Header file for GColorRamp and GColorRampCache classes.
+*/
+namespace Amanith {
+
+	// *********************************************************************
+	//                              GColorRamp
+	// *********************************************************************
+
+	/*!
+		\class GColorRamp
+		\brief A lookup table of ARGB32 colors, sampled from gradient color keys.
+
+		The table is generated once from color keys (constant, linear or Hermite interpolation), and it is
+		independent from any rendering backend: the OpenGL board uploads it as a texture, while software
+		span generators read it directly.\n
+		Table entries are evenly distributed over the keys domain: the first entry is the color of the first
+		key, and the last entry is the color of the last key. A mirrored table, instead, spans twice the
+		keys domain (the second half is the first one reversed), so that a simple repeat produces the
+		reflect spread mode.\n
+		Colors are stored as native ARGB32 words, like G_A8R8G8B8 pixel maps.
+	*/
+	class G_EXPORT GColorRamp {
+
+	private:
+		//! Table colors.
+		GDynArray<GUInt32> gColors;
+		//! Source color keys, as specified to Build().
+		GDynArray<GKeyValue> gKeys;
+		//! Color interpolation used to build the table.
+		GColorRampInterpolation gInterpolation;
+		//! Spread mode, used by lookup functions.
+		GColorRampSpreadMode gSpreadMode;
+		//! G_TRUE if table colors are premultiplied.
+		GBool gPremultiplied;
+		//! G_TRUE if the table spans twice the keys domain (reflected).
+		GBool gMirrored;
+		//! Hash key, see HashKey().
+		GUInt32 gHashKey;
+
+	public:
+		//! Default constructor, it builds an empty ramp.
+		GColorRamp();
+		/*!
+			Build the colors table.
+
+			\param ColorKeys color keys; they can be G_VECTOR3_KEY (opaque colors) or G_VECTOR4_KEY values, with
+			components in the range [0; 1].
+			\param Interpolation color interpolation.
+			\param SpreadMode spread mode that will be applied by lookup functions.
+			\param Size number of table entries, it must be at least 2.
+			\param Premultiplied if G_TRUE, table colors are premultiplied by their alpha.
+			\param Mirrored if G_TRUE, the table spans twice the keys domain, the second half being the
+			reflection of the first one.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+		*/
+		GError Build(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+					 const GColorRampSpreadMode SpreadMode, const GUInt32 Size, const GBool Premultiplied = G_TRUE,
+					 const GBool Mirrored = G_FALSE);
+		/*!
+			Calculate the hash key of a ramp, without building it. Ramps built with the same parameters
+			always have the same hash key.
+		*/
+		static GUInt32 HashKey(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+							   const GColorRampSpreadMode SpreadMode, const GUInt32 Size,
+							   const GBool Premultiplied = G_TRUE, const GBool Mirrored = G_FALSE);
+		//! Returns G_TRUE if this ramp has been built using the specified parameters.
+		GBool Matches(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+					  const GColorRampSpreadMode SpreadMode, const GUInt32 Size,
+					  const GBool Premultiplied = G_TRUE, const GBool Mirrored = G_FALSE) const;
+		//! Get the hash key of this ramp.
+		inline GUInt32 HashKey() const {
+			return gHashKey;
+		}
+		//! Get table colors.
+		inline const GUInt32 *Colors() const {
+			if (gColors.empty())
+				return NULL;
+			return &gColors[0];
+		}
+		//! Get the number of table entries.
+		inline GUInt32 Size() const {
+			return (GUInt32)gColors.size();
+		}
+		//! Get color interpolation.
+		inline GColorRampInterpolation ColorInterpolation() const {
+			return gInterpolation;
+		}
+		//! Get spread mode.
+		inline GColorRampSpreadMode SpreadMode() const {
+			return gSpreadMode;
+		}
+		//! Returns G_TRUE if table colors are premultiplied.
+		inline GBool IsPremultiplied() const {
+			return gPremultiplied;
+		}
+		//! Returns G_TRUE if the table spans twice the keys domain.
+		inline GBool IsMirrored() const {
+			return gMirrored;
+		}
+		/*!
+			Get the color at the specified ramp parameter, applying the spread mode.
+
+			\param U the ramp parameter; 0 corresponds to the first key, 1 to the last one.
+		*/
+		GUInt32 Color(const GReal U) const;
+		/*!
+			Get colors for an arithmetic sequence of ramp parameters (U0, U0 + DeltaU, U0 + 2 * DeltaU, ...),
+			applying the spread mode. This is the typical case of a linear gradient scanline.
+
+			\param U0 the first ramp parameter; 0 corresponds to the first key, 1 to the last one.
+			\param DeltaU the parameter increment between two consecutive colors.
+			\param Colors output buffer, it must be able to contain Count colors.
+			\param Count the number of colors to generate.
+		*/
+		void Colors(const GReal U0, const GReal DeltaU, GUInt32 *Colors, const GUInt32 Count) const;
+	};
+
+	// *********************************************************************
+	//                           GColorRampCache
+	// *********************************************************************
+
+	/*!
+		\class GColorRampCache
+		\brief A set of reference counted color ramps, looked up by hash key.
+
+		Gradients sharing the same color keys and ramp parameters get the same GColorRamp instance, so that
+		the table is generated (and eventually uploaded to the graphic device) only once.
+	*/
+	class G_EXPORT GColorRampCache {
+
+	private:
+		struct GCachedRamp {
+			GColorRamp *Ramp;
+			GUInt32 RefCount;
+		};
+		//! Cached ramps, sorted by hash key.
+		GDynArray<GCachedRamp> gRamps;
+
+		//! Get the index of the first cached ramp with a hash key not less than the specified one.
+		GUInt32 LowerBound(const GUInt32 HashKey) const;
+
+		// disable copy
+		GColorRampCache(const GColorRampCache& Source);
+		GColorRampCache& operator =(const GColorRampCache& Source);
+
+	public:
+		//! Constructor, it builds an empty cache.
+		GColorRampCache();
+		//! Destructor, it deletes all cached ramps (even if they are still referenced).
+		~GColorRampCache();
+		/*!
+			Get a ramp built from the specified parameters (see GColorRamp::Build); if an identical ramp is
+			already cached it is shared, else a new one is built.
+
+			\param NewRamp returns G_TRUE if the ramp has been built by this call.
+			\return the ramp, or NULL if it cannot be built. The returned ramp must be released calling Release().
+		*/
+		const GColorRamp *Acquire(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+								  const GColorRampSpreadMode SpreadMode, const GUInt32 Size,
+								  const GBool Premultiplied, const GBool Mirrored, GBool& NewRamp);
+		/*!
+			Release a ramp previously returned by Acquire(); when its references counter reaches 0, the ramp
+			is deleted.
+
+			\return G_TRUE if the ramp has been deleted, G_FALSE otherwise.
+		*/
+		GBool Release(const GColorRamp *Ramp);
+		//! Get the number of cached ramps.
+		inline GUInt32 RampsCount() const {
+			return (GUInt32)gRamps.size();
+		}
+	};
+
+};	// end namespace Amanith
+
+#endif
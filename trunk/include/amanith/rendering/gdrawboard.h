@@ -30,8 +30,9 @@
 #define GDRAWBOARD_H
 
 #include "amanith/gglobal.h"
-#include "amanith/2d/gpath2d.h"
+#include "amanith/2d/gpathdata.h"
 #include "amanith/rendering/gdrawstyle.h"
+#include <cstring>
 
 /*!
 	\file gdrawboard.h
@@ -71,6 +72,16 @@ namespace Amanith {
 		G_INTERSECTION_CLIP
 	};
 
+	//! How shapes smaller than the sub-pixel size are drawn (see GDrawBoard::SetSubPixelMode()).
+	enum GSubPixelMode {
+		//! Draw them like any other shape.
+		G_DRAW_SUBPIXEL_MODE,
+		//! Skip them.
+		G_SKIP_SUBPIXEL_MODE,
+		//! Draw them as a pixel sized rectangle, without any flattening or tessellation.
+		G_POINT_SUBPIXEL_MODE
+	};
+
 	// *********************************************************************
 	//                           GRenderingContext
 	// *********************************************************************
@@ -179,12 +190,28 @@ namespace Amanith {
 		"container" (like a sort of memory bank) of cached primitives is first created. Then to draw geometries onto
 		cache bank it's a simple matter to set G_CACHE_MODE as target mode. Each drawing operation will append a new
 		slot to the bank. After caching, the user can draw each slot using DrawCacheSlot() function.
-		The users can invalidate a cache bank using the function Invalidate().
+		The users can invalidate a cache bank using the function Invalidate().\n\n
+		Before a shape is passed to the implementation, its bounding box is transformed by the model-view matrix.
+		In G_COLOR_MODE target mode, shapes that fall outside the logical window or outside the bounds of the
+		clip masks are rejected (see SetCullingEnabled()), and shapes smaller than a pixel can be skipped or
+		drawn as points (see SetSubPixelMode()). The scale of the model-view matrix is passed to the
+		implementation too, so that curves are flattened according to their size on screen.
 	*/
 	class G_EXPORT GDrawBoard {
 	private:
 		GBool gInsideGroup;
 		GRenderingContext gCurrentContext;
+		// culling and sub-pixel settings
+		GBool gCullingEnabled;
+		GSubPixelMode gSubPixelMode;
+		GReal gSubPixelSize;
+		// culling counters
+		GUInt32 gCulledPrimitives;
+		GUInt32 gSubPixelPrimitives;
+
+		// per-shape preparation; it returns G_FALSE if the shape has been already handled (Result contains the
+		// value to return)
+		GBool BeginShape(const GAABox2 *Box, GInt32& Result);
 
 	protected:
 		//! Current viewport.
@@ -491,6 +518,37 @@ namespace Amanith {
 			\note this method <b>MUST</b> be implemented by all derived classes.
 		*/
 		virtual GInt32 DoDrawPaths(GDrawStyle& Style, const GDynArray<GCurve2D *>& Curves) = 0;
+		/*!
+			Do the effective drawing of a (multi)path, specified by SVG path data.
+
+			The default implementation parses the data with GSVGPathParser and feeds the resulting commands to
+			BeginPaths(), MoveTo(), LineTo(), CurveTo(), EllipticalArcTo(), ClosePath() and EndPaths(). Derived
+			classes can override it to flatten the data directly, without going through path commands.
+
+			\param Style the drawstyle to use.
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param AnglesMeasureUnits the system units into which angles are expressed inside path data.
+			\return if caching is enabled (G_CACHE_MODE, G_CLIP_AND_CACHE_MODE and G_COLOR_AND_CACHE_MODE target modes)
+			and a valid cache bank is currently set, it must returns the slot index (where the primitive has been inserted)
+			in the active cache bank, else an error code.
+		*/
+		virtual GInt32 DoDrawSVGPaths(GDrawStyle& Style, const GChar8 *Begin, const GChar8 *End,
+									  const GAnglesMeasureUnit AnglesMeasureUnits);
+		/*!
+			Do the effective drawing of a compact path.
+
+			The default implementation feeds path verbs to BeginPaths(), MoveTo(), LineTo(), CurveTo(),
+			EllipticalArcTo(), ClosePath() and EndPaths(). Derived classes can override it to flatten the path
+			directly.
+
+			\param Style the drawstyle to use.
+			\param Data the path to draw, it's ensured to be non-empty.
+			\return if caching is enabled (G_CACHE_MODE, G_CLIP_AND_CACHE_MODE and G_COLOR_AND_CACHE_MODE target modes)
+			and a valid cache bank is currently set, it must returns the slot index (where the primitive has been inserted)
+			in the active cache bank, else an error code.
+		*/
+		virtual GInt32 DoDrawPathData(GDrawStyle& Style, const GPathData& Data);
 		/*!
 			Draw the current cache bank slots. Here it's ensured that current cache bank is non-NULL and
 			that FirstSlotIndex <= LastSlotIndex.
@@ -514,6 +572,30 @@ namespace Amanith {
 			\note this method <b>MUST</b> be implemented by all derived classes.
 		*/
 		virtual GError DoScreenShot(GPixelMap& Output, const GVectBase<GUInt32, 2>& P0, const GVectBase<GUInt32, 2>& P1) const = 0;
+		/*!
+			Set the scale of the shape that is going to be drawn.
+
+			It is called before each drawing operation, and before each path block. Scale is the maximum
+			stretching that the model-view matrix applies to the shape, so implementations can choose a
+			flattening deviation that gives the same precision on screen at any zoom level.
+			Default implementation does nothing.
+		*/
+		virtual void DoSetShapeScale(const GReal Scale);
+		/*!
+			Get the bounds of the region where clip masks permit drawing.
+
+			\param Box the region, expressed in logical coordinates (model-view matrix already applied).
+			\return G_TRUE if clip masks are enabled and their bounds are known, else G_FALSE. Default
+			implementation returns G_FALSE, so shapes are culled against the logical window only.
+		*/
+		virtual GBool DoClipMasksBox(GAABox2& Box) const;
+		/*!
+			Get the maximum stretching of the current model-view matrix.
+
+			It is the greatest singular value of the linear part of the matrix, so every length is multiplied by
+			at most this factor.
+		*/
+		GReal ModelViewScale() const;
 
 
 		inline GDrawStyle *CurrentStyle() {
@@ -699,6 +781,61 @@ namespace Amanith {
 		const GMatrix33& ModelViewMatrix() const;
 		//! Set model-view matrix.
 		void SetModelViewMatrix(const GMatrix33& Matrix);
+
+		//---------------------------------------------------------------------------
+		//                           CULLING & LEVEL OF DETAIL
+		//---------------------------------------------------------------------------
+		//! Get culling enable/disable flag.
+		inline GBool CullingEnabled() const {
+			return gCullingEnabled;
+		}
+		/*!
+			Enable (G_TRUE value) or disable (G_FALSE value) culling.
+
+			When culling is enabled (default), in G_COLOR_MODE target mode the shapes whose bounding box (stroke
+			included, model-view matrix applied) does not intersect the logical window, or the bounds of the clip
+			masks, are not passed to the implementation at all. Clip and cache target modes are never culled,
+			because their results do not depend only on what is visible.
+		*/
+		inline void SetCullingEnabled(const GBool Enabled) {
+			gCullingEnabled = Enabled;
+		}
+		//! Get the way shapes smaller than the sub-pixel size are drawn.
+		inline GSubPixelMode SubPixelMode() const {
+			return gSubPixelMode;
+		}
+		/*!
+			Set the way shapes smaller than the sub-pixel size are drawn.
+
+			A shape is considered sub-pixel when both dimensions of its bounding box, on screen, are smaller
+			than SubPixelSize(). Like culling, this applies to G_COLOR_MODE target mode only. Default mode is
+			G_DRAW_SUBPIXEL_MODE.
+		*/
+		inline void SetSubPixelMode(const GSubPixelMode Mode) {
+			gSubPixelMode = Mode;
+		}
+		//! Get the sub-pixel size, in pixels.
+		inline GReal SubPixelSize() const {
+			return gSubPixelSize;
+		}
+		//! Set the sub-pixel size, in pixels (default is 1). Negative values are taken as absolute values.
+		inline void SetSubPixelSize(const GReal Size) {
+			gSubPixelSize = GMath::Abs(Size);
+		}
+		//! Get the number of shapes rejected because outside the logical window or the clip masks.
+		inline GUInt32 CulledPrimitivesCount() const {
+			return gCulledPrimitives;
+		}
+		//! Get the number of sub-pixel shapes skipped or drawn as points.
+		inline GUInt32 SubPixelPrimitivesCount() const {
+			return gSubPixelPrimitives;
+		}
+		//! Reset culling counters.
+		inline void ResetCullingCounters() {
+			gCulledPrimitives = 0;
+			gSubPixelPrimitives = 0;
+		}
+
 		//---------------------------------------------------------------------------
 		//                                  STROKE
 		//---------------------------------------------------------------------------
@@ -1124,7 +1261,10 @@ namespace Amanith {
 			and a valid cache bank is currently set, it returns the slot index (where the primitive has been inserted)
 			in the active cache bank, else an error code.
 		*/
-		GInt32 DrawPaths(const GString& SVGPathDescription, const GAnglesMeasureUnit AnglesMeasureUnits = G_DEGREE_UNIT);
+		inline GInt32 DrawPaths(const GString& SVGPathDescription, const GAnglesMeasureUnit AnglesMeasureUnits = G_DEGREE_UNIT) {
+			return DrawPaths(SVGPathDescription.data(), SVGPathDescription.data() + SVGPathDescription.length(),
+							 AnglesMeasureUnits);
+		}
 		/*!
 			Draw a (multi)path, specifying an SVG description.
 
@@ -1136,8 +1276,31 @@ namespace Amanith {
 			in the active cache bank, else an error code.
 		*/
 		inline GInt32 DrawPaths(const GChar8 *SVGPathDescription, const GAnglesMeasureUnit AnglesMeasureUnits = G_DEGREE_UNIT) {
-			return DrawPaths(GString(SVGPathDescription), AnglesMeasureUnits);
+			return DrawPaths(SVGPathDescription, SVGPathDescription + std::strlen(SVGPathDescription), AnglesMeasureUnits);
 		}
+		/*!
+			Draw a (multi)path, specifying a range of SVG path data.
+
+			Path data is parsed in place, so this is the fastest way to draw paths coming from an SVG document: there's
+			no need to copy the 'd' attribute into a string.
+
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param AnglesMeasureUnits the system units into which angles are expressed inside path data.
+			\return if caching is enabled (G_CACHE_MODE, G_CLIP_AND_CACHE_MODE and G_COLOR_AND_CACHE_MODE target modes)
+			and a valid cache bank is currently set, it returns the slot index (where the primitive has been inserted)
+			in the active cache bank, else an error code.
+		*/
+		GInt32 DrawPaths(const GChar8 *Begin, const GChar8 *End, const GAnglesMeasureUnit AnglesMeasureUnits = G_DEGREE_UNIT);
+		/*!
+			Draw a compact path, made of one or more contours.
+
+			\param Data the path to draw.
+			\return if caching is enabled (G_CACHE_MODE, G_CLIP_AND_CACHE_MODE and G_COLOR_AND_CACHE_MODE target modes)
+			and a valid cache bank is currently set, it returns the slot index (where the primitive has been inserted)
+			in the active cache bank, else an error code.
+		*/
+		GInt32 DrawPaths(const GPathData& Data);
 		/*!
 			Start an SVG-like path block.
 			Each opened block must be closed calling EndPaths() function.
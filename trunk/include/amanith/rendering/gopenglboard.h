@@ -30,6 +30,7 @@
 #define GOPENGLBOARD_H
 
 #include "amanith/rendering/gdrawboard.h"
+#include "amanith/rendering/gcolorramp.h"
 #include "amanith/2d/gtesselator2d.h"
 #include "amanith/gopenglext.h"
 #include <utility>
@@ -43,6 +44,59 @@ namespace Amanith {
 	// forward declaration
 	class GOpenGLBoard;
 
+	// *********************************************************************
+	//                          GOpenGLRampTextures
+	// *********************************************************************
+	/*!
+		\class GOpenGLRampTextures
+		\brief Reference counted OpenGL textures generated from color ramps.
+
+		Gradients with identical color keys (and texture parameters) share the same GColorRamp and the same
+		OpenGL texture, so the ramp is generated and uploaded only once. Each GOpenGLBoard owns an instance
+		of this class.
+	*/
+	class G_EXPORT GOpenGLRampTextures {
+
+	private:
+		struct GRampTexture {
+			//! Source color ramp (a reference is held for each texture).
+			const GColorRamp *Ramp;
+			//! Texture target: GL_TEXTURE_1D for plain ramps, GL_TEXTURE_2D for conical lookup textures.
+			GLenum Target;
+			//! OpenGL texture handle.
+			GLuint TexName;
+			//! Number of gradients that use this texture.
+			GUInt32 RefCount;
+		};
+		//! Shared (non-premultiplied) color ramps.
+		GColorRampCache gRamps;
+		//! Generated textures.
+		GDynArray<GRampTexture> gTextures;
+
+		// disable copy
+		GOpenGLRampTextures(const GOpenGLRampTextures& Source);
+		GOpenGLRampTextures& operator =(const GOpenGLRampTextures& Source);
+
+	public:
+		//! Constructor.
+		GOpenGLRampTextures();
+		//! Destructor, it deletes all generated OpenGL textures.
+		~GOpenGLRampTextures();
+		/*!
+			Get a texture for the specified color ramp.
+
+			\param Target the texture target.
+			\param Ramp returns the color ramp associated to the texture.
+			\param NewTexture returns G_TRUE if the texture has just been generated, so the caller must fill it.
+			\return the OpenGL texture handle, 0 in case of errors. It must be released calling Release().
+		*/
+		GLuint Acquire(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+					   const GColorRampSpreadMode SpreadMode, const GUInt32 Size, const GBool Mirrored,
+					   const GLenum Target, const GColorRamp *&Ramp, GBool& NewTexture);
+		//! Release a texture returned by Acquire(), deleting it if it is no more used.
+		void Release(const GLuint TexName);
+	};
+
 	// *********************************************************************
 	//                          GOpenGLGradientDesc
 	// *********************************************************************
@@ -60,12 +114,16 @@ namespace Amanith {
 	private:
 		//! OpenGL texture handle.
 		GLuint gGradientTexture;
+		//! Shared ramp textures, written only at creation time by GOpenGLBoard.
+		GOpenGLRampTextures *gRampTextures;
 		//! G_TRUE if specified color keys contain alpha values (so GL_BLEND must be enabled).
 		GBool gAlphaKeys;
 		GDynArray<GVector4> gInTangents;
 		GDynArray<GVector4> gOutTangents;
 
-		void GenerateTexture1D(const GInt32 Size, GPixelMap& Bitmap, const GBool ReflectKeys);
+		// get a shared ramp texture for the current color keys, releasing the old one
+		const GColorRamp *AcquireRampTexture(const GUInt32 Size, const GBool Mirrored, const GLenum Target,
+											 GBool& NewTexture);
 
 	protected:
 		static void SetGLGradientQuality(const GRenderingQuality Quality);
@@ -78,7 +136,7 @@ namespace Amanith {
 	public:
 		//! Default constructor.
 		GOpenGLGradientDesc();
-		//! Destructor, it deletes created OpenGL textures.
+		//! Destructor, it releases used OpenGL textures.
 		~GOpenGLGradientDesc();
 		//! Set color keys; this overridden implementation claps all color components in the range [0; 1].
 		void SetColorKeys(const GDynArray<GKeyValue>& ColorKeys);
@@ -176,16 +234,21 @@ namespace Amanith {
 	//                           GOpenGLCacheSlot
 	// *********************************************************************
 	struct GOpenGLCacheSlot {
-		// display list for fill
-		GLuint FillDisplayList;
-		// display list for stroke
-		GLuint StrokeDisplayList;
+		// vertex buffer object containing fill triangles followed by stroke triangles (0 if not used)
+		GLuint VertexBuffer;
+		// client memory triangles, used when vertex buffer objects are not supported
+		GDynArray<GLfloat> Vertices;
+		// number of fill vertices
+		GLsizei FillVerticesCount;
+		// number of stroke vertices
+		GLsizei StrokeVerticesCount;
 		// bounding box of the primitive, ALWAYS including stroke
 		GAABox2 Box;
 		// constructor
 		GOpenGLCacheSlot() {
-			FillDisplayList = 0;
-			StrokeDisplayList = 0;
+			VertexBuffer = 0;
+			FillVerticesCount = 0;
+			StrokeVerticesCount = 0;
 		}
 	};
 
@@ -198,7 +261,8 @@ namespace Amanith {
 		is in unique correspondence to a single drawn primitive on the current target buffer).
 		
 		A cache bank, after being filled, can be reused to draw cached shapes. The bank can be invalidated using
-		the function Invalidate(). This implementation uses OpenGL display lists, and stroke and fill parts are
+		the function Invalidate(). This implementation stores fill and stroke triangles inside a vertex buffer object
+		(or inside client memory, if vertex buffer objects are not supported), and stroke and fill parts are
 		always cached independently of StrokeEnabled() and FillEnabled() style flags.
 	*/
 	class G_EXPORT GOpenGLCacheBank : public GCacheBank {
@@ -229,6 +293,8 @@ namespace Amanith {
 		GLenum Format;
 		GLuint TexName;
 		GBool IsEmpty;
+		// texel position, inside the texture, of the grabbed rectangle lower-left corner
+		GUInt32 OffsetX, OffsetY;
 		GAABox2 gExpandedLogicBox;
 		GAABox2 gNotExpandedLogicBox;
 
@@ -236,6 +302,7 @@ namespace Amanith {
 		GLGrabbedRect() {
 			Width = Height = 0;
 			TexWidth = TexHeight = 0;
+			OffsetX = OffsetY = 0;
 			Target = GL_TEXTURE_2D;
 			Format = GL_RGBA;
 			TexName = 0;
@@ -249,6 +316,135 @@ namespace Amanith {
 		}
 	};
 
+	// internal structure used to keep an unused grab texture inside the pool
+	struct GLGrabTexture {
+
+		GLuint TexName;
+		GLenum Target;
+		GUInt32 TexWidth, TexHeight;
+	};
+
+	/*!
+		\struct GLGrabStatistics
+		\brief Framebuffer grab counters, collected by GOpenGLBoard for each frame.
+
+		Compositing operations and groups copy portions of the framebuffer into textures; these counters
+		measure such traffic. A frame starts at every GDrawBoard::Clear() call.
+	*/
+	struct GLGrabStatistics {
+
+		//! Number of framebuffer rectangles copied into grab textures.
+		GUInt32 GrabsCount;
+		//! Number of bytes copied from the framebuffer into grab textures.
+		GUInt32 CopiedBytes;
+		//! Number of grab textures allocated.
+		GUInt32 TexturesCreated;
+		//! Number of grab textures taken from the pool, instead of being allocated.
+		GUInt32 PoolHits;
+
+		// constructor
+		GLGrabStatistics() {
+			GrabsCount = 0;
+			CopiedBytes = 0;
+			TexturesCreated = 0;
+			PoolHits = 0;
+		}
+	};
+
+	/*!
+		\struct GLGeometryCacheStatistics
+		\brief Geometry cache counters, collected by GOpenGLBoard.
+
+		See GOpenGLBoard::SetGeometryCacheEnabled() for a description of the geometry cache.
+	*/
+	struct GLGeometryCacheStatistics {
+
+		//! Number of shapes drawn from the cache, skipping flattening and tessellation.
+		GUInt32 Hits;
+		//! Number of cacheable shapes not found inside the cache.
+		GUInt32 Misses;
+		//! Number of shapes evicted to stay within the memory budget.
+		GUInt32 Evictions;
+		//! Number of shapes currently cached.
+		GUInt32 EntriesCount;
+		//! Memory currently used by cached shapes, in bytes.
+		GUInt32 UsedBytes;
+
+		// constructor
+		GLGeometryCacheStatistics() {
+			Hits = 0;
+			Misses = 0;
+			Evictions = 0;
+			EntriesCount = 0;
+			UsedBytes = 0;
+		}
+	};
+
+	// internal structure used to keep a shape inside the geometry cache
+	struct GLGeometryCacheEntry {
+
+		//! Hash of the key.
+		GUInt32 Hash;
+		//! Key bytes: drawing function, shape parameters, style parameters and flattening deviation.
+		GDynArray<GUChar8> Key;
+		//! Cached triangles.
+		GOpenGLCacheSlot Slot;
+		//! Memory used by the entry, in bytes.
+		GUInt32 Bytes;
+	};
+
+	// internal structure used to find geometry cache entries by hash
+	struct GLGeometryCacheIndex {
+
+		GUInt32 Hash;
+		GList<GLGeometryCacheEntry>::iterator Entry;
+	};
+
+	// internal structure used to keep a rectangular clip mask realized through the scissor test
+	struct GLScissorMask {
+
+		//! Number of clip masks on the stack when this mask was pushed, this mask included.
+		GUInt32 Depth;
+		//! Window rectangle covered by the mask (lower-left corner included, upper-right corner excluded).
+		GLint X0, Y0, X1, Y1;
+	};
+
+	// internal structure used to read back a portion of the framebuffer asynchronously
+	struct GLReadbackSlot {
+
+		//! Pixel pack buffer object (0 if pixel buffer objects are not supported).
+		GLuint BufferName;
+		//! NV fence set after the read (0 if fences are not supported).
+		GLuint FenceName;
+		//! Client memory pixels, used when pixel buffer objects are not supported.
+		GUInt32 *Pixels;
+		//! Capacity of the buffer (or of client memory), in pixels.
+		GUInt32 Capacity;
+		//! Dimensions of the grabbed rectangle.
+		GUInt32 Width, Height;
+		//! Identifier of the grabbed frame.
+		GUInt32 FrameID;
+
+		// constructor
+		GLReadbackSlot() {
+			BufferName = 0;
+			FenceName = 0;
+			Pixels = NULL;
+			Capacity = 0;
+			Width = Height = 0;
+			FrameID = 0;
+		}
+	};
+
+	/*!
+		Asynchronous screenshot callback, see GOpenGLBoard::SetScreenShotCallback().
+
+		\param Frame the grabbed image; it is valid only during the call.
+		\param FrameID the identifier returned by GOpenGLBoard::ScreenShotAsync() when the grab was issued.
+		\param UserData the user data pointer specified to GOpenGLBoard::SetScreenShotCallback().
+	*/
+	typedef void (*GScreenShotCallback)(const GPixelMap& Frame, const GUInt32 FrameID, void *UserData);
+
 	typedef std::vector<GPoint2>::const_iterator Point2ConstIt;
 
 	#define SELECT_AND_DISABLE_TUNIT(TexUnit) \
@@ -279,7 +475,10 @@ namespace Amanith {
 		the geometric pass is always just one.
 		The compositing done on groups is implemented according to SVG 1.2 rendering model following the
 		behavior of clip-to-self=false, enable-background=new, knock-out=true.
-		In this implementation the whole caching system is based on OpenGL display lists.
+		In this implementation the whole caching system is based on vertex buffer objects; in addition, repeated
+		shapes are cached automatically (see SetGeometryCacheEnabled()).
+		Rectangular clip masks drawn with an axis-preserving model-view matrix are realized through the scissor
+		test instead of the stencil buffer (see SetScissorClipMasksEnabled()).
 	*/
 	class G_EXPORT GOpenGLBoard : public GDrawBoard {
 	private:
@@ -287,6 +486,8 @@ namespace Amanith {
 		GOpenglExt *gExtManager;
 		//! List of all created gradients.
 		GDynArray<GOpenGLGradientDesc *> gGradients;
+		//! Color ramp textures shared by gradients.
+		GOpenGLRampTextures gRampTextures;
 		//! List of all created patterns.
 		GDynArray<GOpenGLPatternDesc *> gPatterns;
 		//! List of all created cache banks.
@@ -333,10 +534,90 @@ namespace Amanith {
 		GReal gDeviation;
 		//! Defined as Sqrt(gDeviation).
 		GReal gFlateness;
+		//! Squared deviation for a shape drawn with a unit scale model-view matrix.
+		GReal gBaseDeviation;
+		//! Model-view scale of the current shape, gDeviation is gBaseDeviation / Sqr(gShapeScale).
+		GReal gShapeScale;
 		//! Last grabbed portion of the frame buffer, used to do group opacity.
 		GLGrabbedRect gGLGroupRect;
 		//! Last grabbed portion of the frame buffer, used to do compositing operation.
 		GLGrabbedRect gCompositingBuffer;
+		//! Unused grab textures, from the least to the most recently released.
+		GDynArray<GLGrabTexture> gGrabTexturesPool;
+		//! G_TRUE if the current group saves its background lazily, as drawings touch it.
+		GBool gGroupTracking;
+		//! G_TRUE if something has been drawn inside the current group.
+		GBool gGroupDamaged;
+		//! Device rectangle covered by the current group (maximum corner excluded).
+		GGenericAABox<GInt32, 2> gGroupDeviceBox;
+		//! Device rectangle whose background has been saved (and cleared) so far, aligned to group tiles.
+		GGenericAABox<GInt32, 2> gGroupSavedBox;
+		//! Device rectangle actually touched by drawings inside the current group.
+		GGenericAABox<GInt32, 2> gGroupDamageBox;
+		//! Grab counters of the current frame.
+		GLGrabStatistics gGrabStats;
+		//! Grab counters of the last completed frame.
+		GLGrabStatistics gLastGrabStats;
+		//! Maximum number of unused grab textures kept inside the pool.
+		GUInt32 gGrabTexturesPoolSize;
+		//! G_TRUE if pixel buffer objects are supported (used by asynchronous screenshots), else G_FALSE.
+		GBool gPixelBufferSupport;
+		//! G_TRUE if NV fences are supported (used by asynchronous screenshots), else G_FALSE.
+		GBool gFenceSupport;
+		//! G_TRUE if vertex buffer objects are supported (used by cached shapes), else G_FALSE.
+		GBool gVertexBufferSupport;
+		//! Destination of the vertices emitted through GLBegin() / GLVertex() / GLEnd(), NULL to draw them immediately.
+		GDynArray<GLfloat> *gRecordedVertices;
+		//! Primitive type of the vertices being recorded.
+		GLenum gRecordedMode;
+		//! Position (inside gRecordedVertices) of the first vertex of the primitive being recorded.
+		GUInt32 gRecordedFirst;
+		//! Vertices recorded for a cache slot.
+		GDynArray<GLfloat> gSlotVertices;
+		//! G_TRUE if repeated shapes are cached automatically, else G_FALSE.
+		GBool gGeometryCacheEnabled;
+		//! Memory budget of the geometry cache, in bytes.
+		GUInt32 gGeometryCacheBudget;
+		//! Cached shapes, from the most to the least recently used.
+		GList<GLGeometryCacheEntry> gGeometryCache;
+		//! Cached shapes, sorted by hash.
+		GDynArray<GLGeometryCacheIndex> gGeometryCacheIndex;
+		//! Hashes of the shapes drawn once and not cached yet, indexed by the lowest hash bits.
+		GUInt32 gGeometryCacheSeen[256];
+		//! Key of the shape that is going to be drawn.
+		GDynArray<GUChar8> gGeometryKey;
+		//! G_TRUE if gGeometryKey is being built, else G_FALSE.
+		GBool gGeometryKeyValid;
+		//! Hash of gGeometryKey.
+		GUInt32 gGeometryKeyHash;
+		//! Geometry cache counters.
+		GLGeometryCacheStatistics gGeometryCacheStats;
+		//! Stroke of a closed convex contour, as a triangle strip of (outer, inner) points couples.
+		GDynArray<GPoint2> gConvexStroke;
+		//! G_TRUE if rectangular clip masks are realized through the scissor test, else G_FALSE.
+		GBool gScissorClipMasksEnabled;
+		//! Clip masks realized through the scissor test, in the same order they have been pushed.
+		GList<GLScissorMask> gScissorMasks;
+		//! G_TRUE if the scissor test is currently enabled for clip masks, else G_FALSE.
+		GBool gScissorTestEnabled;
+		//! Scissor box currently set for clip masks (x, y, width, height), valid when gScissorTestEnabled is G_TRUE.
+		GLint gScissorBox[4];
+		//! Number of subpixel positions per pixel, the rasterizer snaps vertices to them.
+		GReal gSubPixelScale;
+		//! Ring of asynchronous screenshot slots.
+		GDynArray<GLReadbackSlot> gReadbackSlots;
+		//! Index of the oldest pending asynchronous screenshot.
+		GUInt32 gReadbackFirst;
+		//! Number of pending asynchronous screenshots.
+		GUInt32 gReadbackCount;
+		//! Identifier that will be assigned to the next asynchronous screenshot.
+		GUInt32 gNextFrameID;
+		//! Asynchronous screenshots callback (NULL if frames must be polled).
+		GScreenShotCallback gScreenShotCallback;
+		//! User data passed to asynchronous screenshots callback.
+		void *gScreenShotUserData;
+		//! Image used to hand frames to the asynchronous screenshots callback.
+		GPixelMap gScreenShotFrame;
 		//! Fragment programs table to do compositing, when screen has alpha channel.
 		GLuint gCompProgramsRGBA[24][5][2];
 		//! Fragment programs table to do compositing, when screen hasn't alpha channel.
@@ -395,11 +676,32 @@ namespace Amanith {
 		//! Destroy shaders.
 		void DestroyShadersTable();
 
+		/*!
+			Draw a grabbed rectangle; texture coordinates of unit 1 are taken from GrabbedRect1 if specified
+			(it must have the same dimensions of GrabbedRect), else from GrabbedRect.
+		*/
 		void DrawGrabbedRect(const GLGrabbedRect& GrabbedRect, const GBool TexUnit0, const GBool SubPixel0,
-							 const GBool TexUnit1, const GBool SubPixel1);
+							 const GBool TexUnit1, const GBool SubPixel1, const GLGrabbedRect *GrabbedRect1 = NULL);
 
 		//! Grab a portion of the frame buffer.
 		void GrabFrameBuffer(const GAABox2& LogicBox, GLGrabbedRect& Shot);
+		//! Calculate the device rectangle (maximum corner excluded) grabbed for a logical box, and the logical box clipped by the projection.
+		void GrabDeviceBox(const GAABox2& LogicBox, GGenericAABox<GInt32, 2>& DeviceBox, GAABox2& ClippedBox);
+		//! Grab a device rectangle of the frame buffer into a texture, at the specified texel offset.
+		void CopyFrameBuffer(const GGenericAABox<GInt32, 2>& DeviceBox, const GLGrabbedRect& Shot,
+							 const GUInt32 OffsetX, const GUInt32 OffsetY);
+		//! Build a grabbed rectangle that refers the background of the current group, inside the specified device rectangle.
+		GLGrabbedRect GroupBackground(const GGenericAABox<GInt32, 2>& DeviceBox);
+		//! Save (into the group background texture) and clear a device rectangle of the frame buffer.
+		void SaveGroupBackground(const GGenericAABox<GInt32, 2>& DeviceBox);
+		//! Mark a device rectangle as touched by the current group, saving the background not saved yet.
+		void GroupDamageDevice(const GGenericAABox<GInt32, 2>& DeviceBox);
+		//! Mark the box of a shape (in model space, stroke included) as touched by the current group.
+		void GroupDamage(const GDrawStyle& Style, const GAABox2& ShapeBox);
+		//! Give a grab texture back to the pool.
+		void ReleaseGrabTexture(GLGrabbedRect& GrabRect);
+		//! Delete grab textures, including the pooled ones.
+		void DeleteGrabTextures();
 
 		void ReplaceFrameBuffer(const GLGrabbedRect& GrabbedRect, const GCompositingOperation CompOp,
 								const GUInt32 PassIndex);
@@ -411,11 +713,65 @@ namespace Amanith {
 		void DepthNoStencilWrite();
 		void StencilNoDepthWrite();
 		void StencilWhereDepthEqual();
+		// scissor management
+		void ScissorEnableTop();
+		void ScissorDisable();
+		/*!
+			Push a rectangular clip mask through the scissor test, if possible.
+
+			It's possible when clip masks are supported, we are outside a group, multisample antialiasing is not
+			in use, the model-view matrix is axis-preserving and the stroke (if enabled) doesn't round or bevel
+			the corners.
+			\return G_TRUE if the mask has been pushed, G_FALSE if it must be written into the stencil buffer.
+		*/
+		GBool PushScissorClipMask(const GOpenGLDrawStyle& Style, const GPoint2& MinCorner, const GPoint2& MaxCorner);
 
 		// initialize HTML valid color characters table
 		void BuildHTMLMask();
 		GBool IsValidHTMLColorChar(const GUChar8 Char);
 
+		//! Returns G_TRUE if the specified pending readback slot can be read without stalling.
+		GBool ReadbackReady(const GUInt32 SlotIndex) const;
+		//! Copy (flipping rows) the oldest pending readback slot into an image, and release the slot.
+		GError ReadbackPop(GPixelMap& Output, GUInt32& FrameID);
+		//! Hand all ready (or all, if Wait is G_TRUE) pending readbacks to the screenshot callback.
+		GError ReadbackDeliver(const GBool Wait);
+		//! Delete all readback slots, discarding pending screenshots.
+		void DeleteReadbackSlots();
+
+		//! Begin the geometry cache key of a shape, Kind identifies the drawing function.
+		void GeometryKeyBegin(const GDrawStyle& Style, const GUInt32 Kind);
+		//! Append raw bytes to the geometry cache key of the current shape.
+		void GeometryKeyAppend(const void *Data, const GUInt32 Size);
+		//! Append an array of points to the geometry cache key of the current shape.
+		void GeometryKeyAppend(const GDynArray<GPoint2>& Points);
+		//! Append an array of integers to the geometry cache key of the current shape.
+		void GeometryKeyAppend(const GDynArray<GInt32>& Values);
+		//! Append an array of flags to the geometry cache key of the current shape.
+		void GeometryKeyAppend(const GDynArray<GBool>& Flags);
+		/*!
+			Look for the current shape inside the geometry cache, drawing it if found.
+
+			\param Style the style used to draw the shape.
+			\param Store returns G_TRUE if the shape must be stored inside the cache once tessellated.
+			\return G_TRUE if the shape has been drawn from the cache, G_FALSE otherwise.
+		*/
+		GBool DrawCachedGeometry(GDrawStyle& Style, GBool& Store);
+		/*!
+			Store the current shape inside the geometry cache.
+
+			\param Vertices fill triangles followed by stroke triangles.
+			\param FillVerticesCount number of fill vertices.
+			\param Box bounding box of the shape, stroke included.
+			\return the cached slot, NULL if the shape does not fit the memory budget.
+		*/
+		const GOpenGLCacheSlot *StoreGeometry(const GDynArray<GLfloat>& Vertices, const GLsizei FillVerticesCount,
+											  const GAABox2& Box);
+		//! Evict least recently used shapes, until the geometry cache fits the specified amount of bytes.
+		void EvictGeometry(const GUInt32 MaxBytes);
+		//! Get the index of the first geometry cache entry whose hash is not less than the specified one.
+		GUInt32 GeometryIndexLowerBound(const GUInt32 Hash) const;
+
 	protected:
 		//! Delete all user-generated gradients.
 		void DeleteGradients();
@@ -444,7 +800,7 @@ namespace Amanith {
 		//! Return G_TRUE if a depth mask is required to draw Fill/Stroke according to specified Style.
 		GBool NeedDepthMask(const GOpenGLDrawStyle& Style, const GBool Fill) const;
 
-		//! Update the texture used to grab a portion of the framebuffer.
+		//! Update the texture used to grab a portion of the framebuffer, taking it from the pool if needed.
 		void UpdateGrabBuffer(const GUInt32 Width, const GUInt32 Height, GLGrabbedRect& GrabRect);
 
 		GBool SetGLClipEnabled(const GTargetMode Mode, const GClipOperation Operation);
@@ -474,6 +830,18 @@ namespace Amanith {
 							 const GJoinStyle JoinStyle, const GReal MiterLimitMulThickness,
 							 Point2ConstIt PointsBegin, Point2ConstIt PointsEnd,
 							 const GBool Closed, const GReal Thickness, const GReal RoundAuxCoeff);
+		/*!
+			Build the stroke of a closed convex contour, as a single triangle strip.
+
+			The strip is made of (outer, inner) points couples, one couple for each miter corner and two couples
+			for each bevel corner; its coverage is the same of the one drawn by DrawSolidStroke().
+			\return G_FALSE if the contour is not convex or if the inner border of the stroke degenerates (thick
+			strokes on small shapes), in this case DrawSolidStroke() must be used.
+		*/
+		GBool BuildConvexStroke(const GJoinStyle JoinStyle, const GReal MiterLimitMulThickness,
+								const GDynArray<GPoint2>& Points, const GReal Thickness, GDynArray<GPoint2>& Strip) const;
+		// draw a stroke built by BuildConvexStroke()
+		void DrawConvexStroke(const GDynArray<GPoint2>& Strip);
 		// draw dashed stroke
 		void DrawDashedStroke(const GOpenGLDrawStyle& Style,
 							  Point2ConstIt PointsBegin, Point2ConstIt PointsEnd,
@@ -541,8 +909,34 @@ namespace Amanith {
 		void UseStrokeStyle(const GDrawStyle& Style, const GUInt32 PassIndex);
 		void UseFillStyle(const GDrawStyle& Style, const GUInt32 PassIndex);
 		void UpdateDeviation(const GRenderingQuality Quality);
+		//! Calculate gDeviation and gFlateness, according to gBaseDeviation and gShapeScale.
+		void UpdateShapeDeviation();
 
 		void GLDisableShaders();
+
+		// primitives emission, recorded as triangles when gRecordedVertices is not NULL
+		void GLBegin(const GLenum Mode);
+		void GLEnd();
+		inline void GLVertex(const GPoint<GDouble, 2>& Point) {
+			if (!gRecordedVertices)
+				glVertex2dv(Point.Data());
+			else {
+				gRecordedVertices->push_back((GLfloat)Point[G_X]);
+				gRecordedVertices->push_back((GLfloat)Point[G_Y]);
+			}
+		}
+		inline void GLVertex(const GPoint<GFloat, 2>& Point) {
+			if (!gRecordedVertices)
+				glVertex2fv(Point.Data());
+			else {
+				gRecordedVertices->push_back(Point[G_X]);
+				gRecordedVertices->push_back(Point[G_Y]);
+			}
+		}
+		//! Build the buffers of a cache slot, from vertices recorded for fill and stroke.
+		void BuildCacheSlot(GOpenGLCacheSlot& Slot, const GDynArray<GLfloat>& Vertices, const GLsizei FillVerticesCount);
+		//! Draw fill (Fill = G_TRUE) or stroke triangles of a cache slot.
+		static void DrawGLCacheSlot(const GOpenGLCacheSlot& Slot, const GBool Fill);
 		/*
 			Get if caching is enabled (G_TRUE value) or disabled (G_FALSE value).
 		*/
@@ -657,12 +1051,28 @@ namespace Amanith {
 			\param Top the ordinate of the top-right corner of current logical window.
 		*/
 		void DoSetProjection(const GReal Left, const GReal Right, const GReal Bottom, const GReal Top);
+		/*!
+			Set the model-view scale of the shape that is going to be drawn.
+
+			The flattening deviation is divided by the squared scale, so that curves have the same precision
+			on screen whatever the model-view matrix is. While the geometry cache is enabled, the scale is rounded
+			up to quarter octaves.
+		*/
+		void DoSetShapeScale(const GReal Scale);
+		/*!
+			Get the bounds of the region where clip masks permit drawing.
+
+			It is the intersection of the boxes of all the clip masks on the stack.
+		*/
+		GBool DoClipMasksBox(GAABox2& Box) const;
 
 		// draw primitives
 		GInt32 DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool ClosedFill, const GBool ClosedStroke,
-							const GJoinStyle FlattenJoinStyle, const GDynArray<GPoint2>& Points, const GBool Convex);
+							const GJoinStyle FlattenJoinStyle, const GDynArray<GPoint2>& Points, const GBool Convex,
+							const GBool Store = G_FALSE);
 		GInt32 DrawGLPolygons(const GDynArray<GPoint2>& Points, const GDynArray<GInt32>& PointsPerContour,
-							  const GDynArray<GBool>& ClosedStrokes, const GOpenGLDrawStyle& Style);
+							  const GDynArray<GBool>& ClosedStrokes, const GOpenGLDrawStyle& Style,
+							  const GBool Store = G_FALSE);
 
 		/*!
 			Do the effective drawing of a rectangle.
@@ -850,6 +1260,37 @@ namespace Amanith {
 			in the active cache bank, else an error code.
 		*/
 		GInt32 DoDrawPaths(GDrawStyle& Style, const GDynArray<GCurve2D *>& Curves);
+		/*!
+			Do the effective drawing of a (multi)path, specified by SVG path data.
+
+			Path data is flattened directly by GSVGPathParser::Flatten(), using the current deviation, without building
+			any curve object. Inside a BeginPaths() / EndPaths() block the base class implementation is used, so that
+			the path is merged with the current one.
+
+			\param Style the drawstyle to use.
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param AnglesMeasureUnits the system units into which angles are expressed inside path data.
+			\return if caching is enabled (G_CACHE_MODE, G_CLIP_AND_CACHE_MODE and G_COLOR_AND_CACHE_MODE target modes)
+			and a valid cache bank is currently set, it returns the slot index (where the primitive has been inserted)
+			in the active cache bank, else an error code.
+		*/
+		GInt32 DoDrawSVGPaths(GDrawStyle& Style, const GChar8 *Begin, const GChar8 *End,
+							  const GAnglesMeasureUnit AnglesMeasureUnits);
+		/*!
+			Do the effective drawing of a compact path.
+
+			The path is flattened directly by GPathData::Flatten(), using the current deviation. Inside a
+			BeginPaths() / EndPaths() block the base class implementation is used, so that the path is merged with
+			the current one.
+
+			\param Style the drawstyle to use.
+			\param Data the path to draw.
+			\return if caching is enabled (G_CACHE_MODE, G_CLIP_AND_CACHE_MODE and G_COLOR_AND_CACHE_MODE target modes)
+			and a valid cache bank is currently set, it returns the slot index (where the primitive has been inserted)
+			in the active cache bank, else an error code.
+		*/
+		GInt32 DoDrawPathData(GDrawStyle& Style, const GPathData& Data);
 		/*!
 			Draw a single cache slot, using specified style.
 
@@ -944,8 +1385,8 @@ namespace Amanith {
 		*/
 		inline void SetCustomRenderingQuality(const GReal Deviation) {
 			if (Deviation > 0) {
-				gDeviation = Deviation;
-				gFlateness = GMath::Sqrt(gDeviation);
+				gBaseDeviation = Deviation;
+				UpdateShapeDeviation();
 			}
 			else {
 				G_DEBUG("SetCustomRenderingQuality: Deviation parameter is negative");
@@ -1038,6 +1479,134 @@ namespace Amanith {
 			Set current cache bank, a NULL value is valid.
 		*/
 		void SetCacheBank(GCacheBank *Bank);
+		/*!
+			Start an asynchronous screenshot.
+
+			The read of the framebuffer is queued into a ring of pixel pack buffers, so that it can go on while
+			next frames are drawn; grabbed images are then retrieved calling PollScreenShot(), or handed to the
+			screenshot callback (see SetScreenShotCallback()) as soon as they are ready.\n
+			If the ring is full, the oldest screenshot is handed to the callback first (waiting for it, if
+			needed); without a callback, instead, the function fails and the oldest screenshot must be polled.
+
+			\param P0 a corner of the rectangle portion to grab.
+			\param P1 the opposite (to P0) corner of the rectangle.
+			\param FrameID returns the identifier of the queued screenshot.
+			\return G_NO_ERROR if the operation succeeds, G_OUT_OF_RANGE if the ring is full and no callback
+			has been set, else an error code.
+			\note if pixel buffer objects are not supported, the framebuffer is read immediately.
+		*/
+		GError ScreenShotAsync(const GVectBase<GUInt32, 2>& P0, const GVectBase<GUInt32, 2>& P1, GUInt32& FrameID);
+		/*!
+			Start an asynchronous screenshot of the whole viewport, see ScreenShotAsync().
+		*/
+		inline GError ScreenShotAsync(GUInt32& FrameID) {
+			return ScreenShotAsync(GPoint<GUInt32, 2>(gViewport[G_X], gViewport[G_Y]),
+								   GVectBase<GUInt32, 2>(gViewport[G_X] + gViewport[G_Z] - 1, gViewport[G_Y] + gViewport[G_W] - 1),
+								   FrameID);
+		}
+		/*!
+			Retrieve the oldest pending asynchronous screenshot.
+
+			\param Output the output image, where the grabbed portion will be copied into.
+			\param FrameID returns the identifier of the retrieved screenshot.
+			\param Wait if G_TRUE the function waits for the oldest screenshot to be completed, else it returns
+			immediately if the screenshot is not ready yet.
+			\return G_TRUE if a screenshot has been retrieved, G_FALSE otherwise.
+		*/
+		GBool PollScreenShot(GPixelMap& Output, GUInt32& FrameID, const GBool Wait = G_FALSE);
+		/*!
+			Wait for all pending asynchronous screenshots, handing them to the screenshot callback.
+
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_OPERATION if no callback has been set.
+		*/
+		GError FlushScreenShots();
+		/*!
+			Set the callback that receives completed asynchronous screenshots, a NULL value is valid.
+
+			Completed screenshots are handed to the callback (in the same order they were issued) from inside
+			ScreenShotAsync() and FlushScreenShots().
+		*/
+		void SetScreenShotCallback(GScreenShotCallback Callback, void *UserData = NULL);
+		/*!
+			Set the number of pixel pack buffers used by asynchronous screenshots (3 as default).
+
+			\param Count the ring size, it must be at least 2.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_OPERATION if some screenshots are still
+			pending, G_INVALID_PARAMETER if Count is less than 2.
+		*/
+		GError SetScreenShotBuffersCount(const GUInt32 Count);
+		//! Get the number of pending asynchronous screenshots.
+		inline GUInt32 PendingScreenShots() const {
+			return gReadbackCount;
+		}
+		//! Get framebuffer grab counters of the current frame (a frame starts at every Clear() call).
+		inline const GLGrabStatistics& GrabStatistics() const {
+			return gGrabStats;
+		}
+		//! Get framebuffer grab counters of the last completed frame.
+		inline const GLGrabStatistics& LastFrameGrabStatistics() const {
+			return gLastGrabStats;
+		}
+		/*!
+			Set the maximum number of unused grab textures kept for reuse (4 as default).
+
+			Grab textures have power of two dimensions, so a pooled texture can serve every grab that fits it.
+		*/
+		void SetGrabTexturesPoolSize(const GUInt32 Size);
+		/*!
+			Enable (G_TRUE value) or disable (G_FALSE value) the geometry cache (enabled as default).
+
+			The geometry cache keeps the triangles of fill and stroke inside vertex buffer objects, so that a
+			shape drawn again (an icon, a glyph) skips flattening and tessellation entirely. Shapes are found by
+			a hash of their geometric parameters (or path data), fill rule, stroke parameters and flattening
+			deviation; to keep the number of different deviations low, the model-view scale used to calculate
+			the deviation is rounded up to quarter octaves while the cache is enabled. A shape is cached the
+			second time it is drawn, and least recently used shapes are evicted to stay within the memory budget.
+			Only shapes drawn in G_COLOR_MODE and G_CLIP_MODE target modes are cached; rectangles and lines are
+			never cached, because their tessellation is trivial.
+			\note disabling the cache invalidates it.
+		*/
+		void SetGeometryCacheEnabled(const GBool Enabled);
+		//! Get if the geometry cache is enabled.
+		inline GBool GeometryCacheEnabled() const {
+			return gGeometryCacheEnabled;
+		}
+		/*!
+			Set the memory budget of the geometry cache, in bytes (4 MB as default).
+
+			Least recently used shapes are evicted, if needed, to fit the new budget.
+		*/
+		void SetGeometryCacheBudget(const GUInt32 Bytes);
+		//! Get the memory budget of the geometry cache, in bytes.
+		inline GUInt32 GeometryCacheBudget() const {
+			return gGeometryCacheBudget;
+		}
+		//! Get geometry cache counters.
+		inline const GLGeometryCacheStatistics& GeometryCacheStatistics() const {
+			return gGeometryCacheStats;
+		}
+		//! Reset hits, misses and evictions counters of the geometry cache.
+		void ResetGeometryCacheStatistics();
+		//! Remove all shapes from the geometry cache, freeing associated (video) memory.
+		void InvalidateGeometryCache();
+		/*!
+			Enable (G_TRUE value) or disable (G_FALSE value) scissor clip masks (enabled as default).
+
+			A rectangle drawn in G_CLIP_MODE target mode, with an axis-preserving model-view matrix (no rotations
+			other than multiples of 90 degrees, no skew), is realized through the scissor test instead of being
+			written into the stencil buffer: pushing and popping such a mask costs no drawing at all, and while
+			only scissor masks are on the stack the stencil test stays disabled. Rectangular masks are not realized
+			this way inside groups, when multisample antialiasing is in use (the stencil mask would have
+			antialiased edges) and when the stroke is enabled with round or bevel joins.
+			\note the new setting affects clip masks pushed from now on.
+		*/
+		inline void SetScissorClipMasksEnabled(const GBool Enabled) {
+			gScissorClipMasksEnabled = Enabled;
+		}
+		//! Get if scissor clip masks are enabled.
+		inline GBool ScissorClipMasksEnabled() const {
+			return gScissorClipMasksEnabled;
+		}
 		/*!
 			Convert a color from a string format to its numerical representation (where each component is in
 			the range [0; 1]. Implementation supports color in these forms:\n\n
@@ -0,0 +1,142 @@
+/****************************************************************************
+** $file: amanith/rendering/gpixelcompositor.h   0.3.0.0   edited Jan, 30 2006
+**
+** Software (CPU) compositing on premultiplied ARGB pixels.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GPIXELCOMPOSITOR_H
+#define GPIXELCOMPOSITOR_H
+
+#include "amanith/rendering/gdrawstyle.h"
+
+/*!
+	\file gpixelcompositor.h
+	\brief Header file for GPixelCompositor class.
+*/
+namespace Amanith {
+
+	/*!
+		Span compositing function type, see GPixelCompositor::SpanFunction.
+
+		\param Src source premultiplied ARGB pixels.
+		\param Dst destination premultiplied ARGB pixels, they will be overwritten by the result.
+		\param Count number of pixels to composite.
+		\param Opacity a constant coverage value, in the range [0; 255].
+		\param Mask an optional per-pixel coverage (8 bits each); it can be NULL.
+	*/
+	typedef void (*GCompositingSpanFunction)(const GUInt32 *Src, GUInt32 *Dst, const GUInt32 Count,
+											 const GUInt32 Opacity, const GUChar8 *Mask);
+
+	// *********************************************************************
+	//                           GPixelCompositor
+	// *********************************************************************
+
+	/*!
+		\class GPixelCompositor
+		\brief Software implementation of every GCompositingOperation.
+
+		All operations work on premultiplied ARGB32 spans, and follow the SVG 1.2 compositing formulas; that
+		is the same math realized by GOpenGLBoard through fragment programs, but here every operation is done
+		in a single pass over the destination pixels, without any framebuffer grab.\n
+		Opacity and mask values act as coverage: for every pixel the result is
+		Dst = Dst + (CompOp(Src, Dst) - Dst) * Opacity * Mask, so a 0 coverage always leaves the destination
+		untouched (for unbounded operations like G_CLEAR_OP and G_SRC_IN_OP too).\n
+		Where available (SSE2), Porter-Duff operations and the simplest extended operations (plus, multiply,
+		screen, darken, lighten, difference and exclusion) are vectorized; the remaining ones are computed
+		one pixel at a time.
+	*/
+	class G_EXPORT GPixelCompositor {
+
+	public:
+		/*!
+			Get the span compositing function relative to the specified operation.
+
+			The returned function can be called directly inside inner loops, avoiding any per-span dispatch.
+		*/
+		static GCompositingSpanFunction SpanFunction(const GCompositingOperation CompOp);
+		/*!
+			Composite a span of pixels.
+
+			\param CompOp the compositing operation.
+			\param Src source premultiplied ARGB pixels.
+			\param Dst destination premultiplied ARGB pixels, they will be overwritten by the result.
+			\param Count number of pixels to composite.
+			\param Opacity a constant coverage value, in the range [0; 255].
+			\param Mask an optional per-pixel coverage (8 bits each).
+		*/
+		static void CompositeSpan(const GCompositingOperation CompOp, const GUInt32 *Src, GUInt32 *Dst,
+								  const GUInt32 Count, const GUInt32 Opacity = 255, const GUChar8 *Mask = NULL);
+		/*!
+			Composite a constant color over a span of pixels.
+
+			\param CompOp the compositing operation.
+			\param SrcColor the source premultiplied ARGB color.
+			\param Dst destination premultiplied ARGB pixels, they will be overwritten by the result.
+			\param Count number of pixels to composite.
+			\param Opacity a constant coverage value, in the range [0; 255].
+			\param Mask an optional per-pixel coverage (8 bits each).
+		*/
+		static void CompositeSpan(const GCompositingOperation CompOp, const GUInt32 SrcColor, GUInt32 *Dst,
+								  const GUInt32 Count, const GUInt32 Opacity = 255, const GUChar8 *Mask = NULL);
+		/*!
+			Composite an image over another one.
+
+			\param CompOp the compositing operation.
+			\param Src the source image, it must be a 32 bits per pixel image containing premultiplied colors.
+			\param Dst the destination image, it must be a 32 bits per pixel image containing premultiplied colors.
+			\param DstX horizontal position, in destination, of the source upper-left corner.
+			\param DstY vertical position, in destination, of the source upper-left corner.
+			\param Opacity a constant coverage value, in the range [0; 255].
+			\param Mask an optional grayscale image, with the same dimensions of Src, containing per-pixel coverage.
+			\return G_NO_ERROR if operation succeeds, an error code otherwise.
+			\note G_R8G8B8 images are considered opaque, whatever their alpha byte is. Source pixels falling outside
+			the destination image are simply clipped out.
+		*/
+		static GError Composite(const GCompositingOperation CompOp, const GPixelMap& Src, GPixelMap& Dst,
+								const GInt32 DstX = 0, const GInt32 DstY = 0, const GUInt32 Opacity = 255,
+								const GPixelMap *Mask = NULL);
+		//! Convert a span of non-premultiplied ARGB pixels into premultiplied ones (in place).
+		static void Premultiply(GUInt32 *Pixels, const GUInt32 Count);
+		//! Convert a span of premultiplied ARGB pixels into non-premultiplied ones (in place).
+		static void Unpremultiply(GUInt32 *Pixels, const GUInt32 Count);
+		/*!
+			Convert a non-premultiplied image into a premultiplied one (in place).
+
+			\return G_NO_ERROR if operation succeeds, G_INVALID_OPERATION if the image is not an
+			G_A8R8G8B8 one.
+		*/
+		static GError Premultiply(GPixelMap& Image);
+		/*!
+			Convert a premultiplied image into a non-premultiplied one (in place).
+
+			\return G_NO_ERROR if operation succeeds, G_INVALID_OPERATION if the image is not an
+			G_A8R8G8B8 one.
+		*/
+		static GError Unpremultiply(GPixelMap& Image);
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -0,0 +1,202 @@
+/****************************************************************************
+** $file: amanith/rendering/gspangenerator.h   0.3.0.0   edited Jan, 30 2006
+**
+** Software (CPU) paint span generators.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GSPANGENERATOR_H
+#define GSPANGENERATOR_H
+
+#include "amanith/rendering/gcolorramp.h"
+
+/*!
+	\file gspangenerator.h
+	\brief Header file for GSpanGenerator, GGradientSpanGenerator and GPatternSpanGenerator classes.
+*/
+namespace Amanith {
+
+	// *********************************************************************
+	//                            GSpanGenerator
+	// *********************************************************************
+
+	/*!
+		\class GSpanGenerator
+		\brief Base class for software paint span generators.
+
+		A span generator produces the premultiplied ARGB32 colors of a paint (gradient or pattern) along a
+		horizontal run of device pixels; its output can be passed directly to GPixelCompositor::CompositeSpan().\n
+		Paints are always sampled at pixel centers, that is the device point (X + 0.5, Y + 0.5) for the pixel (X, Y).
+		Once set up, a generator is never modified by Generate(), so a single instance can feed several threads.
+	*/
+	class G_EXPORT GSpanGenerator {
+
+	public:
+		//! Constructor.
+		GSpanGenerator();
+		//! Destructor.
+		virtual ~GSpanGenerator();
+		/*!
+			Generate a span of paint colors.
+
+			\param X horizontal device coordinate of the first pixel.
+			\param Y vertical device coordinate of the span.
+			\param Dst output premultiplied ARGB pixels, it must be able to contain Count pixels.
+			\param Count number of pixels to generate.
+		*/
+		virtual void Generate(const GInt32 X, const GInt32 Y, GUInt32 *Dst, const GUInt32 Count) const = 0;
+		/*!
+			Fill a whole image with paint colors, one span per row.
+
+			\param Image destination image, it must be a G_A8R8G8B8 one.
+			\param X horizontal device coordinate of the image upper-left corner.
+			\param Y vertical device coordinate of the image upper-left corner.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_PARAMETER if the image is not a G_A8R8G8B8 one.
+		*/
+		GError Fill(GPixelMap& Image, const GInt32 X = 0, const GInt32 Y = 0) const;
+	};
+
+	// *********************************************************************
+	//                        GGradientSpanGenerator
+	// *********************************************************************
+
+	/*!
+		\class GGradientSpanGenerator
+		\brief Span generator for linear, radial (with focus) and conical gradients.
+
+		The generator follows the same gradient parameterization used by the OpenGL board shaders, so that
+		software and hardware paths produce the same pictures. Colors are read from a premultiplied GColorRamp
+		built from the gradient keys.\n
+		Linear gradients are realized by stepping the ramp parameter incrementally along the span; radial and
+		conical ones evaluate their parameter four pixels at once where SSE2 is available.
+	*/
+	class G_EXPORT GGradientSpanGenerator : public GSpanGenerator {
+
+	private:
+		//! Gradient type.
+		GGradientType gType;
+		//! Premultiplied color ramp, built with the gradient spread mode.
+		GColorRamp gRamp;
+		/*!
+			Device to gradient space matrix: for linear gradients the first row gives the ramp parameter, for
+			radial gradients it maps into a focus-centered space, for conical gradients into a center-centered
+			space rotated by the gradient direction.
+		*/
+		GMatrix33 gPaintMatrix;
+		//! Radial gradients only, (focus - center) vector.
+		GReal gFocusCenter[2];
+		//! Radial gradients only, (focus - center).LengthSquared - radius^2 (always negative).
+		GReal gQCoef;
+
+		// generate ramp parameters of radial gradients
+		void RadialParameters(const GReal X, const GReal Y, GFloat *U, const GUInt32 Count) const;
+		// generate ramp parameters of conical gradients
+		void ConicalParameters(const GReal X, const GReal Y, GFloat *U, const GUInt32 Count) const;
+		// get ramp colors corresponding to the specified parameters, applying the spread mode
+		void RampColors(const GFloat *U, GUInt32 *Dst, const GUInt32 Count, const GBool Pad) const;
+
+	public:
+		//! Constructor, it builds an empty (transparent) generator.
+		GGradientSpanGenerator();
+		/*!
+			Set up the generator.
+
+			\param Gradient the gradient to render.
+			\param DeviceToLogical the matrix that maps device coordinates into logical coordinates.
+			\param RampSize number of color ramp entries, it must be at least 2.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note for radial gradients, a focus placed outside the circle is moved onto the center, like
+			OpenGL board does.
+		*/
+		GError SetGradient(const GGradientDesc& Gradient, const GMatrix33& DeviceToLogical,
+						   const GUInt32 RampSize = 1024);
+		//! Get the color ramp used by this generator.
+		inline const GColorRamp& Ramp() const {
+			return gRamp;
+		}
+		//! Generate a span of gradient colors, see GSpanGenerator::Generate().
+		void Generate(const GInt32 X, const GInt32 Y, GUInt32 *Dst, const GUInt32 Count) const;
+	};
+
+	/*!
+		Pattern span sampling function type, used internally by GPatternSpanGenerator.
+
+		\param Image premultiplied ARGB32 image.
+		\param S0 16.16 fixed point horizontal texel coordinate of the first pixel.
+		\param T0 16.16 fixed point vertical texel coordinate of the first pixel.
+		\param DeltaS horizontal texel coordinate increment, per pixel.
+		\param DeltaT vertical texel coordinate increment, per pixel.
+		\param Dst output premultiplied ARGB pixels.
+		\param Count number of pixels to generate.
+	*/
+	typedef void (*GPatternSpanFunction)(const GPixelMap& Image, const GInt64 S0, const GInt64 T0,
+										 const GInt64 DeltaS, const GInt64 DeltaT, GUInt32 *Dst, const GUInt32 Count);
+
+	// *********************************************************************
+	//                        GPatternSpanGenerator
+	// *********************************************************************
+
+	/*!
+		\class GPatternSpanGenerator
+		\brief Span generator for image patterns.
+
+		The pattern image is mapped onto the pattern logical window, then transformed by the pattern matrix,
+		like OpenGL board does; outside the window the image is repeated according to the pattern tiling
+		mode.\n
+		Sampling depends on image quality: G_LOW_IMAGE_QUALITY takes the nearest texel, G_NORMAL_IMAGE_QUALITY
+		interpolates bilinearly and G_HIGH_IMAGE_QUALITY uses a bicubic (Catmull-Rom) filter. Texel coordinates
+		are stepped incrementally in fixed point along the span.
+	*/
+	class G_EXPORT GPatternSpanGenerator : public GSpanGenerator {
+
+	private:
+		//! Premultiplied copy of the pattern image.
+		GPixelMap gImage;
+		//! Device to texel space matrix (texel centers lie on integer coordinates).
+		GMatrix33 gTexelMatrix;
+		//! Sampling function, selected by tiling mode and image quality.
+		GPatternSpanFunction gSpanFunction;
+
+	public:
+		//! Constructor, it builds an empty (transparent) generator.
+		GPatternSpanGenerator();
+		/*!
+			Set up the generator.
+
+			\param Pattern the pattern to render; its matrix, logical window and tiling mode are used.
+			\param Image the pattern image; G_A8R8G8B8 images are intended as non-premultiplied, G_R8G8B8 ones
+			as opaque, other formats are converted to G_A8R8G8B8.
+			\param Quality sampling quality.
+			\param DeviceToLogical the matrix that maps device coordinates into logical coordinates.
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+		*/
+		GError SetPattern(const GPatternDesc& Pattern, const GPixelMap& Image, const GImageQuality Quality,
+						  const GMatrix33& DeviceToLogical);
+		//! Generate a span of pattern colors, see GSpanGenerator::Generate().
+		void Generate(const GInt32 X, const GInt32 Y, GUInt32 *Dst, const GUInt32 Count) const;
+	};
+
+};	// end namespace Amanith
+
+#endif
@@ -0,0 +1,188 @@
+/****************************************************************************
+** $file: amanith/support/gsvgpathparser.h   0.3.0.0   edited Jan, 30 2006
+**
+** SVG path data parser definition.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GSVGPATHPARSER_H
+#define GSVGPATHPARSER_H
+
+#include "amanith/2d/gpathdata.h"
+
+/*!
+	\file gsvgpathparser.h
+	\brief Header file for SVG path data parser.
+*/
+namespace Amanith {
+
+	// *********************************************************************
+	//                             GSVGPathSink
+	// *********************************************************************
+
+	/*!
+		\class GSVGPathSink
+		\brief Receiver of the commands produced by GSVGPathParser.
+
+		Commands are normalized: all coordinates are absolute, horizontal and vertical lines are given as lines,
+		smooth curves are given with their reflected control point. Every sub-path starts with a MoveTo() call.
+	*/
+	class G_EXPORT GSVGPathSink {
+
+	public:
+		//! Destructor.
+		virtual ~GSVGPathSink() {
+		}
+		//! Begin a new sub-path at the specified point.
+		virtual void MoveTo(const GPoint2& P) = 0;
+		//! Line from the current point to P.
+		virtual void LineTo(const GPoint2& P) = 0;
+		//! Quadratic Bezier curve from the current point to P, with control point P1.
+		virtual void QuadraticTo(const GPoint2& P1, const GPoint2& P) = 0;
+		//! Cubic Bezier curve from the current point to P, with control points P1 and P2.
+		virtual void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) = 0;
+		/*!
+			Elliptical arc from the current point to P.
+
+			\param Rx x semi-axis length, always greater than 0.
+			\param Ry y semi-axis length, always greater than 0.
+			\param XRot x-axis rotation, in radians.
+			\param LargeArc SVG large arc flag.
+			\param Sweep SVG sweep flag (G_TRUE means positive angles direction).
+			\param P arc end point, always different from the current point.
+			\note radii can be too small to join the arc ends, in this case they must be scaled up as SVG
+			specifications say.
+		*/
+		virtual void ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+						   const GPoint2& P) = 0;
+		//! Close the current sub-path.
+		virtual void ClosePath() = 0;
+	};
+
+	// *********************************************************************
+	//                            GSVGPathParser
+	// *********************************************************************
+
+	/*!
+		\class GSVGPathParser
+		\brief A fast parser for SVG path data (the 'd' attribute of the SVG path element).
+
+		The parser works on a range of characters in place: nothing is copied, numbers are read by an internal lexer
+		that does not depend on the current locale, and no memory is allocated apart from the output arrays.\n
+		Parsing follows SVG specifications: in case of error, everything parsed before the error is kept, and
+		G_INVALID_FORMAT is returned.
+	*/
+	class G_EXPORT GSVGPathParser {
+
+	public:
+		/*!
+			Read a real number, in the SVG (and C) format.
+
+			\param Begin pointer to the first character of the number.
+			\param End pointer past the last available character.
+			\param Value the output number.
+			\return a pointer past the last character of the number, or Begin if no number has been found.
+			\note numbers made of up to 15 significant digits, with a decimal exponent not greater than 22 (in
+			absolute value), are converted exactly; other numbers can be off by one unit in the last place.
+		*/
+		static const GChar8 *ParseReal(const GChar8 *Begin, const GChar8 *End, GReal& Value);
+		/*!
+			Parse path data, sending normalized commands to a sink.
+
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param Sink the receiver of normalized commands.
+			\param AnglesMeasureUnit the units used by arcs rotation angles.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_FORMAT if the path data is malformed.
+		*/
+		static GError Parse(const GChar8 *Begin, const GChar8 *End, GSVGPathSink& Sink,
+							const GAnglesMeasureUnit AnglesMeasureUnit = G_DEGREE_UNIT);
+		/*!
+			Parse path data into a compact buffer of commands and coordinates.
+
+			Every command is one of the characters 'M', 'L', 'Q', 'C', 'A', 'Z', and it takes respectively 2, 2, 4,
+			6, 7 and 0 coordinates, all absolute. Arcs coordinates are x semi-axis, y semi-axis, x-axis rotation (in
+			radians), large arc flag (0 or 1), sweep flag (0 or 1), end point x and y. New data is appended to the
+			output arrays.
+
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param Commands output commands.
+			\param Coordinates output coordinates.
+			\param AnglesMeasureUnit the units used by arcs rotation angles.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_FORMAT if the path data is malformed.
+		*/
+		static GError ParseCommands(const GChar8 *Begin, const GChar8 *End, GDynArray<GChar8>& Commands,
+									GDynArray<GReal>& Coordinates,
+									const GAnglesMeasureUnit AnglesMeasureUnit = G_DEGREE_UNIT);
+		/*!
+			Parse path data into a compact path.
+
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param Data output path data, new contours are appended.
+			\param AnglesMeasureUnit the units used by arcs rotation angles.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_FORMAT if the path data is malformed.
+		*/
+		static GError ParsePathData(const GChar8 *Begin, const GChar8 *End, GPathData& Data,
+									const GAnglesMeasureUnit AnglesMeasureUnit = G_DEGREE_UNIT);
+		/*!
+			Parse path data into paths, one for each sub-path.
+
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param Kernel the kernel used to create paths.
+			\param Paths output paths, new paths are appended. The caller is responsible to delete them.
+			\param AnglesMeasureUnit the units used by arcs rotation angles.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_FORMAT if the path data is malformed, another
+			error code if paths could not be created.
+			\note consecutive lines are joined into a single polyline segment.
+		*/
+		static GError ParsePaths(const GChar8 *Begin, const GChar8 *End, GKernel& Kernel, GDynArray<GPath2D *>& Paths,
+								 const GAnglesMeasureUnit AnglesMeasureUnit = G_DEGREE_UNIT);
+		/*!
+			Parse path data into flattened contours, no curve object is built.
+
+			\param Begin pointer to the first character of path data.
+			\param End pointer past the last character of path data.
+			\param MaxDeviation maximum squared chordal distance allowed between curves and their flattened version;
+			it must be positive.
+			\param Points output points, new points are appended.
+			\param PointsPerContour for each output contour, the number of its points.
+			\param ClosedContours for each output contour, G_TRUE if it has been closed. Closed contours don't repeat
+			their first point at the end.
+			\param AnglesMeasureUnit the units used by arcs rotation angles.
+			\return G_NO_ERROR if the operation succeeds, G_INVALID_PARAMETER if MaxDeviation is not positive,
+			G_INVALID_FORMAT if the path data is malformed.
+			\note sub-paths made of a single point are discarded.
+		*/
+		static GError Flatten(const GChar8 *Begin, const GChar8 *End, const GReal MaxDeviation,
+							  GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+							  GDynArray<GBool>& ClosedContours,
+							  const GAnglesMeasureUnit AnglesMeasureUnit = G_DEGREE_UNIT);
+	};
+
+};	// end namespace Amanith
+
+#endif
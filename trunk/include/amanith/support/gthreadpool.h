@@ -0,0 +1,107 @@
+/****************************************************************************
+** $file: amanith/support/gthreadpool.h   0.3.0.0   edited Jan, 30 2006
+**
+** Thread pool definition.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GTHREADPOOL_H
+#define GTHREADPOOL_H
+
+#include "amanith/gglobal.h"
+#include "amanith/gerror.h"
+
+/*!
+	\file gthreadpool.h
+	\brief Header file for GThreadPool class.
+*/
+namespace Amanith {
+
+	/*!
+		Job function type, used by GThreadPool::Run.
+
+		\param Data the custom data pointer passed to GThreadPool::Run.
+		\param JobIndex the index of the job to execute, in the range [0; JobsCount - 1].
+	*/
+	typedef void (*GJobFunction)(void *Data, const GUInt32 JobIndex);
+
+	// *********************************************************************
+	//                             GThreadPool
+	// *********************************************************************
+
+	/*!
+		\class GThreadPool
+		\brief A simple cross-platform pool of worker threads.
+
+		Worker threads are created once, at construction time, and they sleep until a new set of jobs is submitted
+		through the Run() method. The calling thread takes part in jobs execution too, so a pool built with a
+		single thread executes everything in the caller context, without any synchronization overhead.\n
+		Jobs are picked in ascending index order, but they can be completed in any order; so each job must write
+		its results in its own slot, if a deterministic output is desired.
+	*/
+	class G_EXPORT GThreadPool {
+
+	private:
+		//! Platform-specific threads and synchronization objects.
+		void *gPrivate;
+		//! Number of threads (calling thread included).
+		GUInt32 gThreadsCount;
+
+		// disable copy
+		GThreadPool(const GThreadPool& Source);
+		GThreadPool& operator =(const GThreadPool& Source);
+
+	public:
+		/*!
+			Constructor.
+
+			\param ThreadsCount the number of threads that will execute jobs, calling thread included. A 0 value
+			means 'use as many threads as the available processors'.
+		*/
+		GThreadPool(const GUInt32 ThreadsCount = 0);
+		//! Destructor, it waits for all worker threads termination.
+		~GThreadPool();
+		//! Get the number of threads (calling thread included) used to execute jobs.
+		inline GUInt32 ThreadsCount() const {
+			return gThreadsCount;
+		}
+		/*!
+			Execute a set of jobs, and wait until all of them have been completed.
+
+			\param Function the function to call for every job.
+			\param Data a custom data pointer, passed to every Function call.
+			\param JobsCount the number of jobs to execute. Function will be called exactly one time for each
+			index in the range [0; JobsCount - 1].
+			\return G_NO_ERROR if the operation succeeds, an error code otherwise.
+			\note This method is not reentrant: it must not be called by a job function, nor concurrently by
+			different threads on the same pool.
+		*/
+		GError Run(const GJobFunction Function, void *Data, const GUInt32 JobsCount);
+		//! Get the number of available processors.
+		static GUInt32 ProcessorsCount();
+	};
+
+};	// end namespace Amanith
+
+#endif
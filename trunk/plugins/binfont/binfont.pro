@@ -0,0 +1,15 @@
+include(../../config/useamanith.conf)
+include(./build.conf)
+
+TARGET = binfontimpexp
+
+TEMPLATE = lib
+
+CONFIG += dll
+
+DESTDIR = $$(AMANITHDIR)/plugins
+
+DEFINES += G_MAKE_PLUGIN
+
+SOURCES = gbinfontimpexp.cpp
+
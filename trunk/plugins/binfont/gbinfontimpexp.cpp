@@ -0,0 +1,703 @@
+/****************************************************************************
+** $file: amanith/plugins/binfont/gbinfontimpexp.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** 2D font binary format import/export plugin implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifdef _BINFONT_PLUGIN
+
+#include "gbinfontimpexp.h"
+#include "amanith/support/gutilities.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace Amanith {
+
+// *********************************************************************
+//                          Binary font records
+// *********************************************************************
+
+#define G_BINFONT_VERSION 1
+#define G_BINFONT_BYTE_ORDER 0x01020304
+
+// file header; all records have a size multiple of 8 bytes, so every section is aligned
+struct GBinFontHeader {
+	GChar8 Magic[4];
+	GUInt32 Version;
+	GUInt32 ByteOrder;
+	GUInt32 FileSize;
+	// bit 0 italic, bit 1 bold
+	GUInt32 StyleFlags;
+	GUInt32 UnitsPerEM;
+	GDouble Ascender;
+	GDouble Descender;
+	GDouble ExternalLeading;
+	GDouble MaxAdvanceWidth;
+	GDouble MaxAdvanceHeight;
+	GDouble UnderlinePosition;
+	GDouble UnderlineThickness;
+	GUInt32 FamilyNameOffset;
+	GUInt32 FamilyNameLength;
+	GUInt32 StyleNameOffset;
+	GUInt32 StyleNameLength;
+	GUInt32 CharsCount;
+	GUInt32 CharsOffset;
+	GUInt32 ContoursCount;
+	GUInt32 ContoursOffset;
+	GUInt32 PointsCount;
+	GUInt32 PointsOffset;
+	GUInt32 FlagsOffset;
+	GUInt32 SubCharsCount;
+	GUInt32 SubCharsOffset;
+	GUInt32 CharMapsCount;
+	GUInt32 CharMapsOffset;
+	GUInt32 EncodedCharsCount;
+	GUInt32 EncodedCharsOffset;
+	GUInt32 KerningCount;
+	GUInt32 KerningOffset;
+	GUInt32 Reserved;
+};
+
+struct GBinFontChar {
+	// width, height, hori bearing x and y, hori advance, vert bearing x and y, vert advance
+	GDouble Metrics[8];
+	GDouble LinearHoriAdvance;
+	GDouble LinearVertAdvance;
+	GDouble Advance[2];
+	GDouble LSBDelta;
+	GDouble RSBDelta;
+	GUInt32 FirstContour;
+	GUInt32 ContoursCount;
+	GUInt32 FirstSubChar;
+	GUInt32 SubCharsCount;
+	// bit 0 even-odd fill
+	GUInt32 Flags;
+	GUInt32 Reserved;
+};
+
+struct GBinFontContour {
+	GUInt32 FirstPoint;
+	GUInt32 PointsCount;
+	GUInt32 IsHole;
+	GUInt32 Reserved;
+};
+
+struct GBinFontSubChar {
+	GInt32 GlyphIndex;
+	GInt32 Flags;
+	// row major
+	GDouble Transformation[9];
+};
+
+struct GBinFontCharMap {
+	GUInt32 PlatformID;
+	GUInt32 EncodingID;
+	GUInt32 Encoding;
+	GUInt32 FirstEncodedChar;
+	GUInt32 EncodedCharsCount;
+	GUInt32 Reserved;
+};
+
+// this record has the same layout of GEncodedChar
+struct GBinFontEncodedChar {
+	GUInt32 CharCode;
+	GUInt32 GlyphIndex;
+};
+
+struct GBinFontKerning {
+	GUInt32 GlyphIndexLeft;
+	GUInt32 GlyphIndexRight;
+	GDouble Kerning[2];
+};
+
+// *********************************************************************
+//                            GBinFontFileMap
+// *********************************************************************
+
+// read-only memory mapping of a whole file
+class GBinFontFileMap {
+
+private:
+	const GUChar8 *gData;
+	GUInt32 gSize;
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	HANDLE gFile;
+	HANDLE gMapping;
+#else
+	GInt32 gFile;
+#endif
+
+public:
+	// constructor
+	GBinFontFileMap() : gData(NULL), gSize(0) {
+	#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+		gFile = INVALID_HANDLE_VALUE;
+		gMapping = NULL;
+	#else
+		gFile = -1;
+	#endif
+	}
+	// destructor
+	~GBinFontFileMap() {
+		Close();
+	}
+	// map the specified file
+	GError Open(const GChar8 *FileName) {
+
+		Close();
+	#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+		gFile = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (gFile == INVALID_HANDLE_VALUE)
+			return G_READ_ERROR;
+		gSize = (GUInt32)GetFileSize(gFile, NULL);
+		if (gSize == 0 || gSize == INVALID_FILE_SIZE) {
+			Close();
+			return G_INVALID_FORMAT;
+		}
+		gMapping = CreateFileMappingA(gFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!gMapping) {
+			Close();
+			return G_READ_ERROR;
+		}
+		gData = (const GUChar8 *)MapViewOfFile(gMapping, FILE_MAP_READ, 0, 0, 0);
+		if (!gData) {
+			Close();
+			return G_READ_ERROR;
+		}
+	#else
+		struct stat st;
+		void *p;
+
+		gFile = open(FileName, O_RDONLY);
+		if (gFile < 0)
+			return G_READ_ERROR;
+		if (fstat(gFile, &st) != 0 || st.st_size <= 0 || (GUInt64)st.st_size > (GUInt64)G_MAX_UINT32) {
+			Close();
+			return G_INVALID_FORMAT;
+		}
+		gSize = (GUInt32)st.st_size;
+		p = mmap(NULL, gSize, PROT_READ, MAP_SHARED, gFile, 0);
+		if (p == MAP_FAILED) {
+			Close();
+			return G_READ_ERROR;
+		}
+		gData = (const GUChar8 *)p;
+	#endif
+		return G_NO_ERROR;
+	}
+	// unmap the file
+	void Close() {
+
+	#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+		if (gData)
+			UnmapViewOfFile((LPCVOID)gData);
+		if (gMapping)
+			CloseHandle(gMapping);
+		if (gFile != INVALID_HANDLE_VALUE)
+			CloseHandle(gFile);
+		gMapping = NULL;
+		gFile = INVALID_HANDLE_VALUE;
+	#else
+		if (gData)
+			munmap((void *)gData, gSize);
+		if (gFile >= 0)
+			close(gFile);
+		gFile = -1;
+	#endif
+		gData = NULL;
+		gSize = 0;
+	}
+	// get mapped data
+	const GUChar8 *Data() const {
+		return gData;
+	}
+	// get mapped size, in bytes
+	GUInt32 Size() const {
+		return gSize;
+	}
+};
+
+// *********************************************************************
+//                              GBinFontImpExp
+// *********************************************************************
+
+// constructor
+GBinFontImpExp::GBinFontImpExp() : GImpExp() {
+
+	AddBinFontFeatures();
+}
+
+// constructor
+GBinFontImpExp::GBinFontImpExp(const GElement* Owner) : GImpExp(Owner) {
+
+	AddBinFontFeatures();
+}
+
+// destructor
+GBinFontImpExp::~GBinFontImpExp() {
+}
+
+void GBinFontImpExp::AddBinFontFeatures() {
+
+#if defined(_BINFONT_READ) && defined(_BINFONT_WRITE)
+	AddEntry(GImpExpFeature(G_FONT2D_CLASSID, "Amanith Binary Font", "abf", 1, 0, 0, 0, G_IMPEXP_READWRITE));
+#elif defined(_BINFONT_READ)
+	AddEntry(GImpExpFeature(G_FONT2D_CLASSID, "Amanith Binary Font", "abf", 1, 0, 0, 0, G_IMPEXP_READ));
+#else
+	AddEntry(GImpExpFeature(G_FONT2D_CLASSID, "Amanith Binary Font", "abf", 1, 0, 0, 0, G_IMPEXP_WRITE));
+#endif
+}
+
+// check that Count records of RecordSize bytes, starting at Offset, lie inside the file
+static GBool SectionInside(const GUInt32 Offset, const GUInt32 Count, const GUInt32 RecordSize, const GUInt32 FileSize) {
+
+	if (Offset > FileSize)
+		return G_FALSE;
+	if (Count > (FileSize - Offset) / RecordSize)
+		return G_FALSE;
+	return G_TRUE;
+}
+
+// check that the range [First; First + Count) lies inside [0; Total)
+static GBool RangeInside(const GUInt32 First, const GUInt32 Count, const GUInt32 Total) {
+
+	return (First <= Total && Count <= Total - First);
+}
+
+// load a binary font file
+GError GBinFontImpExp::ReadBinFont(const GChar8 *FullFileName, GElement& Element) {
+
+	GFont2D& font = (GFont2D&)Element;
+	GBinFontFileMap fileMap;
+	const GUChar8 *data;
+	const GBinFontHeader *header;
+	const GBinFontChar *chars, *ch;
+	const GBinFontContour *contours, *ct;
+	const GDouble *points;
+	const GUChar8 *flags;
+	const GBinFontSubChar *subChars;
+	const GBinFontCharMap *charMaps;
+	const GBinFontEncodedChar *encodedChars;
+	const GBinFontKerning *kerning;
+	GDynArray<GPoint2> tmpPoints;
+	GDynArray<GInt32> tmpFlags;
+	GDynArray<GFontCharContour2D> tmpContours;
+	GDynArray<GSubChar2D> tmpSubChars;
+	GDynArray<GKerningEntry> tmpKerning;
+	GCharMap tmpMap;
+	GGlyphMetrics tmpMetrics;
+	GFontChar2D *c;
+	GUInt32 i, j, k, w, size;
+	GError err;
+
+	err = fileMap.Open(FullFileName);
+	if (err != G_NO_ERROR)
+		return err;
+	data = fileMap.Data();
+	size = fileMap.Size();
+
+	// validate header and sections, nothing is read outside the mapped file
+	if (size < sizeof(GBinFontHeader))
+		return G_INVALID_FORMAT;
+	header = (const GBinFontHeader *)data;
+	if (std::memcmp(header->Magic, "ABF1", 4) != 0 || header->Version != G_BINFONT_VERSION ||
+		header->ByteOrder != G_BINFONT_BYTE_ORDER || header->FileSize != size)
+		return G_INVALID_FORMAT;
+	if (!SectionInside(header->FamilyNameOffset, header->FamilyNameLength, 1, size) ||
+		!SectionInside(header->StyleNameOffset, header->StyleNameLength, 1, size) ||
+		!SectionInside(header->CharsOffset, header->CharsCount, sizeof(GBinFontChar), size) ||
+		!SectionInside(header->ContoursOffset, header->ContoursCount, sizeof(GBinFontContour), size) ||
+		!SectionInside(header->PointsOffset, header->PointsCount, 2 * sizeof(GDouble), size) ||
+		!SectionInside(header->FlagsOffset, header->PointsCount, 1, size) ||
+		!SectionInside(header->SubCharsOffset, header->SubCharsCount, sizeof(GBinFontSubChar), size) ||
+		!SectionInside(header->CharMapsOffset, header->CharMapsCount, sizeof(GBinFontCharMap), size) ||
+		!SectionInside(header->EncodedCharsOffset, header->EncodedCharsCount, sizeof(GBinFontEncodedChar), size) ||
+		!SectionInside(header->KerningOffset, header->KerningCount, sizeof(GBinFontKerning), size))
+		return G_INVALID_FORMAT;
+	// records are read in place, so they must be aligned
+	if (((header->CharsOffset | header->ContoursOffset | header->PointsOffset | header->SubCharsOffset |
+		  header->CharMapsOffset | header->EncodedCharsOffset | header->KerningOffset) & 7) != 0)
+		return G_INVALID_FORMAT;
+
+	chars = (const GBinFontChar *)(data + header->CharsOffset);
+	contours = (const GBinFontContour *)(data + header->ContoursOffset);
+	points = (const GDouble *)(data + header->PointsOffset);
+	flags = data + header->FlagsOffset;
+	subChars = (const GBinFontSubChar *)(data + header->SubCharsOffset);
+	charMaps = (const GBinFontCharMap *)(data + header->CharMapsOffset);
+	encodedChars = (const GBinFontEncodedChar *)(data + header->EncodedCharsOffset);
+	kerning = (const GBinFontKerning *)(data + header->KerningOffset);
+
+	// validate references between sections
+	for (i = 0; i < header->CharsCount; ++i) {
+		if (!RangeInside(chars[i].FirstContour, chars[i].ContoursCount, header->ContoursCount) ||
+			!RangeInside(chars[i].FirstSubChar, chars[i].SubCharsCount, header->SubCharsCount))
+			return G_INVALID_FORMAT;
+	}
+	for (i = 0; i < header->ContoursCount; ++i) {
+		if (!RangeInside(contours[i].FirstPoint, contours[i].PointsCount, header->PointsCount))
+			return G_INVALID_FORMAT;
+	}
+	for (i = 0; i < header->CharMapsCount; ++i) {
+		if (!RangeInside(charMaps[i].FirstEncodedChar, charMaps[i].EncodedCharsCount, header->EncodedCharsCount))
+			return G_INVALID_FORMAT;
+	}
+
+	// font informations
+	font.Clear();
+	font.SetFamilyName(GString((const GChar8 *)data + header->FamilyNameOffset, header->FamilyNameLength));
+	font.SetStyleName(GString((const GChar8 *)data + header->StyleNameOffset, header->StyleNameLength));
+	font.SetUnitsPerEM(header->UnitsPerEM);
+	font.SetItalic((header->StyleFlags & 1) != 0);
+	font.SetBold((header->StyleFlags & 2) != 0);
+	font.SetAscender((GReal)header->Ascender);
+	font.SetDescender((GReal)header->Descender);
+	font.SetExternalLeading((GReal)header->ExternalLeading);
+	font.SetMaxAdvanceWidth((GReal)header->MaxAdvanceWidth);
+	font.SetMaxAdvanceHeight((GReal)header->MaxAdvanceHeight);
+	font.SetUnderlinePosition((GReal)header->UnderlinePosition);
+	font.SetUnderlineThickness((GReal)header->UnderlineThickness);
+
+	// chars maps; encoded chars are copied as a whole
+	for (i = 0; i < header->CharMapsCount; ++i) {
+		const GEncodedChar *first = (const GEncodedChar *)(encodedChars + charMaps[i].FirstEncodedChar);
+		tmpMap.CharMap.assign(first, first + charMaps[i].EncodedCharsCount);
+		tmpMap.PlatformID = charMaps[i].PlatformID;
+		tmpMap.EncodingID = charMaps[i].EncodingID;
+		tmpMap.Encoding = (GCharMapEncoding)charMaps[i].Encoding;
+		font.AddCharMap(tmpMap);
+	}
+
+	// kerning table
+	tmpKerning.resize(header->KerningCount);
+	for (i = 0; i < header->KerningCount; ++i) {
+		tmpKerning[i].GlyphIndexLeft = kerning[i].GlyphIndexLeft;
+		tmpKerning[i].GlyphIndexRight = kerning[i].GlyphIndexRight;
+		tmpKerning[i].Kerning.Set((GReal)kerning[i].Kerning[0], (GReal)kerning[i].Kerning[1]);
+	}
+	font.SetKerning(tmpKerning);
+
+	// characters
+	for (i = 0; i < header->CharsCount; ++i) {
+		ch = &chars[i];
+		// composite char
+		if (ch->SubCharsCount > 0) {
+			tmpSubChars.resize(ch->SubCharsCount);
+			for (j = 0; j < ch->SubCharsCount; ++j) {
+				const GBinFontSubChar& s = subChars[ch->FirstSubChar + j];
+				tmpSubChars[j].GlyphIndex = s.GlyphIndex;
+				tmpSubChars[j].Flags = s.Flags;
+				for (k = 0; k < 3; ++k)
+					for (w = 0; w < 3; ++w)
+						tmpSubChars[j].Transformation[k][w] = (GReal)s.Transformation[k * 3 + w];
+			}
+			c = font.AddChar(tmpSubChars);
+		}
+		// plain char, contours are already labeled
+		else {
+			tmpContours.clear();
+			tmpContours.reserve(ch->ContoursCount);
+			for (j = 0; j < ch->ContoursCount; ++j) {
+				ct = &contours[ch->FirstContour + j];
+				tmpPoints.resize(ct->PointsCount);
+				tmpFlags.resize(ct->PointsCount);
+				for (k = 0; k < ct->PointsCount; ++k) {
+					w = ct->FirstPoint + k;
+					tmpPoints[k].Set((GReal)points[2 * w], (GReal)points[2 * w + 1]);
+					tmpFlags[k] = (GInt32)flags[w];
+				}
+				tmpContours.push_back(GFontCharContour2D(tmpPoints, tmpFlags, (ct->IsHole != 0)));
+			}
+			c = font.AddChar(tmpContours, G_TRUE);
+		}
+		if (!c)
+			return G_MEMORY_ERROR;
+		tmpMetrics.Width = (GReal)ch->Metrics[0];
+		tmpMetrics.Height = (GReal)ch->Metrics[1];
+		tmpMetrics.HoriBearingX = (GReal)ch->Metrics[2];
+		tmpMetrics.HoriBearingY = (GReal)ch->Metrics[3];
+		tmpMetrics.HoriAdvance = (GReal)ch->Metrics[4];
+		tmpMetrics.VertBearingX = (GReal)ch->Metrics[5];
+		tmpMetrics.VertBearingY = (GReal)ch->Metrics[6];
+		tmpMetrics.VertAdvance = (GReal)ch->Metrics[7];
+		c->SetMetrics(tmpMetrics);
+		c->SetLinearHoriAdvance((GReal)ch->LinearHoriAdvance);
+		c->SetLinearVertAdvance((GReal)ch->LinearVertAdvance);
+		c->SetAdvance(GVect<GReal, 2>((GReal)ch->Advance[0], (GReal)ch->Advance[1]));
+		c->SetLSBDelta((GReal)ch->LSBDelta);
+		c->SetRSBDelta((GReal)ch->RSBDelta);
+		c->SetEvenOddFill((ch->Flags & 1) != 0);
+	}
+	return G_NO_ERROR;
+}
+
+// append a record to a bytes buffer
+template<typename T>
+static void AppendRecord(GDynArray<GUChar8>& Buffer, const T& Record) {
+
+	const GUChar8 *p = (const GUChar8 *)&Record;
+	Buffer.insert(Buffer.end(), p, p + sizeof(T));
+}
+
+// save a font into a binary font file
+GError GBinFontImpExp::WriteBinFont(const GChar8 *FullFileName, const GElement& Element) {
+
+	const GFont2D& font = (const GFont2D&)Element;
+	GDynArray<GBinFontChar> chars;
+	GDynArray<GBinFontContour> contours;
+	GDynArray<GDouble> points;
+	GDynArray<GUChar8> flags;
+	GDynArray<GBinFontSubChar> subChars;
+	GDynArray<GBinFontCharMap> charMaps;
+	GDynArray<GBinFontEncodedChar> encodedChars;
+	GDynArray<GBinFontKerning> kerning;
+	GDynArray<GUChar8> buffer;
+	GBinFontHeader header;
+	GBinFontChar ch;
+	GBinFontContour ct;
+	GBinFontSubChar sc;
+	GBinFontCharMap cm;
+	GBinFontEncodedChar ec;
+	GBinFontKerning ke;
+	GSubChar2D subChar;
+	const GFontChar2D *c;
+	const GFontCharContour2D *contour;
+	GInt32 i, j;
+	GUInt32 k, w, q;
+	std::FILE *f;
+
+	// characters, contours and sub-characters; accessing contours makes characters labeled
+	j = font.CharsCount();
+	for (i = 0; i < j; ++i) {
+		c = font.CharByIndex(i);
+		G_ASSERT(c != NULL);
+		std::memset(&ch, 0, sizeof(GBinFontChar));
+		ch.FirstContour = (GUInt32)contours.size();
+		ch.FirstSubChar = (GUInt32)subChars.size();
+		if (c->IsComposite()) {
+			ch.SubCharsCount = c->SubCharsCount();
+			for (k = 0; k < ch.SubCharsCount; ++k) {
+				c->SubChar(k, subChar);
+				sc.GlyphIndex = subChar.GlyphIndex;
+				sc.Flags = subChar.Flags;
+				for (w = 0; w < 3; ++w)
+					for (q = 0; q < 3; ++q)
+						sc.Transformation[w * 3 + q] = (GDouble)subChar.Transformation[w][q];
+				subChars.push_back(sc);
+			}
+		}
+		else {
+			ch.ContoursCount = c->ContoursCount();
+			for (k = 0; k < ch.ContoursCount; ++k) {
+				contour = c->Contour(k);
+				ct.FirstPoint = (GUInt32)flags.size();
+				ct.PointsCount = (GUInt32)contour->PointsCount();
+				ct.IsHole = (contour->IsHole()) ? 1 : 0;
+				ct.Reserved = 0;
+				for (w = 0; w < ct.PointsCount; ++w) {
+					points.push_back((GDouble)contour->Points()[w][G_X]);
+					points.push_back((GDouble)contour->Points()[w][G_Y]);
+					flags.push_back((GUChar8)contour->PointsFlags()[w]);
+				}
+				contours.push_back(ct);
+			}
+		}
+		ch.Metrics[0] = (GDouble)c->GlyphMetrics().Width;
+		ch.Metrics[1] = (GDouble)c->GlyphMetrics().Height;
+		ch.Metrics[2] = (GDouble)c->GlyphMetrics().HoriBearingX;
+		ch.Metrics[3] = (GDouble)c->GlyphMetrics().HoriBearingY;
+		ch.Metrics[4] = (GDouble)c->GlyphMetrics().HoriAdvance;
+		ch.Metrics[5] = (GDouble)c->GlyphMetrics().VertBearingX;
+		ch.Metrics[6] = (GDouble)c->GlyphMetrics().VertBearingY;
+		ch.Metrics[7] = (GDouble)c->GlyphMetrics().VertAdvance;
+		ch.LinearHoriAdvance = (GDouble)c->LinearHoriAdvance();
+		ch.LinearVertAdvance = (GDouble)c->LinearVertAdvance();
+		ch.Advance[0] = (GDouble)c->Advance()[G_X];
+		ch.Advance[1] = (GDouble)c->Advance()[G_Y];
+		ch.LSBDelta = (GDouble)c->LSBDelta();
+		ch.RSBDelta = (GDouble)c->RSBDelta();
+		ch.Flags = (c->EvenOddFill()) ? 1 : 0;
+		chars.push_back(ch);
+	}
+
+	// chars maps
+	j = font.CharMapsCount();
+	for (i = 0; i < j; ++i) {
+		const GCharMap& map = font.CharMap(i);
+		cm.PlatformID = map.PlatformID;
+		cm.EncodingID = map.EncodingID;
+		cm.Encoding = (GUInt32)map.Encoding;
+		cm.FirstEncodedChar = (GUInt32)encodedChars.size();
+		cm.EncodedCharsCount = (GUInt32)map.CharMap.size();
+		cm.Reserved = 0;
+		for (k = 0; k < cm.EncodedCharsCount; ++k) {
+			ec.CharCode = map.CharMap[k].CharCode;
+			ec.GlyphIndex = map.CharMap[k].GlyphIndex;
+			encodedChars.push_back(ec);
+		}
+		charMaps.push_back(cm);
+	}
+
+	// kerning table
+	const GDynArray<GKerningEntry>& kerningTable = font.KerningTable();
+	for (k = 0; k < (GUInt32)kerningTable.size(); ++k) {
+		ke.GlyphIndexLeft = kerningTable[k].GlyphIndexLeft;
+		ke.GlyphIndexRight = kerningTable[k].GlyphIndexRight;
+		ke.Kerning[0] = (GDouble)kerningTable[k].Kerning[G_X];
+		ke.Kerning[1] = (GDouble)kerningTable[k].Kerning[G_Y];
+		kerning.push_back(ke);
+	}
+
+	// build header; sections follow it in this order: chars, contours, points, sub-chars, chars maps,
+	// encoded chars, kerning, points flags, family name, style name
+	std::memset(&header, 0, sizeof(GBinFontHeader));
+	std::memcpy(header.Magic, "ABF1", 4);
+	header.Version = G_BINFONT_VERSION;
+	header.ByteOrder = G_BINFONT_BYTE_ORDER;
+	header.StyleFlags = (font.IsItalic() ? 1 : 0) | (font.IsBold() ? 2 : 0);
+	header.UnitsPerEM = font.UnitsPerEM();
+	header.Ascender = (GDouble)font.Ascender();
+	header.Descender = (GDouble)font.Descender();
+	header.ExternalLeading = (GDouble)font.ExternalLeading();
+	header.MaxAdvanceWidth = (GDouble)font.MaxAdvanceWidth();
+	header.MaxAdvanceHeight = (GDouble)font.MaxAdvanceHeight();
+	header.UnderlinePosition = (GDouble)font.UnderlinePosition();
+	header.UnderlineThickness = (GDouble)font.UnderlineThickness();
+	header.CharsCount = (GUInt32)chars.size();
+	header.CharsOffset = sizeof(GBinFontHeader);
+	header.ContoursCount = (GUInt32)contours.size();
+	header.ContoursOffset = header.CharsOffset + header.CharsCount * sizeof(GBinFontChar);
+	header.PointsCount = (GUInt32)flags.size();
+	header.PointsOffset = header.ContoursOffset + header.ContoursCount * sizeof(GBinFontContour);
+	header.SubCharsCount = (GUInt32)subChars.size();
+	header.SubCharsOffset = header.PointsOffset + header.PointsCount * 2 * sizeof(GDouble);
+	header.CharMapsCount = (GUInt32)charMaps.size();
+	header.CharMapsOffset = header.SubCharsOffset + header.SubCharsCount * sizeof(GBinFontSubChar);
+	header.EncodedCharsCount = (GUInt32)encodedChars.size();
+	header.EncodedCharsOffset = header.CharMapsOffset + header.CharMapsCount * sizeof(GBinFontCharMap);
+	header.KerningCount = (GUInt32)kerning.size();
+	header.KerningOffset = header.EncodedCharsOffset + header.EncodedCharsCount * sizeof(GBinFontEncodedChar);
+	header.FlagsOffset = header.KerningOffset + header.KerningCount * sizeof(GBinFontKerning);
+	header.FamilyNameOffset = header.FlagsOffset + header.PointsCount;
+	header.FamilyNameLength = (GUInt32)font.FamilyName().length();
+	header.StyleNameOffset = header.FamilyNameOffset + header.FamilyNameLength;
+	header.StyleNameLength = (GUInt32)font.StyleName().length();
+	header.FileSize = header.StyleNameOffset + header.StyleNameLength;
+
+	// fill the whole file image
+	buffer.reserve(header.FileSize);
+	AppendRecord(buffer, header);
+	for (k = 0; k < header.CharsCount; ++k)
+		AppendRecord(buffer, chars[k]);
+	for (k = 0; k < header.ContoursCount; ++k)
+		AppendRecord(buffer, contours[k]);
+	for (k = 0; k < 2 * header.PointsCount; ++k)
+		AppendRecord(buffer, points[k]);
+	for (k = 0; k < header.SubCharsCount; ++k)
+		AppendRecord(buffer, subChars[k]);
+	for (k = 0; k < header.CharMapsCount; ++k)
+		AppendRecord(buffer, charMaps[k]);
+	for (k = 0; k < header.EncodedCharsCount; ++k)
+		AppendRecord(buffer, encodedChars[k]);
+	for (k = 0; k < header.KerningCount; ++k)
+		AppendRecord(buffer, kerning[k]);
+	buffer.insert(buffer.end(), flags.begin(), flags.end());
+	buffer.insert(buffer.end(), font.FamilyName().begin(), font.FamilyName().end());
+	buffer.insert(buffer.end(), font.StyleName().begin(), font.StyleName().end());
+	G_ASSERT(buffer.size() == header.FileSize);
+
+#if defined(G_OS_WIN) && _MSC_VER >= 1400
+	errno_t openErr = fopen_s(&f, FullFileName, "wb");
+	if (openErr)
+		return G_WRITE_ERROR;
+#else
+	f = std::fopen(FullFileName, "wb");
+	if (!f)
+		return G_WRITE_ERROR;
+#endif
+	k = (GUInt32)std::fwrite(&buffer[0], 1, buffer.size(), f);
+	std::fclose(f);
+	if (k != buffer.size())
+		return G_WRITE_ERROR;
+	return G_NO_ERROR;
+}
+
+GError GBinFontImpExp::DoRead(const GChar8 *FullFileName, GElement& Element,
+							  const GDynArray<GImpExpOption>& ParsedOptions) {
+
+#if defined(_BINFONT_READ)
+	// just to avoid warnings
+	if (ParsedOptions.size() > 0) {
+	}
+	return ReadBinFont(FullFileName, Element);
+#else
+	// just to avoid warnings
+	if (!FullFileName || ParsedOptions.size() > 0 || Element.Owner())
+		return G_MISSED_FEATURE;
+	return G_MISSED_FEATURE;
+#endif
+}
+
+GError GBinFontImpExp::DoWrite(const GChar8 *FullFileName, const GElement& Element,
+							   const GDynArray<GImpExpOption>& ParsedOptions) {
+
+#if defined(_BINFONT_WRITE)
+	// just to avoid warnings
+	if (ParsedOptions.size() > 0) {
+	}
+	return WriteBinFont(FullFileName, Element);
+#else
+	// just to avoid warnings
+	if (!FullFileName || ParsedOptions.size() > 0 || Element.Owner())
+		return G_MISSED_FEATURE;
+	return G_MISSED_FEATURE;
+#endif
+}
+
+// export interface functions
+#ifdef _BINFONT_PLUGIN_EXTERNAL
+G_EXTERN_C G_PLUGIN_EXPORT GUInt32 ProxiesCount() {
+	return 1;
+}
+G_EXTERN_C G_PLUGIN_EXPORT const GElementProxy* ProxyInstance(const GUInt32 Index) {
+	if (Index == 0)
+		return &G_BINFONTIMPEXP_PROXY;
+	return NULL;
+}
+#endif
+
+}
+
+#endif
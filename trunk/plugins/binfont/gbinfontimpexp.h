@@ -0,0 +1,106 @@
+/****************************************************************************
+** $file: amanith/plugins/binfont/gbinfontimpexp.h   0.3.0.0   edited Jan, 30 2006
+**
+** 2D font binary format import/export plugin interface.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#ifndef GBINFONTIMPEXP_H
+#define GBINFONTIMPEXP_H
+
+#include "amanith/gimpexp.h"
+#include "amanith/2d/gfont2d.h"
+
+namespace Amanith {
+
+	// *********************************************************************
+	//                              GBinFontImpExp
+	// *********************************************************************
+	static const GClassID G_BINFONTIMPEXP_CLASSID = GClassID("GBinFontImpExp", 0x1BE85C2D, 0x077841A1, 0xB82CDCD6, 0x5FA4B7FA);
+
+	/*
+		Amanith binary font format (abf): a pre-processed GFont2D, stored as flat arrays of fixed size records.
+
+		Contours are stored already cleaned, labeled (holes/solids) and oriented, so loading a font does not need
+		any parsing nor any geometric processing: the file is memory mapped, validated and copied into the font.
+		All values are stored in the byte order of the machine that wrote the file, and real values are stored
+		as 64 bit floating point numbers; a file written with a different byte order is rejected.
+	*/
+	class G_PLUGIN_EXPORT GBinFontImpExp : public GImpExp {
+
+	private:
+		void AddBinFontFeatures();
+
+	protected:
+		// load a binary font file
+		GError ReadBinFont(const GChar8 *FullFileName, GElement& Element);
+		// save a font into a binary font file
+		GError WriteBinFont(const GChar8 *FullFileName, const GElement& Element);
+
+		// read a binary font file and fill a GFont2D with read data
+		GError DoRead(const GChar8 *FullFileName, GElement& Element, const GDynArray<GImpExpOption>& ParsedOptions);
+		// write to an external binary font file a specified GFont2D
+		GError DoWrite(const GChar8 *FullFileName, const GElement& Element, const GDynArray<GImpExpOption>& ParsedOptions);
+
+	public:
+		// constructor
+		GBinFontImpExp();
+		// constructor
+		GBinFontImpExp(const GElement* Owner);
+		// destructor
+		~GBinFontImpExp();
+		// get class ID
+		const GClassID& ClassID() const {
+			return G_BINFONTIMPEXP_CLASSID;
+		}
+		// get derived class ID
+		const GClassID& DerivedClassID() const {
+			return G_IMPEXP_CLASSID;
+		}
+	};
+
+
+	// *********************************************************************
+	//                           GBinFontImpExpProxy
+	// *********************************************************************
+	class G_PLUGIN_EXPORT GBinFontImpExpProxy : public GElementProxy {
+	public:
+		GElement* CreateNew(const GElement* Owner = NULL) const {
+			return new GBinFontImpExp(Owner);
+		}
+		// get class ID
+		const GClassID& ClassID() const {
+			return G_BINFONTIMPEXP_CLASSID;
+		}
+		// get derived class ID
+		const GClassID& DerivedClassID() const {
+			return G_IMPEXP_CLASSID;
+		}
+	};
+
+	static const GBinFontImpExpProxy G_BINFONTIMPEXP_PROXY;
+
+};	// end namespace Amanith
+
+#endif
@@ -21,6 +21,12 @@ contains(DEFINES, _FONTS_PLUGIN) {
     }
 }
 
+contains(DEFINES, _BINFONT_PLUGIN) {
+    contains(BINFONT_PLUGIN_OPTIONS, EXTERNAL) {
+        SUBDIRS += binfont
+    }
+}
+
 contains(DEFINES, _NETWORK_PLUGIN) {
     contains(NETWORK_PLUGIN_OPTIONS, EXTERNAL) {
         SUBDIRS += network
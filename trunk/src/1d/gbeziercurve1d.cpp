@@ -464,6 +464,115 @@ GReal GBezierCurve1D::Derivative(const GDerivativeOrder Order, const GReal u) co
 	return tmpPoint;
 }
 
+// batched evaluations switch to the power basis up to this degree; for higher degrees the Horner-Bezier
+// scheme is numerically safer
+#define G_BEZIER_POWER_BASIS_MAX_DEGREE 4
+
+// convert Bezier control points into power basis coefficients, so that
+// C(t) = Coeffs[0] + t * (Coeffs[1] + t * (Coeffs[2] + ...)); Coeffs[k] is Binomial(n, k) times the
+// k-th forward difference of control points
+static void BezierPowerBasis(const GReal *Points, const GInt32 Degree, GReal *Coeffs) {
+
+	GReal diff[G_BEZIER_POWER_BASIS_MAX_DEGREE + 1];
+	GReal binomial = 1;
+	GInt32 i, k;
+
+	G_ASSERT(Degree <= G_BEZIER_POWER_BASIS_MAX_DEGREE);
+
+	for (i = 0; i <= Degree; i++)
+		diff[i] = Points[i];
+	for (k = 0; k <= Degree; k++) {
+		Coeffs[k] = binomial * diff[0];
+		for (i = 0; i < Degree - k; i++)
+			diff[i] = diff[i + 1] - diff[i];
+		binomial = (binomial * (Degree - k)) / (k + 1);
+	}
+}
+
+// evaluate the curve at several global parameters
+void GBezierCurve1D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GReal coeffs[G_BEZIER_POWER_BASIS_MAX_DEGREE + 1], tmpPoint;
+	GReal t, u, uStart, uEnd, invLength;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GInt32 k, n = Degree();
+
+	Out.resize(j);
+	// degree must be at least one
+	if (n <= 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+	if (n > G_BEZIER_POWER_BASIS_MAX_DEGREE) {
+		for (i = 0; i < j; i++)
+			Out[i] = GBezierCurve1D::Evaluate(Params[i]);
+		return;
+	}
+
+	BezierPowerBasis(&gPoints[0], n, coeffs);
+	uStart = DomainStart();
+	uEnd = DomainEnd();
+	invLength = 1 / Domain().Length();
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// check for global parameter out of range
+		if (u <= uStart)
+			Out[i] = gPoints[0];
+		else
+		if (u >= uEnd)
+			Out[i] = gPoints[n];
+		else {
+			t = (u - uStart) * invLength;
+			tmpPoint = coeffs[n];
+			for (k = n - 1; k >= 0; k--)
+				tmpPoint = tmpPoint * t + coeffs[k];
+			Out[i] = tmpPoint;
+		}
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GBezierCurve1D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GReal coeffs[G_BEZIER_POWER_BASIS_MAX_DEGREE + 1], tmpPoint;
+	GReal t, uStart, invLength;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GInt32 k, n = Degree() - Order;
+
+	Out.resize(j);
+	// in this case derivate is null (ex: third derivate of a quadratic Bezier curve)
+	if (n < 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+	if (n > G_BEZIER_POWER_BASIS_MAX_DEGREE) {
+		for (i = 0; i < j; i++)
+			Out[i] = GBezierCurve1D::Derivative(Order, Params[i]);
+		return;
+	}
+	// if any point has been changed we have to recalculate forward differences
+	if (gModified)
+		BuildForwDiff();
+
+	if (Order == G_FIRST_ORDER_DERIVATIVE)
+		BezierPowerBasis(&gForwDiff1[0], n, coeffs);
+	else
+		BezierPowerBasis(&gForwDiff2[0], n, coeffs);
+
+	uStart = DomainStart();
+	invLength = 1 / Domain().Length();
+	for (i = 0; i < j; i++) {
+		// clamp parameter inside valid interval
+		t = GMath::Clamp((Params[i] - uStart) * invLength, (GReal)0, (GReal)1);
+		tmpPoint = coeffs[n];
+		for (k = n - 1; k >= 0; k--)
+			tmpPoint = tmpPoint * t + coeffs[k];
+		Out[i] = tmpPoint;
+	}
+}
+
 // cut the curve, giving the 2 new set of control points that represents 2 Bezier curve (with the
 // same degree of the original one)
 // We use De Casteljau's Algorithm
@@ -468,6 +468,25 @@ GInt32 GBSplineCurve1D::FindSpan(const GReal u) const {
 	return -1;
 }
 
+// find knot span, starting from a span not greater than the searched one
+GInt32 GBSplineCurve1D::FindSpan(const GReal u, const GInt32 SpanHint) const {
+
+	GInt32 i, j;
+
+	j = (GInt32)gKnots.size() - 1;
+	if (SpanHint < 0 || SpanHint >= j || u < gKnots[SpanHint])
+		return FindSpan(u);
+	if (gOpened) {
+		if (u >= DomainEnd())
+			return (GInt32)PointsCount() - 1;
+	}
+	// knots are not decreasing, so spans before the hint can't contain the parameter
+	for (i = SpanHint; i < j; i++)
+		if (u < gKnots[i + 1])
+			return i;
+	return -1;
+}
+
 // find at the same time knot span and its multiplicity
 GInt32 GBSplineCurve1D::FindSpanMult(const GReal u, GInt32& Multiplicity) const {
 
@@ -812,6 +831,76 @@ GReal GBSplineCurve1D::Derivative(const GDerivativeOrder Order, const GReal u) c
 }
 
 
+// evaluate the curve at several global parameters
+void GBSplineCurve1D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GReal tmpPoint;
+	GInt32 k, span = -1;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GReal uu, *c;
+
+	Out.resize(j);
+	if (PointsCount() == 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		// clamp parameter inside valid interval
+		uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+		// the previous span is a good starting point for sorted parameters
+		span = FindSpan(uu, span);
+		c = BasisFunctions(span, gDegree, uu);
+		tmpPoint = 0;
+		for (k = 0; k <= gDegree; k++)
+			tmpPoint += c[k] * gPoints[span - gDegree + k];
+		Out[i] = tmpPoint;
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GBSplineCurve1D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GReal tmpPoint;
+	GInt32 k, span = -1;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GReal uu, *c;
+
+	Out.resize(j);
+	if (PointsCount() == 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+	// for clamped splines forward differences are used
+	if (gOpened && gModified)
+		BuildForwDiff();
+
+	for (i = 0; i < j; i++) {
+		// clamp parameter inside valid interval
+		uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+		span = FindSpan(uu, span);
+		tmpPoint = 0;
+		if (gOpened) {
+			c = BasisFunctions(span, gDegree - Order, uu);
+			if (Order == G_FIRST_ORDER_DERIVATIVE)
+				for (k = 0; k <= gDegree - Order; k++)
+					tmpPoint += c[k] * gForwDiff1[span - gDegree + k];
+			else
+			if (Order == G_SECOND_ORDER_DERIVATIVE)
+				for (k = 0; k <= gDegree - Order; k++)
+					tmpPoint += c[k] * gForwDiff2[span - gDegree + k];
+		}
+		else {
+			c = BasisFuncDerivatives(Order, span, gDegree, uu);
+			for (k = 0; k <= gDegree; k++)
+				tmpPoint += c[k] * gPoints[span - gDegree + k];
+		}
+		Out[i] = tmpPoint;
+	}
+}
+
 // decreases by one the degree of the curve
 GError GBSplineCurve1D::LowerDegree() {
 
@@ -1398,35 +1487,29 @@ static void BandedBackSubstitution(GDynArray<GReal>& a, const GInt32 n, const GI
 }
 
 
+// set an element of a banded matrix stored in compact form (see SolveBandedSystem); elements outside the band
+// are discarded
+static void SetBandElement(GDynArray<GReal>& CompactMatrix, const GInt32 LeftSemiBandWidth,
+						   const GInt32 RightSemiBandWidth, const GInt32 i, const GInt32 j, const GReal Value) {
+
+	if (j - i < -LeftSemiBandWidth || j - i > RightSemiBandWidth)
+		return;
+	CompactMatrix[i * (LeftSemiBandWidth + RightSemiBandWidth + 1) + j - i + LeftSemiBandWidth] = Value;
+}
+
 // resolve banded system for curve fitting
-GError GBSplineCurve1D::SolveBandedSystem(const GDynArray<GReal>& BasisMatrix, const GInt32 MatrixSize,
+GError GBSplineCurve1D::SolveBandedSystem(GDynArray<GReal>& CompactMatrix, const GInt32 MatrixSize,
 										  const GInt32 LeftSemiBandWidth, const GInt32 RightSemiBandWidth,
 										  GDynArray<GReal>& Rhs) {
 
-	GInt32 i, j;
+	G_ASSERT((GInt32)CompactMatrix.size() == MatrixSize * (LeftSemiBandWidth + RightSemiBandWidth + 1));
 
-	// construct compact representation of basis functions matrix
-	GDynArray<GReal> compactMatrix(MatrixSize * (LeftSemiBandWidth + RightSemiBandWidth + 1), 0);
-	#define CMATRIX(i, j) compactMatrix[(i)*(LeftSemiBandWidth + RightSemiBandWidth + 1) + (j)]
-	#define MATRIX(i, j) BasisMatrix[(i)*MatrixSize + (j)]
-
-	// copy diagonal and superdiagonal elements
-	for (i = 0; i <= RightSemiBandWidth; i++)
-		for (j = 0; j <= MatrixSize - 1 - i; j++)
-			CMATRIX(j, LeftSemiBandWidth + i) = MATRIX(j, i + j);
-	// copy subdiagonal
-	for (i = 1; i <= LeftSemiBandWidth; i++)
-		for (j = 0; j <= MatrixSize - 1 - i; j++)
-			CMATRIX(j + i, LeftSemiBandWidth - i) = MATRIX(i + j, j);
 	// resolve banded linear system
 	GDynArray<GReal> al(MatrixSize * LeftSemiBandWidth);
 	GDynArray<GInt32> indx(MatrixSize);
 
-	BandEncodec(compactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx);
-	BandedBackSubstitution(compactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx, Rhs);
-
-	#undef CMATRIX
-	#undef MATRIX
+	BandEncodec(CompactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx);
+	BandedBackSubstitution(CompactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx, Rhs);
 	return G_NO_ERROR;
 }
 
@@ -1438,11 +1521,12 @@ GError GBSplineCurve1D::GlobalFit(const GInt32 Degree, const GDynArray<GReal>& F
 		return G_INVALID_PARAMETER;
 
 	GInt32 n = (GInt32)FitPoints.size() - 1, m = n + Degree + 1, i, j, span;
-	GDynArray<GReal> matrix((n + 1) * (n + 1), 0);
+	// basis functions matrix, only its band is stored (Degree - 1 elements on each side of the diagonal)
+	GDynArray<GReal> matrix((n + 1) * (2 * Degree - 1), 0);
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk;
 	GReal *basisFuncs;
-	#define MATRIX(i, j) matrix[(i)*(n + 1) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1451,18 +1535,21 @@ GError GBSplineCurve1D::GlobalFit(const GInt32 Degree, const GDynArray<GReal>& F
 	SetPoints(FitPoints, knots, Degree, G_FALSE);
 
 	// build basis functions matrix
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build i-th row
 		for (j = 0; j <= Degree; j++)
-			MATRIX(i, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(i, span - Degree + j, basisFuncs[j]);
 	}
 	// build first and last row
-	MATRIX(0, 0) = MATRIX(n, n) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
+	SET_MATRIX(n, n, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, n + 1, Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 // curve (global) fitting with first derivative specified at end points
@@ -1480,12 +1567,12 @@ GError GBSplineCurve1D::GlobalFit(const GInt32 Degree, const GDynArray<GReal>& F
 	else
 		m = n + Degree + 3;
 
-	GDynArray<GReal> matrix((n + 3) * (n + 3), 0);
+	GDynArray<GReal> matrix((n + 3) * (2 * Degree - 1), 0);
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk(n + 1);
 	GDynArray<GReal> rhs(n + 3);
 	GReal *basisFuncs, oneOverDegree;
-	#define MATRIX(i, j) matrix[(i)*(n + 3) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1513,26 +1600,28 @@ GError GBSplineCurve1D::GlobalFit(const GInt32 Degree, const GDynArray<GReal>& F
 	SetPoints(rhs, knots, Degree, G_FALSE);
 
 	// build basis functions matrix
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build i-th row
 		for (j = 0; j <= Degree; j++)
-			MATRIX(i + 1, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(i + 1, span - Degree + j, basisFuncs[j]);
 	}
 	// build first row
-	MATRIX(0, 0) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
 	// build second row (first derivative condition)
-	MATRIX(1, 0) = -1;
-	MATRIX(1, 1) = 1;
+	SET_MATRIX(1, 0, -1);
+	SET_MATRIX(1, 1, 1);
 	// build "last but one" row (first derivative condition)
-	MATRIX(n + 1, n + 1) = -1;
-	MATRIX(n + 1, n + 2) = 1;
+	SET_MATRIX(n + 1, n + 1, -1);
+	SET_MATRIX(n + 1, n + 2, 1);
 	// build last row
-	MATRIX(n + 2, n + 2) = (GReal)1;
+	SET_MATRIX(n + 2, n + 2, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, n + 3, Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 // curve (global) natural (second derivaives = 0) fitting
@@ -1549,12 +1638,12 @@ GError GBSplineCurve1D::GlobalNaturalFit(const GInt32 Degree, const GDynArray<GR
 	else
 		m = n + Degree + 3;
 
-	GDynArray<GReal> matrix((n + 3) * (n + 3), 0);
+	GDynArray<GReal> matrix((n + 3) * (2 * Degree - 1), 0);
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk(n + 1);
 	GDynArray<GReal> rhs(n + 3);
 	GReal *basisFuncs, c;
-	#define MATRIX(i, j) matrix[(i)*(n + 3) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1582,32 +1671,34 @@ GError GBSplineCurve1D::GlobalNaturalFit(const GInt32 Degree, const GDynArray<GR
 	SetPoints(rhs, knots, Degree, G_FALSE);
 
 	// build basis functions matrix
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build i-th row
 		for (j = 0; j <= Degree; j++)
-			MATRIX(i + 1, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(i + 1, span - Degree + j, basisFuncs[j]);
 	}
 	// build first row
-	MATRIX(0, 0) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
 	// build second row (second derivative condition)
 	c = (GReal)Degree * (GReal)(Degree - 1);
 	c = c / (knots[Degree + 1] - MinKnotValue);
-	MATRIX(1, 0) = c / (knots[Degree + 1] - MinKnotValue);
-	MATRIX(1, 1) = -c * ((knots[Degree + 1] - MinKnotValue) + (knots[Degree + 2] - MinKnotValue)) / ((knots[Degree + 1] - MinKnotValue) * (knots[Degree + 2] - MinKnotValue));
-	MATRIX(1, 2) = c / (knots[Degree + 2] - MinKnotValue);
+	SET_MATRIX(1, 0, c / (knots[Degree + 1] - MinKnotValue));
+	SET_MATRIX(1, 1, -c * ((knots[Degree + 1] - MinKnotValue) + (knots[Degree + 2] - MinKnotValue)) / ((knots[Degree + 1] - MinKnotValue) * (knots[Degree + 2] - MinKnotValue)));
+	SET_MATRIX(1, 2, c / (knots[Degree + 2] - MinKnotValue));
 	// build "last but one" row (second derivative condition)
 	c = (GReal)Degree * (GReal)(Degree - 1);
 	c = c / (MaxKnotValue - knots[m - Degree - 1]);
-	MATRIX(n + 1, n) = c / (MaxKnotValue - knots[m - Degree - 2]);
-	MATRIX(n + 1, n + 1) = -c * ((2 * MaxKnotValue - knots[m - Degree - 1] - knots[m - Degree - 2]) / ((MaxKnotValue - knots[m - Degree - 1]) * (MaxKnotValue - knots[m - Degree - 2])));
-	MATRIX(n + 1, n + 2) = c / (MaxKnotValue - knots[m - Degree - 1]);
+	SET_MATRIX(n + 1, n, c / (MaxKnotValue - knots[m - Degree - 2]));
+	SET_MATRIX(n + 1, n + 1, -c * ((2 * MaxKnotValue - knots[m - Degree - 1] - knots[m - Degree - 2]) / ((MaxKnotValue - knots[m - Degree - 1]) * (MaxKnotValue - knots[m - Degree - 2]))));
+	SET_MATRIX(n + 1, n + 2, c / (MaxKnotValue - knots[m - Degree - 1]));
 	// build last row
-	MATRIX(n + 2, n + 2) = (GReal)1;
+	SET_MATRIX(n + 2, n + 2, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, n + 3, Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 // curve (global) fitting with first derivative specified at each point
@@ -1628,12 +1719,12 @@ GError GBSplineCurve1D::GlobalFit(const GInt32 Degree, const GDynArray<GReal>& F
 	else
 		m = (n + Degree + 1) + (n + 1);
 
-	GDynArray<GReal> matrix(2 * (n + 1) * 2 * (n + 1), 0);
+	GDynArray<GReal> matrix(2 * (n + 1) * (2 * Degree - 1), 0);
 	GDynArray<GReal> rhs(2 * (n + 1));
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk(n + 1);
 	GReal *basisFuncs, *derFuncs, oneOverDegree, u;
-	#define MATRIX(i, j) matrix[(i) * (2 * (n + 1)) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector (and intermediate ones)
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1711,32 +1802,34 @@ GError GBSplineCurve1D::GlobalFit(const GInt32 Degree, const GDynArray<GReal>& F
 
 	// build basis functions matrix
 	k = 2;
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build row corresponding to the point interpolation condition
 		for (j = 0; j <= Degree; j++)
-			MATRIX(k, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(k, span - Degree + j, basisFuncs[j]);
 		// build row corresponding to the derivative interpolation condition
 		k++;
 		derFuncs = BasisFuncDerivatives(G_FIRST_ORDER_DERIVATIVE, span, Degree, uk[i]);
 		for (j = 0; j <= Degree; j++)
-			MATRIX(k, span - Degree + j) = derFuncs[j];
+			SET_MATRIX(k, span - Degree + j, derFuncs[j]);
 		k++;
 	}
 	// build first row
-	MATRIX(0, 0) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
 	// build second row (first derivative condition)
-	MATRIX(1, 0) = -1;
-	MATRIX(1, 1) = 1;
+	SET_MATRIX(1, 0, -1);
+	SET_MATRIX(1, 1, 1);
 	// build "last but one" row (first derivative condition)
-	MATRIX(2 * (n + 1) - 2 , 2 * (n + 1) - 2) = -1;
-	MATRIX(2 * (n + 1) - 2, 2 * (n + 1) - 1) = 1;
+	SET_MATRIX(2 * (n + 1) - 2 , 2 * (n + 1) - 2, -1);
+	SET_MATRIX(2 * (n + 1) - 2, 2 * (n + 1) - 1, 1);
 	// build last row
-	MATRIX(2 * (n + 1) - 1, 2 * (n + 1) - 1) = (GReal)1;
+	SET_MATRIX(2 * (n + 1) - 1, 2 * (n + 1) - 1, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, 2 * (n + 1), Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 };	// end namespace Amanith
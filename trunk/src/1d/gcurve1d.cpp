@@ -67,6 +67,26 @@ GReal GCurve1D::Tangent(const GReal u) const {
 	return Derivative(G_FIRST_ORDER_DERIVATIVE, u);
 }
 
+// evaluate the curve at several global parameters
+void GCurve1D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size();
+
+	Out.resize(j);
+	for (i = 0; i < j; ++i)
+		Out[i] = Evaluate(Params[i]);
+}
+
+// evaluate the curve derivative at several global parameters
+void GCurve1D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size();
+
+	Out.resize(j);
+	for (i = 0; i < j; ++i)
+		Out[i] = Derivative(Order, Params[i]);
+}
+
 // get curve speed (specifying global parameter)
 GReal GCurve1D::Speed(const GReal u) const {
 
@@ -89,7 +109,7 @@ GReal GCurve1D::Length(const GReal u0, const GReal u1, const GReal MaxError) con
 		uu1 = u1;
 	}
 	// integration over speed
-	errorBounded = GIntegration::Romberg(result, uu0, uu1, SpeedEvaluationCallBack, (void *)this, MaxError);
+	errorBounded = GIntegration::GaussKronrod(result, uu0, uu1, SpeedsEvaluationCallBack, (void *)this, MaxError);
 	return result;
 }
 
@@ -261,4 +281,13 @@ GReal GCurve1D::SpeedEvaluationCallBack(const GReal u, void *Data) {
 	return c->Speed(u);
 }
 
+// static batched speed evaluation callback
+void GCurve1D::SpeedsEvaluationCallBack(const GReal *u, GReal *Speeds, const GUInt32 Count, void *Data) {
+
+	const GCurve1D *c = (const GCurve1D *)Data;
+
+	for (GUInt32 i = 0; i < Count; ++i)
+		Speeds[i] = c->Speed(u[i]);
+}
+
 };	// end namespace Amanith
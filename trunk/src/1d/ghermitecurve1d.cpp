@@ -315,6 +315,16 @@ GReal GHermiteCurve1D::SegmentSpeedEvaluationCallBack(const GReal u, void *Data)
 	return (data->Curve->SegmentDerivative(data->KeyIndex, G_FIRST_ORDER_DERIVATIVE, u));
 }
 
+// static batched speed evaluation callback (useful for length evaluation)
+void GHermiteCurve1D::SegmentSpeedsEvaluationCallBack(const GReal *u, GReal *Speeds, const GUInt32 Count, void *Data) {
+
+	G_ASSERT(Data != NULL);
+	GHermiteCallBackData *data = (GHermiteCallBackData *)Data;
+
+	for (GUInt32 i = 0; i < Count; ++i)
+		Speeds[i] = data->Curve->SegmentDerivative(data->KeyIndex, G_FIRST_ORDER_DERIVATIVE, u[i]);
+}
+
 // calculate length of i-th segment (key (i) to key (i+1)), between 2 parameters; it suppose that
 // Index is valid and also parameter range is inside specified segment range
 GReal GHermiteCurve1D::SegmentLength(const GUInt32 Index, const GReal MinParam, const GReal MaxParam,
@@ -327,7 +337,7 @@ GReal GHermiteCurve1D::SegmentLength(const GUInt32 Index, const GReal MinParam,
 	GReal result;
 
 	// integration over speed
-	GIntegration::Romberg(result, MinParam, MaxParam, SegmentSpeedEvaluationCallBack, &callBackData, MaxError);
+	GIntegration::GaussKronrod(result, MinParam, MaxParam, SegmentSpeedsEvaluationCallBack, &callBackData, MaxError);
 	return result;
 }
 
@@ -521,6 +531,24 @@ GBool GHermiteCurve1D::ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex) con
 	return G_TRUE;
 }
 
+// given a domain value, it returns the span index that includes it, starting from a key index hint
+GBool GHermiteCurve1D::ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex, const GUInt32 KeyIndexHint) const {
+
+	GUInt32 i = KeyIndexHint, j = (GUInt32)gKeys.size(), steps;
+
+	if (i + 1 < j && Param >= gKeys[i].Parameter) {
+		// sorted parameters usually fall in the same interval, or in one of the next ones
+		for (steps = 0; steps < 4 && i + 1 < j; steps++, i++) {
+			if (Param < gKeys[i + 1].Parameter) {
+				KeyIndex = i;
+				return G_TRUE;
+			}
+		}
+	}
+	// too far, lets do a binary search
+	return ParamToKeyIndex(Param, KeyIndex);
+}
+
 // cut the curve, giving the 2 new set of control points that represents 2 poly-line curves (with the
 // same degree of the original one)
 GError GHermiteCurve1D::DoCut(const GReal u, GCurve1D *RightCurve, GCurve1D *LeftCurve) const {
@@ -920,6 +948,67 @@ GReal GHermiteCurve1D::Derivative(const GDerivativeOrder Order, const GReal u) c
 	return SegmentDerivative(keyIndex, Order, uu);
 }
 
+// evaluate the curve at several global parameters
+void GHermiteCurve1D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size(), keyIndex = 0;
+	GReal u;
+	GBool b;
+
+	Out.resize(j);
+	if (PointsCount() < 1) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// check for global parameter out of range
+		if (u <= DomainStart())
+			Out[i] = StartPoint();
+		else
+		if (u >= DomainEnd())
+			Out[i] = EndPoint();
+		else {
+			// the previous key index is a good starting point for sorted parameters
+			b = ParamToKeyIndex(u, keyIndex, keyIndex);
+			G_ASSERT(b == G_TRUE);
+			Out[i] = SegmentEvaluate(keyIndex, u);
+		}
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GHermiteCurve1D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size(), keyIndex = 0;
+	GReal u;
+	GBool b;
+
+	Out.resize(j);
+	if (PointsCount() < 2) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// clamp parameter inside valid interval
+		if (u <= DomainStart())
+			Out[i] = SegmentDerivative(0, Order, DomainStart());
+		else
+		if (u >= DomainEnd())
+			Out[i] = SegmentDerivative(PointsCount() - 2, Order, DomainEnd());
+		else {
+			b = ParamToKeyIndex(u, keyIndex, keyIndex);
+			G_ASSERT(b == G_TRUE);
+			Out[i] = SegmentDerivative(keyIndex, Order, u);
+		}
+	}
+}
+
 void GHermiteCurve1D::DerivativeLR(const GDerivativeOrder Order, const GReal u,
 								   GReal& LeftDerivative, GReal& RightDerivative) const {
 
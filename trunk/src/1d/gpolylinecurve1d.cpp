@@ -336,6 +336,24 @@ GBool GPolyLineCurve1D::ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex) co
 	return G_TRUE;
 }
 
+// given a domain value, it returns the span index that includes it, starting from a key index hint
+GBool GPolyLineCurve1D::ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex, const GUInt32 KeyIndexHint) const {
+
+	GUInt32 i = KeyIndexHint, j = (GUInt32)gKeys.size(), steps;
+
+	if (i + 1 < j && Param >= gKeys[i].Parameter) {
+		// sorted parameters usually fall in the same interval, or in one of the next ones
+		for (steps = 0; steps < 4 && i + 1 < j; steps++, i++) {
+			if (Param < gKeys[i + 1].Parameter) {
+				KeyIndex = i;
+				return G_TRUE;
+			}
+		}
+	}
+	// too far, lets do a binary search
+	return ParamToKeyIndex(Param, KeyIndex);
+}
+
 // cut the curve, giving the 2 new set of control points that represents 2 poly-line curves (with the
 // same degree of the original one)
 GError GPolyLineCurve1D::DoCut(const GReal u, GCurve1D *RightCurve, GCurve1D *LeftCurve) const {
@@ -653,7 +671,7 @@ GReal GPolyLineCurve1D::Derivative(const GDerivativeOrder Order, const GReal u)
 
 	// clamp parameter inside valid interval
 	if (u <= DomainStart())
-		keyIndex = 1;
+		keyIndex = 0;
 	else
 	if (u >= DomainEnd())
 		keyIndex = PointsCount() - 2;
@@ -665,6 +683,70 @@ GReal GPolyLineCurve1D::Derivative(const GDerivativeOrder Order, const GReal u)
 	return ((gKeys[keyIndex + 1].Value - gKeys[keyIndex].Value) * dtdu);
 }
 
+// evaluate the curve at several global parameters
+void GPolyLineCurve1D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size(), keyIndex = 0;
+	GReal u, ratio;
+	GBool b;
+
+	Out.resize(j);
+	if (PointsCount() < 1) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_MIN_REAL;
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// check for global parameter out of range
+		if (u <= DomainStart())
+			Out[i] = StartPoint();
+		else
+		if (u >= DomainEnd())
+			Out[i] = EndPoint();
+		else {
+			// the previous key index is a good starting point for sorted parameters
+			b = ParamToKeyIndex(u, keyIndex, keyIndex);
+			G_ASSERT(b == G_TRUE);
+			ratio = (u - gKeys[keyIndex].Parameter) / (gKeys[keyIndex + 1].Parameter - gKeys[keyIndex].Parameter);
+			Out[i] = GMath::Lerp(ratio, gKeys[keyIndex].Value, gKeys[keyIndex + 1].Value);
+		}
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GPolyLineCurve1D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GReal>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size(), k, keyIndex = 0;
+	GReal u, dtdu;
+	GBool b;
+
+	Out.resize(j);
+	if (PointsCount() < 2 || Order >= G_SECOND_ORDER_DERIVATIVE) {
+		for (i = 0; i < j; i++)
+			Out[i] = (PointsCount() < 2) ? G_MIN_REAL : 0;
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// clamp parameter inside valid interval
+		if (u <= DomainStart())
+			k = 0;
+		else
+		if (u >= DomainEnd())
+			k = PointsCount() - 2;
+		else {
+			b = ParamToKeyIndex(u, keyIndex, keyIndex);
+			G_ASSERT(b == G_TRUE);
+			k = keyIndex;
+		}
+		dtdu = gKeys[k + 1].Parameter - gKeys[k].Parameter;
+		Out[i] = (gKeys[k + 1].Value - gKeys[k].Value) * dtdu;
+	}
+}
+
 void GPolyLineCurve1D::DerivativeLR(const GDerivativeOrder Order, const GReal u,
 									GReal& LeftDerivative, GReal& RightDerivative) const {
 
@@ -69,6 +69,9 @@ GAnimTRSNode2D::GAnimTRSNode2D() : GAnimElement() {
 		p->Property("x")->SetDefaultValue(GKeyValue((GReal)1));
 		p->Property("y")->SetDefaultValue(GKeyValue((GReal)1));
 	}
+	ResolveTRSProperties();
+	gCacheTime = 0;
+	gCacheDirty = G_TRUE;
 }
 
 // default constructor with owner
@@ -98,6 +101,37 @@ GAnimTRSNode2D::GAnimTRSNode2D(const GElement* Owner) : GAnimElement(Owner) {
 		p->Property("x")->SetDefaultValue(GKeyValue((GReal)1));
 		p->Property("y")->SetDefaultValue(GKeyValue((GReal)1));
 	}
+	ResolveTRSProperties();
+	gCacheTime = 0;
+	gCacheDirty = G_TRUE;
+}
+
+// resolve TRS properties pointers
+void GAnimTRSNode2D::ResolveTRSProperties() {
+
+	GProperty *tmpProp = Property("transform");
+	GUInt32 i;
+
+	for (i = 0; i < 5; ++i)
+		gTRSProperties[i] = NULL;
+	// this can be the case of a node not created through a kernel
+	if (!tmpProp)
+		return;
+
+	GProperty *posProp = tmpProp->Property("position");
+	GProperty *rotProp = tmpProp->Property("rotation");
+	GProperty *scaleProp = tmpProp->Property("scale");
+	G_ASSERT(posProp != NULL);
+	G_ASSERT(rotProp != NULL);
+	G_ASSERT(scaleProp != NULL);
+
+	gTRSProperties[0] = posProp->Property("x");
+	gTRSProperties[1] = posProp->Property("y");
+	gTRSProperties[2] = rotProp;
+	gTRSProperties[3] = scaleProp->Property("x");
+	gTRSProperties[4] = scaleProp->Property("y");
+	for (i = 0; i < 5; ++i)
+		G_ASSERT(gTRSProperties[i] != NULL);
 }
 
 // destructor, delete all keys and internal ease curve (if it exists)
@@ -255,24 +289,16 @@ GError GAnimTRSNode2D::SetFather(GAnimTRSNode2D *NewFather, const GBool AffectTr
 
 GPoint2 GAnimTRSNode2D::Position(const GTimeValue TimePos, const GSpaceSystem Space, GTimeInterval& ValidInterval) const {
 
-	GProperty *tmpProp = Property("transform");
-
-	if (!tmpProp)
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[0])
 		return GPoint2(0, 0);
 
-	tmpProp = tmpProp->Property("position");
-	G_ASSERT(tmpProp);
 	GTimeInterval tmpValid = G_FOREVER_TIMEINTERVAL;
 	GKeyValue xValue, yValue;
 
 	// extract translation
-	GProperty *xProp = tmpProp->Property("x");
-	GProperty *yProp = tmpProp->Property("y");
-	G_ASSERT(xProp != NULL);
-	G_ASSERT(yProp != NULL);
-	// build translation factor
-	GError xErr = xProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	GError yErr = yProp->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	GError xErr = gTRSProperties[0]->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	GError yErr = gTRSProperties[1]->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
 	if (xErr != G_NO_ERROR || yErr != G_NO_ERROR)
 		return GPoint2(0, 0);
 
@@ -290,17 +316,14 @@ GPoint2 GAnimTRSNode2D::Position(const GTimeValue TimePos, const GSpaceSystem Sp
 
 GReal GAnimTRSNode2D::Rotation(const GTimeValue TimePos, const GSpaceSystem Space, GTimeInterval& ValidInterval) const {
 
-	GProperty *tmpProp = Property("transform");
-
-	if (!tmpProp)
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[2])
 		return 0;
 
-	tmpProp = tmpProp->Property("rotation");
-	G_ASSERT(tmpProp);
 	GTimeInterval tmpValid = G_FOREVER_TIMEINTERVAL;
 	GKeyValue tmpValue;
 
-	GError err = tmpProp->Value(tmpValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	GError err = gTRSProperties[2]->Value(tmpValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
 	if (err != G_NO_ERROR)
 		return 0;
 
@@ -317,23 +340,16 @@ GReal GAnimTRSNode2D::Rotation(const GTimeValue TimePos, const GSpaceSystem Spac
 
 GVectBase<GReal, 2> GAnimTRSNode2D::Scale(const GTimeValue TimePos, const GSpaceSystem Space, GTimeInterval& ValidInterval) const {
 
-	GProperty *tmpProp = Property("transform");
-
-	if (!tmpProp)
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[3])
 		return GVector2(1, 1);
 
-	tmpProp = tmpProp->Property("scale");
-	G_ASSERT(tmpProp);
 	GTimeInterval tmpValid = G_FOREVER_TIMEINTERVAL;
 	GKeyValue xValue, yValue;
 
 	// extract scale
-	GProperty *xProp = tmpProp->Property("x");
-	GProperty *yProp = tmpProp->Property("y");
-	G_ASSERT(xProp != NULL);
-	G_ASSERT(yProp != NULL);
-	GError xErr = xProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	GError yErr = yProp->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	GError xErr = gTRSProperties[3]->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	GError yErr = gTRSProperties[4]->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
 	if (xErr != G_NO_ERROR || yErr != G_NO_ERROR)
 		return GVector2(1, 1);
 
@@ -383,78 +399,70 @@ GMatrix33 GAnimTRSNode2D::InversePivotMatrix() const {
 		tmpScale[G_Y] = 1 / tmpScale[G_Y];
 	ScaleToMatrix(invScale, tmpScale);
 	// return the resulting (inverse) matrix
-	return (invScale * (invRotation * invTranslation));
+	MultAffine(invRotation, invRotation, invTranslation);
+	return MultAffine(invScale, invScale, invRotation);
 }
 
-GMatrix33 GAnimTRSNode2D::Matrix(const GTimeValue TimePos, const GSpaceSystem Space, GTimeInterval& ValidInterval) const {
+GError GAnimTRSNode2D::LocalMatrix(const GTimeValue TimePos, GMatrix33& Result, GTimeInterval& ValidInterval) const {
 
-	GProperty *tmpProp = Property("transform");
+	GKeyValue values[5];
+	GError err;
+	GUInt32 i;
+
+	Identity(Result);
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[0])
+		return G_NO_ERROR;
+
+	for (i = 0; i < 5; ++i) {
+		err = gTRSProperties[i]->Value(values[i], ValidInterval, TimePos, G_ABSOLUTE_VALUE);
+		if (err != G_NO_ERROR)
+			return err;
+	}
 
-	// this can be the case of a curve not created through a kernel
-	if (!tmpProp) {
+	// translation * (rotation * scale), built directly
+	GReal c = GMath::Cos(values[2].RealValue());
+	GReal s = GMath::Sin(values[2].RealValue());
+	GReal sx = values[3].RealValue();
+	GReal sy = values[4].RealValue();
+
+	Result[0][0] = c * sx;
+	Result[0][1] = -s * sy;
+	Result[0][2] = values[0].RealValue();
+	Result[1][0] = s * sx;
+	Result[1][1] = c * sy;
+	Result[1][2] = values[1].RealValue();
+	return G_NO_ERROR;
+}
+
+GMatrix33 GAnimTRSNode2D::Matrix(const GTimeValue TimePos, const GSpaceSystem Space, GTimeInterval& ValidInterval) const {
+
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[0]) {
 		ValidInterval = G_FOREVER_TIMEINTERVAL;
 		return GMatrix33();
 	}
 
-	GMatrix33 translation;
-	GMatrix33 rotation;
-	GMatrix33 scale;
+	GMatrix33 localMatrix;
 	GTimeInterval tmpValid = G_FOREVER_TIMEINTERVAL;
-	GKeyValue xValue, yValue;
-	GError xErr, yErr;
-	GProperty *transProp = tmpProp->Property("position");
-	GProperty *rotProp = tmpProp->Property("rotation");
-	GProperty *scaleProp = tmpProp->Property("scale");
 
-	G_ASSERT(transProp != NULL);
-	G_ASSERT(rotProp != NULL);
-	G_ASSERT(scaleProp != NULL);
-
-	// extract translation
-	GProperty *xProp = transProp->Property("x");
-	GProperty *yProp = transProp->Property("y");
-	G_ASSERT(xProp != NULL);
-	G_ASSERT(yProp != NULL);
-	// build translation factor
-	xErr = xProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	yErr = yProp->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	if (xErr != G_NO_ERROR || yErr != G_NO_ERROR)
-		return GMatrix33();
-	TranslationToMatrix(translation, GVector2(xValue.RealValue(), yValue.RealValue()));
-	// build rotation factor
-	xErr = rotProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	if (xErr != G_NO_ERROR)
-		return GMatrix33();
-	RotationToMatrix(rotation, xValue.RealValue());
-	// extract scale
-	xProp = scaleProp->Property("x");
-	yProp = scaleProp->Property("y");
-	G_ASSERT(xProp != NULL);
-	G_ASSERT(yProp != NULL);
-	// build scale factor
-	xErr = xProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	yErr = yProp->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	if (xErr != G_NO_ERROR || yErr != G_NO_ERROR)
+	if (LocalMatrix(TimePos, localMatrix, tmpValid) != G_NO_ERROR)
 		return GMatrix33();
-	ScaleToMatrix(scale, GVector2(xValue.RealValue(), yValue.RealValue()));
 
 	ValidInterval = tmpValid;
 	// take care of father
-	GMatrix33 localMatrix = (translation * (rotation * scale));
 	if (gFather && Space == G_WORLD_SPACE) {
 		GMatrix33 fatherMatrix = gFather->Matrix(TimePos, G_WORLD_SPACE, tmpValid);
 		ValidInterval &= tmpValid;
-		return (fatherMatrix * localMatrix);
+		MultAffine(localMatrix, fatherMatrix, localMatrix);
 	}
 	return localMatrix;
 }
 
 GMatrix33 GAnimTRSNode2D::InverseMatrix(const GTimeValue TimePos, const GSpaceSystem Space, GTimeInterval& ValidInterval) const {
 
-	GProperty *tmpProp = Property("transform");
-
-	// this can be the case of a curve not created through a kernel
-	if (!tmpProp) {
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[0]) {
 		ValidInterval = G_FOREVER_TIMEINTERVAL;
 		return GMatrix33();
 	}
@@ -465,40 +473,23 @@ GMatrix33 GAnimTRSNode2D::InverseMatrix(const GTimeValue TimePos, const GSpaceSy
 	GTimeInterval tmpValid = G_FOREVER_TIMEINTERVAL;
 	GKeyValue xValue, yValue;
 	GError xErr, yErr;
-	GProperty *transProp = tmpProp->Property("position");
-	GProperty *rotProp = tmpProp->Property("rotation");
-	GProperty *scaleProp = tmpProp->Property("scale");
 
-	G_ASSERT(transProp != NULL);
-	G_ASSERT(rotProp != NULL);
-	G_ASSERT(scaleProp != NULL);
-
-	// extract translation
-	GProperty *xProp = transProp->Property("x");
-	GProperty *yProp = transProp->Property("y");
-	G_ASSERT(xProp != NULL);
-	G_ASSERT(yProp != NULL);
 	// build translation factor
-	xErr = xProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	yErr = yProp->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	xErr = gTRSProperties[0]->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	yErr = gTRSProperties[1]->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
 	if (xErr != G_NO_ERROR || yErr != G_NO_ERROR)
 		return GMatrix33();
 	TranslationToMatrix(invTranslation, GVector2(-xValue.RealValue(), -yValue.RealValue()));
 
 	// build rotation factor
-	xErr = rotProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	xErr = gTRSProperties[2]->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
 	if (xErr != G_NO_ERROR)
 		return GMatrix33();
 	RotationToMatrix(invRotation, -xValue.RealValue());
 
-	// extract scale
-	xProp = scaleProp->Property("x");
-	yProp = scaleProp->Property("y");
-	G_ASSERT(xProp != NULL);
-	G_ASSERT(yProp != NULL);
 	// build scale factor
-	xErr = xProp->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
-	yErr = yProp->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	xErr = gTRSProperties[3]->Value(xValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
+	yErr = gTRSProperties[4]->Value(yValue, tmpValid, TimePos, G_ABSOLUTE_VALUE);
 	if (xErr != G_NO_ERROR || yErr != G_NO_ERROR)
 		return GMatrix33();
 	GPoint2 tmpScale(1, 1);
@@ -510,221 +501,124 @@ GMatrix33 GAnimTRSNode2D::InverseMatrix(const GTimeValue TimePos, const GSpaceSy
 
 	ValidInterval = tmpValid;
 	// take care of father
-	GMatrix33 invLocalMatrix = (invScale * (invRotation * invTranslation));
+	GMatrix33 invLocalMatrix;
+	MultAffine(invLocalMatrix, invRotation, invTranslation);
+	MultAffine(invLocalMatrix, invScale, invLocalMatrix);
 	if (gFather && Space == G_WORLD_SPACE) {
 		GMatrix33 invFatherMatrix = gFather->InverseMatrix(TimePos, G_WORLD_SPACE, tmpValid);
 		ValidInterval &= tmpValid;
-		return (invLocalMatrix * invFatherMatrix);
+		MultAffine(invLocalMatrix, invLocalMatrix, invFatherMatrix);
 	}
 	return invLocalMatrix;
 }
 
 GError GAnimTRSNode2D::SetPosition(const GTimeValue TimePos, const GVectBase<GReal, 2>& RelPosition) {
 
-	GError err;
-	GProperty *tmpProp = Property("transform");
-	
-	// this can be the case of a curve not created through a kernel
-	if (!tmpProp)
-		err = G_MISSING_KERNEL;
-	else {
-		GKeyValue tmpValue;
-		tmpValue.SetTimePosition(TimePos);
-
-		// extract position track
-		GProperty *posProp = tmpProp->Property("position");
-		G_ASSERT(posProp);
-
-		// set "x" property
-		tmpProp = posProp->Property("x");
-		G_ASSERT(tmpProp != NULL);
-		tmpValue.SetValue(RelPosition[G_X]);
-		err = tmpProp->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
-		if (err != G_NO_ERROR)
-			return err;
-		// set "y" property
-		tmpProp = posProp->Property("y");
-		G_ASSERT(tmpProp != NULL);
-		tmpValue.SetValue(RelPosition[G_Y]);
-		err = tmpProp->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
-	}
-	return err;
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[0])
+		return G_MISSING_KERNEL;
+
+	GKeyValue tmpValue;
+	tmpValue.SetTimePosition(TimePos);
+	gCacheDirty = G_TRUE;
+
+	// set "x" property
+	tmpValue.SetValue(RelPosition[G_X]);
+	GError err = gTRSProperties[0]->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
+	if (err != G_NO_ERROR)
+		return err;
+	// set "y" property
+	tmpValue.SetValue(RelPosition[G_Y]);
+	return gTRSProperties[1]->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
 }
 
 GError GAnimTRSNode2D::SetRotation(const GTimeValue TimePos, const GReal& RelRotation) {
 
-	GError err;
-	GProperty *tmpProp = Property("transform");
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[2])
+		return G_MISSING_KERNEL;
 
-	// this can be the case of a curve not created through a kernel
-	if (!tmpProp)
-		err = G_MISSING_KERNEL;
-	else {
-		// extract position track
-		GProperty *rotProp = tmpProp->Property("rotation");
-		G_ASSERT(rotProp);
-		GKeyValue tmpValue(TimePos, RelRotation);
-		err = rotProp->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
-	}
-	return err;
+	GKeyValue tmpValue(TimePos, RelRotation);
+	gCacheDirty = G_TRUE;
+	return gTRSProperties[2]->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
 }
 
 GError GAnimTRSNode2D::SetScale(const GTimeValue TimePos, const GVectBase<GReal, 2>& RelScale) {
 
-	GError err;
-	GProperty *tmpProp = Property("transform");
+	// this can be the case of a node not created through a kernel
+	if (!gTRSProperties[3])
+		return G_MISSING_KERNEL;
 
-	// this can be the case of a curve not created through a kernel
-	if (!tmpProp) {
-		err = G_MISSING_KERNEL;
-	}
-	else {
-		// extract position track
-		GProperty *scaleProp = tmpProp->Property("scale");
-		G_ASSERT(scaleProp);
-
-		GKeyValue tmpValue;
-		tmpValue.SetTimePosition(TimePos);
-
-		// set "x" property
-		tmpProp = scaleProp->Property("x");
-		G_ASSERT(tmpProp != NULL);
-		tmpValue.SetValue(RelScale[G_X]);
-		err = tmpProp->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
-		if (err != G_NO_ERROR)
-			return err;
-		// set "y" property
-		tmpProp = scaleProp->Property("y");
-		G_ASSERT(tmpProp != NULL);
-		tmpValue.SetValue(RelScale[G_Y]);
-		err = tmpProp->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
-	}
-	return err;
+	GKeyValue tmpValue;
+	tmpValue.SetTimePosition(TimePos);
+	gCacheDirty = G_TRUE;
+
+	// set "x" property
+	tmpValue.SetValue(RelScale[G_X]);
+	GError err = gTRSProperties[3]->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
+	if (err != G_NO_ERROR)
+		return err;
+	// set "y" property
+	tmpValue.SetValue(RelScale[G_Y]);
+	return gTRSProperties[4]->SetValue(tmpValue, TimePos, G_ABSOLUTE_VALUE);
 }
 
-// move all position keys by an additive offset vector
-void GAnimTRSNode2D::OffsetPositionTrack(const GVector2& OffsetVector) {
+// add an offset to all keys of a property (or to its default value, if it has no keys)
+static void OffsetPropertyTrack(GProperty *Prop, const GReal Offset, const GBool Multiplicative) {
 
-	GProperty *tmpProp = Property("transform"), *posProp;
-	GUInt32 i, j;
+	GUInt32 i, j = Prop->KeysCount();
 	GKeyValue tmpKey;
 
-	if (!tmpProp)
-		return;
-
-	posProp = tmpProp->Property("position");
-	G_ASSERT(posProp != NULL);
-	// x-property
-	tmpProp = posProp->Property("x");
-	G_ASSERT(tmpProp != NULL);
-
-	j = tmpProp->KeysCount();
 	if (j == 0) {
-		tmpKey = tmpProp->DefaultValue();
-		tmpKey.SetValue(OffsetVector[G_X] + tmpKey.RealValue());
-		tmpProp->SetDefaultValue(tmpKey);
+		tmpKey = Prop->DefaultValue();
+		if (Multiplicative)
+			tmpKey.SetValue(Offset * tmpKey.RealValue());
+		else
+			tmpKey.SetValue(Offset + tmpKey.RealValue());
+		Prop->SetDefaultValue(tmpKey);
 	}
 	else {
 		for (i = 0; i < j; ++i) {
-			tmpProp->Key(i, tmpKey);
-			tmpKey.SetValue(tmpKey.RealValue() + OffsetVector[G_X]);
-			tmpProp->SetKey(i, tmpKey);
+			Prop->Key(i, tmpKey);
+			if (Multiplicative)
+				tmpKey.SetValue(tmpKey.RealValue() * Offset);
+			else
+				tmpKey.SetValue(tmpKey.RealValue() + Offset);
+			Prop->SetKey(i, tmpKey);
 		}
 	}
+}
 
-	// y-property
-	tmpProp = posProp->Property("y");
-	G_ASSERT(tmpProp != NULL);
+// move all position keys by an additive offset vector
+void GAnimTRSNode2D::OffsetPositionTrack(const GVector2& OffsetVector) {
 
-	j =  tmpProp->KeysCount();
-	if (j == 0) {
-		tmpKey = tmpProp->DefaultValue();
-		tmpKey.SetValue(OffsetVector[G_Y] + tmpKey.RealValue());
-		tmpProp->SetDefaultValue(tmpKey);
-	}
-	else {
-		for (i = 0; i < j; ++i) {
-			tmpProp->Key(i, tmpKey);
-			tmpKey.SetValue(tmpKey.RealValue() + OffsetVector[G_Y]);
-			tmpProp->SetKey(i, tmpKey);
-		}
-	}
+	if (!gTRSProperties[0])
+		return;
+
+	OffsetPropertyTrack(gTRSProperties[0], OffsetVector[G_X], G_FALSE);
+	OffsetPropertyTrack(gTRSProperties[1], OffsetVector[G_Y], G_FALSE);
+	gCacheDirty = G_TRUE;
 }
 
 // move all rotation keys by an additive offset angle (expressed in radiant)
 void GAnimTRSNode2D::OffsetRotationTrack(const GReal OffsetAngle) {
 
-	GProperty *tmpProp = Property("transform"), *rotProp;
-	GUInt32 i, j;
-	GKeyValue tmpKey;
-
-	if (!tmpProp)
+	if (!gTRSProperties[2])
 		return;
 
-	rotProp = tmpProp->Property("rotation");
-	G_ASSERT(rotProp != NULL);
-
-	j = rotProp->KeysCount();
-	if (j == 0) {
-		tmpKey = rotProp->DefaultValue();
-		tmpKey.SetValue(OffsetAngle + tmpKey.RealValue());
-		rotProp->SetDefaultValue(tmpKey);
-	}
-	else {
-		for (i = 0; i < j; ++i) {
-			rotProp->Key(i, tmpKey);
-			rotProp->SetValue(tmpKey.RealValue() + OffsetAngle);
-			rotProp->SetKey(i, tmpKey);
-		}
-	}
+	OffsetPropertyTrack(gTRSProperties[2], OffsetAngle, G_FALSE);
+	gCacheDirty = G_TRUE;
 }
 
 // scale all scaling keys by an offset factor
 void GAnimTRSNode2D::OffsetScaleTrack(const GVectBase<GReal, 2>& OffsetFactors) {
 
-	GProperty *tmpProp = Property("transform"), *sclProp;
-	GUInt32 i, j;
-	GKeyValue tmpKey;
-
-	if (!tmpProp)
+	if (!gTRSProperties[3])
 		return;
 
-	sclProp = tmpProp->Property("scale");
-	G_ASSERT(sclProp != NULL);
-
-	// x-property
-	tmpProp = sclProp->Property("x");
-	G_ASSERT(tmpProp != NULL);
-	j = tmpProp->KeysCount();
-	if (j == 0) {
-		tmpKey = tmpProp->DefaultValue();
-		tmpKey.SetValue(OffsetFactors[G_X] * tmpKey.RealValue());
-		tmpProp->SetDefaultValue(tmpKey);
-	}
-	else {
-		for (i = 0; i < j; ++i) {
-			tmpProp->Key(i, tmpKey);
-			tmpKey.SetValue(tmpKey.RealValue() * OffsetFactors[G_X]);
-			tmpProp->SetKey(i, tmpKey);
-		}
-	}
-
-	// y-property
-	tmpProp = sclProp->Property("y");
-	G_ASSERT(tmpProp != NULL);
-	j =  tmpProp->KeysCount();
-	if (j == 0) {
-		tmpKey = tmpProp->DefaultValue();
-		tmpKey.SetValue(OffsetFactors[G_Y] * tmpKey.RealValue());
-		tmpProp->SetDefaultValue(tmpKey);
-	}
-	else {
-		for (i = 0; i < j; ++i) {
-			tmpProp->Key(i, tmpKey);
-			tmpKey.SetValue(tmpKey.RealValue() * OffsetFactors[G_Y]);
-			tmpProp->SetKey(i, tmpKey);
-		}
-	}
+	OffsetPropertyTrack(gTRSProperties[3], OffsetFactors[G_X], G_TRUE);
+	OffsetPropertyTrack(gTRSProperties[4], OffsetFactors[G_Y], G_TRUE);
+	gCacheDirty = G_TRUE;
 }
 
 GError GAnimTRSNode2D::SetPivotPosition(const GVectBase<GReal, 2>& NewPosition, const GBool AffectChildren) {
@@ -835,7 +729,107 @@ GError GAnimTRSNode2D::BaseClone(const GElement& Source) {
 	gPivotRotation = s.gPivotRotation;
 	gPivotScale = s.gPivotScale;
 	// give the control to base class
-	return GAnimElement::BaseClone(Source);
+	GError err = GAnimElement::BaseClone(Source);
+	// properties have been rebuilt, so old pointers are no more valid
+	ResolveTRSProperties();
+	gCacheDirty = G_TRUE;
+	return err;
+}
+
+void GAnimTRSNode2D::UpdateCache(const GTimeValue TimePos, const GMatrix33 *FatherMatrix, const GTimeInterval& FatherValid) {
+
+	// NB: validity intervals of animated tracks are degenerated ([t, t]), so they are considered empty
+	if (gCacheDirty || (TimePos != gCacheTime && (gLocalValidInterval.IsEmpty() ||
+												 !gLocalValidInterval.IsInInterval(TimePos)))) {
+		gLocalValidInterval = G_FOREVER_TIMEINTERVAL;
+		if (LocalMatrix(TimePos, gLocalMatrix, gLocalValidInterval) != G_NO_ERROR) {
+			Identity(gLocalMatrix);
+			gLocalValidInterval.Set(TimePos, TimePos);
+		}
+		gCacheDirty = G_FALSE;
+	}
+	gCacheTime = TimePos;
+
+	if (FatherMatrix) {
+		MultAffine(gWorldMatrix, *FatherMatrix, gLocalMatrix);
+		gWorldValidInterval = FatherValid;
+		gWorldValidInterval &= gLocalValidInterval;
+	}
+	else {
+		gWorldMatrix = gLocalMatrix;
+		gWorldValidInterval = gLocalValidInterval;
+	}
+}
+
+void GAnimTRSNode2D::UpdateCacheHierarchy(const GTimeValue TimePos, const GMatrix33 *FatherMatrix,
+										  const GTimeInterval& FatherValid) {
+
+	GDynArray<GAnimTRSNode2D *> stack;
+	GAnimTRSNode2D *node;
+	GUInt32 i, j;
+
+	UpdateCache(TimePos, FatherMatrix, FatherValid);
+	for (i = 0; i < (GUInt32)gChildren.size(); ++i)
+		stack.push_back(gChildren[i]);
+
+	// depth-first visit; a node is always pushed after its father has been updated
+	while (!stack.empty()) {
+		node = stack.back();
+		stack.pop_back();
+		node->UpdateCache(TimePos, &node->gFather->gWorldMatrix, node->gFather->gWorldValidInterval);
+		j = (GUInt32)node->gChildren.size();
+		for (i = 0; i < j; ++i)
+			stack.push_back(node->gChildren[i]);
+	}
+}
+
+struct GTRSSubtreesJob {
+	GDynArray<GAnimTRSNode2D *> Roots;
+	GTimeValue TimePos;
+};
+
+void GAnimTRSNode2D::UpdateSubtreeJob(void *Data, const GUInt32 JobIndex) {
+
+	GTRSSubtreesJob *job = (GTRSSubtreesJob *)Data;
+	GAnimTRSNode2D *node = job->Roots[JobIndex];
+
+	node->UpdateCacheHierarchy(job->TimePos, &node->gFather->gWorldMatrix, node->gFather->gWorldValidInterval);
+}
+
+GError GAnimTRSNode2D::EvaluateHierarchy(const GTimeValue TimePos, GThreadPool *Pool) {
+
+	GMatrix33 fatherMatrix;
+	GTimeInterval fatherValid = G_FOREVER_TIMEINTERVAL;
+
+	// an inner node takes its father's world matrix from the exact (uncached) evaluation
+	if (gFather)
+		fatherMatrix = gFather->Matrix(TimePos, G_WORLD_SPACE, fatherValid);
+
+	if (!Pool || Pool->ThreadsCount() < 2) {
+		UpdateCacheHierarchy(TimePos, (gFather) ? &fatherMatrix : NULL, fatherValid);
+		return G_NO_ERROR;
+	}
+
+	// expand the hierarchy level by level, until there are enough subtrees to keep all threads busy
+	GTRSSubtreesJob job;
+	GDynArray<GAnimTRSNode2D *> nextLevel;
+	GUInt32 i, j, k, minSubtrees = Pool->ThreadsCount() * 4;
+
+	UpdateCache(TimePos, (gFather) ? &fatherMatrix : NULL, fatherValid);
+	job.TimePos = TimePos;
+	job.Roots = gChildren;
+	while (!job.Roots.empty() && (GUInt32)job.Roots.size() < minSubtrees) {
+		nextLevel.clear();
+		j = (GUInt32)job.Roots.size();
+		for (i = 0; i < j; ++i) {
+			GAnimTRSNode2D *node = job.Roots[i];
+			node->UpdateCache(TimePos, &node->gFather->gWorldMatrix, node->gFather->gWorldValidInterval);
+			for (k = 0; k < (GUInt32)node->gChildren.size(); ++k)
+				nextLevel.push_back(node->gChildren[k]);
+		}
+		job.Roots.swap(nextLevel);
+	}
+	return Pool->Run(UpdateSubtreeJob, (void *)&job, (GUInt32)job.Roots.size());
 }
 
 }
@@ -102,6 +102,15 @@ GError GBezierCurve2D::SetPoint(const GUInt32 Index, const GPoint2& NewPoint) {
 	return G_NO_ERROR;
 }
 
+// get control points array for in place modification
+GPoint2 *GBezierCurve2D::PointsBuffer() {
+
+	if (gPoints.size() == 0)
+		return NULL;
+	gModified = G_TRUE;
+	return &gPoints[0];
+}
+
 // set control points
 GError GBezierCurve2D::SetPoints(const GDynArray<GPoint2>& NewPoints) {
 
@@ -666,6 +675,168 @@ GVector2 GBezierCurve2D::Derivative(const GDerivativeOrder Order, const GReal u)
 	return tmpPoint;
 }
 
+// inverse hyperbolic sine, written to be accurate for negative values too
+static GReal ArcSinh(const GReal x) {
+
+	if (x < 0)
+		return -GMath::Log(-x + GMath::Sqrt(x * x + 1));
+	return GMath::Log(x + GMath::Sqrt(x * x + 1));
+}
+
+// returns the length of the curve between the 2 specified global parameter values
+GReal GBezierCurve2D::Length(const GReal u0, const GReal u1, const GReal MaxError) const {
+
+	GReal t0, t1, l, a2, b2, ab, d, s0, s1, f0, f1;
+	GVector2 a, b;
+	GInt32 n = Degree();
+
+	l = Domain().Length();
+	if (n < 1 || n > 2 || l <= 0)
+		return GCurve2D::Length(u0, u1, MaxError);
+
+	// local parameters, clamped inside the domain like Derivative() does
+	t0 = (GMath::Clamp(GMath::Min(u0, u1), DomainStart(), DomainEnd()) - DomainStart()) / l;
+	t1 = (GMath::Clamp(GMath::Max(u0, u1), DomainStart(), DomainEnd()) - DomainStart()) / l;
+
+	a = gPoints[1] - gPoints[0];
+	if (n == 1)
+		return (t1 - t0) * a.Length();
+
+	// the speed of a quadratic curve is 2 * |a + t * b|; writing s = t + (a.b) / (b.b) and d = |a x b| / (b.b),
+	// it becomes 2 * |b| * Sqrt(s^2 + d^2), that has the closed form primitive:
+	// |b| * (s * Sqrt(s^2 + d^2) + d^2 * ArcSinh(s / d))
+	b = (gPoints[2] - gPoints[1]) - a;
+	a2 = a.LengthSquared();
+	b2 = b.LengthSquared();
+	// almost constant speed, the curve is a (uniformly parametrized) segment
+	if (b2 <= G_EPSILON * a2) {
+		a += ((t0 + t1) * (GReal)0.5) * b;
+		return 2 * (t1 - t0) * a.Length();
+	}
+
+	ab = Dot(a, b);
+	s0 = t0 + ab / b2;
+	s1 = t1 + ab / b2;
+	d = GMath::Abs(Cross(a, b)) / b2;
+	f0 = s0 * GMath::Sqrt(s0 * s0 + d * d);
+	f1 = s1 * GMath::Sqrt(s1 * s1 + d * d);
+	// for collinear control points (d = 0) the ArcSinh terms vanish
+	if (d > G_EPSILON * GMath::Max(GMath::Abs(s0), GMath::Abs(s1))) {
+		f0 += d * d * ArcSinh(s0 / d);
+		f1 += d * d * ArcSinh(s1 / d);
+	}
+	return GMath::Sqrt(b2) * (f1 - f0);
+}
+
+// batched evaluations switch to the power basis up to this degree; for higher degrees the Horner-Bezier
+// scheme is numerically safer
+#define G_BEZIER_POWER_BASIS_MAX_DEGREE 4
+
+// convert Bezier control points into power basis coefficients, so that
+// C(t) = Coeffs[0] + t * (Coeffs[1] + t * (Coeffs[2] + ...)); Coeffs[k] is Binomial(n, k) times the
+// k-th forward difference of control points
+static void BezierPowerBasis(const GPoint2 *Points, const GInt32 Degree, GPoint2 *Coeffs) {
+
+	GPoint2 diff[G_BEZIER_POWER_BASIS_MAX_DEGREE + 1];
+	GReal binomial = 1;
+	GInt32 i, k;
+
+	G_ASSERT(Degree <= G_BEZIER_POWER_BASIS_MAX_DEGREE);
+
+	for (i = 0; i <= Degree; i++)
+		diff[i] = Points[i];
+	for (k = 0; k <= Degree; k++) {
+		Coeffs[k] = binomial * diff[0];
+		for (i = 0; i < Degree - k; i++)
+			diff[i] = diff[i + 1] - diff[i];
+		binomial = (binomial * (Degree - k)) / (k + 1);
+	}
+}
+
+// evaluate the curve at several global parameters
+void GBezierCurve2D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const {
+
+	GPoint2 coeffs[G_BEZIER_POWER_BASIS_MAX_DEGREE + 1], tmpPoint;
+	GReal t, u, uStart, uEnd, invLength;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GInt32 k, n = Degree();
+
+	Out.resize(j);
+	// degree must be at least one
+	if (n <= 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = GPoint2(G_MIN_REAL, G_MIN_REAL);
+		return;
+	}
+	if (n > G_BEZIER_POWER_BASIS_MAX_DEGREE) {
+		for (i = 0; i < j; i++)
+			Out[i] = GBezierCurve2D::Evaluate(Params[i]);
+		return;
+	}
+
+	BezierPowerBasis(&gPoints[0], n, coeffs);
+	uStart = DomainStart();
+	uEnd = DomainEnd();
+	invLength = 1 / Domain().Length();
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// check for global parameter out of range
+		if (u <= uStart)
+			Out[i] = gPoints[0];
+		else
+		if (u >= uEnd)
+			Out[i] = gPoints[n];
+		else {
+			t = (u - uStart) * invLength;
+			tmpPoint = coeffs[n];
+			for (k = n - 1; k >= 0; k--)
+				tmpPoint = tmpPoint * t + coeffs[k];
+			Out[i] = tmpPoint;
+		}
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GBezierCurve2D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const {
+
+	GPoint2 coeffs[G_BEZIER_POWER_BASIS_MAX_DEGREE + 1], tmpPoint;
+	GReal t, uStart, invLength;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GInt32 k, n = Degree() - Order;
+
+	Out.resize(j);
+	// in this case derivate is null (ex: third derivate of a quadratic Bezier curve)
+	if (n < 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_NULL_POINT2;
+		return;
+	}
+	if (n > G_BEZIER_POWER_BASIS_MAX_DEGREE) {
+		for (i = 0; i < j; i++)
+			Out[i] = GBezierCurve2D::Derivative(Order, Params[i]);
+		return;
+	}
+	// if any point has been changed we have to recalculate forward differences
+	if (gModified)
+		BuildForwDiff();
+
+	if (Order == G_FIRST_ORDER_DERIVATIVE)
+		BezierPowerBasis(&gForwDiff1[0], n, coeffs);
+	else
+		BezierPowerBasis(&gForwDiff2[0], n, coeffs);
+
+	uStart = DomainStart();
+	invLength = 1 / Domain().Length();
+	for (i = 0; i < j; i++) {
+		// clamp parameter inside valid interval
+		t = GMath::Clamp((Params[i] - uStart) * invLength, (GReal)0, (GReal)1);
+		tmpPoint = coeffs[n];
+		for (k = n - 1; k >= 0; k--)
+			tmpPoint = tmpPoint * t + coeffs[k];
+		Out[i] = tmpPoint;
+	}
+}
+
 // cut the curve, giving the 2 new set of control points that represents 2 Bezier curve (with the
 // same degree of the original one)
 // We use De Casteljau's Algorithm
@@ -32,10 +32,11 @@
 #include "amanith/geometry/gxformconv.h"
 #include "amanith/geometry/gxform.h"
 #include "amanith/gerror.h"
+#include <algorithm>
 
 /*!
 	\file gbsplinecurve2d.cpp
-	\brief Implementation of 2D BSpline curve class.
+	\brief Implementation of 2D BSpline curve and BSpline fitter classes.
 */
 namespace Amanith {
 
@@ -111,6 +112,15 @@ GError GBSplineCurve2D::SetPoint(const GUInt32 Index, const GPoint2& NewPoint) {
 	return G_NO_ERROR;
 }
 
+// get control points array for in place modification
+GPoint2 *GBSplineCurve2D::PointsBuffer() {
+
+	if (gPoints.size() == 0)
+		return NULL;
+	gModified = G_TRUE;
+	return &gPoints[0];
+}
+
 // set control points
 GError GBSplineCurve2D::SetPoints(const GDynArray<GPoint2>& NewPoints, const GInt32 Degree,
 								  const GBool Opened, const GBool Uniform) {
@@ -670,6 +680,25 @@ GInt32 GBSplineCurve2D::FindSpan(const GReal u) const {
 	return -1;
 }
 
+// find knot span, starting from a span not greater than the searched one
+GInt32 GBSplineCurve2D::FindSpan(const GReal u, const GInt32 SpanHint) const {
+
+	GInt32 i, j;
+
+	j = (GInt32)gKnots.size() - 1;
+	if (SpanHint < 0 || SpanHint >= j || u < gKnots[SpanHint])
+		return FindSpan(u);
+	if (gOpened) {
+		if (u >= DomainEnd())
+			return (GInt32)PointsCount() - 1;
+	}
+	// knots are not decreasing, so spans before the hint can't contain the parameter
+	for (i = SpanHint; i < j; i++)
+		if (u < gKnots[i + 1])
+			return i;
+	return -1;
+}
+
 // find at the same time knot span and its multiplicity
 GInt32 GBSplineCurve2D::FindSpanMult(const GReal u, GInt32& Multiplicity) const {
 
@@ -1014,6 +1043,76 @@ GVector2 GBSplineCurve2D::Derivative(const GDerivativeOrder Order, const GReal u
 }
 
 
+// evaluate the curve at several global parameters
+void GBSplineCurve2D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const {
+
+	GPoint2 tmpPoint;
+	GInt32 k, span = -1;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GReal uu, *c;
+
+	Out.resize(j);
+	if (PointsCount() == 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_NULL_POINT2;
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		// clamp parameter inside valid interval
+		uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+		// the previous span is a good starting point for sorted parameters
+		span = FindSpan(uu, span);
+		c = BasisFunctions(span, gDegree, uu);
+		tmpPoint = G_NULL_POINT2;
+		for (k = 0; k <= gDegree; k++)
+			tmpPoint += c[k] * gPoints[span - gDegree + k];
+		Out[i] = tmpPoint;
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GBSplineCurve2D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const {
+
+	GPoint2 tmpPoint;
+	GInt32 k, span = -1;
+	GUInt32 i, j = (GUInt32)Params.size();
+	GReal uu, *c;
+
+	Out.resize(j);
+	if (PointsCount() == 0) {
+		for (i = 0; i < j; i++)
+			Out[i] = G_NULL_POINT2;
+		return;
+	}
+	// for clamped splines forward differences are used
+	if (gOpened && gModified)
+		BuildForwDiff();
+
+	for (i = 0; i < j; i++) {
+		// clamp parameter inside valid interval
+		uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+		span = FindSpan(uu, span);
+		tmpPoint = G_NULL_POINT2;
+		if (gOpened) {
+			c = BasisFunctions(span, gDegree - Order, uu);
+			if (Order == G_FIRST_ORDER_DERIVATIVE)
+				for (k = 0; k <= gDegree - Order; k++)
+					tmpPoint += c[k] * gForwDiff1[span - gDegree + k];
+			else
+			if (Order == G_SECOND_ORDER_DERIVATIVE)
+				for (k = 0; k <= gDegree - Order; k++)
+					tmpPoint += c[k] * gForwDiff2[span - gDegree + k];
+		}
+		else {
+			c = BasisFuncDerivatives(Order, span, gDegree, uu);
+			for (k = 0; k <= gDegree; k++)
+				tmpPoint += c[k] * gPoints[span - gDegree + k];
+		}
+		Out[i] = tmpPoint;
+	}
+}
+
 // decreases by one the degree of the curve
 GError GBSplineCurve2D::LowerDegree() {
 
@@ -1692,35 +1791,29 @@ static void BandedBackSubstitution(GDynArray<GReal>& a, const GInt32 n, const GI
 }
 
 
+// set an element of a banded matrix stored in compact form (see SolveBandedSystem); elements outside the band
+// are discarded
+static void SetBandElement(GDynArray<GReal>& CompactMatrix, const GInt32 LeftSemiBandWidth,
+						   const GInt32 RightSemiBandWidth, const GInt32 i, const GInt32 j, const GReal Value) {
+
+	if (j - i < -LeftSemiBandWidth || j - i > RightSemiBandWidth)
+		return;
+	CompactMatrix[i * (LeftSemiBandWidth + RightSemiBandWidth + 1) + j - i + LeftSemiBandWidth] = Value;
+}
+
 // resolve banded system for curve fitting
-GError GBSplineCurve2D::SolveBandedSystem(const GDynArray<GReal>& BasisMatrix, const GInt32 MatrixSize,
+GError GBSplineCurve2D::SolveBandedSystem(GDynArray<GReal>& CompactMatrix, const GInt32 MatrixSize,
 										  const GInt32 LeftSemiBandWidth, const GInt32 RightSemiBandWidth,
 										  GDynArray<GPoint2>& Rhs) {
 
-	GInt32 i, j;
+	G_ASSERT((GInt32)CompactMatrix.size() == MatrixSize * (LeftSemiBandWidth + RightSemiBandWidth + 1));
 
-	// construct compact representation of basis functions matrix
-	GDynArray<GReal> compactMatrix(MatrixSize * (LeftSemiBandWidth + RightSemiBandWidth + 1), 0);
-	#define CMATRIX(i, j) compactMatrix[(i)*(LeftSemiBandWidth + RightSemiBandWidth + 1) + (j)]
-	#define MATRIX(i, j) BasisMatrix[(i)*MatrixSize + (j)]
-
-	// copy diagonal and superdiagonal elements
-	for (i = 0; i <= RightSemiBandWidth; i++)
-		for (j = 0; j <= MatrixSize - 1 - i; j++)
-			CMATRIX(j, LeftSemiBandWidth + i) = MATRIX(j, i + j);
-	// copy subdiagonal
-	for (i = 1; i <= LeftSemiBandWidth; i++)
-		for (j = 0; j <= MatrixSize - 1 - i; j++)
-			CMATRIX(j + i, LeftSemiBandWidth - i) = MATRIX(i + j, j);
 	// resolve banded linear system
 	GDynArray<GReal> al(MatrixSize * LeftSemiBandWidth);
 	GDynArray<GInt32> indx(MatrixSize);
 
-	BandEncodec(compactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx);
-	BandedBackSubstitution(compactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx, Rhs);
-
-	#undef CMATRIX
-	#undef MATRIX
+	BandEncodec(CompactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx);
+	BandedBackSubstitution(CompactMatrix, MatrixSize, LeftSemiBandWidth, RightSemiBandWidth, al, indx, Rhs);
 	return G_NO_ERROR;
 }
 
@@ -1732,11 +1825,12 @@ GError GBSplineCurve2D::GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>&
 		return G_INVALID_PARAMETER;
 
 	GInt32 n = (GInt32)FitPoints.size() - 1, m = n + Degree + 1, i, j, span;
-	GDynArray<GReal> matrix((n + 1) * (n + 1), 0);
+	// basis functions matrix, only its band is stored (Degree - 1 elements on each side of the diagonal)
+	GDynArray<GReal> matrix((n + 1) * (2 * Degree - 1), 0);
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk;
 	GReal *basisFuncs;
-	#define MATRIX(i, j) matrix[(i)*(n + 1) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1745,18 +1839,21 @@ GError GBSplineCurve2D::GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>&
 	SetPoints(FitPoints, knots, Degree, G_FALSE);
 
 	// build basis functions matrix
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build i-th row
 		for (j = 0; j <= Degree; j++)
-			MATRIX(i, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(i, span - Degree + j, basisFuncs[j]);
 	}
 	// build first and last row
-	MATRIX(0, 0) = MATRIX(n, n) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
+	SET_MATRIX(n, n, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, n + 1, Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 // curve (global) fitting with first derivative specified at end points
@@ -1774,12 +1871,12 @@ GError GBSplineCurve2D::GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>&
 	else
 		m = n + Degree + 3;
 
-	GDynArray<GReal> matrix((n + 3) * (n + 3), 0);
+	GDynArray<GReal> matrix((n + 3) * (2 * Degree - 1), 0);
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk(n + 1);
 	GDynArray<GPoint2> rhs(n + 3);
 	GReal *basisFuncs, oneOverDegree;
-	#define MATRIX(i, j) matrix[(i)*(n + 3) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1807,26 +1904,28 @@ GError GBSplineCurve2D::GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>&
 	SetPoints(rhs, knots, Degree, G_FALSE);
 
 	// build basis functions matrix
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build i-th row
 		for (j = 0; j <= Degree; j++)
-			MATRIX(i + 1, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(i + 1, span - Degree + j, basisFuncs[j]);
 	}
 	// build first row
-	MATRIX(0, 0) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
 	// build second row (first derivative condition)
-	MATRIX(1, 0) = -1;
-	MATRIX(1, 1) = 1;
+	SET_MATRIX(1, 0, -1);
+	SET_MATRIX(1, 1, 1);
 	// build "last but one" row (first derivative condition)
-	MATRIX(n + 1, n + 1) = -1;
-	MATRIX(n + 1, n + 2) = 1;
+	SET_MATRIX(n + 1, n + 1, -1);
+	SET_MATRIX(n + 1, n + 2, 1);
 	// build last row
-	MATRIX(n + 2, n + 2) = (GReal)1;
+	SET_MATRIX(n + 2, n + 2, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, n + 3, Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 // curve (global) natural (second derivaives = 0) fitting
@@ -1843,12 +1942,12 @@ GError GBSplineCurve2D::GlobalNaturalFit(const GInt32 Degree, const GDynArray<GP
 	else
 		m = n + Degree + 3;
 
-	GDynArray<GReal> matrix((n + 3) * (n + 3), 0);
+	GDynArray<GReal> matrix((n + 3) * (2 * Degree - 1), 0);
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk(n + 1);
 	GDynArray<GPoint2> rhs(n + 3);
 	GReal *basisFuncs, c;
-	#define MATRIX(i, j) matrix[(i)*(n + 3) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -1876,32 +1975,34 @@ GError GBSplineCurve2D::GlobalNaturalFit(const GInt32 Degree, const GDynArray<GP
 	SetPoints(rhs, knots, Degree, G_FALSE);
 
 	// build basis functions matrix
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build i-th row
 		for (j = 0; j <= Degree; j++)
-			MATRIX(i + 1, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(i + 1, span - Degree + j, basisFuncs[j]);
 	}
 	// build first row
-	MATRIX(0, 0) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
 	// build second row (second derivative condition)
 	c = (GReal)Degree * (GReal)(Degree - 1);
 	c = c / (knots[Degree + 1] - MinKnotValue);
-	MATRIX(1, 0) = c / (knots[Degree + 1] - MinKnotValue);
-	MATRIX(1, 1) = -c * ((knots[Degree + 1] - MinKnotValue) + (knots[Degree + 2] - MinKnotValue)) / ((knots[Degree + 1] - MinKnotValue) * (knots[Degree + 2] - MinKnotValue));
-	MATRIX(1, 2) = c / (knots[Degree + 2] - MinKnotValue);
+	SET_MATRIX(1, 0, c / (knots[Degree + 1] - MinKnotValue));
+	SET_MATRIX(1, 1, -c * ((knots[Degree + 1] - MinKnotValue) + (knots[Degree + 2] - MinKnotValue)) / ((knots[Degree + 1] - MinKnotValue) * (knots[Degree + 2] - MinKnotValue)));
+	SET_MATRIX(1, 2, c / (knots[Degree + 2] - MinKnotValue));
 	// build "last but one" row (second derivative condition)
 	c = (GReal)Degree * (GReal)(Degree - 1);
 	c = c / (MaxKnotValue - knots[m - Degree - 1]);
-	MATRIX(n + 1, n) = c / (MaxKnotValue - knots[m - Degree - 2]);
-	MATRIX(n + 1, n + 1) = -c * ((2 * MaxKnotValue - knots[m - Degree - 1] - knots[m - Degree - 2]) / ((MaxKnotValue - knots[m - Degree - 1]) * (MaxKnotValue - knots[m - Degree - 2])));
-	MATRIX(n + 1, n + 2) = c / (MaxKnotValue - knots[m - Degree - 1]);
+	SET_MATRIX(n + 1, n, c / (MaxKnotValue - knots[m - Degree - 2]));
+	SET_MATRIX(n + 1, n + 1, -c * ((2 * MaxKnotValue - knots[m - Degree - 1] - knots[m - Degree - 2]) / ((MaxKnotValue - knots[m - Degree - 1]) * (MaxKnotValue - knots[m - Degree - 2]))));
+	SET_MATRIX(n + 1, n + 2, c / (MaxKnotValue - knots[m - Degree - 1]));
 	// build last row
-	MATRIX(n + 2, n + 2) = (GReal)1;
+	SET_MATRIX(n + 2, n + 2, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, n + 3, Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
 }
 
 // curve (global) fitting with first derivative specified at each point
@@ -1922,12 +2023,12 @@ GError GBSplineCurve2D::GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>&
 	else
 		m = (n + Degree + 1) + (n + 1);
 
-	GDynArray<GReal> matrix(2 * (n + 1) * 2 * (n + 1), 0);
+	GDynArray<GReal> matrix(2 * (n + 1) * (2 * Degree - 1), 0);
 	GDynArray<GPoint2> rhs(2 * (n + 1));
 	GDynArray<GReal> knots(m + 1);
 	GDynArray<GReal> uk(n + 1);
 	GReal *basisFuncs, *derFuncs, oneOverDegree, u;
-	#define MATRIX(i, j) matrix[(i) * (2 * (n + 1)) + (j)]
+	#define SET_MATRIX(i, j, Value) SetBandElement(matrix, Degree - 1, Degree - 1, i, j, Value)
 
 	// generate knot vector (and intermediate ones)
 	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
@@ -2005,32 +2106,321 @@ GError GBSplineCurve2D::GlobalFit(const GInt32 Degree, const GDynArray<GPoint2>&
 
 	// build basis functions matrix
 	k = 2;
+	// parameters are increasing, so each span search can start from the previous span
+	span = 0;
 	for (i = 1; i <= n - 1; i++) {
-		span = FindSpan(uk[i]);
+		span = FindSpan(uk[i], span);
 		basisFuncs = BasisFunctions(span, Degree, uk[i]);
 		// build row corresponding to the point interpolation condition
 		for (j = 0; j <= Degree; j++)
-			MATRIX(k, span - Degree + j) = basisFuncs[j];
+			SET_MATRIX(k, span - Degree + j, basisFuncs[j]);
 		// build row corresponding to the derivative interpolation condition
 		k++;
 		derFuncs = BasisFuncDerivatives(G_FIRST_ORDER_DERIVATIVE, span, Degree, uk[i]);
 		for (j = 0; j <= Degree; j++)
-			MATRIX(k, span - Degree + j) = derFuncs[j];
+			SET_MATRIX(k, span - Degree + j, derFuncs[j]);
 		k++;
 	}
 	// build first row
-	MATRIX(0, 0) = (GReal)1;
+	SET_MATRIX(0, 0, (GReal)1);
 	// build second row (first derivative condition)
-	MATRIX(1, 0) = -1;
-	MATRIX(1, 1) = 1;
+	SET_MATRIX(1, 0, -1);
+	SET_MATRIX(1, 1, 1);
 	// build "last but one" row (first derivative condition)
-	MATRIX(2 * (n + 1) - 2 , 2 * (n + 1) - 2) = -1;
-	MATRIX(2 * (n + 1) - 2, 2 * (n + 1) - 1) = 1;
+	SET_MATRIX(2 * (n + 1) - 2 , 2 * (n + 1) - 2, -1);
+	SET_MATRIX(2 * (n + 1) - 2, 2 * (n + 1) - 1, 1);
 	// build last row
-	MATRIX(2 * (n + 1) - 1, 2 * (n + 1) - 1) = (GReal)1;
+	SET_MATRIX(2 * (n + 1) - 1, 2 * (n + 1) - 1, (GReal)1);
 	// resolve the system
 	return SolveBandedSystem(matrix, 2 * (n + 1), Degree - 1, Degree - 1, gPoints);
-	#undef MATRIX
+	#undef SET_MATRIX
+}
+
+// weighted least-squares curve approximation
+GError GBSplineCurve2D::LeastSquaresFit(const GInt32 Degree, const GInt32 ControlPointsCount,
+										const GDynArray<GPoint2>& FitPoints, const GDynArray<GReal>& Weights,
+										const GReal MinKnotValue, const GReal MaxKnotValue) {
+
+	GInt32 m = (GInt32)FitPoints.size(), i, j;
+
+	if ((Degree <= 0) || (ControlPointsCount <= Degree) || (ControlPointsCount > m))
+		return G_INVALID_PARAMETER;
+	if (MinKnotValue >= MaxKnotValue)
+		return G_INVALID_PARAMETER;
+	if (Weights.size() > 0 && (GInt32)Weights.size() != m)
+		return G_INVALID_PARAMETER;
+
+	GBSplineCurveFitter2D fitter;
+	GDynArray<GReal> uk;
+	GDynArray<GReal> knots(ControlPointsCount + Degree + 1);
+	GReal d, t, alpha;
+	GError err;
+
+	// parametrize fit points
+	ChordLengthKnots(uk, FitPoints, MinKnotValue, MaxKnotValue);
+	// build a clamped knot vector, where every knot span contains at least one parameter (see "The NURBS Book",
+	// eq. 9.69)
+	for (i = 0; i <= Degree; i++) {
+		knots[i] = MinKnotValue;
+		knots[ControlPointsCount + i] = MaxKnotValue;
+	}
+	d = (GReal)m / (GReal)(ControlPointsCount - Degree);
+	for (j = 1; j < ControlPointsCount - Degree; j++) {
+		t = j * d;
+		i = (GInt32)t;
+		alpha = t - (GReal)i;
+		knots[Degree + j] = (1 - alpha) * uk[i - 1] + alpha * uk[i];
+	}
+	// accumulate normal equations and solve them
+	err = fitter.SetKnots(Degree, knots);
+	if (err != G_NO_ERROR)
+		return err;
+	err = fitter.AddSamples(uk, FitPoints, Weights);
+	if (err != G_NO_ERROR)
+		return err;
+	return fitter.Solve(*this);
+}
+
+// *********************************************************************
+//                        GBSplineCurveFitter2D
+// *********************************************************************
+
+// constructor
+GBSplineCurveFitter2D::GBSplineCurveFitter2D() : gDegree(0), gUniform(G_FALSE), gSmoothing(0), gSamplesCount(0),
+												 gLastSpan(0) {
+}
+
+// set degree and knots
+GError GBSplineCurveFitter2D::SetKnots(const GInt32 Degree, const GDynArray<GReal>& Knots) {
+
+	GInt32 i, n = (GInt32)Knots.size();
+
+	if ((Degree <= 0) || (n < 2 * (Degree + 1)) || (Knots[0] >= Knots[n - 1]))
+		return G_INVALID_PARAMETER;
+	for (i = 1; i < n; i++) {
+		if (Knots[i] < Knots[i - 1])
+			return G_INVALID_PARAMETER;
+	}
+	// first and last knots must have multiplicity Degree + 1
+	for (i = 1; i <= Degree; i++) {
+		if (Knots[i] != Knots[0] || Knots[n - 1 - i] != Knots[n - 1])
+			return G_INVALID_PARAMETER;
+	}
+	gDegree = Degree;
+	gUniform = G_FALSE;
+	gKnots = Knots;
+	gBasisFuncEval.resize(3 * (Degree + 1));
+	n -= Degree + 1;
+	gNormalMatrix.resize(n * (Degree + 1));
+	gNormalRhs.resize(n);
+	Reset();
+	return G_NO_ERROR;
+}
+
+// set degree and a uniform knots vector
+GError GBSplineCurveFitter2D::SetUniformKnots(const GInt32 Degree, const GInt32 ControlPointsCount,
+											  const GReal MinKnotValue, const GReal MaxKnotValue) {
+
+	if ((Degree <= 0) || (ControlPointsCount <= Degree) || (MinKnotValue >= MaxKnotValue))
+		return G_INVALID_PARAMETER;
+
+	GDynArray<GReal> knots(ControlPointsCount + Degree + 1);
+	GInt32 i, spans = ControlPointsCount - Degree;
+	GError err;
+
+	for (i = 0; i <= Degree; i++) {
+		knots[i] = MinKnotValue;
+		knots[ControlPointsCount + i] = MaxKnotValue;
+	}
+	for (i = 1; i < spans; i++)
+		knots[Degree + i] = MinKnotValue + (MaxKnotValue - MinKnotValue) * ((GReal)i / (GReal)spans);
+
+	err = SetKnots(Degree, knots);
+	if (err == G_NO_ERROR)
+		gUniform = G_TRUE;
+	return err;
+}
+
+// discard all samples
+void GBSplineCurveFitter2D::Reset() {
+
+	std::fill(gNormalMatrix.begin(), gNormalMatrix.end(), (GReal)0);
+	std::fill(gNormalRhs.begin(), gNormalRhs.end(), G_NULL_POINT2);
+	gSamplesCount = 0;
+	gLastSpan = gDegree;
+}
+
+// find knot span that contains the specified parameter
+GInt32 GBSplineCurveFitter2D::FindSpan(const GReal u) {
+
+	GInt32 n = PointsCount() - 1;
+
+	// domain end belongs to the last non-empty span
+	if (u >= gKnots[n + 1])
+		gLastSpan = n;
+	else
+	if (u < gKnots[gLastSpan] || u >= gKnots[gLastSpan + 1]) {
+		// sorted samples usually fall in the next span, else do a binary search
+		if (gLastSpan < n && u >= gKnots[gLastSpan + 1] && u < gKnots[gLastSpan + 2])
+			gLastSpan++;
+		else
+			gLastSpan = (GInt32)(std::upper_bound(gKnots.begin() + gDegree, gKnots.begin() + n + 1, u) - gKnots.begin()) - 1;
+	}
+	return gLastSpan;
+}
+
+// evaluate non-vanishing basis functions for a given span index
+const GReal* GBSplineCurveFitter2D::BasisFunctions(const GInt32 SpanIndex, const GReal u) {
+
+	GReal *left = &gBasisFuncEval[gDegree + 1];
+	GReal *right = &gBasisFuncEval[(gDegree + 1) * 2];
+	GReal saved, temp;
+
+	gBasisFuncEval[0] = 1;
+	for (GInt32 j = 1; j <= gDegree; j++) {
+		left[j] = u - gKnots[SpanIndex + 1 - j];
+		right[j] = gKnots[SpanIndex + j] - u;
+		saved = 0;
+		for (GInt32 r = 0; r < j; r++) {
+			temp = gBasisFuncEval[r] / (right[r + 1] + left[j - r]);
+			gBasisFuncEval[r] = saved + right[r + 1] * temp;
+			saved = left[j - r] * temp;
+		}
+		gBasisFuncEval[j] = saved;
+	}
+	return &gBasisFuncEval[0];
+}
+
+// accumulate a weighted sample into normal equations
+GError GBSplineCurveFitter2D::Accumulate(const GReal Parameter, const GPoint2& Point, const GReal Weight) {
+
+	if (gKnots.empty())
+		return G_INVALID_OPERATION;
+	if (Parameter < gKnots[0] || Parameter > gKnots[gKnots.size() - 1])
+		return G_OUT_OF_RANGE;
+
+	GInt32 i, j, span = FindSpan(Parameter), first = span - gDegree;
+	const GReal *basisFuncs = BasisFunctions(span, Parameter);
+	GReal *row, wn;
+
+	// only the (Degree + 1) x (Degree + 1) block relative to the non-vanishing basis functions is touched
+	for (i = 0; i <= gDegree; i++) {
+		wn = Weight * basisFuncs[i];
+		row = &gNormalMatrix[(first + i) * (gDegree + 1)];
+		for (j = i; j <= gDegree; j++)
+			row[j - i] += wn * basisFuncs[j];
+		gNormalRhs[first + i] += wn * Point;
+	}
+	return G_NO_ERROR;
+}
+
+// add a sample
+GError GBSplineCurveFitter2D::AddSample(const GReal Parameter, const GPoint2& Point, const GReal Weight) {
+
+	if (Weight < 0)
+		return G_INVALID_PARAMETER;
+
+	GError err = Accumulate(Parameter, Point, Weight);
+	if (err == G_NO_ERROR)
+		gSamplesCount++;
+	return err;
+}
+
+// add an array of samples
+GError GBSplineCurveFitter2D::AddSamples(const GDynArray<GReal>& Parameters, const GDynArray<GPoint2>& Points,
+										 const GDynArray<GReal>& Weights) {
+
+	GInt32 i, j = (GInt32)Parameters.size();
+
+	if ((GInt32)Points.size() != j || (Weights.size() > 0 && (GInt32)Weights.size() != j))
+		return G_INVALID_PARAMETER;
+	if (gKnots.empty())
+		return G_INVALID_OPERATION;
+	// validate all samples first, so that nothing is added in case of error
+	for (i = 0; i < j; i++) {
+		if (Parameters[i] < gKnots[0] || Parameters[i] > gKnots[gKnots.size() - 1])
+			return G_OUT_OF_RANGE;
+		if (Weights.size() > 0 && Weights[i] < 0)
+			return G_INVALID_PARAMETER;
+	}
+	for (i = 0; i < j; i++)
+		Accumulate(Parameters[i], Points[i], (Weights.size() > 0) ? Weights[i] : (GReal)1);
+	gSamplesCount += j;
+	return G_NO_ERROR;
+}
+
+// remove a previously added sample
+GError GBSplineCurveFitter2D::RemoveSample(const GReal Parameter, const GPoint2& Point, const GReal Weight) {
+
+	if (Weight < 0)
+		return G_INVALID_PARAMETER;
+
+	GError err = Accumulate(Parameter, Point, -Weight);
+	if (err == G_NO_ERROR)
+		gSamplesCount--;
+	return err;
+}
+
+// set the weight of the control polygon length penalty
+void GBSplineCurveFitter2D::SetSmoothing(const GReal Smoothing) {
+
+	gSmoothing = GMath::Max((GReal)0, Smoothing);
+}
+
+// solve normal equations
+GError GBSplineCurveFitter2D::Solve(GBSplineCurve2D& Curve) const {
+
+	GInt32 n = PointsCount(), i, j, k, jMax;
+
+	if (n == 0)
+		return G_INVALID_OPERATION;
+
+	GDynArray<GReal> u(gNormalMatrix);
+	GDynArray<GPoint2> x(gNormalRhs);
+	GReal d, s;
+	#define U(i, j) u[(i) * (gDegree + 1) + (j) - (i)]
+
+	// add the control polygon length penalty, sum of squared (P[i + 1] - P[i])
+	if (gSmoothing > 0) {
+		for (i = 0; i < n - 1; i++) {
+			U(i, i) += gSmoothing;
+			U(i + 1, i + 1) += gSmoothing;
+			U(i, i + 1) -= gSmoothing;
+		}
+	}
+	// banded Cholesky decomposition A = Ut * U, done in place
+	for (i = 0; i < n; i++) {
+		d = U(i, i);
+		for (k = GMath::Max(0, i - gDegree); k < i; k++)
+			d -= U(k, i) * U(k, i);
+		// a (numerically) zero pivot means that the system is singular
+		if (d <= G_EPSILON * U(i, i))
+			return G_INVALID_OPERATION;
+		d = GMath::Sqrt(d);
+		U(i, i) = d;
+		jMax = GMath::Min(i + gDegree, n - 1);
+		for (j = i + 1; j <= jMax; j++) {
+			s = U(i, j);
+			for (k = GMath::Max(0, j - gDegree); k < i; k++)
+				s -= U(k, i) * U(k, j);
+			U(i, j) = s / d;
+		}
+	}
+	// forward substitution (Ut * y = b)
+	for (i = 0; i < n; i++) {
+		for (k = GMath::Max(0, i - gDegree); k < i; k++)
+			x[i] -= U(k, i) * x[k];
+		x[i] *= (1 / U(i, i));
+	}
+	// back substitution (U * x = y)
+	for (i = n - 1; i >= 0; i--) {
+		jMax = GMath::Min(i + gDegree, n - 1);
+		for (j = i + 1; j <= jMax; j++)
+			x[i] -= U(i, j) * x[j];
+		x[i] *= (1 / U(i, i));
+	}
+	#undef U
+	return Curve.SetPoints(x, gKnots, gDegree, gUniform);
 }
 
 };	// end namespace Amanith
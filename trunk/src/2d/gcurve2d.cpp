@@ -30,6 +30,7 @@
 #include "amanith/geometry/gdistance.h"
 #include "amanith/geometry/gxform.h"
 #include "amanith/geometry/gxformconv.h"
+#include "amanith/geometry/gbulkxform.h"
 #include "amanith/gerror.h"
 #include "amanith/numerics/gintegration.h"
 #include "amanith/gmultiproperty.h"
@@ -98,6 +99,26 @@ GReal GCurve2D::Curvature(const GReal u) const {
 		return 0;
 }
 
+// evaluate the curve at several global parameters
+void GCurve2D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size();
+
+	Out.resize(j);
+	for (i = 0; i < j; ++i)
+		Out[i] = Evaluate(Params[i]);
+}
+
+// evaluate the curve derivative at several global parameters
+void GCurve2D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size();
+
+	Out.resize(j);
+	for (i = 0; i < j; ++i)
+		Out[i] = Derivative(Order, Params[i]);
+}
+
 // get curve speed (specifying global parameter)
 GReal GCurve2D::Speed(const GReal u) const {
 
@@ -179,7 +200,7 @@ GReal GCurve2D::Length(const GReal u0, const GReal u1, const GReal MaxError) con
 		uu1 = u1;
 	}
 	// integration over speed
-	errorBounded = GIntegration::Romberg(result, uu0, uu1, SpeedEvaluationCallBack, (void *)this, MaxError);
+	errorBounded = GIntegration::GaussKronrod(result, uu0, uu1, SpeedsEvaluationCallBack, (void *)this, MaxError);
 	return result;
 }
 
@@ -351,8 +372,13 @@ void GCurve2D::Scale(const GPoint2& Pivot, const GReal XScaleAmount, const GReal
 void GCurve2D::XForm(const GMatrix23& Matrix) {
 
 	GUInt32 i, j = PointsCount();
-	GPoint2 p;
+	GPoint2 p, *points = PointsBuffer();
 
+	// contiguous points are transformed in place, all at once
+	if (points) {
+		GBulkXForm::XForm(Matrix, points, points, j);
+		return;
+	}
 	for (i = 0; i < j; i++) {
 		p = Matrix * Point(i);
 		SetPoint(i, p);
@@ -363,8 +389,12 @@ void GCurve2D::XForm(const GMatrix23& Matrix) {
 void GCurve2D::XForm(const GMatrix33& Matrix, const GBool DoProjection) {
 
 	GUInt32 i, j = PointsCount();
-	GPoint2 p;
+	GPoint2 p, *points = PointsBuffer();
 
+	if (points) {
+		GBulkXForm::XForm(Matrix, DoProjection, points, points, j);
+		return;
+	}
 	if (DoProjection == G_FALSE) {
 		for (i = 0; i < j; i++) {
 			p = Matrix * Point(i);
@@ -405,4 +435,13 @@ GReal GCurve2D::SpeedEvaluationCallBack(const GReal u, void *Data) {
 	return c->Speed(u);
 }
 
+// static batched speed evaluation callback
+void GCurve2D::SpeedsEvaluationCallBack(const GReal *u, GReal *Speeds, const GUInt32 Count, void *Data) {
+
+	const GCurve2D *c = (const GCurve2D *)Data;
+
+	for (GUInt32 i = 0; i < Count; ++i)
+		Speeds[i] = c->Speed(u[i]);
+}
+
 };	// end namespace Amanith
@@ -547,6 +547,61 @@ GVector2 GEllipseCurve2D::Derivative(const GDerivativeOrder Order, const GReal u
 	}
 }
 
+// evaluate the curve at several global parameters
+void GEllipseCurve2D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size();
+
+	// there's no span to search, just avoid virtual calls
+	Out.resize(j);
+	for (i = 0; i < j; i++)
+		Out[i] = GEllipseCurve2D::Evaluate(Params[i]);
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GEllipseCurve2D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params,
+								 GDynArray<GVector2>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size();
+
+	Out.resize(j);
+	for (i = 0; i < j; i++)
+		Out[i] = GEllipseCurve2D::Derivative(Order, Params[i]);
+}
+
+// returns the length of the curve between the 2 specified global parameter values
+GReal GEllipseCurve2D::Length(const GReal u0, const GReal u1, const GReal MaxError) const {
+
+	GReal l, span, uu0, uu1;
+
+	// only circular arcs have a constant speed
+	if (GMath::Abs(gXSemiAxisLength - gYSemiAxisLength) >
+		G_EPSILON * GMath::Max(GMath::Abs(gXSemiAxisLength), GMath::Abs(gYSemiAxisLength)))
+		return GCurve2D::Length(u0, u1, MaxError);
+
+	l = Domain().Length();
+	if (l <= G_EPSILON)
+		return 0;
+
+	// swept angle, the same used by Derivative()
+	if (gCCW) {
+		if (gStartAngle < gEndAngle)
+			span = gEndAngle - gStartAngle;
+		else
+			span = (GReal)G_2PI - gStartAngle + gEndAngle;
+	}
+	// cw
+	else {
+		if (gStartAngle < gEndAngle)
+			span = (GReal)G_2PI - gEndAngle + gStartAngle;
+		else
+			span = gStartAngle - gEndAngle;
+	}
+	uu0 = GMath::Clamp(GMath::Min(u0, u1), DomainStart(), DomainEnd());
+	uu1 = GMath::Clamp(GMath::Max(u0, u1), DomainStart(), DomainEnd());
+	return GMath::Abs(gXSemiAxisLength) * span * ((uu1 - uu0) / l);
+}
+
 GError GEllipseCurve2D::DoCut(const GReal u, GCurve2D *RightCurve, GCurve2D *LeftCurve) const {
 
 	GEllipseCurve2D *rCurve = (GEllipseCurve2D *)RightCurve;
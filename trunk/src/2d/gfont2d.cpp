@@ -31,6 +31,8 @@
 #include "amanith/2d/gpolylinecurve2d.h"
 #include "amanith/geometry/gxform.h"
 #include "amanith/gkernel.h"
+#include <algorithm>
+#include <map>
 
 /*!
 	\file gfont2d.cpp
@@ -56,6 +58,20 @@ GFontCharContour2D::GFontCharContour2D(const GDynArray<GPoint2>& NewPoints,
 
 }
 
+// constructor, for already processed contours
+GFontCharContour2D::GFontCharContour2D(const GDynArray<GPoint2>& NewPoints, const GDynArray<GInt32>& PointsFlags,
+									   const GBool IsHole) {
+
+	if (NewPoints.size() != PointsFlags.size())
+		return;
+
+	gPoints = NewPoints;
+	gPointsFlags = PointsFlags;
+	gIsHole = IsHole;
+	// build bound box (axis aligned)
+	gBoundBox.SetMinMax(gPoints);
+}
+
 void GFontCharContour2D::BuildGoodContour(const GReal Precision, const GDynArray<GPoint2>& NewPoints,
 										const GDynArray<GInt32>& PointsFlags) {
 
@@ -802,9 +818,11 @@ GFontChar2D::GFontChar2D(const GFontChar2D& Source) {
 }
 
 // constructor
-GFontChar2D::GFontChar2D(const GFont2D* Owner, const GDynArray<GFontCharContour2D>& Contours) {
+GFontChar2D::GFontChar2D(const GFont2D* Owner, const GDynArray<GFontCharContour2D>& Contours,
+						 const GBool Labeled) {
 
-	gInitialized = G_FALSE;
+	// labeled contours don't need any initialization
+	gInitialized = Labeled;
 	gMetrics.Width = 0;
 	gMetrics.Height = 0;
 	gMetrics.HoriBearingX = 0;
@@ -986,13 +1004,230 @@ void GFontChar2D::LabelContour(const GFontCharContour2D& Contour) const {
 	}
 }
 
+// a y-monotone piece of a contour: a line, a quadratic or a cubic Bezier arc
+struct GMonotoneArc {
+	GPoint2 Points[4];
+	GInt32 PointsCount;
+};
+
+// split a Bezier arc at the specified parameter (de Casteljau)
+static void SplitArc(const GPoint2 *Points, const GInt32 PointsCount, const GReal U, GPoint2 *Left, GPoint2 *Right) {
+
+	GPoint2 tmp[4];
+	GInt32 i, k;
+
+	for (i = 0; i < PointsCount; ++i)
+		tmp[i] = Points[i];
+	for (k = 0; k < PointsCount; ++k) {
+		Left[k] = tmp[0];
+		Right[PointsCount - 1 - k] = tmp[PointsCount - 1 - k];
+		for (i = 0; i < PointsCount - 1 - k; ++i)
+			tmp[i] = tmp[i] + (tmp[i + 1] - tmp[i]) * U;
+	}
+}
+
+// decompose a contour into y-monotone arcs, splitting Bezier arcs at their vertical extrema
+static void BuildMonotoneArcs(const GFontCharContour2D& Contour, GDynArray<GMonotoneArc>& Arcs) {
+
+	GDynArray<GPoint2> pts;
+	GDynArray<GInt32> idx;
+	GMonotoneArc arc, left;
+	GInt32 i, j, k, q, ofs, rootsCount;
+	GReal u[2], a, b, c, r0, r1, lastU;
+
+	Contour.DecomposeBezier(pts, idx);
+	ofs = 0;
+	j = (GInt32)idx.size();
+	for (i = 0; i < j; ++i) {
+		k = idx[i];
+		arc.PointsCount = k;
+		for (q = 0; q < k; ++q)
+			arc.Points[q] = pts[ofs + q];
+		ofs += k;
+		// find parameters where y derivative vanishes
+		rootsCount = 0;
+		if (k == 3) {
+			a = arc.Points[0][G_Y] - 2 * arc.Points[1][G_Y] + arc.Points[2][G_Y];
+			if (a != 0) {
+				u[0] = (arc.Points[0][G_Y] - arc.Points[1][G_Y]) / a;
+				if (u[0] > 0 && u[0] < 1)
+					rootsCount = 1;
+			}
+		}
+		else
+		if (k == 4) {
+			a = 3 * (arc.Points[1][G_Y] - arc.Points[2][G_Y]) + arc.Points[3][G_Y] - arc.Points[0][G_Y];
+			b = 2 * (arc.Points[0][G_Y] - 2 * arc.Points[1][G_Y] + arc.Points[2][G_Y]);
+			c = arc.Points[1][G_Y] - arc.Points[0][G_Y];
+			q = GMath::QuadraticFormula(r0, r1, a, b, c);
+			if (q > 0) {
+				if (r1 < r0)
+					std::swap(r0, r1);
+				// keep roots inside the arc domain only
+				if (r0 > 0 && r0 < 1)
+					u[rootsCount++] = r0;
+				if (q == 2 && r1 > r0 && r1 > 0 && r1 < 1)
+					u[rootsCount++] = r1;
+			}
+		}
+		// split the arc at the found parameters
+		lastU = 0;
+		for (q = 0; q < rootsCount; ++q) {
+			left.PointsCount = k;
+			SplitArc(arc.Points, k, (u[q] - lastU) / (1 - lastU), left.Points, arc.Points);
+			Arcs.push_back(left);
+			lastU = u[q];
+		}
+		Arcs.push_back(arc);
+	}
+}
+
+// count the intersections between a y-monotone arc and the horizontal ray starting at P, pointing towards
+// positive x; the arc is intended to include its lower end point only, so shared end points are counted once
+static GInt32 MonotoneArcCrossings(const GMonotoneArc& Arc, const GPoint2& P) {
+
+	GPoint2 left[4], right[4], pts[4];
+	GReal y0, y1, yMid, minX, maxX;
+	GInt32 i, k, depth;
+
+	k = Arc.PointsCount;
+	y0 = Arc.Points[0][G_Y];
+	y1 = Arc.Points[k - 1][G_Y];
+	if (!((y0 <= P[G_Y] && P[G_Y] < y1) || (y1 <= P[G_Y] && P[G_Y] < y0)))
+		return 0;
+	// lines are intersected directly
+	if (k == 2) {
+		minX = Arc.Points[0][G_X] + (P[G_Y] - y0) * (Arc.Points[1][G_X] - Arc.Points[0][G_X]) / (y1 - y0);
+		return (minX > P[G_X]) ? 1 : 0;
+	}
+	for (i = 0; i < k; ++i)
+		pts[i] = Arc.Points[i];
+	// curves are halved until the control polygon lies entirely on one side of P
+	for (depth = 0; depth < 64; ++depth) {
+		minX = maxX = pts[0][G_X];
+		for (i = 1; i < k; ++i) {
+			if (pts[i][G_X] < minX)
+				minX = pts[i][G_X];
+			else
+			if (pts[i][G_X] > maxX)
+				maxX = pts[i][G_X];
+		}
+		if (minX > P[G_X])
+			return 1;
+		if (maxX <= P[G_X])
+			return 0;
+		SplitArc(pts, k, (GReal)0.5, left, right);
+		yMid = right[0][G_Y];
+		// take the half that contains the ray, according to the half-open rule
+		if ((y0 <= P[G_Y] && P[G_Y] < yMid) || (yMid <= P[G_Y] && P[G_Y] < y0)) {
+			for (i = 0; i < k; ++i)
+				pts[i] = left[i];
+			y1 = yMid;
+		}
+		else {
+			for (i = 0; i < k; ++i)
+				pts[i] = right[i];
+			y0 = yMid;
+		}
+	}
+	return ((pts[0][G_X] + pts[k - 1][G_X]) * (GReal)0.5 > P[G_X]) ? 1 : 0;
+}
+
+// pick a point in the middle of an arc of a contour; on-curve points can be shared with other contours
+// (touching contours), and a ray shot from there would count ambiguous crossings
+static GPoint2 ArcMidPoint(const GFontCharContour2D& Contour) {
+
+	GDynArray<GPoint2> pts;
+	GDynArray<GInt32> idx;
+	GPoint2 left[4], right[4];
+	GUInt32 i, j, ofs;
+
+	Contour.DecomposeBezier(pts, idx);
+	if (idx.empty())
+		return Contour.PickPointOnCurve();
+	// take the arc halfway along the contour, away from the starting point
+	j = (GUInt32)idx.size() / 2;
+	ofs = 0;
+	for (i = 0; i < j; ++i)
+		ofs += idx[i];
+	SplitArc(&pts[ofs], idx[j], (GReal)0.5, left, right);
+	return right[0];
+}
+
+// contour bounding box entry, used by the containment sweep
+struct GContourBoxEntry {
+	GReal MinX;
+	GUInt32 Index;
+};
+
+static bool ContourBoxLess(const GContourBoxEntry& E1, const GContourBoxEntry& E2) {
+
+	return (E1.MinX < E2.MinX);
+}
+
 void GFontChar2D::LabelHolesAndFilled() const {
 
-	GUInt32 i, j;
+	GDynArray<GContourBoxEntry> sorted;
+	GDynArray< GDynArray<GMonotoneArc> > arcs;
+	GDynArray<GBool> arcsBuilt;
+	std::multimap<GReal, GUInt32> active;
+	std::multimap<GReal, GUInt32>::iterator it;
+	GContourBoxEntry entry;
+	GUInt32 i, j, k, w, q, crossings, arcsCount;
+	GPoint2 p;
 
 	j = (GUInt32)gContours.size();
-	for (i = 0; i < j; i++)
-		LabelContour(gContours[i]);
+	if (j == 0)
+		return;
+
+	// sort contours by the left side of their bounding box; a contour can be contained only inside contours
+	// that come before it (or that share its left side)
+	for (i = 0; i < j; ++i) {
+		entry.MinX = gContours[i].BoundBox().Min()[G_X];
+		entry.Index = i;
+		sorted.push_back(entry);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), ContourBoxLess);
+	arcs.resize(j);
+	arcsBuilt.resize(j, G_FALSE);
+
+	i = 0;
+	while (i < j) {
+		// insert all contours sharing the same left side, keyed by the right side of their bounding box
+		for (k = i; k < j && sorted[k].MinX == sorted[i].MinX; ++k)
+			active.insert(std::make_pair(gContours[sorted[k].Index].BoundBox().Max()[G_X], sorted[k].Index));
+		// contours that end before the sweep line cannot contain anything else
+		while (!active.empty() && active.begin()->first < sorted[i].MinX)
+			active.erase(active.begin());
+
+		for (w = i; w < k; ++w) {
+			const GFontCharContour2D& contour = gContours[sorted[w].Index];
+			const GAABox2& box = contour.BoundBox();
+
+			p = ArcMidPoint(contour);
+			crossings = 0;
+			// candidate containers are the active contours whose box contains the box of this contour
+			for (it = active.lower_bound(box.Max()[G_X]); it != active.end(); ++it) {
+				if (it->second == sorted[w].Index)
+					continue;
+				const GFontCharContour2D& c = gContours[it->second];
+				if (c.BoundBox().Min()[G_Y] > box.Min()[G_Y] || c.BoundBox().Max()[G_Y] < box.Max()[G_Y])
+					continue;
+				// monotone arcs are built once, the first time a contour is a candidate container
+				if (!arcsBuilt[it->second]) {
+					BuildMonotoneArcs(c, arcs[it->second]);
+					arcsBuilt[it->second] = G_TRUE;
+				}
+				const GDynArray<GMonotoneArc>& cArcs = arcs[it->second];
+				arcsCount = (GUInt32)cArcs.size();
+				for (q = 0; q < arcsCount; ++q)
+					crossings += MonotoneArcCrossings(cArcs[q], p);
+			}
+			// contour is an hole if it's contained inside an odd number of contours
+			contour.gIsHole = ((crossings & 1) != 0);
+		}
+		i = k;
+	}
 }
 
 void GFontChar2D::SwapHolesAndFilledLabels(const GBool EvenOddFlag) const {
@@ -1221,6 +1456,13 @@ const GFontChar2D* GFont2D::CharByIndex(const GInt32 Index) const {
 	return c;
 }
 
+// get the Index-th char map
+const GCharMap& GFont2D::CharMap(const GInt32 Index) const {
+
+	G_ASSERT((Index >= 0) && (Index < CharMapsCount()));
+	return gCharsMaps[Index];
+}
+
 // add a char map
 GError GFont2D::AddCharMap(const GCharMap& NewCharMap) {
 
@@ -1380,11 +1622,11 @@ const GPoint2& GFont2D::KerningByCharCode(const GUInt32 LeftGlyph, const GUInt32
 }
 
 // insert a new char, based on specified contours
-GFontChar2D* GFont2D::AddChar(const GDynArray<GFontCharContour2D>& Contours) {
+GFontChar2D* GFont2D::AddChar(const GDynArray<GFontCharContour2D>& Contours, const GBool Labeled) {
 
 	GFontChar2D *c;
 
-	c = new GFontChar2D(this, Contours);
+	c = new GFontChar2D(this, Contours, Labeled);
 	gChars.push_back(c);
 	return c;
 }
@@ -1161,6 +1161,74 @@ GVector2 GPath2D::Derivative(const GDerivativeOrder Order, const GReal u) const
 	return gSegments[i]->Derivative(Order, uu);
 }
 
+// evaluate the path at several global parameters
+void GPath2D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const {
+
+	GDynArray<GReal> segParams;
+	GDynArray<GPoint2> segValues;
+	GUInt32 i, j = (GUInt32)Params.size(), k, first, seg;
+	GReal uu;
+	GBool shared;
+
+	Out.resize(j);
+	i = 0;
+	while (i < j) {
+		// clamp parameter into permitted interval
+		uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+		if (ParamToSegmentIndex(uu, seg, shared) != G_NO_ERROR) {
+			Out[i++] = GPoint2(G_MIN_REAL, G_MIN_REAL);
+			continue;
+		}
+		first = i;
+		segParams.clear();
+		segParams.push_back(uu);
+		// collect next parameters, until they fall inside the same segment (not too close to its start, where
+		// ParamToSegmentIndex could choose the previous one)
+		for (i++; i < j; i++) {
+			uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+			if (uu <= gSegments[seg]->DomainStart() + G_EPSILON || uu >= gSegments[seg]->DomainEnd())
+				break;
+			segParams.push_back(uu);
+		}
+		gSegments[seg]->Evaluate(segParams, segValues);
+		for (k = 0; k < (GUInt32)segValues.size(); k++)
+			Out[first + k] = segValues[k];
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GPath2D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const {
+
+	GDynArray<GReal> segParams;
+	GDynArray<GVector2> segValues;
+	GUInt32 i, j = (GUInt32)Params.size(), k, first, seg;
+	GReal uu;
+	GBool shared;
+
+	Out.resize(j);
+	i = 0;
+	while (i < j) {
+		// clamp parameter into permitted interval
+		uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+		if (ParamToSegmentIndex(uu, seg, shared) != G_NO_ERROR) {
+			Out[i++] = GVector2(0, 0);
+			continue;
+		}
+		first = i;
+		segParams.clear();
+		segParams.push_back(uu);
+		for (i++; i < j; i++) {
+			uu = GMath::Clamp(Params[i], DomainStart(), DomainEnd());
+			if (uu <= gSegments[seg]->DomainStart() + G_EPSILON || uu >= gSegments[seg]->DomainEnd())
+				break;
+			segParams.push_back(uu);
+		}
+		gSegments[seg]->Derivative(Order, segParams, segValues);
+		for (k = 0; k < (GUInt32)segValues.size(); k++)
+			Out[first + k] = segValues[k];
+	}
+}
+
 void GPath2D::DerivativeLR(const GDerivativeOrder Order, const GReal u,
 						   GVector2& LeftDerivative, GVector2& RightDerivative) const {
 
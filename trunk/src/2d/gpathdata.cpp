@@ -0,0 +1,1072 @@
+/****************************************************************************
+** $file: amanith/src/2d/gpathdata.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** 2D compact path data implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/2d/gpathdata.h"
+#include "amanith/2d/gbeziercurve2d.h"
+#include "amanith/2d/gellipsecurve2d.h"
+#include "amanith/2d/gpolylinecurve2d.h"
+#include "amanith/geometry/gbulkxform.h"
+#include "amanith/gkernel.h"
+#include "amanith/gerror.h"
+
+/*!
+	\file gpathdata.cpp
+	\brief 2D compact path data implementation file.
+*/
+
+namespace Amanith {
+
+// maximum number of segments a single curve can be flattened into
+static const GInt32 G_MAX_FLATTEN_SEGMENTS = 1024;
+
+// number of points taken by each verb
+static const GInt32 gVerbPointsCount[6] = { 1, 1, 2, 3, 4, 0 };
+
+// real roots of a t^2 + b t + c = 0, returns their number
+static GInt32 SolveQuadratic(const GReal a, const GReal b, const GReal c, GReal *Roots) {
+
+	GReal disc, q;
+
+	if (GMath::Abs(a) <= G_EPSILON * (GMath::Abs(b) + GMath::Abs(c))) {
+		if (b == 0)
+			return 0;
+		Roots[0] = -c / b;
+		return 1;
+	}
+	disc = b * b - 4 * a * c;
+	if (disc < 0)
+		return 0;
+	// numerically stable form, it avoids the cancellation of -b + sqrt(disc)
+	q = (b < 0) ? -(GReal)0.5 * (b - GMath::Sqrt(disc)) : -(GReal)0.5 * (b + GMath::Sqrt(disc));
+	Roots[0] = q / a;
+	if (q == 0)
+		return 1;
+	Roots[1] = c / q;
+	return 2;
+}
+
+// G_TRUE if two points differ just by the roundoff of trigonometric evaluations
+static GBool RoundoffEqual(const GPoint2& P0, const GPoint2& P1) {
+
+	GReal tol = 64 * G_EPSILON * GMath::Max((GReal)1, GMath::Max(GMath::Abs(P0[G_X]), GMath::Abs(P0[G_Y])));
+
+	return (GMath::Abs(P1[G_X] - P0[G_X]) <= tol && GMath::Abs(P1[G_Y] - P0[G_Y]) <= tol);
+}
+
+// value of a cubic Bezier function, given its control values
+static inline GReal CubicValue(const GReal *Values, const GReal t) {
+
+	GReal s = 1 - t;
+
+	return s * s * s * Values[0] + 3 * s * t * (s * Values[1] + t * Values[2]) + t * t * t * Values[3];
+}
+
+// local parameter of an angle inside an arc, returns G_FALSE if the angle is outside the arc
+static GBool AngleInsideArc(const GReal Angle, const GReal StartAngle, const GReal SweepAngle, GReal& LocalParam) {
+
+	GReal d = Angle - StartAngle;
+
+	if (SweepAngle == 0)
+		return G_FALSE;
+
+	d -= (GReal)G_2PI * GMath::Floor(d / (GReal)G_2PI);
+	if (SweepAngle < 0 && d > 0)
+		d -= (GReal)G_2PI;
+	LocalParam = d / SweepAngle;
+	return (LocalParam >= 0 && LocalParam <= 1);
+}
+
+// *********************************************************************
+//                             GPathFlattener
+// *********************************************************************
+
+GPathFlattener::GPathFlattener(GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+							   GDynArray<GBool>& ClosedContours, const GReal MaxDeviation) : gPoints(Points),
+							   gPointsPerContour(PointsPerContour), gClosedContours(ClosedContours) {
+
+	G_ASSERT(MaxDeviation > 0);
+	gFlatness = GMath::Sqrt(MaxDeviation);
+	gContourStart = (GInt32)Points.size();
+}
+
+GInt32 GPathFlattener::SegmentsCount(const GReal Coefficient, const GReal SecondDifference) const {
+
+	GReal n = GMath::Ceil(GMath::Sqrt(Coefficient * SecondDifference / gFlatness));
+
+	if (n < 1)
+		return 1;
+	if (n > (GReal)G_MAX_FLATTEN_SEGMENTS)
+		return G_MAX_FLATTEN_SEGMENTS;
+	return (GInt32)n;
+}
+
+void GPathFlattener::EndContour(const GBool Closed) {
+
+	GInt32 n = (GInt32)gPoints.size() - gContourStart;
+
+	// closed contours don't repeat their first point
+	if (Closed && n > 1 && Distance(gPoints.back(), gPoints[gContourStart]) <= G_EPSILON) {
+		gPoints.pop_back();
+		n--;
+	}
+	if (n > 1) {
+		gPointsPerContour.push_back(n);
+		gClosedContours.push_back(Closed);
+	}
+	else
+		gPoints.resize(gContourStart);
+	gContourStart = (GInt32)gPoints.size();
+}
+
+void GPathFlattener::MoveTo(const GPoint2& P) {
+
+	EndContour(G_FALSE);
+	gPoints.push_back(P);
+	gCursor = P;
+}
+
+void GPathFlattener::LineTo(const GPoint2& P) {
+
+	gPoints.push_back(P);
+	gCursor = P;
+}
+
+void GPathFlattener::QuadTo(const GPoint2& P1, const GPoint2& P) {
+
+	GVector2 a = gCursor - 2 * P1 + P;
+	GInt32 i, n = SegmentsCount((GReal)0.25, a.Length());
+	GReal h = (GReal)1 / (GReal)n;
+	// forward differences
+	GPoint2 f = gCursor;
+	GVector2 df = a * (h * h) + (P1 - gCursor) * (2 * h);
+	GVector2 ddf = a * (2 * h * h);
+
+	for (i = 1; i < n; i++) {
+		f += df;
+		df += ddf;
+		gPoints.push_back(f);
+	}
+	gPoints.push_back(P);
+	gCursor = P;
+}
+
+void GPathFlattener::CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+
+	GVector2 d0 = gCursor - 2 * P1 + P2;
+	GVector2 d1 = P1 - 2 * P2 + P;
+	GInt32 i, n = SegmentsCount((GReal)0.75, GMath::Max(d0.Length(), d1.Length()));
+	GReal h = (GReal)1 / (GReal)n, h2 = h * h, h3 = h2 * h;
+	// power basis coefficients, B(t) = a t^3 + b t^2 + c t + P0
+	GVector2 a = (P - gCursor) + 3 * (P1 - P2);
+	GVector2 b = 3 * d0;
+	GVector2 c = 3 * (P1 - gCursor);
+	// forward differences
+	GPoint2 f = gCursor;
+	GVector2 df = a * h3 + b * h2 + c * h;
+	GVector2 ddf = a * (6 * h3) + b * (2 * h2);
+	GVector2 dddf = a * (6 * h3);
+
+	for (i = 1; i < n; i++) {
+		f += df;
+		df += ddf;
+		ddf += dddf;
+		gPoints.push_back(f);
+	}
+	gPoints.push_back(P);
+	gCursor = P;
+}
+
+void GPathFlattener::ArcTo(const GPoint2& Center, const GVector2& U, const GVector2& V, const GReal StartAngle,
+						   const GReal SweepAngle, const GPoint2& P) {
+
+	GReal uu = Dot(U, U), vv = Dot(V, V), uv = Dot(U, V);
+	GReal r, step, dTheta, c, s, dc, ds, t;
+	GInt32 i, n;
+
+	// semi-major axis length, it works for conjugate (not only orthogonal) semi-diameters too
+	t = (uu - vv) * (GReal)0.5;
+	r = GMath::Sqrt((uu + vv) * (GReal)0.5 + GMath::Sqrt(t * t + uv * uv));
+
+	// angular step that keeps the sagitta within flatness
+	if (gFlatness >= r)
+		step = (GReal)G_PI_OVER2;
+	else
+		step = 2 * GMath::Acos(1 - gFlatness / r);
+	n = (GInt32)GMath::Ceil(GMath::Abs(SweepAngle) / step);
+	n = GMath::Clamp(n, (GInt32)1, G_MAX_FLATTEN_SEGMENTS);
+	dTheta = SweepAngle / (GReal)n;
+
+	// (c, s) is the current angle, rotated incrementally by dTheta
+	c = GMath::Cos(StartAngle);
+	s = GMath::Sin(StartAngle);
+	dc = GMath::Cos(dTheta);
+	ds = GMath::Sin(dTheta);
+	for (i = 1; i < n; i++) {
+		t = c * dc - s * ds;
+		s = s * dc + c * ds;
+		c = t;
+		gPoints.push_back(Center + U * c + V * s);
+	}
+	gPoints.push_back(P);
+	gCursor = P;
+}
+
+void GPathFlattener::ClosePath() {
+
+	EndContour(G_TRUE);
+}
+
+void GPathFlattener::Finish() {
+
+	EndContour(G_FALSE);
+}
+
+// *********************************************************************
+//                          GPathData to GPath2D
+// *********************************************************************
+
+/*
+	Builds paths segment by segment, joining consecutive lines into polylines.
+
+	GPath2D requires each segment to start exactly where the previous one ends, but the ends of an ellipse are
+	evaluated by trigonometric functions, so they differ from the ideal points by roundoff. For this reason the last
+	line or Bezier segment is kept pending, and its end is moved onto the start of a following arc. When two arcs
+	meet they are joined by a degenerate line instead, because moving an end point of an ellipse would fit a new
+	(slightly different) ellipse; for the same reason contours are closed by moving a line or Bezier end point.
+*/
+class GPathBuilder {
+
+private:
+	GKernel& gKernel;
+	GDynArray<GPath2D *>& gPaths;
+	// path under construction, NULL if no segment has been added to the current contour yet
+	GPath2D *gPath;
+	// points of pending consecutive lines
+	GDynArray<GPoint2> gPolyPoints;
+	// G_TRUE if gBezier is a pending segment
+	GBool gBezierPending;
+	// G_TRUE if the first (respectively the last) segment of the path under construction is an arc
+	GBool gFirstIsArc, gLastIsArc;
+	// domain end of the path under construction
+	GReal gDomainEnd;
+	// exact start and end points of the contour under construction
+	GPoint2 gStart, gEnd;
+	GBezierCurve2D gBezier;
+	GEllipseCurve2D gEllipse;
+	GPolyLineCurve2D gPolyLine;
+
+	// get the path under construction, creating it if needed
+	GPath2D *CurrentPath() {
+
+		if (!gPath && gError == G_NO_ERROR) {
+			gPath = (GPath2D *)gKernel.CreateNew(G_PATH2D_CLASSID);
+			if (gPath) {
+				gPaths.push_back(gPath);
+				gDomainEnd = 0;
+				gFirstIsArc = G_FALSE;
+			}
+			else
+				gError = G_UNSUPPORTED_CLASSID;
+		}
+		return gPath;
+	}
+	// append a segment, made of DomainLength unit pieces, to the path under construction
+	void Append(GCurve2D& Curve, const GReal DomainLength) {
+
+		GError err;
+
+		if (!CurrentPath())
+			return;
+		Curve.SetDomain(gDomainEnd, gDomainEnd + DomainLength);
+		if (gPath->SegmentsCount() == 0)
+			gFirstIsArc = (Curve.ClassID() == G_ELLIPSECURVE2D_CLASSID);
+		err = gPath->AppendCurve(Curve);
+		if (err == G_NO_ERROR) {
+			gDomainEnd += DomainLength;
+			gLastIsArc = (Curve.ClassID() == G_ELLIPSECURVE2D_CLASSID);
+		}
+		else
+		if (gError == G_NO_ERROR)
+			gError = err;
+	}
+	// append pending segments to the path under construction
+	void Flush() {
+
+		GReal n = (GReal)gPolyPoints.size() - 1;
+
+		if (n > 0) {
+			gPolyLine.SetPoints(gPolyPoints, gDomainEnd, gDomainEnd + n, G_TRUE);
+			Append(gPolyLine, n);
+		}
+		gPolyPoints.clear();
+		if (gBezierPending) {
+			gBezierPending = G_FALSE;
+			Append(gBezier, 1);
+		}
+	}
+	// make the contour under construction end exactly at P, that is roundoff away from its current end
+	void JoinTo(const GPoint2& P) {
+
+		if (gEnd == P)
+			return;
+		if (gPolyPoints.size() > 1)
+			gPolyPoints.back() = P;
+		else
+		if (gBezierPending)
+			gBezier.SetPoint(gBezier.PointsCount() - 1, P);
+		else
+		if (gPath && gPath->SegmentsCount() > 0) {
+			gPolyPoints.push_back(gEnd);
+			gPolyPoints.push_back(P);
+		}
+		else
+			// the contour is still empty, so it starts here
+			gStart = P;
+		gEnd = P;
+	}
+	// append an arc to the contour under construction
+	void AppendArc() {
+
+		JoinTo(gEllipse.StartPoint());
+		Flush();
+		Append(gEllipse, 1);
+		gEnd = gEllipse.EndPoint();
+	}
+
+public:
+	GError gError;
+
+	GPathBuilder(GKernel& Kernel, GDynArray<GPath2D *>& Paths) : gKernel(Kernel), gPaths(Paths), gPath(NULL),
+																  gBezierPending(G_FALSE), gFirstIsArc(G_FALSE),
+																  gLastIsArc(G_FALSE), gDomainEnd(0),
+																  gError(G_NO_ERROR) {
+	}
+	void MoveTo(const GPoint2& P) {
+		Flush();
+		gPath = NULL;
+		gStart = gEnd = P;
+	}
+	void LineTo(const GPoint2& P) {
+		if (gBezierPending)
+			Flush();
+		if (gPolyPoints.empty())
+			gPolyPoints.push_back(gEnd);
+		gPolyPoints.push_back(P);
+		gEnd = P;
+	}
+	void QuadTo(const GPoint2& P1, const GPoint2& P) {
+		Flush();
+		gBezier.SetPoints(gEnd, P1, P);
+		gBezierPending = G_TRUE;
+		gEnd = P;
+	}
+	void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+		Flush();
+		gBezier.SetPoints(gEnd, P1, P2, P);
+		gBezierPending = G_TRUE;
+		gEnd = P;
+	}
+	void ArcTo(const GPoint2& Center, const GVector2& U, const GVector2& V, const GReal StartAngle,
+			   const GReal SweepAngle) {
+
+		GReal rx, ry, rot, startAngle, sweepAngle;
+
+		GPathData::ArcPrincipalAxes(U, V, StartAngle, SweepAngle, rx, ry, rot, startAngle, sweepAngle);
+		if (sweepAngle >= (GReal)G_2PI)
+			// a counter-clockwise ellipse with coincident start and end angles is a full one
+			gEllipse.SetEllipse(Center, rx, ry, rot, startAngle, startAngle, G_TRUE);
+		else
+		if (sweepAngle <= -(GReal)G_2PI) {
+			// a full clockwise ellipse can't be represented by a single GEllipseCurve2D
+			gEllipse.SetEllipse(Center, rx, ry, rot, startAngle, startAngle - (GReal)G_PI, G_FALSE);
+			AppendArc();
+			gEllipse.SetEllipse(Center, rx, ry, rot, startAngle - (GReal)G_PI, startAngle, G_FALSE);
+		}
+		else
+			gEllipse.SetEllipse(Center, rx, ry, rot, startAngle, startAngle + sweepAngle, sweepAngle >= 0);
+		AppendArc();
+	}
+	void ClosePath() {
+		if (!RoundoffEqual(gEnd, gStart))
+			LineTo(gStart);
+		else
+			JoinTo(gStart);
+		Flush();
+		if (gPath && gPath->SegmentsCount() > 0) {
+			// GPath2D::ClosePath moves an end point of the path, so it must be the one of a line or a Bezier
+			if (gLastIsArc && gFirstIsArc) {
+				gPolyPoints.push_back(gEnd);
+				gPolyPoints.push_back(gStart);
+				Flush();
+			}
+			gPath->ClosePath(gLastIsArc && !gFirstIsArc);
+		}
+		gPath = NULL;
+		gEnd = gStart;
+	}
+	void Finish() {
+		Flush();
+	}
+};
+
+// *********************************************************************
+//                               GPathData
+// *********************************************************************
+
+GPathData::GPathData() : gContourStart(0), gNeedMove(G_TRUE) {
+}
+
+void GPathData::Clear() {
+
+	gVerbs.clear();
+	gPoints.clear();
+	gArcAngles.clear();
+	gContourStart = 0;
+	gNeedMove = G_TRUE;
+}
+
+void GPathData::Reserve(const GUInt32 VerbsCount, const GUInt32 PointsCount) {
+
+	gVerbs.reserve(VerbsCount);
+	gPoints.reserve(PointsCount);
+}
+
+GPoint2 GPathData::CurrentPoint() const {
+
+	if (gVerbs.empty())
+		return GPoint2(0, 0);
+	// a closed contour brings the current point back to its start
+	if (gVerbs.back() == G_CLOSE_VERB)
+		return gPoints[gContourStart];
+	return gPoints.back();
+}
+
+void GPathData::EnsureContour() {
+
+	if (gNeedMove)
+		MoveTo(CurrentPoint());
+}
+
+void GPathData::MoveTo(const GPoint2& P) {
+
+	// consecutive moves don't produce empty contours
+	if (!gVerbs.empty() && gVerbs.back() == G_MOVE_TO_VERB) {
+		gPoints.back() = P;
+		return;
+	}
+	gContourStart = (GInt32)gPoints.size();
+	gVerbs.push_back(G_MOVE_TO_VERB);
+	gPoints.push_back(P);
+	gNeedMove = G_FALSE;
+}
+
+void GPathData::LineTo(const GPoint2& P) {
+
+	EnsureContour();
+	gVerbs.push_back(G_LINE_TO_VERB);
+	gPoints.push_back(P);
+}
+
+void GPathData::QuadTo(const GPoint2& P1, const GPoint2& P) {
+
+	EnsureContour();
+	gVerbs.push_back(G_QUAD_TO_VERB);
+	gPoints.push_back(P1);
+	gPoints.push_back(P);
+}
+
+void GPathData::CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+
+	EnsureContour();
+	gVerbs.push_back(G_CUBIC_TO_VERB);
+	gPoints.push_back(P1);
+	gPoints.push_back(P2);
+	gPoints.push_back(P);
+}
+
+void GPathData::ArcTo(const GPoint2& Center, const GReal XSemiAxisLength, const GReal YSemiAxisLength,
+					  const GReal OffsetRotation, const GReal StartAngle, const GReal SweepAngle) {
+
+	GReal cs = GMath::Cos(OffsetRotation), sn = GMath::Sin(OffsetRotation);
+	GVector2 u(cs * XSemiAxisLength, sn * XSemiAxisLength);
+	GVector2 v(-sn * YSemiAxisLength, cs * YSemiAxisLength);
+	GPoint2 p0 = Center + u * GMath::Cos(StartAngle) + v * GMath::Sin(StartAngle);
+	GReal endAngle = StartAngle + SweepAngle;
+
+	if (gVerbs.empty())
+		MoveTo(p0);
+	else {
+		EnsureContour();
+		if (!RoundoffEqual(CurrentPoint(), p0))
+			LineTo(p0);
+	}
+	gVerbs.push_back(G_ARC_TO_VERB);
+	gPoints.push_back(Center);
+	gPoints.push_back(Center + u);
+	gPoints.push_back(Center + v);
+	gPoints.push_back(Center + u * GMath::Cos(endAngle) + v * GMath::Sin(endAngle));
+	gArcAngles.push_back(StartAngle);
+	gArcAngles.push_back(SweepAngle);
+}
+
+void GPathData::ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+					  const GPoint2& P) {
+
+	GPoint2 p0 = CurrentPoint(), center;
+	GVector2 u, v;
+	GReal startAngle, sweepAngle;
+
+	if (Distance(p0, P) <= G_EPSILON)
+		return;
+	if (!GPathData::ArcCenterParameters(p0, Rx, Ry, XRot, LargeArc, Sweep, P, center, u, v, startAngle, sweepAngle)) {
+		LineTo(P);
+		return;
+	}
+	EnsureContour();
+	gVerbs.push_back(G_ARC_TO_VERB);
+	gPoints.push_back(center);
+	gPoints.push_back(center + u);
+	gPoints.push_back(center + v);
+	gPoints.push_back(P);
+	gArcAngles.push_back(startAngle);
+	gArcAngles.push_back(sweepAngle);
+}
+
+void GPathData::ClosePath() {
+
+	if (gNeedMove)
+		return;
+	gVerbs.push_back(G_CLOSE_VERB);
+	gNeedMove = G_TRUE;
+}
+
+GError GPathData::AppendPath(const GPath2D& Path, const GReal MaxDeviation) {
+
+	GUInt32 i, j, k, n = Path.SegmentsCount();
+	const GCurve2D *seg;
+	GDynArray<GPoint2> pts;
+	GReal startAngle, endAngle, sweepAngle;
+	GError err;
+
+	if (n == 0)
+		return G_NO_ERROR;
+
+	MoveTo(Path.StartPoint());
+	for (i = 0; i < n; ++i) {
+		seg = Path.Segment(i);
+		if (seg->ClassID() == G_POLYLINECURVE2D_CLASSID) {
+			const GPolyLineCurve2D *poly = (const GPolyLineCurve2D *)seg;
+			k = poly->PointsCount();
+			for (j = 1; j < k; ++j)
+				// skip the degenerate lines that join arcs
+				if (!RoundoffEqual(gPoints.back(), poly->Point(j)))
+					LineTo(poly->Point(j));
+		}
+		else
+		if (seg->ClassID() == G_BEZIERCURVE2D_CLASSID && ((const GBezierCurve2D *)seg)->Degree() <= 3) {
+			const GBezierCurve2D *bez = (const GBezierCurve2D *)seg;
+			if (bez->Degree() == 1)
+				LineTo(bez->Point(1));
+			else
+			if (bez->Degree() == 2)
+				QuadTo(bez->Point(1), bez->Point(2));
+			else
+				CubicTo(bez->Point(1), bez->Point(2), bez->Point(3));
+		}
+		else
+		if (seg->ClassID() == G_ELLIPSECURVE2D_CLASSID) {
+			const GEllipseCurve2D *ell = (const GEllipseCurve2D *)seg;
+			// sweep angle as GEllipseCurve2D::MapAngle spans the domain
+			startAngle = ell->StartAngle();
+			endAngle = ell->EndAngle();
+			if (ell->CCW())
+				sweepAngle = (startAngle < endAngle) ? endAngle - startAngle : (GReal)G_2PI - startAngle + endAngle;
+			else
+				sweepAngle = (startAngle < endAngle) ? -((GReal)G_2PI - endAngle + startAngle) : endAngle - startAngle;
+			ArcTo(ell->Center(), ell->XSemiAxisLength(), ell->YSemiAxisLength(), ell->OffsetRotation(),
+				  startAngle, sweepAngle);
+		}
+		else {
+			// other curves can't be represented exactly
+			pts.clear();
+			err = seg->Flatten(pts, MaxDeviation, G_TRUE);
+			if (err != G_NO_ERROR)
+				return err;
+			k = (GUInt32)pts.size();
+			for (j = 1; j < k; ++j)
+				LineTo(pts[j]);
+		}
+	}
+	if (Path.IsClosed()) {
+		// the closing line is implied by the close verb
+		if (gVerbs.back() == G_LINE_TO_VERB && gVerbs[gVerbs.size() - 2] != G_MOVE_TO_VERB &&
+			RoundoffEqual(gPoints.back(), gPoints[gContourStart])) {
+			gVerbs.pop_back();
+			gPoints.pop_back();
+		}
+		ClosePath();
+	}
+	return G_NO_ERROR;
+}
+
+GError GPathData::ToPaths(GKernel& Kernel, GDynArray<GPath2D *>& Paths) const {
+
+	GPathBuilder builder(Kernel, Paths);
+	GUInt32 i, j = (GUInt32)gVerbs.size(), k = 0, a = 0;
+
+	for (i = 0; i < j; ++i) {
+		switch (gVerbs[i]) {
+			case G_MOVE_TO_VERB:
+				builder.MoveTo(gPoints[k]);
+				break;
+			case G_LINE_TO_VERB:
+				builder.LineTo(gPoints[k]);
+				break;
+			case G_QUAD_TO_VERB:
+				builder.QuadTo(gPoints[k], gPoints[k + 1]);
+				break;
+			case G_CUBIC_TO_VERB:
+				builder.CubicTo(gPoints[k], gPoints[k + 1], gPoints[k + 2]);
+				break;
+			case G_ARC_TO_VERB:
+				builder.ArcTo(gPoints[k], gPoints[k + 1] - gPoints[k], gPoints[k + 2] - gPoints[k],
+							  gArcAngles[a], gArcAngles[a + 1]);
+				a += 2;
+				break;
+			case G_CLOSE_VERB:
+				builder.ClosePath();
+				break;
+		}
+		k += gVerbPointsCount[gVerbs[i]];
+	}
+	builder.Finish();
+	return builder.gError;
+}
+
+GError GPathData::Flatten(const GReal MaxDeviation, GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+						  GDynArray<GBool>& ClosedContours) const {
+
+	if (MaxDeviation <= 0)
+		return G_INVALID_PARAMETER;
+
+	GPathFlattener flattener(Points, PointsPerContour, ClosedContours, MaxDeviation);
+	GUInt32 i, j = (GUInt32)gVerbs.size(), k = 0, a = 0;
+
+	for (i = 0; i < j; ++i) {
+		switch (gVerbs[i]) {
+			case G_MOVE_TO_VERB:
+				flattener.MoveTo(gPoints[k]);
+				break;
+			case G_LINE_TO_VERB:
+				flattener.LineTo(gPoints[k]);
+				break;
+			case G_QUAD_TO_VERB:
+				flattener.QuadTo(gPoints[k], gPoints[k + 1]);
+				break;
+			case G_CUBIC_TO_VERB:
+				flattener.CubicTo(gPoints[k], gPoints[k + 1], gPoints[k + 2]);
+				break;
+			case G_ARC_TO_VERB:
+				flattener.ArcTo(gPoints[k], gPoints[k + 1] - gPoints[k], gPoints[k + 2] - gPoints[k],
+								gArcAngles[a], gArcAngles[a + 1], gPoints[k + 3]);
+				a += 2;
+				break;
+			case G_CLOSE_VERB:
+				flattener.ClosePath();
+				break;
+		}
+		k += gVerbPointsCount[gVerbs[i]];
+	}
+	flattener.Finish();
+	return G_NO_ERROR;
+}
+
+GError GPathData::BoundingBox(GAABox2& Box) const {
+
+	GUInt32 i, j = (GUInt32)gVerbs.size(), k = 0, a = 0, h, w, n;
+	GPoint2 cursor(0, 0), minP, maxP, p;
+	GVector2 u, v;
+	GReal roots[2], t, s;
+
+	if (gPoints.empty())
+		return G_INVALID_OPERATION;
+
+	minP = maxP = gPoints[0];
+	for (i = 0; i < j; ++i) {
+		switch (gVerbs[i]) {
+			case G_MOVE_TO_VERB:
+			case G_LINE_TO_VERB:
+				p = gPoints[k];
+				minP[G_X] = GMath::Min(minP[G_X], p[G_X]);
+				minP[G_Y] = GMath::Min(minP[G_Y], p[G_Y]);
+				maxP[G_X] = GMath::Max(maxP[G_X], p[G_X]);
+				maxP[G_Y] = GMath::Max(maxP[G_Y], p[G_Y]);
+				cursor = p;
+				break;
+
+			case G_QUAD_TO_VERB: {
+				const GPoint2& p1 = gPoints[k];
+				const GPoint2& p2 = gPoints[k + 1];
+				for (h = 0; h < 2; ++h) {
+					// extremes where the derivative vanishes
+					t = cursor[h] - 2 * p1[h] + p2[h];
+					if (t != 0) {
+						t = (cursor[h] - p1[h]) / t;
+						if (t > 0 && t < 1) {
+							s = 1 - t;
+							s = s * s * cursor[h] + 2 * s * t * p1[h] + t * t * p2[h];
+							minP[h] = GMath::Min(minP[h], s);
+							maxP[h] = GMath::Max(maxP[h], s);
+						}
+					}
+					minP[h] = GMath::Min(minP[h], p2[h]);
+					maxP[h] = GMath::Max(maxP[h], p2[h]);
+				}
+				cursor = p2;
+				break;
+			}
+
+			case G_CUBIC_TO_VERB: {
+				const GPoint2& p1 = gPoints[k];
+				const GPoint2& p2 = gPoints[k + 1];
+				const GPoint2& p3 = gPoints[k + 2];
+				for (h = 0; h < 2; ++h) {
+					// derivative is 3 times a quadratic Bezier with control values d0, d1, d2
+					GReal d0 = p1[h] - cursor[h], d1 = p2[h] - p1[h], d2 = p3[h] - p2[h];
+					n = SolveQuadratic(d0 - 2 * d1 + d2, 2 * (d1 - d0), d0, roots);
+					for (w = 0; w < n; ++w) {
+						t = roots[w];
+						if (t > 0 && t < 1) {
+							GReal values[4] = { cursor[h], p1[h], p2[h], p3[h] };
+							s = CubicValue(values, t);
+							minP[h] = GMath::Min(minP[h], s);
+							maxP[h] = GMath::Max(maxP[h], s);
+						}
+					}
+					minP[h] = GMath::Min(minP[h], p3[h]);
+					maxP[h] = GMath::Max(maxP[h], p3[h]);
+				}
+				cursor = p3;
+				break;
+			}
+
+			case G_ARC_TO_VERB: {
+				const GPoint2& c = gPoints[k];
+				u = gPoints[k + 1] - c;
+				v = gPoints[k + 2] - c;
+				for (h = 0; h < 2; ++h) {
+					// c + u cos(t) + v sin(t) has its extremes at t = atan2(v, u) + k * PI
+					t = GMath::Atan2(v[h], u[h]);
+					for (w = 0; w < 2; ++w) {
+						if (AngleInsideArc(t, gArcAngles[a], gArcAngles[a + 1], s)) {
+							s = c[h] + u[h] * GMath::Cos(t) + v[h] * GMath::Sin(t);
+							minP[h] = GMath::Min(minP[h], s);
+							maxP[h] = GMath::Max(maxP[h], s);
+						}
+						t += (GReal)G_PI;
+					}
+					minP[h] = GMath::Min(minP[h], gPoints[k + 3][h]);
+					maxP[h] = GMath::Max(maxP[h], gPoints[k + 3][h]);
+				}
+				cursor = gPoints[k + 3];
+				a += 2;
+				break;
+			}
+
+			case G_CLOSE_VERB:
+				break;
+		}
+		k += gVerbPointsCount[gVerbs[i]];
+	}
+	Box.SetMinMax(minP, maxP);
+	return G_NO_ERROR;
+}
+
+GBool GPathData::IntersectRay(const GRay2& NormalizedRay, GDynArray<GVector2>& Intersections,
+							  const GReal Precision, const GUInt32 MaxIterations) const {
+
+	const GPoint2& o = NormalizedRay.Origin();
+	const GVector2& d = NormalizedRay.Direction();
+	GUInt32 i, j = (GUInt32)gVerbs.size(), k = 0, a = 0, n, w, it, startIndex = 0;
+	GUInt32 oldSize = (GUInt32)Intersections.size();
+	// ray frame coordinates: x along the ray, y along its normal
+	GReal x[4], y[4], roots[4], t, s, ft, fs, fm, m;
+	GPoint2 cursor(0, 0), start(0, 0);
+
+	#define RAY_X(P) (((P)[G_X] - o[G_X]) * d[G_X] + ((P)[G_Y] - o[G_Y]) * d[G_Y])
+	#define RAY_Y(P) (((P)[G_Y] - o[G_Y]) * d[G_X] - ((P)[G_X] - o[G_X]) * d[G_Y])
+	#define ADD_INTERSECTION(LocalParam, RayParam) \
+		if ((RayParam) >= 0) \
+			Intersections.push_back(GVector2((GReal)i + (LocalParam), (RayParam)));
+
+	for (i = 0; i < j; ++i) {
+		switch (gVerbs[i]) {
+			case G_MOVE_TO_VERB:
+				cursor = start = gPoints[k];
+				startIndex = k;
+				break;
+
+			case G_CLOSE_VERB:
+			case G_LINE_TO_VERB: {
+				const GPoint2& p1 = (gVerbs[i] == G_CLOSE_VERB) ? gPoints[startIndex] : gPoints[k];
+				y[0] = RAY_Y(cursor);
+				y[1] = RAY_Y(p1);
+				// parallel segments don't intersect the ray in a single point
+				if (y[0] != y[1] && ((y[0] <= 0 && y[1] >= 0) || (y[0] >= 0 && y[1] <= 0))) {
+					t = y[0] / (y[0] - y[1]);
+					x[0] = RAY_X(cursor);
+					x[1] = RAY_X(p1);
+					ADD_INTERSECTION(t, x[0] + t * (x[1] - x[0]))
+				}
+				cursor = p1;
+				break;
+			}
+
+			case G_QUAD_TO_VERB: {
+				const GPoint2& p1 = gPoints[k];
+				const GPoint2& p2 = gPoints[k + 1];
+				y[0] = RAY_Y(cursor);
+				y[1] = RAY_Y(p1);
+				y[2] = RAY_Y(p2);
+				n = SolveQuadratic(y[0] - 2 * y[1] + y[2], 2 * (y[1] - y[0]), y[0], roots);
+				if (n > 0) {
+					x[0] = RAY_X(cursor);
+					x[1] = RAY_X(p1);
+					x[2] = RAY_X(p2);
+					for (w = 0; w < n; ++w) {
+						t = roots[w];
+						if (t >= 0 && t <= 1) {
+							s = 1 - t;
+							ADD_INTERSECTION(t, s * s * x[0] + 2 * s * t * x[1] + t * t * x[2])
+						}
+					}
+				}
+				cursor = p2;
+				break;
+			}
+
+			case G_CUBIC_TO_VERB: {
+				const GPoint2& p1 = gPoints[k];
+				const GPoint2& p2 = gPoints[k + 1];
+				const GPoint2& p3 = gPoints[k + 2];
+				y[0] = RAY_Y(cursor);
+				y[1] = RAY_Y(p1);
+				y[2] = RAY_Y(p2);
+				y[3] = RAY_Y(p3);
+				// quick rejection, the curve lies inside the convex hull of its control points
+				if ((y[0] > 0 && y[1] > 0 && y[2] > 0 && y[3] > 0) || (y[0] < 0 && y[1] < 0 && y[2] < 0 && y[3] < 0)) {
+					cursor = p3;
+					break;
+				}
+				x[0] = RAY_X(cursor);
+				x[1] = RAY_X(p1);
+				x[2] = RAY_X(p2);
+				x[3] = RAY_X(p3);
+				// split [0; 1] where y(t) is monotone, using the roots of its derivative
+				n = SolveQuadratic(y[1] - y[0] - 2 * (y[2] - y[1]) + y[3] - y[2], 2 * (y[2] - 2 * y[1] + y[0]),
+								   y[1] - y[0], roots + 1);
+				if (n == 2 && roots[1] > roots[2]) {
+					t = roots[1];
+					roots[1] = roots[2];
+					roots[2] = t;
+				}
+				roots[0] = 0;
+				w = 1;
+				for (it = 1; it <= n; ++it)
+					if (roots[it] > 0 && roots[it] < 1)
+						roots[w++] = roots[it];
+				roots[w] = 1;
+				n = w;
+				for (w = 0; w < n; ++w) {
+					t = roots[w];
+					s = roots[w + 1];
+					ft = CubicValue(y, t);
+					fs = CubicValue(y, s);
+					// a root on the bound between two intervals is taken once, as the end of the first one
+					if (w == 0 && ft == 0)
+						m = t;
+					else
+					if (fs == 0)
+						m = s;
+					else
+					if ((ft < 0) == (fs < 0) || ft == 0)
+						continue;
+					else {
+						// bisection, the function is monotone inside the interval
+						for (it = 0; it < MaxIterations && s - t > Precision; ++it) {
+							m = (t + s) * (GReal)0.5;
+							fm = CubicValue(y, m);
+							if (fm == 0) {
+								t = s = m;
+								break;
+							}
+							if ((fm < 0) == (ft < 0)) {
+								t = m;
+								ft = fm;
+							}
+							else
+								s = m;
+						}
+						m = (t + s) * (GReal)0.5;
+					}
+					ADD_INTERSECTION(m, CubicValue(x, m))
+				}
+				cursor = p3;
+				break;
+			}
+
+			case G_ARC_TO_VERB: {
+				const GPoint2& c = gPoints[k];
+				GReal yc = RAY_Y(c), xc = RAY_X(c);
+				GReal yu = RAY_Y(gPoints[k + 1]) - yc, yv = RAY_Y(gPoints[k + 2]) - yc;
+				GReal xu = RAY_X(gPoints[k + 1]) - xc, xv = RAY_X(gPoints[k + 2]) - xc;
+				// solve yc + yu cos(t) + yv sin(t) = 0
+				m = GMath::Sqrt(yu * yu + yv * yv);
+				if (m > 0 && GMath::Abs(yc) <= m) {
+					t = GMath::Atan2(yv, yu);
+					s = GMath::Acos(GMath::Clamp(-yc / m, (GReal)-1, (GReal)1));
+					roots[0] = t - s;
+					roots[1] = t + s;
+					// a tangent ray touches the arc once
+					n = (s == 0) ? 1 : 2;
+					for (w = 0; w < n; ++w) {
+						if (AngleInsideArc(roots[w], gArcAngles[a], gArcAngles[a + 1], fm)) {
+							ADD_INTERSECTION(fm, xc + xu * GMath::Cos(roots[w]) + xv * GMath::Sin(roots[w]))
+						}
+					}
+				}
+				cursor = gPoints[k + 3];
+				a += 2;
+				break;
+			}
+		}
+		k += gVerbPointsCount[gVerbs[i]];
+	}
+
+	#undef RAY_X
+	#undef RAY_Y
+	#undef ADD_INTERSECTION
+
+	return ((GUInt32)Intersections.size() > oldSize);
+}
+
+void GPathData::XForm(const GMatrix23& Matrix) {
+
+	// semi-diameters of arcs are stored as points, so every entry goes through the same transformation
+	if (gPoints.size() > 0)
+		GBulkXForm::XForm(Matrix, &gPoints[0], &gPoints[0], (GUInt32)gPoints.size());
+}
+
+void GPathData::XForm(const GMatrix33& Matrix, const GBool DoProjection) {
+
+	if (gPoints.size() > 0)
+		GBulkXForm::XForm(Matrix, DoProjection, &gPoints[0], &gPoints[0], (GUInt32)gPoints.size());
+}
+
+GBool GPathData::ArcCenterParameters(const GPoint2& P0, const GReal Rx, const GReal Ry, const GReal XRot,
+									 const GBool LargeArc, const GBool Sweep, const GPoint2& P1,
+									 GPoint2& Center, GVector2& U, GVector2& V,
+									 GReal& StartAngle, GReal& SweepAngle) {
+
+	// endpoint to center parametrization, see SVG specifications (appendix F.6.5)
+	GReal cs = GMath::Cos(XRot), sn = GMath::Sin(XRot), rx = GMath::Abs(Rx), ry = GMath::Abs(Ry);
+	GReal dx2 = (P0[G_X] - P1[G_X]) * (GReal)0.5, dy2 = (P0[G_Y] - P1[G_Y]) * (GReal)0.5;
+	GReal x1 = cs * dx2 + sn * dy2, y1 = -sn * dx2 + cs * dy2;
+	GReal lambda, num, den, coef, cx, cy, ux, uy, vx, vy, dTheta;
+
+	if (rx <= G_EPSILON || ry <= G_EPSILON || Distance(P0, P1) <= G_EPSILON)
+		return G_FALSE;
+
+	// scale up radii that are too small to join arc ends
+	lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+	if (lambda >= 1) {
+		lambda = GMath::Sqrt(lambda);
+		rx *= lambda;
+		ry *= lambda;
+		// the center lies on the chord, num below would be just roundoff amplified by the square root
+		coef = 0;
+	}
+	else {
+		num = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+		den = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+		coef = (num > 0 && den > 0) ? GMath::Sqrt(num / den) : 0;
+	}
+	if (LargeArc == Sweep)
+		coef = -coef;
+	cx = coef * rx * y1 / ry;
+	cy = -coef * ry * x1 / rx;
+	ux = (x1 - cx) / rx;
+	uy = (y1 - cy) / ry;
+	vx = (-x1 - cx) / rx;
+	vy = (-y1 - cy) / ry;
+	StartAngle = GMath::Atan2(uy, ux);
+	dTheta = GMath::Atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+	if (!Sweep && dTheta > 0)
+		dTheta -= (GReal)G_2PI;
+	else
+	if (Sweep && dTheta < 0)
+		dTheta += (GReal)G_2PI;
+	SweepAngle = dTheta;
+	// move center into user space
+	Center.Set(cs * cx - sn * cy + (P0[G_X] + P1[G_X]) * (GReal)0.5, sn * cx + cs * cy + (P0[G_Y] + P1[G_Y]) * (GReal)0.5);
+	U.Set(cs * rx, sn * rx);
+	V.Set(-sn * ry, cs * ry);
+	return G_TRUE;
+}
+
+void GPathData::ArcPrincipalAxes(const GVector2& U, const GVector2& V, const GReal StartAngle,
+								 const GReal SweepAngle, GReal& XSemiAxisLength, GReal& YSemiAxisLength,
+								 GReal& OffsetRotation, GReal& NewStartAngle, GReal& NewSweepAngle) {
+
+	GReal uv = Dot(U, V), phi = 0, c, s;
+	GVector2 u = U, v = V;
+
+	/*
+		U cos(t) + V sin(t) = U' cos(t - phi) + V' sin(t - phi), where U' = U cos(phi) + V sin(phi) and
+		V' = V cos(phi) - U sin(phi); phi is chosen so that U' and V' are orthogonal.
+	*/
+	if (uv != 0) {
+		phi = (GReal)0.5 * GMath::Atan2(2 * uv, Dot(U, U) - Dot(V, V));
+		c = GMath::Cos(phi);
+		s = GMath::Sin(phi);
+		u = U * c + V * s;
+		v = V * c - U * s;
+	}
+	XSemiAxisLength = u.Length();
+	YSemiAxisLength = v.Length();
+	OffsetRotation = GMath::Atan2(u[G_Y], u[G_X]);
+	NewStartAngle = StartAngle - phi;
+	NewSweepAngle = SweepAngle;
+	// a reflected ellipse goes the other way round
+	if (Cross(u, v) < 0) {
+		NewStartAngle = -NewStartAngle;
+		NewSweepAngle = -NewSweepAngle;
+	}
+}
+
+};	// end namespace Amanith
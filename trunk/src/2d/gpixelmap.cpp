@@ -32,6 +32,13 @@
 #include "amanith/numerics/gfilter.h"
 #include <new> // for nothrow
 #include <cstring>  // for memcpy function
+#include <algorithm>
+
+// SSE2 is always available on x86-64, and on x86 when the compiler has been told so
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define G_PIXELMAP_SSE2
+	#include <emmintrin.h>
+#endif
 
 /*!
 	\file gpixelmap.cpp
@@ -40,345 +47,981 @@
 
 namespace Amanith {
 
+// *********************************************************************
+//                          Color quantization
+// *********************************************************************
+
+// colors are reduced to 5 bits per channel, both in histogram and in the inverse color map
+#define G_QUANT_CELLS 32768
+// number of rows mapped by a single job
+#define G_QUANT_ROWS_PER_JOB 32
+
+static inline GUInt32 QuantCell(const GUInt32 Red, const GUInt32 Green, const GUInt32 Blue) {
+
+	return (((Red >> 3) << 10) | ((Green >> 3) << 5) | (Blue >> 3));
+}
+
+static inline GUInt32 QuantCellComponent(const GUInt32 Cell, const GUInt32 Channel) {
+
+	return ((Cell >> (10 - Channel * 5)) & 31);
+}
+
+// histogram cell
+struct GQuantCell {
+	// number of pixels that fall into this cell
+	GUInt32 Count;
+	// sum of full precision components
+	GDouble Sums[3];
+};
+
+// median cut box, it contains the (non empty) cells in the range [Begin; End)
+struct GQuantBox {
+	GUInt32 Begin;
+	GUInt32 End;
+	GDouble Count;
+	GInt32 Min[3];
+	GInt32 Max[3];
+};
+
+// used to sort cells along a channel axis
+struct GQuantCellLess {
+	GUInt32 Channel;
 
-struct GColorNode {
-	// G_TRUE if node has no children
-	GBool gIsLeaf;
-	// number of pixels represented by this leaf
-	GUInt32 gPixelCount;
-	// sum of red components
-	GULong gRedSum;
-	// sum of green components
-	GUInt32 gGreenSum;
-	// sum of blue components
-	GUInt32 gBlueSum;
-	// pointers to child nodes
-	GColorNode* gChildren[8];
-	// pointer to next reducible node
-	GColorNode* gNext;
-
-	// constructor
-	GColorNode() {
-		gIsLeaf = G_FALSE;
-		gPixelCount = 0;
-		gRedSum = 0;
-		gGreenSum = 0;
-		gBlueSum = 0;
-		gChildren[0] = NULL;
-		gChildren[1] = NULL;
-		gChildren[2] = NULL;
-		gChildren[3] = NULL;
-		gChildren[4] = NULL;
-		gChildren[5] = NULL;
-		gChildren[6] = NULL;
-		gChildren[7] = NULL;
-		gNext = NULL;
+	GQuantCellLess(const GUInt32 SortChannel) : Channel(SortChannel) {
+	}
+	inline bool operator()(const GUInt32 Cell1, const GUInt32 Cell2) const {
+
+		GUInt32 c1 = QuantCellComponent(Cell1, Channel);
+		GUInt32 c2 = QuantCellComponent(Cell2, Channel);
+		return ((c1 < c2) || (c1 == c2 && Cell1 < Cell2));
 	}
 };
 
-static GColorNode* CreateNode(GUInt32 nLevel, GUInt32 nColorBits, GUInt32* pLeafCount, GColorNode** pReducibleNodes) {
+// data shared by quantization jobs
+struct GQuantJobsData {
+	const GPixelMap *Image;
+	GUChar8 *NewPixels;
+	const GUInt32 *Palette;
+	GUInt32 PaletteCount;
+	GUChar8 *InverseMap;
+	GDitherMode DitherMode;
+	GInt32 DitherSpread;
+};
 
-	GColorNode* pNode = NULL;
+// read a row of pixels, as 0x00RRGGBB values
+static void QuantReadRow(const GPixelMap& Image, const GUInt32 *Palette, const GInt32 Y, GUInt32 *Row) {
 
-	pNode = new(std::nothrow) GColorNode();
-	if (!pNode)
-		return NULL;
+	GInt32 i, w = Image.Width();
+	GUInt32 c, r, g, b;
+	const GUChar8 *pixels8;
+	const GUInt16 *pixels16;
+	const GUInt32 *pixels32;
 
-	pNode->gIsLeaf = (nLevel == nColorBits) ? G_TRUE : G_FALSE;
-	if (pNode->gIsLeaf)
-		(*pLeafCount)++;
-	else {
-		// add the node to the reducible list for this level
-		pNode->gNext = pReducibleNodes[nLevel];
-		pReducibleNodes[nLevel] = pNode;
+	switch (Image.PixelFormat()) {
+		case G_GRAYSCALE:
+			pixels8 = Image.Pixels() + Y * w;
+			for (i = 0; i < w; ++i) {
+				c = pixels8[i];
+				Row[i] = (c << 16) | (c << 8) | c;
+			}
+			break;
+		case G_RGB_PALETTE:
+			pixels8 = Image.Pixels() + Y * w;
+			for (i = 0; i < w; ++i)
+				Row[i] = Palette[pixels8[i]] & 0x00FFFFFF;
+			break;
+		case G_A1R5G5B5:
+			pixels16 = (const GUInt16 *)Image.Pixels() + Y * w;
+			for (i = 0; i < w; ++i) {
+				c = pixels16[i];
+				r = ((c >> 10) & 31) << 3;
+				g = ((c >> 5) & 31) << 3;
+				b = (c & 31) << 3;
+				Row[i] = (r << 16) | (g << 8) | b;
+			}
+			break;
+		case G_R5G6B5:
+			pixels16 = (const GUInt16 *)Image.Pixels() + Y * w;
+			for (i = 0; i < w; ++i) {
+				c = pixels16[i];
+				r = ((c >> 11) & 31) << 3;
+				g = ((c >> 5) & 63) << 2;
+				b = (c & 31) << 3;
+				Row[i] = (r << 16) | (g << 8) | b;
+			}
+			break;
+		case G_R8G8B8:
+		case G_A8R8G8B8:
+			pixels32 = (const GUInt32 *)Image.Pixels() + Y * w;
+			for (i = 0; i < w; ++i)
+				Row[i] = pixels32[i] & 0x00FFFFFF;
+			break;
 	}
-	return pNode;
 }
 
-static void AddColor(GColorNode** ppNode, GUChar8 r, GUChar8 g, GUChar8 b, GUInt32 nColorBits,
-					GUInt32 nLevel, GUInt32* pLeafCount, GColorNode** pReducibleNodes) {
-	
-	GInt32 nIndex, shift;
-	static GUChar8 mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+static GUInt32 QuantNearestColor(const GUInt32 *Palette, const GUInt32 PaletteCount,
+								 const GInt32 Red, const GInt32 Green, const GInt32 Blue) {
+
+	GUInt32 i, best = 0, c;
+	GInt32 d, dr, dg, db, bestDist = G_MAX_INT32;
+
+	for (i = 0; i < PaletteCount; ++i) {
+		c = Palette[i];
+		dr = (GInt32)((c >> 16) & 0xFF) - Red;
+		dg = (GInt32)((c >> 8) & 0xFF) - Green;
+		db = (GInt32)(c & 0xFF) - Blue;
+		d = dr * dr + dg * dg + db * db;
+		if (d < bestDist) {
+			bestDist = d;
+			best = i;
+		}
+	}
+	return best;
+}
 
-	// if the node doesn't exist, create it
-	if (*ppNode == NULL)
-		*ppNode = CreateNode(nLevel, nColorBits, pLeafCount, pReducibleNodes);
+// compute the box extent, and return the channel with the longest side
+static GUInt32 QuantBoxUpdate(GQuantBox& Box, const GDynArray<GUInt32>& Cells,
+							  const GDynArray<GQuantCell>& Histogram) {
 
-	// update color information if it's a leaf node
-	if ((*ppNode)->gIsLeaf) {
-		(*ppNode)->gPixelCount++;
-		(*ppNode)->gRedSum += r;
-		(*ppNode)->gGreenSum += g;
-		(*ppNode)->gBlueSum += b;
+	GUInt32 i, k, c, best;
+	GInt32 v;
+
+	Box.Count = 0;
+	for (k = 0; k < 3; ++k) {
+		Box.Min[k] = 31;
+		Box.Max[k] = 0;
 	}
-	// recurse a level deeper if the node is not a leaf
-	else {
-		shift = 7 - nLevel;
-		nIndex = (((r & mask[nLevel]) >> shift) << 2) |	(((g & mask[nLevel]) >> shift) << 1) |
-					((b & mask[nLevel]) >> shift);
-		AddColor(&((*ppNode)->gChildren[nIndex]), r, g, b, nColorBits, nLevel + 1, pLeafCount, pReducibleNodes);
+	for (i = Box.Begin; i < Box.End; ++i) {
+		c = Cells[i];
+		Box.Count += Histogram[c].Count;
+		for (k = 0; k < 3; ++k) {
+			v = (GInt32)QuantCellComponent(c, k);
+			if (v < Box.Min[k])
+				Box.Min[k] = v;
+			if (v > Box.Max[k])
+				Box.Max[k] = v;
+		}
 	}
+	best = 0;
+	for (k = 1; k < 3; ++k) {
+		if (Box.Max[k] - Box.Min[k] > Box.Max[best] - Box.Min[best])
+			best = k;
+	}
+	return best;
 }
 
-static void ReduceTree(GUInt32 nColorBits, GUInt32* pLeafCount, GColorNode** pReducibleNodes) {
+// median cut palette generation
+static GUInt32 QuantMedianCut(GDynArray<GUInt32>& Cells, const GDynArray<GQuantCell>& Histogram,
+							  const GUInt32 MaxColors, GUInt32 *Palette) {
+
+	GDynArray<GQuantBox> boxes;
+	GQuantBox box, box2;
+	GUInt32 i, j, k, axis, split;
+	GDouble score, bestScore, acc, sums[3], count;
+	GInt32 bestBox;
+
+	box.Begin = 0;
+	box.End = (GUInt32)Cells.size();
+	QuantBoxUpdate(box, Cells, Histogram);
+	boxes.push_back(box);
+
+	while ((GUInt32)boxes.size() < MaxColors) {
+		// choose the most populated and extended box
+		bestBox = -1;
+		bestScore = 0;
+		j = (GUInt32)boxes.size();
+		for (i = 0; i < j; ++i) {
+			if (boxes[i].End - boxes[i].Begin < 2)
+				continue;
+			k = 0;
+			for (axis = 1; axis < 3; ++axis) {
+				if (boxes[i].Max[axis] - boxes[i].Min[axis] > boxes[i].Max[k] - boxes[i].Min[k])
+					k = axis;
+			}
+			score = boxes[i].Count * (GDouble)(boxes[i].Max[k] - boxes[i].Min[k] + 1);
+			if (score > bestScore) {
+				bestScore = score;
+				bestBox = (GInt32)i;
+			}
+		}
+		// no more splittable boxes
+		if (bestBox < 0)
+			break;
+
+		box = boxes[bestBox];
+		axis = QuantBoxUpdate(box, Cells, Histogram);
+		std::sort(Cells.begin() + box.Begin, Cells.begin() + box.End, GQuantCellLess(axis));
+		// split at median
+		acc = 0;
+		split = box.Begin + 1;
+		for (i = box.Begin; i < box.End - 1; ++i) {
+			acc += Histogram[Cells[i]].Count;
+			split = i + 1;
+			if (acc >= box.Count * 0.5)
+				break;
+		}
+		box2.Begin = split;
+		box2.End = box.End;
+		box.End = split;
+		QuantBoxUpdate(box, Cells, Histogram);
+		QuantBoxUpdate(box2, Cells, Histogram);
+		boxes[bestBox] = box;
+		boxes.push_back(box2);
+	}
 
-	GInt32 i;
-	GColorNode* pNode;
-	GUInt32 nRedSum, nGreenSum, nBlueSum, nChildren;
-
-	// Find the deepest level containing at least one reducible node
-	for (i = nColorBits - 1; (i > 0) && (pReducibleNodes[i] == NULL); i--);
-
-	// Reduce the node most recently added to the list at level i
-	pNode = pReducibleNodes[i];
-	pReducibleNodes[i] = pNode->gNext;
-
-	nRedSum = nGreenSum = nBlueSum = nChildren = 0;
-	for (i = 0; i < 8; i++) {
-		if (pNode->gChildren[i] != NULL) {
-			nRedSum += pNode->gChildren[i]->gRedSum;
-			nGreenSum += pNode->gChildren[i]->gGreenSum;
-			nBlueSum += pNode->gChildren[i]->gBlueSum;
-			pNode->gPixelCount += pNode->gChildren[i]->gPixelCount;
-			delete pNode->gChildren[i];
-			pNode->gChildren[i] = NULL;
-			nChildren++;
+	// every palette entry is the mean color of a box
+	j = (GUInt32)boxes.size();
+	for (i = 0; i < j; ++i) {
+		sums[0] = sums[1] = sums[2] = count = 0;
+		for (k = boxes[i].Begin; k < boxes[i].End; ++k) {
+			const GQuantCell& cell = Histogram[Cells[k]];
+			sums[0] += cell.Sums[0];
+			sums[1] += cell.Sums[1];
+			sums[2] += cell.Sums[2];
+			count += cell.Count;
+		}
+		Palette[i] = ((GUInt32)(sums[0] / count + 0.5) << 16) | ((GUInt32)(sums[1] / count + 0.5) << 8) |
+					 (GUInt32)(sums[2] / count + 0.5);
+	}
+	return j;
+}
+
+// k-means palette refinement, working on histogram cells weighted by their pixels count
+static void QuantRefine(const GDynArray<GUInt32>& Cells, const GDynArray<GQuantCell>& Histogram,
+						const GUInt32 Iterations, GUInt32 *Palette, const GUInt32 PaletteCount) {
+
+	GDynArray<GDouble> sums(PaletteCount * 4);
+	GUInt32 i, j, k, it, best;
+	GDouble count;
+
+	j = (GUInt32)Cells.size();
+	for (it = 0; it < Iterations; ++it) {
+		std::fill(sums.begin(), sums.end(), (GDouble)0);
+		for (i = 0; i < j; ++i) {
+			const GQuantCell& cell = Histogram[Cells[i]];
+			count = (GDouble)cell.Count;
+			best = QuantNearestColor(Palette, PaletteCount, (GInt32)(cell.Sums[0] / count + 0.5),
+									 (GInt32)(cell.Sums[1] / count + 0.5), (GInt32)(cell.Sums[2] / count + 0.5));
+			sums[best * 4] += cell.Sums[0];
+			sums[best * 4 + 1] += cell.Sums[1];
+			sums[best * 4 + 2] += cell.Sums[2];
+			sums[best * 4 + 3] += count;
+		}
+		for (k = 0; k < PaletteCount; ++k) {
+			count = sums[k * 4 + 3];
+			// unused colors are left untouched
+			if (count > 0)
+				Palette[k] = ((GUInt32)(sums[k * 4] / count + 0.5) << 16) |
+							 ((GUInt32)(sums[k * 4 + 1] / count + 0.5) << 8) |
+							 (GUInt32)(sums[k * 4 + 2] / count + 0.5);
 		}
 	}
-	pNode->gIsLeaf = G_TRUE;
-	pNode->gRedSum = nRedSum;
-	pNode->gGreenSum = nGreenSum;
-	pNode->gBlueSum = nBlueSum;
-	*pLeafCount -= (nChildren - 1);
 }
 
-void DeleteTree(GColorNode** ppNode) {
+// build the inverse color map slice relative to a single red value
+static void QuantInverseMapJob(void *Data, const GUInt32 JobIndex) {
 
-	GInt32 i;
+	GQuantJobsData *jobs = (GQuantJobsData *)Data;
+	GUInt32 g, b, ofs = JobIndex << 10;
+	GInt32 red = (GInt32)((JobIndex << 3) + 4);
 
-	for (i = 0; i < 8; i++) {
-		if ((*ppNode)->gChildren[i] != NULL)
-			DeleteTree(&((*ppNode)->gChildren[i]));
+	for (g = 0; g < 32; ++g) {
+		for (b = 0; b < 32; ++b) {
+			jobs->InverseMap[ofs++] = (GUChar8)QuantNearestColor(jobs->Palette, jobs->PaletteCount, red,
+																 (GInt32)((g << 3) + 4), (GInt32)((b << 3) + 4));
+		}
 	}
-	delete (*ppNode);
-	*ppNode = NULL;
 }
 
-static void GetPaletteColors(GColorNode* pTree, GUChar8* pPalEntries, GUInt32* pIndex) {
+static inline GInt32 QuantClamp(const GInt32 Value) {
 
-	GInt32 i;
+	return (Value < 0) ? 0 : ((Value > 255) ? 255 : Value);
+}
 
-	if (pTree->gIsLeaf) {
-		pPalEntries[(*pIndex) * 4] = (GUChar8)((pTree->gBlueSum) / (pTree->gPixelCount));
-		pPalEntries[(*pIndex) * 4 + 1] = (GUChar8)((pTree->gGreenSum) / (pTree->gPixelCount));
-		pPalEntries[(*pIndex) * 4 + 2] = (GUChar8)((pTree->gRedSum) / (pTree->gPixelCount));
-		pPalEntries[(*pIndex) * 4 + 3] = 0;
-		(*pIndex)++;
+// map a band of rows, without dithering or with ordered dithering
+static void QuantMapJob(void *Data, const GUInt32 JobIndex) {
+
+	static const GInt32 bayer[4][4] = {
+		{  0,  8,  2, 10 },
+		{ 12,  4, 14,  6 },
+		{  3, 11,  1,  9 },
+		{ 15,  7, 13,  5 }
+	};
+	GQuantJobsData *jobs = (GQuantJobsData *)Data;
+	GInt32 x, y, y0, y1, w, d;
+	GUInt32 c;
+	GUChar8 *dst;
+	GDynArray<GUInt32> row;
+
+	w = jobs->Image->Width();
+	y0 = (GInt32)JobIndex * G_QUANT_ROWS_PER_JOB;
+	y1 = GMath::Min(y0 + G_QUANT_ROWS_PER_JOB, jobs->Image->Height());
+	row.resize(w);
+
+	for (y = y0; y < y1; ++y) {
+		QuantReadRow(*jobs->Image, jobs->Image->Palette(), y, &row[0]);
+		dst = jobs->NewPixels + y * w;
+		if (jobs->DitherMode == G_ORDERED_DITHER) {
+			for (x = 0; x < w; ++x) {
+				c = row[x];
+				d = ((2 * bayer[y & 3][x & 3] - 15) * jobs->DitherSpread) / 32;
+				dst[x] = jobs->InverseMap[QuantCell(QuantClamp((GInt32)((c >> 16) & 0xFF) + d),
+													QuantClamp((GInt32)((c >> 8) & 0xFF) + d),
+													QuantClamp((GInt32)(c & 0xFF) + d))];
+			}
+		}
+		else {
+			for (x = 0; x < w; ++x) {
+				c = row[x];
+				dst[x] = jobs->InverseMap[QuantCell((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF)];
+			}
+		}
 	}
-	else {
-		for (i = 0; i < 8; i++) {
-			if (pTree->gChildren[i] != NULL)
-				GetPaletteColors(pTree->gChildren[i], pPalEntries, pIndex);
+}
+
+// map all pixels using Floyd-Steinberg error diffusion
+static void QuantMapFloydSteinberg(GQuantJobsData& Jobs) {
+
+	GInt32 x, y, w, h, k, v[3], e[3];
+	GUInt32 c, idx;
+	GUChar8 *dst;
+	GDynArray<GUInt32> row;
+	// errors (in 1/16 units) for current and next row, with a guard element at both ends
+	GDynArray<GInt32> errCur, errNext;
+
+	w = Jobs.Image->Width();
+	h = Jobs.Image->Height();
+	row.resize(w);
+	errCur.resize((w + 2) * 3, 0);
+	errNext.resize((w + 2) * 3, 0);
+
+	for (y = 0; y < h; ++y) {
+		QuantReadRow(*Jobs.Image, Jobs.Image->Palette(), y, &row[0]);
+		dst = Jobs.NewPixels + y * w;
+		std::fill(errNext.begin(), errNext.end(), 0);
+		for (x = 0; x < w; ++x) {
+			c = row[x];
+			v[0] = QuantClamp((GInt32)((c >> 16) & 0xFF) + errCur[(x + 1) * 3] / 16);
+			v[1] = QuantClamp((GInt32)((c >> 8) & 0xFF) + errCur[(x + 1) * 3 + 1] / 16);
+			v[2] = QuantClamp((GInt32)(c & 0xFF) + errCur[(x + 1) * 3 + 2] / 16);
+			idx = Jobs.InverseMap[QuantCell(v[0], v[1], v[2])];
+			dst[x] = (GUChar8)idx;
+			c = Jobs.Palette[idx];
+			e[0] = v[0] - (GInt32)((c >> 16) & 0xFF);
+			e[1] = v[1] - (GInt32)((c >> 8) & 0xFF);
+			e[2] = v[2] - (GInt32)(c & 0xFF);
+			for (k = 0; k < 3; ++k) {
+				errCur[(x + 2) * 3 + k] += e[k] * 7;
+				errNext[x * 3 + k] += e[k] * 3;
+				errNext[(x + 1) * 3 + k] += e[k] * 5;
+				errNext[(x + 2) * 3 + k] += e[k];
+			}
 		}
+		errCur.swap(errNext);
 	}
 }
 
-static void MapColor(GColorNode* pNode, GUChar8 r, GUChar8 g, GUChar8 b, GUInt32 nLevel,
-					 GUChar8 *OutR, GUChar8 *OutG, GUChar8 *OutB) {
-	
-	GInt32 nIndex, shift;
-	static GUChar8 mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
 
-	G_ASSERT(pNode != NULL);
+// quantize an image, writing palette indexes into NewPixels
+static GError QuantizeImage(const GPixelMap& Image, const GUInt32 MaxColors, const GDitherMode DitherMode,
+							const GUInt32 RefineIterations, GThreadPool *Pool, GUInt32 *Palette,
+							GUChar8 *NewPixels) {
 
-	// update color information if it's a leaf node
-	if (pNode->gIsLeaf) {
-		*OutB = (GUChar8)((pNode->gBlueSum) / (pNode->gPixelCount));
-		*OutG = (GUChar8)((pNode->gGreenSum) / (pNode->gPixelCount));
-		*OutR = (GUChar8)((pNode->gRedSum) / (pNode->gPixelCount));
+	GDynArray<GQuantCell> histogram;
+	GDynArray<GUInt32> cells, row;
+	GDynArray<GUChar8> inverseMap;
+	GQuantJobsData jobs;
+	GThreadPool *pool;
+	GUInt32 i, j, c, cell, colorsCount;
+	GInt32 y, w, h;
+	GError err;
+
+	w = Image.Width();
+	h = Image.Height();
+	if (w <= 0 || h <= 0)
+		return G_NO_ERROR;
+	std::memset(Palette, 0, 256 * sizeof(GUInt32));
+
+	// grayscale images fit exactly into a 256 entries palette
+	if (Image.PixelFormat() == G_GRAYSCALE && MaxColors >= 256) {
+		for (i = 0; i < 256; ++i)
+			Palette[i] = (i << 16) | (i << 8) | i;
+		std::memcpy(NewPixels, Image.Pixels(), w * h);
+		return G_NO_ERROR;
+	}
+
+	// build 5 bits per channel histogram
+	histogram.resize(G_QUANT_CELLS);
+	std::memset(&histogram[0], 0, G_QUANT_CELLS * sizeof(GQuantCell));
+	row.resize(w);
+	for (y = 0; y < h; ++y) {
+		QuantReadRow(Image, Image.Palette(), y, &row[0]);
+		for (i = 0; i < (GUInt32)w; ++i) {
+			c = row[i];
+			GQuantCell& qc = histogram[QuantCell((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF)];
+			qc.Count++;
+			qc.Sums[0] += (GDouble)((c >> 16) & 0xFF);
+			qc.Sums[1] += (GDouble)((c >> 8) & 0xFF);
+			qc.Sums[2] += (GDouble)(c & 0xFF);
+		}
+	}
+	for (cell = 0; cell < G_QUANT_CELLS; ++cell) {
+		if (histogram[cell].Count > 0)
+			cells.push_back(cell);
+	}
+
+	// generate palette
+	j = (GUInt32)cells.size();
+	if (j <= MaxColors) {
+		// every used cell gets its own entry, no refinement is needed
+		for (i = 0; i < j; ++i) {
+			const GQuantCell& qc = histogram[cells[i]];
+			Palette[i] = ((GUInt32)(qc.Sums[0] / qc.Count + 0.5) << 16) |
+						 ((GUInt32)(qc.Sums[1] / qc.Count + 0.5) << 8) | (GUInt32)(qc.Sums[2] / qc.Count + 0.5);
+		}
+		colorsCount = j;
 	}
-	// recurse a level deeper if the node is not a leaf
 	else {
-		shift = 7 - nLevel;
-		nIndex = (((r & mask[nLevel]) >> shift) << 2) |	(((g & mask[nLevel]) >> shift) << 1) |
-					((b & mask[nLevel]) >> shift);
-		MapColor(pNode->gChildren[nIndex], r, g, b, nLevel + 1, OutR, OutG, OutB);
-	}
-}
-
-static GError OctreeQuantization(const GPixelMap& Image, const GUInt32 MaxColors, const GUInt32 ColorBits,
-								  GUInt32 *Palette, const GUInt32 PalEntries, GUInt32& CreatedEntries,
-								  GUChar8 *NewPixels) {
-
-	GInt32 i, j, k;
-	GUChar8 *pbBits;
-	GUInt16* pwBits;
-	GUInt32* pdwBits;
-	GUChar8 r, g, b, r2, g2, b2;
-	GUInt16 wColor;
-	GUInt32 dwColor;
-	GColorNode* pTree;
-	GUInt32 nLeafCount, nIndex;
-	GUInt32 maxCols;
-	GColorNode* pReducibleNodes[9];
-
-	// image must not be already paletted
-	G_ASSERT(Image.IsPaletted() == G_FALSE);
-
-	// check given parameters
-	j = Image.PixelsCount();
-	if (!NewPixels || !Palette || ColorBits > 8 || j <= 0)
-		return G_INVALID_PARAMETER;
+		colorsCount = QuantMedianCut(cells, histogram, MaxColors, Palette);
+		QuantRefine(cells, histogram, RefineIterations, Palette, colorsCount);
+	}
 
-	maxCols = GMath::Min(MaxColors, PalEntries);
+	// use the specified pool, or a temporary one
+	if (Pool)
+		pool = Pool;
+	else
+		pool = new(std::nothrow) GThreadPool();
+	if (!pool)
+		return G_MEMORY_ERROR;
 
-	// initialize octree variables
-	pTree = NULL;
-	nLeafCount = 0;
-	for (i = 0; i <= (GInt32)ColorBits; i++)
-		pReducibleNodes[i] = NULL;
+	// build inverse color map, then map pixels
+	inverseMap.resize(G_QUANT_CELLS);
+	jobs.Image = &Image;
+	jobs.NewPixels = NewPixels;
+	jobs.Palette = Palette;
+	jobs.PaletteCount = colorsCount;
+	jobs.InverseMap = &inverseMap[0];
+	jobs.DitherMode = DitherMode;
+	// dithering amplitude is about the distance between two adjacent palette levels
+	jobs.DitherSpread = (GInt32)(256.0 / GMath::Pow((GDouble)colorsCount, (GDouble)1.0 / (GDouble)3.0));
+
+	err = pool->Run(QuantInverseMapJob, (void *)&jobs, 32);
+	if (err == G_NO_ERROR) {
+		if (DitherMode == G_FLOYD_STEINBERG_DITHER)
+			QuantMapFloydSteinberg(jobs);
+		else
+			err = pool->Run(QuantMapJob, (void *)&jobs, (GUInt32)((h + G_QUANT_ROWS_PER_JOB - 1) / G_QUANT_ROWS_PER_JOB));
+	}
+	if (!Pool)
+		delete pool;
+	return err;
+}
 
-	switch (Image.PixelFormat()) {
-		// just to make gcc happy...
-		case G_RGB_PALETTE:
-			return G_NO_ERROR;
-			break;
+#undef G_QUANT_ROWS_PER_JOB
+#undef G_QUANT_CELLS
 
-		// in this case we can simply generate a standard 256 entries palette
-		case G_GRAYSCALE:
-			for (i = 0; i < (GInt32)maxCols; i++) {
-				dwColor = i | (i << 8) | (i << 16);
-				Palette[i] = dwColor;
-			}
-			pbBits = Image.Pixels();
-			for (i = 0; i < j; ++i)
-				NewPixels[i] = pbBits[i];
-			return G_NO_ERROR;
-			break;
 
-		case G_A1R5G5B5:
-			pwBits = (GUInt16 *)Image.Pixels();
-			for (i = 0; i < j; ++i) {
-				wColor = *pwBits++;
-				r = (GUChar8)(((wColor >> 10) & 31) << 3);
-				g = (GUChar8)(((wColor >> 5) & 31) << 3);
-				b = (GUChar8)((wColor & 31) << 3);
-				AddColor(&pTree, r, g, b, ColorBits, 0, &nLeafCount, pReducibleNodes);
-				while (nLeafCount > maxCols)
-					ReduceTree(ColorBits, &nLeafCount, pReducibleNodes);
-			}
-			break;
+// *********************************************************************
+//                        Pixel rows converters
+// *********************************************************************
 
-		case G_R5G6B5:
-			pwBits = (GUInt16 *)Image.Pixels();
-			for (i = 0; i < j; ++i) {
-				wColor = *pwBits++;
-				r = (GUChar8)(((wColor >> 11) & 31) << 3);
-				g = (GUChar8)(((wColor >> 5) & 63) << 2);
-				b = (GUChar8)((wColor & 31) << 3);
-				AddColor(&pTree, r, g, b, ColorBits, 0, &nLeafCount, pReducibleNodes);
-				while (nLeafCount > maxCols)
-					ReduceTree(ColorBits, &nLeafCount, pReducibleNodes);
-			}
-			break;
+// every pixel format is described by a small traits structure, able to decode a pixel into a 32bit ARGB value
+// and to encode a 32bit ARGB value into a pixel; row converters are generated by combining two traits
+struct GPixelTraitsGray {
+	typedef GUChar8 PixelType;
+	static inline GUInt32 Decode(const PixelType Pixel, const GUInt32 *) {
+		return ((GUInt32)Pixel * 0x00010101);
+	}
+	static inline PixelType Encode(const GUInt32 ARGB) {
+		return (PixelType)GPixelMap::RGBToGray(ARGB);
+	}
+};
 
-		// full color pixel format
-		case G_R8G8B8:
-		case G_A8R8G8B8:
-			pdwBits = (GUInt32 *)Image.Pixels();
-			for (i = 0; i < j; ++i) {
-				dwColor = *pdwBits++;
-				b = (GUChar8)((dwColor & 0x000000FF));
-				g = (GUChar8)((dwColor & 0x0000FF00) >> 8);
-				r = (GUChar8)((dwColor & 0x00FF0000) >> 16);
-				AddColor(&pTree, r, g, b, ColorBits, 0, &nLeafCount, pReducibleNodes);
-				while (nLeafCount > maxCols)
-					ReduceTree(ColorBits, &nLeafCount, pReducibleNodes);
-			}
-			break;
+struct GPixelTraitsPalette {
+	typedef GUChar8 PixelType;
+	static inline GUInt32 Decode(const PixelType Pixel, const GUInt32 *Palette) {
+		return Palette[Pixel];
+	}
+};
+
+struct GPixelTraits8888 {
+	typedef GUInt32 PixelType;
+	static inline GUInt32 Decode(const PixelType Pixel, const GUInt32 *) {
+		return Pixel;
 	}
-	// sanity check
-	if (nLeafCount > maxCols) {
-		// free temporary octree
-		DeleteTree(&pTree);
-		return G_UNKNOWN_ERROR;
+	static inline PixelType Encode(const GUInt32 ARGB) {
+		return ARGB;
 	}
-	CreatedEntries = nLeafCount;
-	// fill palette
-	nIndex = 0;
-	GetPaletteColors(pTree, (GUChar8 *)Palette, &nIndex);
+};
 
-	// now map each pixel in the new created palette
-	j = Image.PixelsCount();
-	switch (Image.PixelFormat()) {
-		// just to make gcc happy...
-		case G_RGB_PALETTE:
-		case G_GRAYSCALE:
-			break;
+struct GPixelTraits1555 {
+	typedef GUInt16 PixelType;
+	static inline GUInt32 Decode(const PixelType Pixel, const GUInt32 *) {
+		return (((GUInt32)(Pixel & 0x8000) << 16) | ((GUInt32)(Pixel & 0x7C00) << 9) |
+				((GUInt32)(Pixel & 0x03E0) << 6) | ((GUInt32)(Pixel & 0x001F) << 3));
+	}
+	static inline PixelType Encode(const GUInt32 ARGB) {
+		return (PixelType)(((ARGB >> 16) & 0x8000) | ((ARGB >> 9) & 0x7C00) | ((ARGB >> 6) & 0x03E0) |
+						   ((ARGB >> 3) & 0x001F));
+	}
+};
 
-		case G_A1R5G5B5:
-			pwBits = (GUInt16 *)Image.Pixels();
-			for (i = 0; i < j; ++i) {
-				wColor = *pwBits++;
-				r = (GUChar8)(((wColor >> 10) & 31) << 3);
-				g = (GUChar8)(((wColor >> 5) & 31) << 3);
-				b = (GUChar8)((wColor & 31) << 3);
-				MapColor(pTree, r, g, b, 0, &r2, &g2, &b2);
-				dwColor = (r2 << 16) | (g2 << 8) | b2;
-				for (k = 0; k < (GInt32)maxCols; ++k) {
-					if (Palette[k] == dwColor) {
-						NewPixels[i] = (GUChar8)k;
-						break;
-					}
-				}
-			}
-			break;
+struct GPixelTraits565 {
+	typedef GUInt16 PixelType;
+	static inline GUInt32 Decode(const PixelType Pixel, const GUInt32 *) {
+		return (((GUInt32)(Pixel & 0xF800) << 8) | ((GUInt32)(Pixel & 0x07E0) << 5) |
+				((GUInt32)(Pixel & 0x001F) << 3));
+	}
+	static inline PixelType Encode(const GUInt32 ARGB) {
+		return (PixelType)(((ARGB >> 8) & 0xF800) | ((ARGB >> 5) & 0x07E0) | ((ARGB >> 3) & 0x001F));
+	}
+};
 
-		case G_R5G6B5:
-			pwBits = (GUInt16 *)Image.Pixels();
-			for (i = 0; i < j; ++i) {
-				wColor = *pwBits++;
-				r = (GUChar8)(((wColor >> 11) & 31) << 3);
-				g = (GUChar8)(((wColor >> 5) & 63) << 2);
-				b = (GUChar8)((wColor & 31) << 3);
-				MapColor(pTree, r, g, b, 0, &r2, &g2, &b2);
-				dwColor = (r2 << 16) | (g2 << 8) | b2;
-				for (k = 0; k < (GInt32)maxCols; ++k) {
-					if (Palette[k] == dwColor) {
-						NewPixels[i] = (GUChar8)k;
-						break;
-					}
-				}
-			}
-			break;
+// generic (scalar) converter
+template <typename SRC_TRAITS, typename DST_TRAITS>
+static inline void ConvertRowScalar(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *SrcPalette) {
 
-		// full color pixel format
-		case G_R8G8B8:
-		case G_A8R8G8B8:
-			pdwBits = (GUInt32 *)Image.Pixels();
-			for (i = 0; i < j; ++i) {
-				dwColor = *pdwBits++;
-				b = (GUChar8)((dwColor & 0x000000FF));
-				g = (GUChar8)((dwColor & 0x0000FF00) >> 8);
-				r = (GUChar8)((dwColor & 0x00FF0000) >> 16);
-				MapColor(pTree, r, g, b, 0, &r2, &g2, &b2);
-				dwColor = (r2 << 16) | (g2 << 8) | b2;
-				for (k = 0; k < (GInt32)maxCols; ++k) {
-					if (Palette[k] == dwColor) {
-						NewPixels[i] = (GUChar8)k;
-						break;
-					}
-				}
-			}
-			break;
+	const typename SRC_TRAITS::PixelType *src = (const typename SRC_TRAITS::PixelType *)Src;
+	typename DST_TRAITS::PixelType *dst = (typename DST_TRAITS::PixelType *)Dst;
+
+	for (GUInt32 i = 0; i < Count; ++i)
+		dst[i] = DST_TRAITS::Encode(SRC_TRAITS::Decode(src[i], SrcPalette));
+}
+
+// this template is specialized for those pairs that have a vectorized version
+template <typename SRC_TRAITS, typename DST_TRAITS>
+static void ConvertRow(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *SrcPalette) {
+
+	ConvertRowScalar<SRC_TRAITS, DST_TRAITS>(Src, Dst, Count, SrcPalette);
+}
+
+// plain copy, used for same size formats that share the same layout
+template <GUInt32 PIXEL_SIZE>
+static void CopyRow(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	if (Src != Dst)
+		std::memmove(Dst, Src, Count * PIXEL_SIZE);
+}
+
+// negative and channels reversal kernels, they all work in place too
+static inline GUInt32 ReverseRGB32(const GUInt32 ARGB) {
+	return ((ARGB & 0xFF00FF00) | ((ARGB >> 16) & 0xFF) | ((ARGB & 0xFF) << 16));
+}
+static inline GUInt32 ReverseARGB32(const GUInt32 ARGB) {
+	return ((ARGB << 24) | ((ARGB << 8) & 0x00FF0000) | ((ARGB >> 8) & 0x0000FF00) | (ARGB >> 24));
+}
+static inline GUInt16 ReverseRGB1555(const GUInt16 ARGB) {
+	return (GUInt16)((ARGB & 0x83E0) | ((ARGB & 0x1F) << 10) | ((ARGB >> 10) & 0x1F));
+}
+static inline GUInt16 ReverseARGB1555(const GUInt16 ARGB) {
+	return (GUInt16)(((ARGB & 0x1F) << 11) | ((ARGB & 0x03E0) << 1) | ((ARGB >> 9) & 0x3E) | (ARGB >> 15));
+}
+static inline GUInt16 ReverseRGB565(const GUInt16 RGB) {
+	return (GUInt16)(((RGB & 0x1F) << 11) | (RGB & 0x07E0) | (RGB >> 11));
+}
+
+#if defined(G_PIXELMAP_SSE2)
+
+// pack the low 16 bits of eight 32bit values (two registers) into a single register
+static inline __m128i PackLow16(const __m128i Lo, const __m128i Hi) {
+
+	// sign extension makes signed saturation harmless
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(Lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(Hi, 16), 16));
+}
+
+// 1.15 fixed point luma of four 32bit ARGB pixels; results are in the low byte of each 32bit lane
+static inline __m128i Luma4(const __m128i ARGB) {
+
+	const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+	// 16bit lanes: (blue, red) and (green, alpha)
+	const __m128i wBR = _mm_set1_epi32((9798 << 16) | 3735);
+	const __m128i wG = _mm_set1_epi32(19235);
+	__m128i br = _mm_and_si128(ARGB, mask);
+	__m128i ga = _mm_and_si128(_mm_srli_epi32(ARGB, 8), mask);
+
+	return _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(br, wBR), _mm_madd_epi16(ga, wG)), 15);
+}
+
+template <>
+void ConvertRow<GPixelTraits8888, GPixelTraitsGray>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													  const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	__m128i l0, l1, l2, l3;
+	GUInt32 i, n = Count >> 4;
+
+	for (i = 0; i < n; ++i) {
+		l0 = Luma4(_mm_loadu_si128(src));
+		l1 = Luma4(_mm_loadu_si128(src + 1));
+		l2 = Luma4(_mm_loadu_si128(src + 2));
+		l3 = Luma4(_mm_loadu_si128(src + 3));
+		_mm_storeu_si128(dst, _mm_packus_epi16(_mm_packs_epi32(l0, l1), _mm_packs_epi32(l2, l3)));
+		src += 4;
+		dst++;
 	}
-	// free temporary octree
-	DeleteTree(&pTree);
-	return G_NO_ERROR;
+	n <<= 4;
+	ConvertRowScalar<GPixelTraits8888, GPixelTraitsGray>(Src + n * 4, Dst + n, Count - n, SrcPalette);
+}
+
+template <>
+void ConvertRow<GPixelTraitsGray, GPixelTraits8888>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													  const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+	__m128i g, gg;
+	GUInt32 i, n = Count >> 4;
+
+	for (i = 0; i < n; ++i) {
+		g = _mm_loadu_si128(src);
+		gg = _mm_unpacklo_epi8(g, g);
+		_mm_storeu_si128(dst, _mm_and_si128(_mm_unpacklo_epi16(gg, gg), mask));
+		_mm_storeu_si128(dst + 1, _mm_and_si128(_mm_unpackhi_epi16(gg, gg), mask));
+		gg = _mm_unpackhi_epi8(g, g);
+		_mm_storeu_si128(dst + 2, _mm_and_si128(_mm_unpacklo_epi16(gg, gg), mask));
+		_mm_storeu_si128(dst + 3, _mm_and_si128(_mm_unpackhi_epi16(gg, gg), mask));
+		src++;
+		dst += 4;
+	}
+	n <<= 4;
+	ConvertRowScalar<GPixelTraitsGray, GPixelTraits8888>(Src + n, Dst + n * 4, Count - n, SrcPalette);
+}
+
+static inline __m128i Encode565x4(const __m128i ARGB) {
+
+	return _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(ARGB, 8), _mm_set1_epi32(0xF800)),
+									 _mm_and_si128(_mm_srli_epi32(ARGB, 5), _mm_set1_epi32(0x07E0))),
+						_mm_and_si128(_mm_srli_epi32(ARGB, 3), _mm_set1_epi32(0x001F)));
+}
+
+static inline __m128i Encode1555x4(const __m128i ARGB) {
+
+	return _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(ARGB, 16), _mm_set1_epi32(0x8000)),
+									 _mm_and_si128(_mm_srli_epi32(ARGB, 9), _mm_set1_epi32(0x7C00))),
+						_mm_or_si128(_mm_and_si128(_mm_srli_epi32(ARGB, 6), _mm_set1_epi32(0x03E0)),
+									 _mm_and_si128(_mm_srli_epi32(ARGB, 3), _mm_set1_epi32(0x001F))));
+}
+
+static inline __m128i Decode565x4(const __m128i RGB) {
+
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(RGB, _mm_set1_epi32(0xF800)), 8),
+									 _mm_slli_epi32(_mm_and_si128(RGB, _mm_set1_epi32(0x07E0)), 5)),
+						_mm_slli_epi32(_mm_and_si128(RGB, _mm_set1_epi32(0x001F)), 3));
+}
+
+static inline __m128i Decode1555x4(const __m128i ARGB) {
+
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(ARGB, _mm_set1_epi32(0x8000)), 16),
+									 _mm_slli_epi32(_mm_and_si128(ARGB, _mm_set1_epi32(0x7C00)), 9)),
+						_mm_or_si128(_mm_slli_epi32(_mm_and_si128(ARGB, _mm_set1_epi32(0x03E0)), 6),
+									 _mm_slli_epi32(_mm_and_si128(ARGB, _mm_set1_epi32(0x001F)), 3)));
+}
+
+template <>
+void ConvertRow<GPixelTraits8888, GPixelTraits565>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													 const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	GUInt32 i, n = Count >> 3;
+
+	for (i = 0; i < n; ++i) {
+		_mm_storeu_si128(dst, PackLow16(Encode565x4(_mm_loadu_si128(src)), Encode565x4(_mm_loadu_si128(src + 1))));
+		src += 2;
+		dst++;
+	}
+	n <<= 3;
+	ConvertRowScalar<GPixelTraits8888, GPixelTraits565>(Src + n * 4, Dst + n * 2, Count - n, SrcPalette);
+}
+
+template <>
+void ConvertRow<GPixelTraits8888, GPixelTraits1555>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													  const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	GUInt32 i, n = Count >> 3;
+
+	for (i = 0; i < n; ++i) {
+		_mm_storeu_si128(dst, PackLow16(Encode1555x4(_mm_loadu_si128(src)), Encode1555x4(_mm_loadu_si128(src + 1))));
+		src += 2;
+		dst++;
+	}
+	n <<= 3;
+	ConvertRowScalar<GPixelTraits8888, GPixelTraits1555>(Src + n * 4, Dst + n * 2, Count - n, SrcPalette);
+}
+
+template <>
+void ConvertRow<GPixelTraits565, GPixelTraits8888>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													 const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i p;
+	GUInt32 i, n = Count >> 3;
+
+	for (i = 0; i < n; ++i) {
+		p = _mm_loadu_si128(src);
+		_mm_storeu_si128(dst, Decode565x4(_mm_unpacklo_epi16(p, zero)));
+		_mm_storeu_si128(dst + 1, Decode565x4(_mm_unpackhi_epi16(p, zero)));
+		src++;
+		dst += 2;
+	}
+	n <<= 3;
+	ConvertRowScalar<GPixelTraits565, GPixelTraits8888>(Src + n * 2, Dst + n * 4, Count - n, SrcPalette);
+}
+
+template <>
+void ConvertRow<GPixelTraits1555, GPixelTraits8888>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													  const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i p;
+	GUInt32 i, n = Count >> 3;
+
+	for (i = 0; i < n; ++i) {
+		p = _mm_loadu_si128(src);
+		_mm_storeu_si128(dst, Decode1555x4(_mm_unpacklo_epi16(p, zero)));
+		_mm_storeu_si128(dst + 1, Decode1555x4(_mm_unpackhi_epi16(p, zero)));
+		src++;
+		dst += 2;
+	}
+	n <<= 3;
+	ConvertRowScalar<GPixelTraits1555, GPixelTraits8888>(Src + n * 2, Dst + n * 4, Count - n, SrcPalette);
+}
+
+template <>
+void ConvertRow<GPixelTraits565, GPixelTraits1555>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													 const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	const __m128i rgMask = _mm_set1_epi16(0x7FE0);
+	const __m128i bMask = _mm_set1_epi16(0x001F);
+	__m128i p;
+	GUInt32 i, n = Count >> 3;
+
+	for (i = 0; i < n; ++i) {
+		p = _mm_loadu_si128(src);
+		_mm_storeu_si128(dst, _mm_or_si128(_mm_and_si128(_mm_srli_epi16(p, 1), rgMask), _mm_and_si128(p, bMask)));
+		src++;
+		dst++;
+	}
+	n <<= 3;
+	ConvertRowScalar<GPixelTraits565, GPixelTraits1555>(Src + n * 2, Dst + n * 2, Count - n, SrcPalette);
+}
+
+template <>
+void ConvertRow<GPixelTraits1555, GPixelTraits565>(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count,
+													 const GUInt32 *SrcPalette) {
+
+	const __m128i *src = (const __m128i *)Src;
+	__m128i *dst = (__m128i *)Dst;
+	const __m128i rgMask = _mm_set1_epi16((GInt16)0xFFC0);
+	const __m128i bMask = _mm_set1_epi16(0x001F);
+	__m128i p;
+	GUInt32 i, n = Count >> 3;
+
+	for (i = 0; i < n; ++i) {
+		p = _mm_loadu_si128(src);
+		_mm_storeu_si128(dst, _mm_or_si128(_mm_and_si128(_mm_slli_epi16(p, 1), rgMask), _mm_and_si128(p, bMask)));
+		src++;
+		dst++;
+	}
+	n <<= 3;
+	ConvertRowScalar<GPixelTraits1555, GPixelTraits565>(Src + n * 2, Dst + n * 2, Count - n, SrcPalette);
+}
+
+#endif
+
+// xor every pixel with a constant mask
+template <typename PIXEL_TYPE, GUInt32 MASK>
+static void XorRow(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	const PIXEL_TYPE *src = (const PIXEL_TYPE *)Src;
+	PIXEL_TYPE *dst = (PIXEL_TYPE *)Dst;
+	GUInt32 i = 0;
+
+#if defined(G_PIXELMAP_SSE2)
+	const __m128i mask = (sizeof(PIXEL_TYPE) == 1) ? _mm_set1_epi8((GChar8)MASK) :
+						 ((sizeof(PIXEL_TYPE) == 2) ? _mm_set1_epi16((GInt16)MASK) : _mm_set1_epi32((GInt32)MASK));
+	const GUInt32 step = 16 / sizeof(PIXEL_TYPE);
+
+	for (; i + step <= Count; i += step)
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), mask));
+#endif
+	for (; i < Count; ++i)
+		dst[i] = (PIXEL_TYPE)(src[i] ^ MASK);
+}
+
+static void ReverseRowRGB32(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	const GUInt32 *src = (const GUInt32 *)Src;
+	GUInt32 *dst = (GUInt32 *)Dst;
+	GUInt32 i = 0;
+
+#if defined(G_PIXELMAP_SSE2)
+	const __m128i agMask = _mm_set1_epi32((GInt32)0xFF00FF00);
+	const __m128i bMask = _mm_set1_epi32(0xFF);
+	__m128i p;
+
+	for (; i + 4 <= Count; i += 4) {
+		p = _mm_loadu_si128((const __m128i *)(src + i));
+		p = _mm_or_si128(_mm_or_si128(_mm_and_si128(p, agMask), _mm_srli_epi32(_mm_slli_epi32(p, 8), 24)),
+						 _mm_slli_epi32(_mm_and_si128(p, bMask), 16));
+		_mm_storeu_si128((__m128i *)(dst + i), p);
+	}
+#endif
+	for (; i < Count; ++i)
+		dst[i] = ReverseRGB32(src[i]);
+}
+
+static void ReverseRowARGB32(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	const GUInt32 *src = (const GUInt32 *)Src;
+	GUInt32 *dst = (GUInt32 *)Dst;
+	GUInt32 i = 0;
+
+#if defined(G_PIXELMAP_SSE2)
+	const __m128i rMask = _mm_set1_epi32(0x00FF0000);
+	const __m128i gMask = _mm_set1_epi32(0x0000FF00);
+	__m128i p;
+
+	for (; i + 4 <= Count; i += 4) {
+		p = _mm_loadu_si128((const __m128i *)(src + i));
+		p = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(p, 24), _mm_and_si128(_mm_slli_epi32(p, 8), rMask)),
+						 _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 8), gMask), _mm_srli_epi32(p, 24)));
+		_mm_storeu_si128((__m128i *)(dst + i), p);
+	}
+#endif
+	for (; i < Count; ++i)
+		dst[i] = ReverseARGB32(src[i]);
+}
+
+static void ReverseRowRGB1555(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	const GUInt16 *src = (const GUInt16 *)Src;
+	GUInt16 *dst = (GUInt16 *)Dst;
+
+	for (GUInt32 i = 0; i < Count; ++i)
+		dst[i] = ReverseRGB1555(src[i]);
+}
+
+static void ReverseRowARGB1555(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	const GUInt16 *src = (const GUInt16 *)Src;
+	GUInt16 *dst = (GUInt16 *)Dst;
+
+	for (GUInt32 i = 0; i < Count; ++i)
+		dst[i] = ReverseARGB1555(src[i]);
+}
+
+static void ReverseRowRGB565(const GUChar8 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 *) {
+
+	const GUInt16 *src = (const GUInt16 *)Src;
+	GUInt16 *dst = (GUInt16 *)Dst;
+	GUInt32 i = 0;
+
+#if defined(G_PIXELMAP_SSE2)
+	const __m128i gMask = _mm_set1_epi16(0x07E0);
+	__m128i p;
+
+	for (; i + 8 <= Count; i += 8) {
+		p = _mm_loadu_si128((const __m128i *)(src + i));
+		p = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(p, 11), _mm_and_si128(p, gMask)), _mm_srli_epi16(p, 11));
+		_mm_storeu_si128((__m128i *)(dst + i), p);
+	}
+#endif
+	for (; i < Count; ++i)
+		dst[i] = ReverseRGB565(src[i]);
 }
 
+// row converters table, indexed by [source format][destination format]
+static const GPixelRowConverter gRowConverters[6][6] = {
+	// G_GRAYSCALE
+	{ CopyRow<1>, NULL,
+	  ConvertRow<GPixelTraitsGray, GPixelTraits8888>, ConvertRow<GPixelTraitsGray, GPixelTraits8888>,
+	  ConvertRow<GPixelTraitsGray, GPixelTraits1555>, ConvertRow<GPixelTraitsGray, GPixelTraits565> },
+	// G_RGB_PALETTE
+	{ ConvertRow<GPixelTraitsPalette, GPixelTraitsGray>, CopyRow<1>,
+	  ConvertRow<GPixelTraitsPalette, GPixelTraits8888>, ConvertRow<GPixelTraitsPalette, GPixelTraits8888>,
+	  ConvertRow<GPixelTraitsPalette, GPixelTraits1555>, ConvertRow<GPixelTraitsPalette, GPixelTraits565> },
+	// G_R8G8B8
+	{ ConvertRow<GPixelTraits8888, GPixelTraitsGray>, NULL, CopyRow<4>, CopyRow<4>,
+	  ConvertRow<GPixelTraits8888, GPixelTraits1555>, ConvertRow<GPixelTraits8888, GPixelTraits565> },
+	// G_A8R8G8B8
+	{ ConvertRow<GPixelTraits8888, GPixelTraitsGray>, NULL, CopyRow<4>, CopyRow<4>,
+	  ConvertRow<GPixelTraits8888, GPixelTraits1555>, ConvertRow<GPixelTraits8888, GPixelTraits565> },
+	// G_A1R5G5B5
+	{ ConvertRow<GPixelTraits1555, GPixelTraitsGray>, NULL,
+	  ConvertRow<GPixelTraits1555, GPixelTraits8888>, ConvertRow<GPixelTraits1555, GPixelTraits8888>,
+	  CopyRow<2>, ConvertRow<GPixelTraits1555, GPixelTraits565> },
+	// G_R5G6B5
+	{ ConvertRow<GPixelTraits565, GPixelTraitsGray>, NULL,
+	  ConvertRow<GPixelTraits565, GPixelTraits8888>, ConvertRow<GPixelTraits565, GPixelTraits8888>,
+	  ConvertRow<GPixelTraits565, GPixelTraits1555>, CopyRow<2> }
+};
+
+// extract a single 8bit channel from 32bit pixels
+static void ExtractChannel32(const GUInt32 *Src, GUChar8 *Dst, const GUInt32 Count, const GUInt32 Shift) {
+
+	GUInt32 i = 0;
+
+#if defined(G_PIXELMAP_SSE2)
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i shift = _mm_cvtsi32_si128((GInt32)Shift);
+	__m128i c0, c1, c2, c3;
+	const __m128i *src;
+
+	for (; i + 16 <= Count; i += 16) {
+		src = (const __m128i *)(Src + i);
+		c0 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(src), shift), mask);
+		c1 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(src + 1), shift), mask);
+		c2 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(src + 2), shift), mask);
+		c3 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(src + 3), shift), mask);
+		_mm_storeu_si128((__m128i *)(Dst + i), _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3)));
+	}
+#endif
+	for (; i < Count; ++i)
+		Dst[i] = (GUChar8)((Src[i] >> Shift) & 0xFF);
+}
 
+// merge 8bit channels into 32bit pixels; alpha channel can be NULL (a 0 alpha is used in this case)
+static void MergeChannels32(const GUChar8 *Alpha, const GUChar8 *Red, const GUChar8 *Green, const GUChar8 *Blue,
+							GUInt32 *Dst, const GUInt32 Count) {
+
+	GUInt32 i = 0, a;
+
+#if defined(G_PIXELMAP_SSE2)
+	__m128i r, g, b, al, bg, ra;
+	__m128i *dst;
+
+	for (; i + 16 <= Count; i += 16) {
+		r = _mm_loadu_si128((const __m128i *)(Red + i));
+		g = _mm_loadu_si128((const __m128i *)(Green + i));
+		b = _mm_loadu_si128((const __m128i *)(Blue + i));
+		al = (Alpha) ? _mm_loadu_si128((const __m128i *)(Alpha + i)) : _mm_setzero_si128();
+		dst = (__m128i *)(Dst + i);
+		bg = _mm_unpacklo_epi8(b, g);
+		ra = _mm_unpacklo_epi8(r, al);
+		_mm_storeu_si128(dst, _mm_unpacklo_epi16(bg, ra));
+		_mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(bg, ra));
+		bg = _mm_unpackhi_epi8(b, g);
+		ra = _mm_unpackhi_epi8(r, al);
+		_mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(bg, ra));
+		_mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(bg, ra));
+	}
+#endif
+	for (; i < Count; ++i) {
+		a = (Alpha) ? (GUInt32)Alpha[i] : 0;
+		Dst[i] = (a << 24) | ((GUInt32)Red[i] << 16) | ((GUInt32)Green[i] << 8) | (GUInt32)Blue[i];
+	}
+}
 
 // *********************************************************************
 //                            GPixelMap
@@ -666,10 +1309,7 @@ GError GPixelMap::Negative() {
 	if (IsPaletted())
 		return G_INVALID_OPERATION;
 
-	GInt32 i, j = PixelsCount();
-	GUChar8 *pixels8;
-	GUInt32 *pixels32;
-	GUInt16 *pixels16;
+	GInt32 j = PixelsCount();
 
 	if (j <= 0)
 		return G_NO_ERROR;
@@ -679,25 +1319,17 @@ GError GPixelMap::Negative() {
 			// just to make gcc happy with warnings..
 			break;
 		case G_GRAYSCALE:
-			pixels8 = gPixels;
-			for (i = 0; i < j; i++)
-				*pixels8++ ^= 0xFF;
+			XorRow<GUChar8, 0xFF>(gPixels, gPixels, j, NULL);
 			break;
 		case G_R8G8B8:
 		case G_A8R8G8B8:
-			pixels32 = (GUInt32 *)gPixels;
-			for (i = 0; i < j; i++)
-				*pixels32++ ^= 0x00FFFFFF;
+			XorRow<GUInt32, 0x00FFFFFF>(gPixels, gPixels, j, NULL);
 			break;
 		case G_A1R5G5B5:
-			pixels16 = (GUInt16 *)gPixels;
-			for (i = 0; i < j; i++)
-				*pixels16++ ^= 0x7FFF;
+			XorRow<GUInt16, 0x7FFF>(gPixels, gPixels, j, NULL);
 			break;
 		case G_R5G6B5:
-			pixels16 = (GUInt16 *)gPixels;
-			for (i = 0; i < j; i++)
-				*pixels16++ ^= 0xFFFF;
+			XorRow<GUInt16, 0xFFFF>(gPixels, gPixels, j, NULL);
 			break;
 	}
 	return G_NO_ERROR;
@@ -709,15 +1341,16 @@ GError GPixelMap::Negative(GPixelMap& NegativePixelMap) const {
 	if (IsPaletted())
 		return G_INVALID_OPERATION;
 
-	GInt32 i, j = PixelsCount();
-	GUChar8 *pixels8, *pixels8Dst;
-	GUInt32 *pixels32, *pixels32Dst;
-	GUInt16 *pixels16, *pixels16Dst;
+	GInt32 j = PixelsCount();
 	GError err;
 
 	if (j <= 0)
 		return G_NO_ERROR;
 
+	// if destination is this image, negative is done in place
+	if (&NegativePixelMap == this)
+		return NegativePixelMap.Negative();
+
 	// resize destination image
 	err = NegativePixelMap.Reset(gWidth, gHeight, gPixelFormat);
 	if (err != G_NO_ERROR)
@@ -728,29 +1361,17 @@ GError GPixelMap::Negative(GPixelMap& NegativePixelMap) const {
 			// just to make gcc happy with warnings..
 			break;
 		case G_GRAYSCALE:
-			pixels8 = gPixels;
-			pixels8Dst = NegativePixelMap.gPixels;
-			for (i = 0; i < j; i++)
-				*pixels8++ ^= 0xFF;
+			XorRow<GUChar8, 0xFF>(gPixels, NegativePixelMap.gPixels, j, NULL);
 			break;
 		case G_R8G8B8:
 		case G_A8R8G8B8:
-			pixels32 = (GUInt32 *)gPixels;
-			pixels32Dst = (GUInt32 *)NegativePixelMap.gPixels;
-			for (i = 0; i < j; i++)
-				*pixels32++ ^= 0x00FFFFFF;
+			XorRow<GUInt32, 0x00FFFFFF>(gPixels, NegativePixelMap.gPixels, j, NULL);
 			break;
 		case G_A1R5G5B5:
-			pixels16 = (GUInt16 *)gPixels;
-			pixels16Dst = (GUInt16 *)NegativePixelMap.gPixels;
-			for (i = 0; i < j; i++)
-				*pixels16++ ^= 0x7FFF;
+			XorRow<GUInt16, 0x7FFF>(gPixels, NegativePixelMap.gPixels, j, NULL);
 			break;
 		case G_R5G6B5:
-			pixels16 = (GUInt16 *)gPixels;
-			pixels16Dst = (GUInt16 *)NegativePixelMap.gPixels;
-			for (i = 0; i < j; i++)
-				*pixels16++ ^= 0xFFFF;
+			XorRow<GUInt16, 0xFFFF>(gPixels, NegativePixelMap.gPixels, j, NULL);
 			break;
 	}
 	return G_NO_ERROR;
@@ -762,9 +1383,7 @@ GError GPixelMap::ReverseChannels(const GBool ReverseAlphaToo) {
 	if (IsGrayScale() || IsPaletted())
 		return G_INVALID_OPERATION;
 
-	GInt32 i, j = PixelsCount();
-	GUInt32 *pixels32, argb32, a32, r32, g32, b32;
-	GUInt16 *pixels16, argb16, a16, r16, g16, b16;
+	GInt32 j = PixelsCount();
 
 	if (j <= 0)
 		return G_NO_ERROR;
@@ -776,66 +1395,19 @@ GError GPixelMap::ReverseChannels(const GBool ReverseAlphaToo) {
 			break;
 		case G_A8R8G8B8:
 		case G_R8G8B8:
-			pixels32 = (GUInt32 *)gPixels;
-			if (ReverseAlphaToo) {
-				for (i = 0; i < j; i++) {
-					argb32 = *pixels32;
-					a32 = (argb32 >> 24) & 0xFF;
-					r32 = (argb32 >> 16) & 0xFF;
-					g32 = (argb32 >> 8) & 0xFF;
-					b32 = argb32 & 0xFF;
-					argb32 = (b32 << 24) | (g32 << 16) | (r32 << 8) | a32;
-					*pixels32++ = argb32;
-				}
-			}
-			else {
-				for (i = 0; i < j; i++) {
-					argb32 = *pixels32;
-					a32 = (argb32 >> 24) & 0xFF;
-					r32 = (argb32 >> 16) & 0xFF;
-					g32 = (argb32 >> 8) & 0xFF;
-					b32 = argb32 & 0xFF;
-					argb32 = (a32 << 24) | (b32 << 16) | (g32 << 8) | r32;
-					*pixels32++ = argb32;
-				}
-			}
+			if (ReverseAlphaToo)
+				ReverseRowARGB32(gPixels, gPixels, j, NULL);
+			else
+				ReverseRowRGB32(gPixels, gPixels, j, NULL);
 			break;
 		case G_A1R5G5B5:
-			pixels16 = (GUInt16 *)gPixels;
-			if (ReverseAlphaToo) {
-				for (i = 0; i < j; i++) {
-					argb16 = *pixels16;
-					a16 = (argb16 >> 15) & 1;
-					r16 = (argb16 >> 10) & 31;
-					g16 = (argb16 >> 5) & 31;
-					b16 = argb16 & 31;
-					argb16 = (b16 << 11) | (g16 << 6) | (r16 << 1) | a16;
-					*pixels16++ = argb16;
-				}
-			}
-			else {
-				for (i = 0; i < j; i++) {
-					argb16 = *pixels16;
-					a16 = (argb16 >> 15) & 1;
-					r16 = (argb16 >> 10) & 31;
-					g16 = (argb16 >> 5) & 31;
-					b16 = argb16 & 31;
-					argb16 = (a16 << 15) | (b16 << 10) | (g16 << 5) | r16;
-					*pixels16++ = argb16;
-				}
-			}
+			if (ReverseAlphaToo)
+				ReverseRowARGB1555(gPixels, gPixels, j, NULL);
+			else
+				ReverseRowRGB1555(gPixels, gPixels, j, NULL);
 			break;
-
 		case G_R5G6B5:
-			pixels16 = (GUInt16 *)gPixels;
-			for (i = 0; i < j; i++) {
-				argb16 = *pixels16;
-				r16 = (argb16 >> 11) & 31;
-				g16 = (argb16 >> 5) & 63;
-				b16 = argb16 & 31;
-				argb16 = (b16 << 11) | (g16 << 5) | r16;
-				*pixels16++ = argb16;
-			}
+			ReverseRowRGB565(gPixels, gPixels, j, NULL);
 			break;
 	}
 	return G_NO_ERROR;
@@ -847,13 +1419,12 @@ GError GPixelMap::ReverseChannels(GPixelMap& ReversedImage, const GBool ReverseA
 	if (IsGrayScale() || IsPaletted())
 		return G_INVALID_OPERATION;
 
-	GInt32 i, j = PixelsCount();
-	GUInt32 *pixels32, argb32, a32, r32, g32, b32, *pixels32Dst;
-	GUInt16 *pixels16, argb16, a16, r16, g16, b16, *pixels16Dst;
+	GInt32 j = PixelsCount();
 
 	if (j <= 0)
 		return G_NO_ERROR;
 
+	// kernels work in place too, so destination can be this image
 	GError err = ReversedImage.Reset(gWidth, gHeight, gPixelFormat);
 	if (err != G_NO_ERROR)
 		return err;
@@ -863,72 +1434,21 @@ GError GPixelMap::ReverseChannels(GPixelMap& ReversedImage, const GBool ReverseA
 		case G_GRAYSCALE:
 			// just to make gcc happy with warnings..
 			break;
-
 		case G_A8R8G8B8:
 		case G_R8G8B8:
-			pixels32 = (GUInt32 *)gPixels;
-			pixels32Dst = (GUInt32 *)ReversedImage.gPixels;
-			if (ReverseAlphaToo) {
-				for (i = 0; i < j; i++) {
-					argb32 = *pixels32++;
-					a32 = (argb32 >> 24) & 0xFF;
-					r32 = (argb32 >> 16) & 0xFF;
-					g32 = (argb32 >> 8) & 0xFF;
-					b32 = argb32 & 0xFF;
-					argb32 = (b32 << 24) | (g32 << 16) | (r32 << 8) | a32;
-					*pixels32Dst++ = argb32;
-				}
-			}
-			else {
-				for (i = 0; i < j; i++) {
-					argb32 = *pixels32++;
-					a32 = (argb32 >> 24) & 0xFF;
-					r32 = (argb32 >> 16) & 0xFF;
-					g32 = (argb32 >> 8) & 0xFF;
-					b32 = argb32 & 0xFF;
-					argb32 = (a32 << 24) | (b32 << 16) | (g32 << 8) | r32;
-					*pixels32Dst++ = argb32;
-				}
-			}
+			if (ReverseAlphaToo)
+				ReverseRowARGB32(gPixels, ReversedImage.gPixels, j, NULL);
+			else
+				ReverseRowRGB32(gPixels, ReversedImage.gPixels, j, NULL);
 			break;
-
 		case G_A1R5G5B5:
-			pixels16 = (GUInt16 *)gPixels;
-			pixels16Dst = (GUInt16 *)ReversedImage.gPixels;
-			if (ReverseAlphaToo) {
-				for (i = 0; i < j; i++) {
-					argb16 = *pixels16++;
-					a16 = (argb16 >> 15) & 1;
-					r16 = (argb16 >> 10) & 31;
-					g16 = (argb16 >> 5) & 31;
-					b16 = argb16 & 31;
-					argb16 = (b16 << 11) | (g16 << 6) | (r16 << 1) | a16;
-					*pixels16Dst++ = argb16;
-				}
-			}
-			else {
-				for (i = 0; i < j; i++) {
-					argb16 = *pixels16++;
-					a16 = (argb16 >> 15) & 1;
-					r16 = (argb16 >> 10) & 31;
-					g16 = (argb16 >> 5) & 31;
-					b16 = argb16 & 31;
-					argb16 = (a16 << 15) | (b16 << 10) | (g16 << 5) | r16;
-					*pixels16Dst++ = argb16;
-				}
-			}
+			if (ReverseAlphaToo)
+				ReverseRowARGB1555(gPixels, ReversedImage.gPixels, j, NULL);
+			else
+				ReverseRowRGB1555(gPixels, ReversedImage.gPixels, j, NULL);
 			break;
 		case G_R5G6B5:
-			pixels16 = (GUInt16 *)gPixels;
-			pixels16Dst = (GUInt16 *)ReversedImage.gPixels;
-			for (i = 0; i < j; i++) {
-				argb16 = *pixels16++;
-				r16 = (argb16 >> 11) & 31;
-				g16 = (argb16 >> 5) & 63;
-				b16 = argb16 & 31;
-				argb16 = (b16 << 11) | (g16 << 5) | r16;
-				*pixels16Dst++ = argb16;
-			}
+			ReverseRowRGB565(gPixels, ReversedImage.gPixels, j, NULL);
 			break;
 	}
 	return G_NO_ERROR;
@@ -1933,9 +2453,6 @@ GError GPixelMap::SetPixelFormat(const GPixelFormat NewPixelFormat) {
 GError GPixelMap::SetPixelFormat(const GPixelFormat NewPixelFormat, GPixelMap& ConvertedImage) const {
 
 	GError err;
-	GUInt32 i, j, gray32, *pixels32, red32, green32, blue32, alpha32, rgb32;
-	GUChar8 *pixels8, *pix8;
-	GUInt16 *pixels16, rgb16, gray16, red16, green16, blue16, alpha16, *pixels16dst;
 
 	if ((NewPixelFormat == gPixelFormat) || (gPixelFormat == G_R8G8B8 && NewPixelFormat == G_A8R8G8B8) ||
 		(gPixelFormat == G_A8R8G8B8 && NewPixelFormat == G_R8G8B8)) {
@@ -1947,237 +2464,41 @@ GError GPixelMap::SetPixelFormat(const GPixelFormat NewPixelFormat, GPixelMap& C
 	if (err != G_NO_ERROR)
 		return err;
 
-	j = PixelsCount();
-	switch (NewPixelFormat) {
-		case G_RGB_PALETTE:
-			// octree color quantization
-			err = OctreeQuantization(*this, 256, 8, ConvertedImage.gPalette, 256, j, ConvertedImage.gPixels);
-			break;
-		case G_R8G8B8:
-		case G_A8R8G8B8:
-			// palette to full 24/32 bit color conversion
-			if (gPixelFormat == G_RGB_PALETTE) {
-				pixels8 = gPixels;
-				pixels32 = (GUInt32 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb32 = gPalette[*pixels8++];
-					*pixels32++ = rgb32;
-				}
-			}
-			else
-			// grayscale to full 24bit color conversion
-			if (gPixelFormat == G_GRAYSCALE) {
-				pixels8 = (GUChar8 *)gPixels;
-				pixels32 = (GUInt32 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					gray32 = (GUInt32)(*pixels8);
-					*pixels32 = gray32 | (gray32 << 8) | (gray32 << 16);
-					pixels32++;
-					pixels8++;
-				}
-			}
-			else
-			// A1R5G5B5 to full 24bit color conversion
-			if (gPixelFormat == G_A1R5G5B5) {
-				pixels16 = (GUInt16 *)gPixels;
-				pixels32 = (GUInt32 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb16 = *pixels16;
-					blue32 = rgb16 & 31;
-					green32 = (rgb16 >> 5) & 31;
-					red32 = (rgb16 >> 10) & 31;
-					alpha32 = (rgb16 >> 15) & 1;
-					*pixels32 = (alpha32 << 31) | (red32 << 19) | (green32 << 11) | (blue32 << 3);
-					pixels32++;
-					pixels16++;
-				}
-			}
-			else
-			// R5G6B5 to full 24bit color conversion
-			if (gPixelFormat == G_R5G6B5) {
-				pixels16 = (GUInt16 *)gPixels;
-				pixels32 = (GUInt32 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb16 = *pixels16;
-					blue32 = rgb16 & 31;
-					green32 = (rgb16 >> 5) & 63;
-					red32 = (rgb16 >> 11) & 31;
-					*pixels32 = (red32 << 19) | (green32 << 10) | (blue32 << 3);
-					pixels32++;
-					pixels16++;
-				}
-			}
-			break;
+	if (NewPixelFormat == G_RGB_PALETTE)
+		// median cut color quantization
+		err = QuantizeImage(*this, 256, G_NO_DITHER, 2, NULL, ConvertedImage.gPalette, ConvertedImage.gPixels);
+	else
+	if (PixelsCount() > 0)
+		// pixels are contiguous, so the whole image can be converted as a single row
+		gRowConverters[gPixelFormat][NewPixelFormat](gPixels, ConvertedImage.gPixels, PixelsCount(), gPalette);
+	return err;
+}
 
-		case G_A1R5G5B5:
-			// palette to 15 bit high color conversion
-			if (gPixelFormat == G_RGB_PALETTE) {
-				pixels8 = gPixels;
-				pixels16 = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb32 = gPalette[*pixels8++];
-					red16 = (GUInt16)((rgb32 >> 19) & 31);
-					green16 = (GUInt16)((rgb32 >> 11) & 31);
-					blue16 = (GUInt16)((rgb32 >> 3)& 31);
-					*pixels16++ = (red16 << 10) | (green16 << 5) | blue16;
-				}
-			}
-			else
-			// grayscale to 16bit color conversion
-			if (gPixelFormat == G_GRAYSCALE) {
-				pixels8 = (GUChar8 *)gPixels;
-				pixels16 = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					gray16 = (GUInt16)(*pixels8);
-					gray16 = (gray16 >> 2) & 63;
-					*pixels16 = (((gray16 >> 1) & 31) << 11) | (gray16 << 5) | ((gray16 >> 1) & 31);
-					pixels16++;
-					pixels8++;
-				}
-			}
-			else
-			// full 24bit to 16bit color conversion
-			if (gPixelFormat == G_R8G8B8 || gPixelFormat ==  G_A8R8G8B8) {
-				pixels32 = (GUInt32 *)gPixels;
-				pixels16 = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb32 = *pixels32;
-					alpha16 = (rgb32 >> 31) & 1;
-					red16 = (rgb32 >> 19) & 31;
-					green16 = (rgb32 >> 11) & 31;
-					blue16 = (rgb32 >> 3) & 31;
-					*pixels16 = (alpha16 << 15) | (red16 << 10) | (green16 << 5) | blue16;
-					pixels16++;
-					pixels32++;
-				}
-			}
-			else
-			if (gPixelFormat == G_R5G6B5) {
-				pixels16 = (GUInt16 *)gPixels;
-				pixels16dst = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					rgb16 = *pixels16;
-					red16 = (rgb16 >> 11) & 31;
-					green16 = (rgb16 >> 6) & 31;
-					blue16 = rgb16 & 31;
-					*pixels16dst = (red16 << 10) | (green16 << 5) | blue16;
-					pixels16++;
-					pixels16dst++;
-				}
-			}
-			break;
+GPixelRowConverter GPixelMap::RowConverter(const GPixelFormat SrcFormat, const GPixelFormat DstFormat) {
 
-		case G_R5G6B5:
-			// palette to 15 bit high color conversion
-			if (gPixelFormat == G_RGB_PALETTE) {
-				pixels8 = gPixels;
-				pixels16 = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb32 = gPalette[*pixels8++];
-					red16 = (GUInt16)((rgb32 >> 19) & 31);
-					green16 = (GUInt16)((rgb32 >> 10) & 63);
-					blue16 = (GUInt16)((rgb32 >> 3)& 31);
-					*pixels16++ = (red16 << 11) | (green16 << 5) | blue16;
-				}
-			}
-			else
-			// grayscale to 16bit color conversion
-			if (gPixelFormat == G_GRAYSCALE) {
-				pixels8 = (GUChar8 *)gPixels;
-				pixels16 = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					gray16 = (GUInt16)(*pixels8);
-					gray16 = (gray16 >> 2) & 63;
-					*pixels16 = (((gray16 >> 1) & 31) << 11) | (gray16 << 5) | ((gray16 >> 1) & 31);
-					pixels16++;
-					pixels8++;
-				}
-			}
-			else
-			// full 24bit to 16bit color conversion
-			if (gPixelFormat == G_R8G8B8 || gPixelFormat ==  G_A8R8G8B8) {
-				pixels32 = (GUInt32 *)gPixels;
-				pixels16 = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					rgb32 = *pixels32;
-					red16 = (rgb32 >> 19) & 31;
-					green16 = (rgb32 >> 10) & 63;
-					blue16 = (rgb32 >> 3) & 31;
-					*pixels16 = (red16 << 11) | (green16 << 5) | blue16;
-					pixels16++;
-					pixels32++;
-				}
-			}
-			else
-			if (gPixelFormat == G_A1R5G5B5) {
-				pixels16 = (GUInt16 *)gPixels;
-				pixels16dst = (GUInt16 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					rgb16 = *pixels16;
-					red16 = (rgb16 >> 10) & 31;
-					green16 = (rgb16 >> 5) & 31;
-					blue16 = rgb16 & 31;
-					*pixels16dst = (red16 << 11) | (green16 << 6) | blue16;
-					pixels16++;
-					pixels16dst++;
-				}
-			}
-			break;
+	if ((GUInt32)SrcFormat > (GUInt32)G_R5G6B5 || (GUInt32)DstFormat > (GUInt32)G_R5G6B5)
+		return NULL;
+	return gRowConverters[SrcFormat][DstFormat];
+}
 
-		case G_GRAYSCALE:
-			// palette to grayscale conversion
-			if (gPixelFormat == G_RGB_PALETTE) {
-				pixels8 = gPixels;
-				pix8 = ConvertedImage.Pixels();
-				for (i = 0; i < j; ++i) {
-					rgb32 = gPalette[*pixels8++];
-					*pix8++ = RGBToGray(rgb32);
-				}
-			}
-			else
-			// full 24bit color to grayscale conversion
-			if ((gPixelFormat == G_R8G8B8) || (gPixelFormat == G_A8R8G8B8)) {
-				pixels32 = (GUInt32 *)gPixels;
-				pixels8 = (GUChar8 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					gray32 = RGBToGray(*pixels32);
-					*pixels8 = (GUChar8)gray32;
-					pixels32++;
-					pixels8++;
-				}
-			}
-			else
-			// 16bit color to grayscale conversion
-			if (gPixelFormat == G_A1R5G5B5) {
-				pixels16 = (GUInt16 *)gPixels;
-				pixels8 = (GUChar8 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					rgb16 = *pixels16;
-					red32 = ((rgb16 >> 10) & 31) << 3;
-					green32 = ((rgb16 >> 5) & 31) << 3;
-					blue32 = (rgb16 & 31) << 3;
-					gray32 = RGBToGray(red32, green32, blue32);
-					*pixels8 = (GUChar8)gray32;
-					pixels16++;
-					pixels8++;
-				}
-			}
-			else
-			if (gPixelFormat == G_R5G6B5) {
-				pixels16 = (GUInt16 *)gPixels;
-				pixels8 = (GUChar8 *)ConvertedImage.Pixels();
-				for (i = 0; i < j; i++) {
-					rgb16 = *pixels16;
-					red32 = ((rgb16 >> 11) & 31) << 3;
-					green32 = ((rgb16 >> 5) & 63) << 2;
-					blue32 = (rgb16 & 31) << 3;
-					gray32 = RGBToGray(red32, green32, blue32);
-					*pixels8 = (GUChar8)gray32;
-					pixels16++;
-					pixels8++;
-				}
-			}
-			break;
+GError GPixelMap::Quantize(GPixelMap& PalettedImage, const GUInt32 MaxColors, const GDitherMode DitherMode,
+						   const GUInt32 RefineIterations, GThreadPool *Pool) const {
+
+	GError err;
+
+	if (MaxColors == 0 || MaxColors > 256)
+		return G_INVALID_PARAMETER;
+
+	// source and destination images could be the same
+	GPixelMap tmpImage;
+
+	err = tmpImage.Reset(gWidth, gHeight, G_RGB_PALETTE);
+	if (err != G_NO_ERROR)
+		return err;
+	err = QuantizeImage(*this, MaxColors, DitherMode, RefineIterations, Pool, tmpImage.gPalette, tmpImage.gPixels);
+	if (err == G_NO_ERROR) {
+		PalettedImage.Reset();
+		PalettedImage.ReferenceMove(tmpImage);
 	}
 	return err;
 }
@@ -3816,7 +4137,7 @@ GError GPixelMap::SplitChannels(GPixelMap *AlphaImage, GPixelMap *RedImage, GPix
 	GUChar8 a8, r8, g8, b8;
 	GError err;
 	GUChar8 *alphaPixels = NULL, *redPixels = NULL, *greenPixels = NULL, *bluePixels = NULL;
-	GInt32 i, j, argb32;
+	GInt32 i, j;
 
 	if (IsGrayScale() || IsPaletted())
 		return G_INVALID_OPERATION;
@@ -3858,25 +4179,14 @@ GError GPixelMap::SplitChannels(GPixelMap *AlphaImage, GPixelMap *RedImage, GPix
 		case G_R8G8B8:
 		case G_A8R8G8B8:
 			pixels32 = (GUInt32 *)gPixels;
-			for (i = 0; i < j; i++) {
-				argb32 = *pixels32++;
-				if (AlphaImage) {
-					a8 = (GUChar8)((argb32 >> 24) & 0xFF);
-					*alphaPixels++ = a8;
-				}
-				if (RedImage) {
-					r8 = (GUChar8)((argb32 >> 16) & 0xFF);
-					*redPixels++ = r8;
-				}
-				if (GreenImage) {
-					g8 = (GUChar8)((argb32 >> 8) & 0xFF);
-					*greenPixels++ = g8;
-				}
-				if (BlueImage) {
-					b8 = (GUChar8)(argb32 & 0xFF);
-					*bluePixels++ = b8;
-				}
-			}
+			if (AlphaImage)
+				ExtractChannel32(pixels32, alphaPixels, j, 24);
+			if (RedImage)
+				ExtractChannel32(pixels32, redPixels, j, 16);
+			if (GreenImage)
+				ExtractChannel32(pixels32, greenPixels, j, 8);
+			if (BlueImage)
+				ExtractChannel32(pixels32, bluePixels, j, 0);
 			break;
 
 		case G_A1R5G5B5:
@@ -3931,10 +4241,9 @@ GError GPixelMap::MergeChannels(const GPixelMap& RedImage, const GPixelMap& Gree
 								const GPixelMap *AlphaImage) {
 
 	GUInt32 *pixels32;
-	GUInt32 a32, r32, g32, b32;
 	GError err;
 	GUChar8 *alphaPixels = NULL, *redPixels, *greenPixels, *bluePixels;
-	GInt32 i, j, width, height;
+	GInt32 width, height;
 
 	if (!RedImage.IsGrayScale() || !GreenImage.IsGrayScale() || !BlueImage.IsGrayScale())
 		return G_INVALID_PARAMETER;
@@ -3968,31 +4277,7 @@ GError GPixelMap::MergeChannels(const GPixelMap& RedImage, const GPixelMap& Gree
 		alphaPixels = (GUChar8 *)AlphaImage->gPixels;
 	pixels32 = (GUInt32 *)gPixels;
 
-	j = PixelsCount();
-	if (AlphaImage) {
-		for (i = 0; i < j; i++) {
-			a32 = (GUInt32)*alphaPixels;
-			r32 = (GUInt32)*redPixels;
-			g32 = (GUInt32)*greenPixels;
-			b32 = (GUInt32)*bluePixels;
-			*pixels32++ = (a32 << 24) | (r32 << 16) | (g32 << 8) | b32;
-			alphaPixels++;
-			redPixels++;
-			greenPixels++;
-			bluePixels++;
-		}
-	}
-	else {
-		for (i = 0; i < j; i++) {
-			r32 = (GUInt32)*redPixels;
-			g32 = (GUInt32)*greenPixels;
-			b32 = (GUInt32)*bluePixels;
-			*pixels32++ = (r32 << 16) | (g32 << 8) | b32;
-			redPixels++;
-			greenPixels++;
-			bluePixels++;
-		}
-	}
+	MergeChannels32(alphaPixels, redPixels, greenPixels, bluePixels, pixels32, PixelsCount());
 	return G_NO_ERROR;
 }
 
@@ -27,6 +27,7 @@
 **********************************************************************/
 
 #include "amanith/2d/gpolylinecurve2d.h"
+#include "amanith/geometry/gbulkxform.h"
 #include <algorithm>
 
 /*!
@@ -336,6 +337,53 @@ GBool GPolyLineCurve2D::ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex) co
 	return G_TRUE;
 }
 
+// given a domain value, it returns the span index that includes it, starting from a key index hint
+GBool GPolyLineCurve2D::ParamToKeyIndex(const GReal Param, GUInt32& KeyIndex, const GUInt32 KeyIndexHint) const {
+
+	GUInt32 i = KeyIndexHint, j = (GUInt32)gKeys.size(), steps;
+
+	if (i + 1 < j && Param >= gKeys[i].Parameter) {
+		// sorted parameters usually fall in the same interval, or in one of the next ones
+		for (steps = 0; steps < 4 && i + 1 < j; steps++, i++) {
+			if (Param < gKeys[i + 1].Parameter) {
+				KeyIndex = i;
+				return G_TRUE;
+			}
+		}
+	}
+	// too far, lets do a binary search
+	return ParamToKeyIndex(Param, KeyIndex);
+}
+
+// key values are interleaved with parameters, so they are gathered, transformed all at once and scattered back
+void GPolyLineCurve2D::XForm(const GMatrix23& Matrix) {
+
+	GUInt32 i, j = (GUInt32)gKeys.size();
+	GDynArray<GPoint2> points(j);
+
+	if (j == 0)
+		return;
+	for (i = 0; i < j; ++i)
+		points[i] = gKeys[i].Value;
+	GBulkXForm::XForm(Matrix, &points[0], &points[0], j);
+	for (i = 0; i < j; ++i)
+		gKeys[i].Value = points[i];
+}
+
+void GPolyLineCurve2D::XForm(const GMatrix33& Matrix, const GBool DoProjection) {
+
+	GUInt32 i, j = (GUInt32)gKeys.size();
+	GDynArray<GPoint2> points(j);
+
+	if (j == 0)
+		return;
+	for (i = 0; i < j; ++i)
+		points[i] = gKeys[i].Value;
+	GBulkXForm::XForm(Matrix, DoProjection, &points[0], &points[0], j);
+	for (i = 0; i < j; ++i)
+		gKeys[i].Value = points[i];
+}
+
 // get max variation (chordal distance) in the domain range
 //GReal GPolyLineCurve2D::Variation(const GReal u0, const GReal u1, const GPoint2& p0, const GPoint2& p1) const {
 GReal GPolyLineCurve2D::Variation() const {
@@ -779,7 +827,7 @@ GVector2 GPolyLineCurve2D::Derivative(const GDerivativeOrder Order, const GReal
 
 	// clamp parameter inside valid interval
 	if (u <= DomainStart())
-		keyIndex = 1;
+		keyIndex = 0;
 	else
 	if (u >= DomainEnd())
 		keyIndex = PointsCount() - 2;
@@ -791,6 +839,70 @@ GVector2 GPolyLineCurve2D::Derivative(const GDerivativeOrder Order, const GReal
 	return ((gKeys[keyIndex + 1].Value - gKeys[keyIndex].Value) * dtdu);
 }
 
+// evaluate the curve at several global parameters
+void GPolyLineCurve2D::Evaluate(const GDynArray<GReal>& Params, GDynArray<GPoint2>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size(), keyIndex = 0;
+	GReal u, ratio;
+	GBool b;
+
+	Out.resize(j);
+	if (PointsCount() < 1) {
+		for (i = 0; i < j; i++)
+			Out[i] = GPoint2(G_MIN_REAL, G_MIN_REAL);
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// check for global parameter out of range
+		if (u <= DomainStart())
+			Out[i] = StartPoint();
+		else
+		if (u >= DomainEnd())
+			Out[i] = EndPoint();
+		else {
+			// the previous key index is a good starting point for sorted parameters
+			b = ParamToKeyIndex(u, keyIndex, keyIndex);
+			G_ASSERT(b == G_TRUE);
+			ratio = (u - gKeys[keyIndex].Parameter) / (gKeys[keyIndex + 1].Parameter - gKeys[keyIndex].Parameter);
+			Out[i] = GMath::Lerp(ratio, gKeys[keyIndex].Value, gKeys[keyIndex + 1].Value);
+		}
+	}
+}
+
+// evaluate the derivate Order-th at several global parameters
+void GPolyLineCurve2D::Derivative(const GDerivativeOrder Order, const GDynArray<GReal>& Params, GDynArray<GVector2>& Out) const {
+
+	GUInt32 i, j = (GUInt32)Params.size(), k, keyIndex = 0;
+	GReal u, dtdu;
+	GBool b;
+
+	Out.resize(j);
+	if (Order >= G_SECOND_ORDER_DERIVATIVE || PointsCount() < 2) {
+		for (i = 0; i < j; i++)
+			Out[i] = GVector2(0, 0);
+		return;
+	}
+
+	for (i = 0; i < j; i++) {
+		u = Params[i];
+		// clamp parameter inside valid interval
+		if (u <= DomainStart())
+			k = 0;
+		else
+		if (u >= DomainEnd())
+			k = PointsCount() - 2;
+		else {
+			b = ParamToKeyIndex(u, keyIndex, keyIndex);
+			G_ASSERT(b == G_TRUE);
+			k = keyIndex;
+		}
+		dtdu = gKeys[k + 1].Parameter - gKeys[k].Parameter;
+		Out[i] = (gKeys[k + 1].Value - gKeys[k].Value) * dtdu;
+	}
+}
+
 void GPolyLineCurve2D::DerivativeLR(const GDerivativeOrder Order, const GReal u,
 									GVector2& LeftDerivative, GVector2& RightDerivative) const {
 
@@ -121,7 +121,7 @@ void GTesselator2D::DebugDumpDictionary(std::FILE *File, GDictionaryTree& Dictio
 	GAVLNode *nUpper;
 	GMeshEdge2D<GDouble> *upperExtEdge;
 	GDouble sweepDist;
-	GInt32 crossNumber;
+	GInt32 crossNumber, windNumber;
 	GMeshToAVL *data;
 	GString s;
 
@@ -130,21 +130,25 @@ void GTesselator2D::DebugDumpDictionary(std::FILE *File, GDictionaryTree& Dictio
 
 	nUpper = Dictionary.Max();
 	crossNumber = 1;
+	windNumber = 0;
 	while (nUpper) {
 		upperExtEdge = (GMeshEdge2D<GDouble> *)nUpper->CustomData();
-		// update crossing number
+		// update crossing and winding numbers
 		data = (GMeshToAVL *)upperExtEdge->CustomData();
 		// edge is into dictionary, so it MUST include a descriptor
 		G_ASSERT(data != NULL);
 		if (data->EdgeType != RIGHT_ADDED_EDGE) {
 			data->CrossingNumber = crossNumber;
 			crossNumber++;
+			windNumber += data->Winding;
+			data->WindingNumber = windNumber;
 		}
 		sweepDist = SweepLineDistance(upperExtEdge, Event);
 		s = "Sweep dist = " + StrUtils::ToString(sweepDist, "%5.2f") + ", ";
 		s += "Org = " + StrUtils::ToString(upperExtEdge->Org()->Position(), ";", "%5.2f") + ", ";
 		s += "Dest = " + StrUtils::ToString(upperExtEdge->Dest()->Position(), ";", "%5.2f") + ", ";
 		s += "Cros num. = " + StrUtils::ToString(data->CrossingNumber) + ", ";
+		s += "Wind num. = " + StrUtils::ToString(data->WindingNumber) + ", ";
 		if (data->EdgeType == RIGHT_ADDED_EDGE)
 			s += "Type = RIGHT DIAGONAL";
 		else
@@ -645,18 +649,8 @@ GError GTesselator2D::Tesselate(const GDynArray<GPoint2>& Points, const GDynArra
 		if (!ar->Valid)
 			continue;
 		// use specified fill rule
-		if (FillRule == G_ANY_RULE)
+		if (IsRegionFilled(ar, FillRule))
 			TessellateMonotoneRegion(ar, Triangles, desc);
-		else {
-			if (FillRule == G_ODD_EVEN_RULE) {
-				if ((ar->CrossingNumber & 1) != 0)
-					TessellateMonotoneRegion(ar, Triangles, desc);
-			}
-			else {
-				if ((ar->CrossingNumber & 1) == 0)
-					TessellateMonotoneRegion(ar, Triangles, desc);
-			}
-		}
 	}
 	// free memory used for tessellation
 	FreeTessellation(desc);
@@ -737,18 +731,8 @@ GError GTesselator2D::Tesselate(const GDynArray<GPoint2>& Points, const GDynArra
 		if (!ar->Valid)
 			continue;
 		// use specified fill rule
-		if (FillRule == G_ANY_RULE)
+		if (IsRegionFilled(ar, FillRule))
 			TessellateMonotoneRegion(ar, Triangles, desc);
-		else {
-			if (FillRule == G_ODD_EVEN_RULE) {
-				if ((ar->CrossingNumber & 1) != 0)
-					TessellateMonotoneRegion(ar, Triangles, desc);
-			}
-			else {
-				if ((ar->CrossingNumber & 1) == 0)
-					TessellateMonotoneRegion(ar, Triangles, desc);
-			}
-		}
 	}
 	// free memory used for tessellation
 	FreeTessellation(desc);
@@ -837,18 +821,8 @@ GError GTesselator2D::Tesselate(const GDynArray<GPoint2>& Points, const GDynArra
 		if (!ar->Valid)
 			continue;
 		// use specified fill rule
-		if (FillRule == G_ANY_RULE)
+		if (IsRegionFilled(ar, FillRule))
 			TessellateMonotoneRegion(ar, TriangIds, desc);
-		else {
-			if (FillRule == G_ODD_EVEN_RULE) {
-				if ((ar->CrossingNumber & 1) != 0)
-					TessellateMonotoneRegion(ar, TriangIds, desc);
-			}
-			else {
-				if ((ar->CrossingNumber & 1) == 0)
-					TessellateMonotoneRegion(ar, TriangIds, desc);
-			}
-		}
 	}
 	// free memory used for tessellation
 	FreeTessellation(desc);
@@ -949,18 +923,8 @@ GError GTesselator2D::Tesselate(const GDynArray<GPoint2>& Points, const GDynArra
 		if (!ar->Valid)
 			continue;
 		// use specified fill rule
-		if (FillRule == G_ANY_RULE)
+		if (IsRegionFilled(ar, FillRule))
 			TessellateMonotoneRegion(ar, TriangIds, desc);
-		else {
-			if (FillRule == G_ODD_EVEN_RULE) {
-				if ((ar->CrossingNumber & 1) != 0)
-					TessellateMonotoneRegion(ar, TriangIds, desc);
-			}
-			else {
-				if ((ar->CrossingNumber & 1) == 0)
-					TessellateMonotoneRegion(ar, TriangIds, desc);
-			}
-		}
 	}
 	// free memory used for tessellation
 	FreeTessellation(desc);
@@ -968,6 +932,75 @@ GError GTesselator2D::Tesselate(const GDynArray<GPoint2>& Points, const GDynArra
 	return G_NO_ERROR;
 }
 
+// trapezoidation routine
+GError GTesselator2D::TesselateTrapezoids(const GDynArray<GPoint2>& Points, const GDynArray<GInt32>& PointsPerContour,
+										  GDynArray< GPoint<GDouble, 2> >& Trapezoids, const GFillBehavior FillRule) {
+
+	GExtVertex* extVertex;
+	GInt32 i, j, k, w, ofs;
+	GActiveRegion *ar;
+
+	// test input for consistency
+	if (ValidateInput(Points, PointsPerContour) == G_FALSE)
+		return G_INVALID_PARAMETER;
+
+	// create a tessellation descriptor; contours are inserted with swapped coordinates, so the sweep line
+	// moves along the y axis and monotone regions are monotone respect to y
+	GTessDescriptor desc;
+	desc.Transposed = G_TRUE;
+
+	// insert all contours
+	ofs = 0;
+	j = (GInt32)PointsPerContour.size();
+	for (i = 0; i < j; i++) {
+		// k = number of points of i-th contour
+		k = PointsPerContour[i];
+		if (k == 0)
+			continue;
+		BeginContour((GDouble)Points[ofs][G_Y], (GDouble)Points[ofs][G_X], desc);
+		ofs++;
+		for (w = 1; w < k; w++) {
+			AddContourPoint((GDouble)Points[ofs][G_Y], (GDouble)Points[ofs][G_X], desc);
+			ofs++;
+		}
+		EndContour(desc);
+	}
+	EndTesselletionData(desc);
+
+	// main loop
+	extVertex = desc.PriorityTree.front();
+	while (!desc.PriorityTree.empty()) {
+		// sweep event
+		SweepEvent(extVertex, desc);
+		// next event
+		desc.PriorityTree.pop_front();
+		if (!desc.PriorityTree.empty())
+			extVertex = desc.PriorityTree.front();
+	}
+
+	// at the end of process, dictionary must be empty
+	G_ASSERT(desc.DictionaryTree.NodesCount() == 0);
+
+	// keep track of last closed region
+	if (desc.LastRegion)
+		desc.LastRegionEdge = desc.LastRegion->MeshUpperEdge->Sym();
+	// remove all backface regions
+	PurgeRegions(desc.ActiveRegions, G_TRUE, desc);
+	// split all monotone regions
+	j = (GInt32)desc.ActiveRegions.size();
+	for (i = 0; i < j; i++) {
+		ar = desc.ActiveRegions[i];
+		if (!ar->Valid)
+			continue;
+		// use specified fill rule
+		if (IsRegionFilled(ar, FillRule))
+			TrapezoidateMonotoneRegion(ar, Trapezoids, desc);
+	}
+	// free memory used for tessellation
+	FreeTessellation(desc);
+	return G_NO_ERROR;
+}
+
 void GTesselator2D::BeginContour(const GDouble X, const GDouble Y, GTessDescriptor& Descriptor) {
 
 	G_ASSERT(Descriptor.LastEdge == NULL);
@@ -1141,6 +1174,15 @@ void GTesselator2D::EndTesselletionData(GTessDescriptor& Descriptor) {
 			customData = new GMeshToAVL;
 			customData->EdgeType = UNDEFINED_EDGE;
 			customData->CrossingNumber = -99;
+			customData->WindingNumber = 0;
+			// contour edges going right to left increase the winding number of the regions below them
+			if (PointCmp(e->Dest()->Position(), e->Org()->Position()) < 0)
+				customData->Winding = 1;
+			else
+				customData->Winding = -1;
+			// swapping axes reverses contours orientation
+			if (Descriptor.Transposed)
+				customData->Winding = -customData->Winding;
 			customData->IsIntoDictionary = G_FALSE;
 			customData->AVLNode = NULL;
 			customData->Region = NULL;
@@ -1355,6 +1397,8 @@ GMeshEdge2D<GDouble> *GTesselator2D::TraceLeftDiagonal(GMeshVertex2D<GDouble> *O
 	customData->HasBeenIntoDictionary = G_FALSE;
 	customData->IsIntoDictionary = G_FALSE;
 	customData->CrossingNumber = -99;
+	customData->WindingNumber = 0;
+	customData->Winding = 0;
 	customData->AVLNode = NULL;
 	newEdge->SetCustomData((void *)customData);
 	newEdge->Sym()->SetCustomData((void *)customData);
@@ -1383,6 +1427,8 @@ GMeshEdge2D<GDouble> *GTesselator2D::TraceRightDiagonal(GMeshVertex2D<GDouble> *
 	customData = new GMeshToAVL;
 	customData->AVLNode = NULL;
 	customData->CrossingNumber = -99;
+	customData->WindingNumber = 0;
+	customData->Winding = 0;
 	customData->EdgeType = RIGHT_ADDED_EDGE;
 	customData->HasBeenIntoDictionary = G_FALSE;
 	customData->IsIntoDictionary = G_FALSE;
@@ -1424,7 +1470,27 @@ GInt32 GTesselator2D::CheckIntersection(const GPoint<GDouble, 2>& Event,
 
 	G_ASSERT(EdgeAbove != EdgeBelow);
 
-	if (EdgeAbove->Org() == EdgeBelow->Org() || EdgeAbove->Dest() == EdgeBelow->Dest())
+	// collinear edges sharing the origin overlap; the longer one must be split at the destination
+	// of the shorter one, so that SimplifyEdges can merge the overlapping parts
+	if (EdgeAbove->Org() == EdgeBelow->Org()) {
+		const GPoint<GDouble, 2>& o = EdgeAbove->Org()->Position();
+		const GPoint<GDouble, 2>& dA = EdgeAbove->Dest()->Position();
+		const GPoint<GDouble, 2>& dB = EdgeBelow->Dest()->Position();
+
+		if (PointCmp(o, dA) < 0 && PointCmp(o, dB) < 0 && EdgeSignXY(o, dA, dB) == 0) {
+			ptCmp1 = PointCmp(dA, dB);
+			if (ptCmp1 < 0) {
+				IntersectionPoint = dA;
+				return DEGENERATE_INTERSECTION2;
+			}
+			if (ptCmp1 > 0) {
+				IntersectionPoint = dB;
+				return DEGENERATE_INTERSECTION1;
+			}
+		}
+		return NO_INTERSECTION;
+	}
+	if (EdgeAbove->Dest() == EdgeBelow->Dest())
 		return NO_INTERSECTION;
 	
 	const GPoint<GDouble, 2>& o1 = (EdgeAbove->Org()->Position());
@@ -1481,7 +1547,7 @@ GInt32 GTesselator2D::CheckIntersection(const GPoint<GDouble, 2>& Event,
 GBool GTesselator2D::DoIntersection(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEdge2D<GDouble> *EdgeBelow,
 									GInt32& IntersectionType, GTessDescriptor& Descriptor) {
 
-	GPoint<GDouble, 2> intPoint, auxPoint;
+	GPoint<GDouble, 2> intPoint, auxPoint, oldDestAbove, oldDestBelow;
 	GInt32 intersected, ptCmp;
 	GBool revisitLocalFlag;
 	GMeshEdge2D<GDouble> *newEdge;
@@ -1492,15 +1558,20 @@ GBool GTesselator2D::DoIntersection(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEdge2D
 	IntersectionType = intersected;
 	if (intersected != NO_INTERSECTION) {
 
+		oldDestAbove = EdgeAbove->Dest()->Position();
+		oldDestBelow = EdgeBelow->Dest()->Position();
 		if (intersected == GOOD_INTERSECTION) {
 			ptCmp = PointCmp(intPoint, Descriptor.CurrentEvent->Position());
 			if (ptCmp == 0)
 				revisitLocalFlag = G_TRUE;
 			ManageIntersections(EdgeAbove, EdgeBelow, intPoint, Descriptor);
+			SplitOverlappingEdges(EdgeAbove, oldDestAbove, intPoint, Descriptor);
+			SplitOverlappingEdges(EdgeBelow, oldDestBelow, intPoint, Descriptor);
 		}
 		else
 		if (intersected == DEGENERATE_INTERSECTION2) {
 			newEdge = ManageDegenerativeIntersections(EdgeBelow, EdgeAbove, intPoint, Descriptor);
+			SplitOverlappingEdges(EdgeBelow, oldDestBelow, intPoint, Descriptor);
 			ptCmp = PointCmp(intPoint, Descriptor.CurrentEvent->Position());
 			if (ptCmp == 0)
 				revisitLocalFlag = G_TRUE;
@@ -1508,6 +1579,7 @@ GBool GTesselator2D::DoIntersection(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEdge2D
 		else
 		if (intersected == DEGENERATE_INTERSECTION1) {
 			newEdge = ManageDegenerativeIntersections(EdgeAbove, EdgeBelow, intPoint, Descriptor);
+			SplitOverlappingEdges(EdgeAbove, oldDestAbove, intPoint, Descriptor);
 			ptCmp = PointCmp(intPoint, Descriptor.CurrentEvent->Position());
 			if (ptCmp == 0)
 				revisitLocalFlag = G_TRUE;
@@ -1516,6 +1588,27 @@ GBool GTesselator2D::DoIntersection(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEdge2D
 	return revisitLocalFlag;
 }
 
+// overlapping edges (same origin and destination) are merged only when the sweep line reaches their destination;
+// until then they must be split together, else the ones not adjacent to the intersecting edge would pass through
+// the intersection point without a vertex there
+void GTesselator2D::SplitOverlappingEdges(GMeshEdge2D<GDouble> *SplitEdge, const GPoint<GDouble, 2>& OldDest,
+										  const GPoint<GDouble, 2>& IntersectionPoint, GTessDescriptor& Descriptor) {
+
+	GDynArray<GMeshEdge2D<GDouble> *> overlapping;
+	GMeshEdge2D<GDouble> *e;
+	GUInt32 i, j;
+
+	e = SplitEdge->Onext();
+	while (e != SplitEdge) {
+		if (PointCmp(e->Dest()->Position(), OldDest) == 0)
+			overlapping.push_back(e);
+		e = e->Onext();
+	}
+	j = (GUInt32)overlapping.size();
+	for (i = 0; i < j; i++)
+		ManageDegenerativeIntersections(overlapping[i], SplitEdge, IntersectionPoint, Descriptor);
+}
+
 void GTesselator2D::ManageIntersections(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEdge2D<GDouble> *EdgeBelow,
 										const GPoint<GDouble, 2>& IntersectionPoint, GTessDescriptor& Descriptor) {
 
@@ -1567,6 +1660,8 @@ void GTesselator2D::ManageIntersections(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEd
 	customData = new GMeshToAVL;
 	customData->AVLNode = NULL;
 	customData->CrossingNumber = -99;
+	customData->WindingNumber = 0;
+	customData->Winding = tmpData->Winding;
 	customData->EdgeType = tmpData->EdgeType;
 	customData->HasBeenIntoDictionary = G_FALSE;
 	customData->IsIntoDictionary = G_FALSE;
@@ -1600,6 +1695,8 @@ void GTesselator2D::ManageIntersections(GMeshEdge2D<GDouble> *EdgeAbove, GMeshEd
 	customData = new GMeshToAVL;
 	customData->AVLNode = NULL;
 	customData->CrossingNumber = -99;
+	customData->WindingNumber = 0;
+	customData->Winding = tmpData->Winding;
 	customData->EdgeType = tmpData->EdgeType;
 	customData->HasBeenIntoDictionary = G_FALSE;
 	customData->IsIntoDictionary = G_FALSE;
@@ -1653,6 +1750,8 @@ GMeshEdge2D<GDouble> *GTesselator2D::ManageDegenerativeIntersections(GMeshEdge2D
 	customData = new GMeshToAVL;
 	customData->AVLNode = NULL;
 	customData->CrossingNumber = -99;
+	customData->WindingNumber = 0;
+	customData->Winding = tmpData->Winding;
 	customData->EdgeType = tmpData->EdgeType;
 	customData->HasBeenIntoDictionary = G_FALSE;
 	customData->IsIntoDictionary = G_FALSE;
@@ -1777,7 +1876,7 @@ GBool GTesselator2D::CloseRegion(GMeshEdge2D<GDouble> *UpperEdge, GDynArray<GAct
 								 GTessDescriptor& Descriptor) {
 
 	GMeshEdge2D<GDouble> *e;
-	GInt32 correctCrossNumber;
+	GInt32 correctCrossNumber, correctWindNumber;
 	GActiveRegion *region;
 	GInt32 ptCmp;
 	GMeshToAVL *customData;
@@ -1797,12 +1896,15 @@ GBool GTesselator2D::CloseRegion(GMeshEdge2D<GDouble> *UpperEdge, GDynArray<GAct
 	DebugWrite(debugFile, StrUtils::ToAscii(s));
 #endif
 
-	if (customData->EdgeType == NORMAL_EDGE)
+	if (customData->EdgeType == NORMAL_EDGE) {
 		correctCrossNumber = customData->CrossingNumber;
+		correctWindNumber = customData->WindingNumber;
+	}
 	else {
 		G_ASSERT(customData->EdgeType == RIGHT_ADDED_EDGE);
 		n = Descriptor.DictionaryTree.Next(customData->AVLNode);
-		if (n) {
+		// skip other right diagonals overlapping this one, they don't have crossing numbers
+		while (n) {
 			e = (GMeshEdge2D<GDouble> *)n->CustomData();
 #ifdef TESSELATOR_DEBUG_ACTIVATED
 			s = StrUtils::ToString(UpperEdge->Org()->Position(), ";", "%5.2f") + ", " + StrUtils::ToString(e->Org()->Position(), ";", "%5.2f");
@@ -1810,14 +1912,18 @@ GBool GTesselator2D::CloseRegion(GMeshEdge2D<GDouble> *UpperEdge, GDynArray<GAct
 #endif
 			G_ASSERT(e);
 			ptCmp = PointCmp(UpperEdge->Org()->Position(), e->Org()->Position());
-			if (ptCmp == 0) {
-				ptCmp = PointCmp(UpperEdge->Dest()->Position(), e->Dest()->Position());
-				if (ptCmp == 0) {
-					customData = (GMeshToAVL *)e->CustomData();
-					correctCrossNumber = customData->CrossingNumber;
-					goto doCloseRegion;
-				}
+			if (ptCmp != 0)
+				break;
+			ptCmp = PointCmp(UpperEdge->Dest()->Position(), e->Dest()->Position());
+			if (ptCmp != 0)
+				break;
+			customData = (GMeshToAVL *)e->CustomData();
+			if (customData->EdgeType != RIGHT_ADDED_EDGE) {
+				correctCrossNumber = customData->CrossingNumber;
+				correctWindNumber = customData->WindingNumber;
+				goto doCloseRegion;
 			}
+			n = Descriptor.DictionaryTree.Next(n);
 		}
 
 		e = UpperEdge;
@@ -1837,15 +1943,21 @@ GBool GTesselator2D::CloseRegion(GMeshEdge2D<GDouble> *UpperEdge, GDynArray<GAct
 		} while(customData->EdgeType == RIGHT_ADDED_EDGE);
 		G_ASSERT(customData != NULL);
 		G_ASSERT(e != NULL);
-		if (IsRightGoing(e, e->Org()))
+		if (IsRightGoing(e, e->Org())) {
 			correctCrossNumber = customData->CrossingNumber;
-		else
-			correctCrossNumber = customData->CrossingNumber - 1;
+			correctWindNumber = customData->WindingNumber;
+		}
+		else {
+			// an edge that merges overlapping edges counts as many crossings as its winding, modulo 2
+			correctCrossNumber = customData->CrossingNumber - GMath::Abs(customData->Winding);
+			correctWindNumber = customData->WindingNumber - customData->Winding;
+		}
 	}
 
 doCloseRegion:
 	region = new GActiveRegion;
 	region->CrossingNumber = correctCrossNumber;
+	region->WindingNumber = correctWindNumber;
 	region->MeshUpperEdge = UpperEdge;
 	region->Valid = G_TRUE;
 	ActiveRegions.push_back(region);
@@ -1862,8 +1974,8 @@ GBool GTesselator2D::CloseRegions(GMeshVertex2D<GDouble> *EventVertex, GDynArray
 	GAVLNode *upperBO;
 	GMeshEdge2D<GDouble> *upperExtEdge, *lowerExtEdge, *extAbove, *extBelow;
 	GDouble area, oldArea, sweepDist;
-	GInt32 crossNumber, intersected, lCount, delCount, area0Count, ptCmp;
-	GBool leftGoingFound, regionClosed, localRevisitFlag;
+	GInt32 crossNumber, windNumber, intersected, lCount, delCount, area0Count, area0Winding, ptCmp;
+	GBool leftGoingFound, regionClosed, localRevisitFlag, area0Diagonal;
 	GMeshToAVL *data;
 
 	leftGoingFound = G_FALSE;
@@ -1872,17 +1984,21 @@ GBool GTesselator2D::CloseRegions(GMeshVertex2D<GDouble> *EventVertex, GDynArray
 	upperBO = NULL;
 
 	crossNumber = 1;
-	lCount = delCount = area0Count = 0;
+	windNumber = 0;
+	lCount = delCount = area0Count = area0Winding = 0;
+	area0Diagonal = G_FALSE;
 	area = oldArea = 1;
 	while (nUpper) {
 		upperExtEdge = (GMeshEdge2D<GDouble> *)nUpper->CustomData();
-		// update crossing number
+		// update crossing and winding numbers
 		data = (GMeshToAVL *)upperExtEdge->CustomData();
 		// edge is into dictionary, so it MUST include a descriptor
 		G_ASSERT(data != NULL);
 		if (data->EdgeType != RIGHT_ADDED_EDGE) {
 			data->CrossingNumber = crossNumber;
 			crossNumber++;
+			windNumber += data->Winding;
+			data->WindingNumber = windNumber;
 		}
 
 		sweepDist = SweepLineDistance(upperExtEdge, Descriptor.CurrentEvent);
@@ -1911,6 +2027,9 @@ GBool GTesselator2D::CloseRegions(GMeshVertex2D<GDouble> *EventVertex, GDynArray
 		if (IsLeftGoingFast(upperExtEdge, EventVertex)) {
 			leftGoingFound = G_TRUE;
 			lCount++;
+			area0Winding += data->Winding;
+			if (data->EdgeType == RIGHT_ADDED_EDGE)
+				area0Diagonal = G_TRUE;
 			// now test if eventVertex->MeshVertex is a left-going vertex of lowerExtEdge->MeshEdge
 			if (nLower) {
 				lowerExtEdge = (GMeshEdge2D<GDouble> *)nLower->CustomData();
@@ -1922,11 +2041,14 @@ GBool GTesselator2D::CloseRegions(GMeshVertex2D<GDouble> *EventVertex, GDynArray
 						// now we are sure that both edges are left-going edges, so we can output an
 						// active region and classify it according to upperExtEdge cross number
 						regionClosed = CloseRegion(upperExtEdge, ActiveRegions, Descriptor);
-						if (area0Count & 1)
+						// SimplifyEdges will remove all overlapping edges if their windings cancel out and
+						// there isn't a right diagonal among them, else it will keep one of them
+						if (area0Count > 0 && area0Winding == 0 && !area0Diagonal)
 							delCount += (area0Count + 1);
 						else
 							delCount += area0Count;
-						area0Count = 0;
+						area0Count = area0Winding = 0;
+						area0Diagonal = G_FALSE;
 					}
 					else
 						area0Count++;
@@ -1951,7 +2073,7 @@ GBool GTesselator2D::CloseRegions(GMeshVertex2D<GDouble> *EventVertex, GDynArray
 	*UpperBounder = regionUpperNode;
 	*LowerBounder = regionLowerNode;
 	if (area <= gPrecision) {
-		if (area0Count & 1)
+		if (area0Count > 0 && area0Winding == 0 && !area0Diagonal)
 			delCount += (area0Count + 1);
 		else
 			delCount += area0Count;
@@ -2122,10 +2244,11 @@ cleanRing2:
 void GTesselator2D::SimplifyEdges(GMeshVertex2D<GDouble> *Event, GDynArray<GActiveRegion *>& ActiveRegions,
 								  GTessDescriptor& Descriptor) {
 
-	GMeshEdge2D<GDouble> *firstEdge, *outgoingEdge, *tmpEdge, *auxEdge;
-	GInt32 ptCmp, ringCount;
+	GMeshEdge2D<GDouble> *firstEdge, *outgoingEdge, *tmpEdge, *keepEdge;
+	GDynArray<GMeshEdge2D<GDouble> *> overlapped;
+	GInt32 ptCmp, ringCount, winding;
 	GUInt32 i, j;
-	GMeshToAVL *data1, *data2, *data2Sym, *data1Sym;
+	GMeshToAVL *data1, *data2, *data2Sym, *data1Sym, *keepData;
 
 	ringCount = Event->EdgesInRingCount();
 
@@ -2153,58 +2276,87 @@ cleanRing:
 				Descriptor.DictionaryTree.DeleteNode(data2->AVLNode);
 			}
 
-			tmpEdge = outgoingEdge->Oprev();
-			if (!IsRightGoing(tmpEdge, Event)) {
-				ptCmp = PointCmp(tmpEdge->Dest()->Position(), outgoingEdge->Dest()->Position());
-				if (ptCmp == 0) {
-					// extract descriptors
-					data1 = (GMeshToAVL *)tmpEdge->CustomData();
-					data1Sym = (GMeshToAVL *)tmpEdge->Sym()->CustomData();
-					G_ASSERT(data1 == data1Sym && data1 != NULL);
-
-					if ((data1->HasBeenIntoDictionary) && (data1->IsIntoDictionary)) {
+			// collect all swept edges that overlap outgoingEdge; they are not always adjacent into the ring
+			// (a left diagonal can lie between them), so the whole ring must be scanned
+			overlapped.clear();
+			winding = 0;
+			keepEdge = NULL;
+			keepData = NULL;
+			tmpEdge = outgoingEdge;
+			do {
+				data1 = (GMeshToAVL *)tmpEdge->CustomData();
+				data1Sym = (GMeshToAVL *)tmpEdge->Sym()->CustomData();
+				G_ASSERT(data1 == data1Sym && data1 != NULL);
+				if (data1->HasBeenIntoDictionary && !IsRightGoing(tmpEdge, Event) &&
+					PointCmp(tmpEdge->Dest()->Position(), outgoingEdge->Dest()->Position()) == 0) {
+					if (data1->IsIntoDictionary) {
 						G_ASSERT(data1->AVLNode != NULL);
 						data1->IsIntoDictionary = G_FALSE;
 						Descriptor.DictionaryTree.DeleteNode(data1->AVLNode);
 					}
-
-					if (data1->HasBeenIntoDictionary && data2->HasBeenIntoDictionary) {
-						if (data1->Region) {
-							auxEdge = tmpEdge->Oprev();
-							ptCmp = PointCmp(auxEdge->Dest()->Position(), tmpEdge->Dest()->Position());
-							if (ptCmp == 0) {
-								data1->Region->MeshUpperEdge = auxEdge->Sym();
-							}
-							else
-								data1->Region->Valid = G_FALSE;
-						}
-						else
-						if (data2->Region) {
-							auxEdge = tmpEdge->Oprev();
-							ptCmp = PointCmp(auxEdge->Dest()->Position(), tmpEdge->Dest()->Position());
-							if (ptCmp == 0) {
-								data2->Region->MeshUpperEdge = auxEdge->Sym();
-							}
-							else
-								data2->Region->Valid = G_FALSE;
+					overlapped.push_back(tmpEdge);
+					winding += data1->Winding;
+					// prefer to keep the edge that bounds a closed region
+					if (!keepData || (data1->Region && !keepData->Region)) {
+						keepEdge = tmpEdge;
+						keepData = data1;
+					}
+				}
+				tmpEdge = tmpEdge->Oprev();
+			} while (tmpEdge != outgoingEdge);
+
+			if (overlapped.size() > 1) {
+				// if windings cancel out, regions above and below overlapping edges have the same winding number
+				// and crossing parity, so only a right diagonal (if any) is kept; else one edge is kept, carrying the
+				// summed winding and the numbers of the region below all of them (crossing numbers grow downward)
+				if (winding == 0) {
+					keepEdge = NULL;
+					keepData = NULL;
+					j = (GUInt32)overlapped.size();
+					for (i = 0; i < j; i++) {
+						data1 = (GMeshToAVL *)overlapped[i]->CustomData();
+						if (data1->EdgeType == RIGHT_ADDED_EDGE && (!keepData || (data1->Region && !keepData->Region))) {
+							keepEdge = overlapped[i];
+							keepData = data1;
 						}
 					}
-					// detach tmpEdge and outgoingEdge
-					if (data1->HasBeenIntoDictionary) {
-						SafeRemoveEdgeFromVertex(tmpEdge);
-						SafeRemoveEdgeFromVertex(tmpEdge->Sym());
-						Descriptor.TargetMesh.DetachEdge(tmpEdge);
-						ringCount--;
+				}
+				else {
+					j = (GUInt32)overlapped.size();
+					for (i = 0; i < j; i++) {
+						data1 = (GMeshToAVL *)overlapped[i]->CustomData();
+						if (data1->EdgeType == RIGHT_ADDED_EDGE)
+							continue;
+						if (keepData->EdgeType == RIGHT_ADDED_EDGE || data1->CrossingNumber > keepData->CrossingNumber) {
+							keepData->EdgeType = data1->EdgeType;
+							keepData->CrossingNumber = data1->CrossingNumber;
+							keepData->WindingNumber = data1->WindingNumber;
+						}
 					}
-					if (data2->HasBeenIntoDictionary) {
-						SafeRemoveEdgeFromVertex(outgoingEdge);
-						SafeRemoveEdgeFromVertex(outgoingEdge->Sym());
-						Descriptor.TargetMesh.DetachEdge(outgoingEdge);
-						ringCount--;
+					keepData->Winding = winding;
+				}
+				// detach overlapping edges
+				j = (GUInt32)overlapped.size();
+				for (i = 0; i < j; i++) {
+					tmpEdge = overlapped[i];
+					if (tmpEdge == keepEdge)
+						continue;
+					data1 = (GMeshToAVL *)tmpEdge->CustomData();
+					if (data1->Region) {
+						if (keepData && !keepData->Region) {
+							data1->Region->MeshUpperEdge = keepEdge->Sym();
+							keepData->Region = data1->Region;
+						}
+						else
+							data1->Region->Valid = G_FALSE;
 					}
-					// start again (this simplify code)
-					goto cleanRing;
+					SafeRemoveEdgeFromVertex(tmpEdge);
+					SafeRemoveEdgeFromVertex(tmpEdge->Sym());
+					Descriptor.TargetMesh.DetachEdge(tmpEdge);
+					ringCount--;
 				}
+				// start again (this simplify code)
+				goto cleanRing;
 			}
 		}
 		outgoingEdge = outgoingEdge->Oprev();
@@ -2395,6 +2547,176 @@ void GTesselator2D::TessellateMonotoneRegion(const GActiveRegion* Region, GDynAr
 	Points.push_back(lo->Lnext()->Dest()->Position());
 }
 
+// y coordinate of the segment (P0, P1) at the specified x; P0 and P1 must have different x
+static GDouble ChainHeight(const GPoint<GDouble, 2>& P0, const GPoint<GDouble, 2>& P1, const GDouble X) {
+
+	GDouble t = (X - P0[G_X]) / (P1[G_X] - P0[G_X]);
+	return P0[G_Y] + t * (P1[G_Y] - P0[G_Y]);
+}
+
+// push a trapezoid with vertical parallel sides at X0 and X1, swapping coordinates back if needed
+static void PushTrapezoid(GDynArray< GPoint<GDouble, 2> >& Trapezoids, const GDouble X0, const GDouble X1,
+						  const GDouble YLow0, const GDouble YLow1, const GDouble YUp0, const GDouble YUp1,
+						  const GBool Transposed) {
+
+	if (Transposed) {
+		Trapezoids.push_back(GPoint<GDouble, 2>(YLow0, X0));
+		Trapezoids.push_back(GPoint<GDouble, 2>(YUp0, X0));
+		Trapezoids.push_back(GPoint<GDouble, 2>(YUp1, X1));
+		Trapezoids.push_back(GPoint<GDouble, 2>(YLow1, X1));
+	}
+	else {
+		Trapezoids.push_back(GPoint<GDouble, 2>(X0, YLow0));
+		Trapezoids.push_back(GPoint<GDouble, 2>(X1, YLow1));
+		Trapezoids.push_back(GPoint<GDouble, 2>(X1, YUp1));
+		Trapezoids.push_back(GPoint<GDouble, 2>(X0, YUp0));
+	}
+}
+
+// an edge crossing a slab, used to trapezoidate regions whose boundary is not monotone
+struct GSlabCrossing {
+	GDouble Y0;
+	GDouble Y1;
+};
+
+static bool SlabCrossingLess(const GSlabCrossing& C1, const GSlabCrossing& C2) {
+
+	return ((C1.Y0 + C1.Y1) < (C2.Y0 + C2.Y1));
+}
+
+// split a simple loop into slabs at every vertex, pairing the edges that cross each slab
+static void TrapezoidateLoop(const GDynArray< GPoint<GDouble, 2> >& Loop, GDynArray< GPoint<GDouble, 2> >& Trapezoids,
+							 const GBool Transposed) {
+
+	GDynArray<GDouble> xs;
+	GDynArray<GSlabCrossing> crossings;
+	GSlabCrossing c;
+	GInt32 i, j, k, n = (GInt32)Loop.size();
+	GDouble x0, x1;
+
+	for (i = 0; i < n; i++)
+		xs.push_back(Loop[i][G_X]);
+	std::sort(xs.begin(), xs.end());
+	xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+	k = (GInt32)xs.size();
+	for (i = 0; i + 1 < k; i++) {
+		x0 = xs[i];
+		x1 = xs[i + 1];
+		// slabs are delimited by vertices, so every non vertical edge either spans the whole slab or misses it
+		crossings.clear();
+		for (j = 0; j < n; j++) {
+			const GPoint<GDouble, 2>& p0 = Loop[j];
+			const GPoint<GDouble, 2>& p1 = Loop[(j + 1) % n];
+			if (GMath::Min(p0[G_X], p1[G_X]) <= x0 && GMath::Max(p0[G_X], p1[G_X]) >= x1) {
+				c.Y0 = ChainHeight(p0, p1, x0);
+				c.Y1 = ChainHeight(p0, p1, x1);
+				crossings.push_back(c);
+			}
+		}
+		std::sort(crossings.begin(), crossings.end(), SlabCrossingLess);
+		for (j = 0; j + 1 < (GInt32)crossings.size(); j += 2) {
+			if (crossings[j + 1].Y0 > crossings[j].Y0 || crossings[j + 1].Y1 > crossings[j].Y1)
+				PushTrapezoid(Trapezoids, x0, x1, crossings[j].Y0, crossings[j].Y1,
+							  crossings[j + 1].Y0, crossings[j + 1].Y1, Transposed);
+		}
+	}
+}
+
+void GTesselator2D::TrapezoidateMonotoneRegion(const GActiveRegion* Region, GDynArray< GPoint<GDouble, 2> >& Trapezoids,
+											   GTessDescriptor& Descriptor) {
+
+	GDynArray< GPoint<GDouble, 2> > loop, lower, upper;
+	GMeshEdge2D<GDouble> *e, *startEdge;
+	GInt32 i, j, n, iMin, iMax;
+	GDouble x0, x1, yl0, yl1, yu0, yu1;
+
+	// collect region boundary; edges are oriented CCW around the region
+	startEdge = e = Region->MeshUpperEdge->Sym();
+	do {
+		loop.push_back(e->Org()->Position());
+		e = e->Lnext();
+	} while (e != startEdge);
+
+	n = (GInt32)loop.size();
+	if (n < 3)
+		return;
+	// find leftmost and rightmost vertices
+	iMin = iMax = 0;
+	for (i = 1; i < n; i++) {
+		if (PointCmp(loop[i], loop[iMin]) < 0)
+			iMin = i;
+		if (PointCmp(loop[i], loop[iMax]) > 0)
+			iMax = i;
+	}
+	// going CCW from the leftmost vertex we walk along the lower chain, going CW along the upper chain
+	i = iMin;
+	lower.push_back(loop[i]);
+	while (i != iMax) {
+		i = (i + 1) % n;
+		lower.push_back(loop[i]);
+	}
+	i = iMin;
+	upper.push_back(loop[i]);
+	while (i != iMax) {
+		i = (i + n - 1) % n;
+		upper.push_back(loop[i]);
+	}
+	// degenerate inputs can produce regions whose chains are not monotone, split them the slow way
+	for (i = 1; i < (GInt32)lower.size(); i++) {
+		if (lower[i][G_X] < lower[i - 1][G_X]) {
+			TrapezoidateLoop(loop, Trapezoids, Descriptor.Transposed);
+			return;
+		}
+	}
+	for (i = 1; i < (GInt32)upper.size(); i++) {
+		if (upper[i][G_X] < upper[i - 1][G_X]) {
+			TrapezoidateLoop(loop, Trapezoids, Descriptor.Transposed);
+			return;
+		}
+	}
+
+	// merge the two chains, splitting the region at every vertex
+	i = j = 0;
+	x0 = lower[0][G_X];
+	for (;;) {
+		// find the segments that span the interval starting at x0, skipping vertical ones
+		while (i + 1 < (GInt32)lower.size() && lower[i + 1][G_X] <= x0)
+			i++;
+		while (j + 1 < (GInt32)upper.size() && upper[j + 1][G_X] <= x0)
+			j++;
+		if (i + 1 >= (GInt32)lower.size() || j + 1 >= (GInt32)upper.size())
+			break;
+		x1 = GMath::Min(lower[i + 1][G_X], upper[j + 1][G_X]);
+		yl0 = ChainHeight(lower[i], lower[i + 1], x0);
+		yl1 = ChainHeight(lower[i], lower[i + 1], x1);
+		yu0 = ChainHeight(upper[j], upper[j + 1], x0);
+		yu1 = ChainHeight(upper[j], upper[j + 1], x1);
+		// skip empty trapezoids
+		if (yu0 > yl0 || yu1 > yl1)
+			PushTrapezoid(Trapezoids, x0, x1, yl0, yl1, yu0, yu1, Descriptor.Transposed);
+		x0 = x1;
+	}
+}
+
+GBool GTesselator2D::IsRegionFilled(const GActiveRegion* Region, const GFillBehavior FillRule) {
+
+	switch (FillRule) {
+		case G_ODD_EVEN_RULE:
+			return ((Region->CrossingNumber & 1) != 0);
+		case G_EVEN_ODD_RULE:
+			return ((Region->CrossingNumber & 1) == 0);
+		case G_NON_ZERO_RULE:
+			return (Region->WindingNumber != 0);
+		case G_POSITIVE_RULE:
+			return (Region->WindingNumber > 0);
+		case G_NEGATIVE_RULE:
+			return (Region->WindingNumber < 0);
+		default:
+			return G_TRUE;
+	}
+}
+
 
 GBool GTesselator2D::SweepEvent(GExtVertex* Event, GTessDescriptor& Descriptor) {
 
@@ -2576,10 +2898,10 @@ GMeshEdge2D<GDouble> *GTesselator2D::CCWSmallerAngleSpanEdge(GMeshEdge2D<GDouble
 		}
 		e2 = e2->Oprev();
 	}
-	// it's possible that there are overlapping edges
+	// it's possible that there are overlapping edges, skip all of them
 	GDouble area;
 	GBool ok;
-	e1 = eGood;
+	e1 = startEdge = eGood;
 	do {
 		e1 = e1->Onext();
 
@@ -2605,8 +2927,10 @@ GMeshEdge2D<GDouble> *GTesselator2D::CCWSmallerAngleSpanEdge(GMeshEdge2D<GDouble
 				else
 					ok = G_TRUE;
 			}
+			else
+				ok = G_TRUE;
 		}
-	} while (!ok && e1 != eGood);
+	} while (!ok && e1->Onext() != startEdge);
 	return eGood;
 }
 
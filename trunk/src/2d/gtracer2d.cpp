@@ -33,6 +33,7 @@
 #include "amanith/numerics/geigen.h"
 #include "amanith/2d/gpolylinecurve2d.h"
 #include "amanith/2d/gbeziercurve2d.h"
+#include <cstring>  // for memcpy function
 
 /*!
 	\file gtracer2d.cpp
@@ -158,15 +159,25 @@ GError GTracedContour::ConvertToPath(GPath2D& Path) const {
 GBool GTracer2D::FindBlackPixel(const GPixelMap& Image, const GUChar8 WhiteColor,
 								 const GInt32 StartY, GPoint<GInt32, 2>& PixelCoords) {
 
-	GInt32 x, x2, y = StartY, ofs;
+	GPoint<GInt32, 2> cursor(0, StartY);
+
+	return FindBlackPixel(Image, WhiteColor, cursor, PixelCoords);
+}
+
+GBool GTracer2D::FindBlackPixel(const GPixelMap& Image, const GUChar8 WhiteColor,
+								GPoint<GInt32, 2>& ScanCursor, GPoint<GInt32, 2>& PixelCoords) {
+
+	GInt32 x = ScanCursor[G_X], x2, y = ScanCursor[G_Y], ofs;
 	GUChar8 *pixels;
 
 	pixels = (GUChar8 *)Image.Pixels();
 	while (y >= 0) {
-		for (x = 0; x < Image.Width(); x++) {
+		for (; x < Image.Width(); x++) {
 			ofs = y * Image.Width() + x;
 			// pixel found
 			if (pixels[ofs] != WhiteColor) {
+				// next scan will resume from here
+				ScanCursor.Set(x, y);
 				x2 = x + 1;
 				ofs++;
 				while ((x2 < Image.Width()) && (pixels[ofs] != WhiteColor)) {
@@ -178,9 +189,11 @@ GBool GTracer2D::FindBlackPixel(const GPixelMap& Image, const GUChar8 WhiteColor
 				return G_TRUE;
 			}
 		}
+		x = 0;
 		y--;
 	}
 	// pixel not found
+	ScanCursor.Set(0, -1);
 	return G_FALSE;
 }
 
@@ -240,6 +253,7 @@ GError GTracer2D::BuildPath(const GPixelMap& Image, const GPoint<GInt32, 2>& Sta
 	Path.Length = 0;
 	Path.Area = 0;
 	Path.Direction = Direction;
+	Path.Start = StartPoint;
 
 	while (1) {
 		// add point to path
@@ -298,7 +312,7 @@ GError GTracer2D::BuildPath(const GPixelMap& Image, const GPoint<GInt32, 2>& Sta
 
 GError GTracer2D::XorUpdate(const PixelPath& Path, GPixelMap& DestImage, const GUChar8 WhiteColor) {
 
-	GInt32 xNew, yNew, i, yOld, j, k, ofs, minY;
+	GInt32 xNew, yNew, i, yOld, j, k, ofs, minY, xRef, x0, x1;
 	GUChar8 *pixel8, gray;
 
 	if (Path.Length <= 0)
@@ -307,13 +321,19 @@ GError GTracer2D::XorUpdate(const PixelPath& Path, GPixelMap& DestImage, const G
 	pixel8 = (GUChar8 *)DestImage.Pixels();
 	j = (GInt32)Path.Points.size();
 	yOld = Path.Points[0][G_Y];
+	// the path is closed, so every row is crossed by an even number of vertical edges; flipping pixels between
+	// each edge and a reference abscissa (instead of the whole [0; edge] span) leads to the same result, touching
+	// only pixels inside the horizontal extent of the path
+	xRef = Path.Points[0][G_X];
 	for (i = 0; i < j; i++) {
 		xNew = Path.Points[i][G_X];
 		yNew = Path.Points[i][G_Y];
 		if (yNew != yOld) {
 			minY = GMath::Min(yOld, yNew);
 			ofs = minY * DestImage.Width();
-			for (k = 0; k < xNew; k++) {
+			x0 = GMath::Min(xNew, xRef);
+			x1 = GMath::Max(xNew, xRef);
+			for (k = x0; k < x1; k++) {
 				gray = pixel8[ofs + k];
 				if (gray != WhiteColor)
 					pixel8[ofs + k] = WhiteColor;
@@ -965,36 +985,36 @@ GError GTracer2D::ShiftPath(PixelPath& Path) {
 	return G_NO_ERROR;
 }
 
-GError GTracer2D::Trace(const GPixelMap& Image, GDynArray<GTracedContour>& Paths,
-						const GUChar8 WhiteColor, const GTurnPolicy TurnPolicy,
-						const GInt32 MaxRadius, const GInt32 MinArea, const GReal Alpha) {
+void GTracer2D::VectorizeJob(void *Data, const GUInt32 JobIndex) {
+
+	VectorizeJobsData *jobs = (VectorizeJobsData *)Data;
+
+	(*jobs->Errors)[JobIndex] = VectorizePath((*jobs->Paths)[JobIndex], (*jobs->Curves)[JobIndex],
+											  (*jobs->Signs)[JobIndex], jobs->AlphaMax, jobs->Scale,
+											  jobs->ImageHeight);
+}
+
+GError GTracer2D::ExtractPaths(const GPixelMap& Image, const GUChar8 WhiteColor, const GTurnPolicy TurnPolicy,
+							   const GInt32 MaxRadius, const GInt32 MinArea,
+							   GDynArray<PixelPath>& Paths, GDynArray<GInt32>& Signs) {
 
-	// we only wanna single channel images
-	if (!Image.IsPaletted() && !Image.IsGrayScale())
-		return G_INVALID_FORMAT;
-	
 	GPixelMap imageCopy;
-	GInt32 y, dir;
+	GInt32 dir;
 	GUInt32 pixel;
-	GPoint<GInt32, 2> blackPixel;
+	GPoint<GInt32, 2> blackPixel, scanCursor;
 	PixelPath path;
 	GError err;
-	GReal globalScale;
-	PrivateCurve curve;
-
-	// calculate a scale that make vectorized paths normalized
-	globalScale = (GReal)(GMath::Max(GMath::Abs(Image.Width()), GMath::Abs(Image.Height())));
-	globalScale = (GReal)1 / globalScale;
 
 	// make a physical copy of input image
-	Image.ResizeCanvas(1, 1, 1, 1, imageCopy, WhiteColor);
+	err = Image.ResizeCanvas(1, 1, 1, 1, imageCopy, WhiteColor);
+	if (err != G_NO_ERROR)
+		return err;
 
-	// iterate through components
-	y = imageCopy.Height() - 1;
-	while (FindBlackPixel(imageCopy, WhiteColor, y, blackPixel)) { 
+	// iterate through components, in a single raster scan
+	scanCursor.Set(0, imageCopy.Height() - 1);
+	while (FindBlackPixel(imageCopy, WhiteColor, scanCursor, blackPixel)) { 
 		// calculate the sign by looking at the original
 		Image.Pixel(blackPixel[G_X] - 1, blackPixel[G_Y] - 1, pixel);
-		y = blackPixel[G_Y];
 		if (pixel != WhiteColor)
 			// black pixel, go up
 			dir = -1;
@@ -1012,16 +1032,357 @@ GError GTracer2D::Trace(const GPixelMap& Image, GDynArray<GTracedContour>& Paths
 		path.Area = GMath::Abs(path.Area);
 		// update buffered image
 		XorUpdate(path, imageCopy, WhiteColor);
-		// if path was "fat" enough, lets append it
+		// if path was "fat" enough, lets keep it
 		if (path.Area >= MinArea) {
-			err = VectorizePath(path, curve, dir, Alpha, globalScale, (GReal)Image.Height());
-			if (err == G_NO_ERROR) {
-				GTracedContour c(curve.Tags, curve.CurvePoints);
-				if (err == G_NO_ERROR)
-					Paths.push_back(c);
+			Paths.push_back(path);
+			Signs.push_back(dir);
+		}
+	}
+	return G_NO_ERROR;
+}
+
+GError GTracer2D::VectorizePaths(GDynArray<PixelPath>& Paths, const GDynArray<GInt32>& Signs,
+								 const GReal AlphaMax, const GReal Scale, const GReal ImageHeight,
+								 GThreadPool *Pool, GDynArray<PrivateCurve>& Curves,
+								 GDynArray<GError>& Errors) {
+
+	GUInt32 j = (GUInt32)Paths.size();
+	VectorizeJobsData jobs;
+	GError err;
+
+	Curves.resize(j);
+	Errors.resize(j);
+	if (j == 0)
+		return G_NO_ERROR;
+
+	// paths are independent, so they can be processed concurrently
+	jobs.Paths = &Paths;
+	jobs.Signs = &Signs;
+	jobs.Curves = &Curves;
+	jobs.Errors = &Errors;
+	jobs.AlphaMax = AlphaMax;
+	jobs.Scale = Scale;
+	jobs.ImageHeight = ImageHeight;
+
+	if (Pool)
+		err = Pool->Run(VectorizeJob, (void *)&jobs, j);
+	else
+	if (j > 1) {
+		GThreadPool tmpPool;
+		err = tmpPool.Run(VectorizeJob, (void *)&jobs, j);
+	}
+	else {
+		VectorizeJob((void *)&jobs, 0);
+		err = G_NO_ERROR;
+	}
+	return err;
+}
+
+GError GTracer2D::Trace(const GPixelMap& Image, GDynArray<GTracedContour>& Paths,
+						const GUChar8 WhiteColor, const GTurnPolicy TurnPolicy,
+						const GInt32 MaxRadius, const GInt32 MinArea, const GReal Alpha,
+						GThreadPool *Pool) {
+
+	// we only wanna single channel images
+	if (!Image.IsPaletted() && !Image.IsGrayScale())
+		return G_INVALID_FORMAT;
+	
+	GUInt32 i, j;
+	GError err;
+	GReal globalScale;
+	GDynArray<PixelPath> pixelPaths;
+	GDynArray<GInt32> signs;
+	GDynArray<PrivateCurve> curves;
+	GDynArray<GError> errors;
+
+	// calculate a scale that make vectorized paths normalized
+	globalScale = (GReal)(GMath::Max(GMath::Abs(Image.Width()), GMath::Abs(Image.Height())));
+	globalScale = (GReal)1 / globalScale;
+
+	// phase 1: extract all pixel paths
+	err = ExtractPaths(Image, WhiteColor, TurnPolicy, MaxRadius, MinArea, pixelPaths, signs);
+	if (err != G_NO_ERROR)
+		return err;
+
+	// phase 2: vectorize paths
+	err = VectorizePaths(pixelPaths, signs, Alpha, globalScale, (GReal)Image.Height(), Pool, curves, errors);
+	if (err != G_NO_ERROR)
+		return err;
+
+	// append contours in extraction order
+	j = (GUInt32)pixelPaths.size();
+	for (i = 0; i < j; i++) {
+		if (errors[i] == G_NO_ERROR) {
+			GTracedContour c(curves[i].Tags, curves[i].CurvePoints);
+			Paths.push_back(c);
+		}
+	}
+	return G_NO_ERROR;
+}
+
+// *********************************************************************
+//                           GTracerSession
+// *********************************************************************
+
+static inline GBool BoxesOverlap(const GGenericAABox<GInt32, 2>& Box1, const GGenericAABox<GInt32, 2>& Box2) {
+
+	return (Box1.Min()[G_X] <= Box2.Max()[G_X] && Box2.Min()[G_X] <= Box1.Max()[G_X] &&
+			Box1.Min()[G_Y] <= Box2.Max()[G_Y] && Box2.Min()[G_Y] <= Box1.Max()[G_Y]);
+}
+
+static inline GBool BoxInside(const GGenericAABox<GInt32, 2>& Inner, const GGenericAABox<GInt32, 2>& Outer) {
+
+	return (Inner.Min()[G_X] >= Outer.Min()[G_X] && Inner.Max()[G_X] <= Outer.Max()[G_X] &&
+			Inner.Min()[G_Y] >= Outer.Min()[G_Y] && Inner.Max()[G_Y] <= Outer.Max()[G_Y]);
+}
+
+static inline void BoxUnion(GGenericAABox<GInt32, 2>& Box, const GGenericAABox<GInt32, 2>& Other) {
+
+	Box.ExtendToInclude(GPoint<GInt32, 2>(Other.Min()[G_X], Other.Min()[G_Y]));
+	Box.ExtendToInclude(GPoint<GInt32, 2>(Other.Max()[G_X], Other.Max()[G_Y]));
+}
+
+// raster scan order: rows are scanned from the last to the first one, each row from left to right
+static inline GBool ScanOrderLess(const GPoint<GInt32, 2>& P1, const GPoint<GInt32, 2>& P2) {
+
+	return ((P1[G_Y] > P2[G_Y]) || (P1[G_Y] == P2[G_Y] && P1[G_X] < P2[G_X]));
+}
+
+GTracerSession::GTracerSession() : gWidth(0), gHeight(0), gWhiteColor(255), gTurnPolicy(G_CONNECT_NOT_DOMINANT),
+								   gMaxRadius(6), gMinArea(10), gAlpha((GReal)0.55), gPool(NULL) {
+}
+
+GTracerSession::~GTracerSession() {
+}
+
+void GTracerSession::Clear() {
+
+	gContours.clear();
+	gBoxes.clear();
+	gStartPoints.clear();
+	gWidth = 0;
+	gHeight = 0;
+}
+
+GError GTracerSession::TraceRegion(const GPixelMap& Image, const GGenericAABox<GInt32, 2>& Region,
+								   GBool& Grown, GGenericAABox<GInt32, 2>& GrowBox,
+								   GDynArray<GTracedContour>& Contours,
+								   GDynArray< GGenericAABox<GInt32, 2> >& Boxes,
+								   GDynArray< GPoint<GInt32, 2> >& StartPoints) {
+
+	GInt32 x0, y0, x1, y1, w, h, y, margin;
+	GUInt32 i, j, k, n;
+	GPixelMap subImage;
+	GDynArray<GTracer2D::PixelPath> paths, keptPaths;
+	GDynArray<GInt32> signs, keptSigns;
+	GDynArray< GGenericAABox<GInt32, 2> > keptBoxes;
+	GDynArray<GTracer2D::PrivateCurve> curves;
+	GDynArray<GError> errors;
+	GGenericAABox<GInt32, 2> box;
+	GPoint<GInt32, 2> pMin, pMax, ofs;
+	GReal globalScale;
+	GError err;
+
+	Grown = G_FALSE;
+
+	// region is extended by a margin, so dominance masks can see the same pixels of a full trace
+	margin = GMath::Max(gMaxRadius, (GInt32)0) + 1;
+	x0 = GMath::Max(Region.Min()[G_X] - margin, (GInt32)0);
+	y0 = GMath::Max(Region.Min()[G_Y] - margin, (GInt32)0);
+	x1 = GMath::Min(Region.Max()[G_X] + margin, gWidth - 1);
+	y1 = GMath::Min(Region.Max()[G_Y] + margin, gHeight - 1);
+	w = x1 - x0 + 1;
+	h = y1 - y0 + 1;
+
+	// extract the sub image
+	err = subImage.Create(w, h, Image.PixelFormat());
+	if (err != G_NO_ERROR)
+		return err;
+	for (y = 0; y < h; y++)
+		std::memcpy(subImage.Pixels() + y * w, Image.Pixels() + (y + y0) * gWidth + x0, w);
+
+	// extract all paths, area filtering must be done on complete paths only
+	err = GTracer2D::ExtractPaths(subImage, gWhiteColor, gTurnPolicy, gMaxRadius, 0, paths, signs);
+	if (err != G_NO_ERROR)
+		return err;
+
+	ofs.Set(x0, y0);
+	j = (GUInt32)paths.size();
+	for (i = 0; i < j; i++) {
+
+		GTracer2D::PixelPath& path = paths[i];
+
+		n = (GUInt32)path.Points.size();
+		pMin = pMax = path.Points[0];
+		for (k = 1; k < n; k++) {
+			pMin[G_X] = GMath::Min(pMin[G_X], path.Points[k][G_X]);
+			pMin[G_Y] = GMath::Min(pMin[G_Y], path.Points[k][G_Y]);
+			pMax[G_X] = GMath::Max(pMax[G_X], path.Points[k][G_X]);
+			pMax[G_Y] = GMath::Max(pMax[G_Y], path.Points[k][G_Y]);
+		}
+		// path points are pixel corners of the 1-pixel bordered sub image, so pixels covered by the path
+		// go from (pMin - 1) to (pMax - 2)
+		box.SetMinMax(GPoint<GInt32, 2>(pMin[G_X] - 1 + x0, pMin[G_Y] - 1 + y0),
+					  GPoint<GInt32, 2>(pMax[G_X] - 2 + x0, pMax[G_Y] - 2 + y0));
+
+		// contours belonging to the margin only are not interesting
+		if (!BoxesOverlap(box, Region))
+			continue;
+		// a contour crosses the region border, the region must be grown
+		if (!BoxInside(box, Region)) {
+			if (!Grown) {
+				GrowBox = box;
+				Grown = G_TRUE;
+			}
+			else
+				BoxUnion(GrowBox, box);
+			continue;
+		}
+		if (Grown || path.Area < gMinArea)
+			continue;
+
+		// move path into whole image coordinates
+		for (k = 0; k < n; k++)
+			path.Points[k] += ofs;
+		path.Start += ofs;
+		keptPaths.push_back(path);
+		keptSigns.push_back(signs[i]);
+		keptBoxes.push_back(box);
+	}
+	if (Grown)
+		return G_NO_ERROR;
+
+	// vectorize paths, using the same scale of a full image trace
+	globalScale = (GReal)1 / (GReal)GMath::Max(gWidth, gHeight);
+	err = GTracer2D::VectorizePaths(keptPaths, keptSigns, gAlpha, globalScale, (GReal)gHeight, gPool,
+									curves, errors);
+	if (err != G_NO_ERROR)
+		return err;
+
+	j = (GUInt32)keptPaths.size();
+	for (i = 0; i < j; i++) {
+		if (errors[i] == G_NO_ERROR) {
+			GTracedContour c(curves[i].Tags, curves[i].CurvePoints);
+			Contours.push_back(c);
+			Boxes.push_back(keptBoxes[i]);
+			// ShiftPath has rotated points, but the start point is still there to be used as sort key
+			StartPoints.push_back(keptPaths[i].Start);
+		}
+	}
+	return G_NO_ERROR;
+}
+
+GError GTracerSession::Trace(const GPixelMap& Image, const GUChar8 WhiteColor, const GTurnPolicy TurnPolicy,
+							 const GInt32 MaxRadius, const GInt32 MinArea, const GReal Alpha, GThreadPool *Pool) {
+
+	// we only wanna single channel images
+	if (!Image.IsPaletted() && !Image.IsGrayScale())
+		return G_INVALID_FORMAT;
+
+	GBool grown;
+	GGenericAABox<GInt32, 2> region, growBox;
+	GError err;
+
+	Clear();
+	gWidth = Image.Width();
+	gHeight = Image.Height();
+	gWhiteColor = WhiteColor;
+	gTurnPolicy = TurnPolicy;
+	gMaxRadius = MaxRadius;
+	gMinArea = MinArea;
+	gAlpha = Alpha;
+	gPool = Pool;
+
+	if (gWidth <= 0 || gHeight <= 0)
+		return G_NO_ERROR;
+
+	// the whole image region can't grow
+	region.SetMinMax(GPoint<GInt32, 2>(0, 0), GPoint<GInt32, 2>(gWidth - 1, gHeight - 1));
+	err = TraceRegion(Image, region, grown, growBox, gContours, gBoxes, gStartPoints);
+	if (err != G_NO_ERROR)
+		Clear();
+	return err;
+}
+
+GError GTracerSession::Update(const GPixelMap& Image, const GGenericAABox<GInt32, 2>& DirtyRect) {
+
+	// we only wanna single channel images
+	if (!Image.IsPaletted() && !Image.IsGrayScale())
+		return G_INVALID_FORMAT;
+
+	// image dimensions are changed, trace it again
+	if (Image.Width() != gWidth || Image.Height() != gHeight)
+		return Trace(Image, gWhiteColor, gTurnPolicy, gMaxRadius, gMinArea, gAlpha, gPool);
+
+	GUInt32 i, j, k, n;
+	GBool changed, grown;
+	GGenericAABox<GInt32, 2> region, growBox;
+	GDynArray<GBool> retraced;
+	GDynArray<GTracedContour> newContours, mergedContours;
+	GDynArray< GGenericAABox<GInt32, 2> > newBoxes, mergedBoxes;
+	GDynArray< GPoint<GInt32, 2> > newStartPoints, mergedStartPoints;
+	GError err;
+
+	// dirty rectangle is completely outside the image
+	if (DirtyRect.Max()[G_X] < 0 || DirtyRect.Max()[G_Y] < 0 ||
+		DirtyRect.Min()[G_X] >= gWidth || DirtyRect.Min()[G_Y] >= gHeight)
+		return G_NO_ERROR;
+	// dirty pixels can join shapes touching the dirty rectangle, so enlarge it by one pixel
+	region.SetMinMax(GPoint<GInt32, 2>(GMath::Max(DirtyRect.Min()[G_X] - 1, (GInt32)0),
+									   GMath::Max(DirtyRect.Min()[G_Y] - 1, (GInt32)0)),
+					 GPoint<GInt32, 2>(GMath::Min(DirtyRect.Max()[G_X] + 1, gWidth - 1),
+									   GMath::Min(DirtyRect.Max()[G_Y] + 1, gHeight - 1)));
+
+	j = (GUInt32)gContours.size();
+	retraced.resize(j, G_FALSE);
+	do {
+		// grow region until it contains every intersecting contour
+		do {
+			changed = G_FALSE;
+			for (i = 0; i < j; i++) {
+				if (!retraced[i] && BoxesOverlap(gBoxes[i], region)) {
+					retraced[i] = G_TRUE;
+					BoxUnion(region, gBoxes[i]);
+					changed = G_TRUE;
+				}
 			}
+		} while (changed);
+
+		newContours.clear();
+		newBoxes.clear();
+		newStartPoints.clear();
+		err = TraceRegion(Image, region, grown, growBox, newContours, newBoxes, newStartPoints);
+		if (err != G_NO_ERROR)
+			return err;
+		// some new (or previously discarded) contour goes out of the region
+		if (grown)
+			BoxUnion(region, growBox);
+	} while (grown);
+
+	// splice new contours into untouched ones, keeping the raster scan order
+	n = (GUInt32)newContours.size();
+	i = k = 0;
+	while (i < j || k < n) {
+		if (i < j && retraced[i]) {
+			i++;
+			continue;
+		}
+		if (k >= n || (i < j && ScanOrderLess(gStartPoints[i], newStartPoints[k]))) {
+			mergedContours.push_back(gContours[i]);
+			mergedBoxes.push_back(gBoxes[i]);
+			mergedStartPoints.push_back(gStartPoints[i]);
+			i++;
+		}
+		else {
+			mergedContours.push_back(newContours[k]);
+			mergedBoxes.push_back(newBoxes[k]);
+			mergedStartPoints.push_back(newStartPoints[k]);
+			k++;
 		}
 	}
+	gContours.swap(mergedContours);
+	gBoxes.swap(mergedBoxes);
+	gStartPoints.swap(mergedStartPoints);
 	return G_NO_ERROR;
 }
 
@@ -0,0 +1,487 @@
+/****************************************************************************
+** $file: amanith/src/geometry/gbatchquery.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** Batched intersection queries over arrays of primitives.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/geometry/gbatchquery.h"
+
+// SSE2 is always available on x86-64, and on x86 when the compiler has been told so
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define G_BATCHQUERY_SSE2
+	#include <emmintrin.h>
+#endif
+
+/*!
+	\file gbatchquery.cpp
+	\brief Batched intersection queries implementation file.
+*/
+
+namespace Amanith {
+
+// *********************************************************************
+//                     Scalar tests (single primitive)
+// *********************************************************************
+
+// every scalar test calls the template of gintersect.h, so results are the reference ones
+static GBool RayBox(const GRay2& Ray, const GAABox2Array& Boxes, const GUInt32 Index,
+					GBool *Hits, GReal *Parameters) {
+
+	GUInt32 flags;
+	GReal params[2];
+	GBoxSide side;
+
+	GBool hit = Intersect(Ray, Boxes.Box(Index), flags, params, side);
+	Hits[Index] = hit;
+	if (hit && Parameters)
+		Parameters[Index] = params[0];
+	return hit;
+}
+
+static GBool RaySphere(const GRay2& Ray, const GSphere2Array& Spheres, const GUInt32 Index,
+					   GBool *Hits, GReal *Parameters) {
+
+	GUInt32 flags;
+	GReal params[2];
+
+	GBool hit = Intersect(Ray, Spheres.Sphere(Index), flags, params);
+	Hits[Index] = hit;
+	if (hit && Parameters)
+		Parameters[Index] = params[0];
+	return hit;
+}
+
+static GBool RaySegment(const GRay2& Ray, const GLineSegment2Array& Segments, const GUInt32 Index,
+						GBool *Hits, GReal *Parameters) {
+
+	GUInt32 flags;
+	GReal params[2];
+
+	GBool hit = Intersect(Ray, Segments.Segment(Index), flags, params);
+	Hits[Index] = hit;
+	if (hit && Parameters)
+		Parameters[Index] = params[0];
+	return hit;
+}
+
+static GBool BoxView(const GAABox2& View, const GAABox2Array& Boxes, const GUInt32 Index, GBool *Visible) {
+
+	GUInt32 flags;
+
+	GBool hit = Intersect(Boxes.Box(Index), View, flags);
+	Visible[Index] = hit;
+	return hit;
+}
+
+// *********************************************************************
+//                             SSE2 kernels
+// *********************************************************************
+#ifdef G_BATCHQUERY_SSE2
+
+// kernels are written once in terms of a "pack" of GReal values; every operation maps to a single SSE2
+// instruction, in the same order of the scalar templates, so packed results are identical to scalar ones
+#ifdef DOUBLE_REAL_TYPE
+
+	#define G_PACK_SIZE 2
+	typedef __m128d GRealPack;
+
+	static inline GRealPack PackSet(const GReal Value) { return _mm_set1_pd(Value); }
+	static inline GRealPack PackLoad(const GReal *Src) { return _mm_loadu_pd(Src); }
+	static inline void PackStore(GReal *Dst, const GRealPack& a) { _mm_storeu_pd(Dst, a); }
+	static inline GRealPack PackAdd(const GRealPack& a, const GRealPack& b) { return _mm_add_pd(a, b); }
+	static inline GRealPack PackSub(const GRealPack& a, const GRealPack& b) { return _mm_sub_pd(a, b); }
+	static inline GRealPack PackMul(const GRealPack& a, const GRealPack& b) { return _mm_mul_pd(a, b); }
+	static inline GRealPack PackDiv(const GRealPack& a, const GRealPack& b) { return _mm_div_pd(a, b); }
+	static inline GRealPack PackSqrt(const GRealPack& a) { return _mm_sqrt_pd(a); }
+	// (a < b) ? a : b, as MINPD does
+	static inline GRealPack PackMin(const GRealPack& a, const GRealPack& b) { return _mm_min_pd(a, b); }
+	// (a > b) ? a : b, as MAXPD does
+	static inline GRealPack PackMax(const GRealPack& a, const GRealPack& b) { return _mm_max_pd(a, b); }
+	static inline GRealPack PackAbs(const GRealPack& a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+	static inline GRealPack PackNeg(const GRealPack& a) { return _mm_xor_pd(_mm_set1_pd(-0.0), a); }
+	static inline GRealPack PackGreater(const GRealPack& a, const GRealPack& b) { return _mm_cmpgt_pd(a, b); }
+	static inline GRealPack PackLess(const GRealPack& a, const GRealPack& b) { return _mm_cmplt_pd(a, b); }
+	static inline GRealPack PackLessEqual(const GRealPack& a, const GRealPack& b) { return _mm_cmple_pd(a, b); }
+	static inline GRealPack PackGreaterEqual(const GRealPack& a, const GRealPack& b) { return _mm_cmpge_pd(a, b); }
+	static inline GRealPack PackAnd(const GRealPack& a, const GRealPack& b) { return _mm_and_pd(a, b); }
+	static inline GRealPack PackOr(const GRealPack& a, const GRealPack& b) { return _mm_or_pd(a, b); }
+	// (NOT a) AND b
+	static inline GRealPack PackAndNot(const GRealPack& a, const GRealPack& b) { return _mm_andnot_pd(a, b); }
+	static inline GRealPack PackSelect(const GRealPack& Mask, const GRealPack& a, const GRealPack& b) {
+		return _mm_or_pd(_mm_and_pd(Mask, a), _mm_andnot_pd(Mask, b));
+	}
+	static inline GUInt32 PackMask(const GRealPack& a) { return (GUInt32)_mm_movemask_pd(a); }
+
+#else
+
+	#define G_PACK_SIZE 4
+	typedef __m128 GRealPack;
+
+	static inline GRealPack PackSet(const GReal Value) { return _mm_set1_ps(Value); }
+	static inline GRealPack PackLoad(const GReal *Src) { return _mm_loadu_ps(Src); }
+	static inline void PackStore(GReal *Dst, const GRealPack& a) { _mm_storeu_ps(Dst, a); }
+	static inline GRealPack PackAdd(const GRealPack& a, const GRealPack& b) { return _mm_add_ps(a, b); }
+	static inline GRealPack PackSub(const GRealPack& a, const GRealPack& b) { return _mm_sub_ps(a, b); }
+	static inline GRealPack PackMul(const GRealPack& a, const GRealPack& b) { return _mm_mul_ps(a, b); }
+	static inline GRealPack PackDiv(const GRealPack& a, const GRealPack& b) { return _mm_div_ps(a, b); }
+	static inline GRealPack PackSqrt(const GRealPack& a) { return _mm_sqrt_ps(a); }
+	static inline GRealPack PackMin(const GRealPack& a, const GRealPack& b) { return _mm_min_ps(a, b); }
+	static inline GRealPack PackMax(const GRealPack& a, const GRealPack& b) { return _mm_max_ps(a, b); }
+	static inline GRealPack PackAbs(const GRealPack& a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	static inline GRealPack PackNeg(const GRealPack& a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+	static inline GRealPack PackGreater(const GRealPack& a, const GRealPack& b) { return _mm_cmpgt_ps(a, b); }
+	static inline GRealPack PackLess(const GRealPack& a, const GRealPack& b) { return _mm_cmplt_ps(a, b); }
+	static inline GRealPack PackLessEqual(const GRealPack& a, const GRealPack& b) { return _mm_cmple_ps(a, b); }
+	static inline GRealPack PackGreaterEqual(const GRealPack& a, const GRealPack& b) { return _mm_cmpge_ps(a, b); }
+	static inline GRealPack PackAnd(const GRealPack& a, const GRealPack& b) { return _mm_and_ps(a, b); }
+	static inline GRealPack PackOr(const GRealPack& a, const GRealPack& b) { return _mm_or_ps(a, b); }
+	static inline GRealPack PackAndNot(const GRealPack& a, const GRealPack& b) { return _mm_andnot_ps(a, b); }
+	static inline GRealPack PackSelect(const GRealPack& Mask, const GRealPack& a, const GRealPack& b) {
+		return _mm_or_ps(_mm_and_ps(Mask, a), _mm_andnot_ps(Mask, b));
+	}
+	static inline GUInt32 PackMask(const GRealPack& a) { return (GUInt32)_mm_movemask_ps(a); }
+
+#endif
+
+#define G_PACK_FULLMASK ((1 << G_PACK_SIZE) - 1)
+
+// write hit flags (one bit for each lane) and return the number of hits
+static inline GUInt32 StoreHits(const GUInt32 HitMask, GBool *Hits) {
+
+	GUInt32 j, n = 0;
+
+	for (j = 0; j < G_PACK_SIZE; ++j) {
+		Hits[j] = ((HitMask >> j) & 1) ? G_TRUE : G_FALSE;
+		n += (HitMask >> j) & 1;
+	}
+	return n;
+}
+
+// ray - axis aligned boxes, the ray must not be parallel to any axis; it returns the number of processed boxes
+static GUInt32 RayBoxesSSE2(const GRay2& Ray, const GAABox2Array& Boxes, GBool *Hits, GReal *Parameters,
+							GUInt32& HitsCount) {
+
+	const GReal *minX = Boxes.MinX(), *minY = Boxes.MinY(), *maxX = Boxes.MaxX(), *maxY = Boxes.MaxY();
+	GUInt32 count = Boxes.Count() - (Boxes.Count() % G_PACK_SIZE);
+	GRealPack half = PackSet((GReal)0.5);
+	GRealPack kx = PackSet(1 / Ray.Direction()[G_X]);
+	GRealPack ky = PackSet(1 / Ray.Direction()[G_Y]);
+	GRealPack ox = PackSet(Ray.Origin()[G_X]);
+	GRealPack oy = PackSet(Ray.Origin()[G_Y]);
+	GRealPack minReal = PackSet(G_MIN_REAL);
+	GRealPack maxReal = PackSet(G_MAX_REAL);
+	GRealPack negEps = PackSet(-G_EPSILON);
+	GRealPack h, b, t1, t2, tNear, tFar, reject;
+	GUInt32 i;
+
+	for (i = 0; i < count; i += G_PACK_SIZE) {
+		// X slab; center = (min + max) / 2, half dimension = (max - min) / 2
+		h = PackMul(PackSub(PackLoad(maxX + i), PackLoad(minX + i)), half);
+		b = PackSub(ox, PackMul(PackAdd(PackLoad(minX + i), PackLoad(maxX + i)), half));
+		t1 = PackMul(PackSub(PackNeg(h), b), kx);
+		t2 = PackMul(PackSub(h, b), kx);
+		// sort solutions (t1 > t2 swaps them), then update near and far parameters
+		tNear = PackMax(PackMin(t2, t1), minReal);
+		tFar = PackMin(PackMax(t1, t2), maxReal);
+		reject = PackOr(PackGreater(tNear, tFar), PackLess(tFar, negEps));
+		// Y slab
+		h = PackMul(PackSub(PackLoad(maxY + i), PackLoad(minY + i)), half);
+		b = PackSub(oy, PackMul(PackAdd(PackLoad(minY + i), PackLoad(maxY + i)), half));
+		t1 = PackMul(PackSub(PackNeg(h), b), ky);
+		t2 = PackMul(PackSub(h, b), ky);
+		tNear = PackMax(PackMin(t2, t1), tNear);
+		tFar = PackMin(PackMax(t1, t2), tFar);
+		reject = PackOr(reject, PackOr(PackGreater(tNear, tFar), PackLess(tFar, negEps)));
+
+		HitsCount += StoreHits(~PackMask(reject) & G_PACK_FULLMASK, Hits + i);
+		// if the ray origin is inside the box, the first valid intersection is the far one
+		if (Parameters)
+			PackStore(Parameters + i, PackSelect(PackLess(tNear, negEps), tFar, tNear));
+	}
+	return count;
+}
+
+// ray - spheres, the ray direction must not be zero; it returns the number of processed spheres
+static GUInt32 RaySpheresSSE2(const GRay2& Ray, const GSphere2Array& Spheres, GBool *Hits, GReal *Parameters,
+							  GUInt32& HitsCount) {
+
+	const GReal *centerX = Spheres.CenterX(), *centerY = Spheres.CenterY(), *radius = Spheres.Radius();
+	GUInt32 count = Spheres.Count() - (Spheres.Count() % G_PACK_SIZE);
+	// a = |direction|^2, the same for all spheres
+	GReal a = Ray.Direction().LengthSquared();
+	GRealPack dx = PackSet(Ray.Direction()[G_X]);
+	GRealPack dy = PackSet(Ray.Direction()[G_Y]);
+	GRealPack ox = PackSet(Ray.Origin()[G_X]);
+	GRealPack oy = PackSet(Ray.Origin()[G_Y]);
+	GRealPack aPack = PackSet(a);
+	GRealPack twoA = PackSet(2 * a);
+	GRealPack fourA = PackSet((GReal)4 * a);
+	GRealPack two = PackSet(2);
+	GRealPack one = PackSet(1);
+	GRealPack minusOne = PackSet(-1);
+	GRealPack zero = PackSet(0);
+	GRealPack eps = PackSet(G_EPSILON);
+	GRealPack negEps = PackSet(-G_EPSILON);
+	GRealPack diffX, diffY, r, b, c, det, absB, twoRoots, degenerate, stableA, stableB, stableC, r1, r2;
+	GRealPack lo, hi, loValid, hiValid;
+	GUInt32 i, j, degenerateMask;
+
+	for (i = 0; i < count; i += G_PACK_SIZE) {
+		diffX = PackSub(ox, PackLoad(centerX + i));
+		diffY = PackSub(oy, PackLoad(centerY + i));
+		r = PackLoad(radius + i);
+		b = PackMul(two, PackAdd(PackMul(diffY, dy), PackMul(diffX, dx)));
+		c = PackSub(PackAdd(PackMul(diffY, diffY), PackMul(diffX, diffX)), PackMul(r, r));
+		// quadratic formula, see GMath::QuadraticFormula
+		det = PackSub(PackMul(b, b), PackMul(fourA, c));
+		absB = PackAbs(b);
+		twoRoots = PackAnd(PackGreater(PackAbs(det), eps), PackGreater(det, zero));
+		// a single root, or two opposite roots: leave them to the scalar test
+		degenerate = PackOr(PackLessEqual(PackAbs(det), eps), PackAnd(twoRoots, PackLessEqual(absB, eps)));
+		// numerically stable roots
+		stableA = PackDiv(b, twoA);
+		stableB = PackDiv(c, PackMul(PackMul(aPack, stableA), stableA));
+		stableC = PackSub(minusOne, PackSqrt(PackSub(one, stableB)));
+		r2 = PackMul(stableA, stableC);
+		r1 = PackDiv(PackMul(stableA, stableB), stableC);
+		// sort roots, then take the first one in front of the ray origin
+		lo = PackMin(r2, r1);
+		hi = PackMax(r1, r2);
+		loValid = PackGreaterEqual(lo, negEps);
+		hiValid = PackGreaterEqual(hi, negEps);
+
+		HitsCount += StoreHits(PackMask(PackAnd(twoRoots, PackOr(loValid, hiValid))), Hits + i);
+		if (Parameters)
+			PackStore(Parameters + i, PackSelect(loValid, lo, hi));
+
+		degenerateMask = PackMask(degenerate);
+		if (degenerateMask) {
+			for (j = 0; j < G_PACK_SIZE; ++j) {
+				if ((degenerateMask >> j) & 1) {
+					HitsCount -= (Hits[i + j]) ? 1 : 0;
+					HitsCount += (RaySphere(Ray, Spheres, i + j, Hits, Parameters)) ? 1 : 0;
+				}
+			}
+		}
+	}
+	return count;
+}
+
+// ray - segments; it returns the number of processed segments
+static GUInt32 RaySegmentsSSE2(const GRay2& Ray, const GLineSegment2Array& Segments, GBool *Hits, GReal *Parameters,
+							   GUInt32& HitsCount) {
+
+	const GReal *originX = Segments.OriginX(), *originY = Segments.OriginY();
+	const GReal *dirX = Segments.DirectionX(), *dirY = Segments.DirectionY();
+	GUInt32 count = Segments.Count() - (Segments.Count() % G_PACK_SIZE);
+	GRealPack rdx = PackSet(Ray.Direction()[G_X]);
+	GRealPack rdy = PackSet(Ray.Direction()[G_Y]);
+	GRealPack ox = PackSet(Ray.Origin()[G_X]);
+	GRealPack oy = PackSet(Ray.Origin()[G_Y]);
+	GRealPack one = PackSet(1);
+	GRealPack eps = PackSet(G_EPSILON);
+	GRealPack negEps = PackSet(-G_EPSILON);
+	GRealPack onePlusEps = PackSet(1 + G_EPSILON);
+	GRealPack sdx, sdy, det, invDet, diffX, diffY, p0, p1, single, miss;
+	GUInt32 i, j, degenerateMask;
+
+	for (i = 0; i < count; i += G_PACK_SIZE) {
+		sdx = PackLoad(dirX + i);
+		sdy = PackLoad(dirY + i);
+		det = PackSub(PackMul(sdx, rdy), PackMul(sdy, rdx));
+		diffX = PackSub(PackLoad(originX + i), ox);
+		diffY = PackSub(PackLoad(originY + i), oy);
+		// parallel lanes (disjoint or collinear) are left to the scalar test
+		single = PackGreater(PackAbs(det), eps);
+		invDet = PackDiv(one, det);
+		p0 = PackMul(PackSub(PackMul(sdx, diffY), PackMul(sdy, diffX)), invDet);
+		p1 = PackMul(PackSub(PackMul(rdx, diffY), PackMul(rdy, diffX)), invDet);
+		// intersection must be "inside" the segment and in front of the ray origin
+		miss = PackOr(PackOr(PackGreater(p1, onePlusEps), PackLess(p0, negEps)), PackLess(p1, negEps));
+
+		HitsCount += StoreHits(PackMask(PackAndNot(miss, single)), Hits + i);
+		if (Parameters)
+			PackStore(Parameters + i, p0);
+
+		degenerateMask = ~PackMask(single) & G_PACK_FULLMASK;
+		if (degenerateMask) {
+			for (j = 0; j < G_PACK_SIZE; ++j) {
+				if ((degenerateMask >> j) & 1)
+					HitsCount += (RaySegment(Ray, Segments, i + j, Hits, Parameters)) ? 1 : 0;
+			}
+		}
+	}
+	return count;
+}
+
+// points - box, points are loaded as they are stored ((x, y) couples); it returns the number of processed points
+static GUInt32 PointsInBoxSSE2(const GAABox2& Box, const GReal *Points, const GUInt32 Count, GBool *Hits,
+							   const GReal Epsilon, GUInt32& HitsCount) {
+
+	// each pack contains G_PACK_SIZE / 2 points
+	const GUInt32 pointsPerPack = G_PACK_SIZE / 2;
+	GUInt32 count = Count - (Count % pointsPerPack);
+	GReal lo[4], hi[4];
+	GRealPack minPack, maxPack, p;
+	GUInt32 i, j, outsideMask;
+
+	for (j = 0; j < 4; j += 2) {
+		lo[j] = Box.Min()[G_X] - Epsilon;
+		lo[j + 1] = Box.Min()[G_Y] - Epsilon;
+		hi[j] = Box.Max()[G_X] + Epsilon;
+		hi[j + 1] = Box.Max()[G_Y] + Epsilon;
+	}
+	minPack = PackLoad(lo);
+	maxPack = PackLoad(hi);
+
+	for (i = 0; i < count; i += pointsPerPack) {
+		p = PackLoad(Points + 2 * i);
+		outsideMask = PackMask(PackOr(PackGreater(p, maxPack), PackLess(p, minPack)));
+		for (j = 0; j < pointsPerPack; ++j) {
+			Hits[i + j] = (((outsideMask >> (2 * j)) & 3) == 0) ? G_TRUE : G_FALSE;
+			HitsCount += (Hits[i + j]) ? 1 : 0;
+		}
+	}
+	return count;
+}
+
+// boxes - view box; it returns the number of processed boxes
+static GUInt32 CullSSE2(const GAABox2& View, const GAABox2Array& Boxes, GBool *Visible, GUInt32& HitsCount) {
+
+	const GReal *minX = Boxes.MinX(), *minY = Boxes.MinY(), *maxX = Boxes.MaxX(), *maxY = Boxes.MaxY();
+	GUInt32 count = Boxes.Count() - (Boxes.Count() % G_PACK_SIZE);
+	GPoint2 viewCenter = View.Center();
+	GRealPack half = PackSet((GReal)0.5);
+	GRealPack cx = PackSet(viewCenter[G_X]);
+	GRealPack cy = PackSet(viewCenter[G_Y]);
+	GRealPack hx = PackSet(View.HalfDimension(G_X));
+	GRealPack hy = PackSet(View.HalfDimension(G_Y));
+	GRealPack twoEps = PackSet(2 * G_EPSILON);
+	GRealPack d, h, separated;
+	GUInt32 i;
+
+	for (i = 0; i < count; i += G_PACK_SIZE) {
+		// separation distance along x: |delta center| - half dimension - view half dimension
+		d = PackSub(PackMul(PackAdd(PackLoad(minX + i), PackLoad(maxX + i)), half), cx);
+		h = PackMul(PackSub(PackLoad(maxX + i), PackLoad(minX + i)), half);
+		separated = PackGreater(PackSub(PackSub(PackAbs(d), h), hx), twoEps);
+		// separation distance along y
+		d = PackSub(PackMul(PackAdd(PackLoad(minY + i), PackLoad(maxY + i)), half), cy);
+		h = PackMul(PackSub(PackLoad(maxY + i), PackLoad(minY + i)), half);
+		separated = PackOr(separated, PackGreater(PackSub(PackSub(PackAbs(d), h), hy), twoEps));
+
+		HitsCount += StoreHits(~PackMask(separated) & G_PACK_FULLMASK, Visible + i);
+	}
+	return count;
+}
+
+#undef G_PACK_FULLMASK
+
+#endif
+
+// *********************************************************************
+//                              GBatchQuery
+// *********************************************************************
+
+GUInt32 GBatchQuery::Intersect(const GRay2& Ray, const GAABox2Array& Boxes, GBool *Hits, GReal *Parameters) {
+
+	G_ASSERT(Hits != NULL || Boxes.Count() == 0);
+
+	GUInt32 i = 0, hitsCount = 0, count = Boxes.Count();
+
+#ifdef G_BATCHQUERY_SSE2
+	// rays parallel to an axis go through the scalar test, that handles tangent slabs
+	if (GMath::Abs(Ray.Direction()[G_X]) > G_EPSILON && GMath::Abs(Ray.Direction()[G_Y]) > G_EPSILON)
+		i = RayBoxesSSE2(Ray, Boxes, Hits, Parameters, hitsCount);
+#endif
+	for (; i < count; ++i)
+		hitsCount += (RayBox(Ray, Boxes, i, Hits, Parameters)) ? 1 : 0;
+	return hitsCount;
+}
+
+GUInt32 GBatchQuery::Intersect(const GRay2& Ray, const GSphere2Array& Spheres, GBool *Hits, GReal *Parameters) {
+
+	G_ASSERT(Hits != NULL || Spheres.Count() == 0);
+
+	GUInt32 i = 0, hitsCount = 0, count = Spheres.Count();
+
+#ifdef G_BATCHQUERY_SSE2
+	// a degenerate (zero length) ray goes through the scalar test
+	if (GMath::Abs(Ray.Direction().LengthSquared()) > G_EPSILON)
+		i = RaySpheresSSE2(Ray, Spheres, Hits, Parameters, hitsCount);
+#endif
+	for (; i < count; ++i)
+		hitsCount += (RaySphere(Ray, Spheres, i, Hits, Parameters)) ? 1 : 0;
+	return hitsCount;
+}
+
+GUInt32 GBatchQuery::Intersect(const GRay2& Ray, const GLineSegment2Array& Segments, GBool *Hits,
+							   GReal *Parameters) {
+
+	G_ASSERT(Hits != NULL || Segments.Count() == 0);
+
+	GUInt32 i = 0, hitsCount = 0, count = Segments.Count();
+
+#ifdef G_BATCHQUERY_SSE2
+	i = RaySegmentsSSE2(Ray, Segments, Hits, Parameters, hitsCount);
+#endif
+	for (; i < count; ++i)
+		hitsCount += (RaySegment(Ray, Segments, i, Hits, Parameters)) ? 1 : 0;
+	return hitsCount;
+}
+
+GUInt32 GBatchQuery::PointsInBox(const GAABox2& Box, const GPoint2 *Points, const GUInt32 Count, GBool *Hits,
+								 const GReal Epsilon) {
+
+	G_ASSERT((Points != NULL && Hits != NULL) || Count == 0);
+
+	GUInt32 i = 0, hitsCount = 0;
+
+#ifdef G_BATCHQUERY_SSE2
+	if (Count > 0)
+		i = PointsInBoxSSE2(Box, (const GReal *)Points, Count, Hits, Epsilon, hitsCount);
+#endif
+	for (; i < Count; ++i) {
+		Hits[i] = (Box.PointSign(Points[i], Epsilon) != G_OUTSIDE);
+		hitsCount += (Hits[i]) ? 1 : 0;
+	}
+	return hitsCount;
+}
+
+GUInt32 GBatchQuery::Cull(const GAABox2& View, const GAABox2Array& Boxes, GBool *Visible) {
+
+	G_ASSERT(Visible != NULL || Boxes.Count() == 0);
+
+	GUInt32 i = 0, hitsCount = 0, count = Boxes.Count();
+
+#ifdef G_BATCHQUERY_SSE2
+	i = CullSSE2(View, Boxes, Visible, hitsCount);
+#endif
+	for (; i < count; ++i)
+		hitsCount += (BoxView(View, Boxes, i, Visible)) ? 1 : 0;
+	return hitsCount;
+}
+
+};	// end namespace Amanith
@@ -0,0 +1,305 @@
+/****************************************************************************
+** $file: amanith/src/geometry/gbulkxform.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** Bulk transformation of points arrays.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/geometry/gbulkxform.h"
+#include "amanith/gmath.h"
+
+// SSE2 is always available on x86-64, and on x86 when the compiler has been told so
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define G_BULKXFORM_SSE2
+	#include <emmintrin.h>
+#endif
+
+/*!
+	\file gbulkxform.cpp
+	\brief Bulk transformation of points arrays implementation file.
+*/
+
+namespace Amanith {
+
+// *********************************************************************
+//                            Scalar kernels
+// *********************************************************************
+
+// affine transformation; M = {m00, m01, m02, m10, m11, m12}, points are (x, y) couples
+template<typename DATA_TYPE>
+static void AffineScalar(const DATA_TYPE *M, const DATA_TYPE *Src, DATA_TYPE *Dst, const GUInt32 Count) {
+
+	DATA_TYPE m00 = M[0], m01 = M[1], m02 = M[2];
+	DATA_TYPE m10 = M[3], m11 = M[4], m12 = M[5];
+	DATA_TYPE x, y;
+	GUInt32 i;
+
+	for (i = 0; i < Count; ++i) {
+		x = Src[2 * i];
+		y = Src[2 * i + 1];
+		Dst[2 * i] = m00 * x + m01 * y + m02;
+		Dst[2 * i + 1] = m10 * x + m11 * y + m12;
+	}
+}
+
+// projective transformation; M = {m00, m01, m02, m10, m11, m12, m20, m21, m22}
+template<typename DATA_TYPE>
+static void ProjectiveScalar(const DATA_TYPE *M, const DATA_TYPE *Src, DATA_TYPE *Dst, const GUInt32 Count,
+							 const DATA_TYPE Epsilon) {
+
+	DATA_TYPE m00 = M[0], m01 = M[1], m02 = M[2];
+	DATA_TYPE m10 = M[3], m11 = M[4], m12 = M[5];
+	DATA_TYPE m20 = M[6], m21 = M[7], m22 = M[8];
+	DATA_TYPE x, y, w;
+	GUInt32 i;
+
+	for (i = 0; i < Count; ++i) {
+		x = Src[2 * i];
+		y = Src[2 * i + 1];
+		w = m20 * x + m21 * y + m22;
+		if (GMath::Abs(w) <= Epsilon)
+			w = 1;
+		Dst[2 * i] = (m00 * x + m01 * y + m02) / w;
+		Dst[2 * i + 1] = (m10 * x + m11 * y + m12) / w;
+	}
+}
+
+// *********************************************************************
+//                             SSE2 kernels
+// *********************************************************************
+#ifdef G_BULKXFORM_SSE2
+
+// one point for each register
+static void AffineSSE2(const GDouble *M, const GDouble *Src, GDouble *Dst, const GUInt32 Count) {
+
+	__m128d c0 = _mm_set_pd(M[3], M[0]);
+	__m128d c1 = _mm_set_pd(M[4], M[1]);
+	__m128d c2 = _mm_set_pd(M[5], M[2]);
+	__m128d p0, p1, x0, y0, x1, y1;
+	GUInt32 i = 0;
+
+	// two independent points per iteration, to hide latencies
+	for (; i + 2 <= Count; i += 2) {
+		p0 = _mm_loadu_pd(Src + 2 * i);
+		p1 = _mm_loadu_pd(Src + 2 * i + 2);
+		x0 = _mm_unpacklo_pd(p0, p0);
+		y0 = _mm_unpackhi_pd(p0, p0);
+		x1 = _mm_unpacklo_pd(p1, p1);
+		y1 = _mm_unpackhi_pd(p1, p1);
+		_mm_storeu_pd(Dst + 2 * i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(x0, c0), _mm_mul_pd(y0, c1)), c2));
+		_mm_storeu_pd(Dst + 2 * i + 2, _mm_add_pd(_mm_add_pd(_mm_mul_pd(x1, c0), _mm_mul_pd(y1, c1)), c2));
+	}
+	if (i < Count) {
+		p0 = _mm_loadu_pd(Src + 2 * i);
+		x0 = _mm_unpacklo_pd(p0, p0);
+		y0 = _mm_unpackhi_pd(p0, p0);
+		_mm_storeu_pd(Dst + 2 * i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(x0, c0), _mm_mul_pd(y0, c1)), c2));
+	}
+}
+
+static void ProjectiveSSE2(const GDouble *M, const GDouble *Src, GDouble *Dst, const GUInt32 Count,
+						   const GDouble Epsilon) {
+
+	__m128d c0 = _mm_set_pd(M[3], M[0]);
+	__m128d c1 = _mm_set_pd(M[4], M[1]);
+	__m128d c2 = _mm_set_pd(M[5], M[2]);
+	__m128d w0 = _mm_set1_pd(M[6]);
+	__m128d w1 = _mm_set1_pd(M[7]);
+	__m128d w2 = _mm_set1_pd(M[8]);
+	__m128d eps = _mm_set1_pd(Epsilon);
+	__m128d one = _mm_set1_pd(1);
+	__m128d signMask = _mm_set1_pd(-0.0);
+	__m128d p, x, y, w, degenerate;
+	GUInt32 i;
+
+	for (i = 0; i < Count; ++i) {
+		p = _mm_loadu_pd(Src + 2 * i);
+		x = _mm_unpacklo_pd(p, p);
+		y = _mm_unpackhi_pd(p, p);
+		w = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, w0), _mm_mul_pd(y, w1)), w2);
+		// points at infinity are not divided
+		degenerate = _mm_cmple_pd(_mm_andnot_pd(signMask, w), eps);
+		w = _mm_or_pd(_mm_and_pd(degenerate, one), _mm_andnot_pd(degenerate, w));
+		p = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, c0), _mm_mul_pd(y, c1)), c2);
+		_mm_storeu_pd(Dst + 2 * i, _mm_div_pd(p, w));
+	}
+}
+
+// two points for each register
+static void AffineSSE2(const GFloat *M, const GFloat *Src, GFloat *Dst, const GUInt32 Count) {
+
+	__m128 c0 = _mm_set_ps(M[3], M[0], M[3], M[0]);
+	__m128 c1 = _mm_set_ps(M[4], M[1], M[4], M[1]);
+	__m128 c2 = _mm_set_ps(M[5], M[2], M[5], M[2]);
+	__m128 p0, p1, x0, y0, x1, y1;
+	GUInt32 i = 0;
+
+	for (; i + 4 <= Count; i += 4) {
+		p0 = _mm_loadu_ps(Src + 2 * i);
+		p1 = _mm_loadu_ps(Src + 2 * i + 4);
+		x0 = _mm_shuffle_ps(p0, p0, _MM_SHUFFLE(2, 2, 0, 0));
+		y0 = _mm_shuffle_ps(p0, p0, _MM_SHUFFLE(3, 3, 1, 1));
+		x1 = _mm_shuffle_ps(p1, p1, _MM_SHUFFLE(2, 2, 0, 0));
+		y1 = _mm_shuffle_ps(p1, p1, _MM_SHUFFLE(3, 3, 1, 1));
+		_mm_storeu_ps(Dst + 2 * i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, c0), _mm_mul_ps(y0, c1)), c2));
+		_mm_storeu_ps(Dst + 2 * i + 4, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, c0), _mm_mul_ps(y1, c1)), c2));
+	}
+	if (i < Count)
+		AffineScalar(M, Src + 2 * i, Dst + 2 * i, Count - i);
+}
+
+static void ProjectiveSSE2(const GFloat *M, const GFloat *Src, GFloat *Dst, const GUInt32 Count,
+						   const GFloat Epsilon) {
+
+	__m128 c0 = _mm_set_ps(M[3], M[0], M[3], M[0]);
+	__m128 c1 = _mm_set_ps(M[4], M[1], M[4], M[1]);
+	__m128 c2 = _mm_set_ps(M[5], M[2], M[5], M[2]);
+	__m128 w0 = _mm_set1_ps(M[6]);
+	__m128 w1 = _mm_set1_ps(M[7]);
+	__m128 w2 = _mm_set1_ps(M[8]);
+	__m128 eps = _mm_set1_ps(Epsilon);
+	__m128 one = _mm_set1_ps(1);
+	__m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 p, x, y, w, degenerate;
+	GUInt32 i = 0;
+
+	for (; i + 2 <= Count; i += 2) {
+		p = _mm_loadu_ps(Src + 2 * i);
+		x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+		y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+		w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, w0), _mm_mul_ps(y, w1)), w2);
+		// points at infinity are not divided
+		degenerate = _mm_cmple_ps(_mm_andnot_ps(signMask, w), eps);
+		w = _mm_or_ps(_mm_and_ps(degenerate, one), _mm_andnot_ps(degenerate, w));
+		p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c0), _mm_mul_ps(y, c1)), c2);
+		_mm_storeu_ps(Dst + 2 * i, _mm_div_ps(p, w));
+	}
+	if (i < Count)
+		ProjectiveScalar(M, Src + 2 * i, Dst + 2 * i, Count - i, Epsilon);
+}
+
+#endif
+
+// *********************************************************************
+//                              GBulkXForm
+// *********************************************************************
+
+// extract matrix entries, row by row
+template<typename DATA_TYPE, GUInt32 ROWS>
+static void MatrixEntries(const GMatrix<GReal, ROWS, 3>& Matrix, DATA_TYPE *M) {
+
+	for (GUInt32 i = 0; i < ROWS; ++i) {
+		M[3 * i] = (DATA_TYPE)Matrix[i][0];
+		M[3 * i + 1] = (DATA_TYPE)Matrix[i][1];
+		M[3 * i + 2] = (DATA_TYPE)Matrix[i][2];
+	}
+}
+
+template<typename DATA_TYPE>
+static void DoAffine(const DATA_TYPE *M, const GPoint<DATA_TYPE, 2> *Src, GPoint<DATA_TYPE, 2> *Dst,
+					 const GUInt32 Count) {
+
+	// points are read as a flat array of (x, y) couples
+	G_ASSERT(sizeof(GPoint<DATA_TYPE, 2>) == 2 * sizeof(DATA_TYPE));
+
+	if (Count == 0)
+		return;
+	G_ASSERT(Src != NULL && Dst != NULL);
+#ifdef G_BULKXFORM_SSE2
+	AffineSSE2(M, (const DATA_TYPE *)Src, (DATA_TYPE *)Dst, Count);
+#else
+	AffineScalar(M, (const DATA_TYPE *)Src, (DATA_TYPE *)Dst, Count);
+#endif
+}
+
+// threshold under which w is considered zero, the same used by GCurve2D::XForm for the given precision
+static inline GFloat InfinityThreshold(const GFloat) {
+	return 2 * 1.1920928955078125e-07f;
+}
+
+static inline GDouble InfinityThreshold(const GDouble) {
+	return 2 * 2.2204460492503131e-16;
+}
+
+template<typename DATA_TYPE>
+static void DoProjective(const DATA_TYPE *M, const GPoint<DATA_TYPE, 2> *Src, GPoint<DATA_TYPE, 2> *Dst,
+						 const GUInt32 Count) {
+
+	DATA_TYPE eps = InfinityThreshold(M[0]);
+
+	G_ASSERT(sizeof(GPoint<DATA_TYPE, 2>) == 2 * sizeof(DATA_TYPE));
+
+	if (Count == 0)
+		return;
+	G_ASSERT(Src != NULL && Dst != NULL);
+#ifdef G_BULKXFORM_SSE2
+	ProjectiveSSE2(M, (const DATA_TYPE *)Src, (DATA_TYPE *)Dst, Count, eps);
+#else
+	ProjectiveScalar(M, (const DATA_TYPE *)Src, (DATA_TYPE *)Dst, Count, eps);
+#endif
+}
+
+void GBulkXForm::XForm(const GMatrix23& Matrix, const GPoint<GFloat, 2> *Src, GPoint<GFloat, 2> *Dst,
+					   const GUInt32 Count) {
+
+	GFloat m[6];
+
+	MatrixEntries(Matrix, m);
+	DoAffine(m, Src, Dst, Count);
+}
+
+void GBulkXForm::XForm(const GMatrix23& Matrix, const GPoint<GDouble, 2> *Src, GPoint<GDouble, 2> *Dst,
+					   const GUInt32 Count) {
+
+	GDouble m[6];
+
+	MatrixEntries(Matrix, m);
+	DoAffine(m, Src, Dst, Count);
+}
+
+void GBulkXForm::XForm(const GMatrix33& Matrix, const GBool DoProjection, const GPoint<GFloat, 2> *Src,
+					   GPoint<GFloat, 2> *Dst, const GUInt32 Count) {
+
+	GFloat m[9];
+
+	MatrixEntries(Matrix, m);
+	if (DoProjection)
+		DoProjective(m, Src, Dst, Count);
+	else
+		DoAffine(m, Src, Dst, Count);
+}
+
+void GBulkXForm::XForm(const GMatrix33& Matrix, const GBool DoProjection, const GPoint<GDouble, 2> *Src,
+					   GPoint<GDouble, 2> *Dst, const GUInt32 Count) {
+
+	GDouble m[9];
+
+	MatrixEntries(Matrix, m);
+	if (DoProjection)
+		DoProjective(m, Src, Dst, Count);
+	else
+		DoAffine(m, Src, Dst, Count);
+}
+
+};	// end namespace Amanith
@@ -65,6 +65,10 @@
 	#include "../plugins/fonts/gfontsimpexp.h"
 #endif
 
+#if defined(_BINFONT_PLUGIN) && defined(_BINFONT_PLUGIN_INTERNAL)
+	#include "../plugins/binfont/gbinfontimpexp.h"
+#endif
+
 /*!
 	\file gkernel.cpp
 	\brief Implementation of GKernel class.
@@ -183,6 +187,10 @@ void GKernel::RegisterProxies() {
 	#if defined(_FONTS_PLUGIN) && defined(_FONTS_PLUGIN_INTERNAL)
 		RegisterElementProxy(G_FONTSIMPEXP_PROXY);
 	#endif
+	// binary fonts import/export plugin
+	#if defined(_BINFONT_PLUGIN) && defined(_BINFONT_PLUGIN_INTERNAL)
+		RegisterElementProxy(G_BINFONTIMPEXP_PROXY);
+	#endif
 
 	// 1D stuff
 	RegisterElementProxy(G_CURVE1D_PROXY);
@@ -375,6 +375,40 @@ GBool GOpenglExt::IsFBOSupported() const {
 	return G_FALSE;
 }
 
+/*!
+	\return G_TRUE if GL_ARB_pixel_buffer_object (or GL_EXT_pixel_buffer_object) extension is supported,
+	G_FALSE otherwise.
+*/
+GBool GOpenglExt::IsPBOSupported() const {
+
+	if (glewGetExtension("GL_ARB_pixel_buffer_object") || glewGetExtension("GL_EXT_pixel_buffer_object")) {
+		// buffer objects entry points are exported by GL_ARB_vertex_buffer_object
+		if (glewGetExtension("GL_ARB_vertex_buffer_object"))
+			return G_TRUE;
+	}
+	return G_FALSE;
+}
+
+/*!
+	\return G_TRUE if GL_ARB_vertex_buffer_object extension is supported, G_FALSE otherwise.
+*/
+GBool GOpenglExt::IsVBOSupported() const {
+
+	if (glewGetExtension("GL_ARB_vertex_buffer_object"))
+		return G_TRUE;
+	return G_FALSE;
+}
+
+/*!
+	\return G_TRUE if GL_NV_fence extension is supported, G_FALSE otherwise.
+*/
+GBool GOpenglExt::IsFenceSupported() const {
+
+	if (glewGetExtension("GL_NV_fence"))
+		return G_TRUE;
+	return G_FALSE;
+}
+
 GInt32 GOpenglExt::TextureUnitsCount() {
 
 	GLint num = 1;
@@ -469,6 +503,13 @@ GUInt32 GOpenglExt::MultiSamples() {
 	return (GUInt32)num;
 }
 
+GUInt32 GOpenglExt::SubPixelBits() {
+
+	GLint num = 0;
+	glGetIntegerv(GL_SUBPIXEL_BITS, &num);
+	return (GUInt32)num;
+}
+
 GUInt32 GOpenglExt::FBOMaxColorAttachments() {
 
 	GLint num = 0;
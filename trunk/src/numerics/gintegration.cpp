@@ -135,4 +135,162 @@ namespace Amanith {
 		Result = integral;
 		return G_FALSE;
 	}
+
+	// Gauss-Kronrod 7-15 abscissae (positive half, the last one is the interval center)
+	static const GReal GaussKronrodNodes[8] = {
+		(GReal)0.991455371120812639206854697526329, (GReal)0.949107912342758524526189684047851,
+		(GReal)0.864864423359769072789712788640926, (GReal)0.741531185599394439863864773280788,
+		(GReal)0.586087235467691130294144845693013, (GReal)0.405845151377397166906606412076961,
+		(GReal)0.207784955007898467600689403773245, (GReal)0.0
+	};
+	// 15 points Kronrod weights
+	static const GReal KronrodWeights[8] = {
+		(GReal)0.022935322010529224963732008058970, (GReal)0.063092092629978553290700663189204,
+		(GReal)0.104790010322250183839876322541518, (GReal)0.140653259715525918745189590510238,
+		(GReal)0.169004726639267902826583426598550, (GReal)0.190350578064785409913256402421014,
+		(GReal)0.204432940075298892414161999234649, (GReal)0.209482141084727828012999174891714
+	};
+	// 7 points Gauss weights, relative to odd Kronrod abscissae (1, 3, 5, 7)
+	static const GReal GaussWeights[4] = {
+		(GReal)0.129484966168869693270611432679082, (GReal)0.279705391489276667901467771423780,
+		(GReal)0.381830050505118944950369775488975, (GReal)0.417959183673469387755102040816327
+	};
+
+	// a sub-interval used by adaptive Gauss-Kronrod integration
+	struct GGaussKronrodInterval {
+		GReal A;
+		GReal B;
+		GReal Integral;
+		GReal Error;
+	};
+
+	// fill the 15 Gauss-Kronrod abscissae of the interval [A; B]
+	static void GaussKronrodParams(const GReal A, const GReal B, GReal *Params) {
+
+		GReal center = (GReal)0.5 * (A + B);
+		GReal halfLength = (GReal)0.5 * (B - A);
+		GUInt32 j;
+
+		for (j = 0; j < 7; ++j) {
+			Params[2 * j] = center - halfLength * GaussKronrodNodes[j];
+			Params[2 * j + 1] = center + halfLength * GaussKronrodNodes[j];
+		}
+		Params[14] = center;
+	}
+
+	// apply the 7-15 rule to the interval, starting from the 15 values of the integrand (same order of
+	// GaussKronrodParams); the error estimation follows QUADPACK (qk15)
+	static void GaussKronrodRule(GGaussKronrodInterval& Interval, const GReal *Values) {
+
+		GReal halfLength = (GReal)0.5 * (Interval.B - Interval.A);
+		GReal resK, resG, resAbs, resAsc, resKHalf, err;
+		GUInt32 j;
+
+		resK = KronrodWeights[7] * Values[14];
+		resG = GaussWeights[3] * Values[14];
+		resAbs = GMath::Abs(resK);
+		for (j = 0; j < 7; ++j) {
+			resK += KronrodWeights[j] * (Values[2 * j] + Values[2 * j + 1]);
+			resAbs += KronrodWeights[j] * (GMath::Abs(Values[2 * j]) + GMath::Abs(Values[2 * j + 1]));
+			if (j & 1)
+				resG += GaussWeights[j >> 1] * (Values[2 * j] + Values[2 * j + 1]);
+		}
+		resKHalf = (GReal)0.5 * resK;
+		resAsc = KronrodWeights[7] * GMath::Abs(Values[14] - resKHalf);
+		for (j = 0; j < 7; ++j)
+			resAsc += KronrodWeights[j] * (GMath::Abs(Values[2 * j] - resKHalf) + GMath::Abs(Values[2 * j + 1] - resKHalf));
+
+		halfLength = GMath::Abs(halfLength);
+		resAbs *= halfLength;
+		resAsc *= halfLength;
+		err = GMath::Abs((resK - resG) * halfLength);
+		// the difference between Kronrod and Gauss estimations is very pessimistic for smooth integrands
+		if (resAsc != 0 && err != 0)
+			err = resAsc * GMath::Min((GReal)1, GMath::Pow(200 * err / resAsc, (GReal)1.5));
+		// below this threshold the error is dominated by roundoff
+		err = GMath::Max(50 * G_EPSILON * resAbs, err);
+
+		Interval.Integral = resK * (Interval.B - Interval.A) * (GReal)0.5;
+		Interval.Error = err;
+	}
+
+	/*!
+		\param Result the output calculated integral.
+		\param u0 lower bound of integration domain
+		\param u1 upper bound of integration domain
+		\param Function the batched callback function used to evaluate integrand.
+		\param UserData pointer passed to the callback function.
+		\param MaxError the maximum relative precision we wanna reach for the integral calculus.
+		\param MaxIntervals the maximum number of sub-intervals the domain can be split into.
+		\return G_TRUE if the specified precision has been reached, G_FALSE otherwise
+	*/
+	GBool GIntegration::GaussKronrod(GReal& Result, const GReal u0, const GReal u1, GBatchFunction Function,
+									 void *UserData, const GReal MaxError, const GUInt32 MaxIntervals) {
+
+		GDynArray<GGaussKronrodInterval> intervals;
+		GGaussKronrodInterval interval, left, right;
+		GReal params[30], values[30];
+		GReal integral, err, tolerance, mid;
+		GUInt32 i, j, worst;
+
+		tolerance = GMath::Max(MaxError, 100 * G_EPSILON);
+
+		interval.A = u0;
+		interval.B = u1;
+		GaussKronrodParams(u0, u1, params);
+		Function(params, values, 15, UserData);
+		GaussKronrodRule(interval, values);
+
+		integral = interval.Integral;
+		err = interval.Error;
+		if (err <= tolerance * GMath::Abs(integral) || u0 == u1) {
+			Result = integral;
+			return G_TRUE;
+		}
+		intervals.reserve(GMath::Min(MaxIntervals, (GUInt32)16));
+		intervals.push_back(interval);
+
+		while (err > tolerance * GMath::Abs(integral) && (GUInt32)intervals.size() < MaxIntervals) {
+			// bisect the interval with the largest error
+			worst = 0;
+			j = (GUInt32)intervals.size();
+			for (i = 1; i < j; ++i) {
+				if (intervals[i].Error > intervals[worst].Error)
+					worst = i;
+			}
+			interval = intervals[worst];
+			mid = (GReal)0.5 * (interval.A + interval.B);
+			// the interval can't be split anymore
+			if (mid <= GMath::Min(interval.A, interval.B) || mid >= GMath::Max(interval.A, interval.B))
+				break;
+			left.A = interval.A;
+			left.B = mid;
+			right.A = mid;
+			right.B = interval.B;
+			// both halves are evaluated with a single call
+			GaussKronrodParams(left.A, left.B, params);
+			GaussKronrodParams(right.A, right.B, params + 15);
+			Function(params, values, 30, UserData);
+			GaussKronrodRule(left, values);
+			GaussKronrodRule(right, values + 15);
+
+			integral += (left.Integral + right.Integral) - interval.Integral;
+			err += (left.Error + right.Error) - interval.Error;
+			intervals[worst] = left;
+			intervals.push_back(right);
+		}
+
+		// sum again from scratch, to get rid of accumulated cancellation errors
+		integral = 0;
+		err = 0;
+		j = (GUInt32)intervals.size();
+		for (i = 0; i < j; ++i) {
+			integral += intervals[i].Integral;
+			err += intervals[i].Error;
+		}
+		Result = integral;
+		if (err <= tolerance * GMath::Abs(integral))
+			return G_TRUE;
+		return G_FALSE;
+	}
 }
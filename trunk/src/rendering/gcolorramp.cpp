@@ -0,0 +1,442 @@
+/****************************************************************************
+** $file: amanith/src/rendering/gcolorramp.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** Color ramp (gradient lookup table) implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/rendering/gcolorramp.h"
+#include "amanith/1d/ghermitecurve1d.h"
+#include <algorithm>
+#include <new>
+
+/*!
+	\file gcolorramp.cpp
+	\brief Implementation file for GColorRamp and GColorRampCache classes.
+*/
+
+namespace Amanith {
+
+// *********************************************************************
+//                              GColorRamp
+// *********************************************************************
+
+// a color key, with its components clamped in the range [0; 1]
+struct GRampKey {
+	GReal Time;
+	GReal Color[4];
+	GReal InTangent[4];
+	GReal OutTangent[4];
+};
+
+static GBool RampKeyLE(const GRampKey& Key1, const GRampKey& Key2) {
+
+	if (Key1.Time < Key2.Time)
+		return G_TRUE;
+	return G_FALSE;
+}
+
+// extract (clamped) RGBA components from a color key
+static void KeyColor(const GKeyValue& Key, GReal *Color) {
+
+	GVector4 v = Key.Vect4Value();
+
+	Color[0] = GMath::Clamp(v[G_X], (GReal)0, (GReal)1);
+	Color[1] = GMath::Clamp(v[G_Y], (GReal)0, (GReal)1);
+	Color[2] = GMath::Clamp(v[G_Z], (GReal)0, (GReal)1);
+	// G_VECTOR3_KEY keys are opaque colors
+	if (Key.KeyType() == G_VECTOR3_KEY)
+		Color[3] = 1;
+	else
+		Color[3] = GMath::Clamp(v[G_W], (GReal)0, (GReal)1);
+}
+
+// calculate Hermite tangents, using the same rules of GHermiteCurve1D (so textures and shaders agree)
+static void RampTangents(GDynArray<GRampKey>& Keys) {
+
+	GUInt32 i, k, j = (GUInt32)Keys.size();
+	GDynArray<GHermiteKey1D> curveKeys(j);
+	GHermiteCurve1D curve;
+	GHermiteKey1D tmpKey;
+
+	for (k = 0; k < 4; ++k) {
+		for (i = 0; i < j; ++i)
+			curveKeys[i] = GHermiteKey1D(Keys[i].Time, Keys[i].Color[k]);
+
+		if (curve.SetKeys(curveKeys) != G_NO_ERROR || curve.PointsCount() != j) {
+			// degenerated keys, use flat tangents
+			for (i = 0; i < j; ++i)
+				Keys[i].InTangent[k] = Keys[i].OutTangent[k] = 0;
+			continue;
+		}
+		for (i = 0; i < j; ++i) {
+			curve.Key(i, tmpKey);
+			Keys[i].InTangent[k] = tmpKey.InTangent;
+			Keys[i].OutTangent[k] = tmpKey.OutTangent;
+		}
+	}
+}
+
+// convert a RGBA color (components in the range [0; 1]) into an ARGB32 word
+static inline GUInt32 PackColor(const GReal *Color, const GBool Premultiplied) {
+
+	GReal r = GMath::Clamp(Color[0], (GReal)0, (GReal)1);
+	GReal g = GMath::Clamp(Color[1], (GReal)0, (GReal)1);
+	GReal b = GMath::Clamp(Color[2], (GReal)0, (GReal)1);
+	GReal a = GMath::Clamp(Color[3], (GReal)0, (GReal)1);
+
+	if (Premultiplied) {
+		r *= a;
+		g *= a;
+		b *= a;
+	}
+	return ((GUInt32)(a * 255 + (GReal)0.5) << 24) | ((GUInt32)(r * 255 + (GReal)0.5) << 16) |
+		   ((GUInt32)(g * 255 + (GReal)0.5) << 8) | (GUInt32)(b * 255 + (GReal)0.5);
+}
+
+// sample keys at Count parameters (U0, U0 + Step, ...); parameters must be not less than the first key time
+static void SampleKeys(const GDynArray<GRampKey>& Keys, const GColorRampInterpolation Interpolation,
+					   const GReal U0, const GReal Step, const GUInt32 Count, const GBool Premultiplied,
+					   GUInt32 *Colors) {
+
+	GUInt32 i, k, seg, lastKey = (GUInt32)Keys.size() - 1;
+	GReal u, t, t2, t3, h1, h2, h3, h4, invLen;
+	GReal color[4];
+
+	seg = 0;
+	for (i = 0; i < Count; ++i) {
+
+		u = U0 + (GReal)i * Step;
+		// parameters are increasing, so we just have to walk over segments
+		while (seg < lastKey && u >= Keys[seg + 1].Time)
+			seg++;
+		// past the last key
+		if (seg == lastKey) {
+			Colors[i] = PackColor(Keys[lastKey].Color, Premultiplied);
+			continue;
+		}
+
+		const GRampKey& k0 = Keys[seg];
+		const GRampKey& k1 = Keys[seg + 1];
+
+		switch (Interpolation) {
+
+			case G_CONSTANT_COLOR_INTERPOLATION:
+				Colors[i] = PackColor(k0.Color, Premultiplied);
+				break;
+
+			case G_LINEAR_COLOR_INTERPOLATION:
+				invLen = 1 / (k1.Time - k0.Time);
+				t = (u - k0.Time) * invLen;
+				for (k = 0; k < 4; ++k)
+					color[k] = k0.Color[k] + t * (k1.Color[k] - k0.Color[k]);
+				Colors[i] = PackColor(color, Premultiplied);
+				break;
+
+			case G_HERMITE_COLOR_INTERPOLATION:
+				invLen = 1 / (k1.Time - k0.Time);
+				t = (u - k0.Time) * invLen;
+				t2 = t * t;
+				t3 = t2 * t;
+				// Hermite basis functions, shared by all four channels
+				h1 = 2 * t3 - 3 * t2 + 1;
+				h2 = -2 * t3 + 3 * t2;
+				h3 = t3 - 2 * t2 + t;
+				h4 = t3 - t2;
+				for (k = 0; k < 4; ++k)
+					color[k] = h1 * k0.Color[k] + h2 * k1.Color[k] + h3 * k0.OutTangent[k] + h4 * k1.InTangent[k];
+				Colors[i] = PackColor(color, Premultiplied);
+				break;
+		}
+	}
+}
+
+// FNV-1a hashing
+static inline void HashBytes(GUInt32& Hash, const void *Data, const GUInt32 Size) {
+
+	const GUChar8 *p = (const GUChar8 *)Data;
+	for (GUInt32 i = 0; i < Size; ++i) {
+		Hash ^= (GUInt32)p[i];
+		Hash *= 16777619;
+	}
+}
+
+GColorRamp::GColorRamp() {
+
+	gInterpolation = G_LINEAR_COLOR_INTERPOLATION;
+	gSpreadMode = G_PAD_COLOR_RAMP_SPREAD;
+	gPremultiplied = G_TRUE;
+	gMirrored = G_FALSE;
+	gHashKey = 0;
+}
+
+GUInt32 GColorRamp::HashKey(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+							const GColorRampSpreadMode SpreadMode, const GUInt32 Size,
+							const GBool Premultiplied, const GBool Mirrored) {
+
+	GUInt32 hash = 2166136261U;
+	GUInt32 i, j = (GUInt32)ColorKeys.size();
+	GUInt32 params[5];
+	GReal key[5];
+
+	params[0] = (GUInt32)Interpolation;
+	params[1] = (GUInt32)SpreadMode;
+	params[2] = Size;
+	params[3] = (Premultiplied) ? 1 : 0;
+	params[4] = (Mirrored) ? 1 : 0;
+	HashBytes(hash, params, sizeof(params));
+
+	for (i = 0; i < j; ++i) {
+		key[0] = ColorKeys[i].TimePosition();
+		KeyColor(ColorKeys[i], &key[1]);
+		HashBytes(hash, key, sizeof(key));
+	}
+	return hash;
+}
+
+GBool GColorRamp::Matches(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+						  const GColorRampSpreadMode SpreadMode, const GUInt32 Size,
+						  const GBool Premultiplied, const GBool Mirrored) const {
+
+	GUInt32 i, k, j = (GUInt32)ColorKeys.size();
+	GReal c1[4], c2[4];
+
+	if (Interpolation != gInterpolation || SpreadMode != gSpreadMode || Size != (GUInt32)gColors.size() ||
+		Premultiplied != gPremultiplied || Mirrored != gMirrored || j != (GUInt32)gKeys.size())
+		return G_FALSE;
+
+	for (i = 0; i < j; ++i) {
+		if (ColorKeys[i].TimePosition() != gKeys[i].TimePosition())
+			return G_FALSE;
+		KeyColor(ColorKeys[i], c1);
+		KeyColor(gKeys[i], c2);
+		for (k = 0; k < 4; ++k) {
+			if (c1[k] != c2[k])
+				return G_FALSE;
+		}
+	}
+	return G_TRUE;
+}
+
+GError GColorRamp::Build(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+						 const GColorRampSpreadMode SpreadMode, const GUInt32 Size, const GBool Premultiplied,
+						 const GBool Mirrored) {
+
+	GUInt32 i, j = (GUInt32)ColorKeys.size(), n;
+	GDynArray<GRampKey> keys(j);
+
+	if (j == 0 || Size < 2)
+		return G_INVALID_PARAMETER;
+
+	for (i = 0; i < j; ++i) {
+		keys[i].Time = ColorKeys[i].TimePosition();
+		KeyColor(ColorKeys[i], keys[i].Color);
+	}
+	std::stable_sort(keys.begin(), keys.end(), RampKeyLE);
+
+	if (Interpolation == G_HERMITE_COLOR_INTERPOLATION && j > 1)
+		RampTangents(keys);
+
+	gColors.resize(Size);
+	gKeys = ColorKeys;
+	gInterpolation = Interpolation;
+	gSpreadMode = SpreadMode;
+	gPremultiplied = Premultiplied;
+	gMirrored = Mirrored;
+	gHashKey = HashKey(ColorKeys, Interpolation, SpreadMode, Size, Premultiplied, Mirrored);
+
+	GReal domainStart = keys[0].Time;
+	GReal domainLen = keys[j - 1].Time - domainStart;
+
+	if (!Mirrored) {
+		SampleKeys(keys, Interpolation, domainStart, domainLen / (GReal)(Size - 1), Size, Premultiplied, &gColors[0]);
+		// make sure that the last entry is exactly the last key color
+		gColors[Size - 1] = PackColor(keys[j - 1].Color, Premultiplied);
+	}
+	else {
+		// the first half is the ramp itself (sampled at double rate), the second half is its reflection
+		n = (Size + 1) / 2;
+		SampleKeys(keys, Interpolation, domainStart, (2 * domainLen) / (GReal)(Size - 1), n, Premultiplied, &gColors[0]);
+		for (i = n; i < Size; ++i)
+			gColors[i] = gColors[Size - 1 - i];
+	}
+	return G_NO_ERROR;
+}
+
+void GColorRamp::Colors(const GReal U0, const GReal DeltaU, GUInt32 *Colors, const GUInt32 Count) const {
+
+	GInt32 last = (GInt32)gColors.size() - 1;
+	GInt64 pos, step, idx, period;
+	GReal scale;
+	GUInt32 i;
+
+	if (!Colors || Count == 0)
+		return;
+	if (last < 0) {
+		for (i = 0; i < Count; ++i)
+			Colors[i] = 0;
+		return;
+	}
+
+	// a mirrored table covers two keys domains, so a simple repeat realizes the reflect spread mode
+	scale = (gMirrored) ? ((GReal)last * (GReal)0.5) : (GReal)last;
+	// 16.16 fixed point table positions, rounded to the nearest entry
+	pos = (GInt64)GMath::Floor(U0 * scale * (GReal)65536 + (GReal)0.5) + 32768;
+	step = (GInt64)GMath::Floor(DeltaU * scale * (GReal)65536 + (GReal)0.5);
+
+	if (gMirrored || gSpreadMode == G_REPEAT_COLOR_RAMP_SPREAD) {
+		period = (GInt64)last;
+		if (period == 0)
+			period = 1;
+		for (i = 0; i < Count; ++i, pos += step) {
+			idx = (pos >> 16) % period;
+			if (idx < 0)
+				idx += period;
+			Colors[i] = gColors[(GUInt32)idx];
+		}
+	}
+	else
+	if (gSpreadMode == G_REFLECT_COLOR_RAMP_SPREAD) {
+		period = 2 * (GInt64)last;
+		if (period == 0)
+			period = 1;
+		for (i = 0; i < Count; ++i, pos += step) {
+			idx = (pos >> 16) % period;
+			if (idx < 0)
+				idx += period;
+			if (idx > last)
+				idx = period - idx;
+			Colors[i] = gColors[(GUInt32)idx];
+		}
+	}
+	// pad
+	else {
+		for (i = 0; i < Count; ++i, pos += step) {
+			idx = pos >> 16;
+			if (idx < 0)
+				idx = 0;
+			else
+			if (idx > last)
+				idx = last;
+			Colors[i] = gColors[(GUInt32)idx];
+		}
+	}
+}
+
+GUInt32 GColorRamp::Color(const GReal U) const {
+
+	GUInt32 result;
+
+	Colors(U, 0, &result, 1);
+	return result;
+}
+
+// *********************************************************************
+//                           GColorRampCache
+// *********************************************************************
+
+GColorRampCache::GColorRampCache() {
+}
+
+GColorRampCache::~GColorRampCache() {
+
+	GUInt32 i, j = (GUInt32)gRamps.size();
+
+	for (i = 0; i < j; ++i)
+		delete gRamps[i].Ramp;
+	gRamps.clear();
+}
+
+// binary search of the first cached ramp with a hash key not less than the specified one
+GUInt32 GColorRampCache::LowerBound(const GUInt32 HashKey) const {
+
+	GUInt32 lo = 0, hi = (GUInt32)gRamps.size(), mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (gRamps[mid].Ramp->HashKey() < HashKey)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+const GColorRamp *GColorRampCache::Acquire(const GDynArray<GKeyValue>& ColorKeys,
+										   const GColorRampInterpolation Interpolation,
+										   const GColorRampSpreadMode SpreadMode, const GUInt32 Size,
+										   const GBool Premultiplied, const GBool Mirrored, GBool& NewRamp) {
+
+	GUInt32 hash = GColorRamp::HashKey(ColorKeys, Interpolation, SpreadMode, Size, Premultiplied, Mirrored);
+	GUInt32 lo = LowerBound(hash), i;
+
+	NewRamp = G_FALSE;
+	// hash collisions are resolved comparing building parameters
+	for (i = lo; i < (GUInt32)gRamps.size() && gRamps[i].Ramp->HashKey() == hash; ++i) {
+		if (gRamps[i].Ramp->Matches(ColorKeys, Interpolation, SpreadMode, Size, Premultiplied, Mirrored)) {
+			gRamps[i].RefCount++;
+			return gRamps[i].Ramp;
+		}
+	}
+
+	GColorRamp *ramp = new(std::nothrow) GColorRamp();
+	if (!ramp)
+		return NULL;
+	if (ramp->Build(ColorKeys, Interpolation, SpreadMode, Size, Premultiplied, Mirrored) != G_NO_ERROR) {
+		delete ramp;
+		return NULL;
+	}
+
+	GCachedRamp cached;
+	cached.Ramp = ramp;
+	cached.RefCount = 1;
+	gRamps.insert(gRamps.begin() + lo, cached);
+	NewRamp = G_TRUE;
+	return ramp;
+}
+
+GBool GColorRampCache::Release(const GColorRamp *Ramp) {
+
+	GUInt32 i;
+
+	if (!Ramp)
+		return G_FALSE;
+
+	for (i = LowerBound(Ramp->HashKey()); i < (GUInt32)gRamps.size() && gRamps[i].Ramp->HashKey() == Ramp->HashKey(); ++i) {
+		if (gRamps[i].Ramp == Ramp) {
+			G_ASSERT(gRamps[i].RefCount > 0);
+			gRamps[i].RefCount--;
+			if (gRamps[i].RefCount == 0) {
+				delete gRamps[i].Ramp;
+				gRamps.erase(gRamps.begin() + i);
+				return G_TRUE;
+			}
+			return G_FALSE;
+		}
+	}
+	// the ramp does not belong to this cache
+	return G_FALSE;
+}
+
+};	// end namespace Amanith
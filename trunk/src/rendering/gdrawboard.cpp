@@ -27,8 +27,15 @@
 **********************************************************************/
 
 #include "amanith/rendering/gdrawboard.h"
-#include "amanith/support/gsvgpathtokenizer.h"
+#include "amanith/support/gsvgpathparser.h"
 #include "amanith/geometry/gxformconv.h"
+#include "amanith/geometry/gbulkxform.h"
+#include "amanith/geometry/gdistance.h"
+#include "amanith/2d/gbeziercurve2d.h"
+#include "amanith/2d/gbsplinecurve2d.h"
+#include "amanith/2d/gpolylinecurve2d.h"
+#include "amanith/2d/gellipsecurve2d.h"
+#include "amanith/2d/gpath2d.h"
 #include <new>
 
 /*!
@@ -62,6 +69,11 @@ GDrawBoard::GDrawBoard() {
 	gInsideGroup = G_FALSE;
 	gViewport.Set(0, 0, 1, 1);
 	gProjection.Set(0, 1, 0, 1);
+	gCullingEnabled = G_TRUE;
+	gSubPixelMode = G_DRAW_SUBPIXEL_MODE;
+	gSubPixelSize = 1;
+	gCulledPrimitives = 0;
+	gSubPixelPrimitives = 0;
 }
 
 GDrawBoard::~GDrawBoard() {
@@ -622,6 +634,166 @@ void GDrawBoard::SetFillEnabled(const GBool Enabled) {
 	gCurrentContext.gDrawStyle->SetFillEnabled(Enabled);
 }
 
+//---------------------------------------------------------------------------
+//                           CULLING & LEVEL OF DETAIL
+//---------------------------------------------------------------------------
+void GDrawBoard::DoSetShapeScale(const GReal Scale) {
+
+	// just to avoid warning
+	if (Scale) {
+	}
+}
+
+GBool GDrawBoard::DoClipMasksBox(GAABox2& Box) const {
+
+	// just to avoid warning
+	if (Box.Volume()) {
+	}
+	return G_FALSE;
+}
+
+GReal GDrawBoard::ModelViewScale() const {
+
+	const GMatrix33& m = ModelViewMatrix();
+
+	// greatest singular value of the 2x2 linear part
+	GReal a = m[0][0], b = m[0][1], c = m[1][0], d = m[1][1];
+	GReal s = (a * a + b * b + c * c + d * d) / 2;
+	GReal det = a * d - b * c;
+	GReal disc = s * s - det * det;
+
+	if (disc < 0)
+		disc = 0;
+	return GMath::Sqrt(s + GMath::Sqrt(disc));
+}
+
+// bounding box of the control points
+static void ControlPointsBox(const GCurve2D& Curve, GAABox2& Box) {
+
+	GUInt32 i, j = Curve.PointsCount();
+	GPoint2 p = Curve.Point(0), pMin = p, pMax = p;
+
+	for (i = 1; i < j; ++i) {
+		p = Curve.Point(i);
+		if (p[G_X] < pMin[G_X])
+			pMin[G_X] = p[G_X];
+		else
+		if (p[G_X] > pMax[G_X])
+			pMax[G_X] = p[G_X];
+		if (p[G_Y] < pMin[G_Y])
+			pMin[G_Y] = p[G_Y];
+		else
+		if (p[G_Y] > pMax[G_Y])
+			pMax[G_Y] = p[G_Y];
+	}
+	Box.SetMinMax(pMin, pMax);
+}
+
+// a box that contains the curve; it returns G_FALSE if the curve type is not known (no culling is possible)
+static GBool CurveBox(const GCurve2D& Curve, GAABox2& Box) {
+
+	// these curves lie inside the convex hull of their control points
+	if (Curve.IsOfType(G_BEZIERCURVE2D_CLASSID) || Curve.IsOfType(G_BSPLINECURVE2D_CLASSID) ||
+		Curve.IsOfType(G_POLYLINECURVE2D_CLASSID)) {
+		ControlPointsBox(Curve, Box);
+		return G_TRUE;
+	}
+	if (Curve.IsOfType(G_ELLIPSECURVE2D_CLASSID)) {
+		const GEllipseCurve2D& e = (const GEllipseCurve2D&)Curve;
+		GReal r = GMath::Max(e.XSemiAxisLength(), e.YSemiAxisLength());
+		Box.SetMinMax(e.Center() - GVector2(r, r), e.Center() + GVector2(r, r));
+		return G_TRUE;
+	}
+	if (Curve.IsOfType(G_PATH2D_CLASSID)) {
+		const GPath2D& path = (const GPath2D&)Curve;
+		GUInt32 i, j = path.SegmentsCount();
+		GAABox2 segBox;
+
+		if (j == 0 || !CurveBox(*path.Segment(0), Box))
+			return G_FALSE;
+		for (i = 1; i < j; ++i) {
+			if (!CurveBox(*path.Segment(i), segBox))
+				return G_FALSE;
+			Box.ExtendToInclude(segBox.Min());
+			Box.ExtendToInclude(segBox.Max());
+		}
+		return G_TRUE;
+	}
+	return G_FALSE;
+}
+
+GBool GDrawBoard::BeginShape(const GAABox2 *Box, GInt32& Result) {
+
+	DoSetShapeScale(ModelViewScale());
+
+	// clip and cache modes draw everything
+	if (!Box || TargetMode() != G_COLOR_MODE || (!gCullingEnabled && gSubPixelMode == G_DRAW_SUBPIXEL_MODE))
+		return G_TRUE;
+
+	GDrawStyle *s = gCurrentContext.gDrawStyle;
+	GPoint2 p[4];
+	GReal r = 0;
+
+	// take care of the stroke, including miter joins and square caps
+	if (s->StrokeEnabled()) {
+		r = s->StrokeThickness() / (GReal)G_SQRTHALF;
+		if (s->StrokeJoinStyle() == G_MITER_JOIN)
+			r = GMath::Max(r, s->StrokeThickness() * s->StrokeMiterLimit());
+	}
+	p[0].Set(Box->Min()[G_X] - r, Box->Min()[G_Y] - r);
+	p[2].Set(Box->Max()[G_X] + r, Box->Max()[G_Y] + r);
+	p[1].Set(p[2][G_X], p[0][G_Y]);
+	p[3].Set(p[0][G_X], p[2][G_Y]);
+
+	// logical box of the shape
+	GBulkXForm::XForm(ModelViewMatrix(), G_FALSE, p, p, 4);
+	GAABox2 box(p[0], p[1]);
+	box.ExtendToInclude(p[2]);
+	box.ExtendToInclude(p[3]);
+
+	if (gCullingEnabled) {
+		// gProjection x = left; y = right; z = bottom; w = top
+		GReal left = GMath::Min(gProjection[G_X], gProjection[G_Y]);
+		GReal right = GMath::Max(gProjection[G_X], gProjection[G_Y]);
+		GReal bottom = GMath::Min(gProjection[G_Z], gProjection[G_W]);
+		GReal top = GMath::Max(gProjection[G_Z], gProjection[G_W]);
+		GAABox2 clipBox;
+
+		if (DoClipMasksBox(clipBox)) {
+			left = GMath::Max(left, clipBox.Min()[G_X]);
+			right = GMath::Min(right, clipBox.Max()[G_X]);
+			bottom = GMath::Max(bottom, clipBox.Min()[G_Y]);
+			top = GMath::Min(top, clipBox.Max()[G_Y]);
+		}
+		if (box.Max()[G_X] < left || box.Min()[G_X] > right || box.Max()[G_Y] < bottom || box.Min()[G_Y] > top) {
+			gCulledPrimitives++;
+			Result = G_DRAWBOARD_CACHE_NOT_WRITTEN;
+			return G_FALSE;
+		}
+	}
+
+	if (gSubPixelMode != G_DRAW_SUBPIXEL_MODE) {
+		// pixels per logical unit
+		GReal sx = (GReal)gViewport[G_Z] / GMath::Abs(gProjection[G_Y] - gProjection[G_X]);
+		GReal sy = (GReal)gViewport[G_W] / GMath::Abs(gProjection[G_W] - gProjection[G_Z]);
+
+		if (box.Dimension(G_X) * sx < gSubPixelSize && box.Dimension(G_Y) * sy < gSubPixelSize) {
+			gSubPixelPrimitives++;
+			if (gSubPixelMode == G_SKIP_SUBPIXEL_MODE) {
+				Result = G_DRAWBOARD_CACHE_NOT_WRITTEN;
+				return G_FALSE;
+			}
+			// a pixel sized rectangle, centered on the shape (model coordinates)
+			GReal h = (GReal)0.5 / (GMath::Min(sx, sy) * GMath::Max(ModelViewScale(), G_EPSILON));
+			GVector2 half(GMath::Max(Box->HalfDimension(G_X), h), GMath::Max(Box->HalfDimension(G_Y), h));
+			GPoint2 center = Box->Center();
+			Result = DoDrawRectangle(*s, center - half, center + half);
+			return G_FALSE;
+		}
+	}
+	return G_TRUE;
+}
+
 //---------------------------------------------------------------------------
 //                           PRIMITIVES & COMMANDS
 //---------------------------------------------------------------------------
@@ -629,21 +801,36 @@ void GDrawBoard::SetFillEnabled(const GBool Enabled) {
 GInt32 GDrawBoard::DrawLine(const GPoint2& P0, const GPoint2& P1) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
+	GAABox2 box(P0, P1);
+	GInt32 res;
 
+	if (!BeginShape(&box, res))
+		return res;
 	return DoDrawLine(*s, P0, P1);
 }
 
 GInt32 GDrawBoard::DrawBezier(const GPoint2& P0, const GPoint2& P1, const GPoint2& P2) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
+	GAABox2 box(P0, P2);
+	GInt32 res;
 
+	box.ExtendToInclude(P1);
+	if (!BeginShape(&box, res))
+		return res;
 	return DoDrawBezier(*s, P0, P1, P2);
 }
 
 GInt32 GDrawBoard::DrawBezier(const GPoint2& P0, const GPoint2& P1, const GPoint2& P2, const GPoint2& P3) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
+	GAABox2 box(P0, P3);
+	GInt32 res;
 
+	box.ExtendToInclude(P1);
+	box.ExtendToInclude(P2);
+	if (!BeginShape(&box, res))
+		return res;
 	return DoDrawBezier(*s, P0, P1, P2, P3);
 }
 
@@ -652,8 +839,15 @@ GInt32 GDrawBoard::DrawEllipseArc(const GPoint2& Center, const GReal XSemiAxisLe
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (XSemiAxisLength > 0 && YSemiAxisLength > 0)
+	if (XSemiAxisLength > 0 && YSemiAxisLength > 0) {
+		GReal r = GMath::Max(XSemiAxisLength, YSemiAxisLength);
+		GAABox2 box(Center - GVector2(r, r), Center + GVector2(r, r));
+		GInt32 res;
+
+		if (!BeginShape(&box, res))
+			return res;
 		return DoDrawEllipseArc(*s, Center, XSemiAxisLength, YSemiAxisLength, OffsetRotation, StartAngle, EndAngle, CCW);
+	}
 	else {
 		G_DEBUG("DrawEllipseArc, negative semi-axes");
 		return G_INVALID_PARAMETER;
@@ -665,8 +859,20 @@ GInt32 GDrawBoard::DrawEllipseArc(const GPoint2& P0, const GPoint2& P1, const GR
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (XSemiAxisLength > 0 && YSemiAxisLength > 0)
+	if (XSemiAxisLength > 0 && YSemiAxisLength > 0) {
+		// too small radii are scaled up until the ellipse passes through both points; the scaled major
+		// semi-axis cannot exceed half the chord times (1 + major / minor), and the arc is never farther from
+		// P0 than the major axis
+		GReal rMax = GMath::Max(XSemiAxisLength, YSemiAxisLength);
+		GReal rMin = GMath::Min(XSemiAxisLength, YSemiAxisLength);
+		GReal r = 2 * GMath::Max(rMax, (Distance(P0, P1) / 2) * (1 + rMax / rMin));
+		GAABox2 box(P0 - GVector2(r, r), P0 + GVector2(r, r));
+		GInt32 res;
+
+		if (!BeginShape(&box, res))
+			return res;
 		return DoDrawEllipseArc(*s, P0, P1, XSemiAxisLength, YSemiAxisLength, OffsetRotation, LargeArc, CCW);
+	}
 	else {
 		G_DEBUG("DrawEllipseArc, negative semi-axes");
 		return G_INVALID_PARAMETER;
@@ -676,7 +882,18 @@ GInt32 GDrawBoard::DrawEllipseArc(const GPoint2& P0, const GPoint2& P1, const GR
 GInt32 GDrawBoard::DrawPolygon(const GDynArray<GPoint2>& Points, const GBool Closed) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
+	GInt32 res;
+
+	if (Points.empty())
+		return DoDrawPolygon(*s, Points, Closed);
+
+	GAABox2 box(Points[0], Points[0]);
+	GUInt32 i, j = (GUInt32)Points.size();
 
+	for (i = 1; i < j; ++i)
+		box.ExtendToInclude(Points[i]);
+	if (!BeginShape(&box, res))
+		return res;
 	return DoDrawPolygon(*s, Points, Closed);
 }
 
@@ -684,7 +901,10 @@ GInt32 GDrawBoard::DrawRectangle(const GPoint2& P0, const GPoint2& P1) {
 
 	GAABox2 box(P0, P1);
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
+	GInt32 res;
 
+	if (!BeginShape(&box, res))
+		return res;
 	return DoDrawRectangle(*s, box.Min(), box.Max());
 }
 
@@ -692,6 +912,10 @@ GInt32 GDrawBoard::DrawRoundRectangle(const GPoint2& P0, const GPoint2& P1, cons
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 	GAABox2 box(P0, P1);
+	GInt32 res;
+
+	if (!BeginShape(&box, res))
+		return res;
 
 	if (ArcWidth > 0 && ArcHeight > 0) {
 		// arc dimensions cannot be larger than box half-dimensions
@@ -717,8 +941,15 @@ GInt32 GDrawBoard::DrawEllipse(const GPoint2& Center, const GReal XSemiAxisLengt
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (XSemiAxisLength > 0 && YSemiAxisLength > 0)
+	if (XSemiAxisLength > 0 && YSemiAxisLength > 0) {
+		GReal r = GMath::Max(XSemiAxisLength, YSemiAxisLength);
+		GAABox2 box(Center - GVector2(r, r), Center + GVector2(r, r));
+		GInt32 res;
+
+		if (!BeginShape(&box, res))
+			return res;
 		return DoDrawEllipse(*s, Center, XSemiAxisLength, YSemiAxisLength);
+	}
 	else {
 		G_DEBUG("DrawEllipse, negative semi-axes");
 		return G_INVALID_PARAMETER;
@@ -729,8 +960,14 @@ GInt32 GDrawBoard::DrawCircle(const GPoint2& Center, const GReal Radius) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (Radius > 0)
+	if (Radius > 0) {
+		GAABox2 box(Center - GVector2(Radius, Radius), Center + GVector2(Radius, Radius));
+		GInt32 res;
+
+		if (!BeginShape(&box, res))
+			return res;
 		return DoDrawCircle(*s, Center, Radius);
+	}
 	else {
 		G_DEBUG("DrawCircle, negative radius");
 		return G_INVALID_PARAMETER;
@@ -741,8 +978,14 @@ GInt32 GDrawBoard::DrawPath(const GCurve2D& Curve) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (Curve.PointsCount() > 1)
+	if (Curve.PointsCount() > 1) {
+		GAABox2 box;
+		GInt32 res;
+
+		if (!BeginShape(CurveBox(Curve, box) ? &box : NULL, res))
+			return res;
 		return DoDrawPath(*s, Curve);
+	}
 	else {
 		G_DEBUG("DrawPath, curve has no points");
 		return G_INVALID_PARAMETER;
@@ -753,129 +996,161 @@ GInt32 GDrawBoard::DrawPaths(const GDynArray<GCurve2D *>& Curves) {
 
 	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (Curves.size() > 0)
+	if (Curves.size() > 0) {
+		GAABox2 box, curveBox;
+		GUInt32 i, j = (GUInt32)Curves.size();
+		GBool known = CurveBox(*Curves[0], box);
+		GInt32 res;
+
+		for (i = 1; i < j && known; ++i) {
+			known = CurveBox(*Curves[i], curveBox);
+			box.ExtendToInclude(curveBox.Min());
+			box.ExtendToInclude(curveBox.Max());
+		}
+		if (!BeginShape(known ? &box : NULL, res))
+			return res;
 		return DoDrawPaths(*s, Curves);
+	}
 	else {
 		G_DEBUG("DrawPaths, no curves specified (empty array)");
 		return G_INVALID_PARAMETER;
 	}
 }
 
-GInt32 GDrawBoard::DrawPaths(const GString& SVGPathDescription, const GAnglesMeasureUnit AnglesMeasureUnits) {
+GInt32 GDrawBoard::DrawPaths(const GChar8 *Begin, const GChar8 *End, const GAnglesMeasureUnit AnglesMeasureUnits) {
+
+	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-	if (SVGPathDescription.length() < 2) {
-		G_DEBUG("DrawPaths, empty SVG string");
+	if (!Begin || End - Begin < 2) {
+		G_DEBUG("DrawPaths, empty SVG path data");
 		return G_INVALID_PARAMETER;
 	}
 
-	GReal arg[6];
-	GBool largeArc, sweep;
-	GChar8 cmd;
-	// instantiate a new tokenizer
-	GSVGPathTokenizer tokenizer(SVGPathDescription);
+	GInt32 res;
+
+	// bounds are not known until the path has been parsed
+	if (!BeginShape(NULL, res))
+		return res;
+	return DoDrawSVGPaths(*s, Begin, End, AnglesMeasureUnits);
+}
+
+// forwards normalized SVG commands to the path commands of a draw board
+class GDrawBoardSVGSink : public GSVGPathSink {
+
+private:
+	GDrawBoard& gBoard;
+
+public:
+	GDrawBoardSVGSink(GDrawBoard& Board) : gBoard(Board) {
+	}
+	void MoveTo(const GPoint2& P) {
+		gBoard.MoveTo(P, G_FALSE);
+	}
+	void LineTo(const GPoint2& P) {
+		gBoard.LineTo(P, G_FALSE);
+	}
+	void QuadraticTo(const GPoint2& P1, const GPoint2& P) {
+		gBoard.CurveTo(P1, P, G_FALSE);
+	}
+	void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+		gBoard.CurveTo(P1, P2, P, G_FALSE);
+	}
+	void ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+			   const GPoint2& P) {
+		gBoard.EllipticalArcTo(Rx, Ry, XRot, LargeArc, Sweep, P, G_FALSE);
+	}
+	void ClosePath() {
+		gBoard.ClosePath();
+	}
+};
+
+GInt32 GDrawBoard::DoDrawSVGPaths(GDrawStyle& Style, const GChar8 *Begin, const GChar8 *End,
+								  const GAnglesMeasureUnit AnglesMeasureUnits) {
+
+	// path commands always draw with the current style, that is Style
+	GDrawBoardSVGSink sink(*this);
+
+	// just to avoid warning
+	if (Style.StrokeEnabled()) {
+	}
 
 	BeginPaths();
+	// like SVG specifications say, everything before an error is drawn
+	if (GSVGPathParser::Parse(Begin, End, sink, AnglesMeasureUnits) != G_NO_ERROR)
+		G_DEBUG("DrawPaths, SVG path data contains errors");
+	return EndPaths();
+}
 
-	while (tokenizer.NextTkn()) {
+GInt32 GDrawBoard::DrawPaths(const GPathData& Data) {
 
-		// extract command
-		cmd = tokenizer.LastCmd();
+	GDrawStyle *s = gCurrentContext.gDrawStyle;
 
-		switch(cmd)	{
+	if (Data.IsEmpty()) {
+		G_DEBUG("DrawPaths, empty path data");
+		return G_INVALID_PARAMETER;
+	}
 
-			// moveto command
-			case 'M':
-			case 'm':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				MoveTo(arg[0], arg[1], cmd == 'm');
-				break;
+	GAABox2 box;
+	GInt32 res;
 
-			// lineto command
-			case 'L':
-			case 'l':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				LineTo(arg[0], arg[1], cmd == 'l');
-				break;
+	if (!BeginShape((Data.BoundingBox(box) == G_NO_ERROR) ? &box : NULL, res))
+		return res;
+	return DoDrawPathData(*s, Data);
+}
 
-			// vertical lineto command
-			case 'V':
-			case 'v':
-				arg[0] = tokenizer.LastNum();
-				VerticalLineTo(arg[0], cmd == 'v');
-				break;
+GInt32 GDrawBoard::DoDrawPathData(GDrawStyle& Style, const GPathData& Data) {
 
-			// horizontal lineto command
-			case 'H':
-			case 'h':
-				arg[0] = tokenizer.LastNum();
-				HorizontalLineTo(arg[0], cmd == 'h');
-				break;
+	const GDynArray<GUChar8>& verbs = Data.Verbs();
+	const GDynArray<GPoint2>& points = Data.Points();
+	const GDynArray<GReal>& angles = Data.ArcAngles();
+	GUInt32 i, j = (GUInt32)verbs.size(), k = 0, a = 0;
+	GReal rx, ry, rot, startAngle, sweepAngle;
+	GVector2 u, v;
+	GPoint2 p;
 
-			// quadratic Bezier curve
-			case 'Q':
-			case 'q':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				arg[2] = tokenizer.NextTknAsReal(cmd);
-				arg[3] = tokenizer.NextTknAsReal(cmd);
-				CurveTo(arg[0], arg[1], arg[2], arg[3], cmd == 'q');
-				break;
+	// just to avoid warning
+	if (Style.StrokeEnabled()) {
+	}
 
-			// quadratic Bezier smooth curve
-			case 'T':
-			case 't':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				SmoothCurveTo(arg[0], arg[1], cmd == 't');
+	// path commands always draw with the current style, that is Style
+	BeginPaths();
+	for (i = 0; i < j; ++i) {
+		switch (verbs[i]) {
+			case G_MOVE_TO_VERB:
+				MoveTo(points[k], G_FALSE);
+				k++;
 				break;
-
-			// cubic Bezier curve
-			case 'C':
-			case 'c':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				arg[2] = tokenizer.NextTknAsReal(cmd);
-				arg[3] = tokenizer.NextTknAsReal(cmd);
-				arg[4] = tokenizer.NextTknAsReal(cmd);
-				arg[5] = tokenizer.NextTknAsReal(cmd);
-				CurveTo(arg[0], arg[1], arg[2], arg[3], arg[4], arg[5], cmd == 'c');
+			case G_LINE_TO_VERB:
+				LineTo(points[k], G_FALSE);
+				k++;
 				break;
-
-			// cubic Bezier smooth curve
-			case 'S':
-			case 's':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				arg[2] = tokenizer.NextTknAsReal(cmd);
-				arg[3] = tokenizer.NextTknAsReal(cmd);
-				SmoothCurveTo(arg[0], arg[1], arg[2], arg[3], cmd == 's');
+			case G_QUAD_TO_VERB:
+				CurveTo(points[k], points[k + 1], G_FALSE);
+				k += 2;
 				break;
-
-			case 'A':
-			case 'a':
-				arg[0] = tokenizer.LastNum();
-				arg[1] = tokenizer.NextTknAsReal(cmd);
-				arg[2] = tokenizer.NextTknAsReal(cmd);
-				largeArc = tokenizer.NextTknAsBool(cmd);
-				sweep = tokenizer.NextTknAsBool(cmd);
-				arg[3] = tokenizer.NextTknAsReal(cmd);
-				arg[4] = tokenizer.NextTknAsReal(cmd);
-				EllipticalArcTo(arg[0], arg[1], GMath::AngleConversion(arg[2], AnglesMeasureUnits, G_RADIAN_UNIT),
-								largeArc, sweep, arg[3], arg[4], cmd == 'a');
+			case G_CUBIC_TO_VERB:
+				CurveTo(points[k], points[k + 1], points[k + 2], G_FALSE);
+				k += 3;
 				break;
-
-			case 'Z':
-			case 'z':
+			case G_ARC_TO_VERB:
+				u = points[k + 1] - points[k];
+				v = points[k + 2] - points[k];
+				GPathData::ArcPrincipalAxes(u, v, angles[a], angles[a + 1], rx, ry, rot, startAngle, sweepAngle);
+				// arcs wider than PI are split in two halves, so that full ellipses (coincident ends) are drawn too
+				if (GMath::Abs(sweepAngle) > (GReal)G_PI) {
+					startAngle = angles[a] + angles[a + 1] * (GReal)0.5;
+					p = points[k] + u * GMath::Cos(startAngle) + v * GMath::Sin(startAngle);
+					EllipticalArcTo(rx, ry, rot, G_FALSE, sweepAngle > 0, p, G_FALSE);
+				}
+				EllipticalArcTo(rx, ry, rot, G_FALSE, sweepAngle > 0, points[k + 3], G_FALSE);
+				k += 4;
+				a += 2;
+				break;
+			case G_CLOSE_VERB:
 				ClosePath();
 				break;
-
-		default:
-			G_DEBUG("SVG path invalid command");
 		}
 	}
-
 	return EndPaths();
 }
 
@@ -148,28 +148,15 @@ void GGradientDesc::SetMatrix(const GMatrix33& Matrix) {
 	if (gMatrix != Matrix) {
 
 		// calculate inverse gradient matrix
-		GMatrix33 preTrans, tmpInv;
-		GMatrix22 n, b;
-		GBool ok;
+		GMatrix33 tmpInv;
 		GReal det;
 
-		TranslationToMatrix(preTrans, GPoint2(-Matrix[0][2], -Matrix[1][2]));
-		n[0][0] = Matrix[0][0];
-		n[0][1] = Matrix[0][1];
-		n[1][0] = Matrix[1][0];
-		n[1][1] = Matrix[1][1];
-		ok = InvertFull_GJ(b, n, det);
-		if (!ok) {
+		// the inverse of [A t] is [inv(A) -inv(A)t]
+		if (!InvertAffine(tmpInv, Matrix, det)) {
 			G_DEBUG("GGradientDesc::SetMatrix, matrix is singular!");
 			return;
 		}
-		tmpInv[0][0] = b[0][0];
-		tmpInv[0][1] = b[0][1];
-		tmpInv[1][0] = b[1][0];
-		tmpInv[1][1] = b[1][1];
-		tmpInv[0][2] = 0;
-		tmpInv[1][2] = 0;
-		gInverseMatrix = tmpInv * preTrans;
+		gInverseMatrix = tmpInv;
 
 		gModified |= G_GRADIENT_MATRIX_MODIFIED;
 		gMatrix = Matrix;
@@ -338,28 +325,15 @@ void GPatternDesc::SetMatrix(const GMatrix33& Matrix) {
 	if (gMatrix != Matrix) {
 
 		// calculate inverse pattern matrix
-		GMatrix33 preTrans, tmpInv;
-		GMatrix22 n, b;
-		GBool ok;
+		GMatrix33 tmpInv;
 		GReal det;
 
-		TranslationToMatrix(preTrans, GPoint2(-Matrix[0][2], -Matrix[1][2]));
-		n[0][0] = Matrix[0][0];
-		n[0][1] = Matrix[0][1];
-		n[1][0] = Matrix[1][0];
-		n[1][1] = Matrix[1][1];
-		ok = InvertFull_GJ(b, n, det);
-		if (!ok) {
+		// the inverse of [A t] is [inv(A) -inv(A)t]
+		if (!InvertAffine(tmpInv, Matrix, det)) {
 			G_DEBUG("GPatternDesc::SetMatrix, matrix is singular!");
 			return;
 		}
-		tmpInv[0][0] = b[0][0];
-		tmpInv[0][1] = b[0][1];
-		tmpInv[1][0] = b[1][0];
-		tmpInv[1][1] = b[1][1];
-		tmpInv[0][2] = 0;
-		tmpInv[1][2] = 0;
-		gInverseMatrix = tmpInv * preTrans;
+		gInverseMatrix = tmpInv;
 
 		gModified |= G_PATTERN_MATRIX_MODIFIED;
 		gMatrix = Matrix;
@@ -746,29 +720,15 @@ void GDrawStyle::SetModelView(const GMatrix33& Matrix) {
 
 	if (gModelView != Matrix) {
 		// calculate inverse model-view matrix
-		GMatrix33 preTrans, tmpInv;
-		GMatrix22 n, b;
-		GBool ok;
+		GMatrix33 tmpInv;
 		GReal det;
 
-		TranslationToMatrix(preTrans, GPoint2(-Matrix[0][2], -Matrix[1][2]));
-		n[0][0] = Matrix[0][0];
-		n[0][1] = Matrix[0][1];
-		n[1][0] = Matrix[1][0];
-		n[1][1] = Matrix[1][1];
-		ok = InvertFull_GJ(b, n, det);
-		if (!ok) {
+		// the inverse of [A t] is [inv(A) -inv(A)t]
+		if (!InvertAffine(tmpInv, Matrix, det)) {
 			G_DEBUG("GDrawStyle::SetModelView, matrix is singular!");
 			return;
 		}
-
-		tmpInv[0][0] = b[0][0];
-		tmpInv[0][1] = b[0][1];
-		tmpInv[1][0] = b[1][0];
-		tmpInv[1][1] = b[1][1];
-		tmpInv[0][2] = 0;
-		tmpInv[1][2] = 0;
-		gInverseModelView = tmpInv * preTrans;
+		gInverseModelView = tmpInv;
 
 		gModified |= G_DRAWSTYLE_MODELVIEW_MODIFIED;
 		gModelView = Matrix;
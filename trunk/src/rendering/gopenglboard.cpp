@@ -29,6 +29,7 @@
 #include "amanith/rendering/gopenglboard.h"
 #include "amanith/geometry/gxform.h"
 #include "amanith/geometry/gxformconv.h"
+#include "amanith/geometry/gbulkxform.h"
 
 /*!
 	\file gopenglboard.cpp
@@ -497,28 +498,8 @@ void GOpenGLBoard::SetRectTextureEnabled(const GBool Enabled) {
 
 	// changing rectangular texture support, we must invalidate all textures already used before (to grab)
 	gRectTexturesInUse = Enabled;
-
-	if (gGLGroupRect.TexName > 0)
-		glDeleteTextures(1, &gGLGroupRect.TexName);
-
-	gGLGroupRect.Width = 0;
-	gGLGroupRect.Height = 0;
-	gGLGroupRect.TexWidth = 0;
-	gGLGroupRect.TexHeight = 0;
-	gGLGroupRect.TexName = 0;
-	gGLGroupRect.Target = 0;
-	gGLGroupRect.IsEmpty = G_TRUE;
-
-	if (gCompositingBuffer.TexName > 0)
-		glDeleteTextures(1, &gCompositingBuffer.TexName);
-
-	gCompositingBuffer.Width = 0;
-	gCompositingBuffer.Height = 0;
-	gCompositingBuffer.TexWidth = 0;
-	gCompositingBuffer.TexHeight = 0;
-	gCompositingBuffer.TexName = 0;
-	gCompositingBuffer.Target = 0;
-	gCompositingBuffer.IsEmpty = G_TRUE;
+	// pooled textures have the old target too
+	DeleteGrabTextures();
 }
 
 GOpenGLBoard::GOpenGLBoard(const GUInt32 LowLeftCornerX, const GUInt32 LowLeftCornerY,
@@ -552,6 +533,8 @@ GOpenGLBoard::GOpenGLBoard(const GUInt32 LowLeftCornerX, const GUInt32 LowLeftCo
 	gFirstClipMaskReplace = G_FALSE;
 	// set a flag that tells if, when we are inside a group, something has been drawn
 	gIsFirstGroupDrawing = G_FALSE;
+	// flattening deviation is calculated for an identity model-view at first
+	gShapeScale = 1;
 
 	// extract mirrored repeat support
 	gMirroredRepeatSupport = gExtManager->IsMirroredRepeatSupported();
@@ -584,6 +567,38 @@ GOpenGLBoard::GOpenGLBoard(const GUInt32 LowLeftCornerX, const GUInt32 LowLeftCo
 	gRectTexturesSupport = gExtManager->IsRectTextureSupported();
 	gRectTexturesInUse = gRectTexturesSupport;
 
+	// asynchronous screenshots
+	gPixelBufferSupport = gExtManager->IsPBOSupported();
+	gFenceSupport = gExtManager->IsFenceSupported();
+	gReadbackSlots.resize(3);
+	gReadbackFirst = 0;
+	gReadbackCount = 0;
+	gNextFrameID = 0;
+	gScreenShotCallback = NULL;
+	gScreenShotUserData = NULL;
+
+	// cached shapes
+	gVertexBufferSupport = gExtManager->IsVBOSupported();
+	gRecordedVertices = NULL;
+	gRecordedMode = GL_TRIANGLES;
+	gRecordedFirst = 0;
+	gGeometryCacheEnabled = G_TRUE;
+	gGeometryCacheBudget = 4 * 1024 * 1024;
+	std::memset(gGeometryCacheSeen, 0, sizeof(gGeometryCacheSeen));
+	gGeometryKeyValid = G_FALSE;
+	gGeometryKeyHash = 0;
+
+	// scissor clip masks
+	gScissorClipMasksEnabled = G_TRUE;
+	gScissorTestEnabled = G_FALSE;
+	std::memset(gScissorBox, 0, sizeof(gScissorBox));
+	gSubPixelScale = (GReal)(1 << GMath::Min(gExtManager->SubPixelBits(), (GUInt32)16));
+
+	// framebuffer grabs
+	gGrabTexturesPoolSize = 4;
+	gGroupTracking = G_FALSE;
+	gGroupDamaged = G_FALSE;
+
 	gAtan2LookupTable = NULL;
 	gAtan2LookupTableSize = 256;
 
@@ -631,6 +646,8 @@ GOpenGLBoard::~GOpenGLBoard() {
 	DeleteGradients();
 	DeletePatterns();
 	DeleteCacheBanks();
+	InvalidateGeometryCache();
+	DeleteReadbackSlots();
 
 	if (gFragmentProgramsSupport) {
 		DestroyShadersTable();
@@ -638,11 +655,7 @@ GOpenGLBoard::~GOpenGLBoard() {
 			delete [] gAtan2LookupTable;
 	}
 
-	if (gGLGroupRect.TexName > 0)
-		glDeleteTextures(1, &gGLGroupRect.TexName);
-
-	if (gCompositingBuffer.TexName > 0)
-		glDeleteTextures(1, &gCompositingBuffer.TexName);
+	DeleteGrabTextures();
 
 	if (gExtManager)
 		delete gExtManager;
@@ -725,25 +738,72 @@ void GOpenGLBoard::UpdateDeviation(const GRenderingQuality Quality) {
 	switch (Quality) {
 
 		case G_LOW_RENDERING_QUALITY:
-			gDeviation = CalcDeviation(LOW_QUALITY_PIXEL_DEVIATION);
+			gBaseDeviation = CalcDeviation(LOW_QUALITY_PIXEL_DEVIATION);
 			break;
 
 		case G_NORMAL_RENDERING_QUALITY:
-			gDeviation = CalcDeviation(NORMAL_QUALITY_PIXEL_DEVIATION);
+			gBaseDeviation = CalcDeviation(NORMAL_QUALITY_PIXEL_DEVIATION);
 			break;
 
 		case G_HIGH_RENDERING_QUALITY:
-			gDeviation = CalcDeviation(HIGH_QUALITY_PIXEL_DEVIATION);
+			gBaseDeviation = CalcDeviation(HIGH_QUALITY_PIXEL_DEVIATION);
 			break;
 	}
-	G_ASSERT(gDeviation > 0);
-	gFlateness = GMath::Sqrt(gDeviation);
+	G_ASSERT(gBaseDeviation > 0);
+	UpdateShapeDeviation();
 
 	#undef LOW_QUALITY_PIXEL_DEVIATION
 	#undef NORMAL_QUALITY_PIXEL_DEVIATION
 	#undef HIGH_QUALITY_PIXEL_DEVIATION
 }
 
+void GOpenGLBoard::UpdateShapeDeviation() {
+
+	gDeviation = gBaseDeviation / (gShapeScale * gShapeScale);
+	gFlateness = GMath::Sqrt(gDeviation);
+}
+
+void GOpenGLBoard::DoSetShapeScale(const GReal Scale) {
+
+	// a singular model-view matrix collapses shapes, any deviation is fine
+	GReal s = GMath::Max(Scale, G_EPSILON);
+
+	// the geometry cache keys shapes by deviation too, so the scale is rounded up to quarter octaves (tolerating
+	// rounding errors of the matrix); this way, slightly different scales share the same cached triangles
+	if (gGeometryCacheEnabled)
+		s = GMath::Pow((GReal)2, GMath::Ceil(4 * GMath::Log2(s) - (GReal)1e-3) / 4);
+
+	if (s != gShapeScale) {
+		gShapeScale = s;
+		UpdateShapeDeviation();
+	}
+}
+
+GBool GOpenGLBoard::DoClipMasksBox(GAABox2& Box) const {
+
+	// with a stencil overflow, the last masks have not been written
+	if (!gClipMasksSupport || !ClipEnabled() || gClipMasksBoxes.empty() ||
+		(gTopStencilValue == 0 && gScissorMasks.empty()) || gTopStencilValue >= gMaxTopStencilValue)
+		return G_FALSE;
+
+	GList<GAABox2>::const_iterator it = gClipMasksBoxes.begin();
+	GPoint2 pMin(it->Min()), pMax(it->Max());
+
+	for (++it; it != gClipMasksBoxes.end(); ++it) {
+		pMin[G_X] = GMath::Max(pMin[G_X], it->Min()[G_X]);
+		pMin[G_Y] = GMath::Max(pMin[G_Y], it->Min()[G_Y]);
+		pMax[G_X] = GMath::Min(pMax[G_X], it->Max()[G_X]);
+		pMax[G_Y] = GMath::Min(pMax[G_Y], it->Max()[G_Y]);
+	}
+	// an empty intersection is reduced to a single point, that is still a conservative bound
+	if (pMin[G_X] > pMax[G_X])
+		pMax[G_X] = pMin[G_X];
+	if (pMin[G_Y] > pMax[G_Y])
+		pMax[G_Y] = pMin[G_Y];
+	Box.SetMinMax(pMin, pMax);
+	return G_TRUE;
+}
+
 void GOpenGLBoard::DoSetRenderingQuality(const GRenderingQuality Quality) {
 
 	UpdateDeviation(Quality);
@@ -805,6 +865,17 @@ void GOpenGLBoard::DoClear(const GReal Red, const GReal Green, const GReal Blue,
     GLclampf blue = (GLclampf)GMath::Clamp(Blue, (GReal)0, (GReal)1);
 	GLclampf alpha = (GLclampf)GMath::Clamp(Alpha, (GReal)0, (GReal)1);
 
+	// a clear starts a new frame
+	gLastGrabStats = gGrabStats;
+	gGrabStats = GLGrabStatistics();
+
+	// a clear inside a group touches the whole group area
+	if (gGroupTracking)
+		GroupDamageDevice(gGroupDeviceBox);
+
+	// the clear must not be limited by scissor clip masks
+	ScissorDisable();
+
 	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 	glDepthMask(GL_TRUE);
 	glStencilMask((GLuint)(~0));
@@ -817,6 +888,7 @@ void GOpenGLBoard::DoClear(const GReal Red, const GReal Green, const GReal Blue,
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 			gTopStencilValue = 0;
 			gClipMasksBoxes.clear();
+			gScissorMasks.clear();
 		}
 		else
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -838,6 +910,8 @@ GBool GOpenGLBoard::SetGLClipEnabled(const GTargetMode Mode, const GClipOperatio
 		// write to the stencil using current clip operation
 		if (Mode == G_CLIP_MODE || Mode == G_CLIP_AND_CACHE_MODE) {
 
+			// stencil masks must be written entirely, independently of scissor masks
+			ScissorDisable();
 			switch (Operation) {
 				case G_REPLACE_CLIP:
 					// take care of an overflow into masks stack
@@ -857,6 +931,8 @@ GBool GOpenGLBoard::SetGLClipEnabled(const GTargetMode Mode, const GClipOperatio
 		}
 		// color mode
 		else {
+			// clip with scissor masks (if any) too
+			ScissorEnableTop();
 			if (!InsideGroup())
 				return G_FALSE;
 			else {
@@ -1118,20 +1194,18 @@ GError GOpenGLBoard::DoScreenShot(GPixelMap& Output, const GVectBase<GUInt32, 2>
 
 void GOpenGLBoard::UpdateBox(const GAABox2& Source, const GMatrix33& Matrix, GAABox2& Result) {
 
-	GPoint2 p0 = Source.Min();
-	GPoint2 p2 = Source.Max();
-	GPoint2 p1(p2[G_X], p0[G_Y]);
-	GPoint2 p3(p0[G_X], p2[G_Y]);
+	GPoint2 p[4];
 
-	GPoint2 q0 = Matrix * p0;
-	GPoint2 q1 = Matrix * p1;
-	GPoint2 q2 = Matrix * p2;
-	GPoint2 q3 = Matrix * p3;
+	p[0] = Source.Min();
+	p[2] = Source.Max();
+	p[1].Set(p[2][G_X], p[0][G_Y]);
+	p[3].Set(p[0][G_X], p[2][G_Y]);
 
 	// transform the box using model-view matrix
-	Result.SetMinMax(q0, q1);
-	Result.ExtendToInclude(q2);
-	Result.ExtendToInclude(q3);
+	GBulkXForm::XForm(Matrix, G_FALSE, p, p, 4);
+	Result.SetMinMax(p[0], p[1]);
+	Result.ExtendToInclude(p[2]);
+	Result.ExtendToInclude(p[3]);
 }
 
 void GOpenGLBoard::GLDisableShaders() {
@@ -42,19 +42,32 @@ namespace Amanith {
 //                        GOpenGLCacheBank
 // *********************************************************************
 
+// FNV-1a hash of a bytes sequence
+static inline void HashBytes(GUInt32& Hash, const void *Data, const GUInt32 Size) {
+
+	const GUChar8 *p = (const GUChar8 *)Data;
+	for (GUInt32 i = 0; i < Size; ++i) {
+		Hash ^= (GUInt32)p[i];
+		Hash *= 16777619;
+	}
+}
+
+// free the vertex buffer object of a cache slot
+static void DeleteCacheSlot(GOpenGLCacheSlot& Slot) {
+
+	if (Slot.VertexBuffer != 0) {
+		glDeleteBuffersARB(1, &Slot.VertexBuffer);
+		Slot.VertexBuffer = 0;
+	}
+}
+
 // invalidate the cache, freeing associated (video) memory
 void GOpenGLCacheBank::Invalidate() {
 
-	GOpenGLCacheSlot slot;
 	GUInt32 i, j = (GUInt32)gSlots.size();
 
-	for (i = 0; i < j; ++i) {
-		slot = gSlots[i];
-		if (slot.FillDisplayList != 0)
-			glDeleteLists(slot.FillDisplayList, 1);
-		if (slot.StrokeDisplayList != 0)
-			glDeleteLists(slot.StrokeDisplayList, 1);
-	}
+	for (i = 0; i < j; ++i)
+		DeleteCacheSlot(gSlots[i]);
 	gSlots.clear();
 }
 
@@ -79,22 +92,123 @@ GInt32 GOpenGLCacheBank::SlotsCount() const {
 //                             GOpenGLBoard
 // *********************************************************************
 
+void GOpenGLBoard::GLBegin(const GLenum Mode) {
+
+	if (!gRecordedVertices)
+		glBegin(Mode);
+	else {
+		G_ASSERT(Mode == GL_TRIANGLES || Mode == GL_POLYGON || Mode == GL_TRIANGLE_FAN || Mode == GL_TRIANGLE_STRIP);
+		gRecordedMode = Mode;
+		gRecordedFirst = (GUInt32)gRecordedVertices->size();
+	}
+}
+
+void GOpenGLBoard::GLEnd() {
+
+	if (!gRecordedVertices) {
+		glEnd();
+		return;
+	}
+
+	GDynArray<GLfloat>& v = *gRecordedVertices;
+	GUInt32 i, n = ((GUInt32)v.size() - gRecordedFirst) / 2;
+
+	if (gRecordedMode == GL_TRIANGLES) {
+		G_ASSERT((n % 3) == 0);
+		return;
+	}
+	if (n < 3) {
+		v.resize(gRecordedFirst);
+		return;
+	}
+	// strips are split into triangles made by consecutive vertices
+	if (gRecordedMode == GL_TRIANGLE_STRIP) {
+		v.resize(gRecordedFirst + (n - 2) * 6);
+		// walk backward, reading the three vertices before writing the triangle (they could overlap)
+		for (i = n - 1; i >= 2; --i) {
+			GUInt32 dst = gRecordedFirst + (i - 2) * 6;
+			GUInt32 src = gRecordedFirst + (i - 2) * 2;
+			GLfloat t[6] = { v[src], v[src + 1], v[src + 2], v[src + 3], v[src + 4], v[src + 5] };
+			for (GUInt32 j = 0; j < 6; ++j)
+				v[dst + j] = t[j];
+		}
+		return;
+	}
+	// convex polygons and fans are split into triangles that share the first vertex
+	v.resize(gRecordedFirst + (n - 2) * 6);
+	// walk backward, so that each vertex is read before being overwritten
+	for (i = n - 1; i >= 2; --i) {
+		GUInt32 dst = gRecordedFirst + (i - 2) * 6;
+		GUInt32 src = gRecordedFirst + (i - 1) * 2;
+		v[dst + 4] = v[src + 2];
+		v[dst + 5] = v[src + 3];
+		v[dst + 2] = v[src];
+		v[dst + 3] = v[src + 1];
+		v[dst] = v[gRecordedFirst];
+		v[dst + 1] = v[gRecordedFirst + 1];
+	}
+}
+
+void GOpenGLBoard::BuildCacheSlot(GOpenGLCacheSlot& Slot, const GDynArray<GLfloat>& Vertices,
+								  const GLsizei FillVerticesCount) {
+
+	G_ASSERT((Vertices.size() % 2) == 0);
+
+	GLsizei n = (GLsizei)(Vertices.size() / 2);
+
+	G_ASSERT(FillVerticesCount <= n);
+	Slot.FillVerticesCount = FillVerticesCount;
+	Slot.StrokeVerticesCount = n - FillVerticesCount;
+	if (n == 0)
+		return;
+
+	if (gVertexBufferSupport) {
+		glGenBuffersARB(1, &Slot.VertexBuffer);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, Slot.VertexBuffer);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)(Vertices.size() * sizeof(GLfloat)), &Vertices[0],
+						GL_STATIC_DRAW_ARB);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	}
+	else
+		Slot.Vertices = Vertices;
+}
+
+void GOpenGLBoard::DrawGLCacheSlot(const GOpenGLCacheSlot& Slot, const GBool Fill) {
+
+	GLint first = (Fill) ? 0 : Slot.FillVerticesCount;
+	GLsizei count = (Fill) ? Slot.FillVerticesCount : Slot.StrokeVerticesCount;
+
+	if (count == 0)
+		return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (Slot.VertexBuffer != 0) {
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, Slot.VertexBuffer);
+		glVertexPointer(2, GL_FLOAT, 0, NULL);
+		glDrawArrays(GL_TRIANGLES, first, count);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	}
+	else {
+		glVertexPointer(2, GL_FLOAT, 0, &Slot.Vertices[0]);
+		glDrawArrays(GL_TRIANGLES, first, count);
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 void GOpenGLBoard::DoDrawCacheSlot(const GDrawStyle& Style, const GOpenGLCacheSlot& CacheSlot) {
 
 	// if we had to draw nothing, just exit
-	if (CacheSlot.FillDisplayList == 0 && CacheSlot.StrokeDisplayList == 0)
+	if (CacheSlot.FillVerticesCount == 0 && CacheSlot.StrokeVerticesCount == 0)
 		return;
 	// draw cached primitives on cache has no effects
 	if (TargetMode() == G_CACHE_MODE)
 		return;
 
 #define DRAW_STROKE \
-	G_ASSERT(CacheSlot.StrokeDisplayList != 0); \
-	glCallList(CacheSlot.StrokeDisplayList);
+	DrawGLCacheSlot(CacheSlot, G_FALSE);
 
 #define DRAW_FILL \
-	if (CacheSlot.FillDisplayList != 0) \
-	glCallList(CacheSlot.FillDisplayList);
+	DrawGLCacheSlot(CacheSlot, G_TRUE);
 
 	// calculate bound box
 	GAABox2 tmpBox(CacheSlot.Box);
@@ -103,6 +217,9 @@ void GOpenGLBoard::DoDrawCacheSlot(const GDrawStyle& Style, const GOpenGLCacheSl
 
 	if (TargetMode() == G_CLIP_MODE || TargetMode() == G_CLIP_AND_CACHE_MODE) {
 
+		if (!gClipMasksSupport)
+			return;
+
 		glMatrixMode(GL_MODELVIEW);
 		SetGLModelViewMatrix(ModelViewMatrix());
 
@@ -146,6 +263,8 @@ void GOpenGLBoard::DoDrawCacheSlot(const GDrawStyle& Style, const GOpenGLCacheSl
 	// calculate/update the shape box, according to model-view matrix
 	GAABox2 mvBox;
 	UpdateBox(tmpBox, ModelViewMatrix(), mvBox);
+	// inside a group, save the background that this drawing is going to touch
+	GroupDamage(Style, tmpBox);
 
 	if (Style.FillEnabled() && Style.FillCompOp() != G_DST_OP) {
 
@@ -311,6 +430,215 @@ void GOpenGLBoard::DoDrawCacheSlots(GDrawStyle& Style, const GInt32 FirstSlotInd
 		DoDrawCacheSlot(Style, bank->gSlots[i]);
 }
 
+void GOpenGLBoard::GeometryKeyBegin(const GDrawStyle& Style, const GUInt32 Kind) {
+
+	gGeometryKey.clear();
+	gGeometryKeyValid = (gGeometryCacheEnabled && !CachingEnabled());
+	if (!gGeometryKeyValid)
+		return;
+
+	GUInt32 tags[3];
+	tags[0] = Kind;
+	tags[1] = (Style.FillEnabled()) ? (GUInt32)Style.FillRule() + 1 : 0;
+	tags[2] = (Style.StrokeEnabled()) ? 1 : 0;
+	GeometryKeyAppend(tags, sizeof(tags));
+	// flattening deviation, it determines round joins and caps too
+	GeometryKeyAppend(&gDeviation, sizeof(GReal));
+
+	if (Style.StrokeEnabled()) {
+		GUInt32 strokeTags[4];
+		GReal strokeParams[3];
+
+		strokeTags[0] = (GUInt32)Style.StrokeStartCapStyle();
+		strokeTags[1] = (GUInt32)Style.StrokeEndCapStyle();
+		strokeTags[2] = (GUInt32)Style.StrokeJoinStyle();
+		strokeTags[3] = (GUInt32)Style.StrokeStyle();
+		strokeParams[0] = Style.StrokeThickness();
+		strokeParams[1] = Style.StrokeMiterLimit();
+		strokeParams[2] = 0;
+		GeometryKeyAppend(strokeTags, sizeof(strokeTags));
+		if (Style.StrokeStyle() == G_DASHED_STROKE) {
+			strokeParams[2] = Style.StrokeDashPhase();
+			const GDynArray<GReal>& pattern = Style.StrokeDashPattern();
+			if (pattern.size() > 0)
+				GeometryKeyAppend(&pattern[0], (GUInt32)(pattern.size() * sizeof(GReal)));
+		}
+		GeometryKeyAppend(strokeParams, sizeof(strokeParams));
+	}
+}
+
+void GOpenGLBoard::GeometryKeyAppend(const void *Data, const GUInt32 Size) {
+
+	if (!gGeometryKeyValid || Size == 0)
+		return;
+
+	const GUChar8 *p = (const GUChar8 *)Data;
+	gGeometryKey.insert(gGeometryKey.end(), p, p + Size);
+}
+
+void GOpenGLBoard::GeometryKeyAppend(const GDynArray<GPoint2>& Points) {
+
+	GUInt32 n = (GUInt32)Points.size();
+
+	GeometryKeyAppend(&n, sizeof(GUInt32));
+	if (n > 0)
+		GeometryKeyAppend(&Points[0], n * sizeof(GPoint2));
+}
+
+void GOpenGLBoard::GeometryKeyAppend(const GDynArray<GInt32>& Values) {
+
+	GUInt32 n = (GUInt32)Values.size();
+
+	GeometryKeyAppend(&n, sizeof(GUInt32));
+	if (n > 0)
+		GeometryKeyAppend(&Values[0], n * sizeof(GInt32));
+}
+
+void GOpenGLBoard::GeometryKeyAppend(const GDynArray<GBool>& Flags) {
+
+	GUInt32 i, n = (GUInt32)Flags.size();
+	GUChar8 f;
+
+	GeometryKeyAppend(&n, sizeof(GUInt32));
+	for (i = 0; i < n; ++i) {
+		f = (Flags[i]) ? 1 : 0;
+		GeometryKeyAppend(&f, 1);
+	}
+}
+
+GUInt32 GOpenGLBoard::GeometryIndexLowerBound(const GUInt32 Hash) const {
+
+	GUInt32 lo = 0, hi = (GUInt32)gGeometryCacheIndex.size(), mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (gGeometryCacheIndex[mid].Hash < Hash)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+GBool GOpenGLBoard::DrawCachedGeometry(GDrawStyle& Style, GBool& Store) {
+
+	Store = G_FALSE;
+	if (!gGeometryKeyValid)
+		return G_FALSE;
+
+	GUInt32 hash = 2166136261U;
+	HashBytes(hash, &gGeometryKey[0], (GUInt32)gGeometryKey.size());
+	gGeometryKeyHash = hash;
+
+	// hash collisions are resolved comparing keys
+	GUInt32 i = GeometryIndexLowerBound(hash), j = (GUInt32)gGeometryCacheIndex.size();
+	for (; i < j && gGeometryCacheIndex[i].Hash == hash; ++i) {
+		GList<GLGeometryCacheEntry>::iterator it = gGeometryCacheIndex[i].Entry;
+		if (it->Key == gGeometryKey) {
+			// move the entry in front of the most recently used list
+			if (it != gGeometryCache.begin())
+				gGeometryCache.splice(gGeometryCache.begin(), gGeometryCache, it);
+			gGeometryCacheStats.Hits++;
+			UpdateStyle((GOpenGLDrawStyle&)Style);
+			DoDrawCacheSlot(Style, it->Slot);
+			return G_TRUE;
+		}
+	}
+
+	gGeometryCacheStats.Misses++;
+	// shapes are cached the second time they are drawn, so that one-off shapes do not pollute the cache
+	GUInt32& seen = gGeometryCacheSeen[hash & 255];
+	if (seen == hash)
+		Store = G_TRUE;
+	else
+		seen = hash;
+	return G_FALSE;
+}
+
+const GOpenGLCacheSlot *GOpenGLBoard::StoreGeometry(const GDynArray<GLfloat>& Vertices, const GLsizei FillVerticesCount,
+												   const GAABox2& Box) {
+
+	GUInt32 bytes = (GUInt32)(sizeof(GLGeometryCacheEntry) + sizeof(GLGeometryCacheIndex) + gGeometryKey.size() +
+							  Vertices.size() * sizeof(GLfloat));
+
+	if (bytes > gGeometryCacheBudget)
+		return NULL;
+	// make room for the new entry
+	EvictGeometry(gGeometryCacheBudget - bytes);
+
+	gGeometryCache.push_front(GLGeometryCacheEntry());
+	GLGeometryCacheEntry& entry = gGeometryCache.front();
+	entry.Hash = gGeometryKeyHash;
+	entry.Key = gGeometryKey;
+	entry.Bytes = bytes;
+	entry.Slot.Box = Box;
+	BuildCacheSlot(entry.Slot, Vertices, FillVerticesCount);
+
+	GLGeometryCacheIndex index;
+	index.Hash = entry.Hash;
+	index.Entry = gGeometryCache.begin();
+	gGeometryCacheIndex.insert(gGeometryCacheIndex.begin() + GeometryIndexLowerBound(entry.Hash), index);
+
+	gGeometryCacheStats.EntriesCount++;
+	gGeometryCacheStats.UsedBytes += bytes;
+	return &entry.Slot;
+}
+
+void GOpenGLBoard::EvictGeometry(const GUInt32 MaxBytes) {
+
+	while (gGeometryCacheStats.UsedBytes > MaxBytes && !gGeometryCache.empty()) {
+
+		GList<GLGeometryCacheEntry>::iterator it = gGeometryCache.end();
+		--it;
+		GUInt32 i = GeometryIndexLowerBound(it->Hash), j = (GUInt32)gGeometryCacheIndex.size();
+		for (; i < j; ++i) {
+			if (gGeometryCacheIndex[i].Entry == it) {
+				gGeometryCacheIndex.erase(gGeometryCacheIndex.begin() + i);
+				break;
+			}
+		}
+		G_ASSERT(i < j);
+		DeleteCacheSlot(it->Slot);
+		gGeometryCacheStats.UsedBytes -= it->Bytes;
+		gGeometryCacheStats.EntriesCount--;
+		gGeometryCacheStats.Evictions++;
+		gGeometryCache.erase(it);
+	}
+}
+
+void GOpenGLBoard::InvalidateGeometryCache() {
+
+	GList<GLGeometryCacheEntry>::iterator it = gGeometryCache.begin();
+
+	for (; it != gGeometryCache.end(); ++it)
+		DeleteCacheSlot(it->Slot);
+	gGeometryCache.clear();
+	gGeometryCacheIndex.clear();
+	std::memset(gGeometryCacheSeen, 0, sizeof(gGeometryCacheSeen));
+	gGeometryCacheStats.EntriesCount = 0;
+	gGeometryCacheStats.UsedBytes = 0;
+}
+
+void GOpenGLBoard::ResetGeometryCacheStatistics() {
+
+	gGeometryCacheStats.Hits = 0;
+	gGeometryCacheStats.Misses = 0;
+	gGeometryCacheStats.Evictions = 0;
+}
+
+void GOpenGLBoard::SetGeometryCacheEnabled(const GBool Enabled) {
+
+	if (!Enabled)
+		InvalidateGeometryCache();
+	gGeometryCacheEnabled = Enabled;
+}
+
+void GOpenGLBoard::SetGeometryCacheBudget(const GUInt32 Bytes) {
+
+	gGeometryCacheBudget = Bytes;
+	EvictGeometry(Bytes);
+}
+
 GCacheBank *GOpenGLBoard::CreateCacheBank() {
 
 	GOpenGLCacheBank *bank = new(std::nothrow) GOpenGLCacheBank();
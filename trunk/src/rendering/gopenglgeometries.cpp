@@ -31,6 +31,7 @@
 #include "amanith/2d/gellipsecurve2d.h"
 #include "amanith/geometry/gxform.h"
 #include "amanith/geometry/gxformconv.h"
+#include "amanith/support/gsvgpathparser.h"
 
 
 /*!
@@ -40,6 +41,23 @@
 
 namespace Amanith {
 
+// drawing functions identifiers, used to build geometry cache keys
+enum GLGeometryKeyKind {
+	G_ROUNDRECT_GEOMETRY_KEY = 1,
+	G_QUADBEZIER_GEOMETRY_KEY,
+	G_CUBICBEZIER_GEOMETRY_KEY,
+	G_CENTERARC_GEOMETRY_KEY,
+	G_SVGARC_GEOMETRY_KEY,
+	G_ELLIPSE_GEOMETRY_KEY,
+	G_CIRCLE_GEOMETRY_KEY,
+	G_POLYGON_GEOMETRY_KEY,
+	G_CURVE_GEOMETRY_KEY,
+	G_CURVES_GEOMETRY_KEY,
+	G_SVGCOMMANDS_GEOMETRY_KEY,
+	G_SVGSTRING_GEOMETRY_KEY,
+	G_PATHDATA_GEOMETRY_KEY
+};
+
 inline GFillBehavior FillRuleToBehavior(const GFillRule Rule) {
 
 	switch(Rule) {
@@ -59,7 +77,7 @@ inline GFillBehavior FillRuleToBehavior(const GFillRule Rule) {
 
 GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool ClosedFill, const GBool ClosedStroke,
 								   const GJoinStyle FlattenJoinStyle, const GDynArray<GPoint2>& Points,
-								   const GBool Convex) {
+								   const GBool Convex, const GBool Store) {
 
 	// empty contours, or 1 point contour, lets exit immediately
 	if (Points.size() < 2) {
@@ -74,50 +92,26 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 	GUInt32 j = 0;
 	GAABox2 tmpBox;
 
-	#define DRAW_FILL_DOUBLE \
-		if (!Convex) { \
-			if (j > 0) { \
-				glBegin(GL_TRIANGLES); \
-				for (it = triangles.begin(); it != triangles.end(); ++it) { \
-					glVertex2dv(it->Data()); \
-					it++; \
-					glVertex2dv(it->Data()); \
-					it++; \
-					glVertex2dv(it->Data()); \
-				} \
-				glEnd(); \
-			} \
-		} \
-		else { \
-			glBegin(GL_POLYGON); \
-			for (it2 = Points.begin(); it2 != Points.end(); ++it2) { \
-				glVertex2dv(it2->Data()); \
-			} \
-			glEnd(); \
-		}
-
-	#define DRAW_FILL_FLOAT \
+	#define DRAW_FILL \
 		if (!Convex) { \
 			if (j > 0) { \
-				glBegin(GL_TRIANGLES); \
-				for (it = triangles.begin(); it != triangles.end(); ++it) { \
-					glVertex2dv(it->Data()); \
-					it++; \
-					glVertex2dv(it->Data()); \
-					it++; \
-					glVertex2dv(it->Data()); \
-				} \
-				glEnd(); \
+				GLBegin(GL_TRIANGLES); \
+				for (it = triangles.begin(); it != triangles.end(); ++it) \
+					GLVertex(*it); \
+				GLEnd(); \
 			} \
 		} \
 		else { \
-			glBegin(GL_POLYGON); \
+			GLBegin(GL_TRIANGLE_FAN); \
 			for (it2 = Points.begin(); it2 != Points.end(); ++it2) \
-				glVertex2fv(it2->Data()); \
-			glEnd(); \
+				GLVertex(*it2); \
+			GLEnd(); \
 		}
 
 	#define DRAW_STROKE \
+		if (convexStroke) \
+			DrawConvexStroke(gConvexStroke); \
+		else \
 		if (Style.StrokeStyle() == G_SOLID_STROKE) { \
 				DrawSolidStroke(Style.StrokeStartCapStyle(), Style.StrokeEndCapStyle(), \
 								FlattenJoinStyle, Style.StrokeMiterLimitMulThickness(), \
@@ -144,11 +138,48 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 	else
 		tmpBox.SetMinMax(Points);
 
+	// the stroke of a closed convex contour (rectangles, rounded rectangles, circles, ellipses) is drawn as a
+	// single triangle strip, instead of a polygon for each segment
+	GBool convexStroke = G_FALSE;
+	if (Convex && ClosedStroke && Style.StrokeEnabled() && Style.StrokeStyle() == G_SOLID_STROKE)
+		convexStroke = BuildConvexStroke(FlattenJoinStyle, Style.StrokeMiterLimitMulThickness(), Points,
+										 Style.StrokeThickness(), gConvexStroke);
+
 	// caching management
 	GInt32 slotIndex = G_DRAWBOARD_CACHE_NOT_WRITTEN;
 	GOpenGLCacheSlot cacheSlot;
 	GOpenGLCacheBank *cacheBank = (GOpenGLCacheBank *)CacheBank();
 
+	// store the shape inside the geometry cache and draw it from there, if needed
+	if (Store && (Style.StrokeEnabled() || ClosedFill)) {
+		gSlotVertices.clear();
+		gRecordedVertices = &gSlotVertices;
+		if (ClosedFill) {
+			DRAW_FILL
+		}
+		GLsizei fillVerticesCount = (GLsizei)(gSlotVertices.size() / 2);
+		if (Style.StrokeEnabled()) {
+			DRAW_STROKE
+		}
+		gRecordedVertices = NULL;
+
+		GAABox2 box(tmpBox);
+		if (Style.StrokeEnabled()) {
+			GPoint2 pMin(box.Min());
+			GPoint2 pMax(box.Max());
+			pMin[G_X] -= Style.StrokeThickness();
+			pMin[G_Y] -= Style.StrokeThickness();
+			pMax[G_X] += Style.StrokeThickness();
+			pMax[G_Y] += Style.StrokeThickness();
+			box.SetMinMax(pMin, pMax);
+		}
+		const GOpenGLCacheSlot *slot = StoreGeometry(gSlotVertices, fillVerticesCount, box);
+		if (slot) {
+			DoDrawCacheSlot(Style, *slot);
+			return slotIndex;
+		}
+	}
+
 	// cache the primitive, if needed
 	if (CachingEnabled()) {
 		if (!cacheBank) {
@@ -165,20 +196,14 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 			pMax[G_X] += Style.StrokeThickness();
 			pMax[G_Y] += Style.StrokeThickness();
 			cacheSlot.Box.SetMinMax(pMin, pMax);
-			// draw fill
-			cacheSlot.FillDisplayList = glGenLists(1);
-			glNewList(cacheSlot.FillDisplayList, GL_COMPILE);
-			#ifdef DOUBLE_REAL_TYPE
-				DRAW_FILL_DOUBLE
-			#else
-				DRAW_FILL_FLOAT
-			#endif
-			glEndList();
-			// draw stroke
-			cacheSlot.StrokeDisplayList = glGenLists(1);
-			glNewList(cacheSlot.StrokeDisplayList, GL_COMPILE);
+			// record fill and stroke
+			gSlotVertices.clear();
+			gRecordedVertices = &gSlotVertices;
+			DRAW_FILL
+			GLsizei fillVerticesCount = (GLsizei)(gSlotVertices.size() / 2);
 			DRAW_STROKE
-			glEndList();
+			gRecordedVertices = NULL;
+			BuildCacheSlot(cacheSlot, gSlotVertices, fillVerticesCount);
 			cacheBank->gSlots.push_back(cacheSlot);
 			slotIndex = (GInt32)cacheBank->gSlots.size() - 1;
 		}
@@ -203,11 +228,7 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 
 		// draw fill, using the model-view matrix
 		if (ClosedFill) {
-			#ifdef DOUBLE_REAL_TYPE
-				DRAW_FILL_DOUBLE
-			#else
-				DRAW_FILL_FLOAT
-			#endif
+			DRAW_FILL
 		}
 		// draw stroke, using the model-view matrix
 		if (Style.StrokeEnabled()) {
@@ -265,6 +286,8 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 	// calculate/update the shape box, according to model-view matrix
 	GAABox2 mvBox;
 	UpdateBox(tmpBox, ModelViewMatrix(), mvBox);
+	// inside a group, save the background that this drawing is going to touch
+	GroupDamage(Style, tmpBox);
 
 	if (ClosedFill && Style.FillCompOp() != G_DST_OP) {
 
@@ -292,11 +315,7 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 				StencilNoDepthWrite();
 				glMatrixMode(GL_MODELVIEW);
 				SetGLModelViewMatrix(ModelViewMatrix());
-				#ifdef DOUBLE_REAL_TYPE
-					DRAW_FILL_DOUBLE
-				#else
-					DRAW_FILL_FLOAT
-				#endif
+				DRAW_FILL
 			}
 			else
 			if (!stencilPass && depthPass) {
@@ -305,11 +324,7 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 				// use model-view matrix to draw the mask
 				glMatrixMode(GL_MODELVIEW);
 				SetGLModelViewMatrix(ModelViewMatrix());
-				#ifdef DOUBLE_REAL_TYPE
-					DRAW_FILL_DOUBLE
-				#else
-					DRAW_FILL_FLOAT
-				#endif
+				DRAW_FILL
 			}
 			else {
 				StencilEnableTop();
@@ -317,11 +332,7 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 				// use model-view matrix to draw the mask
 				glMatrixMode(GL_MODELVIEW);
 				SetGLModelViewMatrix(ModelViewMatrix());
-				#ifdef DOUBLE_REAL_TYPE
-					DRAW_FILL_DOUBLE
-				#else
-					DRAW_FILL_FLOAT
-				#endif
+				DRAW_FILL
 
 				StencilWhereDepthEqual();
 				// use identity to draw the logical box (already transformed with model-view matrix)
@@ -346,11 +357,7 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 			for (GUInt32 ii = 0; ii < stylePassesCount; ++ii) {
 				// draw fill, using specified style and model-view matrix
 				UseFillStyle(Style, ii);
-				#ifdef DOUBLE_REAL_TYPE
-					DRAW_FILL_DOUBLE
-				#else
-					DRAW_FILL_FLOAT
-				#endif
+				DRAW_FILL
 			}
 		}
 	}
@@ -429,14 +436,14 @@ GInt32 GOpenGLBoard::DrawGLPolygon(const GOpenGLDrawStyle& Style, const GBool Cl
 		}
 	}
 	return slotIndex;
-	#undef DRAW_FILL_FLOAT
-	#undef DRAW_FILL_DOUBLE
+	#undef DRAW_FILL
 	#undef DRAW_STROKE
 	return 0;
 }
 
 GInt32 GOpenGLBoard::DrawGLPolygons(const GDynArray<GPoint2>& Points, const GDynArray<GInt32>& PointsPerContour,
-									const GDynArray<GBool>& ClosedStrokes, const GOpenGLDrawStyle& Style) {
+									const GDynArray<GBool>& ClosedStrokes, const GOpenGLDrawStyle& Style,
+									const GBool Store) {
 
 	G_ASSERT(PointsPerContour.size() == ClosedStrokes.size());
 	G_ASSERT(PointsPerContour.size() > 0);
@@ -451,15 +458,10 @@ GInt32 GOpenGLBoard::DrawGLPolygons(const GDynArray<GPoint2>& Points, const GDyn
 	#define DRAW_FILL \
 		j = (GUInt32)triangles.size() / 3; \
 		if (j > 0) { \
-			glBegin(GL_TRIANGLES); \
-			for (itTriangles = triangles.begin(); itTriangles != triangles.end(); ++itTriangles) { \
-				glVertex2dv(itTriangles->Data()); \
-				itTriangles++; \
-				glVertex2dv(itTriangles->Data()); \
-				itTriangles++; \
-				glVertex2dv(itTriangles->Data()); \
-			} \
-			glEnd(); \
+			GLBegin(GL_TRIANGLES); \
+			for (itTriangles = triangles.begin(); itTriangles != triangles.end(); ++itTriangles) \
+				GLVertex(*itTriangles); \
+			GLEnd(); \
 		}
 
 	#define DRAW_STROKE \
@@ -501,6 +503,36 @@ GInt32 GOpenGLBoard::DrawGLPolygons(const GDynArray<GPoint2>& Points, const GDyn
 	GOpenGLCacheSlot cacheSlot;
 	GOpenGLCacheBank *cacheBank = (GOpenGLCacheBank *)CacheBank();
 
+	// store the shape inside the geometry cache and draw it from there, if needed
+	if (Store && (Style.StrokeEnabled() || Style.FillEnabled())) {
+		gSlotVertices.clear();
+		gRecordedVertices = &gSlotVertices;
+		if (Style.FillEnabled()) {
+			DRAW_FILL
+		}
+		GLsizei fillVerticesCount = (GLsizei)(gSlotVertices.size() / 2);
+		GAABox2 box(tmpBox);
+		if (Style.StrokeEnabled()) {
+			DRAW_STROKE
+			// stroke drawing includes 2-points contours inside the box
+			box = tmpBox;
+			GPoint2 pMin(box.Min());
+			GPoint2 pMax(box.Max());
+			pMin[G_X] -= Style.StrokeThickness();
+			pMin[G_Y] -= Style.StrokeThickness();
+			pMax[G_X] += Style.StrokeThickness();
+			pMax[G_Y] += Style.StrokeThickness();
+			box.SetMinMax(pMin, pMax);
+		}
+		gRecordedVertices = NULL;
+
+		const GOpenGLCacheSlot *slot = StoreGeometry(gSlotVertices, fillVerticesCount, box);
+		if (slot) {
+			DoDrawCacheSlot(Style, *slot);
+			return slotIndex;
+		}
+	}
+
 	// cache the primitive, if needed
 	if (CachingEnabled()) {
 		if (!cacheBank) {
@@ -508,16 +540,14 @@ GInt32 GOpenGLBoard::DrawGLPolygons(const GDynArray<GPoint2>& Points, const GDyn
 			G_DEBUG("DrawGLPolygons, cache bank NULL (not set)");
 		}
 		else {
-			// draw fill
-			cacheSlot.FillDisplayList = glGenLists(1);
-			glNewList(cacheSlot.FillDisplayList, GL_COMPILE);
+			// record fill and stroke
+			gSlotVertices.clear();
+			gRecordedVertices = &gSlotVertices;
 			DRAW_FILL
-			glEndList();
-			// draw stroke
-			cacheSlot.StrokeDisplayList = glGenLists(1);
-			glNewList(cacheSlot.StrokeDisplayList, GL_COMPILE);
+			GLsizei fillVerticesCount = (GLsizei)(gSlotVertices.size() / 2);
 			DRAW_STROKE
-			glEndList();
+			gRecordedVertices = NULL;
+			BuildCacheSlot(cacheSlot, gSlotVertices, fillVerticesCount);
 			// expand box to have always the stroke included
 			cacheSlot.Box = tmpBox;
 			GPoint2 pMin(cacheSlot.Box.Min());
@@ -607,6 +637,8 @@ GInt32 GOpenGLBoard::DrawGLPolygons(const GDynArray<GPoint2>& Points, const GDyn
 	// calculate/update the shape box, according to model-view matrix
 	GAABox2 mvBox;
 	UpdateBox(tmpBox, ModelViewMatrix(), mvBox);
+	// inside a group, save the background that this drawing is going to touch
+	GroupDamage(Style, tmpBox);
 
 	if (Style.FillEnabled() && Style.FillCompOp() != G_DST_OP) {
 
@@ -805,12 +837,12 @@ GInt32 GOpenGLBoard::DoDrawLine(GDrawStyle& Style, const GPoint2& P0, const GPoi
 		}
 		else {
 			cacheSlot.Box = tmpBox;
-			cacheSlot.FillDisplayList = 0;
-			cacheSlot.StrokeDisplayList = glGenLists(1);
-			glNewList(cacheSlot.StrokeDisplayList, GL_COMPILE);
-			// draw line segment inside cache slot
+			// record line segment inside cache slot
+			gSlotVertices.clear();
+			gRecordedVertices = &gSlotVertices;
 			DRAW_STROKE
-			glEndList();
+			gRecordedVertices = NULL;
+			BuildCacheSlot(cacheSlot, gSlotVertices, 0);
 			cacheBank->gSlots.push_back(cacheSlot);
 			slotIndex = (GInt32)cacheBank->gSlots.size() - 1;
 		}
@@ -825,6 +857,8 @@ GInt32 GOpenGLBoard::DoDrawLine(GDrawStyle& Style, const GPoint2& P0, const GPoi
 	// calculate/update the shape box, according to model-view matrix
 	GAABox2 mvBox;
 	UpdateBox(tmpBox, ModelViewMatrix(), mvBox);
+	// inside a group, save the background that this drawing is going to touch
+	GroupDamage(s, tmpBox);
 
 	// manage stencil test and operation for G_CLIP_MODE and G_CLIP_AND_CACHE_MODE; the returned value
 	// has sense for other modes
@@ -959,6 +993,9 @@ GInt32 GOpenGLBoard::DoDrawRectangle(GDrawStyle& Style, const GPoint2& MinCorner
 
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
+	// a rectangular clip mask can be realized through the scissor test
+	if (PushScissorClipMask((const GOpenGLDrawStyle&)Style, MinCorner, MaxCorner))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
 	// draw polyline
 	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, Style.StrokeJoinStyle(), pts, G_TRUE);
 }
@@ -973,6 +1010,17 @@ GInt32 GOpenGLBoard::DoDrawRoundRectangle(GDrawStyle& Style, const GPoint2& MinC
 
 	G_ASSERT(ArcWidth > 0 && ArcHeight > 0);
 
+	GBool storeGeometry;
+	GReal arcs[2] = { ArcWidth, ArcHeight };
+
+	// draw the shape from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_ROUNDRECT_GEOMETRY_KEY);
+	GeometryKeyAppend(&MinCorner, sizeof(GPoint2));
+	GeometryKeyAppend(&MaxCorner, sizeof(GPoint2));
+	GeometryKeyAppend(arcs, sizeof(arcs));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
 	GReal radius = GMath::Max(ArcWidth, ArcHeight);
 	GReal dev = GMath::Clamp(gFlateness, G_EPSILON, radius - (G_EPSILON * radius));
 	GUInt32 n = 3;
@@ -1042,13 +1090,23 @@ GInt32 GOpenGLBoard::DoDrawRoundRectangle(GDrawStyle& Style, const GPoint2& MinC
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polyline
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, G_BEVEL_JOIN, pts, G_TRUE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, G_BEVEL_JOIN, pts, G_TRUE,
+						 storeGeometry);
 }
 
 GInt32 GOpenGLBoard::DoDrawBezier(GDrawStyle& Style, const GPoint2& P0, const GPoint2& P1, const GPoint2& P2) {
 
 	GBezierCurve2D bez;
 	GDynArray<GPoint2> pts;
+	GBool storeGeometry;
+
+	// draw the curve from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_QUADBEZIER_GEOMETRY_KEY);
+	GeometryKeyAppend(&P0, sizeof(GPoint2));
+	GeometryKeyAppend(&P1, sizeof(GPoint2));
+	GeometryKeyAppend(&P2, sizeof(GPoint2));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
 
 	// flatten the curve
 	bez.SetPoints(P0, P1, P2);
@@ -1057,13 +1115,24 @@ GInt32 GOpenGLBoard::DoDrawBezier(GDrawStyle& Style, const GPoint2& P0, const GP
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polyline
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, G_BEVEL_JOIN, pts, G_TRUE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, G_BEVEL_JOIN, pts, G_TRUE,
+						 storeGeometry);
 }
 
 GInt32 GOpenGLBoard::DoDrawBezier(GDrawStyle& Style, const GPoint2& P0, const GPoint2& P1, const GPoint2& P2, const GPoint2& P3) {
 
 	GBezierCurve2D bez;
 	GDynArray<GPoint2> pts;
+	GBool storeGeometry;
+
+	// draw the curve from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_CUBICBEZIER_GEOMETRY_KEY);
+	GeometryKeyAppend(&P0, sizeof(GPoint2));
+	GeometryKeyAppend(&P1, sizeof(GPoint2));
+	GeometryKeyAppend(&P2, sizeof(GPoint2));
+	GeometryKeyAppend(&P3, sizeof(GPoint2));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
 
 	// flatten the curve
 	bez.SetPoints(P0, P1, P2, P3);
@@ -1072,7 +1141,8 @@ GInt32 GOpenGLBoard::DoDrawBezier(GDrawStyle& Style, const GPoint2& P0, const GP
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polyline
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, Style.StrokeJoinStyle(), pts, G_FALSE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, Style.StrokeJoinStyle(), pts, G_FALSE,
+						 storeGeometry);
 }
 
 GInt32 GOpenGLBoard::DoDrawEllipseArc(GDrawStyle& Style, const GPoint2& Center, const GReal XSemiAxisLength,
@@ -1081,6 +1151,16 @@ GInt32 GOpenGLBoard::DoDrawEllipseArc(GDrawStyle& Style, const GPoint2& Center,
 
 	GEllipseCurve2D ellipse;
 	GDynArray<GPoint2> pts;
+	GBool storeGeometry;
+	GReal params[5] = { XSemiAxisLength, YSemiAxisLength, OffsetRotation, StartAngle, EndAngle };
+
+	// draw the arc from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_CENTERARC_GEOMETRY_KEY);
+	GeometryKeyAppend(&Center, sizeof(GPoint2));
+	GeometryKeyAppend(params, sizeof(params));
+	GeometryKeyAppend(&CCW, sizeof(GBool));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
 
 	// flatten the curve
 	ellipse.SetEllipse(Center, XSemiAxisLength, YSemiAxisLength, OffsetRotation, StartAngle, EndAngle, CCW);
@@ -1089,7 +1169,8 @@ GInt32 GOpenGLBoard::DoDrawEllipseArc(GDrawStyle& Style, const GPoint2& Center,
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polyline
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, G_BEVEL_JOIN, pts, G_TRUE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, G_BEVEL_JOIN, pts, G_TRUE,
+						 storeGeometry);
 }
 
 GInt32 GOpenGLBoard::DoDrawEllipseArc(GDrawStyle& Style, const GPoint2& P0, const GPoint2& P1, const GReal XSemiAxisLength, const GReal YSemiAxisLength,
@@ -1097,6 +1178,18 @@ GInt32 GOpenGLBoard::DoDrawEllipseArc(GDrawStyle& Style, const GPoint2& P0, cons
 
 	GEllipseCurve2D ellipse;
 	GDynArray<GPoint2> pts;
+	GBool storeGeometry;
+	GReal params[3] = { XSemiAxisLength, YSemiAxisLength, OffsetRotation };
+	GBool flags[2] = { LargeArc, CCW };
+
+	// draw the arc from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_SVGARC_GEOMETRY_KEY);
+	GeometryKeyAppend(&P0, sizeof(GPoint2));
+	GeometryKeyAppend(&P1, sizeof(GPoint2));
+	GeometryKeyAppend(params, sizeof(params));
+	GeometryKeyAppend(flags, sizeof(flags));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
 
 	// flatten the curve
 	ellipse.SetEllipse(P0, P1, XSemiAxisLength, YSemiAxisLength, OffsetRotation, LargeArc, CCW);
@@ -1105,13 +1198,25 @@ GInt32 GOpenGLBoard::DoDrawEllipseArc(GDrawStyle& Style, const GPoint2& P0, cons
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polyline
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, G_BEVEL_JOIN, pts, G_TRUE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, G_BEVEL_JOIN, pts, G_TRUE,
+						 storeGeometry);
 }
 
 // here we are sure that semi-axes lengths are greater than 0
 GInt32 GOpenGLBoard::DoDrawEllipse(GDrawStyle& Style, const GPoint2& Center, const GReal XSemiAxisLength, const GReal YSemiAxisLength) {
 
 	G_ASSERT(XSemiAxisLength > 0 && YSemiAxisLength > 0);
+
+	GBool storeGeometry;
+	GReal axes[2] = { XSemiAxisLength, YSemiAxisLength };
+
+	// draw the ellipse from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_ELLIPSE_GEOMETRY_KEY);
+	GeometryKeyAppend(&Center, sizeof(GPoint2));
+	GeometryKeyAppend(axes, sizeof(axes));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
 	GReal radius = GMath::Max(XSemiAxisLength, YSemiAxisLength);
 
 	GReal dev = GMath::Clamp(gFlateness, G_EPSILON, radius - (G_EPSILON * radius));
@@ -1142,12 +1247,22 @@ GInt32 GOpenGLBoard::DoDrawEllipse(GDrawStyle& Style, const GPoint2& Center, con
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polygon
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, G_BEVEL_JOIN, pts, G_TRUE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, G_BEVEL_JOIN, pts, G_TRUE,
+						 storeGeometry);
 }
 
 // here we are sure that Radius is greater than 0
 GInt32 GOpenGLBoard::DoDrawCircle(GDrawStyle& Style, const GPoint2& Center, const GReal Radius) {
 
+	GBool storeGeometry;
+
+	// draw the circle from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_CIRCLE_GEOMETRY_KEY);
+	GeometryKeyAppend(&Center, sizeof(GPoint2));
+	GeometryKeyAppend(&Radius, sizeof(GReal));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
 	GReal dev = GMath::Clamp(gFlateness, G_EPSILON, Radius - (G_EPSILON * Radius));
 	GUInt32 n = 4;
 
@@ -1174,37 +1289,56 @@ GInt32 GOpenGLBoard::DoDrawCircle(GDrawStyle& Style, const GPoint2& Center, cons
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polygon
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, G_BEVEL_JOIN, pts, G_TRUE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_TRUE, G_BEVEL_JOIN, pts, G_TRUE,
+						 storeGeometry);
 }
 
 GInt32 GOpenGLBoard::DoDrawPolygon(GDrawStyle& Style, const GDynArray<GPoint2>& Points, const GBool Closed) {
 
+	GBool storeGeometry;
+
+	// draw the polygon from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_POLYGON_GEOMETRY_KEY);
+	GeometryKeyAppend(Points);
+	GeometryKeyAppend(&Closed, sizeof(GBool));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 	// draw polygon
-	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), Closed, Style.StrokeJoinStyle(), Points, G_FALSE);
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), Closed, Style.StrokeJoinStyle(), Points, G_FALSE,
+						 storeGeometry);
 }
 
 GInt32 GOpenGLBoard::DoDrawPath(GDrawStyle& Style, const GCurve2D& Curve) {
 
 	GDynArray<GPoint2> pts;
+	GBool closed = G_FALSE, storeGeometry;
 
 	// update style
 	UpdateStyle((GOpenGLDrawStyle&)Style);
 
-	if (Curve.ClassID() != G_PATH2D_CLASSID && !Curve.IsOfType(G_PATH2D_CLASSID)) {
-		// flatten the curve
+	// flatten the curve
+	if (Curve.ClassID() != G_PATH2D_CLASSID && !Curve.IsOfType(G_PATH2D_CLASSID))
 		Curve.Flatten(pts, gDeviation, G_TRUE);
-		// draw polyline
-		return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), G_FALSE, Style.StrokeJoinStyle(), pts, G_FALSE);
-	}
 	else {
 		const GPath2D& p = (const GPath2D&)Curve;
-		// flatten the curve
 		p.Flatten(pts, gDeviation, G_TRUE);
-		// draw polyline
-		return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), p.IsClosed(), Style.StrokeJoinStyle(), pts, G_FALSE);
+		closed = p.IsClosed();
 	}
+
+	// curves do not expose a compact description, so the geometry cache is keyed on flattened points; a hit
+	// skips tessellation and stroke generation
+	GeometryKeyBegin(Style, G_CURVE_GEOMETRY_KEY);
+	GeometryKeyAppend(pts);
+	GeometryKeyAppend(&closed, sizeof(GBool));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
+	// draw polyline
+	return DrawGLPolygon((const GOpenGLDrawStyle&)Style, Style.FillEnabled(), closed, Style.StrokeJoinStyle(), pts, G_FALSE,
+						 storeGeometry);
 }
 
 // here we are sure that we have at least one curve
@@ -1244,10 +1378,19 @@ GInt32 GOpenGLBoard::DoDrawPaths(GDrawStyle& Style, const GDynArray<GCurve2D *>&
 		return G_INVALID_PARAMETER;
 	}
 
+	// the geometry cache is keyed on flattened points, like in DoDrawPath()
+	GBool storeGeometry;
+	GeometryKeyBegin(Style, G_CURVES_GEOMETRY_KEY);
+	GeometryKeyAppend(pts);
+	GeometryKeyAppend(ptsPerContour);
+	GeometryKeyAppend(closedStroke);
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
 	// update style
 	UpdateStyle(s);
 	// draw polygons
-	return DrawGLPolygons(pts, ptsPerContour, closedStroke, s);
+	return DrawGLPolygons(pts, ptsPerContour, closedStroke, s, storeGeometry);
 }
 
 
@@ -1255,6 +1398,8 @@ GInt32 GOpenGLBoard::DoDrawPaths(GDrawStyle& Style, const GDynArray<GCurve2D *>&
 void GOpenGLBoard::BeginPaths() {
 
 	if (!gInsideSVGPaths) {
+		// path commands are flattened as they come, so the scale must be known from the start
+		DoSetShapeScale(ModelViewScale());
 		gSVGPathPoints.clear();
 		gSVGPathPointsPerContour.clear();
 		gSVGPathClosedStrokes.clear();
@@ -1491,11 +1636,99 @@ GInt32 GOpenGLBoard::EndPaths() {
 	}
 
 	GOpenGLDrawStyle *s = (GOpenGLDrawStyle *)CurrentStyle();
+
+	// the geometry cache is keyed on flattened points, because commands have been flattened while issued
+	GBool storeGeometry;
+	GeometryKeyBegin(*s, G_SVGCOMMANDS_GEOMETRY_KEY);
+	GeometryKeyAppend(gSVGPathPoints);
+	GeometryKeyAppend(gSVGPathPointsPerContour);
+	GeometryKeyAppend(gSVGPathClosedStrokes);
+	if (DrawCachedGeometry(*s, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
 	// update style
 	UpdateStyle(*s);
 	// draw polygons
-	return DrawGLPolygons(gSVGPathPoints, gSVGPathPointsPerContour, gSVGPathClosedStrokes, *s);
+	return DrawGLPolygons(gSVGPathPoints, gSVGPathPointsPerContour, gSVGPathClosedStrokes, *s, storeGeometry);
 }
 
+GInt32 GOpenGLBoard::DoDrawSVGPaths(GDrawStyle& Style, const GChar8 *Begin, const GChar8 *End,
+									const GAnglesMeasureUnit AnglesMeasureUnits) {
+
+	// inside an open block, data must be merged with the current path
+	if (gInsideSVGPaths)
+		return GDrawBoard::DoDrawSVGPaths(Style, Begin, End, AnglesMeasureUnits);
+
+	GBool storeGeometry;
+
+	// draw the paths from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_SVGSTRING_GEOMETRY_KEY);
+	GeometryKeyAppend(&AnglesMeasureUnits, sizeof(GAnglesMeasureUnit));
+	GeometryKeyAppend(Begin, (GUInt32)(End - Begin));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
+	gSVGPathPoints.clear();
+	gSVGPathPointsPerContour.clear();
+	gSVGPathClosedStrokes.clear();
+
+	// like SVG specifications say, everything before an error is drawn
+	if (GSVGPathParser::Flatten(Begin, End, gDeviation, gSVGPathPoints, gSVGPathPointsPerContour,
+								gSVGPathClosedStrokes, AnglesMeasureUnits) != G_NO_ERROR)
+		G_DEBUG("DrawPaths, SVG path data contains errors");
+
+	// empty contours, or 1 point contour, lets exit immediately
+	if (gSVGPathPoints.size() < 2) {
+		G_DEBUG("DrawPaths, empty contours, or 1 point contour");
+		return G_INVALID_PARAMETER;
+	}
+
+	GOpenGLDrawStyle& s = (GOpenGLDrawStyle&)Style;
+	// update style
+	UpdateStyle(s);
+	// draw polygons
+	return DrawGLPolygons(gSVGPathPoints, gSVGPathPointsPerContour, gSVGPathClosedStrokes, s, storeGeometry);
+}
+
+
+GInt32 GOpenGLBoard::DoDrawPathData(GDrawStyle& Style, const GPathData& Data) {
+
+	// inside an open block, data must be merged with the current path
+	if (gInsideSVGPaths)
+		return GDrawBoard::DoDrawPathData(Style, Data);
+
+	GBool storeGeometry;
+	const GDynArray<GUChar8>& verbs = Data.Verbs();
+	const GDynArray<GReal>& angles = Data.ArcAngles();
+	GUInt32 sizes[2] = { (GUInt32)verbs.size(), (GUInt32)angles.size() };
+
+	// draw the path from the geometry cache, if possible
+	GeometryKeyBegin(Style, G_PATHDATA_GEOMETRY_KEY);
+	GeometryKeyAppend(sizes, sizeof(sizes));
+	GeometryKeyAppend(Data.Points());
+	if (sizes[0] > 0)
+		GeometryKeyAppend(&verbs[0], sizes[0]);
+	if (sizes[1] > 0)
+		GeometryKeyAppend(&angles[0], sizes[1] * (GUInt32)sizeof(GReal));
+	if (DrawCachedGeometry(Style, storeGeometry))
+		return G_DRAWBOARD_CACHE_NOT_WRITTEN;
+
+	gSVGPathPoints.clear();
+	gSVGPathPointsPerContour.clear();
+	gSVGPathClosedStrokes.clear();
+	Data.Flatten(gDeviation, gSVGPathPoints, gSVGPathPointsPerContour, gSVGPathClosedStrokes);
+
+	// empty contours, or 1 point contour, lets exit immediately
+	if (gSVGPathPoints.size() < 2) {
+		G_DEBUG("DrawPaths, empty contours, or 1 point contour");
+		return G_INVALID_PARAMETER;
+	}
+
+	GOpenGLDrawStyle& s = (GOpenGLDrawStyle&)Style;
+	// update style
+	UpdateStyle(s);
+	// draw polygons
+	return DrawGLPolygons(gSVGPathPoints, gSVGPathPointsPerContour, gSVGPathClosedStrokes, s, storeGeometry);
+}
 
 };	// end namespace Amanith
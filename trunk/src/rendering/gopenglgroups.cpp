@@ -35,10 +35,21 @@
 
 namespace Amanith {
 
+// dimension (in pixels) of group tiles; the background of a group is saved in tile aligned strips
+#define G_GROUP_TILE_SIZE 64
+
+// build a device rectangle (maximum corner excluded)
+static GGenericAABox<GInt32, 2> DeviceRect(const GInt32 X0, const GInt32 Y0, const GInt32 X1, const GInt32 Y1) {
+
+	return GGenericAABox<GInt32, 2>(GPoint<GInt32, 2>(X0, Y0), GPoint<GInt32, 2>(X1, Y1));
+}
+
 void GOpenGLBoard::DoGroupBegin(const GAABox2& LogicBox) {
 
 
 	gIsFirstGroupDrawing = G_TRUE;
+	gGroupTracking = G_FALSE;
+	gGroupDamaged = G_FALSE;
 
 	// if group opacity is not supported by hardware or group compositing operation is DST_OP just exit; the case of
 	// CLEAR_OP is the same, a black box will be drawn inside DoGroupEnd()
@@ -49,51 +60,60 @@ void GOpenGLBoard::DoGroupBegin(const GAABox2& LogicBox) {
 	if (TargetMode() == G_CACHE_MODE || TargetMode() == G_CLIP_MODE || TargetMode() == G_CLIP_AND_CACHE_MODE)
 		return;
 
-	GrabFrameBuffer(LogicBox, gGLGroupRect);
-
-	GReal ll, rr, bb, tt;
-	Projection(ll, rr, bb, tt);
-	GMatrix44 m = GLProjectionMatrix(ll, rr, bb, tt, 1);
-	glMatrixMode(GL_PROJECTION);
-	glPushMatrix();
-	#ifdef DOUBLE_REAL_TYPE 
-		glLoadMatrixd((const GLdouble *)m.Data());
-	#else
-		glLoadMatrixf((const GLfloat *)m.Data());
-	#endif
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-
-	glDepthMask(GL_FALSE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-	GLDisableShaders();
-	SetGLColor(GVector4(1, 1, 1, 0));
-	// enable texture 2D
-	SELECT_AND_DISABLE_TUNIT(0)
-	glDisable(GL_BLEND);
-	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_PRIMARY_COLOR);
-	glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
-	glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_REPLACE);
-	
-	DrawGLBox(gGLGroupRect.gExpandedLogicBox);
+	// the background is not grabbed here; drawings save (and clear) it, tile by tile, as they touch the group
+	// area (see GroupDamage()), so that only the touched part of the group is copied and composited
+	GAABox2 clippedBox;
+	GrabDeviceBox(LogicBox, gGroupDeviceBox, clippedBox);
+
+	GUInt32 width = (GUInt32)(gGroupDeviceBox.Max()[G_X] - gGroupDeviceBox.Min()[G_X]);
+	GUInt32 height = (GUInt32)(gGroupDeviceBox.Max()[G_Y] - gGroupDeviceBox.Min()[G_Y]);
+	UpdateGrabBuffer(width, height, gGLGroupRect);
+
+	gGLGroupRect.Width = width;
+	gGLGroupRect.Height = height;
+	gGLGroupRect.OffsetX = 0;
+	gGLGroupRect.OffsetY = 0;
+	gGLGroupRect.IsEmpty = G_FALSE;
+	gGLGroupRect.gNotExpandedLogicBox = clippedBox;
+	GPoint2 q0 = PhysicalToLogical(GPoint<GInt32, 2>(gGroupDeviceBox.Min()));
+	GPoint2 q1 = PhysicalToLogical(GPoint<GInt32, 2>(gGroupDeviceBox.Max()));
+	gGLGroupRect.gExpandedLogicBox.SetMinMax(q0, q1);
+	gGroupTracking = G_TRUE;
 
 	// now intersect bounding box with current mask(s)
 	if (ClipEnabled()) {
+
+		GReal ll, rr, bb, tt;
+		Projection(ll, rr, bb, tt);
+		GMatrix44 m = GLProjectionMatrix(ll, rr, bb, tt, 1);
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		#ifdef DOUBLE_REAL_TYPE 
+			glLoadMatrixd((const GLdouble *)m.Data());
+		#else
+			glLoadMatrixf((const GLfloat *)m.Data());
+		#endif
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+
+		glDepthMask(GL_FALSE);
+		glDisable(GL_DEPTH_TEST);
+		GLDisableShaders();
+		SELECT_AND_DISABLE_TUNIT(0)
+		glDisable(GL_BLEND);
+
+		ScissorDisable();
 		StencilPush();
 		DrawGLBox(gGLGroupRect.gExpandedLogicBox);
 		// increment top stencil value because StencilPush checks for InsideGroup() flag; gTopStencilValue is
 		// incremented only if we are not inside e group (here we are already in a group, because we have just
 		// entered it)
 		gTopStencilValue++;
-	}
 
-	// exit from window-mode
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
+		// exit from window-mode
+		glMatrixMode(GL_PROJECTION);
+		glPopMatrix();
+	}
 }
 
 void GOpenGLBoard::DoGroupEnd() {
@@ -130,11 +150,31 @@ void GOpenGLBoard::DoGroupEnd() {
 	glDisable(GL_DEPTH_TEST);
 	glDepthMask(GL_FALSE);
 	glDisable(GL_STENCIL_TEST);
+	// group drawings have been already clipped, the background must be restored entirely
+	ScissorDisable();
 
-	GrabFrameBuffer(gGLGroupRect.gNotExpandedLogicBox, gCompositingBuffer);
+	// background of the touched part of the group, where the group content will be composited
+	GLGrabbedRect damagedBackground;
 
-	// use SRC_OP just to disable blend and enable all 4 channels color mask
-	ReplaceFrameBuffer(gGLGroupRect, G_SRC_OP, 0);
+	if (gGroupDamaged) {
+		// grab the group content, only where drawings have touched it
+		GLDisableShaders();
+		UpdateGrabBuffer((GUInt32)(gGroupDamageBox.Max()[G_X] - gGroupDamageBox.Min()[G_X]),
+						 (GUInt32)(gGroupDamageBox.Max()[G_Y] - gGroupDamageBox.Min()[G_Y]), gCompositingBuffer);
+		damagedBackground = GroupBackground(gGroupDamageBox);
+		CopyFrameBuffer(gGroupDamageBox, gCompositingBuffer, 0, 0);
+		gCompositingBuffer.Width = damagedBackground.Width;
+		gCompositingBuffer.Height = damagedBackground.Height;
+		gCompositingBuffer.OffsetX = 0;
+		gCompositingBuffer.OffsetY = 0;
+		gCompositingBuffer.IsEmpty = G_FALSE;
+		gCompositingBuffer.gExpandedLogicBox = damagedBackground.gExpandedLogicBox;
+		gCompositingBuffer.gNotExpandedLogicBox = damagedBackground.gNotExpandedLogicBox;
+
+		// restore the saved (and cleared) background; use SRC_OP just to disable blend and enable all 4 channels
+		// color mask
+		ReplaceFrameBuffer(GroupBackground(gGroupSavedBox), G_SRC_OP, 0);
+	}
 
 	glEnable(GL_STENCIL_TEST);
 	if (ClipEnabled()) {
@@ -147,35 +187,38 @@ void GOpenGLBoard::DoGroupEnd() {
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 	}
 
-	if (GroupCompOp() == G_CLEAR_OP) {
-
-		SELECT_AND_DISABLE_TUNIT(0)
-		GLDisableShaders();
-		glDisable(GL_BLEND);
-		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-		glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_PRIMARY_COLOR);
-		glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-		glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
-		glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_REPLACE);
-		SetGLColor(GVector4(0, 0, 0, 0));
-		DrawGLBox(gGLGroupRect.gExpandedLogicBox);
-	}
-	else {
-		// simulate the drawing of a rectangle with GroupCompOp() and only fill
-		GUInt32 stylePassesCount = 0;
-		GUInt32 fbPassesCount = 0;
-		CompOpPassesCount(GroupCompOp(), stylePassesCount, fbPassesCount);
-
-		for (GUInt32 ii = 0; ii < stylePassesCount; ++ii) {
-			UseGroupStyle(ii, gCompositingBuffer, gGLGroupRect);
-			G_ASSERT(gCompositingBuffer.Width == gGLGroupRect.Width);
-			G_ASSERT(gCompositingBuffer.Height == gGLGroupRect.Height);
-			G_ASSERT(gCompositingBuffer.Target == gGLGroupRect.Target);
-			DrawGrabbedRect(gCompositingBuffer, G_TRUE, G_TRUE, G_TRUE, G_FALSE);
+	// when nothing has been drawn inside the group, there's nothing to composite
+	if (gGroupDamaged) {
+		if (GroupCompOp() == G_CLEAR_OP) {
+
+			SELECT_AND_DISABLE_TUNIT(0)
+			GLDisableShaders();
+			glDisable(GL_BLEND);
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+			glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_PRIMARY_COLOR);
+			glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
+			glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
+			glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_REPLACE);
+			SetGLColor(GVector4(0, 0, 0, 0));
+			DrawGLBox(damagedBackground.gExpandedLogicBox);
+		}
+		else {
+			// simulate the drawing of a rectangle with GroupCompOp() and only fill
+			GUInt32 stylePassesCount = 0;
+			GUInt32 fbPassesCount = 0;
+			CompOpPassesCount(GroupCompOp(), stylePassesCount, fbPassesCount);
+
+			for (GUInt32 ii = 0; ii < stylePassesCount; ++ii) {
+				UseGroupStyle(ii, gCompositingBuffer, damagedBackground);
+				G_ASSERT(gCompositingBuffer.Width == damagedBackground.Width);
+				G_ASSERT(gCompositingBuffer.Height == damagedBackground.Height);
+				G_ASSERT(gCompositingBuffer.Target == damagedBackground.Target);
+				DrawGrabbedRect(gCompositingBuffer, G_TRUE, G_TRUE, G_TRUE, G_FALSE, &damagedBackground);
+			}
+			for (GUInt32 ii = 0; ii < fbPassesCount; ++ii)
+				ReplaceFrameBuffer(damagedBackground, GroupCompOp(), ii);
 		}
-		for (GUInt32 ii = 0; ii < fbPassesCount; ++ii)
-			ReplaceFrameBuffer(gGLGroupRect, GroupCompOp(), ii);
 	}
 
 
@@ -196,59 +239,259 @@ void GOpenGLBoard::DoGroupEnd() {
 		glStencilMask(gStencilDualMask);
 		DrawGLBox(gGLGroupRect.gExpandedLogicBox);
 	}
+
+	// the background texture can now serve other grabs
+	ReleaseGrabTexture(gGLGroupRect);
+	gGroupTracking = G_FALSE;
+	gGroupDamaged = G_FALSE;
+}
+
+GLGrabbedRect GOpenGLBoard::GroupBackground(const GGenericAABox<GInt32, 2>& DeviceBox) {
+
+	GLGrabbedRect rect(gGLGroupRect);
+
+	rect.Width = (GUInt32)(DeviceBox.Max()[G_X] - DeviceBox.Min()[G_X]);
+	rect.Height = (GUInt32)(DeviceBox.Max()[G_Y] - DeviceBox.Min()[G_Y]);
+	rect.OffsetX = (GUInt32)(DeviceBox.Min()[G_X] - gGroupDeviceBox.Min()[G_X]);
+	rect.OffsetY = (GUInt32)(DeviceBox.Min()[G_Y] - gGroupDeviceBox.Min()[G_Y]);
+
+	GPoint2 q0 = PhysicalToLogical(GPoint<GInt32, 2>(DeviceBox.Min()));
+	GPoint2 q1 = PhysicalToLogical(GPoint<GInt32, 2>(DeviceBox.Max()));
+	rect.gExpandedLogicBox.SetMinMax(q0, q1);
+	rect.gNotExpandedLogicBox = rect.gExpandedLogicBox;
+	return rect;
+}
+
+void GOpenGLBoard::SaveGroupBackground(const GGenericAABox<GInt32, 2>& DeviceBox) {
+
+	GLboolean colorMask[4];
+	GInt32 x = DeviceBox.Min()[G_X];
+	GInt32 y = DeviceBox.Min()[G_Y];
+	GInt32 w = DeviceBox.Max()[G_X] - x;
+	GInt32 h = DeviceBox.Max()[G_Y] - y;
+
+	G_ASSERT(w > 0 && h > 0);
+	G_ASSERT(gGLGroupRect.TexName > 0);
+
+	CopyFrameBuffer(DeviceBox, gGLGroupRect, (GUInt32)(x - gGroupDeviceBox.Min()[G_X]),
+					(GUInt32)(y - gGroupDeviceBox.Min()[G_Y]));
+
+	// clear the saved rectangle, so that group drawings start from a transparent background; the clear affects
+	// color buffer only, and it doesn't depend on drawing states
+	glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glScissor((GLint)x, (GLint)y, (GLsizei)w, (GLsizei)h);
+	glEnable(GL_SCISSOR_TEST);
+	glClearColor(1, 1, 1, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+	// restore the scissor of clip masks
+	if (gScissorTestEnabled)
+		glScissor(gScissorBox[0], gScissorBox[1], (GLsizei)gScissorBox[2], (GLsizei)gScissorBox[3]);
+	else
+		glDisable(GL_SCISSOR_TEST);
+	glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+}
+
+void GOpenGLBoard::GroupDamageDevice(const GGenericAABox<GInt32, 2>& DeviceBox) {
+
+	if (!gGroupTracking)
+		return;
+
+	// clip against the group rectangle
+	GInt32 x0 = GMath::Max(DeviceBox.Min()[G_X], gGroupDeviceBox.Min()[G_X]);
+	GInt32 y0 = GMath::Max(DeviceBox.Min()[G_Y], gGroupDeviceBox.Min()[G_Y]);
+	GInt32 x1 = GMath::Min(DeviceBox.Max()[G_X], gGroupDeviceBox.Max()[G_X]);
+	GInt32 y1 = GMath::Min(DeviceBox.Max()[G_Y], gGroupDeviceBox.Max()[G_Y]);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	// snap to group tiles, so that a sequence of small drawings doesn't produce a lot of small copies
+	GInt32 ox = gGroupDeviceBox.Min()[G_X];
+	GInt32 oy = gGroupDeviceBox.Min()[G_Y];
+	GInt32 tx0 = ox + ((x0 - ox) / G_GROUP_TILE_SIZE) * G_GROUP_TILE_SIZE;
+	GInt32 ty0 = oy + ((y0 - oy) / G_GROUP_TILE_SIZE) * G_GROUP_TILE_SIZE;
+	GInt32 tx1 = ox + ((x1 - ox + G_GROUP_TILE_SIZE - 1) / G_GROUP_TILE_SIZE) * G_GROUP_TILE_SIZE;
+	GInt32 ty1 = oy + ((y1 - oy + G_GROUP_TILE_SIZE - 1) / G_GROUP_TILE_SIZE) * G_GROUP_TILE_SIZE;
+	tx1 = GMath::Min(tx1, gGroupDeviceBox.Max()[G_X]);
+	ty1 = GMath::Min(ty1, gGroupDeviceBox.Max()[G_Y]);
+
+	if (!gGroupDamaged) {
+		gGroupDamageBox = DeviceRect(x0, y0, x1, y1);
+		gGroupSavedBox = DeviceRect(tx0, ty0, tx1, ty1);
+		SaveGroupBackground(gGroupSavedBox);
+		gGroupDamaged = G_TRUE;
+		return;
+	}
+
+	gGroupDamageBox = DeviceRect(GMath::Min(x0, gGroupDamageBox.Min()[G_X]), GMath::Min(y0, gGroupDamageBox.Min()[G_Y]),
+								 GMath::Max(x1, gGroupDamageBox.Max()[G_X]), GMath::Max(y1, gGroupDamageBox.Max()[G_Y]));
+
+	// the saved area is always a rectangle; when it grows, only the strips around the old one are saved
+	GInt32 sx0 = gGroupSavedBox.Min()[G_X];
+	GInt32 sy0 = gGroupSavedBox.Min()[G_Y];
+	GInt32 sx1 = gGroupSavedBox.Max()[G_X];
+	GInt32 sy1 = gGroupSavedBox.Max()[G_Y];
+	GInt32 nx0 = GMath::Min(tx0, sx0);
+	GInt32 ny0 = GMath::Min(ty0, sy0);
+	GInt32 nx1 = GMath::Max(tx1, sx1);
+	GInt32 ny1 = GMath::Max(ty1, sy1);
+
+	// bottom and top strips (full width)
+	if (ny0 < sy0)
+		SaveGroupBackground(DeviceRect(nx0, ny0, nx1, sy0));
+	if (sy1 < ny1)
+		SaveGroupBackground(DeviceRect(nx0, sy1, nx1, ny1));
+	// left and right strips
+	if (nx0 < sx0)
+		SaveGroupBackground(DeviceRect(nx0, sy0, sx0, sy1));
+	if (sx1 < nx1)
+		SaveGroupBackground(DeviceRect(sx1, sy0, nx1, sy1));
+
+	gGroupSavedBox = DeviceRect(nx0, ny0, nx1, ny1);
+}
+
+void GOpenGLBoard::GroupDamage(const GDrawStyle& Style, const GAABox2& ShapeBox) {
+
+	if (!gGroupTracking)
+		return;
+
+	GAABox2 box(ShapeBox);
+
+	// miter joins can go beyond the stroke thickness, that callers already include into the box
+	if (Style.StrokeEnabled() && Style.StrokeJoinStyle() == G_MITER_JOIN) {
+		GReal excess = Style.StrokeMiterLimit() * Style.StrokeThickness() - Style.StrokeThickness();
+		if (excess > 0) {
+			GPoint2 pMin(box.Min());
+			GPoint2 pMax(box.Max());
+			pMin[G_X] -= excess;
+			pMin[G_Y] -= excess;
+			pMax[G_X] += excess;
+			pMax[G_Y] += excess;
+			box.SetMinMax(pMin, pMax);
+		}
+	}
+
+	GAABox2 mvBox, clippedBox;
+	GGenericAABox<GInt32, 2> deviceBox;
+	UpdateBox(box, ModelViewMatrix(), mvBox);
+	GrabDeviceBox(mvBox, deviceBox, clippedBox);
+	GroupDamageDevice(deviceBox);
 }
 
 void GOpenGLBoard::UpdateGrabBuffer(const GUInt32 Width, const GUInt32 Height, GLGrabbedRect& GrabRect) {
 
 	G_ASSERT(Width > 0 && Height > 0);
 
+	// grab textures have power of two dimensions (rectangular ones too), so that every texture (and then every
+	// pooled texture) can serve all the grabs that fit it; we must ensure that texture must not be larger than
+	// the maximum (hw)permitted size
+	GUInt32 maxTexSize = gExtManager->MaxTextureSize();
+	GUInt32 texWidth = GMath::Min(GOpenglExt::PowerOfTwo(Width), maxTexSize);
+	GUInt32 texHeight = GMath::Min(GOpenglExt::PowerOfTwo(Height), maxTexSize);
+	GLenum target = (gRectTexturesInUse) ? GL_TEXTURE_RECTANGLE_EXT : GL_TEXTURE_2D;
+
 	// check if we have to expand grabbing buffer
-	if (Width > GrabRect.TexWidth || Height > GrabRect.TexHeight) {
-
-		// check if we have to create OpenGL texture
-		if (GrabRect.TexName == 0) {
-			glGenTextures(1, &GrabRect.TexName);
-			G_ASSERT(GrabRect.TexName > 0);
-			if (gRectTexturesInUse)
-				GrabRect.Target = GL_TEXTURE_RECTANGLE_EXT;
-			else
-				GrabRect.Target = GL_TEXTURE_2D;
-		}
+	if (GrabRect.TexName > 0 && texWidth <= GrabRect.TexWidth && texHeight <= GrabRect.TexHeight)
+		return;
 
-		// bind texture and calculate new dimensions
-		SELECT_AND_DISABLE_TUNIT(1)
-		SELECT_AND_DISABLE_TUNIT(0)
-		glEnable(GrabRect.Target);
-		glBindTexture(GrabRect.Target, GrabRect.TexName);
-		if (GrabRect.Target == GL_TEXTURE_RECTANGLE_EXT) {
-			GrabRect.TexWidth = Width;
-			GrabRect.TexHeight = Height;
-		}
-		else {
-			GrabRect.TexWidth = GOpenglExt::PowerOfTwo(Width);
-			GrabRect.TexHeight = GOpenglExt::PowerOfTwo(Height);
-		}
-		// we must ensure that texture must not be larger than the maximum (hw)permitted size
-		GUInt32 maxTexSize = gExtManager->MaxTextureSize();
-		if (GrabRect.TexWidth > maxTexSize)
-			GrabRect.TexWidth = maxTexSize;
-		if (GrabRect.TexHeight > maxTexSize)
-			GrabRect.TexHeight = maxTexSize;
-
-		// set texture parameters
-		glTexParameteri(GrabRect.Target, GL_TEXTURE_MAG_FILTER, GL_NEAREST); 
-		glTexParameteri(GrabRect.Target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GrabRect.Target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GrabRect.Target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		// create/enlarge texture
-		glTexImage2D(GrabRect.Target, 0, GL_RGBA8, GrabRect.TexWidth, GrabRect.TexHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	// the current texture is too small, give it back to the pool
+	ReleaseGrabTexture(GrabRect);
+
+	// look for the smallest pooled texture that fits
+	GUInt32 i, j = (GUInt32)gGrabTexturesPool.size(), best = j;
+	for (i = 0; i < j; ++i) {
+		const GLGrabTexture& tex = gGrabTexturesPool[i];
+		if (tex.Target != target || tex.TexWidth < texWidth || tex.TexHeight < texHeight)
+			continue;
+		if (best == j || tex.TexWidth * tex.TexHeight < gGrabTexturesPool[best].TexWidth * gGrabTexturesPool[best].TexHeight)
+			best = i;
+	}
+	if (best < j) {
+		GrabRect.TexName = gGrabTexturesPool[best].TexName;
+		GrabRect.Target = gGrabTexturesPool[best].Target;
+		GrabRect.TexWidth = gGrabTexturesPool[best].TexWidth;
+		GrabRect.TexHeight = gGrabTexturesPool[best].TexHeight;
 		GrabRect.Format = GL_RGBA8;
+		gGrabTexturesPool.erase(gGrabTexturesPool.begin() + best);
+		gGrabStats.PoolHits++;
+		return;
 	}
+
+	// create OpenGL texture
+	glGenTextures(1, &GrabRect.TexName);
+	G_ASSERT(GrabRect.TexName > 0);
+	GrabRect.Target = target;
+	GrabRect.TexWidth = texWidth;
+	GrabRect.TexHeight = texHeight;
+
+	SELECT_AND_DISABLE_TUNIT(1)
+	SELECT_AND_DISABLE_TUNIT(0)
+	glEnable(GrabRect.Target);
+	glBindTexture(GrabRect.Target, GrabRect.TexName);
+
+	// set texture parameters
+	glTexParameteri(GrabRect.Target, GL_TEXTURE_MAG_FILTER, GL_NEAREST); 
+	glTexParameteri(GrabRect.Target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GrabRect.Target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GrabRect.Target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// create texture
+	glTexImage2D(GrabRect.Target, 0, GL_RGBA8, GrabRect.TexWidth, GrabRect.TexHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	GrabRect.Format = GL_RGBA8;
+	gGrabStats.TexturesCreated++;
 }
 
-void GOpenGLBoard::GrabFrameBuffer(const GAABox2& LogicBox, GLGrabbedRect& Shot) {
+void GOpenGLBoard::ReleaseGrabTexture(GLGrabbedRect& GrabRect) {
 
-	GLDisableShaders();
+	if (GrabRect.TexName == 0)
+		return;
+
+	if (gGrabTexturesPoolSize == 0)
+		glDeleteTextures(1, &GrabRect.TexName);
+	else {
+		// the pool is full, delete the least recently released texture
+		if (gGrabTexturesPool.size() >= gGrabTexturesPoolSize) {
+			glDeleteTextures(1, &gGrabTexturesPool[0].TexName);
+			gGrabTexturesPool.erase(gGrabTexturesPool.begin());
+		}
+		GLGrabTexture tex;
+		tex.TexName = GrabRect.TexName;
+		tex.Target = GrabRect.Target;
+		tex.TexWidth = GrabRect.TexWidth;
+		tex.TexHeight = GrabRect.TexHeight;
+		gGrabTexturesPool.push_back(tex);
+	}
+	GrabRect.TexName = 0;
+	GrabRect.TexWidth = 0;
+	GrabRect.TexHeight = 0;
+}
+
+void GOpenGLBoard::SetGrabTexturesPoolSize(const GUInt32 Size) {
+
+	gGrabTexturesPoolSize = Size;
+	while (gGrabTexturesPool.size() > Size) {
+		glDeleteTextures(1, &gGrabTexturesPool[0].TexName);
+		gGrabTexturesPool.erase(gGrabTexturesPool.begin());
+	}
+}
+
+void GOpenGLBoard::DeleteGrabTextures() {
+
+	GUInt32 i, j = (GUInt32)gGrabTexturesPool.size();
+
+	for (i = 0; i < j; ++i)
+		glDeleteTextures(1, &gGrabTexturesPool[i].TexName);
+	gGrabTexturesPool.clear();
+
+	if (gGLGroupRect.TexName > 0)
+		glDeleteTextures(1, &gGLGroupRect.TexName);
+	gGLGroupRect = GLGrabbedRect();
+
+	if (gCompositingBuffer.TexName > 0)
+		glDeleteTextures(1, &gCompositingBuffer.TexName);
+	gCompositingBuffer = GLGrabbedRect();
+}
+
+void GOpenGLBoard::GrabDeviceBox(const GAABox2& LogicBox, GGenericAABox<GInt32, 2>& DeviceBox, GAABox2& ClippedBox) {
 
 	GReal left, right, bottom, top;
 	Projection(left, right, bottom, top);
@@ -262,18 +505,45 @@ void GOpenGLBoard::GrabFrameBuffer(const GAABox2& LogicBox, GLGrabbedRect& Shot)
 	if (LogicBox.Max()[G_Y] < top)
 		top = LogicBox.Max()[G_Y];
 
-	GAABox2 tmpBox(GPoint2(left, bottom), GPoint2(right, top));
+	ClippedBox.SetMinMax(GPoint2(left, bottom), GPoint2(right, top));
 
-	GPoint<GInt32, 2> p0 = LogicalToPhysicalInt(tmpBox.Min());
-	GPoint<GInt32, 2> p1 = LogicalToPhysicalInt(tmpBox.Max());
-	p0[G_X] -= 1;
-	p0[G_Y] -= 1;
-	p1[G_X] += 1;
-	p1[G_Y] += 1;
-	GGenericAABox<GInt32, 2> intBox(p0, p1);
+	GPoint<GInt32, 2> p0 = LogicalToPhysicalInt(ClippedBox.Min());
+	GPoint<GInt32, 2> p1 = LogicalToPhysicalInt(ClippedBox.Max());
+	DeviceBox.SetMinMax(p0, p1);
+	DeviceBox = DeviceRect(DeviceBox.Min()[G_X] - 1, DeviceBox.Min()[G_Y] - 1, DeviceBox.Max()[G_X] + 1, DeviceBox.Max()[G_Y] + 1);
+}
+
+void GOpenGLBoard::CopyFrameBuffer(const GGenericAABox<GInt32, 2>& DeviceBox, const GLGrabbedRect& Shot,
+								   const GUInt32 OffsetX, const GUInt32 OffsetY) {
+
+	GUInt32 width = (GUInt32)(DeviceBox.Max()[G_X] - DeviceBox.Min()[G_X]);
+	GUInt32 height = (GUInt32)(DeviceBox.Max()[G_Y] - DeviceBox.Min()[G_Y]);
+
+	G_ASSERT(Shot.TexName > 0);
+	G_ASSERT(Shot.TexWidth >= OffsetX + width && Shot.TexHeight >= OffsetY + height);
+
+	SELECT_AND_DISABLE_TUNIT(1)
+	SELECT_AND_DISABLE_TUNIT(0)
+	glEnable(Shot.Target);
+	glBindTexture(Shot.Target, Shot.TexName);
+	glCopyTexSubImage2D(Shot.Target, 0, (GLint)OffsetX, (GLint)OffsetY, (GLint)DeviceBox.Min()[G_X],
+						(GLint)DeviceBox.Min()[G_Y], (GLsizei)width, (GLsizei)height);
+	SELECT_AND_DISABLE_TUNIT(0)
+
+	gGrabStats.GrabsCount++;
+	gGrabStats.CopiedBytes += width * height * 4;
+}
+
+void GOpenGLBoard::GrabFrameBuffer(const GAABox2& LogicBox, GLGrabbedRect& Shot) {
+
+	GLDisableShaders();
 
-	GUInt32 width = (GUInt32)GMath::Abs(p1[G_X] - p0[G_X]);
-	GUInt32 height = (GUInt32)GMath::Abs(p1[G_Y] - p0[G_Y]);
+	GAABox2 tmpBox;
+	GGenericAABox<GInt32, 2> intBox;
+	GrabDeviceBox(LogicBox, intBox, tmpBox);
+
+	GUInt32 width = (GUInt32)(intBox.Max()[G_X] - intBox.Min()[G_X]);
+	GUInt32 height = (GUInt32)(intBox.Max()[G_Y] - intBox.Min()[G_Y]);
 
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -284,54 +554,72 @@ void GOpenGLBoard::GrabFrameBuffer(const GAABox2& LogicBox, GLGrabbedRect& Shot)
 	G_ASSERT(Shot.TexWidth > 0 && Shot.TexHeight > 0);
 	G_ASSERT(Shot.TexWidth >= width && Shot.TexHeight >= height);
 
-	SELECT_AND_DISABLE_TUNIT(1)
-	SELECT_AND_DISABLE_TUNIT(0)
-	glEnable(Shot.Target);
-	glBindTexture(Shot.Target, Shot.TexName);
-	glCopyTexSubImage2D(Shot.Target, 0, 0, 0, (GLint)intBox.Min()[G_X], (GLint)intBox.Min()[G_Y], (GLsizei)width, (GLsizei)height);
+	CopyFrameBuffer(intBox, Shot, 0, 0);
 
 	Shot.Width = width;
 	Shot.Height = height;
+	Shot.OffsetX = 0;
+	Shot.OffsetY = 0;
 	Shot.IsEmpty = G_FALSE;
 
 	Shot.gNotExpandedLogicBox = tmpBox;
 
-	GPoint2 q0 = PhysicalToLogical(p0);
-	GPoint2 q1 = PhysicalToLogical(p1);
+	GPoint2 q0 = PhysicalToLogical(GPoint<GInt32, 2>(intBox.Min()));
+	GPoint2 q1 = PhysicalToLogical(GPoint<GInt32, 2>(intBox.Max()));
 	Shot.gExpandedLogicBox.SetMinMax(q0, q1);
 
-	SELECT_AND_DISABLE_TUNIT(0)
 	glPixelStorei(GL_PACK_ALIGNMENT, 4);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 void GOpenGLBoard::DrawGrabbedRect(const GLGrabbedRect& GrabbedRect, const GBool TexUnit0, const GBool SubPixel0,
-								   const GBool TexUnit1, const GBool SubPixel1) {
+								   const GBool TexUnit1, const GBool SubPixel1, const GLGrabbedRect *GrabbedRect1) {
 
-	GReal u, v;
+	GReal u0, v0, u1, v1, s0, t0, s1, t1;
 	GReal subX0 = 0, subY0 = 0, subX1 = 0, subY1 = 0;
+	const GLGrabbedRect& rect1 = (GrabbedRect1) ? *GrabbedRect1 : GrabbedRect;
 
 	#define ENLARGE_OFFSET (GReal)0.5
 
+	G_ASSERT(rect1.Width == GrabbedRect.Width && rect1.Height == GrabbedRect.Height);
+
+	// texture coordinates of unit 0 are in the range [s0; u0] x [t0; v0], the ones of unit 1 in [s1; u1] x [t1; v1]
 	if (GrabbedRect.Target == GL_TEXTURE_2D) {
-		u = (GReal)((GDouble)GrabbedRect.Width / (GDouble)GrabbedRect.TexWidth);
-		v = (GReal)((GDouble)GrabbedRect.Height / (GDouble)GrabbedRect.TexHeight);
+		s0 = (GReal)((GDouble)GrabbedRect.OffsetX / (GDouble)GrabbedRect.TexWidth);
+		t0 = (GReal)((GDouble)GrabbedRect.OffsetY / (GDouble)GrabbedRect.TexHeight);
+		u0 = (GReal)((GDouble)(GrabbedRect.OffsetX + GrabbedRect.Width) / (GDouble)GrabbedRect.TexWidth);
+		v0 = (GReal)((GDouble)(GrabbedRect.OffsetY + GrabbedRect.Height) / (GDouble)GrabbedRect.TexHeight);
 		if (SubPixel0) {
 			subX0 = ENLARGE_OFFSET / (GrabbedRect.TexWidth);
 			subY0 = ENLARGE_OFFSET / (GrabbedRect.TexHeight);
 		}
-		if (SubPixel1) {
-			subX1 = ENLARGE_OFFSET / (GrabbedRect.TexWidth);
-			subY1 = ENLARGE_OFFSET / (GrabbedRect.TexHeight);
-		}
 	}
 	else {
-		u = (GReal)GrabbedRect.Width;
-		v = (GReal)GrabbedRect.Height;
+		s0 = (GReal)GrabbedRect.OffsetX;
+		t0 = (GReal)GrabbedRect.OffsetY;
+		u0 = (GReal)(GrabbedRect.OffsetX + GrabbedRect.Width);
+		v0 = (GReal)(GrabbedRect.OffsetY + GrabbedRect.Height);
 		if (SubPixel0) {
 			subX0 = ENLARGE_OFFSET;
 			subY0 = ENLARGE_OFFSET;
 		}
+	}
+
+	if (rect1.Target == GL_TEXTURE_2D) {
+		s1 = (GReal)((GDouble)rect1.OffsetX / (GDouble)rect1.TexWidth);
+		t1 = (GReal)((GDouble)rect1.OffsetY / (GDouble)rect1.TexHeight);
+		u1 = (GReal)((GDouble)(rect1.OffsetX + rect1.Width) / (GDouble)rect1.TexWidth);
+		v1 = (GReal)((GDouble)(rect1.OffsetY + rect1.Height) / (GDouble)rect1.TexHeight);
+		if (SubPixel1) {
+			subX1 = ENLARGE_OFFSET / (rect1.TexWidth);
+			subY1 = ENLARGE_OFFSET / (rect1.TexHeight);
+		}
+	}
+	else {
+		s1 = (GReal)rect1.OffsetX;
+		t1 = (GReal)rect1.OffsetY;
+		u1 = (GReal)(rect1.OffsetX + rect1.Width);
+		v1 = (GReal)(rect1.OffsetY + rect1.Height);
 		if (SubPixel1) {
 			subX1 = ENLARGE_OFFSET;
 			subY1 = ENLARGE_OFFSET;
@@ -345,9 +633,9 @@ void GOpenGLBoard::DrawGrabbedRect(const GLGrabbedRect& GrabbedRect, const GBool
 
 	glBegin(GL_POLYGON);
 		if (TexUnit0)
-			SetTextureVertex(0, 0 + subX0, v - subY0);
+			SetTextureVertex(0, s0 + subX0, v0 - subY0);
 		if (TexUnit1)
-			SetTextureVertex(1, 0 + subX1, v - subY1);
+			SetTextureVertex(1, s1 + subX1, v1 - subY1);
 		#ifdef DOUBLE_REAL_TYPE
 			glVertex2dv(p1.Data());
 		#else
@@ -355,9 +643,9 @@ void GOpenGLBoard::DrawGrabbedRect(const GLGrabbedRect& GrabbedRect, const GBool
 		#endif
 
 		if (TexUnit0)
-			SetTextureVertex(0, u - subX0, v - subY0);
+			SetTextureVertex(0, u0 - subX0, v0 - subY0);
 		if (TexUnit1)
-			SetTextureVertex(1, u - subX1, v - subY1);
+			SetTextureVertex(1, u1 - subX1, v1 - subY1);
 		#ifdef DOUBLE_REAL_TYPE
 			glVertex2dv(p2.Data());
 		#else
@@ -365,9 +653,9 @@ void GOpenGLBoard::DrawGrabbedRect(const GLGrabbedRect& GrabbedRect, const GBool
 		#endif
 
 		if (TexUnit0)
-			SetTextureVertex(0, u - subX0, 0 + subY0);
+			SetTextureVertex(0, u0 - subX0, t0 + subY0);
 		if (TexUnit1)
-			SetTextureVertex(1, u - subX1, 0 + subY1);
+			SetTextureVertex(1, u1 - subX1, t1 + subY1);
 		#ifdef DOUBLE_REAL_TYPE
 			glVertex2dv(p3.Data());
 		#else
@@ -375,15 +663,17 @@ void GOpenGLBoard::DrawGrabbedRect(const GLGrabbedRect& GrabbedRect, const GBool
 		#endif
 
 		if (TexUnit0)
-			SetTextureVertex(0, 0 + subX0, 0 + subY0);
+			SetTextureVertex(0, s0 + subX0, t0 + subY0);
 		if (TexUnit1)
-			SetTextureVertex(1, 0 + subX1, 0 + subY1);
+			SetTextureVertex(1, s1 + subX1, t1 + subY1);
 		#ifdef DOUBLE_REAL_TYPE
 			glVertex2dv(p0.Data());
 		#else
 			glVertex2fv(p0.Data());
 		#endif
 	glEnd();
+
+	#undef ENLARGE_OFFSET
 }
 
 };	// end namespace Amanith
@@ -108,6 +108,115 @@ void GOpenGLBoard::StencilEnableTop() {
 	}
 }
 
+void GOpenGLBoard::ScissorEnableTop() {
+
+	if (gScissorMasks.empty() || !ClipEnabled()) {
+		ScissorDisable();
+		return;
+	}
+
+	// intersect all scissor masks on the stack
+	GList<GLScissorMask>::const_iterator it = gScissorMasks.begin();
+	GLint x0 = it->X0, y0 = it->Y0, x1 = it->X1, y1 = it->Y1;
+
+	for (++it; it != gScissorMasks.end(); ++it) {
+		x0 = GMath::Max(x0, it->X0);
+		y0 = GMath::Max(y0, it->Y0);
+		x1 = GMath::Min(x1, it->X1);
+		y1 = GMath::Min(y1, it->Y1);
+	}
+	GLint w = GMath::Max(x1 - x0, 0);
+	GLint h = GMath::Max(y1 - y0, 0);
+
+	// avoid redundant state changes
+	if (!gScissorTestEnabled || gScissorBox[0] != x0 || gScissorBox[1] != y0 || gScissorBox[2] != w ||
+		gScissorBox[3] != h) {
+		glScissor(x0, y0, (GLsizei)w, (GLsizei)h);
+		gScissorBox[0] = x0;
+		gScissorBox[1] = y0;
+		gScissorBox[2] = w;
+		gScissorBox[3] = h;
+	}
+	if (!gScissorTestEnabled) {
+		glEnable(GL_SCISSOR_TEST);
+		gScissorTestEnabled = G_TRUE;
+	}
+}
+
+void GOpenGLBoard::ScissorDisable() {
+
+	if (gScissorTestEnabled) {
+		glDisable(GL_SCISSOR_TEST);
+		gScissorTestEnabled = G_FALSE;
+	}
+}
+
+GBool GOpenGLBoard::PushScissorClipMask(const GOpenGLDrawStyle& Style, const GPoint2& MinCorner, const GPoint2& MaxCorner) {
+
+	if (!gScissorClipMasksEnabled || !gClipMasksSupport || InsideGroup() || TargetMode() != G_CLIP_MODE)
+		return G_FALSE;
+	// stencil masks written with multisample have antialiased edges
+	if (gMultiSamplePresent && RenderingQuality() != G_LOW_RENDERING_QUALITY)
+		return G_FALSE;
+
+	// the mask must be a rectangle: filled, and with a stroke (if any) that keeps the corners square
+	if (!Style.FillEnabled())
+		return G_FALSE;
+
+	GReal t = 0;
+	if (Style.StrokeEnabled()) {
+		t = Style.StrokeThickness();
+		// the miter of a right angle is Sqrt(2) * Thickness long
+		if (Style.StrokeStyle() != G_SOLID_STROKE || Style.StrokeJoinStyle() != G_MITER_JOIN ||
+			t > Style.StrokeMiterLimitMulThickness() * (GReal)G_SQRTHALF)
+			return G_FALSE;
+	}
+
+	// the model-view matrix must be axis-preserving
+	const GMatrix33& m = ModelViewMatrix();
+	if (m[2][0] != 0 || m[2][1] != 0 || m[2][2] != 1)
+		return G_FALSE;
+	if (!(m[0][1] == 0 && m[1][0] == 0) && !(m[0][0] == 0 && m[1][1] == 0))
+		return G_FALSE;
+
+	// with an axis-preserving matrix, the transformed box is exactly the transformed rectangle
+	GPoint2 p0(MinCorner[G_X] - t, MinCorner[G_Y] - t);
+	GPoint2 p1(MaxCorner[G_X] + t, MaxCorner[G_Y] + t);
+	GAABox2 mvBox;
+	UpdateBox(GAABox2(p0, p1), m, mvBox);
+	GPoint2 q0 = LogicalToPhysicalReal(mvBox.Min());
+	GPoint2 q1 = LogicalToPhysicalReal(mvBox.Max());
+
+	// the stencil mask would cover the pixels whose center is inside the rectangle, once its corners have been
+	// snapped to the subpixel grid; a center lying on an edge is inside only for the minimum edges
+	GReal x0 = GMath::Floor(GMath::Min(q0[G_X], q1[G_X]) * gSubPixelScale + (GReal)0.5) / gSubPixelScale;
+	GReal y0 = GMath::Floor(GMath::Min(q0[G_Y], q1[G_Y]) * gSubPixelScale + (GReal)0.5) / gSubPixelScale;
+	GReal x1 = GMath::Floor(GMath::Max(q0[G_X], q1[G_X]) * gSubPixelScale + (GReal)0.5) / gSubPixelScale;
+	GReal y1 = GMath::Floor(GMath::Max(q0[G_Y], q1[G_Y]) * gSubPixelScale + (GReal)0.5) / gSubPixelScale;
+	GLScissorMask mask;
+	mask.X0 = (GLint)GMath::Ceil(x0 - (GReal)0.5);
+	mask.Y0 = (GLint)GMath::Ceil(y0 - (GReal)0.5);
+	mask.X1 = (GLint)GMath::Ceil(x1 - (GReal)0.5);
+	mask.Y1 = (GLint)GMath::Ceil(y1 - (GReal)0.5);
+
+	ScissorDisable();
+	if (ClipOperation() == G_REPLACE_CLIP) {
+		// the new mask replaces the whole stack, so the stencil buffer doesn't clip anymore
+		if (gTopStencilValue > 0) {
+			glStencilMask((GLuint)(~0));
+			glClearStencil((GLint)0);
+			glClear(GL_STENCIL_BUFFER_BIT);
+			gTopStencilValue = 0;
+		}
+	}
+	UpdateClipMasksState();
+
+	gClipMasksBoxes.push_back(mvBox);
+	mask.Depth = (GUInt32)gClipMasksBoxes.size();
+	gScissorMasks.push_back(mask);
+	return G_TRUE;
+}
+
 void GOpenGLBoard::DepthNoStencilWrite() {
 
 	glEnable(GL_DEPTH_TEST);
@@ -170,6 +279,8 @@ void GOpenGLBoard::DoPopClipMask() {
 	if (gClipMasksBoxes.size() == 0)
 		return;
 
+	ScissorDisable();
+
 	// setup stencil operation
 	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 
@@ -178,6 +289,13 @@ void GOpenGLBoard::DoPopClipMask() {
 		glClearStencil(0);
 		glClear(GL_STENCIL_BUFFER_BIT);
 		gClipMasksBoxes.clear();
+		gScissorMasks.clear();
+	}
+	else
+	if (!gScissorMasks.empty() && gScissorMasks.back().Depth == (GUInt32)gClipMasksBoxes.size()) {
+		// a scissor mask has nothing written into the stencil buffer
+		gClipMasksBoxes.pop_back();
+		gScissorMasks.pop_back();
 	}
 	else {
 		
@@ -203,6 +321,7 @@ void GOpenGLBoard::UpdateClipMasksState() {
 
 	if (ClipOperation() == G_REPLACE_CLIP) {
 		gClipMasksBoxes.clear();
+		gScissorMasks.clear();
 		// sign the flag, so popping a mask written using replace operation will be done as a clear of the entire
 		// stencil buffer
 		gFirstClipMaskReplace = G_TRUE;
@@ -0,0 +1,250 @@
+/****************************************************************************
+** $file: amanith/src/rendering/gopenglreadback.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** OpenGL based draw board asynchronous screenshots implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/rendering/gopenglboard.h"
+#include <new>
+#include <cstring>
+
+/*!
+	\file gopenglreadback.cpp
+	\brief OpenGL based draw board asynchronous screenshots implementation file.
+*/
+
+namespace Amanith {
+
+GError GOpenGLBoard::ScreenShotAsync(const GVectBase<GUInt32, 2>& P0, const GVectBase<GUInt32, 2>& P1,
+									 GUInt32& FrameID) {
+
+	GGenericAABox<GUInt32, 2> box(P0, P1);
+	GPoint<GUInt32, 2> q0 = box.Min();
+	GPoint<GUInt32, 2> q1 = box.Max();
+	GUInt32 n = (GUInt32)gReadbackSlots.size();
+	GUInt32 w, h, pixelsCount, id;
+	GError err;
+
+	// clamp the rectangle like ScreenShot() does
+	q0[G_X] = GMath::Clamp(q0[G_X], (GUInt32)0, gViewport[G_Z]);
+	q0[G_Y] = GMath::Clamp(q0[G_Y], (GUInt32)0, gViewport[G_W]);
+	q1[G_X] = GMath::Clamp(q1[G_X], (GUInt32)0, gViewport[G_Z]);
+	q1[G_Y] = GMath::Clamp(q1[G_Y], (GUInt32)0, gViewport[G_W]);
+	w = q1[G_X] - q0[G_X] + 1;
+	h = q1[G_Y] - q0[G_Y] + 1;
+	pixelsCount = w * h;
+
+	if (gScreenShotCallback) {
+		// hand already completed frames to the callback, so the ring is drained as soon as possible
+		err = ReadbackDeliver(G_FALSE);
+		if (err != G_NO_ERROR)
+			return err;
+		// if the ring is still full, the oldest frame must be waited for
+		if (gReadbackCount == n) {
+			err = ReadbackPop(gScreenShotFrame, id);
+			if (err != G_NO_ERROR)
+				return err;
+			gScreenShotCallback(gScreenShotFrame, id, gScreenShotUserData);
+		}
+	}
+	else
+	if (gReadbackCount == n)
+		return G_OUT_OF_RANGE;
+
+	GLReadbackSlot& slot = gReadbackSlots[(gReadbackFirst + gReadbackCount) % n];
+
+	if (gPixelBufferSupport) {
+		if (slot.BufferName == 0)
+			glGenBuffersARB(1, &slot.BufferName);
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, slot.BufferName);
+		if (slot.Capacity < pixelsCount) {
+			glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, (GLsizeiptrARB)(pixelsCount * sizeof(GUInt32)), NULL,
+							GL_STREAM_READ_ARB);
+			slot.Capacity = pixelsCount;
+		}
+		// with a pixel pack buffer bound, glReadPixels returns immediately and the pointer is a buffer offset
+		glReadPixels((GLint)q0[G_X], (GLint)q0[G_Y], (GLsizei)w, (GLsizei)h, GL_BGRA_EXT, GL_UNSIGNED_BYTE,
+					 (GLvoid *)0);
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+		if (gFenceSupport) {
+			if (slot.FenceName == 0)
+				glGenFencesNV(1, &slot.FenceName);
+			glSetFenceNV(slot.FenceName, GL_ALL_COMPLETED_NV);
+		}
+		// make sure the read is submitted to the device now, not at the next buffers swap
+		glFlush();
+	}
+	else {
+		// without pixel pack buffers the read is done synchronously into client memory
+		if (slot.Capacity < pixelsCount) {
+			if (slot.Pixels)
+				delete [] slot.Pixels;
+			slot.Pixels = new(std::nothrow) GUInt32[pixelsCount];
+			if (!slot.Pixels) {
+				slot.Capacity = 0;
+				return G_MEMORY_ERROR;
+			}
+			slot.Capacity = pixelsCount;
+		}
+		glReadPixels((GLint)q0[G_X], (GLint)q0[G_Y], (GLsizei)w, (GLsizei)h, GL_BGRA_EXT, GL_UNSIGNED_BYTE,
+					 (GLvoid *)slot.Pixels);
+	}
+
+	slot.Width = w;
+	slot.Height = h;
+	slot.FrameID = gNextFrameID++;
+	gReadbackCount++;
+	FrameID = slot.FrameID;
+	return G_NO_ERROR;
+}
+
+GBool GOpenGLBoard::ReadbackReady(const GUInt32 SlotIndex) const {
+
+	const GLReadbackSlot& slot = gReadbackSlots[SlotIndex];
+
+	if (!gPixelBufferSupport)
+		return G_TRUE;
+	if (slot.FenceName != 0)
+		return (glTestFenceNV(slot.FenceName) == GL_TRUE) ? G_TRUE : G_FALSE;
+	// without fences a read is considered completed when a newer one has been issued (one frame of latency)
+	return (SlotIndex != (gReadbackFirst + gReadbackCount - 1) % (GUInt32)gReadbackSlots.size()) ? G_TRUE : G_FALSE;
+}
+
+GError GOpenGLBoard::ReadbackPop(GPixelMap& Output, GUInt32& FrameID) {
+
+	GLReadbackSlot& slot = gReadbackSlots[gReadbackFirst];
+	const GUInt32 *src;
+	GUInt32 *dst, i;
+	GError err;
+
+	G_ASSERT(gReadbackCount > 0);
+
+	// the slot is released whatever happens, so that a failure can't stall the ring
+	gReadbackFirst = (gReadbackFirst + 1) % (GUInt32)gReadbackSlots.size();
+	gReadbackCount--;
+	FrameID = slot.FrameID;
+
+	// every pixel is overwritten, so there's no need to clear the image
+	err = Output.Reset((GInt32)slot.Width, (GInt32)slot.Height, G_A8R8G8B8);
+	if (err != G_NO_ERROR)
+		return err;
+
+	if (gPixelBufferSupport) {
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, slot.BufferName);
+		src = (const GUInt32 *)glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+		if (!src) {
+			glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+			return G_MEMORY_ERROR;
+		}
+	}
+	else
+		src = slot.Pixels;
+
+	// OpenGL rows go from bottom to top, so the image is flipped while copying
+	dst = (GUInt32 *)Output.Pixels();
+	src += slot.Width * (slot.Height - 1);
+	for (i = 0; i < slot.Height; ++i) {
+		std::memcpy(dst, src, slot.Width * sizeof(GUInt32));
+		dst += slot.Width;
+		src -= slot.Width;
+	}
+
+	if (gPixelBufferSupport) {
+		glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+	}
+	return G_NO_ERROR;
+}
+
+GError GOpenGLBoard::ReadbackDeliver(const GBool Wait) {
+
+	GUInt32 id;
+	GError err;
+
+	if (!gScreenShotCallback)
+		return G_INVALID_OPERATION;
+
+	while (gReadbackCount > 0 && (Wait || ReadbackReady(gReadbackFirst))) {
+		err = ReadbackPop(gScreenShotFrame, id);
+		if (err != G_NO_ERROR)
+			return err;
+		gScreenShotCallback(gScreenShotFrame, id, gScreenShotUserData);
+	}
+	return G_NO_ERROR;
+}
+
+GBool GOpenGLBoard::PollScreenShot(GPixelMap& Output, GUInt32& FrameID, const GBool Wait) {
+
+	if (gReadbackCount == 0)
+		return G_FALSE;
+	if (!Wait && !ReadbackReady(gReadbackFirst))
+		return G_FALSE;
+	if (ReadbackPop(Output, FrameID) != G_NO_ERROR)
+		return G_FALSE;
+	return G_TRUE;
+}
+
+GError GOpenGLBoard::FlushScreenShots() {
+
+	return ReadbackDeliver(G_TRUE);
+}
+
+void GOpenGLBoard::SetScreenShotCallback(GScreenShotCallback Callback, void *UserData) {
+
+	gScreenShotCallback = Callback;
+	gScreenShotUserData = UserData;
+}
+
+GError GOpenGLBoard::SetScreenShotBuffersCount(const GUInt32 Count) {
+
+	if (Count < 2)
+		return G_INVALID_PARAMETER;
+	if (gReadbackCount > 0)
+		return G_INVALID_OPERATION;
+
+	DeleteReadbackSlots();
+	gReadbackSlots.resize(Count);
+	return G_NO_ERROR;
+}
+
+void GOpenGLBoard::DeleteReadbackSlots() {
+
+	GUInt32 i, j = (GUInt32)gReadbackSlots.size();
+
+	for (i = 0; i < j; ++i) {
+		GLReadbackSlot& slot = gReadbackSlots[i];
+		if (slot.BufferName != 0)
+			glDeleteBuffersARB(1, &slot.BufferName);
+		if (slot.FenceName != 0)
+			glDeleteFencesNV(1, &slot.FenceName);
+		if (slot.Pixels)
+			delete [] slot.Pixels;
+		slot = GLReadbackSlot();
+	}
+	gReadbackFirst = 0;
+	gReadbackCount = 0;
+}
+
+};	// end namespace Amanith
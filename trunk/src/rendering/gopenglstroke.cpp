@@ -50,7 +50,7 @@ void GOpenGLBoard::DrawGLCapsLine(const GBool DoStartCap, const GCapStyle StartC
 	perpSeg *= (Thickness / perpSeg.Length());
 
 
-	glBegin(GL_POLYGON);
+	GLBegin(GL_POLYGON);
 
 	// calculate fundamentals points
 	GPoint2 j0 = P0 + perpSeg;
@@ -65,26 +65,16 @@ void GOpenGLBoard::DrawGLCapsLine(const GBool DoStartCap, const GCapStyle StartC
 	// end cap
 	if (!DoEndCap) {
 		// behavior is like we would have a butt cap
-		#ifdef DOUBLE_REAL_TYPE
-			glVertex2dv(l0.Data());
-			glVertex2dv(l1.Data());
-		#else
-			glVertex2fv(l0.Data());
-			glVertex2fv(l1.Data());
-		#endif
+		GLVertex(l0);
+		GLVertex(l1);
 	}
 	else {
 		GPoint2 a, b;
 		switch (EndCapStyle) {
 
 			case G_BUTT_CAP:
-				#ifdef DOUBLE_REAL_TYPE
-					glVertex2dv(l0.Data());
-					glVertex2dv(l1.Data());
-				#else
-					glVertex2fv(l0.Data());
-					glVertex2fv(l1.Data());
-				#endif
+				GLVertex(l0);
+				GLVertex(l1);
 				break;
 
 			case G_ROUND_CAP:
@@ -94,13 +84,8 @@ void GOpenGLBoard::DrawGLCapsLine(const GBool DoStartCap, const GCapStyle StartC
 			case G_SQUARE_CAP:
 				a = j0 + l * dirSeg;
 				b = j1 + l * dirSeg;
-				#ifdef DOUBLE_REAL_TYPE
-					glVertex2dv(a.Data());
-					glVertex2dv(b.Data());
-				#else
-					glVertex2fv(a.Data());
-					glVertex2fv(b.Data());
-				#endif
+				GLVertex(a);
+				GLVertex(b);
 				break;
 		}
 	}
@@ -109,13 +94,8 @@ void GOpenGLBoard::DrawGLCapsLine(const GBool DoStartCap, const GCapStyle StartC
 	// start cap
 	if (!DoStartCap) {
 		// behavior is like we would have a butt cap
-		#ifdef DOUBLE_REAL_TYPE
-			glVertex2dv(j1.Data());
-			glVertex2dv(j0.Data());
-		#else
-			glVertex2fv(j1.Data());
-			glVertex2fv(j0.Data());
-		#endif
+		GLVertex(j1);
+		GLVertex(j0);
 	}
 	else {
 		GPoint2 a, b;
@@ -123,13 +103,8 @@ void GOpenGLBoard::DrawGLCapsLine(const GBool DoStartCap, const GCapStyle StartC
 		switch (StartCapStyle) {
 
 			case G_BUTT_CAP:
-				#ifdef DOUBLE_REAL_TYPE
-					glVertex2dv(j1.Data());
-					glVertex2dv(j0.Data());
-				#else
-					glVertex2fv(j1.Data());
-					glVertex2fv(j0.Data());
-				#endif
+				GLVertex(j1);
+				GLVertex(j0);
 				break;
 
 			case G_ROUND_CAP:
@@ -139,17 +114,12 @@ void GOpenGLBoard::DrawGLCapsLine(const GBool DoStartCap, const GCapStyle StartC
 			case G_SQUARE_CAP:
 				a = l0 - l * dirSeg;
 				b = l1 - l * dirSeg;
-				#ifdef DOUBLE_REAL_TYPE
-					glVertex2dv(b.Data());
-					glVertex2dv(a.Data());
-				#else
-					glVertex2fv(b.Data());
-					glVertex2fv(a.Data());
-				#endif
+				GLVertex(b);
+				GLVertex(a);
 				break;
 		}
 	}
-	glEnd();
+	GLEnd();
 }
 
 void GOpenGLBoard::DrawGLJoinLine(const GJoinStyle JoinStyle, const GReal MiterLimitMulThickness,
@@ -175,7 +145,7 @@ void GOpenGLBoard::DrawGLJoinLine(const GJoinStyle JoinStyle, const GReal MiterL
 	}
 
 
-	glBegin(GL_POLYGON);
+	GLBegin(GL_POLYGON);
 
 	// calculate fundamentals points
 	GPoint2 j0 = P0 + perpPrev;
@@ -217,42 +187,24 @@ void GOpenGLBoard::DrawGLJoinLine(const GJoinStyle JoinStyle, const GReal MiterL
 			GVector2 intDir = intPoint - P0;
 			GReal intDirLen = intDir.Normalize();
 
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(j0.Data());
-				if (intDirLen <= MiterLimitMulThickness)
-					glVertex2dv(intPoint.Data());
-				glVertex2dv(j1.Data());
-			#else
-				glVertex2fv(j0.Data());
-				if (intDirLen <= MiterLimitMulThickness)
-					glVertex2fv(intPoint.Data());
-				glVertex2fv(j1.Data());
-			#endif
+			GLVertex(j0);
+			if (intDirLen <= MiterLimitMulThickness)
+				GLVertex(intPoint);
+			GLVertex(j1);
 		}
 	}
 	// bevel join
 	else {
 		G_ASSERT(JoinStyle == G_BEVEL_JOIN);
-		#ifdef DOUBLE_REAL_TYPE
-			glVertex2dv(j0.Data());
-			glVertex2dv(j1.Data());
-		#else
-			glVertex2fv(j0.Data());
-			glVertex2fv(j1.Data());
-		#endif
+		GLVertex(j0);
+		GLVertex(j1);
 	}
 
-	#ifdef DOUBLE_REAL_TYPE
-		glVertex2dv(l0.Data());
-		glVertex2dv(l1.Data());
-		glVertex2dv(l2.Data());
-	#else
-		glVertex2fv(l0.Data());
-		glVertex2fv(l1.Data());
-		glVertex2fv(l2.Data());
-	#endif
-
-	glEnd();
+	GLVertex(l0);
+	GLVertex(l1);
+	GLVertex(l2);
+
+	GLEnd();
 }
 
 void GOpenGLBoard::DrawGLJoinLineCap(const GJoinStyle JoinStyle, const GReal MiterLimitMulThickness,
@@ -279,7 +231,7 @@ void GOpenGLBoard::DrawGLJoinLineCap(const GJoinStyle JoinStyle, const GReal Mit
 	}
 
 
-	glBegin(GL_POLYGON);
+	GLBegin(GL_POLYGON);
 
 	// calculate fundamentals points
 	GPoint2 j0 = P0 + perpPrev;
@@ -321,71 +273,43 @@ void GOpenGLBoard::DrawGLJoinLineCap(const GJoinStyle JoinStyle, const GReal Mit
 			GVector2 intDir = intPoint - P0;
 			GReal intDirLen = intDir.Normalize();
 
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(j0.Data());
-				if (intDirLen <= MiterLimitMulThickness)
-					glVertex2dv(intPoint.Data());
-				glVertex2dv(j1.Data());
-			#else
-				glVertex2fv(j0.Data());
-				if (intDirLen <= MiterLimitMulThickness)
-					glVertex2fv(intPoint.Data());
-				glVertex2fv(j1.Data());
-			#endif
+			GLVertex(j0);
+			if (intDirLen <= MiterLimitMulThickness)
+				GLVertex(intPoint);
+			GLVertex(j1);
 		}
 	}
 	// bevel join
 	else {
 		G_ASSERT(JoinStyle == G_BEVEL_JOIN);
-		#ifdef DOUBLE_REAL_TYPE
-			glVertex2dv(j0.Data());
-			glVertex2dv(j1.Data());
-		#else
-			glVertex2fv(j0.Data());
-			glVertex2fv(j1.Data());
-		#endif
+		GLVertex(j0);
+		GLVertex(j1);
 	}
 
 	GReal l;
 	switch (EndCapStyle) {
 
 		case G_BUTT_CAP:
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(l0.Data());
-				glVertex2dv(l1.Data());
-				glVertex2dv(l2.Data());
-			#else
-				glVertex2fv(l0.Data());
-				glVertex2fv(l1.Data());
-				glVertex2fv(l2.Data());
-			#endif
+			GLVertex(l0);
+			GLVertex(l1);
+			GLVertex(l2);
 			break;
 
 		case G_ROUND_CAP:
 			DrawGLCircleSlice(P1, RoundAuxCoef, l0, l1, (GReal)G_PI, CounterClockWise(P0, l0, l1));
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(l2.Data());
-			#else
-				glVertex2fv(l2.Data());
-			#endif
+			GLVertex(l2);
 			break;
 
 		case G_SQUARE_CAP:
 			l = dirSeg.Normalize() + Thickness;
 			l0 = j1 + l * dirSeg;
 			l1 = l2 + l * dirSeg;
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(l0.Data());
-				glVertex2dv(l1.Data());
-				glVertex2dv(l2.Data());
-			#else
-				glVertex2fv(l0.Data());
-				glVertex2fv(l1.Data());
-				glVertex2fv(l2.Data());
-			#endif
+			GLVertex(l0);
+			GLVertex(l1);
+			GLVertex(l2);
 			break;
 	}
-	glEnd();
+	GLEnd();
 }
 
 void GOpenGLBoard::DrawGLCircleSlice(const GPoint2& Center, const GReal RoundAuxCoef, const GPoint2& Start,
@@ -409,26 +333,14 @@ void GOpenGLBoard::DrawGLCircleSlice(const GPoint2& Center, const GReal RoundAux
 	GPoint2 p(Start - Center), q, r;
 	// draw cap
 
-#ifdef DOUBLE_REAL_TYPE
-	glVertex2dv(Start.Data());
-#else
-	glVertex2fv(Start.Data());
-#endif
+	GLVertex(Start);
 	for (GUInt32 i = 0; i < n - 1; ++i) {
 		q.Set(p[G_X] * cosDelta - p[G_Y] * sinDelta, p[G_Y] * cosDelta + p[G_X] * sinDelta);
 		r = q + Center;
-#ifdef DOUBLE_REAL_TYPE
-		glVertex2dv(r.Data());
-#else
-		glVertex2fv(r.Data());
-#endif
+		GLVertex(r);
 		p = q;
 	}
-#ifdef DOUBLE_REAL_TYPE
-	glVertex2dv(End.Data());
-#else
-	glVertex2fv(End.Data());
-#endif
+	GLVertex(End);
 }
 
 void GOpenGLBoard::DrawGLJoin(const GPoint2& JoinCenter, const GVector2& InDirection, const GReal InDistance,
@@ -492,18 +404,13 @@ void GOpenGLBoard::DrawGLJoin(const GPoint2& JoinCenter, const GVector2& InDirec
 	// calculate ccw/cw direction
 	GBool ccw = CounterClockWise(j0, t0, s0);
 
-	glBegin(GL_POLYGON);
+	GLBegin(GL_POLYGON);
 	// start cap
 	switch (StartCapStyle) {
 
 		case G_BUTT_CAP:
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(v0.Data());
-				glVertex2dv(k0.Data());
-			#else
-				glVertex2fv(v0.Data());
-				glVertex2fv(k0.Data());
-			#endif
+			GLVertex(v0);
+			GLVertex(k0);
 			break;
 
 		case G_ROUND_CAP:
@@ -513,26 +420,16 @@ void GOpenGLBoard::DrawGLJoin(const GPoint2& JoinCenter, const GVector2& InDirec
 		case G_SQUARE_CAP:
 			a = k0 - Thickness * InDirection;
 			b = v0 - Thickness * InDirection;
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(b.Data());
-				glVertex2dv(a.Data());
-			#else
-				glVertex2fv(b.Data());
-				glVertex2fv(a.Data());
-			#endif
+			GLVertex(b);
+			GLVertex(a);
 			break;
 	}
 
 	// join
 	if (JoinStyle == G_BEVEL_JOIN) {
 		jc = (j0 + j1) * (GReal)0.5;
-		#ifdef DOUBLE_REAL_TYPE
-			glVertex2dv(j0.Data());
-			glVertex2dv(jc.Data());
-		#else
-			glVertex2fv(j0.Data());
-			glVertex2fv(jc.Data());
-		#endif
+		GLVertex(j0);
+		GLVertex(jc);
 	}
 	else
 	if (JoinStyle == G_ROUND_JOIN) {
@@ -546,27 +443,18 @@ void GOpenGLBoard::DrawGLJoin(const GPoint2& JoinCenter, const GVector2& InDirec
 		jc = JoinCenter + intDir;
 		GReal intDirLen = intDir.Normalize();
 
-		if (intDirLen > MiterLimitMulThickness)
+		// beyond the miter limit the join is beveled
+		if (intDirLen > MiterLimitMulThickness) {
 			//jc = JoinCenter + MiterLimitMulThickness * intDir;
 			jc = (j0 + j1) * (GReal)0.5;
-
-		#ifdef DOUBLE_REAL_TYPE
-			glVertex2dv(j0.Data());
-			glVertex2dv(jc.Data());
-		#else
-			glVertex2fv(j0.Data());
-			glVertex2fv(jc.Data());
-		#endif
+		}
+		GLVertex(j0);
+		GLVertex(jc);
 	}
 
-	#ifdef DOUBLE_REAL_TYPE
-		glVertex2dv(w1.Data());
-		glVertex2dv(vc.Data());
-	#else
-		glVertex2fv(w1.Data());
-		glVertex2fv(vc.Data());
-	#endif
-	glEnd();
+	GLVertex(w1);
+	GLVertex(vc);
+	GLEnd();
 
 
 	// handle degenerative distance cases
@@ -578,18 +466,13 @@ void GOpenGLBoard::DrawGLJoin(const GPoint2& JoinCenter, const GVector2& InDirec
 	GPoint2 s1 = (k1 + v1) * (GReal)0.5;
 
 
-	glBegin(GL_POLYGON);
+	GLBegin(GL_POLYGON);
 	// end cap
 	switch (EndCapStyle) {
 
 		case G_BUTT_CAP:
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(k1.Data());
-				glVertex2dv(v1.Data());
-			#else
-				glVertex2fv(k1.Data());
-				glVertex2fv(v1.Data());
-			#endif
+			GLVertex(k1);
+			GLVertex(v1);
 			break;
 
 		case G_ROUND_CAP:
@@ -599,42 +482,27 @@ void GOpenGLBoard::DrawGLJoin(const GPoint2& JoinCenter, const GVector2& InDirec
 		case G_SQUARE_CAP:
 			a = k1 + Thickness * OutDirection;
 			b = v1 + Thickness * OutDirection;
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(a.Data());
-				glVertex2dv(b.Data());
-			#else
-				glVertex2fv(a.Data());
-				glVertex2fv(b.Data());
-			#endif
+			GLVertex(a);
+			GLVertex(b);
 			break;
 	}
 
-	#ifdef DOUBLE_REAL_TYPE
-		glVertex2dv(vc.Data());
-		glVertex2dv(w0.Data());
-	#else
-		glVertex2fv(vc.Data());
-		glVertex2fv(w0.Data());
-	#endif
+	GLVertex(vc);
+	GLVertex(w0);
 
 	switch (JoinStyle) {
 
 		case G_BEVEL_JOIN:
 		case G_MITER_JOIN:
-			#ifdef DOUBLE_REAL_TYPE
-				glVertex2dv(jc.Data());
-				glVertex2dv(j1.Data());
-			#else
-				glVertex2fv(jc.Data());
-				glVertex2fv(j1.Data());
-			#endif
+			GLVertex(jc);
+			GLVertex(j1);
 			break;
 
 		case G_ROUND_JOIN:
 			DrawGLCircleSlice(JoinCenter, RoundAuxCoef, jc, j1, halfRoundJoinAngle, ccw);
 			break;
 	}
-	glEnd();
+	GLEnd();
 }
 
 void GOpenGLBoard::DrawSolidStroke(const GCapStyle StartCapStyle, const GCapStyle EndCapStyle,
@@ -704,6 +572,97 @@ void GOpenGLBoard::DrawSolidStroke(const GCapStyle StartCapStyle, const GCapStyl
 	}
 }
 
+GBool GOpenGLBoard::BuildConvexStroke(const GJoinStyle JoinStyle, const GReal MiterLimitMulThickness,
+									 const GDynArray<GPoint2>& Points, const GReal Thickness,
+									 GDynArray<GPoint2>& Strip) const {
+
+	GUInt32 i, n = (GUInt32)Points.size();
+
+	if (n < 3 || JoinStyle == G_ROUND_JOIN)
+		return G_FALSE;
+
+	// orientation of the contour
+	GReal area = 0;
+	for (i = 0; i < n; ++i) {
+		const GPoint2& p = Points[i];
+		const GPoint2& q = Points[(i + 1) % n];
+		area += p[G_X] * q[G_Y] - q[G_X] * p[G_Y];
+	}
+	if (GMath::Abs(area) <= G_EPSILON)
+		return G_FALSE;
+	GReal orientation = (area > 0) ? (GReal)1 : (GReal)-1;
+
+	Strip.clear();
+
+	GVector2 dirPrev = Points[0] - Points[n - 1];
+	GReal lenPrev = dirPrev.Normalize();
+	if (lenPrev <= G_EPSILON)
+		return G_FALSE;
+	GPoint2 innerFirst, innerPrev;
+
+	for (i = 0; i < n; ++i) {
+
+		const GPoint2& p = Points[i];
+		GVector2 dirSeg = Points[(i + 1) % n] - p;
+		GReal lenSeg = dirSeg.Normalize();
+
+		if (lenSeg <= G_EPSILON)
+			return G_FALSE;
+		// the contour must turn always on the same side
+		GReal turn = Cross(dirPrev, dirSeg) * orientation;
+		if (turn < -G_EPSILON)
+			return G_FALSE;
+
+		// normal vectors pointing outwards
+		GVector2 normPrev(orientation * dirPrev[G_Y], -orientation * dirPrev[G_X]);
+		GVector2 normSeg(orientation * dirSeg[G_Y], -orientation * dirSeg[G_X]);
+		GReal k = (GReal)1 + Dot(normPrev, normSeg);
+		if (k <= G_EPSILON)
+			return G_FALSE;
+
+		// the inner border is the intersection of the inner offsets of the two segments; the outer border
+		// has the miter point, or the two offsets ends for a bevel
+		GVector2 miter = (normPrev + normSeg) * (Thickness / k);
+		GPoint2 inner = p - miter;
+
+		// the inner offset of the previous segment must not be reversed
+		if (i > 0 && Dot(inner - innerPrev, dirPrev) <= 0)
+			return G_FALSE;
+
+		if (JoinStyle == G_MITER_JOIN && miter.Length() <= MiterLimitMulThickness) {
+			Strip.push_back(p + miter);
+			Strip.push_back(inner);
+		}
+		else {
+			Strip.push_back(p + Thickness * normPrev);
+			Strip.push_back(inner);
+			Strip.push_back(p + Thickness * normSeg);
+			Strip.push_back(inner);
+		}
+
+		if (i == 0)
+			innerFirst = inner;
+		innerPrev = inner;
+		dirPrev = dirSeg;
+	}
+	// check the closing segment, then close the strip
+	if (Dot(innerFirst - innerPrev, dirPrev) <= 0)
+		return G_FALSE;
+	Strip.push_back(Strip[0]);
+	Strip.push_back(Strip[1]);
+	return G_TRUE;
+}
+
+void GOpenGLBoard::DrawConvexStroke(const GDynArray<GPoint2>& Strip) {
+
+	GDynArray<GPoint2>::const_iterator it;
+
+	GLBegin(GL_TRIANGLE_STRIP);
+	for (it = Strip.begin(); it != Strip.end(); ++it)
+		GLVertex(*it);
+	GLEnd();
+}
+
 void GOpenGLBoard::DrawDashedStroke(const GOpenGLDrawStyle& Style,
 									Point2ConstIt PointsBegin, Point2ConstIt PointsEnd,
 									const GBool Closed,	const GReal Thickness, const GReal RoundAuxCoeff) {
@@ -28,7 +28,6 @@
 
 #include "amanith/rendering/gopenglboard.h"
 #include "amanith/1d/ghermitecurve1d.h"
-#include "amanith/1d/gpolylinecurve1d.h"
 #include "amanith/gmultiproperty.h"
 #include "amanith/geometry/gxform.h"
 #include "amanith/geometry/gxformconv.h"
@@ -41,6 +40,77 @@
 
 namespace Amanith {
 
+// *********************************************************************
+//                          GOpenGLRampTextures
+// *********************************************************************
+
+GOpenGLRampTextures::GOpenGLRampTextures() {
+}
+
+GOpenGLRampTextures::~GOpenGLRampTextures() {
+
+	GUInt32 i, j = (GUInt32)gTextures.size();
+
+	// ramps will be deleted by the cache destructor
+	for (i = 0; i < j; ++i)
+		glDeleteTextures(1, &gTextures[i].TexName);
+	gTextures.clear();
+}
+
+GLuint GOpenGLRampTextures::Acquire(const GDynArray<GKeyValue>& ColorKeys, const GColorRampInterpolation Interpolation,
+									const GColorRampSpreadMode SpreadMode, const GUInt32 Size, const GBool Mirrored,
+									const GLenum Target, const GColorRamp *&Ramp, GBool& NewTexture) {
+
+	GUInt32 i, j = (GUInt32)gTextures.size();
+	GBool newRamp;
+
+	NewTexture = G_FALSE;
+	// OpenGL blending works on non-premultiplied colors
+	Ramp = gRamps.Acquire(ColorKeys, Interpolation, SpreadMode, Size, G_FALSE, Mirrored, newRamp);
+	if (!Ramp)
+		return 0;
+
+	if (!newRamp) {
+		for (i = 0; i < j; ++i) {
+			if (gTextures[i].Ramp == Ramp && gTextures[i].Target == Target) {
+				gTextures[i].RefCount++;
+				// the texture already holds a reference to the ramp
+				gRamps.Release(Ramp);
+				return gTextures[i].TexName;
+			}
+		}
+	}
+
+	GRampTexture t;
+	t.Ramp = Ramp;
+	t.Target = Target;
+	t.RefCount = 1;
+	t.TexName = 0;
+	glGenTextures(1, &t.TexName);
+	G_ASSERT(t.TexName > 0);
+	gTextures.push_back(t);
+	NewTexture = G_TRUE;
+	return t.TexName;
+}
+
+void GOpenGLRampTextures::Release(const GLuint TexName) {
+
+	GUInt32 i, j = (GUInt32)gTextures.size();
+
+	for (i = 0; i < j; ++i) {
+		if (gTextures[i].TexName == TexName) {
+			G_ASSERT(gTextures[i].RefCount > 0);
+			gTextures[i].RefCount--;
+			if (gTextures[i].RefCount == 0) {
+				glDeleteTextures(1, &gTextures[i].TexName);
+				gRamps.Release(gTextures[i].Ramp);
+				gTextures.erase(gTextures.begin() + i);
+			}
+			return;
+		}
+	}
+}
+
 // *********************************************************************
 //                          GOpenGLGradientDesc
 // *********************************************************************
@@ -49,14 +119,19 @@ namespace Amanith {
 GOpenGLGradientDesc::GOpenGLGradientDesc() {
 
 	gGradientTexture = 0;
+	gRampTextures = NULL;
 	gAlphaKeys = G_FALSE;
 }
 
 // destructor
 GOpenGLGradientDesc::~GOpenGLGradientDesc() {
 
-	if (gGradientTexture)
-		glDeleteTextures(1, &gGradientTexture);
+	if (gGradientTexture) {
+		if (gRampTextures)
+			gRampTextures->Release(gGradientTexture);
+		else
+			glDeleteTextures(1, &gGradientTexture);
+	}
 }
 
 void GOpenGLGradientDesc::SetGLGradientQuality(const GRenderingQuality Quality) {
@@ -76,202 +151,33 @@ void GOpenGLGradientDesc::SetGLGradientQuality(const GRenderingQuality Quality)
 	}
 }
 
-void GOpenGLGradientDesc::GenerateTexture1D(const GInt32 Size, GPixelMap& Bitmap, const GBool ReflectKeys) {
-
-	Bitmap.Create(Size, 1, G_A8R8G8B8);
-	GUChar8 *pixels = Bitmap.Pixels();
-
-	// hermite color interpolation
-	if (ColorInterpolation() == G_HERMITE_COLOR_INTERPOLATION) {
-
-		const GDynArray<GKeyValue>& keys = ColorKeys();
-		GInt32 i, j = (GInt32)keys.size(), pixelOfs;
-		GHermiteCurve1D redCurve, greenCurve, blueCurve, alphaCurve;
-		GDynArray<GHermiteKey1D> redKeys, greenKeys, blueKeys, alphaKeys;
-		GReal u, step;
-		GUChar8 r8, g8, b8, a8;
-
-		for (i = 0; i < j; i++) {
-			GVector4 v = keys[i].Vect4Value();
-			redKeys.push_back(GHermiteKey1D(keys[i].TimePosition(), v[G_X]));
-			greenKeys.push_back(GHermiteKey1D(keys[i].TimePosition(), v[G_Y]));
-			blueKeys.push_back(GHermiteKey1D(keys[i].TimePosition(), v[G_Z]));
-			alphaKeys.push_back(GHermiteKey1D(keys[i].TimePosition(), v[G_W]));
-		}
-
-		// reflect keys, is specified
-		if (ReflectKeys) {
-
-			GReal maxTime = redKeys.back().Parameter;
-			for (i = j - 2; i >= 0; i--) {
-
-				redKeys.push_back(redKeys[i]);
-				redKeys.back().Parameter = ((GReal)2 * maxTime - redKeys.back().Parameter);
-				greenKeys.push_back(greenKeys[i]);
-				greenKeys.back().Parameter = ((GReal)2 * maxTime - greenKeys.back().Parameter);
-				blueKeys.push_back(blueKeys[i]);
-				blueKeys.back().Parameter = ((GReal)2 * maxTime - blueKeys.back().Parameter);
-				alphaKeys.push_back(alphaKeys[i]);
-				alphaKeys.back().Parameter = ((GReal)2 * maxTime - alphaKeys.back().Parameter);
-			}
-		}
-
-		redCurve.SetKeys(redKeys);
-		greenCurve.SetKeys(greenKeys);
-		blueCurve.SetKeys(blueKeys);
-		alphaCurve.SetKeys(alphaKeys);
-
-		step = redCurve.Domain().Length() / (GReal)(Size - 1);
-		u = redCurve.DomainStart();
-		pixelOfs = 0;
-		for (i = 0; i < Size; i++) {
-			r8 = (GUChar8)(redCurve.Evaluate(u) * (GReal)255);
-			g8 = (GUChar8)(greenCurve.Evaluate(u) * (GReal)255);
-			b8 = (GUChar8)(blueCurve.Evaluate(u) * (GReal)255);
-			a8 = (GUChar8)(alphaCurve.Evaluate(u) * (GReal)255);
-			pixels[pixelOfs++] = r8;
-			pixels[pixelOfs++] = g8;
-			pixels[pixelOfs++] = b8;
-			pixels[pixelOfs++] = a8;
-			u += step;
-		}		
-	}
-	else
-	// linear color interpolation
-	if (ColorInterpolation() == G_LINEAR_COLOR_INTERPOLATION) {
-
-		const GDynArray<GKeyValue>& keys = ColorKeys();
-		GInt32 i, j = (GInt32)keys.size(), pixelOfs;
-		GPolyLineCurve1D redCurve, greenCurve, blueCurve, alphaCurve;
-		GDynArray<GPolyLineKey1D> redKeys, greenKeys, blueKeys, alphaKeys;
-		GReal u, step;
-		GUChar8 r8, g8, b8, a8;
-
-		for (i = 0; i < j; i++) {
-			GVector4 v = keys[i].Vect4Value();
-			redKeys.push_back(GPolyLineKey1D(keys[i].TimePosition(), v[G_X]));
-			greenKeys.push_back(GPolyLineKey1D(keys[i].TimePosition(), v[G_Y]));
-			blueKeys.push_back(GPolyLineKey1D(keys[i].TimePosition(), v[G_Z]));
-			alphaKeys.push_back(GPolyLineKey1D(keys[i].TimePosition(), v[G_W]));
-		}
-
-		// reflect keys, is specified
-		if (ReflectKeys) {
-
-			GReal maxTime = redKeys.back().Parameter;
-		
-			for (i = j - 2; i >= 0; i--) {
-
-				redKeys.push_back(redKeys[i]);
-				redKeys.back().Parameter = ((GReal)2 * maxTime - redKeys.back().Parameter);
-				greenKeys.push_back(greenKeys[i]);
-				greenKeys.back().Parameter = ((GReal)2 * maxTime - greenKeys.back().Parameter);
-				blueKeys.push_back(blueKeys[i]);
-				blueKeys.back().Parameter = ((GReal)2 * maxTime - blueKeys.back().Parameter);
-				alphaKeys.push_back(alphaKeys[i]);
-				alphaKeys.back().Parameter = ((GReal)2 * maxTime - alphaKeys.back().Parameter);
-			}
-		}
-
-		redCurve.SetKeys(redKeys);
-		greenCurve.SetKeys(greenKeys);
-		blueCurve.SetKeys(blueKeys);
-		alphaCurve.SetKeys(alphaKeys);
-
-		step = redCurve.Domain().Length() / (GReal)(Size - 1);
-		u = redCurve.DomainStart();
-		pixelOfs = 0;
-		for (i = 0; i < Size; i++) {
-			r8 = (GUChar8)(redCurve.Evaluate(u) * (GReal)255);
-			g8 = (GUChar8)(greenCurve.Evaluate(u) * (GReal)255);
-			b8 = (GUChar8)(blueCurve.Evaluate(u) * (GReal)255);
-			a8 = (GUChar8)(alphaCurve.Evaluate(u) * (GReal)255);
-			pixels[pixelOfs++] = r8;
-			pixels[pixelOfs++] = g8;
-			pixels[pixelOfs++] = b8;
-			pixels[pixelOfs++] = a8;
-			u += step;
-		}
-	}
-	// constant color interpolation
-	else {
-		const GDynArray<GKeyValue>& keys = ColorKeys();
-		GInt32 i, j = (GInt32)keys.size(), pixelOfs;
-		GConstantProperty1D redCurve, greenCurve, blueCurve, alphaCurve;
-		GDynArray<GKeyValue> redKeys, greenKeys, blueKeys, alphaKeys;
-		GKeyValue val;
-		GTimeInterval valid;
-		GReal u, step;
-		GUChar8 r8, g8, b8, a8;
-
-		for (i = 0; i < j; i++) {
-			GVector4 v = keys[i].Vect4Value();
-			redKeys.push_back(GKeyValue(keys[i].TimePosition(), v[G_X]));
-			greenKeys.push_back(GKeyValue(keys[i].TimePosition(), v[G_Y]));
-			blueKeys.push_back(GKeyValue(keys[i].TimePosition(), v[G_Z]));
-			alphaKeys.push_back(GKeyValue(keys[i].TimePosition(), v[G_W]));
-		}
-		// reflect keys, is specified
-		if (ReflectKeys) {
-
-			GReal maxTime = redKeys.back().TimePosition();
-		
-			for (i = j - 2; i >= 0; i--) {
-
-				redKeys.push_back(redKeys[i]);
-				redKeys.back().SetTimePosition((GReal)2 * maxTime - redKeys.back().TimePosition());
-				greenKeys.push_back(greenKeys[i]);
-				greenKeys.back().SetTimePosition((GReal)2 * maxTime - greenKeys.back().TimePosition());
-				blueKeys.push_back(blueKeys[i]);
-				blueKeys.back().SetTimePosition((GReal)2 * maxTime - blueKeys.back().TimePosition());
-				alphaKeys.push_back(alphaKeys[i]);
-				alphaKeys.back().SetTimePosition((GReal)2 * maxTime - alphaKeys.back().TimePosition());
-			}
-		}
-
-		redCurve.SetKeys(redKeys);
-		greenCurve.SetKeys(greenKeys);
-		blueCurve.SetKeys(blueKeys);
-		alphaCurve.SetKeys(alphaKeys);
-
-		step = redCurve.Domain().Length() / (GReal)(Size - 1);
-		u = redCurve.Domain().Start();
-		pixelOfs = 0;
-		for (i = 0; i < Size; i++) {
-			redCurve.Value(val, valid, u, G_ABSOLUTE_VALUE);
-			r8 = (GUChar8)(val.RealValue() * (GReal)255);
-			greenCurve.Value(val, valid, u, G_ABSOLUTE_VALUE);
-			g8 = (GUChar8)(val.RealValue() * (GReal)255);
-			blueCurve.Value(val, valid, u, G_ABSOLUTE_VALUE);
-			b8 = (GUChar8)(val.RealValue() * (GReal)255);
-			alphaCurve.Value(val, valid, u, G_ABSOLUTE_VALUE);
-			a8 = (GUChar8)(val.RealValue() * (GReal)255);
-			pixels[pixelOfs++] = r8;
-			pixels[pixelOfs++] = g8;
-			pixels[pixelOfs++] = b8;
-			pixels[pixelOfs++] = a8;
-			u += step;
-		}
-
-		// pad spread mode		
-		if (SpreadMode() == G_PAD_COLOR_RAMP_SPREAD) {
-			GVector4 v = keys[j - 1].Vect4Value();
-			r8 = (GUChar8)(v[G_X] * (GReal)255);
-			g8 = (GUChar8)(v[G_Y] * (GReal)255);
-			b8 = (GUChar8)(v[G_Z] * (GReal)255);
-			a8 = (GUChar8)(v[G_W] * (GReal)255);
-			pixels[pixelOfs - 4] = r8;
-			pixels[pixelOfs - 3] = g8;
-			pixels[pixelOfs - 2] = b8;
-			pixels[pixelOfs - 1] = a8;
-		}
-	}
+const GColorRamp *GOpenGLGradientDesc::AcquireRampTexture(const GUInt32 Size, const GBool Mirrored,
+															const GLenum Target, GBool& NewTexture) {
+
+	const GColorRamp *ramp = NULL;
+	GLuint oldTexture = gGradientTexture;
+
+	NewTexture = G_FALSE;
+	if (!gRampTextures)
+		return NULL;
+
+	// plain tables do not depend on spread mode, so pad and repeat gradients can share them too
+	gGradientTexture = gRampTextures->Acquire(ColorKeys(), ColorInterpolation(),
+											  (Mirrored) ? G_REFLECT_COLOR_RAMP_SPREAD : G_PAD_COLOR_RAMP_SPREAD,
+											  Size, Mirrored, Target, ramp, NewTexture);
+	// release the old texture after the new acquisition, so an unchanged ramp is not regenerated
+	if (oldTexture)
+		gRampTextures->Release(oldTexture);
+	if (!gGradientTexture)
+		return NULL;
+	return ramp;
 }
 
 void GOpenGLGradientDesc::UpdateOpenGLTextureLinRad(const GRenderingQuality Quality, const GUInt32 MaxTextureSize,
 													const GBool MirroredRepeatSupported) {
 
 	GInt32 size = 512;
+	GBool mirrored = G_FALSE, newTexture;
 
 	// texture size depends on rendering quality
 	switch (Quality) {
@@ -288,30 +194,21 @@ void GOpenGLGradientDesc::UpdateOpenGLTextureLinRad(const GRenderingQuality Qual
 	if (size > (GInt32)MaxTextureSize)
 		size = (GInt32)MaxTextureSize;
 
-	// create pixelmap
-	GPixelMap pixMap;
-
-	if (SpreadMode() == G_REFLECT_COLOR_RAMP_SPREAD) {
-
-		if (ColorInterpolation() == G_CONSTANT_COLOR_INTERPOLATION || !MirroredRepeatSupported)
-			GenerateTexture1D(size, pixMap, G_TRUE);
-		else
-			GenerateTexture1D(size, pixMap, G_FALSE);
-	}
-	else
-		GenerateTexture1D(size, pixMap, G_FALSE);
+	// without "mirrored repeat" support (or with constant interpolation) reflection is built into the texture
+	if (SpreadMode() == G_REFLECT_COLOR_RAMP_SPREAD &&
+		(ColorInterpolation() == G_CONSTANT_COLOR_INTERPOLATION || !MirroredRepeatSupported))
+		mirrored = G_TRUE;
 
-	GUChar8 *pixels = pixMap.Pixels();
+	const GColorRamp *ramp = AcquireRampTexture((GUInt32)size, mirrored, GL_TEXTURE_1D, newTexture);
+	// an already uploaded texture can be shared as is
+	if (!ramp || !newTexture)
+		return;
 
-	// generate OpenGL texture
-	if (gGradientTexture == 0) {
-		glGenTextures(1, &gGradientTexture);
-		G_ASSERT(gGradientTexture > 0);
-	}
+	// ARGB32 words are uploaded as BGRA bytes, like pattern images
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glBindTexture(GL_TEXTURE_1D, gGradientTexture);
 	SetGLGradientQuality(Quality);
-	glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, (GLsizei)size, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid *)pixels);
+	glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, (GLsizei)size, 0, GL_BGRA, GL_UNSIGNED_BYTE, (const GLvoid *)ramp->Colors());
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
@@ -320,6 +217,7 @@ void GOpenGLGradientDesc::UpdateOpenGLTextureCon(const GRenderingQuality Quality
 
 
 	GInt32 size = 512, i, j;
+	GBool newTexture;
 
 	// texture size depends on rendering quality
 	switch (Quality) {
@@ -336,11 +234,13 @@ void GOpenGLGradientDesc::UpdateOpenGLTextureCon(const GRenderingQuality Quality
 	if (size > (GInt32)MaxTextureSize)
 		size = (GInt32)MaxTextureSize;
 
-	// create pixelmap
-	GPixelMap pixMap, texture;
+	const GColorRamp *ramp = AcquireRampTexture((GUInt32)size, G_FALSE, GL_TEXTURE_2D, newTexture);
+	// an already generated lookup texture can be shared as is
+	if (!ramp || !newTexture)
+		return;
 
-	GenerateTexture1D(size, pixMap, G_FALSE);
-	GUInt32 *pixelsSrc = (GUInt32 *)pixMap.Pixels();
+	const GUInt32 *pixelsSrc = ramp->Colors();
+	GPixelMap texture;
 
 	texture.Create(Atan2LookupTableSize, Atan2LookupTableSize, G_A8R8G8B8);
 	GUInt32 *pixelsDst = (GUInt32 *)texture.Pixels();
@@ -352,16 +252,9 @@ void GOpenGLGradientDesc::UpdateOpenGLTextureCon(const GRenderingQuality Quality
 		GFloat atan2Val = gAtan2LookupTable[i];
 		G_ASSERT(atan2Val >= 0 && atan2Val <= 1);
 		GInt32 u = (GInt32)(atan2Val * size);
-		G_ASSERT(u >= 0 && u < size);
-
-		GUInt32 argb = pixelsSrc[u];
-		pixelsDst[i] = argb;
-	}
-
-	// generate OpenGL texture
-	if (gGradientTexture == 0) {
-		glGenTextures(1, &gGradientTexture);
-		G_ASSERT(gGradientTexture > 0);
+		if (u >= size)
+			u = size - 1;
+		pixelsDst[i] = pixelsSrc[u];
 	}
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -370,7 +263,7 @@ void GOpenGLGradientDesc::UpdateOpenGLTextureCon(const GRenderingQuality Quality
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)Atan2LookupTableSize, (GLsizei)Atan2LookupTableSize,
-				0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid *)pixelsDst);
+				0, GL_BGRA, GL_UNSIGNED_BYTE, (GLvoid *)pixelsDst);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
@@ -734,6 +627,7 @@ GGradientDesc *GOpenGLBoard::CreateLinearGradient(const GPoint2& StartPoint, con
 		g->SetColorInterpolation(Interpolation);
 		g->SetSpreadMode(SpreadMode);
 		g->SetMatrix(Matrix);
+		g->gRampTextures = &gRampTextures;
 		gGradients.push_back(g);
 	}
 	return g;
@@ -755,6 +649,7 @@ GGradientDesc *GOpenGLBoard::CreateRadialGradient(const GPoint2& Center, const G
 		g->SetColorInterpolation(Interpolation);
 		g->SetSpreadMode(SpreadMode);
 		g->SetMatrix(Matrix);
+		g->gRampTextures = &gRampTextures;
 		gGradients.push_back(g);
 	}
 	return g;
@@ -773,6 +668,7 @@ GGradientDesc *GOpenGLBoard::CreateConicalGradient(const GPoint2& Center, const
 		g->SetColorKeys(ColorKeys);
 		g->SetColorInterpolation(Interpolation);
 		g->SetMatrix(Matrix);
+		g->gRampTextures = &gRampTextures;
 		gGradients.push_back(g);
 	}
 	return g;
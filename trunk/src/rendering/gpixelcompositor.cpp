@@ -0,0 +1,606 @@
+/****************************************************************************
+** $file: amanith/src/rendering/gpixelcompositor.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** Software (CPU) compositing on premultiplied ARGB pixels implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/rendering/gpixelcompositor.h"
+#include <cstring>
+
+// SSE2 is always available on x86-64, and on x86 when the compiler has been told so
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define G_COMPOSITOR_SSE2
+	#include <emmintrin.h>
+#endif
+
+/*!
+	\file gpixelcompositor.cpp
+	\brief Implementation file for GPixelCompositor class.
+*/
+
+namespace Amanith {
+
+// number of pixels composited at once, when the source is a constant color
+#define G_SOLID_SPAN_LENGTH 64
+
+// Porter-Duff blend factors
+#define G_F_ZERO	0
+#define G_F_ONE		1
+#define G_F_SA		2
+#define G_F_INV_SA	3
+#define G_F_DA		4
+#define G_F_INV_DA	5
+
+// compile-time description of a compositing operation; Porter-Duff operations are expressed as
+// Result = Src * FA + Dst * FB, for every channel (alpha included)
+template <GCompositingOperation OP>
+struct GCompOpTraits {
+	enum {
+		IsPorterDuff = 0,
+		FA = G_F_ZERO,
+		FB = G_F_ZERO,
+		Vectorized = 0
+	};
+};
+
+#define G_PORTER_DUFF_OP(_OP, _FA, _FB) \
+template <> \
+struct GCompOpTraits<_OP> { \
+	enum { \
+		IsPorterDuff = 1, \
+		FA = _FA, \
+		FB = _FB, \
+		Vectorized = 1 \
+	}; \
+};
+
+#define G_VECTORIZED_BLEND_OP(_OP) \
+template <> \
+struct GCompOpTraits<_OP> { \
+	enum { \
+		IsPorterDuff = 0, \
+		FA = G_F_ZERO, \
+		FB = G_F_ZERO, \
+		Vectorized = 1 \
+	}; \
+};
+
+G_PORTER_DUFF_OP(G_CLEAR_OP, G_F_ZERO, G_F_ZERO)
+G_PORTER_DUFF_OP(G_SRC_OP, G_F_ONE, G_F_ZERO)
+G_PORTER_DUFF_OP(G_DST_OP, G_F_ZERO, G_F_ONE)
+G_PORTER_DUFF_OP(G_SRC_OVER_OP, G_F_ONE, G_F_INV_SA)
+G_PORTER_DUFF_OP(G_DST_OVER_OP, G_F_INV_DA, G_F_ONE)
+G_PORTER_DUFF_OP(G_SRC_IN_OP, G_F_DA, G_F_ZERO)
+G_PORTER_DUFF_OP(G_DST_IN_OP, G_F_ZERO, G_F_SA)
+G_PORTER_DUFF_OP(G_SRC_OUT_OP, G_F_INV_DA, G_F_ZERO)
+G_PORTER_DUFF_OP(G_DST_OUT_OP, G_F_ZERO, G_F_INV_SA)
+G_PORTER_DUFF_OP(G_SRC_ATOP_OP, G_F_DA, G_F_INV_SA)
+G_PORTER_DUFF_OP(G_DST_ATOP_OP, G_F_INV_DA, G_F_SA)
+G_PORTER_DUFF_OP(G_XOR_OP, G_F_INV_DA, G_F_INV_SA)
+G_VECTORIZED_BLEND_OP(G_PLUS_OP)
+G_VECTORIZED_BLEND_OP(G_MULTIPLY_OP)
+G_VECTORIZED_BLEND_OP(G_SCREEN_OP)
+G_VECTORIZED_BLEND_OP(G_DARKEN_OP)
+G_VECTORIZED_BLEND_OP(G_LIGHTEN_OP)
+G_VECTORIZED_BLEND_OP(G_DIFFERENCE_OP)
+G_VECTORIZED_BLEND_OP(G_EXCLUSION_OP)
+
+#undef G_PORTER_DUFF_OP
+#undef G_VECTORIZED_BLEND_OP
+
+// *********************************************************************
+//                          Scalar kernels
+// *********************************************************************
+
+// x / 255, with rounding; exact for x in [0; 255 * 255]
+static inline GUInt32 Div255(const GUInt32 x) {
+
+	GUInt32 t = x + 128;
+	return ((t + (t >> 8)) >> 8);
+}
+
+static inline GUInt32 Mul255(const GUInt32 a, const GUInt32 b) {
+
+	return Div255(a * b);
+}
+
+static inline GUInt32 PorterDuffFactor(const GUInt32 Factor, const GUInt32 Sa, const GUInt32 Da) {
+
+	switch (Factor) {
+		case G_F_ZERO:
+			return 0;
+		case G_F_ONE:
+			return 255;
+		case G_F_SA:
+			return Sa;
+		case G_F_INV_SA:
+			return 255 - Sa;
+		case G_F_DA:
+			return Da;
+		default:
+			return 255 - Da;
+	}
+}
+
+// a blending channel value, expressed in [0; 1] range
+static inline GFloat BlendChannelFloat(const GCompositingOperation CompOp, const GFloat Sca, const GFloat Sa,
+									   const GFloat Dca, const GFloat Da) {
+
+	GFloat common = Sca * (1.0f - Da) + Dca * (1.0f - Sa);
+	GFloat m;
+
+	switch (CompOp) {
+		case G_COLOR_DODGE_OP:
+			if (Sca * Da + Dca * Sa >= Sa * Da)
+				return (Sa * Da + common);
+			return (Dca * Sa / (1.0f - Sca / Sa) + common);
+
+		case G_COLOR_BURN_OP:
+			if (Sca * Da + Dca * Sa <= Sa * Da)
+				return common;
+			return (Sa * (Sca * Da + Dca * Sa - Sa * Da) / Sca + common);
+
+		case G_SOFT_LIGHT_OP:
+			m = (Da > 0.0f) ? (Dca / Da) : 0.0f;
+			if (2.0f * Sca < Sa)
+				return (Dca * (Sa - (1.0f - m) * (2.0f * Sca - Sa)) + common);
+			if (8.0f * Dca <= Da)
+				return (Dca * (Sa - (1.0f - m) * (2.0f * Sca - Sa) * (3.0f - 8.0f * m)) + common);
+			return (Dca * Sa + (GMath::Sqrt(m) * Da - Dca) * (2.0f * Sca - Sa) + common);
+
+		default:
+			return common;
+	}
+}
+
+// a single blending channel; all values are premultiplied and in the [0; 255] range
+static inline GInt32 BlendChannel(const GCompositingOperation CompOp, const GInt32 s, const GInt32 sa,
+								  const GInt32 d, const GInt32 da) {
+
+	GInt32 a, b;
+
+	switch (CompOp) {
+		case G_PLUS_OP:
+			return (s + d);
+		case G_MULTIPLY_OP:
+			return (GInt32)(Mul255(s, d) + Mul255(s, 255 - da) + Mul255(d, 255 - sa));
+		case G_SCREEN_OP:
+			return (s + d - (GInt32)Mul255(s, d));
+		case G_DARKEN_OP:
+		case G_LIGHTEN_OP:
+			a = (GInt32)Mul255(s, da);
+			b = (GInt32)Mul255(d, sa);
+			if (CompOp == G_DARKEN_OP)
+				a = GMath::Min(a, b);
+			else
+				a = GMath::Max(a, b);
+			return (a + (GInt32)(Mul255(s, 255 - da) + Mul255(d, 255 - sa)));
+		case G_DIFFERENCE_OP:
+			return (s + d - 2 * GMath::Min((GInt32)Mul255(s, da), (GInt32)Mul255(d, sa)));
+		case G_EXCLUSION_OP:
+			return (s + d - 2 * (GInt32)Mul255(s, d));
+		case G_OVERLAY_OP:
+		case G_HARD_LIGHT_OP:
+			a = s * (255 - da) + d * (255 - sa);
+			if ((CompOp == G_OVERLAY_OP && 2 * d <= da) || (CompOp == G_HARD_LIGHT_OP && 2 * s <= sa))
+				a += 2 * s * d;
+			else
+				a += sa * da - 2 * (da - d) * (sa - s);
+			if (a < 0)
+				return 0;
+			return (GInt32)Div255(GMath::Min(a, 255 * 255));
+		default:
+			return (GInt32)(BlendChannelFloat(CompOp, (GFloat)s / 255.0f, (GFloat)sa / 255.0f,
+											  (GFloat)d / 255.0f, (GFloat)da / 255.0f) * 255.0f + 0.5f);
+	}
+}
+
+static inline GUInt32 ClampChannel(const GInt32 Value) {
+
+	return (Value < 0) ? 0 : ((Value > 255) ? 255 : (GUInt32)Value);
+}
+
+template <GCompositingOperation OP>
+static inline GUInt32 CompositePixel(const GUInt32 Src, const GUInt32 Dst) {
+
+	GUInt32 sa = Src >> 24, da = Dst >> 24, fa, fb, res, shift, a;
+
+	if (GCompOpTraits<OP>::IsPorterDuff) {
+		fa = PorterDuffFactor(GCompOpTraits<OP>::FA, sa, da);
+		fb = PorterDuffFactor(GCompOpTraits<OP>::FB, sa, da);
+		res = 0;
+		for (shift = 0; shift < 32; shift += 8)
+			res |= GMath::Min((GUInt32)255, Mul255((Src >> shift) & 0xFF, fa) +
+											Mul255((Dst >> shift) & 0xFF, fb)) << shift;
+		return res;
+	}
+	if (OP == G_PLUS_OP)
+		a = GMath::Min((GUInt32)255, sa + da);
+	else
+		a = sa + da - Mul255(sa, da);
+	res = a << 24;
+	for (shift = 0; shift < 24; shift += 8)
+		res |= ClampChannel(BlendChannel(OP, (GInt32)((Src >> shift) & 0xFF), (GInt32)sa,
+										 (GInt32)((Dst >> shift) & 0xFF), (GInt32)da)) << shift;
+	return res;
+}
+
+// Dst + (Res - Dst) * Coverage
+static inline GUInt32 LerpPixel(const GUInt32 Dst, const GUInt32 Res, const GUInt32 Coverage) {
+
+	GUInt32 res = 0, shift, invCoverage = 255 - Coverage;
+
+	for (shift = 0; shift < 32; shift += 8)
+		res |= Div255(((Res >> shift) & 0xFF) * Coverage + ((Dst >> shift) & 0xFF) * invCoverage) << shift;
+	return res;
+}
+
+// *********************************************************************
+//                           SSE2 kernels
+// *********************************************************************
+
+#if defined(G_COMPOSITOR_SSE2)
+
+// every register holds two pixels, unpacked into 16bit lanes (blue, green, red, alpha)
+static inline __m128i Div255x8(const __m128i x) {
+
+	__m128i t = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static inline __m128i Mul255x8(const __m128i a, const __m128i b) {
+
+	return Div255x8(_mm_mullo_epi16(a, b));
+}
+
+static inline __m128i BroadcastAlpha(const __m128i x) {
+
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+template <GUInt32 FACTOR>
+static inline __m128i ApplyFactor(const __m128i x, const __m128i Sa, const __m128i Da) {
+
+	const __m128i full = _mm_set1_epi16(255);
+
+	switch (FACTOR) {
+		case G_F_ZERO:
+			return _mm_setzero_si128();
+		case G_F_ONE:
+			return x;
+		case G_F_SA:
+			return Mul255x8(x, Sa);
+		case G_F_INV_SA:
+			return Mul255x8(x, _mm_sub_epi16(full, Sa));
+		case G_F_DA:
+			return Mul255x8(x, Da);
+		default:
+			return Mul255x8(x, _mm_sub_epi16(full, Da));
+	}
+}
+
+template <GCompositingOperation OP>
+static inline __m128i CompositePixels(const __m128i s, const __m128i d) {
+
+	const __m128i full = _mm_set1_epi16(255);
+	const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	__m128i sa = BroadcastAlpha(s), da = BroadcastAlpha(d), r, a, b, common;
+
+	// results must be clamped to 255 before any coverage interpolation
+	if (GCompOpTraits<OP>::IsPorterDuff)
+		return _mm_min_epi16(_mm_add_epi16(ApplyFactor<GCompOpTraits<OP>::FA>(s, sa, da),
+										   ApplyFactor<GCompOpTraits<OP>::FB>(d, sa, da)), full);
+	if (OP == G_PLUS_OP)
+		return _mm_min_epi16(_mm_add_epi16(s, d), full);
+
+	common = _mm_add_epi16(Mul255x8(s, _mm_sub_epi16(full, da)), Mul255x8(d, _mm_sub_epi16(full, sa)));
+	switch (OP) {
+		case G_MULTIPLY_OP:
+			r = _mm_add_epi16(Mul255x8(s, d), common);
+			break;
+		case G_SCREEN_OP:
+			r = _mm_sub_epi16(_mm_add_epi16(s, d), Mul255x8(s, d));
+			break;
+		case G_DARKEN_OP:
+			r = _mm_add_epi16(_mm_min_epi16(Mul255x8(s, da), Mul255x8(d, sa)), common);
+			break;
+		case G_LIGHTEN_OP:
+			r = _mm_add_epi16(_mm_max_epi16(Mul255x8(s, da), Mul255x8(d, sa)), common);
+			break;
+		case G_DIFFERENCE_OP:
+			a = _mm_min_epi16(Mul255x8(s, da), Mul255x8(d, sa));
+			r = _mm_subs_epu16(_mm_add_epi16(s, d), _mm_add_epi16(a, a));
+			break;
+		case G_EXCLUSION_OP:
+			a = Mul255x8(s, d);
+			r = _mm_subs_epu16(_mm_add_epi16(s, d), _mm_add_epi16(a, a));
+			break;
+		default:
+			r = s;
+			break;
+	}
+	// alpha is always Sa + Da - Sa * Da
+	b = _mm_sub_epi16(_mm_add_epi16(sa, da), Mul255x8(sa, da));
+	return _mm_or_si128(_mm_andnot_si128(alphaMask, _mm_min_epi16(r, full)), _mm_and_si128(alphaMask, b));
+}
+
+// Dst + (Res - Dst) * Coverage, where coverage has been broadcasted to all lanes of the same pixel
+static inline __m128i LerpPixels(const __m128i d, const __m128i r, const __m128i Coverage) {
+
+	return Div255x8(_mm_add_epi16(_mm_mullo_epi16(r, Coverage),
+								  _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), Coverage))));
+}
+
+// composite as many pixels as possible, four at a time; it returns the number of processed pixels
+template <GCompositingOperation OP, GInt32 VECTORIZED>
+struct GCompositeSpanSSE2 {
+	static inline GUInt32 Run(const GUInt32 *, GUInt32 *, const GUInt32, const GUInt32, const GUChar8 *) {
+		return 0;
+	}
+};
+
+template <GCompositingOperation OP>
+struct GCompositeSpanSSE2<OP, 1> {
+	static inline GUInt32 Run(const GUInt32 *Src, GUInt32 *Dst, const GUInt32 Count, const GUInt32 Opacity,
+							  const GUChar8 *Mask) {
+
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i opacity = _mm_set1_epi16((GInt16)Opacity);
+		__m128i s, d, sl, sh, dl, dh, rl, rh, c, cl, ch;
+		GUInt32 i, m;
+
+		for (i = 0; i + 4 <= Count; i += 4) {
+			s = _mm_loadu_si128((const __m128i *)(Src + i));
+			d = _mm_loadu_si128((const __m128i *)(Dst + i));
+			sl = _mm_unpacklo_epi8(s, zero);
+			sh = _mm_unpackhi_epi8(s, zero);
+			dl = _mm_unpacklo_epi8(d, zero);
+			dh = _mm_unpackhi_epi8(d, zero);
+			rl = CompositePixels<OP>(sl, dl);
+			rh = CompositePixels<OP>(sh, dh);
+			if (Mask) {
+				std::memcpy(&m, Mask + i, 4);
+				c = Mul255x8(_mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)m), zero), opacity);
+				c = _mm_unpacklo_epi16(c, c);
+				cl = _mm_unpacklo_epi32(c, c);
+				ch = _mm_unpackhi_epi32(c, c);
+				rl = LerpPixels(dl, rl, cl);
+				rh = LerpPixels(dh, rh, ch);
+			}
+			else
+			if (Opacity < 255) {
+				rl = LerpPixels(dl, rl, opacity);
+				rh = LerpPixels(dh, rh, opacity);
+			}
+			_mm_storeu_si128((__m128i *)(Dst + i), _mm_packus_epi16(rl, rh));
+		}
+		return i;
+	}
+};
+
+#endif
+
+// *********************************************************************
+//                          Span functions
+// *********************************************************************
+
+template <GCompositingOperation OP>
+static void CompositeSpanT(const GUInt32 *Src, GUInt32 *Dst, const GUInt32 Count, const GUInt32 Opacity,
+						   const GUChar8 *Mask) {
+
+	GUInt32 i = 0, c, r;
+
+	if (Opacity == 0)
+		return;
+#if defined(G_COMPOSITOR_SSE2)
+	i = GCompositeSpanSSE2<OP, GCompOpTraits<OP>::Vectorized>::Run(Src, Dst, Count, Opacity, Mask);
+#endif
+	for (; i < Count; ++i) {
+		c = (Mask) ? Mul255(Mask[i], Opacity) : Opacity;
+		if (c == 0)
+			continue;
+		r = CompositePixel<OP>(Src[i], Dst[i]);
+		Dst[i] = (c < 255) ? LerpPixel(Dst[i], r, c) : r;
+	}
+}
+
+// span functions table, indexed by GCompositingOperation
+static const GCompositingSpanFunction gSpanFunctions[G_EXCLUSION_OP + 1] = {
+	CompositeSpanT<G_CLEAR_OP>,
+	CompositeSpanT<G_SRC_OP>,
+	CompositeSpanT<G_DST_OP>,
+	CompositeSpanT<G_SRC_OVER_OP>,
+	CompositeSpanT<G_DST_OVER_OP>,
+	CompositeSpanT<G_SRC_IN_OP>,
+	CompositeSpanT<G_DST_IN_OP>,
+	CompositeSpanT<G_SRC_OUT_OP>,
+	CompositeSpanT<G_DST_OUT_OP>,
+	CompositeSpanT<G_SRC_ATOP_OP>,
+	CompositeSpanT<G_DST_ATOP_OP>,
+	CompositeSpanT<G_XOR_OP>,
+	CompositeSpanT<G_PLUS_OP>,
+	CompositeSpanT<G_MULTIPLY_OP>,
+	CompositeSpanT<G_SCREEN_OP>,
+	CompositeSpanT<G_OVERLAY_OP>,
+	CompositeSpanT<G_DARKEN_OP>,
+	CompositeSpanT<G_LIGHTEN_OP>,
+	CompositeSpanT<G_COLOR_DODGE_OP>,
+	CompositeSpanT<G_COLOR_BURN_OP>,
+	CompositeSpanT<G_HARD_LIGHT_OP>,
+	CompositeSpanT<G_SOFT_LIGHT_OP>,
+	CompositeSpanT<G_DIFFERENCE_OP>,
+	CompositeSpanT<G_EXCLUSION_OP>
+};
+
+#undef G_F_ZERO
+#undef G_F_ONE
+#undef G_F_SA
+#undef G_F_INV_SA
+#undef G_F_DA
+#undef G_F_INV_DA
+
+// *********************************************************************
+//                           GPixelCompositor
+// *********************************************************************
+
+GCompositingSpanFunction GPixelCompositor::SpanFunction(const GCompositingOperation CompOp) {
+
+	if ((GUInt32)CompOp > (GUInt32)G_EXCLUSION_OP)
+		return NULL;
+	return gSpanFunctions[CompOp];
+}
+
+void GPixelCompositor::CompositeSpan(const GCompositingOperation CompOp, const GUInt32 *Src, GUInt32 *Dst,
+									 const GUInt32 Count, const GUInt32 Opacity, const GUChar8 *Mask) {
+
+	GCompositingSpanFunction f = SpanFunction(CompOp);
+
+	if (f && Src && Dst)
+		f(Src, Dst, Count, GMath::Min(Opacity, (GUInt32)255), Mask);
+}
+
+void GPixelCompositor::CompositeSpan(const GCompositingOperation CompOp, const GUInt32 SrcColor, GUInt32 *Dst,
+									 const GUInt32 Count, const GUInt32 Opacity, const GUChar8 *Mask) {
+
+	GCompositingSpanFunction f = SpanFunction(CompOp);
+	GUInt32 i, n, src[G_SOLID_SPAN_LENGTH];
+
+	if (!f || !Dst)
+		return;
+
+	for (i = 0; i < G_SOLID_SPAN_LENGTH; ++i)
+		src[i] = SrcColor;
+	for (i = 0; i < Count; i += n) {
+		n = GMath::Min(Count - i, (GUInt32)G_SOLID_SPAN_LENGTH);
+		f(src, Dst + i, n, GMath::Min(Opacity, (GUInt32)255), (Mask) ? Mask + i : NULL);
+	}
+}
+
+GError GPixelCompositor::Composite(const GCompositingOperation CompOp, const GPixelMap& Src, GPixelMap& Dst,
+								   const GInt32 DstX, const GInt32 DstY, const GUInt32 Opacity,
+								   const GPixelMap *Mask) {
+
+	GCompositingSpanFunction f = SpanFunction(CompOp);
+	GInt32 x0, y0, x1, y1, y, w, i;
+	GDynArray<GUInt32> srcRow;
+	const GUInt32 *src;
+	GUInt32 *dst;
+	const GUChar8 *mask;
+
+	if (!f)
+		return G_INVALID_PARAMETER;
+	if (Src.BytesPerPixel() != 4 || Dst.BytesPerPixel() != 4)
+		return G_INVALID_FORMAT;
+	if (Mask && (!Mask->IsGrayScale() || Mask->Width() != Src.Width() || Mask->Height() != Src.Height()))
+		return G_INVALID_PARAMETER;
+
+	// clip source rectangle against destination
+	x0 = GMath::Max(DstX, (GInt32)0);
+	y0 = GMath::Max(DstY, (GInt32)0);
+	x1 = GMath::Min(DstX + (GInt32)Src.Width(), (GInt32)Dst.Width());
+	y1 = GMath::Min(DstY + (GInt32)Src.Height(), (GInt32)Dst.Height());
+	if (x0 >= x1 || y0 >= y1)
+		return G_NO_ERROR;
+	w = x1 - x0;
+
+	if (Src.PixelFormat() == G_R8G8B8)
+		srcRow.resize(w);
+
+	for (y = y0; y < y1; ++y) {
+		src = (const GUInt32 *)Src.Pixels() + (y - DstY) * Src.Width() + (x0 - DstX);
+		dst = (GUInt32 *)Dst.Pixels() + y * Dst.Width() + x0;
+		mask = (Mask) ? Mask->Pixels() + (y - DstY) * Mask->Width() + (x0 - DstX) : NULL;
+		// opaque images
+		if (Src.PixelFormat() == G_R8G8B8) {
+			for (i = 0; i < w; ++i)
+				srcRow[i] = src[i] | 0xFF000000;
+			src = &srcRow[0];
+		}
+		if (Dst.PixelFormat() == G_R8G8B8) {
+			for (i = 0; i < w; ++i)
+				dst[i] |= 0xFF000000;
+		}
+		f(src, dst, (GUInt32)w, GMath::Min(Opacity, (GUInt32)255), mask);
+	}
+	return G_NO_ERROR;
+}
+
+void GPixelCompositor::Premultiply(GUInt32 *Pixels, const GUInt32 Count) {
+
+	GUInt32 i, c, a;
+
+	if (!Pixels)
+		return;
+	for (i = 0; i < Count; ++i) {
+		c = Pixels[i];
+		a = c >> 24;
+		if (a == 255)
+			continue;
+		Pixels[i] = (a << 24) | (Mul255((c >> 16) & 0xFF, a) << 16) | (Mul255((c >> 8) & 0xFF, a) << 8) |
+					Mul255(c & 0xFF, a);
+	}
+}
+
+void GPixelCompositor::Unpremultiply(GUInt32 *Pixels, const GUInt32 Count) {
+
+	GUInt32 i, c, a, r, g, b;
+
+	if (!Pixels)
+		return;
+	for (i = 0; i < Count; ++i) {
+		c = Pixels[i];
+		a = c >> 24;
+		if (a == 255)
+			continue;
+		if (a == 0) {
+			Pixels[i] = 0;
+			continue;
+		}
+		r = GMath::Min((((c >> 16) & 0xFF) * 255 + a / 2) / a, (GUInt32)255);
+		g = GMath::Min((((c >> 8) & 0xFF) * 255 + a / 2) / a, (GUInt32)255);
+		b = GMath::Min(((c & 0xFF) * 255 + a / 2) / a, (GUInt32)255);
+		Pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+	}
+}
+
+GError GPixelCompositor::Premultiply(GPixelMap& Image) {
+
+	if (Image.PixelFormat() != G_A8R8G8B8)
+		return G_INVALID_OPERATION;
+	Premultiply((GUInt32 *)Image.Pixels(), (GUInt32)Image.PixelsCount());
+	return G_NO_ERROR;
+}
+
+GError GPixelCompositor::Unpremultiply(GPixelMap& Image) {
+
+	if (Image.PixelFormat() != G_A8R8G8B8)
+		return G_INVALID_OPERATION;
+	Unpremultiply((GUInt32 *)Image.Pixels(), (GUInt32)Image.PixelsCount());
+	return G_NO_ERROR;
+}
+
+#undef G_SOLID_SPAN_LENGTH
+
+};	// end namespace Amanith
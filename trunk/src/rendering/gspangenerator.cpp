@@ -0,0 +1,769 @@
+/****************************************************************************
+** $file: amanith/src/rendering/gspangenerator.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** Software (CPU) paint span generators implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/rendering/gspangenerator.h"
+#include "amanith/rendering/gpixelcompositor.h"
+#include "amanith/geometry/gdistance.h"
+#include "amanith/geometry/gxform.h"
+#include "amanith/geometry/gxformconv.h"
+
+// SSE2 is always available on x86-64, and on x86 when the compiler has been told so
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define G_SPANGENERATOR_SSE2
+	#include <emmintrin.h>
+#endif
+
+/*!
+	\file gspangenerator.cpp
+	\brief Implementation file for span generator classes.
+*/
+
+namespace Amanith {
+
+// number of ramp parameters evaluated at once by radial and conical gradients
+#define G_GRADIENT_CHUNK_LENGTH 128
+// ramp parameters are clamped into [-G_MAX_RAMP_PARAMETER; G_MAX_RAMP_PARAMETER] before being converted into indexes
+#define G_MAX_RAMP_PARAMETER 1048576.0f
+
+// atan(x) polynomial coefficients, for x in [0; 1] (max error about 1e-5 radians)
+#define G_ATAN_C0 0.99986600f
+#define G_ATAN_C1 -0.33029950f
+#define G_ATAN_C2 0.18014100f
+#define G_ATAN_C3 -0.08513300f
+#define G_ATAN_C4 0.02083510f
+
+// *********************************************************************
+//                            GSpanGenerator
+// *********************************************************************
+
+GSpanGenerator::GSpanGenerator() {
+}
+
+GSpanGenerator::~GSpanGenerator() {
+}
+
+GError GSpanGenerator::Fill(GPixelMap& Image, const GInt32 X, const GInt32 Y) const {
+
+	GInt32 i;
+
+	if (Image.PixelFormat() != G_A8R8G8B8)
+		return G_INVALID_PARAMETER;
+
+	GUInt32 *pixels = (GUInt32 *)Image.Pixels();
+	for (i = 0; i < Image.Height(); ++i) {
+		Generate(X, Y + i, pixels, (GUInt32)Image.Width());
+		pixels += Image.Width();
+	}
+	return G_NO_ERROR;
+}
+
+// *********************************************************************
+//                        GGradientSpanGenerator
+// *********************************************************************
+
+// angle (normalized in [0; 1), counterclockwise from the x axis) of the specified vector
+static inline GFloat NormalizedAngle(const GFloat X, const GFloat Y) {
+
+	GFloat ax = GMath::Abs(X), ay = GMath::Abs(Y);
+	GFloat mx = GMath::Max(ax, ay), mn = GMath::Min(ax, ay);
+	GFloat a, s, r;
+
+	if (mx <= 0.0f)
+		return 0.0f;
+
+	a = mn / mx;
+	s = a * a;
+	r = a * (G_ATAN_C0 + s * (G_ATAN_C1 + s * (G_ATAN_C2 + s * (G_ATAN_C3 + s * G_ATAN_C4))));
+	if (ay > ax)
+		r = (GFloat)G_PI_OVER2 - r;
+	if (X < 0.0f)
+		r = (GFloat)G_PI - r;
+	if (Y < 0.0f)
+		r = -r;
+	r *= (GFloat)(1.0 / G_2PI);
+	if (r < 0.0f)
+		r += 1.0f;
+	return r;
+}
+
+// ramp table index corresponding to the specified parameter (Last is the last valid index)
+static inline GInt32 RampIndex(const GFloat U, const GInt32 Last, const GColorRampSpreadMode SpreadMode) {
+
+	GFloat u = GMath::Clamp(U, -G_MAX_RAMP_PARAMETER, G_MAX_RAMP_PARAMETER);
+	GInt32 i;
+
+	switch (SpreadMode) {
+		case G_REPEAT_COLOR_RAMP_SPREAD:
+			u -= (GFloat)GMath::Floor(u);
+			i = (GInt32)(u * (GFloat)Last + 0.5f);
+			if (i >= Last)
+				i -= Last;
+			return i;
+
+		case G_REFLECT_COLOR_RAMP_SPREAD:
+			u -= 2.0f * (GFloat)GMath::Floor(u * 0.5f);
+			i = (GInt32)(u * (GFloat)Last + 0.5f);
+			if (i > Last)
+				i = 2 * Last - i;
+			return i;
+
+		default:
+			return (GInt32)GMath::Clamp(u * (GFloat)Last + 0.5f, 0.0f, (GFloat)Last);
+	}
+}
+
+#if defined(G_SPANGENERATOR_SSE2)
+
+// floor of 4 floats, valid for values in the 32 bit integers range
+static inline __m128 Floor4(const __m128 x) {
+
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+// select a where mask is set, b elsewhere
+static inline __m128 Select4(const __m128 Mask, const __m128 a, const __m128 b) {
+
+	return _mm_or_ps(_mm_and_ps(Mask, a), _mm_andnot_ps(Mask, b));
+}
+
+#endif
+
+GGradientSpanGenerator::GGradientSpanGenerator() : GSpanGenerator() {
+
+	gType = G_LINEAR_GRADIENT;
+	gFocusCenter[0] = gFocusCenter[1] = 0;
+	gQCoef = -1;
+}
+
+GError GGradientSpanGenerator::SetGradient(const GGradientDesc& Gradient, const GMatrix33& DeviceToLogical,
+										   const GUInt32 RampSize) {
+
+	GError err;
+	GMatrix33 m;
+	GReal r0[3], r1[3];
+	GUInt32 i;
+
+	// software gradients use the spread mode directly, so the ramp never needs to be mirrored
+	err = gRamp.Build(Gradient.ColorKeys(), Gradient.ColorInterpolation(), Gradient.SpreadMode(), RampSize,
+					  G_TRUE, G_FALSE);
+	if (err != G_NO_ERROR)
+		return err;
+
+	gType = Gradient.Type();
+	Identity(gPaintMatrix);
+
+	if (gType == G_LINEAR_GRADIENT) {
+
+		// affine transform end points
+		GPoint2 sPoint = Gradient.Matrix() * Gradient.StartPoint();
+		GPoint2 ePoint = Gradient.Matrix() * Gradient.AuxPoint();
+		// calculate direction
+		GVector2 n = ePoint - sPoint;
+		GReal l = n.LengthSquared();
+
+		if (l <= G_EPSILON)
+			n.Set(0, 0);
+		else
+			n /= l;
+		// u = n . (DeviceToLogical * p) - n . sPoint
+		for (i = 0; i < 3; ++i)
+			gPaintMatrix[0][i] = n[G_X] * DeviceToLogical[0][i] + n[G_Y] * DeviceToLogical[1][i];
+		gPaintMatrix[0][2] -= n[G_X] * sPoint[G_X] + n[G_Y] * sPoint[G_Y];
+	}
+	else
+	if (gType == G_RADIAL_GRADIENT) {
+
+		GPoint2 pc = Gradient.StartPoint();
+		GPoint2 pf = Gradient.AuxPoint();
+		GReal radius = GMath::Max(Gradient.Radius(), (GReal)G_EPSILON);
+
+		// if focus is outside gradient circle, we must reset it
+		if (Distance(pf, pc) > radius)
+			pf = pc;
+
+		GVector2 fc = pf - pc;
+		gQCoef = fc.LengthSquared() - GMath::Sqr(radius);
+		// a focus lying exactly on the circle would make the ramp parameter infinite, so pull it a bit inside
+		if (gQCoef > -G_EPSILON * GMath::Sqr(radius)) {
+			fc *= (GReal)0.999;
+			pf = pc + fc;
+			gQCoef = fc.LengthSquared() - GMath::Sqr(radius);
+		}
+		gFocusCenter[0] = fc[G_X];
+		gFocusCenter[1] = fc[G_Y];
+
+		gPaintMatrix = Gradient.InverseMatrix() * DeviceToLogical;
+		gPaintMatrix[0][2] -= pf[G_X];
+		gPaintMatrix[1][2] -= pf[G_Y];
+	}
+	else {
+		const GPoint2& pc = Gradient.StartPoint();
+		GVector2 dir = Gradient.AuxPoint() - pc;
+		GReal l = dir.Length();
+
+		if (l <= G_EPSILON)
+			dir.Set(1, 0);
+		else
+			dir /= l;
+
+		m = Gradient.InverseMatrix() * DeviceToLogical;
+		m[0][2] -= pc[G_X];
+		m[1][2] -= pc[G_Y];
+		// rotate by the gradient direction: [cos, sin, -sin, cos]
+		for (i = 0; i < 3; ++i) {
+			r0[i] = dir[G_X] * m[0][i] + dir[G_Y] * m[1][i];
+			r1[i] = -dir[G_Y] * m[0][i] + dir[G_X] * m[1][i];
+		}
+		for (i = 0; i < 3; ++i) {
+			gPaintMatrix[0][i] = r0[i];
+			gPaintMatrix[1][i] = r1[i];
+		}
+	}
+	return G_NO_ERROR;
+}
+
+void GGradientSpanGenerator::RadialParameters(const GReal X, const GReal Y, GFloat *U, const GUInt32 Count) const {
+
+	// point relative to the focus, it moves linearly along the span
+	GFloat px = (GFloat)(gPaintMatrix[0][0] * X + gPaintMatrix[0][1] * Y + gPaintMatrix[0][2]);
+	GFloat py = (GFloat)(gPaintMatrix[1][0] * X + gPaintMatrix[1][1] * Y + gPaintMatrix[1][2]);
+	GFloat dx = (GFloat)gPaintMatrix[0][0];
+	GFloat dy = (GFloat)gPaintMatrix[1][0];
+	GFloat fcx = (GFloat)gFocusCenter[0];
+	GFloat fcy = (GFloat)gFocusCenter[1];
+	GFloat q = (GFloat)gQCoef;
+	GFloat invNegQ = (GFloat)(-1 / gQCoef);
+	GFloat x, y, d;
+	GUInt32 i = 0;
+
+	// the ramp parameter is the positive root of q * u^2 + 2 * (p . fc) * u + |p|^2 = 0
+#if defined(G_SPANGENERATOR_SSE2)
+	__m128 idx = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	__m128 four = _mm_set1_ps(4.0f);
+	__m128 px4 = _mm_set1_ps(px), py4 = _mm_set1_ps(py);
+	__m128 dx4 = _mm_set1_ps(dx), dy4 = _mm_set1_ps(dy);
+	__m128 fcx4 = _mm_set1_ps(fcx), fcy4 = _mm_set1_ps(fcy);
+	__m128 q4 = _mm_set1_ps(q), invNegQ4 = _mm_set1_ps(invNegQ);
+	__m128 x4, y4, d4, pp4;
+
+	for (; i + 4 <= Count; i += 4) {
+		x4 = _mm_add_ps(px4, _mm_mul_ps(idx, dx4));
+		y4 = _mm_add_ps(py4, _mm_mul_ps(idx, dy4));
+		d4 = _mm_add_ps(_mm_mul_ps(x4, fcx4), _mm_mul_ps(y4, fcy4));
+		pp4 = _mm_add_ps(_mm_mul_ps(x4, x4), _mm_mul_ps(y4, y4));
+		pp4 = _mm_sub_ps(_mm_mul_ps(d4, d4), _mm_mul_ps(q4, pp4));
+		_mm_storeu_ps(U + i, _mm_mul_ps(_mm_add_ps(d4, _mm_sqrt_ps(pp4)), invNegQ4));
+		idx = _mm_add_ps(idx, four);
+	}
+#endif
+	for (; i < Count; ++i) {
+		x = px + (GFloat)i * dx;
+		y = py + (GFloat)i * dy;
+		d = x * fcx + y * fcy;
+		U[i] = (d + GMath::Sqrt(d * d - q * (x * x + y * y))) * invNegQ;
+	}
+}
+
+void GGradientSpanGenerator::ConicalParameters(const GReal X, const GReal Y, GFloat *U, const GUInt32 Count) const {
+
+	// point in the rotated, center relative, space; it moves linearly along the span
+	GFloat px = (GFloat)(gPaintMatrix[0][0] * X + gPaintMatrix[0][1] * Y + gPaintMatrix[0][2]);
+	GFloat py = (GFloat)(gPaintMatrix[1][0] * X + gPaintMatrix[1][1] * Y + gPaintMatrix[1][2]);
+	GFloat dx = (GFloat)gPaintMatrix[0][0];
+	GFloat dy = (GFloat)gPaintMatrix[1][0];
+	GUInt32 i = 0;
+
+#if defined(G_SPANGENERATOR_SSE2)
+	__m128 idx = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	__m128 four = _mm_set1_ps(4.0f);
+	__m128 px4 = _mm_set1_ps(px), py4 = _mm_set1_ps(py);
+	__m128 dx4 = _mm_set1_ps(dx), dy4 = _mm_set1_ps(dy);
+	__m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	__m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	__m128 tiny = _mm_set1_ps(1e-30f);
+	__m128 halfPi = _mm_set1_ps((GFloat)G_PI_OVER2), pi = _mm_set1_ps((GFloat)G_PI);
+	__m128 inv2Pi = _mm_set1_ps((GFloat)(1.0 / G_2PI));
+	__m128 x4, y4, ax, ay, a, s, r;
+
+	for (; i + 4 <= Count; i += 4) {
+		x4 = _mm_add_ps(px4, _mm_mul_ps(idx, dx4));
+		y4 = _mm_add_ps(py4, _mm_mul_ps(idx, dy4));
+		ax = _mm_and_ps(x4, signMask);
+		ay = _mm_and_ps(y4, signMask);
+		a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), tiny));
+		s = _mm_mul_ps(a, a);
+		r = _mm_add_ps(_mm_set1_ps(G_ATAN_C3), _mm_mul_ps(s, _mm_set1_ps(G_ATAN_C4)));
+		r = _mm_add_ps(_mm_set1_ps(G_ATAN_C2), _mm_mul_ps(s, r));
+		r = _mm_add_ps(_mm_set1_ps(G_ATAN_C1), _mm_mul_ps(s, r));
+		r = _mm_add_ps(_mm_set1_ps(G_ATAN_C0), _mm_mul_ps(s, r));
+		r = _mm_mul_ps(a, r);
+		r = Select4(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(halfPi, r), r);
+		r = Select4(_mm_cmplt_ps(x4, zero), _mm_sub_ps(pi, r), r);
+		r = Select4(_mm_cmplt_ps(y4, zero), _mm_sub_ps(zero, r), r);
+		r = _mm_mul_ps(r, inv2Pi);
+		r = _mm_add_ps(r, _mm_and_ps(_mm_cmplt_ps(r, zero), one));
+		_mm_storeu_ps(U + i, r);
+		idx = _mm_add_ps(idx, four);
+	}
+#endif
+	for (; i < Count; ++i)
+		U[i] = NormalizedAngle(px + (GFloat)i * dx, py + (GFloat)i * dy);
+}
+
+void GGradientSpanGenerator::RampColors(const GFloat *U, GUInt32 *Dst, const GUInt32 Count, const GBool Pad) const {
+
+	const GUInt32 *table = gRamp.Colors();
+	GInt32 last = (GInt32)gRamp.Size() - 1;
+	GColorRampSpreadMode spreadMode = (Pad) ? G_PAD_COLOR_RAMP_SPREAD : gRamp.SpreadMode();
+	GUInt32 i = 0;
+
+#if defined(G_SPANGENERATOR_SSE2)
+	GInt32 idx[4];
+	__m128 minU = _mm_set1_ps(-G_MAX_RAMP_PARAMETER), maxU = _mm_set1_ps(G_MAX_RAMP_PARAMETER);
+	__m128 lastF = _mm_set1_ps((GFloat)last), half = _mm_set1_ps(0.5f);
+	__m128 zero = _mm_setzero_ps(), maxT = _mm_set1_ps((GFloat)last + 0.5f);
+	__m128i lastI = _mm_set1_epi32(last), lastMinusOne = _mm_set1_epi32(last - 1);
+	__m128i twoLast = _mm_set1_epi32(2 * last);
+	__m128i i4, mask;
+	__m128 u, fl;
+
+	for (; i + 4 <= Count; i += 4) {
+		// NaN parameters (if any) are flushed to the lower bound here
+		u = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(U + i), minU), maxU);
+		switch (spreadMode) {
+			case G_REPEAT_COLOR_RAMP_SPREAD:
+				u = _mm_sub_ps(u, Floor4(u));
+				i4 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(u, lastF), half));
+				i4 = _mm_sub_epi32(i4, _mm_and_si128(_mm_cmpgt_epi32(i4, lastMinusOne), lastI));
+				break;
+			case G_REFLECT_COLOR_RAMP_SPREAD:
+				fl = Floor4(_mm_mul_ps(u, half));
+				u = _mm_sub_ps(u, _mm_add_ps(fl, fl));
+				i4 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(u, lastF), half));
+				mask = _mm_cmpgt_epi32(i4, lastI);
+				i4 = _mm_or_si128(_mm_and_si128(mask, _mm_sub_epi32(twoLast, i4)), _mm_andnot_si128(mask, i4));
+				break;
+			default:
+				u = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(u, lastF), half), zero), maxT);
+				i4 = _mm_cvttps_epi32(u);
+				break;
+		}
+		_mm_storeu_si128((__m128i *)idx, i4);
+		Dst[i] = table[idx[0]];
+		Dst[i + 1] = table[idx[1]];
+		Dst[i + 2] = table[idx[2]];
+		Dst[i + 3] = table[idx[3]];
+	}
+#endif
+	for (; i < Count; ++i)
+		Dst[i] = table[RampIndex(U[i], last, spreadMode)];
+}
+
+void GGradientSpanGenerator::Generate(const GInt32 X, const GInt32 Y, GUInt32 *Dst, const GUInt32 Count) const {
+
+	GFloat u[G_GRADIENT_CHUNK_LENGTH];
+	GReal x = (GReal)X + (GReal)0.5, y = (GReal)Y + (GReal)0.5;
+	GUInt32 i, n;
+
+	if (!Dst || Count == 0)
+		return;
+
+	if (gRamp.Size() == 0) {
+		for (i = 0; i < Count; ++i)
+			Dst[i] = 0;
+		return;
+	}
+
+	switch (gType) {
+		// the ramp parameter is an affine function of x
+		case G_LINEAR_GRADIENT:
+			gRamp.Colors(gPaintMatrix[0][0] * x + gPaintMatrix[0][1] * y + gPaintMatrix[0][2],
+						 gPaintMatrix[0][0], Dst, Count);
+			break;
+
+		case G_RADIAL_GRADIENT:
+			for (i = 0; i < Count; i += n) {
+				n = GMath::Min(Count - i, (GUInt32)G_GRADIENT_CHUNK_LENGTH);
+				RadialParameters(x + (GReal)i, y, u, n);
+				RampColors(u, Dst + i, n, G_FALSE);
+			}
+			break;
+
+		// conical gradients always cover the ramp exactly once
+		case G_CONICAL_GRADIENT:
+			for (i = 0; i < Count; i += n) {
+				n = GMath::Min(Count - i, (GUInt32)G_GRADIENT_CHUNK_LENGTH);
+				ConicalParameters(x + (GReal)i, y, u, n);
+				RampColors(u, Dst + i, n, G_TRUE);
+			}
+			break;
+	}
+}
+
+// *********************************************************************
+//                        GPatternSpanGenerator
+// *********************************************************************
+
+/*
+	A texel coordinate, stepped along a span in 16.16 fixed point.
+
+	For repeat and reflect tiling modes the position is kept inside a single tiling period (Size and 2 * Size
+	texels respectively), so that wrapping a texel index never needs a division.
+*/
+template <GTilingMode TILING>
+struct GTexelAxis {
+	GInt64 Pos;
+	GInt64 Delta;
+	GInt64 Period;
+	GInt32 Size;
+
+	inline GTexelAxis(const GInt64 Pos0, const GInt64 Step, const GInt32 TexelsCount) {
+
+		Size = TexelsCount;
+		Period = ((TILING == G_REFLECT_TILE) ? (GInt64)(2 * Size) : (GInt64)Size) << 16;
+		if (TILING == G_PAD_TILE) {
+			Pos = Pos0;
+			Delta = Step;
+		}
+		else {
+			Pos = Pos0 % Period;
+			if (Pos < 0)
+				Pos += Period;
+			Delta = Step % Period;
+			if (Delta < 0)
+				Delta += Period;
+		}
+	}
+
+	inline void Next() {
+
+		Pos += Delta;
+		if (TILING != G_PAD_TILE && Pos >= Period)
+			Pos -= Period;
+	}
+
+	// integer part of the position
+	inline GInt32 Index() const {
+
+		return (GInt32)(Pos >> 16);
+	}
+
+	// 8 bits fractional part of the position, rounded
+	inline GUInt32 Fraction() const {
+
+		return (GUInt32)(((Pos & 0xFFFF) + 128) >> 8);
+	}
+
+	// wrap a texel index, that must lie at most one period away from the current tile, inside [0; Size - 1]
+	inline GInt32 Texel(const GInt32 i) const {
+
+		GInt32 j = i;
+
+		switch (TILING) {
+			case G_REPEAT_TILE:
+				if (j < 0)
+					j += Size;
+				else
+				if (j >= Size)
+					j -= Size;
+				return j;
+
+			case G_REFLECT_TILE:
+				if (j < 0)
+					j += 2 * Size;
+				else
+				if (j >= 2 * Size)
+					j -= 2 * Size;
+				return (j < Size) ? j : (2 * Size - 1 - j);
+
+			default:
+				if (j < 0)
+					return 0;
+				if (j >= Size)
+					return Size - 1;
+				return j;
+		}
+	}
+};
+
+// linear interpolation of two premultiplied colors, Weight is in the range [0; 256]
+static inline GUInt32 LerpColor(const GUInt32 a, const GUInt32 b, const GUInt32 Weight) {
+
+	GUInt32 rb = (((a & 0x00FF00FF) * (256 - Weight) + (b & 0x00FF00FF) * Weight) >> 8) & 0x00FF00FF;
+	GUInt32 ag = (((a >> 8) & 0x00FF00FF) * (256 - Weight) + ((b >> 8) & 0x00FF00FF) * Weight) & 0xFF00FF00;
+	return (rb | ag);
+}
+
+// Catmull-Rom weights, scaled by 256, for the fractional position T (in the range [0; 256])
+static inline void CubicWeights(const GInt32 T, GInt32 *Weights) {
+
+	GInt32 t2 = T * T;
+	GInt32 t3 = t2 * T;
+
+	// w0 = (-t^3 + 2t^2 - t) / 2, w2 = (-3t^3 + 4t^2 + t) / 2, w3 = (t^3 - t^2) / 2
+	Weights[0] = (-t3 + 512 * t2 - 65536 * T) / 131072;
+	Weights[2] = (-3 * t3 + 1024 * t2 + 65536 * T) / 131072;
+	Weights[3] = (t3 - 256 * t2) / 131072;
+	Weights[1] = 256 - Weights[0] - Weights[2] - Weights[3];
+}
+
+#if !defined(G_SPANGENERATOR_SSE2)
+static inline GInt32 ClampByte(const GInt32 Value) {
+
+	if (Value < 0)
+		return 0;
+	if (Value > 255)
+		return 255;
+	return Value;
+}
+#endif
+
+template <GTilingMode TILING>
+static void NearestSpan(const GPixelMap& Image, const GInt64 S0, const GInt64 T0, const GInt64 DeltaS,
+						const GInt64 DeltaT, GUInt32 *Dst, const GUInt32 Count) {
+
+	const GUInt32 *pixels = (const GUInt32 *)Image.Pixels();
+	GInt32 w = Image.Width();
+	// texel centers lie on integer coordinates, so the nearest one is found by rounding
+	GTexelAxis<TILING> s(S0 + 32768, DeltaS, w);
+	GTexelAxis<TILING> t(T0 + 32768, DeltaT, Image.Height());
+	GUInt32 i;
+
+	for (i = 0; i < Count; ++i) {
+		Dst[i] = pixels[t.Texel(t.Index()) * w + s.Texel(s.Index())];
+		s.Next();
+		t.Next();
+	}
+}
+
+template <GTilingMode TILING>
+static void BilinearSpan(const GPixelMap& Image, const GInt64 S0, const GInt64 T0, const GInt64 DeltaS,
+						 const GInt64 DeltaT, GUInt32 *Dst, const GUInt32 Count) {
+
+	const GUInt32 *pixels = (const GUInt32 *)Image.Pixels();
+	const GUInt32 *row0, *row1;
+	GInt32 w = Image.Width();
+	GTexelAxis<TILING> s(S0, DeltaS, w);
+	GTexelAxis<TILING> t(T0, DeltaT, Image.Height());
+	GInt32 x0, x1, y;
+	GUInt32 i;
+
+	for (i = 0; i < Count; ++i) {
+		x0 = s.Index();
+		x1 = s.Texel(x0 + 1);
+		x0 = s.Texel(x0);
+		y = t.Index();
+		row0 = pixels + t.Texel(y) * w;
+		row1 = pixels + t.Texel(y + 1) * w;
+#if defined(G_SPANGENERATOR_SSE2)
+		// horizontal and vertical interpolations are realized by two multiply-add steps
+		__m128i zero = _mm_setzero_si128();
+		__m128i top = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row0[x0]), zero);
+		__m128i bottom = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row1[x0]), zero);
+		__m128i top1 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row0[x1]), zero);
+		__m128i bottom1 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row1[x1]), zero);
+		GUInt32 fs = s.Fraction(), ft = t.Fraction();
+		__m128i ws = _mm_set1_epi32((GInt32)((fs << 16) | (256 - fs)));
+		__m128i wt = _mm_set1_epi32((GInt32)((ft << 16) | (256 - ft)));
+
+		top = _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(top, top1), ws), 8);
+		bottom = _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(bottom, bottom1), ws), 8);
+		// both rows fit in 16 bits, so they can be interleaved again
+		top = _mm_srli_epi32(_mm_madd_epi16(_mm_or_si128(top, _mm_slli_epi32(bottom, 16)), wt), 8);
+		top = _mm_packs_epi32(top, top);
+		Dst[i] = (GUInt32)_mm_cvtsi128_si32(_mm_packus_epi16(top, top));
+#else
+		Dst[i] = LerpColor(LerpColor(row0[x0], row0[x1], s.Fraction()),
+						   LerpColor(row1[x0], row1[x1], s.Fraction()), t.Fraction());
+#endif
+		s.Next();
+		t.Next();
+	}
+}
+
+template <GTilingMode TILING>
+static void BicubicSpan(const GPixelMap& Image, const GInt64 S0, const GInt64 T0, const GInt64 DeltaS,
+						const GInt64 DeltaT, GUInt32 *Dst, const GUInt32 Count) {
+
+	const GUInt32 *pixels = (const GUInt32 *)Image.Pixels();
+	const GUInt32 *row;
+	GInt32 w = Image.Width();
+	GTexelAxis<TILING> s(S0, DeltaS, w);
+	GTexelAxis<TILING> t(T0, DeltaT, Image.Height());
+	GInt32 xs[4], ws[4], wt[4];
+	GInt32 x, y, j, k;
+	GUInt32 i;
+
+	for (i = 0; i < Count; ++i) {
+		x = s.Index();
+		y = t.Index();
+		CubicWeights((GInt32)s.Fraction(), ws);
+		CubicWeights((GInt32)t.Fraction(), wt);
+		for (k = 0; k < 4; ++k)
+			xs[k] = s.Texel(x - 1 + k);
+
+#if defined(G_SPANGENERATOR_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		// pairs of horizontal weights, interleaved as 16 bits values
+		__m128i ws01 = _mm_set1_epi32((GInt32)(((GUInt32)ws[1] << 16) | ((GUInt32)ws[0] & 0xFFFF)));
+		__m128i ws23 = _mm_set1_epi32((GInt32)(((GUInt32)ws[3] << 16) | ((GUInt32)ws[2] & 0xFFFF)));
+		__m128 acc = _mm_setzero_ps();
+		__m128i c0, c1, c2, c3, rowAcc;
+
+		for (j = 0; j < 4; ++j) {
+			row = pixels + t.Texel(y - 1 + j) * w;
+			c0 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row[xs[0]]), zero);
+			c1 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row[xs[1]]), zero);
+			c2 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row[xs[2]]), zero);
+			c3 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((GInt32)row[xs[3]]), zero);
+			rowAcc = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c0, c1), ws01),
+								   _mm_madd_epi16(_mm_unpacklo_epi16(c2, c3), ws23));
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(rowAcc), _mm_set1_ps((GFloat)wt[j])));
+		}
+		// saturating packs clamp channels into [0; 255]
+		c0 = _mm_cvtps_epi32(_mm_mul_ps(acc, _mm_set1_ps(1.0f / 65536.0f)));
+		c0 = _mm_packs_epi32(c0, c0);
+		c0 = _mm_packus_epi16(c0, c0);
+		// Catmull-Rom overshoots, so colors must be clamped to the alpha value to keep them premultiplied
+		c1 = _mm_shufflelo_epi16(_mm_unpacklo_epi8(c0, zero), _MM_SHUFFLE(3, 3, 3, 3));
+		c0 = _mm_min_epu8(c0, _mm_packus_epi16(c1, c1));
+		Dst[i] = (GUInt32)_mm_cvtsi128_si32(c0);
+#else
+		GInt32 acc[4], rowAcc[4], a;
+		GUInt32 c;
+
+		acc[0] = acc[1] = acc[2] = acc[3] = 0;
+		for (j = 0; j < 4; ++j) {
+			row = pixels + t.Texel(y - 1 + j) * w;
+			rowAcc[0] = rowAcc[1] = rowAcc[2] = rowAcc[3] = 0;
+			for (k = 0; k < 4; ++k) {
+				c = row[xs[k]];
+				rowAcc[0] += ws[k] * (GInt32)(c >> 24);
+				rowAcc[1] += ws[k] * (GInt32)((c >> 16) & 0xFF);
+				rowAcc[2] += ws[k] * (GInt32)((c >> 8) & 0xFF);
+				rowAcc[3] += ws[k] * (GInt32)(c & 0xFF);
+			}
+			for (k = 0; k < 4; ++k)
+				acc[k] += wt[j] * rowAcc[k];
+		}
+		// Catmull-Rom overshoots, so colors must be clamped to the alpha value to keep them premultiplied
+		a = ClampByte((acc[0] + 32768) >> 16);
+		Dst[i] = ((GUInt32)a << 24) |
+				 ((GUInt32)GMath::Min(ClampByte((acc[1] + 32768) >> 16), a) << 16) |
+				 ((GUInt32)GMath::Min(ClampByte((acc[2] + 32768) >> 16), a) << 8) |
+				 (GUInt32)GMath::Min(ClampByte((acc[3] + 32768) >> 16), a);
+#endif
+		s.Next();
+		t.Next();
+	}
+}
+
+// sampling functions, indexed by [tiling mode][image quality]
+static const GPatternSpanFunction gPatternSpanFunctions[G_REFLECT_TILE + 1][G_HIGH_IMAGE_QUALITY + 1] = {
+	{ NearestSpan<G_PAD_TILE>, BilinearSpan<G_PAD_TILE>, BicubicSpan<G_PAD_TILE> },
+	{ NearestSpan<G_REPEAT_TILE>, BilinearSpan<G_REPEAT_TILE>, BicubicSpan<G_REPEAT_TILE> },
+	{ NearestSpan<G_REFLECT_TILE>, BilinearSpan<G_REFLECT_TILE>, BicubicSpan<G_REFLECT_TILE> }
+};
+
+GPatternSpanGenerator::GPatternSpanGenerator() : GSpanGenerator() {
+
+	gSpanFunction = NULL;
+}
+
+GError GPatternSpanGenerator::SetPattern(const GPatternDesc& Pattern, const GPixelMap& Image,
+										 const GImageQuality Quality, const GMatrix33& DeviceToLogical) {
+
+	const GAABox2& patWindow = Pattern.LogicalWindow();
+	GReal xAxisLen = patWindow.Dimension(G_X);
+	GReal yAxisLen = patWindow.Dimension(G_Y);
+	GMatrix33 m, postTrans, postTrans2, scale;
+	GError err;
+	GInt32 i, j;
+
+	if (Image.Width() <= 0 || Image.Height() <= 0 || xAxisLen <= G_EPSILON || yAxisLen <= G_EPSILON)
+		return G_INVALID_PARAMETER;
+
+	err = Image.SetPixelFormat(G_A8R8G8B8, gImage);
+	if (err != G_NO_ERROR) {
+		gSpanFunction = NULL;
+		return err;
+	}
+	GUInt32 *pixels = (GUInt32 *)gImage.Pixels();
+	j = gImage.Width() * gImage.Height();
+	// an RGB image is opaque, whatever its alpha byte is
+	if (Image.PixelFormat() == G_R8G8B8) {
+		for (i = 0; i < j; ++i)
+			pixels[i] |= 0xFF000000;
+	}
+	else
+		GPixelCompositor::Premultiply(pixels, (GUInt32)j);
+
+	// logical window is mapped to [0; Width] x [0; Height], first image row lying at the top of the window
+	TranslationToMatrix(postTrans2, -patWindow.Min());
+	ScaleToMatrix(scale, GVector2((GReal)gImage.Width() / xAxisLen, -(GReal)gImage.Height() / yAxisLen));
+	// texel centers are moved onto integer coordinates
+	TranslationToMatrix(postTrans, GPoint2((GReal)-0.5, (GReal)gImage.Height() - (GReal)0.5));
+	gTexelMatrix = (postTrans * (scale * (postTrans2 * (Pattern.InverseMatrix() * DeviceToLogical))));
+
+	gSpanFunction = gPatternSpanFunctions[Pattern.TilingMode()][Quality];
+	return G_NO_ERROR;
+}
+
+void GPatternSpanGenerator::Generate(const GInt32 X, const GInt32 Y, GUInt32 *Dst, const GUInt32 Count) const {
+
+	GReal x = (GReal)X + (GReal)0.5, y = (GReal)Y + (GReal)0.5;
+	GUInt32 i;
+
+	if (!Dst || Count == 0)
+		return;
+
+	if (!gSpanFunction) {
+		for (i = 0; i < Count; ++i)
+			Dst[i] = 0;
+		return;
+	}
+
+	// 16.16 fixed point texel coordinates, stepped along the span
+	GReal s = gTexelMatrix[0][0] * x + gTexelMatrix[0][1] * y + gTexelMatrix[0][2];
+	GReal t = gTexelMatrix[1][0] * x + gTexelMatrix[1][1] * y + gTexelMatrix[1][2];
+	gSpanFunction(gImage, (GInt64)GMath::Floor(s * (GReal)65536 + (GReal)0.5),
+				  (GInt64)GMath::Floor(t * (GReal)65536 + (GReal)0.5),
+				  (GInt64)GMath::Floor(gTexelMatrix[0][0] * (GReal)65536 + (GReal)0.5),
+				  (GInt64)GMath::Floor(gTexelMatrix[1][0] * (GReal)65536 + (GReal)0.5), Dst, Count);
+}
+
+#undef G_GRADIENT_CHUNK_LENGTH
+#undef G_MAX_RAMP_PARAMETER
+#undef G_ATAN_C0
+#undef G_ATAN_C1
+#undef G_ATAN_C2
+#undef G_ATAN_C3
+#undef G_ATAN_C4
+
+};	// end namespace Amanith
@@ -528,7 +528,7 @@ GAVLNode *GAVLTree::FindPrev(void *Data) {
 	if (!Root())
 		return NULL;
 
-	GInt32 cmp, cmpTmp, cmpNew = 0;
+	GInt32 cmp, cmpNew = 0;
 
 	// find a first lesser node
 	p = Root();
@@ -549,11 +549,10 @@ GAVLNode *GAVLTree::FindPrev(void *Data) {
 			p = p->LeftChild();
 			if (p) {
 				cmpNew = Compare(Data, p->CustomData());
-				if (cmpNew > 0) {
-					cmpTmp = Compare(p->CustomData(), candidate->CustomData());
-					if (cmpTmp > 0)
-						candidate = p;
-				}
+				// p lies in the right subtree of the current candidate, so it's surely greater; do not
+				// compare them through Compare(), it could be unable to order two stored keys
+				if (cmpNew > 0)
+					candidate = p;
 			}
 		}
 		else
@@ -587,7 +586,7 @@ GAVLNode *GAVLTree::FindNext(void *Data) {
 	if (!Root())
 		return NULL;
 
-	GInt32 cmp, cmpTmp, cmpNew = 0;
+	GInt32 cmp, cmpNew = 0;
 
 	// find a first greater node
 	p = Root();
@@ -608,11 +607,10 @@ GAVLNode *GAVLTree::FindNext(void *Data) {
 			p = p->RightChild();
 			if (p) {
 				cmpNew = Compare(Data, p->CustomData());
-				if (cmpNew < 0) {
-					cmpTmp = Compare(p->CustomData(), candidate->CustomData());
-					if (cmpTmp < 0)
-						candidate = p;
-				}
+				// p lies in the left subtree of the current candidate, so it's surely lesser; do not
+				// compare them through Compare(), it could be unable to order two stored keys
+				if (cmpNew < 0)
+					candidate = p;
 			}
 		}
 		else
@@ -0,0 +1,521 @@
+/****************************************************************************
+** $file: amanith/src/support/gsvgpathparser.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** SVG path data parser implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/support/gsvgpathparser.h"
+#include "amanith/gerror.h"
+
+/*!
+	\file gsvgpathparser.cpp
+	\brief SVG path data parser implementation file.
+*/
+
+namespace Amanith {
+
+// powers of ten that are exactly representable as doubles
+static const GDouble gPowersOfTen[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline GBool IsDigit(const GChar8 c) {
+
+	return ((GUChar8)(c - '0') <= 9);
+}
+
+static inline GBool IsSpace(const GChar8 c) {
+
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f');
+}
+
+// skip white spaces and commas
+static inline const GChar8 *SkipSeparators(const GChar8 *p, const GChar8 *End) {
+
+	while (p < End && (IsSpace(*p) || *p == ','))
+		p++;
+	return p;
+}
+
+const GChar8 *GSVGPathParser::ParseReal(const GChar8 *Begin, const GChar8 *End, GReal& Value) {
+
+	const GChar8 *p = Begin, *q;
+	GBool negative = G_FALSE;
+	GUInt64 mantissa = 0;
+	GInt32 exponent = 0, digits = 0, e, expSign;
+	GDouble v;
+
+	if (p < End && (*p == '+' || *p == '-')) {
+		negative = (*p == '-');
+		p++;
+	}
+	// integer part; digits that don't fit the mantissa only scale it
+	while (p < End && IsDigit(*p)) {
+		if (mantissa < (GUInt64)100000000000000000ULL)
+			mantissa = mantissa * 10 + (GUInt64)(*p - '0');
+		else
+			exponent++;
+		p++;
+		digits++;
+	}
+	// fractional part
+	if (p < End && *p == '.') {
+		p++;
+		while (p < End && IsDigit(*p)) {
+			if (mantissa < (GUInt64)100000000000000000ULL) {
+				mantissa = mantissa * 10 + (GUInt64)(*p - '0');
+				exponent--;
+			}
+			p++;
+			digits++;
+		}
+	}
+	if (digits == 0)
+		return Begin;
+	// exponent, taken only if followed by at least a digit
+	if (p < End && (*p == 'e' || *p == 'E')) {
+		q = p + 1;
+		expSign = 1;
+		if (q < End && (*q == '+' || *q == '-')) {
+			if (*q == '-')
+				expSign = -1;
+			q++;
+		}
+		if (q < End && IsDigit(*q)) {
+			e = 0;
+			while (q < End && IsDigit(*q)) {
+				if (e < 10000)
+					e = e * 10 + (*q - '0');
+				q++;
+			}
+			exponent += expSign * e;
+			p = q;
+		}
+	}
+
+	v = (GDouble)mantissa;
+	if (mantissa != 0) {
+		if (exponent < 0) {
+			while (exponent < -22) {
+				v /= gPowersOfTen[22];
+				exponent += 22;
+			}
+			v /= gPowersOfTen[-exponent];
+		}
+		else {
+			while (exponent > 22) {
+				v *= gPowersOfTen[22];
+				exponent -= 22;
+			}
+			v *= gPowersOfTen[exponent];
+		}
+	}
+	Value = (GReal)(negative ? -v : v);
+	return p;
+}
+
+GError GSVGPathParser::Parse(const GChar8 *Begin, const GChar8 *End, GSVGPathSink& Sink,
+							 const GAnglesMeasureUnit AnglesMeasureUnit) {
+
+	const GChar8 *p = Begin, *q;
+	GChar8 cmd = 0, lastCurve = 0;
+	GInt32 i, argsCount;
+	GReal args[7];
+	GBool relative, started = G_FALSE, subPath = G_FALSE;
+	GPoint2 cursor(0, 0), start(0, 0), ctrl(0, 0), p1, p2, pt;
+
+	if (!Begin || End < Begin)
+		return G_INVALID_PARAMETER;
+
+	for (;;) {
+		p = SkipSeparators(p, End);
+		if (p == End)
+			break;
+
+		if (!IsDigit(*p) && *p != '.' && *p != '-' && *p != '+') {
+			cmd = *p++;
+			if (cmd == 'Z' || cmd == 'z') {
+				if (subPath)
+					Sink.ClosePath();
+				// next sub-path (if not started by a moveto) begins at the same initial point
+				cursor = start;
+				subPath = G_FALSE;
+				lastCurve = 0;
+				continue;
+			}
+		}
+		else
+		// numbers are allowed only as (implicitly repeated) command arguments
+		if (cmd == 0 || cmd == 'Z' || cmd == 'z')
+			return G_INVALID_FORMAT;
+
+		switch (cmd) {
+			case 'M': case 'm': case 'L': case 'l': case 'T': case 't':
+				argsCount = 2;
+				break;
+			case 'H': case 'h': case 'V': case 'v':
+				argsCount = 1;
+				break;
+			case 'Q': case 'q': case 'S': case 's':
+				argsCount = 4;
+				break;
+			case 'C': case 'c':
+				argsCount = 6;
+				break;
+			case 'A': case 'a':
+				argsCount = 7;
+				break;
+			default:
+				return G_INVALID_FORMAT;
+		}
+		// read arguments
+		for (i = 0; i < argsCount; i++) {
+			p = SkipSeparators(p, End);
+			if ((cmd == 'A' || cmd == 'a') && (i == 3 || i == 4)) {
+				// arc flags are single characters, and they may not be separated from what follows
+				if (p == End || (*p != '0' && *p != '1'))
+					return G_INVALID_FORMAT;
+				args[i] = (GReal)(*p++ - '0');
+			}
+			else {
+				q = ParseReal(p, End, args[i]);
+				if (q == p)
+					return G_INVALID_FORMAT;
+				p = q;
+			}
+		}
+
+		relative = (cmd >= 'a');
+		if (cmd == 'M' || cmd == 'm') {
+			pt.Set(args[0], args[1]);
+			if (relative)
+				pt += cursor;
+			Sink.MoveTo(pt);
+			cursor = start = pt;
+			started = subPath = G_TRUE;
+			lastCurve = 0;
+			// subsequent pairs of coordinates are implicit lineto commands
+			cmd = (relative) ? 'l' : 'L';
+			continue;
+		}
+		// path data must begin with a moveto
+		if (!started)
+			return G_INVALID_FORMAT;
+		if (!subPath) {
+			Sink.MoveTo(cursor);
+			start = cursor;
+			subPath = G_TRUE;
+		}
+
+		switch (cmd) {
+			case 'L':
+			case 'l':
+				pt.Set(args[0], args[1]);
+				if (relative)
+					pt += cursor;
+				Sink.LineTo(pt);
+				lastCurve = 0;
+				break;
+
+			case 'H':
+			case 'h':
+				pt.Set((relative) ? cursor[G_X] + args[0] : args[0], cursor[G_Y]);
+				Sink.LineTo(pt);
+				lastCurve = 0;
+				break;
+
+			case 'V':
+			case 'v':
+				pt.Set(cursor[G_X], (relative) ? cursor[G_Y] + args[0] : args[0]);
+				Sink.LineTo(pt);
+				lastCurve = 0;
+				break;
+
+			case 'C':
+			case 'c':
+				p1.Set(args[0], args[1]);
+				p2.Set(args[2], args[3]);
+				pt.Set(args[4], args[5]);
+				if (relative) {
+					p1 += cursor;
+					p2 += cursor;
+					pt += cursor;
+				}
+				Sink.CubicTo(p1, p2, pt);
+				ctrl = p2;
+				lastCurve = 'C';
+				break;
+
+			case 'S':
+			case 's':
+				// first control point is the reflection of the previous cubic second control point
+				if (lastCurve == 'C')
+					p1 = cursor + (cursor - ctrl);
+				else
+					p1 = cursor;
+				p2.Set(args[0], args[1]);
+				pt.Set(args[2], args[3]);
+				if (relative) {
+					p2 += cursor;
+					pt += cursor;
+				}
+				Sink.CubicTo(p1, p2, pt);
+				ctrl = p2;
+				lastCurve = 'C';
+				break;
+
+			case 'Q':
+			case 'q':
+				p1.Set(args[0], args[1]);
+				pt.Set(args[2], args[3]);
+				if (relative) {
+					p1 += cursor;
+					pt += cursor;
+				}
+				Sink.QuadraticTo(p1, pt);
+				ctrl = p1;
+				lastCurve = 'Q';
+				break;
+
+			case 'T':
+			case 't':
+				// control point is the reflection of the previous quadratic control point
+				if (lastCurve == 'Q')
+					p1 = cursor + (cursor - ctrl);
+				else
+					p1 = cursor;
+				pt.Set(args[0], args[1]);
+				if (relative)
+					pt += cursor;
+				Sink.QuadraticTo(p1, pt);
+				ctrl = p1;
+				lastCurve = 'Q';
+				break;
+
+			default:
+				pt.Set(args[5], args[6]);
+				if (relative)
+					pt += cursor;
+				// arcs with coincident ends are omitted, arcs with a zero radius are lines (SVG specifications)
+				if (pt != cursor) {
+					if (args[0] == 0 || args[1] == 0)
+						Sink.LineTo(pt);
+					else
+						Sink.ArcTo(GMath::Abs(args[0]), GMath::Abs(args[1]),
+								   GMath::AngleConversion(args[2], AnglesMeasureUnit, G_RADIAN_UNIT),
+								   (args[3] != 0), (args[4] != 0), pt);
+				}
+				lastCurve = 0;
+				break;
+		}
+		cursor = pt;
+	}
+	return G_NO_ERROR;
+}
+
+// *********************************************************************
+//                          commands buffer sink
+// *********************************************************************
+class GSVGCommandsSink : public GSVGPathSink {
+
+private:
+	GDynArray<GChar8>& gCommands;
+	GDynArray<GReal>& gCoordinates;
+
+	inline void Push(const GPoint2& P) {
+		gCoordinates.push_back(P[G_X]);
+		gCoordinates.push_back(P[G_Y]);
+	}
+
+public:
+	GSVGCommandsSink(GDynArray<GChar8>& Commands, GDynArray<GReal>& Coordinates) : gCommands(Commands),
+																					 gCoordinates(Coordinates) {
+	}
+	void MoveTo(const GPoint2& P) {
+		gCommands.push_back('M');
+		Push(P);
+	}
+	void LineTo(const GPoint2& P) {
+		gCommands.push_back('L');
+		Push(P);
+	}
+	void QuadraticTo(const GPoint2& P1, const GPoint2& P) {
+		gCommands.push_back('Q');
+		Push(P1);
+		Push(P);
+	}
+	void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+		gCommands.push_back('C');
+		Push(P1);
+		Push(P2);
+		Push(P);
+	}
+	void ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+			   const GPoint2& P) {
+		gCommands.push_back('A');
+		gCoordinates.push_back(Rx);
+		gCoordinates.push_back(Ry);
+		gCoordinates.push_back(XRot);
+		gCoordinates.push_back((LargeArc) ? (GReal)1 : (GReal)0);
+		gCoordinates.push_back((Sweep) ? (GReal)1 : (GReal)0);
+		Push(P);
+	}
+	void ClosePath() {
+		gCommands.push_back('Z');
+	}
+};
+
+GError GSVGPathParser::ParseCommands(const GChar8 *Begin, const GChar8 *End, GDynArray<GChar8>& Commands,
+									 GDynArray<GReal>& Coordinates, const GAnglesMeasureUnit AnglesMeasureUnit) {
+
+	GSVGCommandsSink sink(Commands, Coordinates);
+
+	// path data is mostly made of numbers, so a good guess avoids most of reallocations
+	Coordinates.reserve(Coordinates.size() + (End - Begin) / 4);
+	return Parse(Begin, End, sink, AnglesMeasureUnit);
+}
+
+// *********************************************************************
+//                            path data sink
+// *********************************************************************
+class GSVGPathDataSink : public GSVGPathSink {
+
+private:
+	GPathData& gData;
+
+public:
+	GSVGPathDataSink(GPathData& Data) : gData(Data) {
+	}
+	void MoveTo(const GPoint2& P) {
+		gData.MoveTo(P);
+	}
+	void LineTo(const GPoint2& P) {
+		gData.LineTo(P);
+	}
+	void QuadraticTo(const GPoint2& P1, const GPoint2& P) {
+		gData.QuadTo(P1, P);
+	}
+	void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+		gData.CubicTo(P1, P2, P);
+	}
+	void ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+			   const GPoint2& P) {
+		gData.ArcTo(Rx, Ry, XRot, LargeArc, Sweep, P);
+	}
+	void ClosePath() {
+		gData.ClosePath();
+	}
+};
+
+GError GSVGPathParser::ParsePathData(const GChar8 *Begin, const GChar8 *End, GPathData& Data,
+									 const GAnglesMeasureUnit AnglesMeasureUnit) {
+
+	GSVGPathDataSink sink(Data);
+
+	return Parse(Begin, End, sink, AnglesMeasureUnit);
+}
+
+GError GSVGPathParser::ParsePaths(const GChar8 *Begin, const GChar8 *End, GKernel& Kernel,
+								  GDynArray<GPath2D *>& Paths, const GAnglesMeasureUnit AnglesMeasureUnit) {
+
+	GPathData data;
+	GError err, buildErr;
+
+	err = ParsePathData(Begin, End, data, AnglesMeasureUnit);
+	// like SVG specifications say, everything before an error is kept
+	buildErr = data.ToPaths(Kernel, Paths);
+	if (err == G_NO_ERROR)
+		err = buildErr;
+	return err;
+}
+
+// *********************************************************************
+//                             flattening sink
+// *********************************************************************
+class GSVGFlattenSink : public GSVGPathSink {
+
+private:
+	GPathFlattener gFlattener;
+	GPoint2 gCursor;
+
+public:
+	GSVGFlattenSink(GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour, GDynArray<GBool>& ClosedContours,
+					const GReal MaxDeviation) : gFlattener(Points, PointsPerContour, ClosedContours, MaxDeviation) {
+	}
+	void MoveTo(const GPoint2& P) {
+		gFlattener.MoveTo(P);
+		gCursor = P;
+	}
+	void LineTo(const GPoint2& P) {
+		gFlattener.LineTo(P);
+		gCursor = P;
+	}
+	void QuadraticTo(const GPoint2& P1, const GPoint2& P) {
+		gFlattener.QuadTo(P1, P);
+		gCursor = P;
+	}
+	void CubicTo(const GPoint2& P1, const GPoint2& P2, const GPoint2& P) {
+		gFlattener.CubicTo(P1, P2, P);
+		gCursor = P;
+	}
+	void ArcTo(const GReal Rx, const GReal Ry, const GReal XRot, const GBool LargeArc, const GBool Sweep,
+			   const GPoint2& P) {
+
+		GPoint2 center;
+		GVector2 u, v;
+		GReal startAngle, sweepAngle;
+
+		if (GPathData::ArcCenterParameters(gCursor, Rx, Ry, XRot, LargeArc, Sweep, P, center, u, v,
+										   startAngle, sweepAngle))
+			gFlattener.ArcTo(center, u, v, startAngle, sweepAngle, P);
+		else
+			gFlattener.LineTo(P);
+		gCursor = P;
+	}
+	void ClosePath() {
+		gFlattener.ClosePath();
+	}
+	void Finish() {
+		gFlattener.Finish();
+	}
+};
+
+GError GSVGPathParser::Flatten(const GChar8 *Begin, const GChar8 *End, const GReal MaxDeviation,
+							   GDynArray<GPoint2>& Points, GDynArray<GInt32>& PointsPerContour,
+							   GDynArray<GBool>& ClosedContours, const GAnglesMeasureUnit AnglesMeasureUnit) {
+
+	if (MaxDeviation <= 0)
+		return G_INVALID_PARAMETER;
+
+	GSVGFlattenSink sink(Points, PointsPerContour, ClosedContours, MaxDeviation);
+	GError err;
+
+	err = Parse(Begin, End, sink, AnglesMeasureUnit);
+	sink.Finish();
+	return err;
+}
+
+};	// end namespace Amanith
@@ -0,0 +1,297 @@
+/****************************************************************************
+** $file: amanith/src/support/gthreadpool.cpp   0.3.0.0   edited Jan, 30 2006
+**
+** Thread pool implementation.
+**
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+#include "amanith/support/gthreadpool.h"
+
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	#include <windows.h>
+	#include <process.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+/*!
+	\file gthreadpool.cpp
+	\brief Implementation file for GThreadPool class.
+*/
+
+namespace Amanith {
+
+// maximum number of threads that a pool can hold
+#define G_MAX_POOL_THREADS 64
+
+// *********************************************************************
+//                             GThreadPool
+// *********************************************************************
+
+struct GThreadPoolPrivate {
+	// current jobs set
+	GJobFunction Function;
+	void *Data;
+	GUInt32 JobsCount;
+	GUInt32 NextJob;
+	// number of workers that have not finished the current jobs set yet
+	GInt32 ActiveWorkers;
+	GBool Quit;
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	CRITICAL_SECTION Lock;
+	HANDLE StartSemaphore;
+	HANDLE DoneEvent;
+	GDynArray<HANDLE> Threads;
+#else
+	pthread_mutex_t Lock;
+	pthread_cond_t StartCond;
+	pthread_cond_t DoneCond;
+	GUInt32 Generation;
+	GDynArray<pthread_t> Threads;
+#endif
+};
+
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+
+// pick and execute jobs until the set is exhausted; the lock must NOT be held by the caller
+static void ExecuteJobs(GThreadPoolPrivate *Pool) {
+
+	GUInt32 i;
+
+	EnterCriticalSection(&Pool->Lock);
+	while (Pool->NextJob < Pool->JobsCount) {
+		i = Pool->NextJob++;
+		LeaveCriticalSection(&Pool->Lock);
+		Pool->Function(Pool->Data, i);
+		EnterCriticalSection(&Pool->Lock);
+	}
+	LeaveCriticalSection(&Pool->Lock);
+}
+
+static unsigned __stdcall WorkerThread(void *Param) {
+
+	GThreadPoolPrivate *pool = (GThreadPoolPrivate *)Param;
+
+	while (1) {
+		WaitForSingleObject(pool->StartSemaphore, INFINITE);
+		if (pool->Quit)
+			break;
+		ExecuteJobs(pool);
+		// every semaphore count is consumed by exactly one decrement, so when the counter reaches 0 no stale
+		// count can survive to the next jobs set
+		if (InterlockedDecrement((LONG *)&pool->ActiveWorkers) == 0)
+			SetEvent(pool->DoneEvent);
+	}
+	return 0;
+}
+
+#else
+
+// pick and execute jobs until the set is exhausted; the lock must be held by the caller
+static void ExecuteJobs(GThreadPoolPrivate *Pool) {
+
+	GUInt32 i;
+
+	while (Pool->NextJob < Pool->JobsCount) {
+		i = Pool->NextJob++;
+		pthread_mutex_unlock(&Pool->Lock);
+		Pool->Function(Pool->Data, i);
+		pthread_mutex_lock(&Pool->Lock);
+	}
+}
+
+static void *WorkerThread(void *Param) {
+
+	GThreadPoolPrivate *pool = (GThreadPoolPrivate *)Param;
+	GUInt32 generation;
+
+	// workers are created when generation counter is still 0; reading it here instead could skip a jobs set
+	// submitted before this thread has been scheduled for the first time
+	generation = 0;
+	pthread_mutex_lock(&pool->Lock);
+	while (1) {
+		while (!pool->Quit && pool->Generation == generation)
+			pthread_cond_wait(&pool->StartCond, &pool->Lock);
+		if (pool->Quit)
+			break;
+		generation = pool->Generation;
+		ExecuteJobs(pool);
+		pool->ActiveWorkers--;
+		if (pool->ActiveWorkers == 0)
+			pthread_cond_signal(&pool->DoneCond);
+	}
+	pthread_mutex_unlock(&pool->Lock);
+	return NULL;
+}
+
+#endif
+
+GThreadPool::GThreadPool(const GUInt32 ThreadsCount) {
+
+	GUInt32 i, n = ThreadsCount;
+	GThreadPoolPrivate *pool;
+
+	if (n == 0)
+		n = ProcessorsCount();
+	if (n > G_MAX_POOL_THREADS)
+		n = G_MAX_POOL_THREADS;
+
+	pool = new GThreadPoolPrivate;
+	gPrivate = (void *)pool;
+
+	pool->Function = NULL;
+	pool->Data = NULL;
+	pool->JobsCount = 0;
+	pool->NextJob = 0;
+	pool->ActiveWorkers = 0;
+	pool->Quit = G_FALSE;
+
+	// the calling thread is the first one
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	InitializeCriticalSection(&pool->Lock);
+	pool->StartSemaphore = CreateSemaphore(NULL, 0, G_MAX_POOL_THREADS, NULL);
+	pool->DoneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	for (i = 1; i < n; ++i) {
+		HANDLE h = (HANDLE)_beginthreadex(NULL, 0, WorkerThread, (void *)pool, 0, NULL);
+		if (!h)
+			break;
+		pool->Threads.push_back(h);
+	}
+#else
+	pthread_mutex_init(&pool->Lock, NULL);
+	pthread_cond_init(&pool->StartCond, NULL);
+	pthread_cond_init(&pool->DoneCond, NULL);
+	pool->Generation = 0;
+	for (i = 1; i < n; ++i) {
+		pthread_t t;
+		if (pthread_create(&t, NULL, WorkerThread, (void *)pool) != 0)
+			break;
+		pool->Threads.push_back(t);
+	}
+#endif
+	gThreadsCount = (GUInt32)pool->Threads.size() + 1;
+}
+
+GThreadPool::~GThreadPool() {
+
+	GThreadPoolPrivate *pool = (GThreadPoolPrivate *)gPrivate;
+	GUInt32 i, j;
+
+	if (!pool)
+		return;
+
+	j = (GUInt32)pool->Threads.size();
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	pool->Quit = G_TRUE;
+	if (j > 0)
+		ReleaseSemaphore(pool->StartSemaphore, (LONG)j, NULL);
+	for (i = 0; i < j; ++i) {
+		WaitForSingleObject(pool->Threads[i], INFINITE);
+		CloseHandle(pool->Threads[i]);
+	}
+	CloseHandle(pool->StartSemaphore);
+	CloseHandle(pool->DoneEvent);
+	DeleteCriticalSection(&pool->Lock);
+#else
+	pthread_mutex_lock(&pool->Lock);
+	pool->Quit = G_TRUE;
+	pthread_cond_broadcast(&pool->StartCond);
+	pthread_mutex_unlock(&pool->Lock);
+	for (i = 0; i < j; ++i)
+		pthread_join(pool->Threads[i], NULL);
+	pthread_cond_destroy(&pool->DoneCond);
+	pthread_cond_destroy(&pool->StartCond);
+	pthread_mutex_destroy(&pool->Lock);
+#endif
+	delete pool;
+}
+
+GError GThreadPool::Run(const GJobFunction Function, void *Data, const GUInt32 JobsCount) {
+
+	GThreadPoolPrivate *pool = (GThreadPoolPrivate *)gPrivate;
+	GUInt32 i, j;
+
+	if (!Function)
+		return G_INVALID_PARAMETER;
+	if (JobsCount == 0)
+		return G_NO_ERROR;
+
+	j = (pool) ? (GUInt32)pool->Threads.size() : 0;
+	// a single job (or no workers) is executed directly in the caller context
+	if (j == 0 || JobsCount == 1) {
+		for (i = 0; i < JobsCount; ++i)
+			Function(Data, i);
+		return G_NO_ERROR;
+	}
+
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	EnterCriticalSection(&pool->Lock);
+	pool->Function = Function;
+	pool->Data = Data;
+	pool->JobsCount = JobsCount;
+	pool->NextJob = 0;
+	pool->ActiveWorkers = (GInt32)j;
+	LeaveCriticalSection(&pool->Lock);
+	ReleaseSemaphore(pool->StartSemaphore, (LONG)j, NULL);
+	ExecuteJobs(pool);
+	WaitForSingleObject(pool->DoneEvent, INFINITE);
+#else
+	pthread_mutex_lock(&pool->Lock);
+	pool->Function = Function;
+	pool->Data = Data;
+	pool->JobsCount = JobsCount;
+	pool->NextJob = 0;
+	pool->ActiveWorkers = (GInt32)j;
+	pool->Generation++;
+	pthread_cond_broadcast(&pool->StartCond);
+	ExecuteJobs(pool);
+	while (pool->ActiveWorkers > 0)
+		pthread_cond_wait(&pool->DoneCond, &pool->Lock);
+	pthread_mutex_unlock(&pool->Lock);
+#endif
+	return G_NO_ERROR;
+}
+
+GUInt32 GThreadPool::ProcessorsCount() {
+
+#if defined(G_OS_WIN) && !defined(__CYGWIN__)
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	if (sysInfo.dwNumberOfProcessors < 1)
+		return 1;
+	return (GUInt32)sysInfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n < 1)
+		return 1;
+	return (GUInt32)n;
+#else
+	return 1;
+#endif
+}
+
+#undef G_MAX_POOL_THREADS
+
+};	// end namespace Amanith
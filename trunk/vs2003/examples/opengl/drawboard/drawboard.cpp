@@ -67,6 +67,9 @@ GString gScreenShotFileName;
 // 7 = stroking
 // 8 = masks and group opacity
 // 9 = shapes
+// 10 = cache
+// 11 = UI rectangles benchmark
+// 12 = screenshot capture benchmark
 GUInt32 gTestSuite = 0;
 GUInt32 gTestIndex = 0;
 GBool gDrawBackGround = G_TRUE;
@@ -75,6 +78,14 @@ GReal gRandScaleX = 1;
 GReal gRandScaleY = 1;
 GRenderingQuality gRenderingQuality = G_HIGH_RENDERING_QUALITY;
 GBool gUseShaders = G_TRUE;
+// time spent to draw the last UI rectangles frame, in milliseconds
+GUInt32 gUIRectsTime = 0;
+// frames per second of the last synchronous and asynchronous capture runs
+GReal gCaptureFps[2] = { 0, 0 };
+// size of the captured frames
+GUInt32 gCaptureWidth = 0, gCaptureHeight = 0;
+// G_TRUE if the last asynchronous frame is equal to a synchronous screenshot
+GBool gCaptureMatch = G_FALSE;
 
 #include "test_color.h"
 #include "test_lineargradient.h"
@@ -87,6 +98,8 @@ GBool gUseShaders = G_TRUE;
 #include "test_masks.h"
 #include "test_geometries.h"
 #include "test_cache.h"
+#include "test_uirects.h"
+#include "test_capture.h"
 
 bool arbMultisampleSupported = false;
 int arbMultisampleFormat = 0;
@@ -348,6 +361,12 @@ int DrawGLScene(GLvoid)	{
 		case 10:
 			TestCache(gTestIndex);
 			break;
+		case 11:
+			TestUIRects(gTestIndex);
+			break;
+		case 12:
+			TestCapture(gTestIndex);
+			break;
 		default:
 			TestColor(gTestIndex);
 	}
@@ -643,7 +662,7 @@ int WINAPI WinMain(	HINSTANCE	hInstance,			// Instance
 			if (keys[VK_F1]) {						// Is F1 Being Pressed?
 				keys[VK_F1] = FALSE;
 				s = "F2: contextual example description\n";
-				s += "0..9, C: Toggle draw test\n";
+				s += "0..9, C, U, G: Toggle draw test\n";
 				s += "PageUp/PageDown: Switch draw sheet\n";
 				s += "B: Toggle background\n";
 				s += "R: Switch rendering quality (low/normal/high)\n";
@@ -796,6 +815,31 @@ int WINAPI WinMain(	HINSTANCE	hInstance,			// Instance
 						s += "Topmost row: cached geometry is drawn with a different paint style.\n\n";
 						MessageBox(NULL, StrUtils::ToAscii(s), "Current board description", MB_OK | MB_ICONINFORMATION | MB_APPLMODAL);
 						break;
+					case 11:
+						s = "This board is a benchmark made of many small UI rectangles (use PageUp/PageDown keys to switch sheet).\n\n";
+						s += "Sheet 1: 100000 filled and outlined rectangles.\n";
+						s += "Sheet 2: 100000 filled and outlined round rectangles.\n";
+						s += "Sheet 3: 2000 panels clipped by rectangular masks (scissor test), with 10 rectangles each.\n";
+						s += "Sheet 4: the same panels of sheet 3, using stencil masks.\n\n";
+						s += "With multisample buffers rectangular masks use the scissor test only at low rendering quality (R key).\n\n";
+						s += "Last frame was drawn in " + StrUtils::ToString(gUIRectsTime) + " ms.";
+						MessageBox(NULL, StrUtils::ToAscii(s), "Current board description", MB_OK | MB_ICONINFORMATION | MB_APPLMODAL);
+						break;
+					case 12:
+						s = "This board is a benchmark of framebuffer capture (use PageUp/PageDown keys to switch sheet).\n\n";
+						s += "Every run draws 60 frames of an animation, each one is grabbed after being drawn.\n";
+						s += "Sheet 1: frames are grabbed with the synchronous ScreenShot().\n";
+						s += "Sheet 2: frames are grabbed with ScreenShotAsync(), so that reads can go on while next frames are drawn.\n\n";
+						s += "Frames have the size of the window: maximize it on a 1920x1080 display to measure 1080p capture.\n\n";
+						s += "Last runs at " + StrUtils::ToString(gCaptureWidth) + "x" + StrUtils::ToString(gCaptureHeight) + ": ";
+						s += "synchronous " + StrUtils::ToString(gCaptureFps[0], "%.1f") + " fps, ";
+						s += "asynchronous " + StrUtils::ToString(gCaptureFps[1], "%.1f") + " fps.\n";
+						if (gCaptureMatch)
+							s += "Last asynchronous frame is equal to the synchronous screenshot.";
+						else
+							s += "Last asynchronous frame is NOT equal to the synchronous screenshot (or sheet 2 has not been drawn yet).";
+						MessageBox(NULL, StrUtils::ToAscii(s), "Current board description", MB_OK | MB_ICONINFORMATION | MB_APPLMODAL);
+						break;
 				}
 			}
 			// 1 key
@@ -875,6 +919,20 @@ int WINAPI WinMain(	HINSTANCE	hInstance,			// Instance
 				gTestIndex = 0;
 				doDraw = TRUE;
 			}
+			// U key
+			if (keys[85]) {
+				keys[85] = FALSE;
+				gTestSuite = 11;
+				gTestIndex = 0;
+				doDraw = TRUE;
+			}
+			// G key
+			if (keys[71]) {
+				keys[71] = FALSE;
+				gTestSuite = 12;
+				gTestIndex = 0;
+				doDraw = TRUE;
+			}
 
 			// B key
 			if (keys[66]) {
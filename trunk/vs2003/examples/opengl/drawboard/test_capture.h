@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2004-2006 Mazatech Inc. All rights reserved.
+**
+** This file is part of Amanith Framework.
+**
+** This file may be distributed and/or modified under the terms of the Q Public License
+** as defined by Mazatech Inc. of Italy and appearing in the file
+** LICENSE.QPL included in the packaging of this file.
+**
+** Licensees holding valid Amanith Professional Edition license may use this file in
+** accordance with the Amanith Commercial License Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.mazatech.com or email sales@mazatech.com for
+** information about Amanith Commercial License Agreements.
+** See http://www.amanith.org/ for opensource version, public forums and news.
+**
+** Contact info@mazatech.com if any conditions of this licensing are
+** not clear to you.
+**********************************************************************/
+
+// number of frames drawn and grabbed by every run
+#define G_CAPTURE_FRAMES 60
+
+struct GCaptureData {
+	// number of frames received by the callback
+	GUInt32 Count;
+	// copy of the last received frame
+	GPixelMap LastFrame;
+};
+
+// asynchronous screenshots are delivered here, a real application would encode or store them
+static void CaptureCallback(const GPixelMap& Frame, const GUInt32, void *UserData) {
+
+	GCaptureData *data = (GCaptureData *)UserData;
+
+	data->Count++;
+	if (data->Count == G_CAPTURE_FRAMES)
+		data->LastFrame.CopyFrom(Frame);
+}
+
+// a frame of a simple animation, made of moving bars that cover the whole viewport
+static void DrawCaptureFrame(GOpenGLBoard *DrawBoard, const GUInt32 Frame, const GReal Width, const GReal Height) {
+
+	GUInt32 i;
+	GReal x, y, w = Width / 40, h = Height / 25;
+
+	DrawBoard->Clear((GReal)1, (GReal)1, (GReal)1, (GReal)1, G_TRUE);
+	for (i = 0; i < 1000; ++i) {
+		x = (GReal)(i % 40) * w;
+		y = (GReal)(i / 40) * h + (GReal)((Frame * 3 + i * 7) % 20) - 10;
+		DrawBoard->SetFillColor(GVector4((GReal)((i * 37 + Frame * 5) % 256) / 255, (GReal)((i * 11) % 256) / 255,
+										 (GReal)((Frame * 9) % 256) / 255, (GReal)1.000));
+		DrawBoard->DrawRoundRectangle(GPoint2(x + 2, y + 2), GPoint2(x + w - 2, y + h - 2), 4, 4);
+	}
+}
+
+void TestCapture(const GUInt32 TestIndex) {
+
+	GUInt32 idx = TestIndex % 2;
+	GUInt32 i, x, y, w, h, frameID, elapsed;
+	GCaptureData data;
+	GPixelMap shot;
+	DWORD startTime;
+
+	gDrawBoard->Viewport(x, y, w, h);
+	gDrawBoard->SetTargetMode(G_COLOR_MODE);
+	gDrawBoard->SetStrokeEnabled(G_FALSE);
+	gDrawBoard->SetFillEnabled(G_TRUE);
+	gDrawBoard->SetFillPaintType(G_COLOR_PAINT_TYPE);
+	data.Count = 0;
+
+	glFinish();
+	startTime = GetTickCount();
+	if (idx == 0) {
+		for (i = 0; i < G_CAPTURE_FRAMES; ++i) {
+			DrawCaptureFrame(gDrawBoard, i, (GReal)w, (GReal)h);
+			gDrawBoard->ScreenShot(shot);
+		}
+	}
+	else {
+		// the read of each frame goes on while the next ones are drawn
+		gDrawBoard->SetScreenShotCallback(CaptureCallback, &data);
+		for (i = 0; i < G_CAPTURE_FRAMES; ++i) {
+			DrawCaptureFrame(gDrawBoard, i, (GReal)w, (GReal)h);
+			gDrawBoard->ScreenShotAsync(frameID);
+		}
+		gDrawBoard->FlushScreenShots();
+		gDrawBoard->SetScreenShotCallback(NULL);
+	}
+	glFinish();
+	elapsed = GMath::Max((GUInt32)(GetTickCount() - startTime), (GUInt32)1);
+
+	gCaptureFps[idx] = (GReal)(G_CAPTURE_FRAMES * 1000) / (GReal)elapsed;
+	gCaptureWidth = w;
+	gCaptureHeight = h;
+	// the last frame is still in the framebuffer, so it can be compared with a synchronous screenshot
+	if (idx == 1) {
+		gDrawBoard->ScreenShot(shot);
+		gCaptureMatch = (data.Count == G_CAPTURE_FRAMES && data.LastFrame.PixelsCount() == shot.PixelsCount() &&
+						 std::memcmp(data.LastFrame.Pixels(), shot.Pixels(), shot.PixelsCount() * 4) == 0);
+	}
+}
@@ -815,6 +815,9 @@ int WINAPI WinMain(	HINSTANCE	hInstance,			// Instance
 					gFillRule = G_EVEN_ODD_RULE;
 				else
 				if (gFillRule == G_EVEN_ODD_RULE)
+					gFillRule = G_NON_ZERO_RULE;
+				else
+				if (gFillRule == G_NON_ZERO_RULE)
 					gFillRule = G_ANY_RULE;
 				else
 					gFillRule = G_ODD_EVEN_RULE;